@@ -0,0 +1,89 @@
+#version 450 core
+
+// MUST BE the same as ANIMATION_WORKGROUP_SIZE in main.c
+layout(local_size_x = 64, local_size_y = 1, local_size_z = 1) in;
+
+struct ObjectState {
+    vec2 position;
+    vec2 velocity;
+    float angle;            // in degrees
+    float angularVelocity;  // in degrees per second
+    float scale;
+    float reserved;
+};
+
+struct ObjectTransform {
+    vec2 offset;
+    float angle;
+    float scale;
+};
+
+layout(std430, set = 0, binding = 0) buffer state_block {
+    ObjectState states[];
+} object_states;
+
+layout(std430, set = 0, binding = 1) writeonly buffer transform_block {
+    ObjectTransform transforms[];
+} object_transforms;
+
+// Written by the host before every dispatch, since the dispatch itself is recorded once
+layout(std140, set = 0, binding = 2) uniform animation_params {
+    // Seconds since the previous frame
+    float deltaTime;
+} params;
+
+layout(push_constant) uniform animation_consts {
+    uint objectCount;
+    // Non-zero to place the objects at their initial states instead of advancing them
+    uint reset;
+} consts;
+
+// Integer hash (lowbias32), mapped into [0, 1)
+float Hash(uint x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return float(x >> 8) / 16777216.0f;
+}
+
+void main(void)
+{
+    const uint index = gl_GlobalInvocationID.x;
+    if (index >= consts.objectCount) return;
+
+    ObjectState state;
+    if (consts.reset != 0U)
+    {
+        const uint seed = index * 6U;
+        state.position = vec2(Hash(seed), Hash(seed + 1U)) * 1.6f - 0.8f;
+        state.velocity = vec2(Hash(seed + 2U), Hash(seed + 3U)) * 0.6f - 0.3f;
+        state.angle = Hash(seed + 4U) * 360.0f;
+        state.angularVelocity = Hash(seed + 5U) * 240.0f - 120.0f;
+        // Two objects keep the size of the original squares, more objects get smaller to stay visible.
+        state.scale = min(1.0f, 2.0f / sqrt(float(consts.objectCount)));
+        state.reserved = 0.0f;
+    }
+    else
+    {
+        state = object_states.states[index];
+        state.position += state.velocity * params.deltaTime;
+        // Bounce off the edges of the view volume
+        if (abs(state.position.x) > 0.8f)
+        {
+            state.position.x = clamp(state.position.x, -0.8f, 0.8f);
+            state.velocity.x = -state.velocity.x;
+        }
+        if (abs(state.position.y) > 0.8f)
+        {
+            state.position.y = clamp(state.position.y, -0.8f, 0.8f);
+            state.velocity.y = -state.velocity.y;
+        }
+        state.angle = mod(state.angle + state.angularVelocity * params.deltaTime, 360.0f);
+    }
+
+    object_states.states[index] = state;
+    object_transforms.transforms[index] = ObjectTransform(state.position, state.angle, state.scale);
+}
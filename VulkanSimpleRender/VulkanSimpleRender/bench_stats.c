@@ -0,0 +1,50 @@
+#include "bench_stats.h"
+#include <stdlib.h>
+
+static int CompareDoubleSamples(const void* a, const void* b)
+{
+    const double lhs = *(const double*)a;
+    const double rhs = *(const double*)b;
+    return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+}
+
+double GetSortedSamplesPercentile(const double sortedSamples[], size_t count, double percentile)
+{
+    if (count == 0) return 0.0;
+    if (count == 1) return sortedSamples[0];
+
+    const double rank = percentile / 100.0 * (double)(count - 1);
+    size_t lowerIndex = (size_t)rank;
+    if (lowerIndex >= count - 1) {
+        return sortedSamples[count - 1];
+    }
+    const double fraction = rank - (double)lowerIndex;
+    return sortedSamples[lowerIndex] + (sortedSamples[lowerIndex + 1] - sortedSamples[lowerIndex]) * fraction;
+}
+
+void ComputeBenchStatistics(double samples[], size_t count, BenchStatistics* pStats)
+{
+    *pStats = (BenchStatistics){ .sampleCount = count };
+    if (count == 0) return;
+
+    qsort(samples, count, sizeof(samples[0]), CompareDoubleSamples);
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i) {
+        sum += samples[i];
+    }
+
+    pStats->min = samples[0];
+    pStats->max = samples[count - 1];
+    pStats->mean = sum / (double)count;
+    pStats->p50 = GetSortedSamplesPercentile(samples, count, 50.0);
+    pStats->p95 = GetSortedSamplesPercentile(samples, count, 95.0);
+    pStats->p99 = GetSortedSamplesPercentile(samples, count, 99.0);
+}
+
+void WriteBenchStatisticsJSON(FILE* fp, const char* indent, const char* name, const BenchStatistics* pStats)
+{
+    fprintf(fp, "%s\"%s\": { \"samples\": %zu, \"mean\": %.6f, \"min\": %.6f, \"max\": %.6f, \"p50\": %.6f, \"p95\": %.6f, \"p99\": %.6f }",
+        indent, name, pStats->sampleCount, pStats->mean, pStats->min, pStats->max, pStats->p50, pStats->p95, pStats->p99);
+}
+
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct BenchStatistics
+{
+    size_t sampleCount;
+    double min;
+    double max;
+    double mean;
+    double p50;
+    double p95;
+    double p99;
+} BenchStatistics;
+
+// Summarizes `count` samples. The `samples` array will be sorted in ascending order in place.
+extern void ComputeBenchStatistics(double samples[], size_t count, BenchStatistics* pStats);
+
+// Returns the percentile (0.0 ~ 100.0) of the sorted samples with linear interpolation between the closest ranks.
+extern double GetSortedSamplesPercentile(const double sortedSamples[], size_t count, double percentile);
+
+// Writes the statistics as a JSON object member of the form `"name": { ... }` without the trailing comma.
+extern void WriteBenchStatisticsJSON(FILE* fp, const char* indent, const char* name, const BenchStatistics* pStats);
+
@@ -0,0 +1,414 @@
+#include "capability_registry.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct CapabilityCacheFileHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    uint32_t payloadSize;
+    // Catches the corruption the checks of IsDeviceCapabilitiesValid cannot see, like a damaged device name
+    uint32_t payloadChecksum;
+} CapabilityCacheFileHeader;
+
+// 32-bit FNV-1a
+static uint32_t HashExtensionName(const char* name)
+{
+    uint32_t hash = 2166136261U;
+    for (const char* p = name; *p != '\0'; ++p)
+    {
+        hash ^= (uint8_t)*p;
+        hash *= 16777619U;
+    }
+    return hash != 0 ? hash : 1U;
+}
+
+// 32-bit FNV-1a as well
+static uint32_t ComputePayloadChecksum(const void* pPayload, size_t size)
+{
+    uint32_t hash = 2166136261U;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= ((const uint8_t*)pPayload)[i];
+        hash *= 16777619U;
+    }
+    return hash;
+}
+
+void InitializeExtensionSet(ExtensionSet* pSet)
+{
+    memset(pSet, 0, sizeof(*pSet));
+}
+
+bool InsertExtension(ExtensionSet* pSet, const char* name)
+{
+    const uint32_t hash = HashExtensionName(name);
+    for (uint32_t slot = hash & (EXTENSION_SET_SLOT_COUNT - 1); ; slot = (slot + 1) & (EXTENSION_SET_SLOT_COUNT - 1))
+    {
+        if (pSet->hashes[slot] == 0)
+        {
+            const uint32_t length = (uint32_t)strlen(name) + 1;
+            if (pSet->count >= MAX_EXTENSION_SET_ENTRY_COUNT || pSet->namePoolSize + length > EXTENSION_SET_NAME_POOL_SIZE) return false;
+
+            memcpy(&pSet->namePool[pSet->namePoolSize], name, length);
+            pSet->hashes[slot] = hash;
+            pSet->nameOffsets[slot] = (uint16_t)pSet->namePoolSize;
+            pSet->namePoolSize += length;
+            ++pSet->count;
+            return true;
+        }
+        if (pSet->hashes[slot] == hash && strcmp(&pSet->namePool[pSet->nameOffsets[slot]], name) == 0) return true;
+    }
+}
+
+bool ContainsExtension(const ExtensionSet* pSet, const char* name)
+{
+    const uint32_t hash = HashExtensionName(name);
+    for (uint32_t slot = hash & (EXTENSION_SET_SLOT_COUNT - 1); pSet->hashes[slot] != 0; slot = (slot + 1) & (EXTENSION_SET_SLOT_COUNT - 1))
+    {
+        if (pSet->hashes[slot] == hash && strcmp(&pSet->namePool[pSet->nameOffsets[slot]], name) == 0) return true;
+    }
+    return false;
+}
+
+static bool InsertExtensionProperties(ExtensionSet* pSet, const VkExtensionProperties* pProperties, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        if (!InsertExtension(pSet, pProperties[i].extensionName))
+        {
+            printf("Too many extensions! %s and the following ones are ignored.\n", pProperties[i].extensionName);
+            return false;
+        }
+    }
+    return true;
+}
+
+VkResult QueryInstanceExtensionSet(const char* layerName, ExtensionSet* pSet)
+{
+    InitializeExtensionSet(pSet);
+
+    VkExtensionProperties* pProperties = NULL;
+    uint32_t count = 0;
+    VkResult res;
+    // The extension count may change between the two calls, in which case VK_INCOMPLETE is returned.
+    do
+    {
+        res = vkEnumerateInstanceExtensionProperties(layerName, &count, NULL);
+        if (res != VK_SUCCESS || count == 0) break;
+
+        free(pProperties);
+        pProperties = malloc(count * sizeof(*pProperties));
+        if (pProperties == NULL) return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+        res = vkEnumerateInstanceExtensionProperties(layerName, &count, pProperties);
+    } while (res == VK_INCOMPLETE);
+
+    if (res == VK_SUCCESS && pProperties != NULL) {
+        InsertExtensionProperties(pSet, pProperties, count);
+    }
+    free(pProperties);
+    return res;
+}
+
+static VkResult QueryDeviceExtensionSet(VkPhysicalDevice physicalDevice, ExtensionSet* pSet)
+{
+    InitializeExtensionSet(pSet);
+
+    VkExtensionProperties* pProperties = NULL;
+    uint32_t count = 0;
+    VkResult res;
+    do
+    {
+        res = vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &count, NULL);
+        if (res != VK_SUCCESS || count == 0) break;
+
+        free(pProperties);
+        pProperties = malloc(count * sizeof(*pProperties));
+        if (pProperties == NULL) return VK_ERROR_OUT_OF_HOST_MEMORY;
+
+        res = vkEnumerateDeviceExtensionProperties(physicalDevice, NULL, &count, pProperties);
+    } while (res == VK_INCOMPLETE);
+
+    if (res == VK_SUCCESS && pProperties != NULL) {
+        InsertExtensionProperties(pSet, pProperties, count);
+    }
+    free(pProperties);
+    return res;
+}
+
+void GetPhysicalDeviceUUID(VkPhysicalDevice physicalDevice, uint8_t deviceUUID[VK_UUID_SIZE])
+{
+    VkPhysicalDeviceIDProperties idProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &idProps
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    memcpy(deviceUUID, idProps.deviceUUID, VK_UUID_SIZE);
+}
+
+bool QueryDeviceCapabilities(VkPhysicalDevice physicalDevice, DeviceCapabilities* pCapabilities)
+{
+    memset(pCapabilities, 0, sizeof(*pCapabilities));
+
+    const VkResult res = QueryDeviceExtensionSet(physicalDevice, &pCapabilities->extensions);
+    if (res != VK_SUCCESS)
+    {
+        printf("QueryDeviceExtensionSet failed: %d\n", res);
+        return false;
+    }
+
+    vkGetPhysicalDeviceProperties(physicalDevice, &pCapabilities->properties);
+    const bool isVulkan12 = pCapabilities->properties.apiVersion >= VK_API_VERSION_1_2;
+
+    // Only chain the structures the device knows about
+    VkPhysicalDeviceDriverProperties driverProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceIDProperties idProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceDescriptorIndexingProperties descriptorIndexingProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES,
+        .pNext = NULL
+    };
+    if (isVulkan12 || ContainsExtension(&pCapabilities->extensions, VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME)) {
+        idProps.pNext = &driverProps;
+    }
+    const bool supportDescriptorIndexing = isVulkan12 || ContainsExtension(&pCapabilities->extensions, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+    if (supportDescriptorIndexing)
+    {
+        descriptorIndexingProps.pNext = idProps.pNext;
+        idProps.pNext = &descriptorIndexingProps;
+    }
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT descriptorBufferProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT,
+        .pNext = NULL
+    };
+    const bool supportDescriptorBuffer = ContainsExtension(&pCapabilities->extensions, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    if (supportDescriptorBuffer)
+    {
+        descriptorBufferProps.pNext = idProps.pNext;
+        idProps.pNext = &descriptorBufferProps;
+    }
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &idProps
+    };
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+    pCapabilities->uniformBufferDescriptorSize = (uint32_t)descriptorBufferProps.uniformBufferDescriptorSize;
+    pCapabilities->storageBufferDescriptorSize = (uint32_t)descriptorBufferProps.storageBufferDescriptorSize;
+    pCapabilities->combinedImageSamplerDescriptorSize = (uint32_t)descriptorBufferProps.combinedImageSamplerDescriptorSize;
+    pCapabilities->descriptorBufferOffsetAlignment = descriptorBufferProps.descriptorBufferOffsetAlignment;
+    memcpy(pCapabilities->deviceUUID, idProps.deviceUUID, VK_UUID_SIZE);
+    memcpy(pCapabilities->driverName, driverProps.driverName, VK_MAX_DRIVER_NAME_SIZE);
+    memcpy(pCapabilities->driverInfo, driverProps.driverInfo, VK_MAX_DRIVER_INFO_SIZE);
+
+    VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlockLayoutFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceFeatures2 features2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+        .pNext = NULL
+    };
+    if (isVulkan12 || ContainsExtension(&pCapabilities->extensions, VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME)) {
+        features2.pNext = &scalarBlockLayoutFeature;
+    }
+    if (ContainsExtension(&pCapabilities->extensions, VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME))
+    {
+        hostImageCopyFeature.pNext = features2.pNext;
+        features2.pNext = &hostImageCopyFeature;
+    }
+    if (supportDescriptorIndexing)
+    {
+        descriptorIndexingFeature.pNext = features2.pNext;
+        features2.pNext = &descriptorIndexingFeature;
+    }
+    // VK_EXT_descriptor_buffer requires Vulkan 1.2 or VK_KHR_buffer_device_address, so the device knows both structures.
+    if (supportDescriptorBuffer)
+    {
+        bufferDeviceAddressFeature.pNext = features2.pNext;
+        descriptorBufferFeature.pNext = &bufferDeviceAddressFeature;
+        features2.pNext = &descriptorBufferFeature;
+    }
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &features2);
+    pCapabilities->features = features2.features;
+    pCapabilities->scalarBlockLayout = scalarBlockLayoutFeature.scalarBlockLayout;
+    pCapabilities->hostImageCopy = hostImageCopyFeature.hostImageCopy;
+    pCapabilities->bindlessDescriptors = descriptorIndexingFeature.runtimeDescriptorArray &&
+        descriptorIndexingFeature.descriptorBindingPartiallyBound &&
+        descriptorIndexingFeature.descriptorBindingUpdateUnusedWhilePending &&
+        descriptorIndexingFeature.descriptorBindingStorageBufferUpdateAfterBind &&
+        descriptorIndexingFeature.descriptorBindingSampledImageUpdateAfterBind ? VK_TRUE : VK_FALSE;
+    pCapabilities->maxBindlessStorageBuffers = descriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindStorageBuffers <
+        descriptorIndexingProps.maxDescriptorSetUpdateAfterBindStorageBuffers ?
+        descriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindStorageBuffers : descriptorIndexingProps.maxDescriptorSetUpdateAfterBindStorageBuffers;
+    pCapabilities->maxBindlessSampledImages = descriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages <
+        descriptorIndexingProps.maxDescriptorSetUpdateAfterBindSampledImages ?
+        descriptorIndexingProps.maxPerStageDescriptorUpdateAfterBindSampledImages : descriptorIndexingProps.maxDescriptorSetUpdateAfterBindSampledImages;
+    pCapabilities->descriptorBuffer = descriptorBufferFeature.descriptorBuffer && bufferDeviceAddressFeature.bufferDeviceAddress ? VK_TRUE : VK_FALSE;
+
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &pCapabilities->memoryProperties);
+
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &pCapabilities->queueFamilyCount, NULL);
+    if (pCapabilities->queueFamilyCount > MAX_CAPABILITY_QUEUE_FAMILY_COUNT) {
+        pCapabilities->queueFamilyCount = MAX_CAPABILITY_QUEUE_FAMILY_COUNT;
+    }
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &pCapabilities->queueFamilyCount, pCapabilities->queueFamilies);
+
+    return true;
+}
+
+bool IsDeviceCapabilitiesCurrent(const DeviceCapabilities* pCapabilities, VkPhysicalDevice physicalDevice)
+{
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    GetPhysicalDeviceUUID(physicalDevice, deviceUUID);
+    if (memcmp(deviceUUID, pCapabilities->deviceUUID, VK_UUID_SIZE) != 0) return false;
+
+    VkPhysicalDeviceProperties props;
+    vkGetPhysicalDeviceProperties(physicalDevice, &props);
+    return props.vendorID == pCapabilities->properties.vendorID &&
+           props.deviceID == pCapabilities->properties.deviceID &&
+           props.driverVersion == pCapabilities->properties.driverVersion &&
+           props.apiVersion == pCapabilities->properties.apiVersion;
+}
+
+// The loaded set is used as it is, so every name offset MUST point at a terminated name in the used part of the pool,
+// and enough slots MUST stay empty for every lookup to end.
+static bool IsExtensionSetValid(const ExtensionSet* pSet)
+{
+    if (pSet->count > MAX_EXTENSION_SET_ENTRY_COUNT || pSet->namePoolSize > EXTENSION_SET_NAME_POOL_SIZE) return false;
+
+    uint32_t occupiedSlotCount = 0;
+    for (uint32_t slot = 0; slot < EXTENSION_SET_SLOT_COUNT; ++slot)
+    {
+        if (pSet->hashes[slot] == 0) continue;
+
+        const uint32_t nameOffset = pSet->nameOffsets[slot];
+        if (nameOffset >= pSet->namePoolSize || memchr(&pSet->namePool[nameOffset], '\0', pSet->namePoolSize - nameOffset) == NULL ||
+            HashExtensionName(&pSet->namePool[nameOffset]) != pSet->hashes[slot]) {
+            return false;
+        }
+        ++occupiedSlotCount;
+    }
+    return occupiedSlotCount == pSet->count;
+}
+
+// Checks every count against the array it indexes, and that the strings are terminated.
+static bool IsDeviceCapabilitiesValid(const DeviceCapabilities* pCapabilities)
+{
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties = &pCapabilities->memoryProperties;
+    if (pCapabilities->queueFamilyCount > MAX_CAPABILITY_QUEUE_FAMILY_COUNT || pMemoryProperties->memoryTypeCount > VK_MAX_MEMORY_TYPES ||
+        pMemoryProperties->memoryHeapCount > VK_MAX_MEMORY_HEAPS) {
+        return false;
+    }
+    for (uint32_t i = 0; i < pMemoryProperties->memoryTypeCount; ++i)
+    {
+        if (pMemoryProperties->memoryTypes[i].heapIndex >= pMemoryProperties->memoryHeapCount) return false;
+    }
+    if (memchr(pCapabilities->properties.deviceName, '\0', sizeof(pCapabilities->properties.deviceName)) == NULL ||
+        memchr(pCapabilities->driverName, '\0', sizeof(pCapabilities->driverName)) == NULL ||
+        memchr(pCapabilities->driverInfo, '\0', sizeof(pCapabilities->driverInfo)) == NULL) {
+        return false;
+    }
+    return IsExtensionSetValid(&pCapabilities->extensions);
+}
+
+bool LoadDeviceCapabilities(const char* path, DeviceCapabilities* pCapabilities)
+{
+    FILE* fp = NULL;
+    // The cache file does not exist on the first launch, so do not report the failure.
+#ifdef _WIN32
+    if (fopen_s(&fp, path, "rb") != 0) return false;
+#else
+    fp = fopen(path, "rb");
+#endif // _WIN32
+    if (fp == NULL) return false;
+
+    CapabilityCacheFileHeader header = { 0 };
+    const bool isCompatible = fread(&header, sizeof(header), 1, fp) == 1 &&
+                              header.magic == CAPABILITY_CACHE_FILE_MAGIC &&
+                              header.formatVersion == CAPABILITY_CACHE_FORMAT_VERSION &&
+                              header.payloadSize == (uint32_t)sizeof(*pCapabilities);
+    // The file MUST end right after the payload
+    const bool succeeded = isCompatible && fread(pCapabilities, sizeof(*pCapabilities), 1, fp) == 1 && fgetc(fp) == EOF &&
+                           header.payloadChecksum == ComputePayloadChecksum(pCapabilities, sizeof(*pCapabilities)) &&
+                           IsDeviceCapabilitiesValid(pCapabilities);
+    fclose(fp);
+    if (isCompatible && !succeeded)
+    {
+        printf("Capability cache file '%s' is corrupted, the devices are scanned again.\n", path);
+        memset(pCapabilities, 0, sizeof(*pCapabilities));
+    }
+    return succeeded;
+}
+
+void StoreDeviceCapabilities(const char* path, const DeviceCapabilities* pCapabilities)
+{
+    // Written next to the cache and renamed over it, so that a run crashing halfway never leaves a partial cache behind
+    char temporaryPath[1024];
+    if (snprintf(temporaryPath, sizeof(temporaryPath), "%s.tmp", path) >= (int)sizeof(temporaryPath))
+    {
+        printf("Capability cache path '%s' is too long!\n", path);
+        return;
+    }
+
+    FILE* fp = NULL;
+#ifdef _WIN32
+    if (fopen_s(&fp, temporaryPath, "wb") != 0) fp = NULL;
+#else
+    fp = fopen(temporaryPath, "wb");
+#endif // _WIN32
+    if (fp == NULL)
+    {
+        printf("Create capability cache file '%s' failed!\n", temporaryPath);
+        return;
+    }
+
+    const CapabilityCacheFileHeader header = {
+        .magic = CAPABILITY_CACHE_FILE_MAGIC,
+        .formatVersion = CAPABILITY_CACHE_FORMAT_VERSION,
+        .payloadSize = (uint32_t)sizeof(*pCapabilities),
+        .payloadChecksum = ComputePayloadChecksum(pCapabilities, sizeof(*pCapabilities))
+    };
+    const bool isWritten = fwrite(&header, sizeof(header), 1, fp) == 1 && fwrite(pCapabilities, sizeof(*pCapabilities), 1, fp) == 1;
+    if (fclose(fp) != 0 || !isWritten)
+    {
+        printf("Write capability cache file '%s' failed!\n", temporaryPath);
+        remove(temporaryPath);
+        return;
+    }
+#ifdef _WIN32
+    // rename does not replace an existing file on Windows
+    remove(path);
+#endif // _WIN32
+    if (rename(temporaryPath, path) != 0)
+    {
+        printf("Replace capability cache file '%s' failed!\n", path);
+        remove(temporaryPath);
+    }
+}
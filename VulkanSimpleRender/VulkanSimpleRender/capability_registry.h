@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+
+enum CAPABILITY_REGISTRY_CONSTANTS
+{
+    // MUST BE a power of 2 and larger than MAX_EXTENSION_SET_ENTRY_COUNT, so that a lookup always meets an empty slot.
+    EXTENSION_SET_SLOT_COUNT = 512,
+    MAX_EXTENSION_SET_ENTRY_COUNT = 384,
+    EXTENSION_SET_NAME_POOL_SIZE = 16384,
+
+    MAX_CAPABILITY_QUEUE_FAMILY_COUNT = 16,
+
+    // 'VSRC' in little endian
+    CAPABILITY_CACHE_FILE_MAGIC = 0x43525356,
+    // MUST BE increased whenever the layout of DeviceCapabilities or of the file header changes
+    CAPABILITY_CACHE_FORMAT_VERSION = 5
+};
+
+// Open addressing hash set of extension names.
+// All names are stored in one pool, so the whole set can be written to and read from a file as it is.
+typedef struct ExtensionSet
+{
+    // 0 marks an empty slot
+    uint32_t hashes[EXTENSION_SET_SLOT_COUNT];
+    uint16_t nameOffsets[EXTENSION_SET_SLOT_COUNT];
+    uint32_t count;
+    uint32_t namePoolSize;
+    char namePool[EXTENSION_SET_NAME_POOL_SIZE];
+} ExtensionSet;
+
+// Everything the renderer needs to know about a physical device, queried once.
+typedef struct DeviceCapabilities
+{
+    // Includes the limits
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceFeatures features;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    VkBool32 scalarBlockLayout;
+    // VK_EXT_host_image_copy
+    VkBool32 hostImageCopy;
+    // VK_EXT_descriptor_indexing, core in Vulkan 1.2: runtime descriptor arrays of storage buffers and sampled images
+    // that are partially bound and updated after being bound, also while pending
+    VkBool32 bindlessDescriptors;
+    // The smaller of the per-stage and per-set update-after-bind limits
+    uint32_t maxBindlessStorageBuffers;
+    uint32_t maxBindlessSampledImages;
+    // VK_EXT_descriptor_buffer together with bufferDeviceAddress, since buffer descriptors are made from device addresses
+    VkBool32 descriptorBuffer;
+    // Bytes of each descriptor written into a descriptor buffer, and the alignment of the offsets a set is bound at
+    uint32_t uniformBufferDescriptorSize;
+    uint32_t storageBufferDescriptorSize;
+    uint32_t combinedImageSamplerDescriptorSize;
+    VkDeviceSize descriptorBufferOffsetAlignment;
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    char driverName[VK_MAX_DRIVER_NAME_SIZE];
+    char driverInfo[VK_MAX_DRIVER_INFO_SIZE];
+    uint32_t queueFamilyCount;
+    VkQueueFamilyProperties queueFamilies[MAX_CAPABILITY_QUEUE_FAMILY_COUNT];
+    ExtensionSet extensions;
+} DeviceCapabilities;
+
+extern void InitializeExtensionSet(ExtensionSet* pSet);
+// Returns false if the set is full.
+extern bool InsertExtension(ExtensionSet* pSet, const char* name);
+extern bool ContainsExtension(const ExtensionSet* pSet, const char* name);
+
+// Collects the instance extensions provided by the implementation or by `layerName` if it is not NULL.
+extern VkResult QueryInstanceExtensionSet(const char* layerName, ExtensionSet* pSet);
+
+extern void GetPhysicalDeviceUUID(VkPhysicalDevice physicalDevice, uint8_t deviceUUID[VK_UUID_SIZE]);
+extern bool QueryDeviceCapabilities(VkPhysicalDevice physicalDevice, DeviceCapabilities* pCapabilities);
+// Returns true if `pCapabilities` describes `physicalDevice` running on the current driver version.
+extern bool IsDeviceCapabilitiesCurrent(const DeviceCapabilities* pCapabilities, VkPhysicalDevice physicalDevice);
+
+// Returns false if the file does not exist or was written by an incompatible build.
+extern bool LoadDeviceCapabilities(const char* path, DeviceCapabilities* pCapabilities);
+extern void StoreDeviceCapabilities(const char* path, const DeviceCapabilities* pCapabilities);
@@ -0,0 +1,186 @@
+#include "deletion_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool IsRetirableObjectType(VkObjectType type)
+{
+    switch (type)
+    {
+    case VK_OBJECT_TYPE_BUFFER:
+    case VK_OBJECT_TYPE_BUFFER_VIEW:
+    case VK_OBJECT_TYPE_IMAGE:
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+    case VK_OBJECT_TYPE_SAMPLER:
+    case VK_OBJECT_TYPE_FRAMEBUFFER:
+    case VK_OBJECT_TYPE_RENDER_PASS:
+    case VK_OBJECT_TYPE_PIPELINE:
+    case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+    case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+    case VK_OBJECT_TYPE_COMMAND_POOL:
+    case VK_OBJECT_TYPE_SEMAPHORE:
+    case VK_OBJECT_TYPE_FENCE:
+    case VK_OBJECT_TYPE_QUERY_POOL:
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+    case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+        return true;
+    default:
+        return false;
+    }
+}
+
+static void DestroyRetiredObject(const DeletionQueueCreateInfo* pInfo, const RetiredObject* pObject)
+{
+    const VkDevice device = pInfo->device;
+    const VkAllocationCallbacks* pAllocator = pInfo->pAllocator;
+    // Non-dispatchable handles are pointers on 64-bit platforms and uint64_t otherwise, either converts from uint64_t.
+    switch (pObject->type)
+    {
+    case VK_OBJECT_TYPE_BUFFER:
+        vkDestroyBuffer(device, (VkBuffer)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_BUFFER_VIEW:
+        vkDestroyBufferView(device, (VkBufferView)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_IMAGE:
+        vkDestroyImage(device, (VkImage)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_IMAGE_VIEW:
+        vkDestroyImageView(device, (VkImageView)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_SAMPLER:
+        vkDestroySampler(device, (VkSampler)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_FRAMEBUFFER:
+        vkDestroyFramebuffer(device, (VkFramebuffer)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_RENDER_PASS:
+        vkDestroyRenderPass(device, (VkRenderPass)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE:
+        vkDestroyPipeline(device, (VkPipeline)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_PIPELINE_LAYOUT:
+        vkDestroyPipelineLayout(device, (VkPipelineLayout)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_POOL:
+        vkDestroyDescriptorPool(device, (VkDescriptorPool)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT:
+        vkDestroyDescriptorSetLayout(device, (VkDescriptorSetLayout)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_COMMAND_POOL:
+        vkDestroyCommandPool(device, (VkCommandPool)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_SEMAPHORE:
+        vkDestroySemaphore(device, (VkSemaphore)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_FENCE:
+        vkDestroyFence(device, (VkFence)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_QUERY_POOL:
+        vkDestroyQueryPool(device, (VkQueryPool)pObject->handle, pAllocator);
+        break;
+    case VK_OBJECT_TYPE_DEVICE_MEMORY:
+        if (pInfo->pMemoryTracker != NULL) {
+            FreeTrackedDeviceMemory(pInfo->pMemoryTracker, (VkDeviceMemory)pObject->handle);
+        }
+        else {
+            vkFreeMemory(device, (VkDeviceMemory)pObject->handle, pAllocator);
+        }
+        break;
+    case VK_OBJECT_TYPE_SWAPCHAIN_KHR:
+        vkDestroySwapchainKHR(device, (VkSwapchainKHR)pObject->handle, pAllocator);
+        break;
+    default:
+        break;
+    }
+}
+
+bool CreateDeletionQueue(const DeletionQueueCreateInfo* pCreateInfo, DeletionQueue* pQueue)
+{
+    memset(pQueue, 0, sizeof(*pQueue));
+    pQueue->info = *pCreateInfo;
+    pQueue->capacity = pCreateInfo->initialCapacity > 0 ? pCreateInfo->initialCapacity : DEFAULT_DELETION_QUEUE_CAPACITY;
+    pQueue->pObjects = malloc(pQueue->capacity * sizeof(RetiredObject));
+    if (pQueue->pObjects == NULL)
+    {
+        puts("Failed to allocate the deletion queue!");
+        return false;
+    }
+    return true;
+}
+
+void DestroyDeletionQueue(DeletionQueue* pQueue)
+{
+    if (pQueue->pObjects == NULL) return;
+
+    for (uint32_t i = 0; i < pQueue->count; ++i) {
+        DestroyRetiredObject(&pQueue->info, &pQueue->pObjects[(pQueue->head + i) % pQueue->capacity]);
+    }
+    free(pQueue->pObjects);
+    memset(pQueue, 0, sizeof(*pQueue));
+}
+
+bool RetireVulkanObject(DeletionQueue* pQueue, VkObjectType type, uint64_t handle, uint64_t value)
+{
+    if (!IsRetirableObjectType(type))
+    {
+        printf("Objects of type %d cannot be retired!\n", type);
+        return false;
+    }
+    if (handle == 0) return true;
+
+    const RetiredObject object = { .handle = handle, .type = type, .value = value };
+    ++pQueue->retiredCount;
+    // Nothing ahead of it has to be destroyed first, and nothing in flight uses it any more.
+    if (pQueue->count == 0 && value <= pQueue->completedValue)
+    {
+        DestroyRetiredObject(&pQueue->info, &object);
+        ++pQueue->destroyedCount;
+        return true;
+    }
+
+    if (pQueue->count == pQueue->capacity)
+    {
+        // Unrolls the ring into the new array, so the pending objects start at 0 again
+        const uint32_t newCapacity = pQueue->capacity * 2;
+        RetiredObject* pObjects = malloc(newCapacity * sizeof(RetiredObject));
+        if (pObjects == NULL)
+        {
+            puts("Failed to grow the deletion queue!");
+            --pQueue->retiredCount;
+            return false;
+        }
+        const uint32_t firstPartCount = pQueue->capacity - pQueue->head;
+        memcpy(pObjects, &pQueue->pObjects[pQueue->head], firstPartCount * sizeof(RetiredObject));
+        memcpy(&pObjects[firstPartCount], pQueue->pObjects, pQueue->head * sizeof(RetiredObject));
+        free(pQueue->pObjects);
+        pQueue->pObjects = pObjects;
+        pQueue->capacity = newCapacity;
+        pQueue->head = 0;
+    }
+    pQueue->pObjects[(pQueue->head + pQueue->count) % pQueue->capacity] = object;
+    ++pQueue->count;
+    pQueue->maxPendingCount = pQueue->count > pQueue->maxPendingCount ? pQueue->count : pQueue->maxPendingCount;
+    return true;
+}
+
+uint32_t CollectDeletionQueue(DeletionQueue* pQueue, uint64_t completedValue)
+{
+    if (completedValue > pQueue->completedValue) {
+        pQueue->completedValue = completedValue;
+    }
+
+    uint32_t destroyedCount = 0;
+    while (pQueue->count > 0 && pQueue->pObjects[pQueue->head].value <= pQueue->completedValue)
+    {
+        DestroyRetiredObject(&pQueue->info, &pQueue->pObjects[pQueue->head]);
+        pQueue->head = (pQueue->head + 1) % pQueue->capacity;
+        --pQueue->count;
+        ++destroyedCount;
+    }
+    pQueue->destroyedCount += destroyedCount;
+    return destroyedCount;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "memory_tracker.h"
+
+enum DELETION_QUEUE_CONSTANTS
+{
+    // Objects only wait for the frames in flight, so even a shader reload every frame retires far fewer at a time
+    DEFAULT_DELETION_QUEUE_CAPACITY = 64
+};
+
+typedef struct DeletionQueueCreateInfo
+{
+    VkDevice device;
+    // The callbacks the objects were created with, NULL for none
+    const VkAllocationCallbacks* pAllocator;
+    // Device memory is freed through this tracker if not NULL, so the tracker stops counting it
+    DeviceMemoryTracker* pMemoryTracker;
+    uint32_t initialCapacity;
+} DeletionQueueCreateInfo;
+
+typedef struct RetiredObject
+{
+    // A non-dispatchable handle cast to uint64_t, as in VkDebugUtilsObjectNameInfoEXT
+    uint64_t handle;
+    VkObjectType type;
+    // The value of the last submission using the object
+    uint64_t value;
+} RetiredObject;
+
+// Destroys Vulkan objects once the GPU has finished with them, so nothing is ever destroyed behind a vkDeviceWaitIdle.
+// A retired object is tagged with a value of the last submission using it, and destroyed once the owner reports that value as
+// completed. Values are whatever the owner counts its submissions with, such as frame numbers signaling a fence per frame in flight,
+// or the values of a timeline semaphore. They MUST only grow over the submissions, and the objects are destroyed in retirement order,
+// so an object tagged with a smaller value than one retired before it is destroyed late rather than early. Not thread safe.
+typedef struct DeletionQueue
+{
+    DeletionQueueCreateInfo info;
+    // A ring of `capacity` objects, of which `count` are pending from `head` on
+    RetiredObject* pObjects;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+    // The greatest value reported as completed
+    uint64_t completedValue;
+
+    uint32_t retiredCount;
+    uint32_t destroyedCount;
+    uint32_t maxPendingCount;
+} DeletionQueue;
+
+extern bool CreateDeletionQueue(const DeletionQueueCreateInfo* pCreateInfo, DeletionQueue* pQueue);
+// Destroys the pending objects at once. The device MUST BE idle.
+extern void DestroyDeletionQueue(DeletionQueue* pQueue);
+
+// Destroys the object once `value` has completed, or right away if it already has. Supports buffers, buffer views, images,
+// image views, samplers, framebuffers, render passes, pipelines, pipeline layouts, descriptor pools, descriptor set layouts,
+// command pools, semaphores, fences, query pools, device memory and swapchains. Returns false for any other type and if the queue
+// cannot grow, in which case the object is not destroyed.
+extern bool RetireVulkanObject(DeletionQueue* pQueue, VkObjectType type, uint64_t handle, uint64_t value);
+// Destroys the objects of which the values have completed, as far as they are in order. Returns the number of destroyed objects.
+extern uint32_t CollectDeletionQueue(DeletionQueue* pQueue, uint64_t completedValue);
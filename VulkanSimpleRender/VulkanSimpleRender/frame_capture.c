@@ -0,0 +1,852 @@
+#include "frame_capture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct YuvPushConstants
+{
+    uint32_t width;
+    uint32_t height;
+} YuvPushConstants;
+
+// The 4:2:0 planes of a frame, the chroma planes are rounded up for odd sizes
+static uint32_t GetYuv420FrameSize(uint32_t width, uint32_t height)
+{
+    return width * height + 2 * ((width + 1) / 2) * ((height + 1) / 2);
+}
+
+static bool IsStreamOutput(FrameCaptureOutput output)
+{
+    return output == FRAME_CAPTURE_OUTPUT_RGBA_STREAM || output == FRAME_CAPTURE_OUTPUT_Y4M_STREAM;
+}
+
+const char* GetFrameCaptureFormatName(const FrameCapture* pCapture)
+{
+    switch (pCapture->info.output)
+    {
+    case FRAME_CAPTURE_OUTPUT_RGBA_STREAM:
+        return "rgba";
+    case FRAME_CAPTURE_OUTPUT_Y4M_STREAM:
+        return "y4m";
+    default:
+        return GetImageFileFormatName(pCapture->info.fileFormat);
+    }
+}
+
+static bool CreateFrameCaptureSlot(FrameCapture* pCapture, FrameCaptureSlot* pSlot, VkCommandBuffer commandBuffer)
+{
+    const VkDevice device = pCapture->info.device;
+    pSlot->pCapture = pCapture;
+    pSlot->commandBuffer = commandBuffer;
+
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = pCapture->readbackSize,
+        // Written by the compute shader with the GPU YUV conversion
+        .usage = pCapture->isYuvOnGpu ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &pCapture->info.queueFamilyIndex
+    };
+    VkResult res = vkCreateBuffer(device, &bufferCreateInfo, pCapture->info.pAllocator, &pSlot->buffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, pSlot->buffer, &memoryRequirements);
+
+    res = AllocateReadbackDeviceMemory(pCapture->info.pMemoryTracker, device, pCapture->info.pAllocator, pCapture->info.pMemoryProperties,
+        &memoryRequirements, &pSlot->memory, &pCapture->isMemoryCoherent);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(device, pSlot->buffer, pSlot->memory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    res = vkMapMemory(device, pSlot->memory, 0, VK_WHOLE_SIZE, 0, (void**)&pSlot->pData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    const VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .pNext = NULL, .flags = 0 };
+    res = vkCreateFence(device, &fenceCreateInfo, pCapture->info.pAllocator, &pSlot->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateFence for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    if (pCapture->isYuvOnGpu)
+    {
+        const VkDescriptorSetAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = NULL,
+            .descriptorPool = pCapture->yuvDescriptorPool,
+            .descriptorSetCount = 1,
+            .pSetLayouts = &pCapture->yuvDescSetLayout
+        };
+        res = vkAllocateDescriptorSets(device, &allocInfo, &pSlot->yuvDescriptorSet);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateDescriptorSets for frame capture failed: %d\n", res);
+            return false;
+        }
+
+        // The image view is written by every capture
+        const VkDescriptorBufferInfo bufferInfo = { .buffer = pSlot->buffer, .offset = 0, .range = VK_WHOLE_SIZE };
+        const VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = pSlot->yuvDescriptorSet,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &bufferInfo,
+            .pTexelBufferView = NULL
+        };
+        vkUpdateDescriptorSets(device, 1, &write, 0, NULL);
+    }
+
+    return true;
+}
+
+static bool CreateYuvConversionPipeline(FrameCapture* pCapture)
+{
+    const VkDevice device = pCapture->info.device;
+    const VkDescriptorSetLayoutBinding layoutBindings[] = {
+        // captured image
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        // Y, U and V planes
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        }
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptorLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = (uint32_t)(sizeof(layoutBindings) / sizeof(layoutBindings[0])),
+        .pBindings = layoutBindings,
+    };
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorLayoutCreateInfo, pCapture->info.pAllocator, &pCapture->yuvDescSetLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorSetLayout for YUV conversion failed: %d\n", res);
+        return false;
+    }
+
+    const VkPushConstantRange pushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(YuvPushConstants)
+    };
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .setLayoutCount = 1,
+        .pSetLayouts = &pCapture->yuvDescSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, pCapture->info.pAllocator, &pCapture->yuvPipelineLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreatePipelineLayout for YUV conversion failed: %d\n", res);
+        return false;
+    }
+
+    const VkComputePipelineCreateInfo pipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = pCapture->info.yuvShaderModule,
+            .pName = "main",
+            .pSpecializationInfo = NULL
+        },
+        .layout = pCapture->yuvPipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0
+    };
+    res = vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineCreateInfo, pCapture->info.pAllocator, &pCapture->yuvPipeline);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateComputePipelines for YUV conversion failed: %d\n", res);
+        return false;
+    }
+
+    // One set per slot
+    const VkDescriptorPoolSize poolSizes[] = {
+        { .type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = pCapture->info.slotCount },
+        { .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = pCapture->info.slotCount }
+    };
+    const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .maxSets = pCapture->info.slotCount,
+        .poolSizeCount = (uint32_t)(sizeof(poolSizes) / sizeof(poolSizes[0])),
+        .pPoolSizes = poolSizes
+    };
+    res = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, pCapture->info.pAllocator, &pCapture->yuvDescriptorPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorPool for YUV conversion failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+// Full range BT.601 in 8-bit fixed point, bit-exact with rgb_to_yuv.comp.glsl. The chroma of every 2x2 block is computed from the sum
+// of its pixels, which are clamped to the frame for odd sizes.
+static void ConvertRgbaToYuv420(const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch, uint8_t* pPlanes)
+{
+    uint8_t* pLuma = pPlanes;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* pRow = pPixels + (size_t)y * rowPitch;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const uint8_t* p = pRow + (size_t)x * 4;
+            *pLuma++ = (uint8_t)((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+        }
+    }
+
+    const uint32_t chromaWidth = (width + 1) / 2;
+    const uint32_t chromaHeight = (height + 1) / 2;
+    uint8_t* pU = pLuma;
+    uint8_t* pV = pU + (size_t)chromaWidth * chromaHeight;
+    for (uint32_t cy = 0; cy < chromaHeight; ++cy)
+    {
+        const uint8_t* pRow0 = pPixels + (size_t)(cy * 2) * rowPitch;
+        const uint8_t* pRow1 = pPixels + (size_t)(cy * 2 + 1 < height ? cy * 2 + 1 : cy * 2) * rowPitch;
+        for (uint32_t cx = 0; cx < chromaWidth; ++cx)
+        {
+            const size_t x0 = (size_t)cx * 2 * 4;
+            const size_t x1 = cx * 2 + 1 < width ? x0 + 4 : x0;
+            const int r = pRow0[x0] + pRow0[x1] + pRow1[x0] + pRow1[x1];
+            const int g = pRow0[x0 + 1] + pRow0[x1 + 1] + pRow1[x0 + 1] + pRow1[x1 + 1];
+            const int b = pRow0[x0 + 2] + pRow0[x1 + 2] + pRow1[x0 + 2] + pRow1[x1 + 2];
+            // Offset by 128 << 10 and rounded, never negative
+            const int u = (-43 * r - 85 * g + 128 * b + 131584) >> 10;
+            const int v = (128 * r - 107 * g - 21 * b + 131584) >> 10;
+            *pU++ = (uint8_t)(u > 255 ? 255 : u);
+            *pV++ = (uint8_t)(v > 255 ? 255 : v);
+        }
+    }
+}
+
+static bool WriteStreamFrame(FrameCapture* pCapture, const FrameCaptureSlot* pSlot)
+{
+    FILE* fp = pCapture->pStream;
+    const uint32_t width = pCapture->info.width;
+    const uint32_t height = pCapture->info.height;
+    size_t byteCount = 0;
+    if (pCapture->info.output == FRAME_CAPTURE_OUTPUT_Y4M_STREAM)
+    {
+        const uint8_t* pPlanes = pSlot->pData;
+        if (!pCapture->isYuvOnGpu)
+        {
+            ConvertRgbaToYuv420(pSlot->pData, width, height, pCapture->rowPitch, pCapture->pYuvPlanes);
+            pPlanes = pCapture->pYuvPlanes;
+        }
+        static const char frameHeader[] = "FRAME\n";
+        byteCount = sizeof(frameHeader) - 1 + GetYuv420FrameSize(width, height);
+        if (fwrite(frameHeader, 1, sizeof(frameHeader) - 1, fp) != sizeof(frameHeader) - 1 ||
+            fwrite(pPlanes, 1, GetYuv420FrameSize(width, height), fp) != GetYuv420FrameSize(width, height)) return false;
+    }
+    else if (pCapture->rowPitch == width * 4)
+    {
+        byteCount = (size_t)pCapture->rowPitch * height;
+        if (fwrite(pSlot->pData, 1, byteCount, fp) != byteCount) return false;
+    }
+    else
+    {
+        for (uint32_t y = 0; y < height; ++y) {
+            if (fwrite(pSlot->pData + (size_t)y * pCapture->rowPitch, 4, width, fp) != width) return false;
+        }
+        byteCount = (size_t)width * 4 * height;
+    }
+    // A reader of a pipe gets every frame as soon as it is complete
+    if (fflush(fp) != 0) return false;
+    pCapture->streamedByteCount += byteCount;
+    return true;
+}
+
+// Writes the queued slots in ring order, which is the capture order.
+static void RunStreamWriter(void* pArgument)
+{
+    FrameCapture* pCapture = pArgument;
+    bool isStreamBroken = false;
+    LockPlatformMutex(&pCapture->streamMutex);
+    for (;;)
+    {
+        FrameCaptureSlot* pSlot = &pCapture->slots[pCapture->writerSlot];
+        if (!pSlot->isQueued)
+        {
+            if (pCapture->isWriterExiting) break;
+            WaitPlatformConditionVariable(&pCapture->streamCondition, &pCapture->streamMutex);
+            continue;
+        }
+        UnlockPlatformMutex(&pCapture->streamMutex);
+
+        const uint64_t beginTime = GetCurrentTimeNanoseconds();
+        // Once a write has failed, the stream would be corrupt even if the next ones succeeded
+        if (!isStreamBroken)
+        {
+            isStreamBroken = !WriteStreamFrame(pCapture, pSlot);
+            if (isStreamBroken) {
+                printf("Writing frame %llu to %s failed, the remaining frames are dropped.\n", (unsigned long long)pSlot->frameNumber, pCapture->path);
+            }
+        }
+        pSlot->isWritten = !isStreamBroken;
+        pSlot->encodeTime = GetCurrentTimeNanoseconds() - beginTime;
+
+        LockPlatformMutex(&pCapture->streamMutex);
+        pSlot->isQueued = false;
+        pCapture->writerSlot = (pCapture->writerSlot + 1) % pCapture->info.slotCount;
+        WakeAllPlatformConditionVariable(&pCapture->streamCondition);
+    }
+    UnlockPlatformMutex(&pCapture->streamMutex);
+}
+
+static bool OpenFrameCaptureStream(FrameCapture* pCapture)
+{
+    pCapture->pStream = OpenPlatformOutputStream(pCapture->path);
+    if (pCapture->pStream == NULL)
+    {
+        printf("Failed to open the frame stream %s!\n", pCapture->path);
+        return false;
+    }
+    if (pCapture->info.output == FRAME_CAPTURE_OUTPUT_Y4M_STREAM)
+    {
+        if (!pCapture->isYuvOnGpu)
+        {
+            pCapture->pYuvPlanes = malloc(GetYuv420FrameSize(pCapture->info.width, pCapture->info.height));
+            if (pCapture->pYuvPlanes == NULL)
+            {
+                puts("Failed to allocate the YUV planes of the frame stream!");
+                return false;
+            }
+        }
+        // Progressive, square pixels, full range 4:2:0 with the chroma centered between the luma samples
+        if (fprintf(pCapture->pStream, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg XCOLORRANGE=FULL\n", pCapture->info.width,
+            pCapture->info.height, pCapture->info.frameRate > 0 ? pCapture->info.frameRate : 60) < 0)
+        {
+            printf("Writing the header of the frame stream %s failed!\n", pCapture->path);
+            return false;
+        }
+    }
+
+    InitializePlatformMutex(&pCapture->streamMutex);
+    InitializePlatformConditionVariable(&pCapture->streamCondition);
+    pCapture->isWriterStarted = CreatePlatformThread(&pCapture->writerThread, RunStreamWriter, pCapture);
+    if (!pCapture->isWriterStarted)
+    {
+        DestroyPlatformConditionVariable(&pCapture->streamCondition);
+        DestroyPlatformMutex(&pCapture->streamMutex);
+        puts("Failed to start the frame stream writer!");
+        return false;
+    }
+    return true;
+}
+
+bool CreateFrameCapture(const FrameCaptureCreateInfo* pCreateInfo, FrameCapture* pCapture)
+{
+    memset(pCapture, 0, sizeof(*pCapture));
+    pCapture->info = *pCreateInfo;
+    pCapture->info.slotCount = pCreateInfo->slotCount < 1 ? 1 :
+                               pCreateInfo->slotCount > MAX_FRAME_CAPTURE_SLOT_COUNT ? MAX_FRAME_CAPTURE_SLOT_COUNT : pCreateInfo->slotCount;
+    const size_t pathLength = strlen(pCreateInfo->path);
+    if (pathLength >= sizeof(pCapture->path))
+    {
+        printf("Frame capture path '%s' is too long!\n", pCreateInfo->path);
+        return false;
+    }
+    memcpy(pCapture->path, pCreateInfo->path, pathLength + 1);
+    pCapture->info.path = pCapture->path;
+
+    // The row pitch MUST BE a whole number of texels as well
+    VkDeviceSize alignment = pCreateInfo->rowPitchAlignment > 0 ? pCreateInfo->rowPitchAlignment : 1;
+    while (alignment % 4 != 0) {
+        alignment *= 2;
+    }
+    pCapture->rowPitch = (uint32_t)(((VkDeviceSize)pCreateInfo->width * 4 + alignment - 1) / alignment * alignment);
+    pCapture->readbackSize = pCapture->rowPitch * pCreateInfo->height;
+
+    if (pCreateInfo->output == FRAME_CAPTURE_OUTPUT_Y4M_STREAM && pCreateInfo->yuvShaderModule != VK_NULL_HANDLE)
+    {
+        if (pCreateInfo->width % FRAME_CAPTURE_YUV_BLOCK_WIDTH == 0 && pCreateInfo->height % FRAME_CAPTURE_YUV_BLOCK_HEIGHT == 0)
+        {
+            pCapture->isYuvOnGpu = true;
+            pCapture->readbackSize = GetYuv420FrameSize(pCreateInfo->width, pCreateInfo->height);
+            if (!CreateYuvConversionPipeline(pCapture))
+            {
+                DestroyFrameCapture(pCapture);
+                return false;
+            }
+        }
+        else {
+            printf("%ux%u is not a multiple of %ux%u, so the frames are converted to YUV on the CPU.\n", pCreateInfo->width, pCreateInfo->height,
+                FRAME_CAPTURE_YUV_BLOCK_WIDTH, FRAME_CAPTURE_YUV_BLOCK_HEIGHT);
+        }
+    }
+    // Only needed by the pipeline, so the caller may destroy it right away
+    pCapture->info.yuvShaderModule = VK_NULL_HANDLE;
+
+    // Every slot command buffer is re-recorded once its fence is signaled
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = pCreateInfo->queueFamilyIndex
+    };
+    VkResult res = vkCreateCommandPool(pCreateInfo->device, &commandPoolCreateInfo, pCreateInfo->pAllocator, &pCapture->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool for frame capture failed: %d\n", res);
+        DestroyFrameCapture(pCapture);
+        return false;
+    }
+
+    VkCommandBuffer commandBuffers[MAX_FRAME_CAPTURE_SLOT_COUNT];
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pCapture->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = pCapture->info.slotCount
+    };
+    res = vkAllocateCommandBuffers(pCreateInfo->device, &cmdBufAllocInfo, commandBuffers);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers for frame capture failed: %d\n", res);
+        DestroyFrameCapture(pCapture);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < pCapture->info.slotCount; ++i)
+    {
+        if (!CreateFrameCaptureSlot(pCapture, &pCapture->slots[i], commandBuffers[i]))
+        {
+            DestroyFrameCapture(pCapture);
+            return false;
+        }
+    }
+
+    if (IsStreamOutput(pCreateInfo->output) && !OpenFrameCaptureStream(pCapture))
+    {
+        DestroyFrameCapture(pCapture);
+        return false;
+    }
+    return true;
+}
+
+static void EncodeCapturedFrame(void* pUserData, uint32_t workerIndex)
+{
+    (void)workerIndex;
+    FrameCaptureSlot* pSlot = pUserData;
+    const FrameCapture* pCapture = pSlot->pCapture;
+
+    const uint64_t beginTime = GetCurrentTimeNanoseconds();
+    char path[MAX_FRAME_CAPTURE_PATH_LENGTH + 32];
+    snprintf(path, sizeof(path), "%s_%06llu.%s", pCapture->path, (unsigned long long)pSlot->frameNumber,
+        GetImageFileFormatName(pCapture->info.fileFormat));
+    pSlot->isWritten = WriteImageFile(path, pCapture->info.fileFormat, pSlot->pData, pCapture->info.width, pCapture->info.height,
+        pCapture->rowPitch);
+    pSlot->encodeTime = GetCurrentTimeNanoseconds() - beginTime;
+}
+
+// The copy of the slot has completed, so its pixels are handed to an encode job or to the stream writer.
+static void BeginEncodingSlot(FrameCapture* pCapture, FrameCaptureSlot* pSlot)
+{
+    vkResetFences(pCapture->info.device, 1, &pSlot->fence);
+    if (!pCapture->isMemoryCoherent)
+    {
+        const VkMappedMemoryRange range = {
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext = NULL,
+            .memory = pSlot->memory,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE
+        };
+        vkInvalidateMappedMemoryRanges(pCapture->info.device, 1, &range);
+    }
+    pSlot->state = FRAME_CAPTURE_SLOT_ENCODING;
+    if (IsStreamOutput(pCapture->info.output))
+    {
+        LockPlatformMutex(&pCapture->streamMutex);
+        pSlot->isQueued = true;
+        WakeAllPlatformConditionVariable(&pCapture->streamCondition);
+        UnlockPlatformMutex(&pCapture->streamMutex);
+    }
+    else {
+        SubmitJob(pCapture->info.pJobSystem, 0, EncodeCapturedFrame, pSlot, &pSlot->encodeCounter);
+    }
+}
+
+// Returns true once the stream writer is done with the slot. Waiting blocks on the reader of the stream, which is the backpressure.
+static bool IsSlotStreamed(FrameCapture* pCapture, FrameCaptureSlot* pSlot, bool wait)
+{
+    LockPlatformMutex(&pCapture->streamMutex);
+    while (wait && pSlot->isQueued) {
+        WaitPlatformConditionVariable(&pCapture->streamCondition, &pCapture->streamMutex);
+    }
+    const bool isStreamed = !pSlot->isQueued;
+    UnlockPlatformMutex(&pCapture->streamMutex);
+    return isStreamed;
+}
+
+static void FreeEncodedSlot(FrameCapture* pCapture, FrameCaptureSlot* pSlot)
+{
+    if (pSlot->isWritten) {
+        ++pCapture->writtenFrameCount;
+    }
+    else {
+        ++pCapture->failedFrameCount;
+    }
+    pCapture->totalEncodeTime += pSlot->encodeTime;
+    if (pSlot->encodeTime > pCapture->maxEncodeTime) {
+        pCapture->maxEncodeTime = pSlot->encodeTime;
+    }
+    pSlot->state = FRAME_CAPTURE_SLOT_FREE;
+}
+
+// Moves the slot on as far as it goes, waiting for its copy and its encoding if `wait` is true.
+static bool AdvanceFrameCaptureSlot(FrameCapture* pCapture, FrameCaptureSlot* pSlot, bool wait)
+{
+    if (pSlot->state == FRAME_CAPTURE_SLOT_COPYING)
+    {
+        const VkResult res = wait ? vkWaitForFences(pCapture->info.device, 1, &pSlot->fence, VK_TRUE, UINT64_MAX) :
+                                    vkGetFenceStatus(pCapture->info.device, pSlot->fence);
+        if (res == VK_NOT_READY) return true;
+        if (res != VK_SUCCESS)
+        {
+            printf("Waiting for frame capture copy failed: %d\n", res);
+            return false;
+        }
+        BeginEncodingSlot(pCapture, pSlot);
+    }
+    if (pSlot->state == FRAME_CAPTURE_SLOT_ENCODING)
+    {
+        if (IsStreamOutput(pCapture->info.output)) {
+            if (!IsSlotStreamed(pCapture, pSlot, wait)) return true;
+        }
+        else if (wait) {
+            // Runs the encoding on this thread if no other worker has taken it yet
+            WaitForJobCounter(pCapture->info.pJobSystem, 0, &pSlot->encodeCounter);
+        }
+        else if (PlatformAtomicLoad(&pSlot->encodeCounter.value) != 0) {
+            return true;
+        }
+        FreeEncodedSlot(pCapture, pSlot);
+    }
+    return true;
+}
+
+void PollFrameCaptures(FrameCapture* pCapture)
+{
+    for (uint32_t i = 0; i < pCapture->info.slotCount; ++i) {
+        AdvanceFrameCaptureSlot(pCapture, &pCapture->slots[i], false);
+    }
+}
+
+bool FinishFrameCaptures(FrameCapture* pCapture)
+{
+    // Oldest first, so the encoding of the newer frames overlaps the wait
+    bool succeeded = true;
+    for (uint32_t i = 0; i < pCapture->info.slotCount; ++i)
+    {
+        FrameCaptureSlot* pSlot = &pCapture->slots[(pCapture->nextSlot + i) % pCapture->info.slotCount];
+        if (!AdvanceFrameCaptureSlot(pCapture, pSlot, false)) {
+            succeeded = false;
+        }
+    }
+    for (uint32_t i = 0; i < pCapture->info.slotCount; ++i)
+    {
+        FrameCaptureSlot* pSlot = &pCapture->slots[(pCapture->nextSlot + i) % pCapture->info.slotCount];
+        if (!AdvanceFrameCaptureSlot(pCapture, pSlot, true)) {
+            succeeded = false;
+        }
+    }
+    return succeeded && pCapture->failedFrameCount == 0;
+}
+
+void DestroyFrameCapture(FrameCapture* pCapture)
+{
+    const VkDevice device = pCapture->info.device;
+    if (device == VK_NULL_HANDLE) return;
+
+    FinishFrameCaptures(pCapture);
+    if (pCapture->isWriterStarted)
+    {
+        LockPlatformMutex(&pCapture->streamMutex);
+        pCapture->isWriterExiting = true;
+        WakeAllPlatformConditionVariable(&pCapture->streamCondition);
+        UnlockPlatformMutex(&pCapture->streamMutex);
+        JoinPlatformThread(pCapture->writerThread);
+        DestroyPlatformConditionVariable(&pCapture->streamCondition);
+        DestroyPlatformMutex(&pCapture->streamMutex);
+    }
+    if (pCapture->pStream != NULL) {
+        fclose(pCapture->pStream);
+    }
+    free(pCapture->pYuvPlanes);
+
+    for (uint32_t i = 0; i < pCapture->info.slotCount; ++i)
+    {
+        FrameCaptureSlot* pSlot = &pCapture->slots[i];
+        if (pSlot->fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, pSlot->fence, pCapture->info.pAllocator);
+        }
+        if (pSlot->buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, pSlot->buffer, pCapture->info.pAllocator);
+        }
+        if (pSlot->memory != VK_NULL_HANDLE)
+        {
+            // Implicitly unmapped
+            if (pCapture->info.pMemoryTracker != NULL) {
+                FreeTrackedDeviceMemory(pCapture->info.pMemoryTracker, pSlot->memory);
+            }
+            else {
+                vkFreeMemory(device, pSlot->memory, pCapture->info.pAllocator);
+            }
+        }
+    }
+    if (pCapture->commandPool != VK_NULL_HANDLE) {
+        // The slot command buffers are freed together with their pool
+        vkDestroyCommandPool(device, pCapture->commandPool, pCapture->info.pAllocator);
+    }
+    if (pCapture->yuvDescriptorPool != VK_NULL_HANDLE) {
+        // Also frees the slot descriptor sets
+        vkDestroyDescriptorPool(device, pCapture->yuvDescriptorPool, pCapture->info.pAllocator);
+    }
+    if (pCapture->yuvPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(device, pCapture->yuvPipeline, pCapture->info.pAllocator);
+    }
+    if (pCapture->yuvPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(device, pCapture->yuvPipelineLayout, pCapture->info.pAllocator);
+    }
+    if (pCapture->yuvDescSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(device, pCapture->yuvDescSetLayout, pCapture->info.pAllocator);
+    }
+    memset(pCapture, 0, sizeof(*pCapture));
+}
+
+static void RecordFrameCaptureCopy(const FrameCapture* pCapture, VkCommandBuffer cmdBuf, VkImage image, VkBuffer buffer)
+{
+    // The rendering wrote the image before it was transitioned to VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+    const VkImageMemoryBarrier imageBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL,
+        1, &imageBarrier);
+
+    const VkBufferImageCopy region = {
+        .bufferOffset = 0,
+        // In texels
+        .bufferRowLength = pCapture->rowPitch / 4,
+        .bufferImageHeight = pCapture->info.height,
+        .imageSubresource = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .mipLevel = 0,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { pCapture->info.width, pCapture->info.height, 1 }
+    };
+    vkCmdCopyImageToBuffer(cmdBuf, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
+
+    const VkBufferMemoryBarrier bufferBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+}
+
+static void RecordFrameCaptureYuvConversion(const FrameCapture* pCapture, VkCommandBuffer cmdBuf, VkImage image, const FrameCaptureSlot* pSlot)
+{
+    // Another capture of the same image may still be copying it, so the layout transition also waits for the transfer stage
+    const VkImageMemoryBarrier imageBarrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+        .newLayout = VK_IMAGE_LAYOUT_GENERAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = 1,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &imageBarrier);
+
+    const YuvPushConstants pushConstants = { .width = pCapture->info.width, .height = pCapture->info.height };
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pCapture->yuvPipeline);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, pCapture->yuvPipelineLayout, 0, 1, &pSlot->yuvDescriptorSet, 0, NULL);
+    vkCmdPushConstants(cmdBuf, pCapture->yuvPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    const uint32_t blockCountX = pCapture->info.width / FRAME_CAPTURE_YUV_BLOCK_WIDTH;
+    const uint32_t blockCountY = pCapture->info.height / FRAME_CAPTURE_YUV_BLOCK_HEIGHT;
+    vkCmdDispatch(cmdBuf, (blockCountX + FRAME_CAPTURE_YUV_WORKGROUP_SIZE - 1) / FRAME_CAPTURE_YUV_WORKGROUP_SIZE,
+        (blockCountY + FRAME_CAPTURE_YUV_WORKGROUP_SIZE - 1) / FRAME_CAPTURE_YUV_WORKGROUP_SIZE, 1);
+
+    const VkBufferMemoryBarrier bufferBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = pSlot->buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &bufferBarrier, 0, NULL);
+}
+
+bool CaptureFrame(FrameCapture* pCapture, VkImage image, VkImageView imageView, uint64_t frameNumber)
+{
+    PollFrameCaptures(pCapture);
+
+    FrameCaptureSlot* pSlot = &pCapture->slots[pCapture->nextSlot];
+    if (pSlot->state != FRAME_CAPTURE_SLOT_FREE)
+    {
+        // The ring is too small for the speed of the encoders or the reader of the stream
+        const uint64_t beginTime = GetCurrentTimeNanoseconds();
+        const bool isAdvanced = AdvanceFrameCaptureSlot(pCapture, pSlot, true);
+        pCapture->stallTime += GetCurrentTimeNanoseconds() - beginTime;
+        ++pCapture->stallCount;
+        if (!isAdvanced) return false;
+    }
+
+    if (pCapture->isYuvOnGpu)
+    {
+        // The slot is free, so its set is no longer in use
+        const VkDescriptorImageInfo imageInfo = { .sampler = VK_NULL_HANDLE, .imageView = imageView, .imageLayout = VK_IMAGE_LAYOUT_GENERAL };
+        const VkWriteDescriptorSet write = {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = pSlot->yuvDescriptorSet,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,
+            .pImageInfo = &imageInfo,
+            .pBufferInfo = NULL,
+            .pTexelBufferView = NULL
+        };
+        vkUpdateDescriptorSets(pCapture->info.device, 1, &write, 0, NULL);
+    }
+
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+    // Implicitly resets the command buffer
+    VkResult res = vkBeginCommandBuffer(pSlot->commandBuffer, &beginInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer for frame capture failed: %d\n", res);
+        return false;
+    }
+    if (pCapture->isYuvOnGpu) {
+        RecordFrameCaptureYuvConversion(pCapture, pSlot->commandBuffer, image, pSlot);
+    }
+    else {
+        RecordFrameCaptureCopy(pCapture, pSlot->commandBuffer, image, pSlot->buffer);
+    }
+    res = vkEndCommandBuffer(pSlot->commandBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pSlot->commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    res = vkQueueSubmit(pCapture->info.queue, 1, &submitInfo, pSlot->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for frame capture failed: %d\n", res);
+        return false;
+    }
+
+    pSlot->state = FRAME_CAPTURE_SLOT_COPYING;
+    pSlot->frameNumber = frameNumber;
+    pSlot->isWritten = false;
+    pSlot->encodeTime = 0;
+    pCapture->nextSlot = (pCapture->nextSlot + 1) % pCapture->info.slotCount;
+    ++pCapture->capturedFrameCount;
+    return true;
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "job_system.h"
+#include "image_writer.h"
+#include "platform_utils.h"
+#include "memory_tracker.h"
+
+enum FRAME_CAPTURE_CONSTANTS
+{
+    MAX_FRAME_CAPTURE_SLOT_COUNT = 16,
+    MAX_FRAME_CAPTURE_PATH_LENGTH = 260,
+    // Every invocation of rgb_to_yuv.comp.glsl converts a block of 8x2 pixels, so the GPU conversion requires a width multiple of 8
+    // and an even height.
+    FRAME_CAPTURE_YUV_BLOCK_WIDTH = 8,
+    FRAME_CAPTURE_YUV_BLOCK_HEIGHT = 2,
+    // MUST BE the same as the local size of rgb_to_yuv.comp.glsl in both dimensions
+    FRAME_CAPTURE_YUV_WORKGROUP_SIZE = 8
+};
+
+typedef enum FrameCaptureOutput
+{
+    // Every frame is encoded into its own image file by a job
+    FRAME_CAPTURE_OUTPUT_IMAGE_FILES,
+    // Every frame is appended to one stream in capture order as tightly packed RGBA8 rows, without any header
+    FRAME_CAPTURE_OUTPUT_RGBA_STREAM,
+    // A YUV4MPEG2 stream of full range 4:2:0 frames, as read by ffmpeg and most encoders
+    FRAME_CAPTURE_OUTPUT_Y4M_STREAM
+} FrameCaptureOutput;
+
+typedef struct FrameCaptureCreateInfo
+{
+    VkDevice device;
+    // The callbacks every object of the capture is created with, NULL for none
+    const VkAllocationCallbacks* pAllocator;
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties;
+    // Allocates the readback buffers if not NULL
+    DeviceMemoryTracker* pMemoryTracker;
+    // The queue rendering the captured images. It MUST BE externally synchronized with the other users of it.
+    VkQueue queue;
+    uint32_t queueFamilyIndex;
+    // Captured images are VK_FORMAT_R8G8B8A8_UNORM images of this size
+    uint32_t width;
+    uint32_t height;
+    // VkPhysicalDeviceLimits::optimalBufferCopyRowPitchAlignment
+    VkDeviceSize rowPitchAlignment;
+    // Frames being copied or encoded at the same time, at most MAX_FRAME_CAPTURE_SLOT_COUNT
+    uint32_t slotCount;
+    FrameCaptureOutput output;
+    // Image files: runs the encoding. Captures are made on worker 0, so the other workers pick the encoding up in the background.
+    JobSystem* pJobSystem;
+    ImageFileFormat fileFormat;
+    // Image files: frame n is written to "<path>_<n>.<format name>", with n padded to 6 digits.
+    // Streams: the file or pipe the frames are written to, see OpenPlatformOutputStream.
+    const char* path;
+    // Y4M stream: frames per second stated in the stream header
+    uint32_t frameRate;
+    // Y4M stream: converts the frames in a compute shader before the readback, which reads back 1.5 instead of 4 bytes per pixel.
+    // The captured images MUST have VK_IMAGE_USAGE_STORAGE_BIT then. Ignored if the size does not fit FRAME_CAPTURE_YUV_BLOCK_WIDTH
+    // and FRAME_CAPTURE_YUV_BLOCK_HEIGHT, VK_NULL_HANDLE converts the frames on the writer thread.
+    VkShaderModule yuvShaderModule;
+} FrameCaptureCreateInfo;
+
+typedef enum FrameCaptureSlotState
+{
+    FRAME_CAPTURE_SLOT_FREE,
+    // The copy into the buffer is submitted and its fence is not known to be signaled yet
+    FRAME_CAPTURE_SLOT_COPYING,
+    // An encode job or the stream writer reads the buffer
+    FRAME_CAPTURE_SLOT_ENCODING
+} FrameCaptureSlotState;
+
+typedef struct FrameCaptureSlot
+{
+    struct FrameCapture* pCapture;
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    // Mapped for the lifetime of the slot, the encode job reads the pixels in place.
+    const uint8_t* pData;
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    // Refers to the buffer and to the captured image view, only with the GPU YUV conversion
+    VkDescriptorSet yuvDescriptorSet;
+    FrameCaptureSlotState state;
+    uint64_t frameNumber;
+    // Drops to 0 once the encode job has finished
+    JobCounter encodeCounter;
+    // Streams: set while the slot waits for or is being written by the writer thread, guarded by FrameCapture::streamMutex
+    bool isQueued;
+    // Written by the encode job or the stream writer
+    uint64_t encodeTime;
+    bool isWritten;
+} FrameCaptureSlot;
+
+// Reads rendered frames back without stalling the queue. Every capture copies the image into the host visible buffer of the next slot
+// of a ring, the copy is picked up by a later capture once its fence is signaled, and the file is encoded and written by a job.
+// Streams are written by a writer thread instead, which takes the slots in ring order, so the frames stay in capture order and a slow
+// reader of the stream throttles the captures rather than piling frames up in memory.
+// A capture only waits if the slot it reuses is still being copied, encoded or written. Not thread safe, only used on worker 0.
+typedef struct FrameCapture
+{
+    FrameCaptureCreateInfo info;
+    char path[MAX_FRAME_CAPTURE_PATH_LENGTH];
+    // Bytes between the rows of a captured frame
+    uint32_t rowPitch;
+    // Bytes read back per frame
+    uint32_t readbackSize;
+    // Host cached memory is preferred, since the encoders read every byte of it, but is not necessarily coherent.
+    bool isMemoryCoherent;
+    VkCommandPool commandPool;
+    FrameCaptureSlot slots[MAX_FRAME_CAPTURE_SLOT_COUNT];
+    // Slots are used in order, so the next slot is also the oldest one in use
+    uint32_t nextSlot;
+
+    // The GPU YUV conversion, the readback buffers hold the Y, U and V planes then
+    bool isYuvOnGpu;
+    VkDescriptorSetLayout yuvDescSetLayout;
+    VkPipelineLayout yuvPipelineLayout;
+    VkPipeline yuvPipeline;
+    VkDescriptorPool yuvDescriptorPool;
+
+    FILE* pStream;
+    PlatformThread writerThread;
+    bool isWriterStarted;
+    PlatformMutex streamMutex;
+    // Signaled when a slot is queued, written or when the writer has to exit
+    PlatformConditionVariable streamCondition;
+    // Guarded by streamMutex
+    bool isWriterExiting;
+    // Only touched by the writer thread: the next slot to write and the Y, U and V planes converted on the CPU
+    uint32_t writerSlot;
+    uint8_t* pYuvPlanes;
+    uint64_t streamedByteCount;
+
+    uint32_t capturedFrameCount;
+    uint32_t writtenFrameCount;
+    uint32_t failedFrameCount;
+    // Captures that found their slot still in use and waited for it
+    uint32_t stallCount;
+    uint64_t stallTime;
+    uint64_t totalEncodeTime;
+    uint64_t maxEncodeTime;
+} FrameCapture;
+
+extern bool CreateFrameCapture(const FrameCaptureCreateInfo* pCreateInfo, FrameCapture* pCapture);
+// Waits for the captures in flight to be written.
+extern void DestroyFrameCapture(FrameCapture* pCapture);
+
+// Returns the image file format name, or "rgba" and "y4m" for the streams.
+extern const char* GetFrameCaptureFormatName(const FrameCapture* pCapture);
+
+// Submits the copy of `image` to the queue after the commands rendering it, which MUST leave it in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+// A render pass rendering into `image` again MUST wait for VK_PIPELINE_STAGE_TRANSFER_BIT. With the GPU YUV conversion, `imageView`
+// is read by a compute shader instead, which leaves the image in VK_IMAGE_LAYOUT_GENERAL, and the render pass MUST wait for
+// VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT. Called on worker 0 only.
+extern bool CaptureFrame(FrameCapture* pCapture, VkImage image, VkImageView imageView, uint64_t frameNumber);
+// Hands the completed copies to the encoders or the stream writer and frees the slots of the written frames without blocking.
+extern void PollFrameCaptures(FrameCapture* pCapture);
+// Waits until every captured frame has been written. Returns false if any of them failed.
+extern bool FinishFrameCaptures(FrameCapture* pCapture);
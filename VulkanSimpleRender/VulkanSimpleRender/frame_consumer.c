@@ -0,0 +1,756 @@
+// frame_consumer.c : a separate program receiving the frames of VulkanSimpleRender --benchmark --export=<socket path>.
+// The memory of the render targets is imported once, every frame is then read in place on the GPU and released back to the renderer.
+// Only a single pixel of every frame is copied, to show that the frames arrive.
+//
+// Built on its own, since it has a main function of its own:
+//   gcc -std=gnu17 -O2 frame_consumer.c frame_export.c platform_utils.c -o frame_consumer -lvulkan -lpthread
+// Run it next to the renderer, in either order:
+//   frame_consumer <socket path> [milliseconds to hold every frame]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <vulkan/vulkan.h>
+
+#include "platform_utils.h"
+#include "frame_export.h"
+
+#ifdef _WIN32
+
+int main(void)
+{
+    puts("frame_consumer only runs on Linux, where the frames are exported as file descriptors!");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+enum FRAME_CONSUMER_CONSTANTS
+{
+    MAX_CONSUMER_GPU_COUNT = 8,
+    // The renderer may start after the consumer
+    CONNECT_RETRY_COUNT = 100,
+    CONNECT_RETRY_INTERVAL_MS = 100,
+    // Frames of which the probed pixel is printed
+    PRINTED_FRAME_COUNT = 3
+};
+
+typedef struct FrameConsumer
+{
+    int socketFd;
+    FrameExportMessage hello;
+
+    VkInstance instance;
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    uint32_t queueFamilyIndex;
+    VkQueue queue;
+    PFN_vkImportSemaphoreFdKHR vkImportSemaphoreFdKHR;
+
+    // The render targets of the renderer, bound to the imported memory
+    VkImage images[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    VkDeviceMemory memories[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    VkSemaphore semaphores[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    VkCommandPool commandPool;
+    // Acquire the image from VK_QUEUE_FAMILY_EXTERNAL, read it and release it again
+    VkCommandBuffer commandBuffers[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    VkFence fence;
+    // The center pixel of every image
+    VkBuffer probeBuffer;
+    VkDeviceMemory probeMemory;
+    const uint8_t* pProbe;
+
+    uint32_t consumedFrameCount;
+    uint64_t totalReadTime;
+    uint64_t maxReadTime;
+} FrameConsumer;
+
+static bool ConnectToRenderer(FrameConsumer* pConsumer, const char* socketPath)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    const size_t socketPathLength = strlen(socketPath);
+    if (socketPathLength >= sizeof(address.sun_path))
+    {
+        printf("Socket path '%s' is too long!\n", socketPath);
+        return false;
+    }
+    memcpy(address.sun_path, socketPath, socketPathLength + 1);
+
+    pConsumer->socketFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (pConsumer->socketFd < 0)
+    {
+        printf("Creating the socket failed: %d\n", errno);
+        return false;
+    }
+    for (uint32_t i = 0; i < CONNECT_RETRY_COUNT; ++i)
+    {
+        if (connect(pConsumer->socketFd, (const struct sockaddr*)&address, sizeof(address)) == 0) return true;
+
+        const struct timespec interval = { .tv_sec = 0, .tv_nsec = CONNECT_RETRY_INTERVAL_MS * 1000000L };
+        nanosleep(&interval, NULL);
+    }
+    printf("Connecting to %s failed: %d\n", socketPath, errno);
+    return false;
+}
+
+static bool ReceiveHello(FrameConsumer* pConsumer, int* pFds, uint32_t* pFdCount)
+{
+    FrameExportMessage* pHello = &pConsumer->hello;
+    if (!ReceiveFrameExportMessage(pConsumer->socketFd, pHello, pFds, MAX_FRAME_EXPORT_FD_COUNT, pFdCount) ||
+        pHello->type != FRAME_EXPORT_MESSAGE_HELLO)
+    {
+        puts("The renderer did not send the exported images!");
+        return false;
+    }
+    const uint32_t semaphoreFdCount = pHello->semaphoreHandleType == VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT ? pHello->imageCount : 0;
+    if (pHello->imageCount == 0 || pHello->imageCount > MAX_FRAME_EXPORT_IMAGE_COUNT || *pFdCount != pHello->imageCount + semaphoreFdCount)
+    {
+        printf("Unexpected %u descriptors for %u exported images!\n", *pFdCount, pHello->imageCount);
+        return false;
+    }
+    printf("Receiving %u images of %ux%u as %s memory with %s semaphores\n", pHello->imageCount, pHello->width, pHello->height,
+        GetExternalMemoryHandleTypeName((VkExternalMemoryHandleTypeFlagBits)pHello->memoryHandleType),
+        GetExternalSemaphoreHandleTypeName((VkExternalSemaphoreHandleTypeFlagBits)pHello->semaphoreHandleType));
+    return true;
+}
+
+static bool CreateConsumerDevice(FrameConsumer* pConsumer)
+{
+    const VkApplicationInfo appInfo = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pNext = NULL,
+        .pApplicationName = "frame_consumer",
+        .applicationVersion = 1,
+        .pEngineName = NULL,
+        .engineVersion = 0,
+        .apiVersion = VK_API_VERSION_1_1
+    };
+    const VkInstanceCreateInfo instanceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .pApplicationInfo = &appInfo,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL,
+        .enabledExtensionCount = 0,
+        .ppEnabledExtensionNames = NULL
+    };
+    VkResult res = vkCreateInstance(&instanceCreateInfo, NULL, &pConsumer->instance);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateInstance failed: %d\n", res);
+        return false;
+    }
+
+    // Opaque handles can only be imported by the device and driver that exported them
+    VkPhysicalDevice physicalDevices[MAX_CONSUMER_GPU_COUNT];
+    uint32_t gpuCount = MAX_CONSUMER_GPU_COUNT;
+    res = vkEnumeratePhysicalDevices(pConsumer->instance, &gpuCount, physicalDevices);
+    if (res != VK_SUCCESS && res != VK_INCOMPLETE)
+    {
+        printf("vkEnumeratePhysicalDevices failed: %d\n", res);
+        return false;
+    }
+    for (uint32_t i = 0; i < gpuCount && pConsumer->physicalDevice == VK_NULL_HANDLE; ++i)
+    {
+        VkPhysicalDeviceIDProperties idProps = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+            .pNext = NULL
+        };
+        VkPhysicalDeviceProperties2 properties2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+            .pNext = &idProps
+        };
+        vkGetPhysicalDeviceProperties2(physicalDevices[i], &properties2);
+        if (memcmp(idProps.deviceUUID, pConsumer->hello.deviceUUID, VK_UUID_SIZE) == 0 &&
+            memcmp(idProps.driverUUID, pConsumer->hello.driverUUID, VK_UUID_SIZE) == 0)
+        {
+            pConsumer->physicalDevice = physicalDevices[i];
+            printf("Use the device of the renderer: %s\n", properties2.properties.deviceName);
+        }
+    }
+    if (pConsumer->physicalDevice == VK_NULL_HANDLE)
+    {
+        puts("None of the devices is the one of the renderer!");
+        return false;
+    }
+
+    // Any queue can copy, and the ownership transfers from and to VK_QUEUE_FAMILY_EXTERNAL don't care which family it is.
+    VkQueueFamilyProperties queueFamilyProperties[16];
+    uint32_t queueFamilyCount = 16;
+    vkGetPhysicalDeviceQueueFamilyProperties(pConsumer->physicalDevice, &queueFamilyCount, queueFamilyProperties);
+    pConsumer->queueFamilyIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < queueFamilyCount && pConsumer->queueFamilyIndex == UINT32_MAX; ++i)
+    {
+        if ((queueFamilyProperties[i].queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) != 0) {
+            pConsumer->queueFamilyIndex = i;
+        }
+    }
+    if (pConsumer->queueFamilyIndex == UINT32_MAX)
+    {
+        puts("No queue family supports transfers!");
+        return false;
+    }
+
+    const char* extensionNames[3] = { VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME };
+    uint32_t extensionCount = 2;
+    if (pConsumer->hello.memoryHandleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT) {
+        extensionNames[extensionCount++] = VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME;
+    }
+    const float queuePriority = 1.0f;
+    const VkDeviceQueueCreateInfo queueInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = pConsumer->queueFamilyIndex,
+        .queueCount = 1,
+        .pQueuePriorities = &queuePriority
+    };
+    const VkDeviceCreateInfo deviceInfo = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueCreateInfoCount = 1,
+        .pQueueCreateInfos = &queueInfo,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL,
+        .enabledExtensionCount = extensionCount,
+        .ppEnabledExtensionNames = extensionNames,
+        .pEnabledFeatures = NULL
+    };
+    res = vkCreateDevice(pConsumer->physicalDevice, &deviceInfo, NULL, &pConsumer->device);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDevice failed: %d\n", res);
+        return false;
+    }
+    vkGetDeviceQueue(pConsumer->device, pConsumer->queueFamilyIndex, 0, &pConsumer->queue);
+
+    pConsumer->vkImportSemaphoreFdKHR = (PFN_vkImportSemaphoreFdKHR)vkGetDeviceProcAddr(pConsumer->device, "vkImportSemaphoreFdKHR");
+    if (pConsumer->vkImportSemaphoreFdKHR == NULL)
+    {
+        puts("vkImportSemaphoreFdKHR is not available!");
+        return false;
+    }
+    return true;
+}
+
+// Takes the ownership of the descriptors, also of the ones left unimported after a failure.
+static bool ImportImagesAndSemaphores(FrameConsumer* pConsumer, int* pFds, uint32_t fdCount)
+{
+    const FrameExportMessage* pHello = &pConsumer->hello;
+    const VkExternalMemoryHandleTypeFlagBits memoryHandleType = (VkExternalMemoryHandleTypeFlagBits)pHello->memoryHandleType;
+    const VkExternalSemaphoreHandleTypeFlagBits semaphoreHandleType = (VkExternalSemaphoreHandleTypeFlagBits)pHello->semaphoreHandleType;
+    const VkExternalMemoryImageCreateInfo externalMemoryImageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+        .pNext = NULL,
+        .handleTypes = memoryHandleType
+    };
+    // MUST BE the same as the image created by the renderer
+    const VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = &externalMemoryImageCreateInfo,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = (VkFormat)pHello->format,
+        .extent = { pHello->width, pHello->height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = pHello->usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = NULL,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+
+    uint32_t fdIndex = 0;
+    bool succeeded = true;
+    for (uint32_t i = 0; i < pHello->imageCount && succeeded; ++i)
+    {
+        VkResult res = vkCreateImage(pConsumer->device, &imageCreateInfo, NULL, &pConsumer->images[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateImage for imported image @%u failed: %d\n", i, res);
+            succeeded = false;
+            break;
+        }
+        VkMemoryRequirements memoryRequirements = { 0 };
+        vkGetImageMemoryRequirements(pConsumer->device, pConsumer->images[i], &memoryRequirements);
+        if ((memoryRequirements.memoryTypeBits & (1U << pHello->memoryTypeIndex)) == 0U || memoryRequirements.size > pHello->allocationSizes[i])
+        {
+            printf("The exported memory of image @%u does not fit the imported image!\n", i);
+            succeeded = false;
+            break;
+        }
+
+        const VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+            .pNext = NULL,
+            .image = pConsumer->images[i],
+            .buffer = VK_NULL_HANDLE
+        };
+        const VkImportMemoryFdInfoKHR importInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_MEMORY_FD_INFO_KHR,
+            .pNext = &dedicatedAllocateInfo,
+            .handleType = memoryHandleType,
+            .fd = pFds[fdIndex]
+        };
+        const VkMemoryAllocateInfo memAllocInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = &importInfo,
+            .allocationSize = pHello->allocationSizes[i],
+            .memoryTypeIndex = pHello->memoryTypeIndex
+        };
+        res = vkAllocateMemory(pConsumer->device, &memAllocInfo, NULL, &pConsumer->memories[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateMemory importing image @%u failed: %d\n", i, res);
+            succeeded = false;
+            break;
+        }
+        // Owned by the driver once imported
+        ++fdIndex;
+        res = vkBindImageMemory(pConsumer->device, pConsumer->images[i], pConsumer->memories[i], 0);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBindImageMemory for imported image @%u failed: %d\n", i, res);
+            succeeded = false;
+        }
+    }
+    // The semaphore descriptors follow all of the memory ones
+    fdIndex = succeeded ? pHello->imageCount : fdIndex;
+
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    for (uint32_t i = 0; i < pHello->imageCount && succeeded; ++i)
+    {
+        VkResult res = vkCreateSemaphore(pConsumer->device, &semaphoreCreateInfo, NULL, &pConsumer->semaphores[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore failed: %d\n", res);
+            succeeded = false;
+            break;
+        }
+        // Sync files are imported temporarily with every frame instead
+        if (semaphoreHandleType != VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT) continue;
+
+        const VkImportSemaphoreFdInfoKHR importInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+            .pNext = NULL,
+            .semaphore = pConsumer->semaphores[i],
+            .flags = 0,
+            .handleType = semaphoreHandleType,
+            .fd = pFds[fdIndex]
+        };
+        res = pConsumer->vkImportSemaphoreFdKHR(pConsumer->device, &importInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkImportSemaphoreFdKHR for image @%u failed: %d\n", i, res);
+            succeeded = false;
+            break;
+        }
+        ++fdIndex;
+    }
+
+    for (uint32_t i = fdIndex; i < fdCount; ++i) {
+        close(pFds[i]);
+    }
+    return succeeded;
+}
+
+static bool CreateProbeBuffer(FrameConsumer* pConsumer)
+{
+    const uint32_t imageCount = pConsumer->hello.imageCount;
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = imageCount * sizeof(uint32_t),
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 0,
+        .pQueueFamilyIndices = NULL
+    };
+    VkResult res = vkCreateBuffer(pConsumer->device, &bufferCreateInfo, NULL, &pConsumer->probeBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for the probe failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(pConsumer->device, pConsumer->probeBuffer, &memoryRequirements);
+    VkPhysicalDeviceMemoryProperties memoryProperties = { 0 };
+    vkGetPhysicalDeviceMemoryProperties(pConsumer->physicalDevice, &memoryProperties);
+    const VkMemoryPropertyFlags requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    uint32_t memoryTypeIndex;
+    for (memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
+    {
+        if ((memoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) != 0U &&
+            (memoryProperties.memoryTypes[memoryTypeIndex].propertyFlags & requiredFlags) == requiredFlags) {
+            break;
+        }
+    }
+    if (memoryTypeIndex == memoryProperties.memoryTypeCount)
+    {
+        puts("No host coherent memory type is suitable for the probe!");
+        return false;
+    }
+    const VkMemoryAllocateInfo memAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = NULL,
+        .allocationSize = memoryRequirements.size,
+        .memoryTypeIndex = memoryTypeIndex
+    };
+    res = vkAllocateMemory(pConsumer->device, &memAllocInfo, NULL, &pConsumer->probeMemory);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for the probe failed: %d\n", res);
+        return false;
+    }
+    res = vkBindBufferMemory(pConsumer->device, pConsumer->probeBuffer, pConsumer->probeMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory for the probe failed: %d\n", res);
+        return false;
+    }
+    void* pData = NULL;
+    res = vkMapMemory(pConsumer->device, pConsumer->probeMemory, 0, VK_WHOLE_SIZE, 0, &pData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for the probe failed: %d\n", res);
+        return false;
+    }
+    pConsumer->pProbe = pData;
+    return true;
+}
+
+static bool RecordReadCommands(FrameConsumer* pConsumer)
+{
+    const FrameExportMessage* pHello = &pConsumer->hello;
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = pConsumer->queueFamilyIndex
+    };
+    VkResult res = vkCreateCommandPool(pConsumer->device, &commandPoolCreateInfo, NULL, &pConsumer->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool failed: %d\n", res);
+        return false;
+    }
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pConsumer->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = pHello->imageCount
+    };
+    res = vkAllocateCommandBuffers(pConsumer->device, &cmdBufAllocInfo, pConsumer->commandBuffers);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers failed: %d\n", res);
+        return false;
+    }
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0
+    };
+    res = vkCreateFence(pConsumer->device, &fenceCreateInfo, NULL, &pConsumer->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateFence failed: %d\n", res);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < pHello->imageCount; ++i)
+    {
+        const VkCommandBuffer commandBuffer = pConsumer->commandBuffers[i];
+        const VkCommandBufferBeginInfo beginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .pInheritanceInfo = NULL
+        };
+        res = vkBeginCommandBuffer(commandBuffer, &beginInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBeginCommandBuffer failed: %d\n", res);
+            return false;
+        }
+
+        // The acquire half of the ownership transfer released by the renderer, with the same layouts
+        VkImageMemoryBarrier barrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL,
+            .dstQueueFamilyIndex = pConsumer->queueFamilyIndex,
+            .image = pConsumer->images[i],
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+        // A real consumer would sample, encode or scan the image out here
+        const VkBufferImageCopy region = {
+            .bufferOffset = i * sizeof(uint32_t),
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .mipLevel = 0,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            },
+            .imageOffset = { (int32_t)(pHello->width / 2), (int32_t)(pHello->height / 2), 0 },
+            .imageExtent = { 1, 1, 1 }
+        };
+        vkCmdCopyImageToBuffer(commandBuffer, pConsumer->images[i], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pConsumer->probeBuffer, 1, &region);
+
+        // Released back, the renderer discards the contents when it renders into the image again
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = 0;
+        barrier.srcQueueFamilyIndex = pConsumer->queueFamilyIndex;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+        const VkBufferMemoryBarrier probeBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = pConsumer->probeBuffer,
+            .offset = region.bufferOffset,
+            .size = sizeof(uint32_t)
+        };
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &probeBarrier, 0, NULL);
+
+        res = vkEndCommandBuffer(commandBuffer);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkEndCommandBuffer failed: %d\n", res);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Reads the frame in the image once the renderer has finished it, and waits until the read is done.
+static bool ConsumeFrame(FrameConsumer* pConsumer, const FrameExportMessage* pMessage, int syncFd)
+{
+    const uint32_t imageIndex = pMessage->imageIndex;
+    if (pConsumer->hello.semaphoreHandleType == VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT)
+    {
+        // -1 stands for a signal that has already completed
+        const VkImportSemaphoreFdInfoKHR importInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMPORT_SEMAPHORE_FD_INFO_KHR,
+            .pNext = NULL,
+            .semaphore = pConsumer->semaphores[imageIndex],
+            .flags = VK_SEMAPHORE_IMPORT_TEMPORARY_BIT,
+            .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT,
+            .fd = syncFd
+        };
+        const VkResult res = pConsumer->vkImportSemaphoreFdKHR(pConsumer->device, &importInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkImportSemaphoreFdKHR for frame %llu failed: %d\n", (unsigned long long)pMessage->frameNumber, res);
+            if (syncFd >= 0) {
+                close(syncFd);
+            }
+            return false;
+        }
+    }
+
+    const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = &pConsumer->semaphores[imageIndex],
+        .pWaitDstStageMask = &waitStage,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pConsumer->commandBuffers[imageIndex],
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    VkResult res = vkQueueSubmit(pConsumer->queue, 1, &submitInfo, pConsumer->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit failed: %d\n", res);
+        return false;
+    }
+    // The renderer reuses the image as soon as it is released, so the read has to be complete by then.
+    res = vkWaitForFences(pConsumer->device, 1, &pConsumer->fence, VK_TRUE, UINT64_MAX);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkWaitForFences failed: %d\n", res);
+        return false;
+    }
+    vkResetFences(pConsumer->device, 1, &pConsumer->fence);
+
+    if (pConsumer->consumedFrameCount < PRINTED_FRAME_COUNT)
+    {
+        const uint8_t* pPixel = &pConsumer->pProbe[imageIndex * sizeof(uint32_t)];
+        printf("Frame %llu in image %u, center pixel: %u %u %u %u\n", (unsigned long long)pMessage->frameNumber, imageIndex,
+            pPixel[0], pPixel[1], pPixel[2], pPixel[3]);
+    }
+    return true;
+}
+
+static void DestroyFrameConsumer(FrameConsumer* pConsumer)
+{
+    if (pConsumer->socketFd >= 0) {
+        close(pConsumer->socketFd);
+    }
+    const VkDevice device = pConsumer->device;
+    if (device != VK_NULL_HANDLE)
+    {
+        vkDeviceWaitIdle(device);
+        if (pConsumer->fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, pConsumer->fence, NULL);
+        }
+        if (pConsumer->commandPool != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(device, pConsumer->commandPool, NULL);
+        }
+        if (pConsumer->probeBuffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(device, pConsumer->probeBuffer, NULL);
+        }
+        if (pConsumer->probeMemory != VK_NULL_HANDLE) {
+            vkFreeMemory(device, pConsumer->probeMemory, NULL);
+        }
+        for (uint32_t i = 0; i < MAX_FRAME_EXPORT_IMAGE_COUNT; ++i)
+        {
+            if (pConsumer->semaphores[i] != VK_NULL_HANDLE) {
+                vkDestroySemaphore(device, pConsumer->semaphores[i], NULL);
+            }
+            if (pConsumer->images[i] != VK_NULL_HANDLE) {
+                vkDestroyImage(device, pConsumer->images[i], NULL);
+            }
+            // Drops the reference of this process, the renderer still owns the memory
+            if (pConsumer->memories[i] != VK_NULL_HANDLE) {
+                vkFreeMemory(device, pConsumer->memories[i], NULL);
+            }
+        }
+        vkDestroyDevice(device, NULL);
+    }
+    if (pConsumer->instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(pConsumer->instance, NULL);
+    }
+    memset(pConsumer, 0, sizeof(*pConsumer));
+    pConsumer->socketFd = -1;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <socket path> [milliseconds to hold every frame]\n", argv[0]);
+        return 1;
+    }
+    // Holding the frames longer than the renderer takes to render them throttles the renderer
+    const uint32_t holdTime = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : 0;
+
+    FrameConsumer consumer;
+    memset(&consumer, 0, sizeof(consumer));
+    consumer.socketFd = -1;
+
+    int fds[MAX_FRAME_EXPORT_FD_COUNT];
+    uint32_t fdCount = 0;
+    bool succeeded = ConnectToRenderer(&consumer, argv[1]);
+    if (succeeded && !ReceiveHello(&consumer, fds, &fdCount))
+    {
+        for (uint32_t i = 0; i < fdCount; ++i) {
+            close(fds[i]);
+        }
+        succeeded = false;
+    }
+    if (succeeded && !CreateConsumerDevice(&consumer))
+    {
+        for (uint32_t i = 0; i < fdCount; ++i) {
+            close(fds[i]);
+        }
+        succeeded = false;
+    }
+    succeeded = succeeded && ImportImagesAndSemaphores(&consumer, fds, fdCount) && CreateProbeBuffer(&consumer) && RecordReadCommands(&consumer);
+
+    bool isEnded = false;
+    while (succeeded && !isEnded)
+    {
+        FrameExportMessage message;
+        int syncFd = -1;
+        uint32_t syncFdCount = 0;
+        if (!ReceiveFrameExportMessage(consumer.socketFd, &message, &syncFd, 1, &syncFdCount))
+        {
+            puts("The renderer has disconnected!");
+            succeeded = false;
+            break;
+        }
+        if (message.type == FRAME_EXPORT_MESSAGE_END)
+        {
+            isEnded = true;
+            continue;
+        }
+        if (message.type != FRAME_EXPORT_MESSAGE_FRAME || message.imageIndex >= consumer.hello.imageCount)
+        {
+            if (syncFdCount > 0) {
+                close(syncFd);
+            }
+            continue;
+        }
+
+        const uint64_t beginTime = GetCurrentTimeNanoseconds();
+        succeeded = ConsumeFrame(&consumer, &message, syncFdCount > 0 ? syncFd : -1);
+        if (succeeded && holdTime > 0)
+        {
+            const struct timespec interval = { .tv_sec = holdTime / 1000, .tv_nsec = (long)(holdTime % 1000) * 1000000L };
+            nanosleep(&interval, NULL);
+        }
+        const uint64_t readTime = GetCurrentTimeNanoseconds() - beginTime;
+        consumer.totalReadTime += readTime;
+        consumer.maxReadTime = readTime > consumer.maxReadTime ? readTime : consumer.maxReadTime;
+        ++consumer.consumedFrameCount;
+
+        const FrameExportMessage release = { .type = FRAME_EXPORT_MESSAGE_RELEASE, .imageIndex = message.imageIndex, .frameNumber = message.frameNumber };
+        if (succeeded && !SendFrameExportMessage(consumer.socketFd, &release, NULL, 0))
+        {
+            puts("The renderer has disconnected!");
+            succeeded = false;
+        }
+    }
+
+    if (consumer.consumedFrameCount > 0)
+    {
+        printf("Consumed %u frames in place, holding each for %.3f ms on average and %.3f ms at most\n", consumer.consumedFrameCount,
+            consumer.totalReadTime / 1000000.0 / consumer.consumedFrameCount, consumer.maxReadTime / 1000000.0);
+    }
+    DestroyFrameConsumer(&consumer);
+    return succeeded && isEnded ? 0 : 1;
+}
+
+#endif // _WIN32
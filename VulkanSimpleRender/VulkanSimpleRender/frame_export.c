@@ -0,0 +1,565 @@
+#include "frame_export.h"
+#include "platform_utils.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif // !_WIN32
+
+static_assert((int)MAX_FRAME_EXPORT_FD_COUNT <= (int)MAX_PLATFORM_SOCKET_FD_COUNT, "The hello message carries more descriptors than a socket packet can");
+
+bool ChooseFrameExportHandleTypes(VkPhysicalDevice physicalDevice, bool isDmaBufSupported, VkFormat format, VkImageUsageFlags usage,
+                                  VkExternalMemoryHandleTypeFlagBits* pMemoryHandleType,
+                                  VkExternalSemaphoreHandleTypeFlagBits* pSemaphoreHandleType)
+{
+    // dma-buf first, since other APIs and the kernel understand it too
+    const VkExternalMemoryHandleTypeFlagBits memoryHandleTypes[] = {
+        VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT, VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    bool isMemoryExportable = false;
+    for (uint32_t i = isDmaBufSupported ? 0 : 1; i < sizeof(memoryHandleTypes) / sizeof(memoryHandleTypes[0]) && !isMemoryExportable; ++i)
+    {
+        const VkPhysicalDeviceExternalImageFormatInfo externalFormatInfo = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_IMAGE_FORMAT_INFO,
+            .pNext = NULL,
+            .handleType = memoryHandleTypes[i]
+        };
+        const VkPhysicalDeviceImageFormatInfo2 formatInfo = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+            .pNext = &externalFormatInfo,
+            .format = format,
+            .type = VK_IMAGE_TYPE_2D,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = usage,
+            .flags = 0
+        };
+        VkExternalImageFormatProperties externalProperties = { .sType = VK_STRUCTURE_TYPE_EXTERNAL_IMAGE_FORMAT_PROPERTIES, .pNext = NULL };
+        VkImageFormatProperties2 properties = { .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2, .pNext = &externalProperties };
+        if (vkGetPhysicalDeviceImageFormatProperties2(physicalDevice, &formatInfo, &properties) == VK_SUCCESS &&
+            (externalProperties.externalMemoryProperties.externalMemoryFeatures & VK_EXTERNAL_MEMORY_FEATURE_EXPORTABLE_BIT) != 0)
+        {
+            *pMemoryHandleType = memoryHandleTypes[i];
+            isMemoryExportable = true;
+        }
+    }
+    if (!isMemoryExportable) return false;
+
+    // Sync files are exported per signal and can be polled without Vulkan, opaque binary semaphores are shared once
+    const VkExternalSemaphoreHandleTypeFlagBits semaphoreHandleTypes[] = {
+        VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT, VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT
+    };
+    for (uint32_t i = 0; i < sizeof(semaphoreHandleTypes) / sizeof(semaphoreHandleTypes[0]); ++i)
+    {
+        const VkPhysicalDeviceExternalSemaphoreInfo semaphoreInfo = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTERNAL_SEMAPHORE_INFO,
+            .pNext = NULL,
+            .handleType = semaphoreHandleTypes[i]
+        };
+        VkExternalSemaphoreProperties properties = { .sType = VK_STRUCTURE_TYPE_EXTERNAL_SEMAPHORE_PROPERTIES, .pNext = NULL };
+        vkGetPhysicalDeviceExternalSemaphoreProperties(physicalDevice, &semaphoreInfo, &properties);
+        const VkExternalSemaphoreFeatureFlags requiredFeatures = VK_EXTERNAL_SEMAPHORE_FEATURE_EXPORTABLE_BIT | VK_EXTERNAL_SEMAPHORE_FEATURE_IMPORTABLE_BIT;
+        if ((properties.externalSemaphoreFeatures & requiredFeatures) == requiredFeatures)
+        {
+            *pSemaphoreHandleType = semaphoreHandleTypes[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* GetExternalMemoryHandleTypeName(VkExternalMemoryHandleTypeFlagBits handleType)
+{
+    return handleType == VK_EXTERNAL_MEMORY_HANDLE_TYPE_DMA_BUF_BIT_EXT ? "dma-buf" : "opaque-fd";
+}
+
+const char* GetExternalSemaphoreHandleTypeName(VkExternalSemaphoreHandleTypeFlagBits handleType)
+{
+    return handleType == VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT ? "sync-fd" : "opaque-fd";
+}
+
+#ifdef _WIN32
+
+bool SendFrameExportMessage(int socketFd, const FrameExportMessage* pMessage, const int* pFds, uint32_t fdCount)
+{
+    (void)socketFd; (void)pMessage; (void)pFds; (void)fdCount;
+    return false;
+}
+
+bool ReceiveFrameExportMessage(int socketFd, FrameExportMessage* pMessage, int* pFds, uint32_t maxFdCount, uint32_t* pFdCount)
+{
+    (void)socketFd; (void)pMessage; (void)pFds; (void)maxFdCount; (void)pFdCount;
+    return false;
+}
+
+bool CreateFrameExport(const FrameExportCreateInfo* pCreateInfo, FrameExport* pExport)
+{
+    // Windows would export NT handles with VK_KHR_external_memory_win32 and duplicate them into the consumer process instead.
+    (void)pCreateInfo;
+    memset(pExport, 0, sizeof(*pExport));
+    puts("Frame export is only implemented with file descriptors on Linux!");
+    return false;
+}
+
+void DestroyFrameExport(FrameExport* pExport)
+{
+    memset(pExport, 0, sizeof(*pExport));
+}
+
+bool AcquireExportedImage(FrameExport* pExport, uint32_t imageIndex)
+{
+    (void)pExport; (void)imageIndex;
+    return false;
+}
+
+bool ExportFrame(FrameExport* pExport, uint32_t imageIndex, uint64_t frameNumber)
+{
+    (void)pExport; (void)imageIndex; (void)frameNumber;
+    return false;
+}
+
+#else
+
+bool SendFrameExportMessage(int socketFd, const FrameExportMessage* pMessage, const int* pFds, uint32_t fdCount)
+{
+    return fdCount <= MAX_FRAME_EXPORT_FD_COUNT && SendPlatformSocketPacket(socketFd, pMessage, sizeof(*pMessage), pFds, fdCount);
+}
+
+bool ReceiveFrameExportMessage(int socketFd, FrameExportMessage* pMessage, int* pFds, uint32_t maxFdCount, uint32_t* pFdCount)
+{
+    size_t packetSize = 0;
+    if (!ReceivePlatformSocketPacket(socketFd, pMessage, sizeof(*pMessage), &packetSize, pFds, maxFdCount, pFdCount)) return false;
+    if (packetSize == sizeof(*pMessage)) return true;
+
+    for (uint32_t i = 0; i < *pFdCount; ++i) {
+        close(pFds[i]);
+    }
+    *pFdCount = 0;
+    return false;
+}
+
+static bool CreateExportSemaphoresAndCommands(FrameExport* pExport)
+{
+    const VkDevice device = pExport->info.device;
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = pExport->info.queueFamilyIndex
+    };
+    VkResult res = vkCreateCommandPool(device, &commandPoolCreateInfo, pExport->info.pAllocator, &pExport->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool for frame export failed: %d\n", res);
+        return false;
+    }
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pExport->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = pExport->info.imageCount
+    };
+    res = vkAllocateCommandBuffers(device, &cmdBufAllocInfo, pExport->commandBuffers);
+    if (res == VK_SUCCESS) {
+        res = vkAllocateCommandBuffers(device, &cmdBufAllocInfo, pExport->acquireCommandBuffers);
+    }
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers for frame export failed: %d\n", res);
+        return false;
+    }
+
+    const VkExportSemaphoreCreateInfo exportSemaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXPORT_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .handleTypes = pExport->info.semaphoreHandleType
+    };
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = &exportSemaphoreCreateInfo,
+        .flags = 0
+    };
+    for (uint32_t i = 0; i < pExport->info.imageCount; ++i)
+    {
+        res = vkCreateSemaphore(device, &semaphoreCreateInfo, pExport->info.pAllocator, &pExport->semaphores[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore for frame export failed: %d\n", res);
+            return false;
+        }
+
+        // The same commands every time, since an image is only exported again after the consumer has waited for its previous export,
+        // which the previous acquisition was submitted before
+        const VkCommandBufferBeginInfo beginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .pInheritanceInfo = NULL
+        };
+        res = vkBeginCommandBuffer(pExport->commandBuffers[i], &beginInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBeginCommandBuffer for frame export failed: %d\n", res);
+            return false;
+        }
+        // The release half of the ownership transfer to the consumer, which acquires the image with the same barrier
+        const VkImageMemoryBarrier releaseBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = 0,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = pExport->info.queueFamilyIndex,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL,
+            .image = pExport->info.pImages[i],
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        vkCmdPipelineBarrier(pExport->commandBuffers[i], VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+            0, NULL, 0, NULL, 1, &releaseBarrier);
+        res = vkEndCommandBuffer(pExport->commandBuffers[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkEndCommandBuffer for frame export failed: %d\n", res);
+            return false;
+        }
+
+        // The acquire half of the transfer back from the consumer, which releases the image with the same layouts once its read is done.
+        // The render pass discards the contents, so only the ownership is taken back.
+        res = vkBeginCommandBuffer(pExport->acquireCommandBuffers[i], &beginInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBeginCommandBuffer for frame export failed: %d\n", res);
+            return false;
+        }
+        const VkImageMemoryBarrier acquireBarrier = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_EXTERNAL,
+            .dstQueueFamilyIndex = pExport->info.queueFamilyIndex,
+            .image = pExport->info.pImages[i],
+            .subresourceRange = releaseBarrier.subresourceRange
+        };
+        vkCmdPipelineBarrier(pExport->acquireCommandBuffers[i], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+            0, NULL, 0, NULL, 1, &acquireBarrier);
+        res = vkEndCommandBuffer(pExport->acquireCommandBuffers[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkEndCommandBuffer for frame export failed: %d\n", res);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool WaitForFrameConsumer(FrameExport* pExport)
+{
+    pExport->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (pExport->listenFd < 0)
+    {
+        printf("Creating the frame export socket failed: %d\n", errno);
+        return false;
+    }
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    memcpy(address.sun_path, pExport->socketPath, strlen(pExport->socketPath) + 1);
+    // A socket left behind by a previous run
+    unlink(pExport->socketPath);
+    if (bind(pExport->listenFd, (const struct sockaddr*)&address, sizeof(address)) != 0 || listen(pExport->listenFd, 1) != 0)
+    {
+        printf("Listening on %s failed: %d\n", pExport->socketPath, errno);
+        return false;
+    }
+
+    printf("Waiting for a frame consumer to connect to %s...\n", pExport->socketPath);
+    do {
+        pExport->socketFd = accept(pExport->listenFd, NULL, NULL);
+    } while (pExport->socketFd < 0 && errno == EINTR);
+    if (pExport->socketFd < 0)
+    {
+        printf("Accepting the frame consumer failed: %d\n", errno);
+        return false;
+    }
+    pExport->isConsumerConnected = true;
+    return true;
+}
+
+static bool SendFrameExportHello(FrameExport* pExport)
+{
+    const FrameExportCreateInfo* pInfo = &pExport->info;
+    FrameExportMessage hello = {
+        .type = FRAME_EXPORT_MESSAGE_HELLO,
+        .imageIndex = 0,
+        .frameNumber = 0,
+        .imageCount = pInfo->imageCount,
+        .width = pInfo->width,
+        .height = pInfo->height,
+        .format = (uint32_t)pInfo->format,
+        .usage = pInfo->usage,
+        .memoryHandleType = (uint32_t)pInfo->memoryHandleType,
+        .semaphoreHandleType = (uint32_t)pInfo->semaphoreHandleType,
+        .memoryTypeIndex = pInfo->memoryTypeIndex
+    };
+    memcpy(hello.deviceUUID, pInfo->pDeviceUUID, VK_UUID_SIZE);
+    memcpy(hello.driverUUID, pInfo->pDriverUUID, VK_UUID_SIZE);
+
+    int fds[MAX_FRAME_EXPORT_FD_COUNT] = { 0 };
+    uint32_t fdCount = 0;
+    bool succeeded = true;
+    for (uint32_t i = 0; i < pInfo->imageCount && succeeded; ++i)
+    {
+        hello.allocationSizes[i] = pInfo->pAllocationSizes[i];
+        const VkMemoryGetFdInfoKHR getFdInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_GET_FD_INFO_KHR,
+            .pNext = NULL,
+            .memory = pInfo->pMemories[i],
+            .handleType = pInfo->memoryHandleType
+        };
+        const VkResult res = pExport->vkGetMemoryFdKHR(pInfo->device, &getFdInfo, &fds[fdCount]);
+        if (res != VK_SUCCESS) {
+            printf("vkGetMemoryFdKHR for frame export failed: %d\n", res);
+        }
+        succeeded = res == VK_SUCCESS;
+        fdCount += succeeded ? 1 : 0;
+    }
+    // Opaque semaphores share one payload for their lifetime, sync files are exported per frame
+    for (uint32_t i = 0; i < pInfo->imageCount && succeeded && pInfo->semaphoreHandleType == VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT; ++i)
+    {
+        const VkSemaphoreGetFdInfoKHR getFdInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+            .pNext = NULL,
+            .semaphore = pExport->semaphores[i],
+            .handleType = pInfo->semaphoreHandleType
+        };
+        const VkResult res = pExport->vkGetSemaphoreFdKHR(pInfo->device, &getFdInfo, &fds[fdCount]);
+        if (res != VK_SUCCESS) {
+            printf("vkGetSemaphoreFdKHR for frame export failed: %d\n", res);
+        }
+        succeeded = res == VK_SUCCESS;
+        fdCount += succeeded ? 1 : 0;
+    }
+
+    if (succeeded && !SendFrameExportMessage(pExport->socketFd, &hello, fds, fdCount))
+    {
+        printf("Sending the exported images to the frame consumer failed: %d\n", errno);
+        succeeded = false;
+    }
+    // The consumer holds its own duplicates now
+    for (uint32_t i = 0; i < fdCount; ++i) {
+        close(fds[i]);
+    }
+    return succeeded;
+}
+
+bool CreateFrameExport(const FrameExportCreateInfo* pCreateInfo, FrameExport* pExport)
+{
+    memset(pExport, 0, sizeof(*pExport));
+    pExport->info = *pCreateInfo;
+    pExport->listenFd = -1;
+    pExport->socketFd = -1;
+    if (pCreateInfo->imageCount > MAX_FRAME_EXPORT_IMAGE_COUNT)
+    {
+        printf("Cannot export more than %d images!\n", MAX_FRAME_EXPORT_IMAGE_COUNT);
+        return false;
+    }
+    const size_t socketPathLength = strlen(pCreateInfo->socketPath);
+    if (socketPathLength >= sizeof(pExport->socketPath))
+    {
+        printf("Frame export socket path '%s' is too long!\n", pCreateInfo->socketPath);
+        return false;
+    }
+    memcpy(pExport->socketPath, pCreateInfo->socketPath, socketPathLength + 1);
+    pExport->info.socketPath = pExport->socketPath;
+
+    pExport->vkGetMemoryFdKHR = (PFN_vkGetMemoryFdKHR)vkGetDeviceProcAddr(pCreateInfo->device, "vkGetMemoryFdKHR");
+    pExport->vkGetSemaphoreFdKHR = (PFN_vkGetSemaphoreFdKHR)vkGetDeviceProcAddr(pCreateInfo->device, "vkGetSemaphoreFdKHR");
+    if (pExport->vkGetMemoryFdKHR == NULL || pExport->vkGetSemaphoreFdKHR == NULL)
+    {
+        puts("VK_KHR_external_memory_fd or VK_KHR_external_semaphore_fd is not enabled!");
+        return false;
+    }
+
+    const bool succeeded = CreateExportSemaphoresAndCommands(pExport) && WaitForFrameConsumer(pExport) && SendFrameExportHello(pExport);
+    // The arrays are only valid during the creation, and the hello is the only use of them
+    pExport->info.pImages = NULL;
+    pExport->info.pMemories = NULL;
+    pExport->info.pAllocationSizes = NULL;
+    pExport->info.pDeviceUUID = NULL;
+    pExport->info.pDriverUUID = NULL;
+    if (!succeeded)
+    {
+        DestroyFrameExport(pExport);
+        return false;
+    }
+    return true;
+}
+
+static void WaitForExportedImageRelease(FrameExport* pExport, uint32_t imageIndex)
+{
+    if (!pExport->isImageExported[imageIndex]) return;
+
+    // The releases may arrive in any order
+    const uint64_t beginTime = GetCurrentTimeNanoseconds();
+    while (pExport->isImageExported[imageIndex])
+    {
+        FrameExportMessage message;
+        int fds[1];
+        uint32_t fdCount = 0;
+        if (!ReceiveFrameExportMessage(pExport->socketFd, &message, fds, 1, &fdCount))
+        {
+            // The images are no longer used by anyone else
+            puts("The frame consumer has disconnected, so the frames are no longer exported.");
+            pExport->isConsumerConnected = false;
+            memset(pExport->isImageExported, 0, sizeof(pExport->isImageExported));
+            break;
+        }
+        for (uint32_t i = 0; i < fdCount; ++i) {
+            close(fds[i]);
+        }
+        if (message.type == FRAME_EXPORT_MESSAGE_RELEASE && message.imageIndex < pExport->info.imageCount &&
+            pExport->isImageExported[message.imageIndex])
+        {
+            pExport->isImageExported[message.imageIndex] = false;
+            ++pExport->releasedFrameCount;
+        }
+    }
+    pExport->stallTime += GetCurrentTimeNanoseconds() - beginTime;
+    ++pExport->stallCount;
+}
+
+void DestroyFrameExport(FrameExport* pExport)
+{
+    const VkDevice device = pExport->info.device;
+    if (device == VK_NULL_HANDLE) return;
+
+    // Unread releases would reset the connection before the consumer reads the end. The images are not acquired back, since the pool
+    // of the acquisitions is destroyed below.
+    for (uint32_t i = 0; i < pExport->info.imageCount && pExport->isConsumerConnected; ++i) {
+        WaitForExportedImageRelease(pExport, i);
+    }
+    if (pExport->isConsumerConnected)
+    {
+        const FrameExportMessage end = { .type = FRAME_EXPORT_MESSAGE_END };
+        SendFrameExportMessage(pExport->socketFd, &end, NULL, 0);
+    }
+    if (pExport->socketFd >= 0) {
+        close(pExport->socketFd);
+    }
+    if (pExport->listenFd >= 0)
+    {
+        close(pExport->listenFd);
+        unlink(pExport->socketPath);
+    }
+    for (uint32_t i = 0; i < pExport->info.imageCount; ++i)
+    {
+        if (pExport->semaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(device, pExport->semaphores[i], pExport->info.pAllocator);
+        }
+    }
+    if (pExport->commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, pExport->commandPool, pExport->info.pAllocator);
+    }
+    memset(pExport, 0, sizeof(*pExport));
+}
+
+bool AcquireExportedImage(FrameExport* pExport, uint32_t imageIndex)
+{
+    WaitForExportedImageRelease(pExport, imageIndex);
+    if (!pExport->isImageReleased[imageIndex]) return true;
+
+    // Also after the consumer has disconnected, since the image was released to it. The consumer only reports the release once its
+    // read has completed, and the commands rendering into the image are submitted behind this to the same queue.
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pExport->acquireCommandBuffers[imageIndex],
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    const VkResult res = vkQueueSubmit(pExport->info.queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for frame export acquisition failed: %d\n", res);
+        return false;
+    }
+    pExport->isImageReleased[imageIndex] = false;
+    return true;
+}
+
+bool ExportFrame(FrameExport* pExport, uint32_t imageIndex, uint64_t frameNumber)
+{
+    if (!pExport->isConsumerConnected) return true;
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pExport->commandBuffers[imageIndex],
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &pExport->semaphores[imageIndex]
+    };
+    VkResult res = vkQueueSubmit(pExport->info.queue, 1, &submitInfo, VK_NULL_HANDLE);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for frame export failed: %d\n", res);
+        return false;
+    }
+    pExport->isImageReleased[imageIndex] = true;
+
+    int syncFd = -1;
+    if (pExport->info.semaphoreHandleType == VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT)
+    {
+        // Exporting a sync file unsignals the semaphore as a wait would, so it can be signaled by the next export of the image
+        const VkSemaphoreGetFdInfoKHR getFdInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_GET_FD_INFO_KHR,
+            .pNext = NULL,
+            .semaphore = pExport->semaphores[imageIndex],
+            .handleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT
+        };
+        res = pExport->vkGetSemaphoreFdKHR(pExport->info.device, &getFdInfo, &syncFd);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkGetSemaphoreFdKHR for frame export failed: %d\n", res);
+            return false;
+        }
+    }
+
+    const FrameExportMessage message = { .type = FRAME_EXPORT_MESSAGE_FRAME, .imageIndex = imageIndex, .frameNumber = frameNumber };
+    const bool isSent = SendFrameExportMessage(pExport->socketFd, &message, &syncFd, syncFd >= 0 ? 1 : 0);
+    if (syncFd >= 0) {
+        close(syncFd);
+    }
+    if (!isSent)
+    {
+        puts("The frame consumer has disconnected, so the frames are no longer exported.");
+        pExport->isConsumerConnected = false;
+        memset(pExport->isImageExported, 0, sizeof(pExport->isImageExported));
+        return true;
+    }
+    pExport->isImageExported[imageIndex] = true;
+    ++pExport->exportedFrameCount;
+    return true;
+}
+
+#endif // _WIN32
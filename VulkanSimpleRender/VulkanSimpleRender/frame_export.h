@@ -0,0 +1,133 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+
+enum FRAME_EXPORT_CONSTANTS
+{
+    MAX_FRAME_EXPORT_IMAGE_COUNT = 8,
+    // A memory and a semaphore file descriptor per image at most, sent with the hello message
+    MAX_FRAME_EXPORT_FD_COUNT = MAX_FRAME_EXPORT_IMAGE_COUNT * 2,
+    MAX_FRAME_EXPORT_PATH_LENGTH = 108
+};
+
+typedef enum FrameExportMessageType
+{
+    // Renderer to consumer, once: the images and their memory file descriptors, followed by the semaphore file descriptors
+    // with VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT
+    FRAME_EXPORT_MESSAGE_HELLO,
+    // Renderer to consumer: an image holds a new frame once its semaphore is signaled. With VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_SYNC_FD_BIT
+    // the message carries a sync file of the signal, to be imported temporarily, and -1 is sent as no descriptor for an already signaled one.
+    FRAME_EXPORT_MESSAGE_FRAME,
+    // Consumer to renderer: the consumer has finished reading the image, so the renderer may render into it again
+    FRAME_EXPORT_MESSAGE_RELEASE,
+    // Renderer to consumer: no more frames follow
+    FRAME_EXPORT_MESSAGE_END
+} FrameExportMessageType;
+
+// Every message has the same size, sent as one packet of a SOCK_SEQPACKET socket. Both sides run on the same machine and the same device.
+typedef struct FrameExportMessage
+{
+    uint32_t type;
+    // FRAME and RELEASE
+    uint32_t imageIndex;
+    uint64_t frameNumber;
+
+    // HELLO: the consumer creates the same images and imports the memory with the same type, size and a dedicated allocation.
+    // The images are in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL and released to VK_QUEUE_FAMILY_EXTERNAL whenever a frame is sent.
+    uint32_t imageCount;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t usage;
+    uint32_t memoryHandleType;
+    uint32_t semaphoreHandleType;
+    uint32_t memoryTypeIndex;
+    uint64_t allocationSizes[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    // Opaque handles can only be imported by the same driver on the same device
+    uint8_t deviceUUID[VK_UUID_SIZE];
+    uint8_t driverUUID[VK_UUID_SIZE];
+} FrameExportMessage;
+
+// Sends the message and duplicates the file descriptors into the receiving process. The caller keeps its descriptors.
+extern bool SendFrameExportMessage(int socketFd, const FrameExportMessage* pMessage, const int* pFds, uint32_t fdCount);
+// Blocks until a message arrives. The received descriptors belong to the caller. Returns false if the peer has disconnected.
+extern bool ReceiveFrameExportMessage(int socketFd, FrameExportMessage* pMessage, int* pFds, uint32_t maxFdCount, uint32_t* pFdCount);
+
+// Chooses the handle types to export images of the given format and usage with: dma-buf if the device can export it, opaque file
+// descriptors otherwise, and sync files for the semaphores if supported, otherwise opaque file descriptors of binary semaphores.
+// VK_KHR_external_memory_fd and VK_KHR_external_semaphore_fd MUST BE supported. Returns false if nothing can be exported.
+extern bool ChooseFrameExportHandleTypes(VkPhysicalDevice physicalDevice, bool isDmaBufSupported, VkFormat format, VkImageUsageFlags usage,
+                                         VkExternalMemoryHandleTypeFlagBits* pMemoryHandleType,
+                                         VkExternalSemaphoreHandleTypeFlagBits* pSemaphoreHandleType);
+extern const char* GetExternalMemoryHandleTypeName(VkExternalMemoryHandleTypeFlagBits handleType);
+extern const char* GetExternalSemaphoreHandleTypeName(VkExternalSemaphoreHandleTypeFlagBits handleType);
+
+typedef struct FrameExportCreateInfo
+{
+    VkDevice device;
+    // The callbacks every object of the export is created with, NULL for none
+    const VkAllocationCallbacks* pAllocator;
+    // The queue rendering the images. It MUST BE externally synchronized with the other users of it.
+    VkQueue queue;
+    uint32_t queueFamilyIndex;
+    // Listens on a Unix domain socket at this path and waits for one consumer to connect
+    const char* socketPath;
+    // Created with VkExternalMemoryImageCreateInfo of memoryHandleType and VK_SHARING_MODE_EXCLUSIVE, and bound at offset 0 to memory
+    // allocated for them alone with VkExportMemoryAllocateInfo and VkMemoryDedicatedAllocateInfo
+    uint32_t imageCount;
+    const VkImage* pImages;
+    const VkDeviceMemory* pMemories;
+    const VkDeviceSize* pAllocationSizes;
+    uint32_t memoryTypeIndex;
+    uint32_t width;
+    uint32_t height;
+    VkFormat format;
+    VkImageUsageFlags usage;
+    VkExternalMemoryHandleTypeFlagBits memoryHandleType;
+    VkExternalSemaphoreHandleTypeFlagBits semaphoreHandleType;
+    const uint8_t* pDeviceUUID;
+    const uint8_t* pDriverUUID;
+} FrameExportCreateInfo;
+
+// Hands rendered images to a consumer process without copying them. The memory of the images is exported once, every frame then
+// only sends the index of the image and a semaphore the consumer waits on. An image is rendered into again only after the consumer
+// has released it, so a slow consumer throttles the rendering. Not thread safe, only used on worker 0.
+typedef struct FrameExport
+{
+    FrameExportCreateInfo info;
+    char socketPath[MAX_FRAME_EXPORT_PATH_LENGTH];
+    int listenFd;
+    int socketFd;
+    PFN_vkGetMemoryFdKHR vkGetMemoryFdKHR;
+    PFN_vkGetSemaphoreFdKHR vkGetSemaphoreFdKHR;
+    VkCommandPool commandPool;
+    // Release every image to VK_QUEUE_FAMILY_EXTERNAL and signal its semaphore
+    VkCommandBuffer commandBuffers[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    // Acquire every image back from VK_QUEUE_FAMILY_EXTERNAL once the consumer has released it
+    VkCommandBuffer acquireCommandBuffers[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    VkSemaphore semaphores[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    // Sent to the consumer and not released yet
+    bool isImageExported[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    // Released to VK_QUEUE_FAMILY_EXTERNAL and not acquired back yet, which outlasts the consumer
+    bool isImageReleased[MAX_FRAME_EXPORT_IMAGE_COUNT];
+    // Cleared once the consumer has disconnected, after which the frames are rendered without being exported
+    bool isConsumerConnected;
+
+    uint32_t exportedFrameCount;
+    uint32_t releasedFrameCount;
+    // Frames that found their image still held by the consumer and waited for its release
+    uint32_t stallCount;
+    uint64_t stallTime;
+} FrameExport;
+
+extern bool CreateFrameExport(const FrameExportCreateInfo* pCreateInfo, FrameExport* pExport);
+// Waits for the consumer to release the images and tells it that no more frames follow. The queue MUST BE idle.
+extern void DestroyFrameExport(FrameExport* pExport);
+
+// Waits until the consumer has released the image and submits its acquisition from VK_QUEUE_FAMILY_EXTERNAL, before the image is
+// rendered into again.
+extern bool AcquireExportedImage(FrameExport* pExport, uint32_t imageIndex);
+// Submits the release of the image behind the commands rendering it and sends the frame to the consumer.
+extern bool ExportFrame(FrameExport* pExport, uint32_t imageIndex, uint64_t frameNumber);
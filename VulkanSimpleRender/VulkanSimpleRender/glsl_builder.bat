@@ -1,5 +1,16 @@
-%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten.vert.spv  flatten.vert.glsl
-%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten.frag.spv  flatten.frag.glsl
-%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient.vert.spv  gradient.vert.glsl
-%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient.frag.spv  gradient.frag.glsl
-
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten.vert.spv  flatten.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten.frag.spv  flatten.frag.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient.vert.spv  gradient.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient.frag.spv  gradient.frag.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten_instanced.vert.spv  flatten_instanced.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient_instanced.vert.spv  gradient_instanced.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o animate.comp.spv  animate.comp.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o textured.vert.spv  textured.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o textured.frag.spv  textured.frag.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o textured_instanced.vert.spv  textured_instanced.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o flatten_bindless.vert.spv  flatten_bindless.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o gradient_bindless.vert.spv  gradient_bindless.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o textured_bindless.vert.spv  textured_bindless.vert.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o textured_bindless.frag.spv  textured_bindless.frag.glsl
+%VK_SDK_PATH%/Bin/glslangValidator  --target-env vulkan1.1  -o rgb_to_yuv.comp.spv  rgb_to_yuv.comp.glsl
+
@@ -0,0 +1,334 @@
+#include "host_allocator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// Right in front of every allocation
+typedef struct HostAllocationHeader
+{
+    // Requested bytes
+    uint64_t size;
+    // From the start of the block the allocation was placed in, which is what gets freed
+    uint32_t offset;
+    uint8_t scope;
+    uint8_t source;
+    uint8_t sizeClass;
+    uint8_t reserved;
+} HostAllocationHeader;
+
+static_assert(sizeof(HostAllocationHeader) == HOST_ALLOCATION_HEADER_SIZE, "Invalid HostAllocationHeader size");
+
+static uintptr_t AlignHostAddress(uintptr_t address, size_t alignment)
+{
+    return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+static HostAllocationHeader* GetHostAllocationHeader(void* pMemory)
+{
+    return (HostAllocationHeader*)((uint8_t*)pMemory - HOST_ALLOCATION_HEADER_SIZE);
+}
+
+// Places the allocation and its header in the block
+static void* PlaceHostAllocation(uint8_t* pBlock, size_t size, size_t alignment, VkSystemAllocationScope scope,
+                                 HostAllocationSource source, uint32_t sizeClass)
+{
+    uint8_t* pMemory = (uint8_t*)AlignHostAddress((uintptr_t)pBlock + HOST_ALLOCATION_HEADER_SIZE, alignment);
+    HostAllocationHeader* pHeader = GetHostAllocationHeader(pMemory);
+    pHeader->size = size;
+    pHeader->offset = (uint32_t)(pMemory - pBlock);
+    pHeader->scope = (uint8_t)scope;
+    pHeader->source = (uint8_t)source;
+    pHeader->sizeClass = (uint8_t)sizeClass;
+    pHeader->reserved = 0;
+    return pMemory;
+}
+
+static void* AllocateFromArena(HostAllocator* pAllocator, size_t size, size_t alignment)
+{
+    uint8_t* pBlock = pAllocator->pArena + pAllocator->arenaOffset;
+    const uintptr_t memoryAddress = AlignHostAddress((uintptr_t)pBlock + HOST_ALLOCATION_HEADER_SIZE, alignment);
+    const uintptr_t arenaEnd = (uintptr_t)pAllocator->pArena + pAllocator->info.arenaSize;
+    if (memoryAddress > arenaEnd || size > arenaEnd - memoryAddress) return NULL;
+
+    void* pMemory = PlaceHostAllocation(pBlock, size, alignment, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND, HOST_ALLOCATION_SOURCE_ARENA, 0);
+    pAllocator->arenaOffset = (uint32_t)(memoryAddress + size - (uintptr_t)pAllocator->pArena);
+    ++pAllocator->liveArenaAllocationCount;
+
+    HostAllocationStatistics* pStatistics = &pAllocator->statistics;
+    ++pStatistics->arenaAllocationCount;
+    if (pAllocator->arenaOffset > pStatistics->arenaPeakBytes) {
+        pStatistics->arenaPeakBytes = pAllocator->arenaOffset;
+    }
+    return pMemory;
+}
+
+static void* AllocateFromPool(HostAllocator* pAllocator, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    // Whatever the block address, the allocation and its header fit in this
+    const size_t blockSize = HOST_ALLOCATION_HEADER_SIZE + size + alignment - 1;
+    if (blockSize > HOST_POOL_MAX_BLOCK_SIZE) return NULL;
+
+    uint32_t sizeClass = 0;
+    while (((size_t)HOST_POOL_MIN_BLOCK_SIZE << sizeClass) < blockSize) {
+        ++sizeClass;
+    }
+
+    if (pAllocator->pFreeBlocks[sizeClass] == NULL)
+    {
+        // Carves a new slab into blocks of the class, behind the slab link
+        HostPoolSlab* pSlab = malloc(HOST_POOL_SLAB_SIZE);
+        if (pSlab == NULL) return NULL;
+        pSlab->pNext = pAllocator->pSlabs;
+        pAllocator->pSlabs = pSlab;
+        ++pAllocator->statistics.poolSlabCount;
+
+        const uint32_t classBlockSize = HOST_POOL_MIN_BLOCK_SIZE << sizeClass;
+        const uint32_t blockCount = (HOST_POOL_SLAB_SIZE - HOST_ALLOCATION_HEADER_SIZE) / classBlockSize;
+        uint8_t* pBlocks = (uint8_t*)pSlab + HOST_ALLOCATION_HEADER_SIZE;
+        for (uint32_t i = blockCount; i > 0; --i)
+        {
+            HostPoolBlock* pBlock = (HostPoolBlock*)(pBlocks + (size_t)(i - 1) * classBlockSize);
+            pBlock->pNext = pAllocator->pFreeBlocks[sizeClass];
+            pAllocator->pFreeBlocks[sizeClass] = pBlock;
+        }
+    }
+
+    HostPoolBlock* pBlock = pAllocator->pFreeBlocks[sizeClass];
+    pAllocator->pFreeBlocks[sizeClass] = pBlock->pNext;
+    ++pAllocator->statistics.poolAllocationCount;
+    ++pAllocator->statistics.poolAllocationCounts[sizeClass];
+    return PlaceHostAllocation((uint8_t*)pBlock, size, alignment, scope, HOST_ALLOCATION_SOURCE_POOL, sizeClass);
+}
+
+static void* AllocateFromHeap(HostAllocator* pAllocator, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    uint8_t* pBlock = malloc(HOST_ALLOCATION_HEADER_SIZE + size + alignment - 1);
+    if (pBlock == NULL) return NULL;
+    ++pAllocator->statistics.heapAllocationCount;
+    return PlaceHostAllocation(pBlock, size, alignment, scope, HOST_ALLOCATION_SOURCE_HEAP, 0);
+}
+
+// The mutex MUST BE locked.
+static void* AllocateHostMemory(HostAllocator* pAllocator, size_t size, size_t alignment, VkSystemAllocationScope scope)
+{
+    // Keeps the headers aligned
+    if (alignment < HOST_ALLOCATION_HEADER_SIZE) {
+        alignment = HOST_ALLOCATION_HEADER_SIZE;
+    }
+
+    void* pMemory = NULL;
+    if (scope == VK_SYSTEM_ALLOCATION_SCOPE_COMMAND)
+    {
+        pMemory = AllocateFromArena(pAllocator, size, alignment);
+        if (pMemory == NULL) {
+            ++pAllocator->statistics.arenaOverflowCount;
+        }
+    }
+    else if (scope == VK_SYSTEM_ALLOCATION_SCOPE_OBJECT) {
+        pMemory = AllocateFromPool(pAllocator, size, alignment, scope);
+    }
+    if (pMemory == NULL) {
+        pMemory = AllocateFromHeap(pAllocator, size, alignment, scope);
+    }
+    return pMemory;
+}
+
+// The mutex MUST BE locked.
+static void FreeHostMemory(HostAllocator* pAllocator, void* pMemory)
+{
+    const HostAllocationHeader* pHeader = GetHostAllocationHeader(pMemory);
+    uint8_t* pBlock = (uint8_t*)pMemory - pHeader->offset;
+    switch (pHeader->source)
+    {
+    case HOST_ALLOCATION_SOURCE_ARENA:
+        // Nothing is freed until the whole arena is, which then starts over
+        if (--pAllocator->liveArenaAllocationCount == 0)
+        {
+            pAllocator->arenaOffset = 0;
+            ++pAllocator->statistics.arenaResetCount;
+        }
+        break;
+    case HOST_ALLOCATION_SOURCE_POOL:
+    {
+        HostPoolBlock* pPoolBlock = (HostPoolBlock*)pBlock;
+        pPoolBlock->pNext = pAllocator->pFreeBlocks[pHeader->sizeClass];
+        pAllocator->pFreeBlocks[pHeader->sizeClass] = pPoolBlock;
+        break;
+    }
+    default:
+        free(pBlock);
+        break;
+    }
+}
+
+static void CountHostAllocation(HostAllocationScopeStatistics* pScope, uint64_t size)
+{
+    pScope->totalBytes += size;
+    pScope->currentBytes += size;
+    if (pScope->currentBytes > pScope->peakBytes) {
+        pScope->peakBytes = pScope->currentBytes;
+    }
+}
+
+static void* VKAPI_PTR HostAllocation(void* pUserData, size_t size, size_t alignment, VkSystemAllocationScope allocationScope)
+{
+    HostAllocator* pAllocator = pUserData;
+    if (size == 0) return NULL;
+
+    LockPlatformMutex(&pAllocator->mutex);
+    void* pMemory = AllocateHostMemory(pAllocator, size, alignment, allocationScope);
+    if (pMemory != NULL)
+    {
+        HostAllocationScopeStatistics* pScope = &pAllocator->statistics.scopes[allocationScope];
+        ++pScope->allocationCount;
+        CountHostAllocation(pScope, size);
+    }
+    UnlockPlatformMutex(&pAllocator->mutex);
+    return pMemory;
+}
+
+static void VKAPI_PTR HostFree(void* pUserData, void* pMemory)
+{
+    HostAllocator* pAllocator = pUserData;
+    if (pMemory == NULL) return;
+
+    LockPlatformMutex(&pAllocator->mutex);
+    const HostAllocationHeader* pHeader = GetHostAllocationHeader(pMemory);
+    HostAllocationScopeStatistics* pScope = &pAllocator->statistics.scopes[pHeader->scope];
+    ++pScope->freeCount;
+    pScope->currentBytes -= pHeader->size;
+    FreeHostMemory(pAllocator, pMemory);
+    UnlockPlatformMutex(&pAllocator->mutex);
+}
+
+static void* VKAPI_PTR HostReallocation(void* pUserData, void* pOriginal, size_t size, size_t alignment,
+                                        VkSystemAllocationScope allocationScope)
+{
+    HostAllocator* pAllocator = pUserData;
+    if (pOriginal == NULL) return HostAllocation(pUserData, size, alignment, allocationScope);
+    if (size == 0)
+    {
+        HostFree(pUserData, pOriginal);
+        return NULL;
+    }
+
+    // Always moves, so the allocation lands where its new size and scope belong. The original stays valid if this fails.
+    LockPlatformMutex(&pAllocator->mutex);
+    void* pMemory = AllocateHostMemory(pAllocator, size, alignment, allocationScope);
+    if (pMemory != NULL)
+    {
+        const HostAllocationHeader* pHeader = GetHostAllocationHeader(pOriginal);
+        const uint64_t originalSize = pHeader->size;
+        memcpy(pMemory, pOriginal, (size_t)(originalSize < size ? originalSize : size));
+        pAllocator->statistics.scopes[pHeader->scope].currentBytes -= originalSize;
+        FreeHostMemory(pAllocator, pOriginal);
+
+        HostAllocationScopeStatistics* pScope = &pAllocator->statistics.scopes[allocationScope];
+        ++pScope->reallocationCount;
+        CountHostAllocation(pScope, size);
+    }
+    UnlockPlatformMutex(&pAllocator->mutex);
+    return pMemory;
+}
+
+static void VKAPI_PTR HostInternalAllocationNotification(void* pUserData, size_t size, VkInternalAllocationType allocationType,
+                                                         VkSystemAllocationScope allocationScope)
+{
+    HostAllocator* pAllocator = pUserData;
+    (void)allocationType;
+
+    LockPlatformMutex(&pAllocator->mutex);
+    HostAllocationScopeStatistics* pScope = &pAllocator->statistics.scopes[allocationScope];
+    ++pScope->internalAllocationCount;
+    pScope->currentInternalBytes += size;
+    if (pScope->currentInternalBytes > pScope->peakInternalBytes) {
+        pScope->peakInternalBytes = pScope->currentInternalBytes;
+    }
+    UnlockPlatformMutex(&pAllocator->mutex);
+}
+
+static void VKAPI_PTR HostInternalFreeNotification(void* pUserData, size_t size, VkInternalAllocationType allocationType,
+                                                   VkSystemAllocationScope allocationScope)
+{
+    HostAllocator* pAllocator = pUserData;
+    (void)allocationType;
+
+    LockPlatformMutex(&pAllocator->mutex);
+    pAllocator->statistics.scopes[allocationScope].currentInternalBytes -= size;
+    UnlockPlatformMutex(&pAllocator->mutex);
+}
+
+bool CreateHostAllocator(const HostAllocatorCreateInfo* pCreateInfo, HostAllocator* pAllocator)
+{
+    memset(pAllocator, 0, sizeof(*pAllocator));
+    pAllocator->info = *pCreateInfo;
+    if (pAllocator->info.arenaSize == 0) {
+        pAllocator->info.arenaSize = DEFAULT_HOST_ARENA_SIZE;
+    }
+
+    pAllocator->pArena = malloc(pAllocator->info.arenaSize);
+    if (pAllocator->pArena == NULL)
+    {
+        puts("Failed to allocate the host allocation arena!");
+        return false;
+    }
+    InitializePlatformMutex(&pAllocator->mutex);
+
+    pAllocator->callbacks = (VkAllocationCallbacks){
+        .pUserData = pAllocator,
+        .pfnAllocation = HostAllocation,
+        .pfnReallocation = HostReallocation,
+        .pfnFree = HostFree,
+        .pfnInternalAllocation = HostInternalAllocationNotification,
+        .pfnInternalFree = HostInternalFreeNotification
+    };
+    return true;
+}
+
+void DestroyHostAllocator(HostAllocator* pAllocator)
+{
+    if (pAllocator->pArena == NULL) return;
+
+    HostPoolSlab* pSlab = pAllocator->pSlabs;
+    while (pSlab != NULL)
+    {
+        HostPoolSlab* pNext = pSlab->pNext;
+        free(pSlab);
+        pSlab = pNext;
+    }
+    free(pAllocator->pArena);
+    DestroyPlatformMutex(&pAllocator->mutex);
+    memset(pAllocator, 0, sizeof(*pAllocator));
+}
+
+const VkAllocationCallbacks* GetHostAllocationCallbacks(const HostAllocator* pAllocator)
+{
+    return &pAllocator->callbacks;
+}
+
+void GetHostAllocationStatistics(HostAllocator* pAllocator, HostAllocationStatistics* pStatistics)
+{
+    LockPlatformMutex(&pAllocator->mutex);
+    *pStatistics = pAllocator->statistics;
+    UnlockPlatformMutex(&pAllocator->mutex);
+}
+
+const char* GetSystemAllocationScopeName(VkSystemAllocationScope scope)
+{
+    switch (scope)
+    {
+    case VK_SYSTEM_ALLOCATION_SCOPE_COMMAND:
+        return "command";
+    case VK_SYSTEM_ALLOCATION_SCOPE_OBJECT:
+        return "object";
+    case VK_SYSTEM_ALLOCATION_SCOPE_CACHE:
+        return "cache";
+    case VK_SYSTEM_ALLOCATION_SCOPE_DEVICE:
+        return "device";
+    case VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE:
+        return "instance";
+    default:
+        return "unknown";
+    }
+}
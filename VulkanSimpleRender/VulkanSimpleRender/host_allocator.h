@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+
+enum HOST_ALLOCATOR_CONSTANTS
+{
+    HOST_ALLOCATION_SCOPE_COUNT = VK_SYSTEM_ALLOCATION_SCOPE_INSTANCE + 1,
+    // Every allocation is preceded by its header, and aligned to at least this, so the header is aligned too
+    HOST_ALLOCATION_HEADER_SIZE = 16,
+    DEFAULT_HOST_ARENA_SIZE = 256 * 1024,
+    // The pools serve blocks of 64, 128, ... up to 4096 bytes, including the header and the alignment padding
+    HOST_POOL_SIZE_CLASS_COUNT = 7,
+    HOST_POOL_MIN_BLOCK_SIZE = 64,
+    HOST_POOL_MAX_BLOCK_SIZE = HOST_POOL_MIN_BLOCK_SIZE << (HOST_POOL_SIZE_CLASS_COUNT - 1),
+    // The pools grow by whole slabs, which are only freed with the allocator
+    HOST_POOL_SLAB_SIZE = 64 * 1024
+};
+
+typedef enum HostAllocationSource
+{
+    HOST_ALLOCATION_SOURCE_ARENA,
+    HOST_ALLOCATION_SOURCE_POOL,
+    HOST_ALLOCATION_SOURCE_HEAP
+} HostAllocationSource;
+
+typedef struct HostAllocatorCreateInfo
+{
+    // 0 for DEFAULT_HOST_ARENA_SIZE
+    uint32_t arenaSize;
+} HostAllocatorCreateInfo;
+
+// What the driver has asked for in one VkSystemAllocationScope. Bytes are the requested sizes, without the headers and padding.
+typedef struct HostAllocationScopeStatistics
+{
+    uint64_t allocationCount;
+    uint64_t reallocationCount;
+    uint64_t freeCount;
+    // Everything ever allocated, reallocations counting their new size
+    uint64_t totalBytes;
+    uint64_t currentBytes;
+    uint64_t peakBytes;
+    // Reported through pfnInternalAllocation, allocated by the driver itself
+    uint64_t internalAllocationCount;
+    uint64_t currentInternalBytes;
+    uint64_t peakInternalBytes;
+} HostAllocationScopeStatistics;
+
+typedef struct HostAllocationStatistics
+{
+    HostAllocationScopeStatistics scopes[HOST_ALLOCATION_SCOPE_COUNT];
+
+    uint64_t arenaAllocationCount;
+    // Command scope allocations which did not fit in the arena, served from the heap instead
+    uint64_t arenaOverflowCount;
+    uint64_t arenaResetCount;
+    // The most of the arena used at once, including headers and padding
+    uint64_t arenaPeakBytes;
+
+    uint64_t poolAllocationCount;
+    uint64_t poolSlabCount;
+    uint64_t poolAllocationCounts[HOST_POOL_SIZE_CLASS_COUNT];
+    uint64_t heapAllocationCount;
+} HostAllocationStatistics;
+
+typedef struct HostPoolBlock
+{
+    struct HostPoolBlock* pNext;
+} HostPoolBlock;
+
+typedef struct HostPoolSlab
+{
+    struct HostPoolSlab* pNext;
+} HostPoolSlab;
+
+// VkAllocationCallbacks counting what the driver allocates per VkSystemAllocationScope, and serving it by how long it lives.
+// Command scope allocations only live as long as the vkCreate*, vkAllocate* or vkCmd* call making them, so they are bumped from a
+// linear arena, which is rewound whenever its last allocation is freed, at least once per frame. Object scope allocations live as long
+// as a Vulkan object and are mostly small, so they come from free lists of a few size classes. The longer lived cache, device and
+// instance scopes, and anything too large for the arena or the pools, go to the heap. Thread safe, since the driver may call back from
+// any thread creating objects or recording commands.
+typedef struct HostAllocator
+{
+    HostAllocatorCreateInfo info;
+    VkAllocationCallbacks callbacks;
+    PlatformMutex mutex;
+
+    uint8_t* pArena;
+    uint32_t arenaOffset;
+    uint32_t liveArenaAllocationCount;
+
+    HostPoolBlock* pFreeBlocks[HOST_POOL_SIZE_CLASS_COUNT];
+    HostPoolSlab* pSlabs;
+
+    HostAllocationStatistics statistics;
+} HostAllocator;
+
+extern bool CreateHostAllocator(const HostAllocatorCreateInfo* pCreateInfo, HostAllocator* pAllocator);
+// Every object created with the callbacks MUST have been destroyed.
+extern void DestroyHostAllocator(HostAllocator* pAllocator);
+
+// The callbacks to pass to vkCreate* and vkDestroy*, valid until the allocator is destroyed
+extern const VkAllocationCallbacks* GetHostAllocationCallbacks(const HostAllocator* pAllocator);
+extern void GetHostAllocationStatistics(HostAllocator* pAllocator, HostAllocationStatistics* pStatistics);
+extern const char* GetSystemAllocationScopeName(VkSystemAllocationScope scope);
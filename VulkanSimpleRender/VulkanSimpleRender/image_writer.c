@@ -0,0 +1,366 @@
+#include "image_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+enum IMAGE_WRITER_CONSTANTS
+{
+    // Largest payload of a stored deflate block
+    PNG_STORED_BLOCK_SIZE = 65535,
+    // Largest sum of bytes before the 32-bit sums of Adler-32 can overflow
+    PNG_ADLER_BLOCK_SIZE = 5552,
+    QOI_HEADER_SIZE = 14,
+    QOI_END_MARKER_SIZE = 8,
+    QOI_INDEX_SIZE = 64,
+    QOI_MAX_RUN_LENGTH = 62
+};
+
+enum QOI_OPS
+{
+    QOI_OP_INDEX = 0x00,
+    QOI_OP_DIFF = 0x40,
+    QOI_OP_LUMA = 0x80,
+    QOI_OP_RUN = 0xC0,
+    QOI_OP_RGB = 0xFE,
+    QOI_OP_RGBA = 0xFF
+};
+
+static const char* const s_imageFileFormatNames[IMAGE_FILE_FORMAT_COUNT] = {
+    [IMAGE_FILE_FORMAT_PNG] = "png",
+    [IMAGE_FILE_FORMAT_QOI] = "qoi",
+    [IMAGE_FILE_FORMAT_PPM] = "ppm"
+};
+
+const char* GetImageFileFormatName(ImageFileFormat format)
+{
+    return format < IMAGE_FILE_FORMAT_COUNT ? s_imageFileFormatNames[format] : "unknown";
+}
+
+bool ParseImageFileFormat(const char* name, ImageFileFormat* pFormat)
+{
+    for (uint32_t i = 0; i < IMAGE_FILE_FORMAT_COUNT; ++i)
+    {
+        if (strcmp(name, s_imageFileFormatNames[i]) == 0)
+        {
+            *pFormat = (ImageFileFormat)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint8_t* StoreBigEndian32(uint8_t* pDst, uint32_t value)
+{
+    pDst[0] = (uint8_t)(value >> 24);
+    pDst[1] = (uint8_t)(value >> 16);
+    pDst[2] = (uint8_t)(value >> 8);
+    pDst[3] = (uint8_t)value;
+    return pDst + 4;
+}
+
+static uint32_t ComputeCrc32(const uint32_t table[256], const uint8_t* pData, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+    for (size_t i = 0; i < size; ++i) {
+        crc = table[(crc ^ pData[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFU;
+}
+
+// Stores a chunk of which the `dataSize` bytes of data are already at pChunk + 8, and returns the end of the chunk.
+static uint8_t* FinishPngChunk(const uint32_t crcTable[256], uint8_t* pChunk, const char type[4], uint32_t dataSize)
+{
+    StoreBigEndian32(pChunk, dataSize);
+    memcpy(pChunk + 4, type, 4);
+    // The CRC covers the type and the data
+    return StoreBigEndian32(pChunk + 8 + dataSize, ComputeCrc32(crcTable, pChunk + 4, 4 + (size_t)dataSize));
+}
+
+// Splits a zlib stream into stored deflate blocks while summing its Adler-32
+typedef struct StoredDeflateWriter
+{
+    uint8_t* pDst;
+    // Bytes not appended yet, which decides the size of the next block and whether it is the final one
+    size_t remainingSize;
+    size_t blockRemaining;
+    uint32_t adlerA;
+    uint32_t adlerB;
+    uint32_t adlerCount;
+} StoredDeflateWriter;
+
+static void AppendStoredBytes(StoredDeflateWriter* pWriter, const uint8_t* pSrc, size_t size)
+{
+    while (size > 0)
+    {
+        if (pWriter->blockRemaining == 0)
+        {
+            pWriter->blockRemaining = pWriter->remainingSize < PNG_STORED_BLOCK_SIZE ? pWriter->remainingSize : PNG_STORED_BLOCK_SIZE;
+            const uint16_t length = (uint16_t)pWriter->blockRemaining;
+            uint8_t* pDst = pWriter->pDst;
+            // BFINAL and BTYPE 00, then LEN and NLEN in little endian
+            pDst[0] = pWriter->remainingSize == pWriter->blockRemaining ? 1 : 0;
+            pDst[1] = (uint8_t)length;
+            pDst[2] = (uint8_t)(length >> 8);
+            pDst[3] = (uint8_t)~length;
+            pDst[4] = (uint8_t)(~length >> 8);
+            pWriter->pDst += 5;
+        }
+
+        const size_t copySize = size < pWriter->blockRemaining ? size : pWriter->blockRemaining;
+        memcpy(pWriter->pDst, pSrc, copySize);
+        for (size_t i = 0; i < copySize; ++i)
+        {
+            pWriter->adlerA += pSrc[i];
+            pWriter->adlerB += pWriter->adlerA;
+            if (++pWriter->adlerCount == PNG_ADLER_BLOCK_SIZE)
+            {
+                pWriter->adlerA %= 65521U;
+                pWriter->adlerB %= 65521U;
+                pWriter->adlerCount = 0;
+            }
+        }
+        pWriter->pDst += copySize;
+        pWriter->remainingSize -= copySize;
+        pWriter->blockRemaining -= copySize;
+        pSrc += copySize;
+        size -= copySize;
+    }
+}
+
+// The pixel rows, each preceded by filter type 0 (none), are split into stored deflate blocks in a zlib stream.
+static size_t EncodePng(const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch, uint8_t** ppEncoded)
+{
+    // PNG does not allow empty images
+    if (width == 0 || height == 0) return 0;
+
+    const size_t rowSize = (size_t)width * 4;
+    const size_t rawSize = (rowSize + 1) * height;
+    const size_t blockCount = (rawSize + PNG_STORED_BLOCK_SIZE - 1) / PNG_STORED_BLOCK_SIZE;
+    // zlib header, block headers, data and Adler-32
+    const size_t idatSize = 2 + blockCount * 5 + rawSize + 4;
+    if (idatSize > UINT32_MAX) return 0;
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    const size_t encodedSize = sizeof(signature) + (12 + 13) + (12 + idatSize) + 12;
+    uint8_t* pEncoded = malloc(encodedSize);
+    if (pEncoded == NULL) return 0;
+
+    uint32_t crcTable[256];
+    for (uint32_t i = 0; i < 256; ++i)
+    {
+        uint32_t c = i;
+        for (uint32_t k = 0; k < 8; ++k) {
+            c = (c & 1U) != 0 ? 0xEDB88320U ^ (c >> 1) : c >> 1;
+        }
+        crcTable[i] = c;
+    }
+
+    memcpy(pEncoded, signature, sizeof(signature));
+    uint8_t* pChunk = pEncoded + sizeof(signature);
+
+    uint8_t* pData = StoreBigEndian32(pChunk + 8, width);
+    pData = StoreBigEndian32(pData, height);
+    // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+    const uint8_t format[5] = { 8, 6, 0, 0, 0 };
+    memcpy(pData, format, sizeof(format));
+    pChunk = FinishPngChunk(crcTable, pChunk, "IHDR", 13);
+
+    // Deflate with a 32 KB window and no preset dictionary, the check bits make the header a multiple of 31
+    pData = pChunk + 8;
+    pData[0] = 0x78;
+    pData[1] = 0x01;
+    StoredDeflateWriter writer = {
+        .pDst = pData + 2,
+        .remainingSize = rawSize,
+        .blockRemaining = 0,
+        .adlerA = 1,
+        .adlerB = 0,
+        .adlerCount = 0
+    };
+    const uint8_t filterType = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        AppendStoredBytes(&writer, &filterType, 1);
+        AppendStoredBytes(&writer, pPixels + (size_t)y * rowPitch, rowSize);
+    }
+    StoreBigEndian32(writer.pDst, ((writer.adlerB % 65521U) << 16) | (writer.adlerA % 65521U));
+    pChunk = FinishPngChunk(crcTable, pChunk, "IDAT", (uint32_t)idatSize);
+
+    pChunk = FinishPngChunk(crcTable, pChunk, "IEND", 0);
+
+    *ppEncoded = pEncoded;
+    return (size_t)(pChunk - pEncoded);
+}
+
+static inline uint32_t HashQoiPixel(const uint8_t pixel[4])
+{
+    return (pixel[0] * 3U + pixel[1] * 5U + pixel[2] * 7U + pixel[3] * 11U) % QOI_INDEX_SIZE;
+}
+
+static size_t EncodeQoi(const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch, uint8_t** ppEncoded)
+{
+    // Every pixel takes at most an RGBA op
+    const size_t maxSize = QOI_HEADER_SIZE + (size_t)width * height * 5 + QOI_END_MARKER_SIZE;
+    uint8_t* pEncoded = malloc(maxSize);
+    if (pEncoded == NULL) return 0;
+
+    uint8_t* pDst = pEncoded;
+    memcpy(pDst, "qoif", 4);
+    pDst = StoreBigEndian32(pDst + 4, width);
+    pDst = StoreBigEndian32(pDst, height);
+    // RGBA with sRGB color and linear alpha
+    *pDst++ = 4;
+    *pDst++ = 0;
+
+    uint8_t index[QOI_INDEX_SIZE][4];
+    memset(index, 0, sizeof(index));
+    uint8_t prev[4] = { 0, 0, 0, 255 };
+    uint32_t run = 0;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* pRow = pPixels + (size_t)y * rowPitch;
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            const uint8_t* pixel = pRow + (size_t)x * 4;
+            if (memcmp(pixel, prev, 4) == 0)
+            {
+                if (++run == QOI_MAX_RUN_LENGTH)
+                {
+                    *pDst++ = (uint8_t)(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0)
+            {
+                *pDst++ = (uint8_t)(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const uint32_t hash = HashQoiPixel(pixel);
+            if (memcmp(index[hash], pixel, 4) == 0) {
+                *pDst++ = (uint8_t)(QOI_OP_INDEX | hash);
+            }
+            else
+            {
+                memcpy(index[hash], pixel, 4);
+                if (pixel[3] == prev[3])
+                {
+                    // The differences wrap around
+                    const int dr = (int8_t)(uint8_t)(pixel[0] - prev[0]);
+                    const int dg = (int8_t)(uint8_t)(pixel[1] - prev[1]);
+                    const int db = (int8_t)(uint8_t)(pixel[2] - prev[2]);
+                    const int drg = dr - dg;
+                    const int dbg = db - dg;
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        *pDst++ = (uint8_t)(QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+                    }
+                    else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 && dbg >= -8 && dbg <= 7)
+                    {
+                        *pDst++ = (uint8_t)(QOI_OP_LUMA | (dg + 32));
+                        *pDst++ = (uint8_t)(((drg + 8) << 4) | (dbg + 8));
+                    }
+                    else
+                    {
+                        *pDst++ = QOI_OP_RGB;
+                        memcpy(pDst, pixel, 3);
+                        pDst += 3;
+                    }
+                }
+                else
+                {
+                    *pDst++ = QOI_OP_RGBA;
+                    memcpy(pDst, pixel, 4);
+                    pDst += 4;
+                }
+            }
+            memcpy(prev, pixel, 4);
+        }
+    }
+    if (run > 0) {
+        *pDst++ = (uint8_t)(QOI_OP_RUN | (run - 1));
+    }
+    static const uint8_t endMarker[QOI_END_MARKER_SIZE] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    memcpy(pDst, endMarker, sizeof(endMarker));
+    pDst += sizeof(endMarker);
+
+    *ppEncoded = pEncoded;
+    return (size_t)(pDst - pEncoded);
+}
+
+static size_t EncodePpm(const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch, uint8_t** ppEncoded)
+{
+    char header[64];
+    const int headerSize = snprintf(header, sizeof(header), "P6\n%u %u\n255\n", width, height);
+    const size_t encodedSize = (size_t)headerSize + (size_t)width * height * 3;
+    uint8_t* pEncoded = malloc(encodedSize);
+    if (pEncoded == NULL) return 0;
+
+    memcpy(pEncoded, header, (size_t)headerSize);
+    uint8_t* pDst = pEncoded + headerSize;
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        const uint8_t* pSrc = pPixels + (size_t)y * rowPitch;
+        for (uint32_t x = 0; x < width; ++x, pSrc += 4, pDst += 3)
+        {
+            pDst[0] = pSrc[0];
+            pDst[1] = pSrc[1];
+            pDst[2] = pSrc[2];
+        }
+    }
+
+    *ppEncoded = pEncoded;
+    return encodedSize;
+}
+
+bool WriteImageFile(const char* path, ImageFileFormat format, const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    // The whole file is encoded in memory first, so it is written with one call.
+    uint8_t* pEncoded = NULL;
+    size_t encodedSize = 0;
+    switch (format)
+    {
+    case IMAGE_FILE_FORMAT_PNG:
+        encodedSize = EncodePng(pPixels, width, height, rowPitch, &pEncoded);
+        break;
+
+    case IMAGE_FILE_FORMAT_QOI:
+        encodedSize = EncodeQoi(pPixels, width, height, rowPitch, &pEncoded);
+        break;
+
+    case IMAGE_FILE_FORMAT_PPM:
+        encodedSize = EncodePpm(pPixels, width, height, rowPitch, &pEncoded);
+        break;
+
+    default:
+        break;
+    }
+    if (encodedSize == 0)
+    {
+        printf("Encoding image '%s' failed!\n", path);
+        free(pEncoded);
+        return false;
+    }
+
+    FILE* fp = NULL;
+#ifdef _WIN32
+    if (fopen_s(&fp, path, "wb") != 0) fp = NULL;
+#else
+    fp = fopen(path, "wb");
+#endif // _WIN32
+    if (fp == NULL)
+    {
+        printf("Create image file '%s' failed!\n", path);
+        free(pEncoded);
+        return false;
+    }
+
+    bool succeeded = fwrite(pEncoded, 1, encodedSize, fp) == encodedSize;
+    if (fclose(fp) != 0) succeeded = false;
+    free(pEncoded);
+
+    if (!succeeded) {
+        printf("Write image file '%s' failed!\n", path);
+    }
+    return succeeded;
+}
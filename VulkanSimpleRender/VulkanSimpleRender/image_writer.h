@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum ImageFileFormat
+{
+    // Stored (uncompressed) deflate blocks, so encoding costs little more than two checksums over the pixels
+    IMAGE_FILE_FORMAT_PNG,
+    // The Quite OK Image format, lossless and run-length and delta coded in a single pass
+    IMAGE_FILE_FORMAT_QOI,
+    // Binary PPM (P6), the alpha channel is dropped
+    IMAGE_FILE_FORMAT_PPM,
+    IMAGE_FILE_FORMAT_COUNT
+} ImageFileFormat;
+
+// Also the file extension of the format
+extern const char* GetImageFileFormatName(ImageFileFormat format);
+// Returns false if `name` is none of the names returned by GetImageFileFormatName.
+extern bool ParseImageFileFormat(const char* name, ImageFileFormat* pFormat);
+
+// Encodes RGBA8 pixels, of which consecutive rows are `rowPitch` bytes apart, and writes them into a new file at `path`.
+// The encoding uses its own memory only, so images can be written on several threads at the same time.
+extern bool WriteImageFile(const char* path, ImageFileFormat format, const uint8_t* pPixels, uint32_t width, uint32_t height, uint32_t rowPitch);
@@ -0,0 +1,299 @@
+#include "job_system.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct Job
+{
+    PFN_JobFunction function;
+    void* pUserData;
+    JobCounter* pCounter;
+} Job;
+
+// Shared by the jobs of one RunParallelFor call, which lives on the stack of the waiting caller.
+typedef struct ParallelForContext
+{
+    PFN_ParallelForFunction function;
+    void* pUserData;
+    uint32_t count;
+    uint32_t batchSize;
+    volatile int64_t nextBatch;
+} ParallelForContext;
+
+static bool PushJob(JobDeque* pDeque, const Job* pJob)
+{
+    const int64_t bottom = PlatformAtomicLoad(&pDeque->bottom);
+    const int64_t top = PlatformAtomicLoad(&pDeque->top);
+    if (bottom - top >= JOB_DEQUE_CAPACITY) return false;
+
+    JobSlot* pSlot = &pDeque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)];
+    PlatformAtomicStore(&pSlot->function, (int64_t)(intptr_t)pJob->function);
+    PlatformAtomicStore(&pSlot->userData, (int64_t)(intptr_t)pJob->pUserData);
+    PlatformAtomicStore(&pSlot->counter, (int64_t)(intptr_t)pJob->pCounter);
+    // Publishes the slot to the thieves
+    PlatformAtomicStore(&pDeque->bottom, bottom + 1);
+    return true;
+}
+
+static inline void ReadJobSlot(const JobSlot* pSlot, Job* pJob)
+{
+    pJob->function = (PFN_JobFunction)(intptr_t)PlatformAtomicLoad(&pSlot->function);
+    pJob->pUserData = (void*)(intptr_t)PlatformAtomicLoad(&pSlot->userData);
+    pJob->pCounter = (JobCounter*)(intptr_t)PlatformAtomicLoad(&pSlot->counter);
+}
+
+// Only called by the owner of the deque.
+static bool PopJob(JobDeque* pDeque, Job* pJob)
+{
+    // Reserving the bottom job first makes a thief see it as taken, unless both see it as the last one.
+    const int64_t bottom = PlatformAtomicLoad(&pDeque->bottom) - 1;
+    PlatformAtomicStore(&pDeque->bottom, bottom);
+    PlatformMemoryFence();
+    const int64_t top = PlatformAtomicLoad(&pDeque->top);
+    if (top > bottom)
+    {
+        PlatformAtomicStore(&pDeque->bottom, bottom + 1);
+        return false;
+    }
+
+    ReadJobSlot(&pDeque->slots[bottom & (JOB_DEQUE_CAPACITY - 1)], pJob);
+    if (top < bottom) return true;
+
+    // The last job, which a thief may take at the same time
+    const bool isTaken = PlatformAtomicCompareExchange(&pDeque->top, top, top + 1);
+    PlatformAtomicStore(&pDeque->bottom, bottom + 1);
+    return isTaken;
+}
+
+static bool StealJob(JobDeque* pDeque, Job* pJob)
+{
+    const int64_t top = PlatformAtomicLoad(&pDeque->top);
+    PlatformMemoryFence();
+    const int64_t bottom = PlatformAtomicLoad(&pDeque->bottom);
+    if (top >= bottom) return false;
+
+    // The slot cannot be overwritten before `top` moves on, which makes the compare-exchange fail.
+    ReadJobSlot(&pDeque->slots[top & (JOB_DEQUE_CAPACITY - 1)], pJob);
+    return PlatformAtomicCompareExchange(&pDeque->top, top, top + 1);
+}
+
+static void ExecuteJob(JobWorker* pWorker, const Job* pJob)
+{
+    pJob->function(pJob->pUserData, pWorker->workerIndex);
+    PlatformAtomicStore(&pWorker->executedJobCount, pWorker->executedJobCount + 1);
+    if (pJob->pCounter != NULL) {
+        PlatformAtomicAdd(&pJob->pCounter->value, -1);
+    }
+}
+
+// Runs a job of the worker's own deque, or else one stolen from another worker. Returns false if no job was found.
+static bool RunNextJob(JobSystem* pSystem, JobWorker* pWorker)
+{
+    Job job;
+    bool isFound = PopJob(&pWorker->deque, &job);
+    if (!isFound && pSystem->workerCount > 1)
+    {
+        // Victims are visited from a random one, so the thieves spread over the busy workers.
+        uint32_t x = pWorker->randomState;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        pWorker->randomState = x;
+
+        const uint32_t firstVictim = x % pSystem->workerCount;
+        for (uint32_t i = 0; i < pSystem->workerCount && !isFound; ++i)
+        {
+            const uint32_t victim = (firstVictim + i) % pSystem->workerCount;
+            if (victim == pWorker->workerIndex) continue;
+            isFound = StealJob(&pSystem->workers[victim].deque, &job);
+        }
+        if (isFound) {
+            PlatformAtomicStore(&pWorker->stolenJobCount, pWorker->stolenJobCount + 1);
+        }
+    }
+    if (!isFound) return false;
+
+    PlatformAtomicAdd(&pSystem->queuedJobCount, -1);
+    ExecuteJob(pWorker, &job);
+    return true;
+}
+
+static void RunJobWorkerThread(void* pArgument)
+{
+    JobWorker* pWorker = pArgument;
+    JobSystem* pSystem = pWorker->pSystem;
+
+    uint32_t idleCount = 0;
+    while (PlatformAtomicLoad(&pSystem->isShuttingDown) == 0)
+    {
+        if (RunNextJob(pSystem, pWorker))
+        {
+            idleCount = 0;
+            continue;
+        }
+        if (++idleCount < JOB_IDLE_SPIN_COUNT)
+        {
+            PlatformSpinPause();
+            continue;
+        }
+        idleCount = 0;
+
+        // The count of sleeping threads is published before the queued jobs are checked, and SubmitJob does the opposite,
+        // so either the thread sees the new job or the submitter sees the sleeping thread and wakes it.
+        LockPlatformMutex(&pSystem->sleepMutex);
+        PlatformAtomicAdd(&pSystem->sleepingThreadCount, 1);
+        PlatformMemoryFence();
+        while (PlatformAtomicLoad(&pSystem->queuedJobCount) == 0 && PlatformAtomicLoad(&pSystem->isShuttingDown) == 0) {
+            WaitPlatformConditionVariable(&pSystem->jobQueued, &pSystem->sleepMutex);
+        }
+        PlatformAtomicAdd(&pSystem->sleepingThreadCount, -1);
+        UnlockPlatformMutex(&pSystem->sleepMutex);
+    }
+}
+
+bool CreateJobSystem(uint32_t workerCount, JobSystem* pSystem)
+{
+    memset(pSystem, 0, sizeof(*pSystem));
+
+    workerCount = workerCount < 1 ? 1 : workerCount > MAX_JOB_WORKER_COUNT ? MAX_JOB_WORKER_COUNT : workerCount;
+    pSystem->workers = calloc(workerCount, sizeof(JobWorker));
+    if (pSystem->workers == NULL) return false;
+
+    InitializePlatformMutex(&pSystem->sleepMutex);
+    InitializePlatformConditionVariable(&pSystem->jobQueued);
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        pSystem->workers[i].pSystem = pSystem;
+        pSystem->workers[i].workerIndex = i;
+        pSystem->workers[i].randomState = 0x9E3779B9U * (i + 1);
+    }
+    // Read by the workers looking for a victim, so it MUST NOT change once the first thread runs
+    pSystem->workerCount = workerCount;
+
+    // Worker 0 is the calling thread
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        if (!CreatePlatformThread(&pSystem->threads[pSystem->threadCount], RunJobWorkerThread, &pSystem->workers[i]))
+        {
+            DestroyJobSystem(pSystem);
+            return false;
+        }
+        pSystem->threadCount++;
+    }
+    return true;
+}
+
+void DestroyJobSystem(JobSystem* pSystem)
+{
+    if (pSystem->workers == NULL) return;
+
+    PlatformAtomicStore(&pSystem->isShuttingDown, 1);
+    LockPlatformMutex(&pSystem->sleepMutex);
+    WakeAllPlatformConditionVariable(&pSystem->jobQueued);
+    UnlockPlatformMutex(&pSystem->sleepMutex);
+    for (uint32_t i = 0; i < pSystem->threadCount; ++i) {
+        JoinPlatformThread(pSystem->threads[i]);
+    }
+
+    DestroyPlatformConditionVariable(&pSystem->jobQueued);
+    DestroyPlatformMutex(&pSystem->sleepMutex);
+    free(pSystem->workers);
+    memset(pSystem, 0, sizeof(*pSystem));
+}
+
+void SubmitJob(JobSystem* pSystem, uint32_t workerIndex, PFN_JobFunction function, void* pUserData, JobCounter* pCounter)
+{
+    JobWorker* pWorker = &pSystem->workers[workerIndex];
+    const Job job = { .function = function, .pUserData = pUserData, .pCounter = pCounter };
+    if (pCounter != NULL) {
+        PlatformAtomicAdd(&pCounter->value, 1);
+    }
+    if (!PushJob(&pWorker->deque, &job))
+    {
+        // Running the job right away keeps submitting infallible
+        ExecuteJob(pWorker, &job);
+        return;
+    }
+
+    PlatformAtomicAdd(&pSystem->queuedJobCount, 1);
+    PlatformMemoryFence();
+    if (PlatformAtomicLoad(&pSystem->sleepingThreadCount) > 0)
+    {
+        LockPlatformMutex(&pSystem->sleepMutex);
+        WakeAllPlatformConditionVariable(&pSystem->jobQueued);
+        UnlockPlatformMutex(&pSystem->sleepMutex);
+    }
+}
+
+void WaitForJobCounter(JobSystem* pSystem, uint32_t workerIndex, JobCounter* pCounter)
+{
+    JobWorker* pWorker = &pSystem->workers[workerIndex];
+    uint32_t idleCount = 0;
+    while (PlatformAtomicLoad(&pCounter->value) != 0)
+    {
+        if (RunNextJob(pSystem, pWorker))
+        {
+            idleCount = 0;
+        }
+        else if (++idleCount < JOB_IDLE_SPIN_COUNT)
+        {
+            PlatformSpinPause();
+        }
+        else
+        {
+            // The remaining jobs are running on other workers, possibly for a long time
+            idleCount = 0;
+            YieldPlatformThread();
+        }
+    }
+}
+
+static void RunParallelForBatches(void* pUserData, uint32_t workerIndex)
+{
+    ParallelForContext* pContext = pUserData;
+    const uint32_t batchCount = (pContext->count + pContext->batchSize - 1) / pContext->batchSize;
+    while (true)
+    {
+        const int64_t batch = PlatformAtomicAdd(&pContext->nextBatch, 1) - 1;
+        if (batch >= batchCount) break;
+
+        const uint32_t first = (uint32_t)batch * pContext->batchSize;
+        const uint32_t count = pContext->count - first < pContext->batchSize ? pContext->count - first : pContext->batchSize;
+        pContext->function(pContext->pUserData, first, count, workerIndex);
+    }
+}
+
+void RunParallelFor(JobSystem* pSystem, uint32_t workerIndex, uint32_t count, uint32_t batchSize, PFN_ParallelForFunction function,
+                    void* pUserData)
+{
+    if (count == 0) return;
+
+    ParallelForContext context = {
+        .function = function,
+        .pUserData = pUserData,
+        .count = count,
+        .batchSize = batchSize > 0 ? batchSize : 1,
+        .nextBatch = 0
+    };
+    const uint32_t batchCount = (count + context.batchSize - 1) / context.batchSize;
+
+    // One job per other worker at most, the calling worker claims batches too.
+    JobCounter counter = { 0 };
+    for (uint32_t i = 1; i < batchCount && i < pSystem->workerCount; ++i) {
+        SubmitJob(pSystem, workerIndex, RunParallelForBatches, &context, &counter);
+    }
+    RunParallelForBatches(&context, workerIndex);
+    WaitForJobCounter(pSystem, workerIndex, &counter);
+}
+
+void GetJobSystemStatistics(const JobSystem* pSystem, uint64_t* pExecutedJobCount, uint64_t* pStolenJobCount)
+{
+    uint64_t executedJobCount = 0;
+    uint64_t stolenJobCount = 0;
+    for (uint32_t i = 0; i < pSystem->workerCount; ++i)
+    {
+        executedJobCount += (uint64_t)PlatformAtomicLoad(&pSystem->workers[i].executedJobCount);
+        stolenJobCount += (uint64_t)PlatformAtomicLoad(&pSystem->workers[i].stolenJobCount);
+    }
+    *pExecutedJobCount = executedJobCount;
+    *pStolenJobCount = stolenJobCount;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "platform_utils.h"
+
+enum JOB_SYSTEM_CONSTANTS
+{
+    MAX_JOB_WORKER_COUNT = 32,
+    // Jobs a worker can have queued at once, MUST BE a power of 2. A job submitted to a full deque runs immediately instead.
+    JOB_DEQUE_CAPACITY = 4096,
+    // Failed attempts to find a job before an idle worker thread goes to sleep
+    JOB_IDLE_SPIN_COUNT = 1024,
+    // Keeps the indices of a deque on separate cache lines, since the owner writes one and the thieves the other
+    JOB_CACHE_LINE_SIZE = 64
+};
+
+// `workerIndex` is the worker running the job, which nested jobs are submitted with.
+typedef void (*PFN_JobFunction)(void* pUserData, uint32_t workerIndex);
+typedef void (*PFN_ParallelForFunction)(void* pUserData, uint32_t first, uint32_t count, uint32_t workerIndex);
+
+// Number of unfinished jobs submitted with the counter. Jobs depend on other jobs by waiting for their counter to drop to 0.
+typedef struct JobCounter
+{
+    volatile int64_t value;
+} JobCounter;
+
+// A queued job is stored by value, so submitting allocates nothing. The fields are read atomically, since a thief reads
+// them before knowing whether the job is still there.
+typedef struct JobSlot
+{
+    volatile int64_t function;
+    volatile int64_t userData;
+    volatile int64_t counter;
+} JobSlot;
+
+// Chase-Lev work-stealing deque. The owner pushes and pops jobs at the bottom without any lock,
+// the other workers steal from the top, and only a steal or the pop of the last job compete with a compare-exchange.
+typedef struct JobDeque
+{
+    volatile int64_t top;
+    uint8_t topPadding[JOB_CACHE_LINE_SIZE - sizeof(int64_t)];
+    volatile int64_t bottom;
+    uint8_t bottomPadding[JOB_CACHE_LINE_SIZE - sizeof(int64_t)];
+    JobSlot slots[JOB_DEQUE_CAPACITY];
+} JobDeque;
+
+typedef struct JobWorker
+{
+    JobDeque deque;
+    struct JobSystem* pSystem;
+    uint32_t workerIndex;
+    // xorshift32 state choosing the first worker to steal from
+    uint32_t randomState;
+    // Only written by the worker itself
+    volatile int64_t executedJobCount;
+    volatile int64_t stolenJobCount;
+} JobWorker;
+
+// Fixed workers, each with its own deque. Worker 0 is the thread that created the job system, which submits the root jobs
+// and runs jobs while it waits for them. The others are threads that run jobs until the job system is destroyed.
+typedef struct JobSystem
+{
+    JobWorker* workers;
+    uint32_t workerCount;
+    PlatformThread threads[MAX_JOB_WORKER_COUNT];
+    uint32_t threadCount;
+    // Jobs queued and not taken yet, which keeps idle threads from sleeping while there is work
+    volatile int64_t queuedJobCount;
+    volatile int64_t sleepingThreadCount;
+    volatile int64_t isShuttingDown;
+    PlatformMutex sleepMutex;
+    PlatformConditionVariable jobQueued;
+} JobSystem;
+
+// Creates `workerCount` workers, clamped to [1, MAX_JOB_WORKER_COUNT].
+// Returns false if out of memory or if a worker thread cannot be created.
+extern bool CreateJobSystem(uint32_t workerCount, JobSystem* pSystem);
+// Every submitted job MUST have finished.
+extern void DestroyJobSystem(JobSystem* pSystem);
+
+// Queues a job on the deque of `workerIndex`, which MUST BE the calling worker: 0 on the thread that created the job system,
+// otherwise the index passed to the running job. If `pCounter` is not NULL, it is incremented now and decremented once the job has finished.
+extern void SubmitJob(JobSystem* pSystem, uint32_t workerIndex, PFN_JobFunction function, void* pUserData, JobCounter* pCounter);
+// Runs queued jobs on the calling worker until `pCounter` has dropped to 0, so waiting inside a job never blocks a worker.
+extern void WaitForJobCounter(JobSystem* pSystem, uint32_t workerIndex, JobCounter* pCounter);
+
+// Calls `function` for consecutive ranges of at most `batchSize` elements covering [0, count) on all workers, and returns once all have finished.
+// The workers claim the ranges one by one, so uneven ranges are balanced.
+extern void RunParallelFor(JobSystem* pSystem, uint32_t workerIndex, uint32_t count, uint32_t batchSize, PFN_ParallelForFunction function,
+                           void* pUserData);
+
+// Sums the jobs executed and stolen by all workers so far.
+extern void GetJobSystemStatistics(const JobSystem* pSystem, uint64_t* pExecutedJobCount, uint64_t* pStolenJobCount);
@@ -1,2809 +1,7949 @@
-﻿// VulkanSimpleRender.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
-//
-
-#include <stdio.h>
-#include <stdint.h>
-#include <stdbool.h>
-#include <string.h>
-#include <stdlib.h>
-#include <assert.h>
-#include <limits.h>
-#include <errno.h>
-#include <vulkan/vulkan.h>
-
-#ifdef _WIN32
-// ATTENTION: <Windows.h> MUST BE included ahead of <vulkan/vulkan_win32.h> and <vulkan/vk_sdk_platform.h>
-#include <Windows.h>
-#include <wincodec.h>
-#include <vulkan/vulkan_win32.h>
-
-static inline FILE* GeneralOpenFile(const char* path)
-{
-    FILE* fp = NULL;
-    // error code such as `EISDIR`, `EMFILE`, `ENAMETOOLONG`, etc.
-    const errno_t errCode = fopen_s(&fp, path, "rb");
-    if (errCode != 0)
-    {
-        printf("Open file '%s' failed, because: %d\n", path, errCode);
-        return NULL;
-    }
-    return fp;
-}
-
-#define _USE_MATH_DEFINES
-
-#else
-
-static inline FILE* GeneralOpenFile(const char* path)
-{
-    FILE* fp = fopen(path, "r");
-    if (fp == NULL)
-    {
-        printf("File '%s' open failed!\n", path);
-        return NULL;
-    }
-    return fp;
-}
-
-#endif // _WIN32
-
-#include <math.h>
-
-
-enum MY_CONSTANTS
-{
-    MAX_VULKAN_LAYER_COUNT = 64,
-    MAX_VULKAN_GLOBAL_EXT_PROPS = 256,
-    MAX_GPU_COUNT = 8,
-    MAX_QUEUE_FAMILY_PROPERTY_COUNT = 8,
-    MAX_FORMAT_COUNT = 32,
-    MAX_PRESENT_MODE_COUNT = 8,
-    MAX_SWAPCHAIN_IMAGE_COUNT = 16,
-    DYNAMIC_STATE_COUNT = 2,
-
-    WINDOW_WIDTH = 512,
-    WINDOW_HEIGHT = 512,
-    FRAME_LAG = 2,
-
-    s_depth_format = VK_FORMAT_D16_UNORM
-};
-
-typedef struct SwapchainImageResources
-{
-    VkImage image;
-    VkCommandBuffer cmd_buf;
-    VkCommandBuffer graphics_to_present_cmd_buf;
-    VkImageView view;
-    VkBuffer coords_buffer;
-    VkBuffer color_buffer;
-    VkBuffer uniform_buffer;
-    VkDeviceMemory vertex_memory;
-    VkDeviceMemory uniform_memory;
-    VkFramebuffer framebuffer;
-    VkDescriptorSet descriptor_set;
-} SwapchainImageResources;
-
-typedef struct FlattenVertexUniform
-{
-    float u_factor[2];
-    float u_angle;
-} FlattenVertexUniform;
-
-static_assert(sizeof(FlattenVertexUniform) == 12U, "Invalid FlattenVertexUniform size");
-
-
-static VkLayerProperties s_layerProperties[MAX_VULKAN_LAYER_COUNT];
-static const char* s_layerNames[MAX_VULKAN_LAYER_COUNT];
-static VkExtensionProperties s_instanceExtensions[MAX_VULKAN_LAYER_COUNT][MAX_VULKAN_GLOBAL_EXT_PROPS];
-static uint32_t s_layerCount;
-static uint32_t s_instanceExtensionCounts[MAX_VULKAN_LAYER_COUNT];
-
-static VkPhysicalDevice s_currPhysicalDevice = VK_NULL_HANDLE;
-static VkInstance s_instance = VK_NULL_HANDLE;
-static VkDevice s_specDevice = VK_NULL_HANDLE;
-static bool s_supportIncrementalPresent = false;
-static uint32_t s_queueFamilyPropertyCount = 0;
-static uint32_t s_specQueueFamilyIndex = 0;
-static VkSurfaceKHR s_surface = VK_NULL_HANDLE;
-static VkSwapchainKHR s_swapchain = VK_NULL_HANDLE;
-static VkSurfaceFormatKHR s_surfaceFormat = { 0 };
-static uint32_t s_graphicsQueueFamilyIndex = 0;
-static uint32_t s_presentQueueFamilyIndex = 0;
-static VkQueue s_graphicsQueue = VK_NULL_HANDLE;
-static VkQueue s_presentQueue = VK_NULL_HANDLE;
-static SwapchainImageResources s_swapchainImageResources[MAX_SWAPCHAIN_IMAGE_COUNT] = { 0 };
-static uint32_t s_swapchainImageCount = 0;
-static uint32_t s_render_width, s_render_height;
-static VkFence s_presentFences[FRAME_LAG] = { VK_NULL_HANDLE };
-static VkSemaphore s_imageAcquiredSemaphores[FRAME_LAG] = { VK_NULL_HANDLE };
-static VkSemaphore s_drawCompleteSemaphores[FRAME_LAG] = { VK_NULL_HANDLE };
-static VkSemaphore s_imageOwnershipSemaphores[FRAME_LAG] = { VK_NULL_HANDLE };
-static VkCommandPool s_commandPool = VK_NULL_HANDLE;
-static VkCommandPool s_presentCommandPool = VK_NULL_HANDLE;
-static VkCommandBuffer s_commandBuffers[1] = { VK_NULL_HANDLE };
-static VkBuffer s_hostVertexAndUniformBuffer = VK_NULL_HANDLE;
-static VkDeviceMemory s_hostVertexUniformMemory = VK_NULL_HANDLE;
-static VkDescriptorSetLayout s_descSetLayout = VK_NULL_HANDLE;
-static VkPipelineLayout s_pipelineLayout = VK_NULL_HANDLE;
-static VkRenderPass s_render_pass = VK_NULL_HANDLE;
-static VkShaderModule s_vertex_shader_module = VK_NULL_HANDLE;
-static VkShaderModule s_fragment_shader_module = VK_NULL_HANDLE;
-static VkPipelineCache s_pipelineCaches[3] = { VK_NULL_HANDLE };
-static VkPipeline s_pipelines[3] = { VK_NULL_HANDLE };
-static VkDescriptorPool s_descPool = VK_NULL_HANDLE;
-static bool s_isRenderPrepared = false;
-static float s_currRorationDegree = 0.0f;
-
-struct
-{
-    VkImage image;
-    VkDeviceMemory device_memory;
-    VkImageView image_view;
-} s_depthResource;
-
-static const char* const s_deviceTypes[] = {
-    "Other",
-    "Integrated GPU",
-    "Discrete GPU",
-    "Virtual GPU",
-    "CPU"
-};
-
-static const float s_vertex_coords_data[4 * 4] = {
-    // bottom left
-    -0.2f, 0.2f, 0.0f, 1.0f,
-    // bottom right
-    0.2f, 0.2f, 0.0f, 1.0f,
-    // top left
-    -0.2f, -0.2f, 0.0f, 1.0f,
-    // top right
-    0.2f, -0.2f, 0.0f, 1.0f
-};
-
-static const float s_vertex_color_data[4 * 4] = {
-    // bottom left
-    0.9f, 0.1f, 0.1f, 1.0f,
-    // bottom right
-    0.1f, 0.9f, 0.1f, 1.0f,
-    // top left
-    0.1f, 0.1f, 0.9f, 1.0f,
-    // top right
-    0.9f, 0.1f, 0.9f, 1.0f
-};
-
-static inline bool IsSeperatePresentQueue(void)
-{
-    return s_graphicsQueueFamilyIndex != s_presentQueueFamilyIndex;
-}
-
-static VkResult init_global_extension_properties(uint32_t layerIndex)
-{
-    uint32_t instance_extension_count;
-    VkResult res;
-    VkLayerProperties* currLayer = &s_layerProperties[layerIndex];
-    char const* const layer_name = currLayer->layerName;
-    s_layerNames[layerIndex] = layer_name;
-
-    do {
-        res = vkEnumerateInstanceExtensionProperties(layer_name, &instance_extension_count, NULL);
-        if (res != VK_SUCCESS) {
-            return res;
-        }
-
-        if (instance_extension_count == 0) {
-            return VK_SUCCESS;
-        }
-        if (instance_extension_count > MAX_VULKAN_GLOBAL_EXT_PROPS) {
-            instance_extension_count = MAX_VULKAN_GLOBAL_EXT_PROPS;
-        }
-
-        s_instanceExtensionCounts[layerIndex] = instance_extension_count;
-        res = vkEnumerateInstanceExtensionProperties(layer_name, &instance_extension_count, s_instanceExtensions[layerIndex]);
-    } while (res == VK_INCOMPLETE);
-
-    return res;
-}
-
-static VkResult init_global_layer_properties(void)
-{
-    uint32_t instance_layer_count;
-    VkResult res;
-
-    // It's possible, though very rare, 
-    // that the number of instance layers could change.
-    // For example, installing something could include new layers that
-    // the loader would pick up between the initial query for the count and the request for VkLayerProperties.
-    // The loader indicates that by returning a VK_INCOMPLETE status and will update the the count parameter.
-    // The count parameter will be updated with the number of entries loaded into the data pointer -
-    // in case the number of layers went down or is smaller than the size given.
-    do
-    {
-        res = vkEnumerateInstanceLayerProperties(&instance_layer_count, NULL);
-        if (res != VK_SUCCESS) {
-            return res;
-        }
-
-        if (instance_layer_count == 0) {
-            return VK_SUCCESS;
-        }
-        instance_layer_count = min(instance_layer_count, MAX_VULKAN_LAYER_COUNT);
-
-        res = vkEnumerateInstanceLayerProperties(&instance_layer_count, s_layerProperties);
-    } while (res == VK_INCOMPLETE);
-
-    // Now gather the extension list for each instance layer.
-    s_layerCount = instance_layer_count;
-    for (uint32_t i = 0; i < instance_layer_count; i++)
-    {
-        res = init_global_extension_properties(i);
-        if (res != VK_SUCCESS)
-        {
-            printf("Query global extension properties error: %d\n", res);
-            break;
-        }
-    }
-
-    return res;
-}
-
-static bool InitializeVulkanInstance(const char *appName, const char *engineName)
-{
-    VkResult result = init_global_layer_properties();
-    if (result != VK_SUCCESS)
-    {
-        printf("init_global_layer_properties failed: %d\n", result);
-        return false;
-    }
-    printf("Found %u layer(s)...\n", s_layerCount);
-
-    // Check whether a validation layer exists
-    for (uint32_t i = 0; i < s_layerCount; ++i)
-    {
-        if (strstr(s_layerNames[i], "validation") != NULL)
-        {
-            printf("Contains %s!\n", s_layerNames[i]);
-            break;
-        }
-    }
-
-    // Query the API version
-    uint32_t apiVersion = VK_API_VERSION_1_0;
-    result = vkEnumerateInstanceVersion(&apiVersion);
-    if (result != VK_SUCCESS)
-    {
-        printf("vkEnumerateInstanceVersion failed: %d\n", result);
-        return false;
-    }
-    printf("Current API version: %u.%u.%u\n", VK_VERSION_MAJOR(apiVersion), VK_VERSION_MINOR(apiVersion), VK_VERSION_PATCH(apiVersion));
-
-    // initialize the VkApplicationInfo structure
-    const VkApplicationInfo app_info = {
-        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
-        .pNext = NULL,
-        .pApplicationName = appName,
-        .applicationVersion = 1,
-        .pEngineName = engineName,
-        .engineVersion = 1,
-        .apiVersion = apiVersion
-    };
-
-    uint32_t extPropCount = 0;
-    VkExtensionProperties extProps[MAX_VULKAN_GLOBAL_EXT_PROPS];
-    result = vkEnumerateInstanceExtensionProperties(NULL, &extPropCount, NULL);
-    if (result != VK_SUCCESS)
-    {
-        printf("vkEnumerateInstanceExtensionProperties for count failed: %d\n", result);
-        return false;
-    }
-    printf("Found %u instance extensions!\n", extPropCount);
-    extPropCount = min(extPropCount, MAX_VULKAN_GLOBAL_EXT_PROPS);
-
-    result = vkEnumerateInstanceExtensionProperties(NULL, &extPropCount, extProps);
-    if (result != VK_SUCCESS)
-    {
-        printf("vkEnumerateInstanceExtensionProperties for content failed: %d\n", result);
-        return false;
-    }
-
-    uint32_t availExtensionCount = 0;
-    const char* availExtensionNames[8];
-
-    bool supportSurface = false;
-    bool supportFurfaceWin32 = false;
-    bool supportColorSpaceExt = false;
-
-    for (uint32_t i = 0; i < extPropCount; ++i)
-    {
-        const char* const currExtName = extProps[i].extensionName;
-
-        if (strcmp(currExtName, VK_KHR_SURFACE_EXTENSION_NAME) == 0)
-        {
-            supportSurface = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-        if (strcmp(currExtName, VK_KHR_WIN32_SURFACE_EXTENSION_NAME) == 0)
-        {
-            supportFurfaceWin32 = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-        if (strcmp(currExtName, VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME) == 0)
-        {
-            supportColorSpaceExt = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-    }
-    printf("Found %u required instance extensions!\n", availExtensionCount);
-
-    if (!supportSurface) {
-        printf("%s not supported!\n", VK_KHR_SURFACE_EXTENSION_NAME);
-    }
-    if (!supportFurfaceWin32) {
-        printf("%s not supported!\n", VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
-    }
-    if (!supportColorSpaceExt) {
-        printf("%s not supported!\n", VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME);
-    }
-
-    // initialize the VkInstanceCreateInfo structure
-    const VkInstanceCreateInfo inst_info = {
-        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .pApplicationInfo = &app_info,
-        .enabledExtensionCount = availExtensionCount,
-        .ppEnabledExtensionNames = availExtensionNames,
-        .enabledLayerCount = 0, // s_layerCount,
-        .ppEnabledLayerNames = s_layerNames
-    };
-
-    result = vkCreateInstance(&inst_info, NULL, &s_instance);
-    if (result == VK_ERROR_INCOMPATIBLE_DRIVER) {
-        puts("cannot find a compatible Vulkan ICD");
-    }
-    else if (result != VK_SUCCESS) {
-        printf("vkCreateInstance failed: %d\n", result);
-    }
-
-    return result == VK_SUCCESS;
-}
-
-// Return the queue family count
-static bool InitializeVulkanDevice(VkQueueFlagBits queueFlag)
-{
-    VkPhysicalDevice physicalDevices[MAX_GPU_COUNT] = { VK_NULL_HANDLE };
-    uint32_t gpu_count = 0;
-    VkResult res = vkEnumeratePhysicalDevices(s_instance, &gpu_count, NULL);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEnumeratePhysicalDevices failed: %d\n", res);
-        return false;
-    }
-    gpu_count = min(gpu_count, MAX_GPU_COUNT);
-
-    res = vkEnumeratePhysicalDevices(s_instance, &gpu_count, physicalDevices);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEnumeratePhysicalDevices failed: %d\n", res);
-        return false;
-    }
-
-    // TODO: The following code is used to choose the working device and may be not necessary to other projects...
-    const bool isSingle = gpu_count == 1;
-    printf("\nThis application has detected there %s %u Vulkan capable device%s installed: \n",
-        isSingle ? "is" : "are",
-        gpu_count,
-        isSingle ? "" : "s");
-
-    VkPhysicalDeviceProperties props = { 0 };
-    for (uint32_t i = 0; i < gpu_count; i++)
-    {
-        vkGetPhysicalDeviceProperties(physicalDevices[i], &props);
-        printf("\n======== Device %u info ========\n", i);
-        printf("Device name: %s\n", props.deviceName);
-        printf("Device type: %s\n", s_deviceTypes[props.deviceType]);
-        printf("Vulkan API version: %u.%u.%u\n", VK_VERSION_MAJOR(props.apiVersion), VK_VERSION_MINOR(props.apiVersion), VK_VERSION_PATCH(props.apiVersion));
-        printf("Driver version: %08X\n", props.driverVersion);
-    }
-    puts("Please choose which device to use...");
-
-#ifdef _WIN32
-    char inputBuffer[8] = { '\0' };
-    const char* input = gets_s(inputBuffer, sizeof(inputBuffer));
-    if (input == NULL) {
-        input = "0";
-    }
-    const uint32_t deviceIndex = atoi(input);
-#else
-    char* input = NULL;
-    ssize_t initLen = 0;
-    const ssize_t len = getline(&input, &initLen, stdin);
-    input[len - 1] = '\0';
-    errno = 0;
-    const uint32_t deviceIndex = (uint32_t)strtoul(input, NULL, 10);
-    if (errno != 0)
-    {
-        printf("Input error: %d! Invalid integer input!!\n", errno);
-        return false;
-    }
-#endif // WIN32
-
-    if (deviceIndex >= gpu_count)
-    {
-        printf("Your input (%u) exceeds the max number of available devices (%u)\n", deviceIndex, gpu_count);
-        return false;
-    }
-    printf("You have chosen device[%u]...\n", deviceIndex);
-
-    s_currPhysicalDevice = physicalDevices[deviceIndex];
-
-    // Query Vulkan extensions the current selected physical device supports
-    uint32_t extPropCount = 0U;
-    res = vkEnumerateDeviceExtensionProperties(s_currPhysicalDevice, NULL, &extPropCount, NULL);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEnumerateDeviceExtensionProperties for count failed: %d\n", res);
-        return false;
-    }
-    printf("The current selected physical device supports %u device extensions!\n", extPropCount);
-    extPropCount = min(extPropCount, MAX_VULKAN_GLOBAL_EXT_PROPS);
-
-    VkExtensionProperties extProps[MAX_VULKAN_GLOBAL_EXT_PROPS];
-    res = vkEnumerateDeviceExtensionProperties(s_currPhysicalDevice, NULL, &extPropCount, extProps);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEnumerateDeviceExtensionProperties for content failed: %d\n", res);
-        return false;
-    }
-
-    uint32_t availExtensionCount = 0;
-    const char* availExtensionNames[8];
-
-    bool supportSwapchain = false;
-    bool supportScalarBlock = false;
-    bool supportDriverProperties = false;
-
-    for (uint32_t i = 0; i < extPropCount; ++i)
-    {
-        const char* const currExtName = extProps[i].extensionName;
-
-        if (strcmp(currExtName, VK_KHR_SWAPCHAIN_EXTENSION_NAME) == 0)
-        {
-            supportSwapchain = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-        if (strcmp(currExtName, VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME) == 0)
-        {
-            supportScalarBlock = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-        if (strcmp(currExtName, VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME) == 0)
-        {
-            s_supportIncrementalPresent = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-        if (strcmp(currExtName, VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME) == 0)
-        {
-            supportDriverProperties = true;
-            availExtensionNames[availExtensionCount++] = currExtName;
-            continue;
-        }
-    }
-    if (!supportSwapchain) {
-        printf("%s feature not supported!\n", VK_KHR_SWAPCHAIN_EXTENSION_NAME);
-    }
-    if (!s_supportIncrementalPresent) {
-        printf("%s feature not supported!\n", VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
-    }
-    if (!supportDriverProperties) {
-        printf("%s feature not supported or not explicitly given!\n", VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME);
-    }
-
-    printf("Available required device extension count: %u\n\n", availExtensionCount);
-
-    // Query detail driver info
-    VkPhysicalDeviceDriverProperties driverProps = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DRIVER_PROPERTIES,
-        // link to subgroupSizeProps node
-        .pNext = NULL
-    };
-
-    VkPhysicalDeviceProperties2 properties2 = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
-        // link to driverProps
-        .pNext = &driverProps
-    };
-
-    // Query all above properties
-    vkGetPhysicalDeviceProperties2(s_currPhysicalDevice, &properties2);
-    printf("Detail driver info: %s %s\n", driverProps.driverName, driverProps.driverInfo);
-
-    // ==== The following is query the specific extension features in the feature chaining form ====
-    VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlockLayoutFeature = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
-        .pNext = NULL
-    };
-
-    // physical device feature 2
-    VkPhysicalDeviceFeatures2 features2 = {
-        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
-        // link to subgroupSizeControlFeature node
-        .pNext = &scalarBlockLayoutFeature
-    };
-
-    // Query all above features
-    vkGetPhysicalDeviceFeatures2(s_currPhysicalDevice, &features2);
-
-    if (scalarBlockLayoutFeature.scalarBlockLayout == VK_FALSE) {
-        printf("%s feature not supported!\n", VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME);
-    }
-
-    const float queue_priorities[1] = { 0.0f };
-    VkDeviceQueueCreateInfo queue_info = {
-        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-        .pNext = NULL,
-        .queueCount = 1,
-        .pQueuePriorities = queue_priorities
-    };
-
-    VkQueueFamilyProperties queueFamilyProperties[MAX_QUEUE_FAMILY_PROPERTY_COUNT];
-
-    vkGetPhysicalDeviceQueueFamilyProperties(s_currPhysicalDevice, &s_queueFamilyPropertyCount, NULL);
-    s_queueFamilyPropertyCount = min(s_queueFamilyPropertyCount, MAX_QUEUE_FAMILY_PROPERTY_COUNT);
-
-    vkGetPhysicalDeviceQueueFamilyProperties(s_currPhysicalDevice, &s_queueFamilyPropertyCount, queueFamilyProperties);
-
-    bool found = false;
-    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; i++)
-    {
-        if ((queueFamilyProperties[i].queueFlags & queueFlag) != 0 &&
-            // Query whether the current queue supports presentation operations
-            vkGetPhysicalDeviceWin32PresentationSupportKHR(s_currPhysicalDevice, i) == VK_TRUE)
-        {
-            queue_info.queueFamilyIndex = i;
-            found = true;
-            break;
-        }
-    }
-
-    s_specQueueFamilyIndex = queue_info.queueFamilyIndex;
-
-    // There are two ways to enable features:
-    // (1) Set pNext to a VkPhysicalDeviceFeatures2 structure and set pEnabledFeatures to NULL;
-    // (2) or set pNext to NULL and set pEnabledFeatures to a VkPhysicalDeviceFeatures structure.
-    // Here uses the first way
-    const VkDeviceCreateInfo device_info = {
-        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-        .pNext = &features2,
-        .queueCreateInfoCount = 1,
-        .pQueueCreateInfos = &queue_info,
-        .enabledLayerCount = 0,
-        .ppEnabledLayerNames = NULL,
-        .enabledExtensionCount = availExtensionCount,
-        .ppEnabledExtensionNames = availExtensionNames,
-        .pEnabledFeatures = NULL
-    };
-
-    res = vkCreateDevice(s_currPhysicalDevice, &device_info, NULL, &s_specDevice);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateDevice failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateVulkanSurface(HINSTANCE hInstane, HWND hWnd)
-{
-    // Destroy the surface object if it has already existed.
-    if (s_surface != VK_NULL_HANDLE) {
-        vkDestroySurfaceKHR(s_instance, s_surface, NULL);
-    }
-
-    // Create a WSI surface for the window:
-    const VkWin32SurfaceCreateInfoKHR createInfo = {
-        .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
-        .pNext = NULL,
-        .flags = 0,
-        .hinstance = hInstane,
-        .hwnd = hWnd
-    };
-
-    VkResult res = vkCreateWin32SurfaceKHR(s_instance, &createInfo, NULL, &s_surface);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateWin32SurfaceKHR failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateVulkanSwapchain(void)
-{
-    // Iterate over each queue to learn whether it supports presenting:
-    VkBool32 supportsPresents[MAX_QUEUE_FAMILY_PROPERTY_COUNT] = { VK_FALSE };
-    VkResult res;
-    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
-    {
-        res = vkGetPhysicalDeviceSurfaceSupportKHR(s_currPhysicalDevice, i, s_surface, &supportsPresents[i]);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkGetPhysicalDeviceSurfaceSupportKHR failed @%u: %d\n", i, res);
-            return false;
-        }
-    }
-
-    VkQueueFamilyProperties queue_props[MAX_QUEUE_FAMILY_PROPERTY_COUNT] = { 0 };
-    vkGetPhysicalDeviceQueueFamilyProperties(s_currPhysicalDevice, &s_queueFamilyPropertyCount, queue_props);
-
-    // Search for a graphics and a present queue in the array of queue families,
-    // try to find one that supports both
-    uint32_t graphicsQueueFamilyIndex = UINT32_MAX;
-    uint32_t presentQueueFamilyIndex = UINT32_MAX;
-    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
-    {
-        if ((queue_props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0)
-        {
-            if (graphicsQueueFamilyIndex == UINT32_MAX) {
-                graphicsQueueFamilyIndex = i;
-            }
-            if (supportsPresents[i] == VK_TRUE)
-            {
-                graphicsQueueFamilyIndex = i;
-                presentQueueFamilyIndex = i;
-                break;
-            }
-        }
-    }
-
-    if (presentQueueFamilyIndex == UINT32_MAX)
-    {
-        // If didn't find a queue that supports both graphics and present, then
-        // find a separate present queue.
-        for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
-        {
-            if (supportsPresents[i] == VK_TRUE)
-            {
-                presentQueueFamilyIndex = i;
-                break;
-            }
-        }
-    }
-
-    // Generate error if could not find both a graphics and a present queue
-    if (graphicsQueueFamilyIndex == UINT32_MAX || presentQueueFamilyIndex == UINT32_MAX)
-    {
-        puts("Could not find both graphics and present queues!");
-        return false;
-    }
-
-    s_graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
-    s_presentQueueFamilyIndex = presentQueueFamilyIndex;
-    const bool isSeparatePresentQueue = graphicsQueueFamilyIndex != presentQueueFamilyIndex;
-
-    vkGetDeviceQueue(s_specDevice, graphicsQueueFamilyIndex, 0, &s_graphicsQueue);
-
-    if (!isSeparatePresentQueue) {
-        s_presentQueue = s_graphicsQueue;
-    }
-    else {
-        vkGetDeviceQueue(s_specDevice, presentQueueFamilyIndex, 0, &s_presentQueue);
-    }
-
-    // Check the surface capabilities and formats
-    VkSurfaceCapabilitiesKHR surfCapabilities = { 0 };
-    res = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(s_currPhysicalDevice, s_surface, &surfCapabilities);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetPhysicalDeviceSurfaceCapabilitiesKHR failed: %d\n", res);
-        return false;
-    }
-
-    // Determine the number of VkImages to use in the swap chain.
-    // Application desires to acquire 3 images at a time for triple buffering
-    uint32_t desiredNumOfSwapchainImages = 3;
-    desiredNumOfSwapchainImages = max(desiredNumOfSwapchainImages, surfCapabilities.minImageCount);
-    // If maxImageCount is 0, we can ask for as many images as we want;
-    // otherwise we're limited to maxImageCount
-    if (surfCapabilities.maxImageCount > 0) {
-        // Application must settle for fewer images than desired:
-        desiredNumOfSwapchainImages = min(desiredNumOfSwapchainImages, surfCapabilities.maxImageCount);
-    }
-
-    // Get the list of VkFormat's that are supported:
-    uint32_t formatCount = 0;
-    res = vkGetPhysicalDeviceSurfaceFormatsKHR(s_currPhysicalDevice, s_surface, &formatCount, NULL);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetPhysicalDeviceSurfaceFormatsKHR for count failed: %d\n", res);
-        return false;
-    }
-    formatCount = min(formatCount, MAX_FORMAT_COUNT);
-
-    VkSurfaceFormatKHR surfaceFormats[MAX_FORMAT_COUNT];
-    res = vkGetPhysicalDeviceSurfaceFormatsKHR(s_currPhysicalDevice, s_surface, &formatCount, surfaceFormats);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetPhysicalDeviceSurfaceFormatsKHR for content failed: %d\n", res);
-        return false;
-    }
-
-    // Prefer extended SRGB, then normal SRGB and last UNORM RGBA
-    const uint64_t preferredSurfaceFormatList[] = {
-        ((uint64_t)VK_FORMAT_R16G16B16A16_SFLOAT << 32) | VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT,
-        ((uint64_t)VK_FORMAT_A2B10G10R10_UNORM_PACK32 << 32) | VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
-        ((uint64_t)VK_FORMAT_R8G8B8A8_SRGB << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
-        ((uint64_t)VK_FORMAT_B8G8R8A8_SRGB << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
-        ((uint64_t)VK_FORMAT_R8G8B8A8_UNORM << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
-        ((uint64_t)VK_FORMAT_B8G8R8A8_UNORM << 32)| VK_COLORSPACE_SRGB_NONLINEAR_KHR
-    };
-    enum {
-        preferredFormatCount = sizeof(preferredSurfaceFormatList) / sizeof(preferredSurfaceFormatList[0])
-    };
-
-    bool foundPreferredFormat = false;
-    for (int i = 0; i < preferredFormatCount; ++i)
-    {
-        const uint64_t currPreferredFormat = preferredSurfaceFormatList[i];
-        for (uint32_t j = 0; j < formatCount; ++j)
-        {
-            const VkFormat format = surfaceFormats[j].format;
-            const VkColorSpaceKHR colorSpace = surfaceFormats[j].colorSpace;
-            if (currPreferredFormat == (((uint64_t)format << 32) | colorSpace))
-            {
-                s_surfaceFormat = surfaceFormats[j];
-                foundPreferredFormat = true;
-                break;
-            }
-        }
-        if (foundPreferredFormat) {
-            break;
-        }
-    }
-    if (!foundPreferredFormat)
-    {
-        printf("Can't find our preferred formats... Falling back to first exposed format. Rendering may be incorrect.\n");
-        s_surfaceFormat = surfaceFormats[0];
-    }
-
-    VkExtent2D swapchainExtent;
-    // width and height are either both 0xFFFFFFFF, or both not 0xFFFFFFFF.
-    if (surfCapabilities.currentExtent.width == 0xffffffffU || surfCapabilities.currentExtent.height == 0xffffffffU)
-    {
-        // If the surface size is undefined, the size is set to the size
-        // of the images requested, which must fit within the minimum and
-        // maximum values.
-        swapchainExtent.width = s_render_width;
-        swapchainExtent.height = s_render_height;
-
-        swapchainExtent.width = max(swapchainExtent.width, surfCapabilities.minImageExtent.width);
-        swapchainExtent.width = min(swapchainExtent.width, surfCapabilities.maxImageExtent.width);
-
-        swapchainExtent.height = max(swapchainExtent.height, surfCapabilities.minImageExtent.height);
-        swapchainExtent.height = min(swapchainExtent.height, surfCapabilities.maxImageExtent.height);
-    }
-    else
-    {
-        // If the surface size is defined, the swap chain size must match
-        swapchainExtent = surfCapabilities.currentExtent;
-        s_render_width = surfCapabilities.currentExtent.width;
-        s_render_height = surfCapabilities.currentExtent.height;
-    }
-
-    if (s_render_width == 0 || s_render_height == 0) {
-        // In the window minimized situation
-        return true;
-    }
-
-    uint32_t presentModeCount = 0;
-    res = vkGetPhysicalDeviceSurfacePresentModesKHR(s_currPhysicalDevice, s_surface, &presentModeCount, NULL);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetPhysicalDeviceSurfacePresentModesKHR for count failed: %d\n", res);
-        return false;
-    }
-    presentModeCount = min(presentModeCount, MAX_PRESENT_MODE_COUNT);
-
-    VkPresentModeKHR presentModes[MAX_PRESENT_MODE_COUNT] = { 0 };
-    res = vkGetPhysicalDeviceSurfacePresentModesKHR(s_currPhysicalDevice, s_surface, &presentModeCount, presentModes);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetPhysicalDeviceSurfacePresentModesKHR for content failed: %d\n", res);
-        return false;
-    }
-
-    // The FIFO present mode is guaranteed by the spec to be supported
-    // and to have no tearing.  It's a great default present mode to use.
-    const VkPresentModeKHR preferredPresentModes[] = {
-        //VK_PRESENT_MODE_FIFO_RELAXED_KHR,
-        VK_PRESENT_MODE_FIFO_KHR
-    };
-
-    //  There are times when you may wish to use another present mode.  The
-    //  following code shows how to select them, and the comments provide some
-    //  reasons you may wish to use them.
-    //
-    // It should be noted that Vulkan 1.0 doesn't provide a method for
-    // synchronizing rendering with the presentation engine's display.  There
-    // is a method provided for throttling rendering with the display, but
-    // there are some presentation engines for which this method will not work.
-    // If an application doesn't throttle its rendering, and if it renders much
-    // faster than the refresh rate of the display, this can waste power on
-    // mobile devices.  That is because power is being spent rendering images
-    // that may never be seen.
-
-    // VK_PRESENT_MODE_IMMEDIATE_KHR is for applications that don't care about
-    // tearing, or have some way of synchronizing their rendering with the
-    // display.
-    // VK_PRESENT_MODE_MAILBOX_KHR may be useful for applications that
-    // generally render a new presentable image every refresh cycle, but are
-    // occasionally early.  In this case, the application wants the new image
-    // to be displayed instead of the previously-queued-for-presentation image
-    // that has not yet been displayed.
-    // VK_PRESENT_MODE_FIFO_RELAXED_KHR is for applications that generally
-    // render a new presentable image every refresh cycle, but are occasionally
-    // late.  In this case (perhaps because of stuttering/latency concerns),
-    // the application wants the late image to be immediately displayed, even
-    // though that may mean some tearing.
-    VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
-
-    bool foundPreferredPresentMode = false;
-    for (size_t i = 0; i < sizeof(preferredPresentModes) / sizeof(preferredPresentModes[0]); ++i)
-    {
-        const VkPresentModeKHR currPreferredPresentMode = preferredPresentModes[i];
-        for (uint32_t j = 0; j < presentModeCount; ++j)
-        {
-            if (presentModes[j] == currPreferredPresentMode)
-            {
-                swapchainPresentMode = currPreferredPresentMode;
-                foundPreferredPresentMode = true;
-                break;
-            }
-        }
-        if (foundPreferredPresentMode) {
-            break;
-        }
-    }
-
-    if (!foundPreferredPresentMode)
-    {
-        puts("Preferred present mode is not found!");
-        return false;
-    }
-
-    VkSurfaceTransformFlagsKHR preTransform;
-    if ((surfCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) != 0) {
-        preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
-    }
-    else {
-        preTransform = surfCapabilities.currentTransform;
-    }
-
-    // Find a supported composite alpha mode - one of these is guaranteed to be set
-    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
-    VkCompositeAlphaFlagBitsKHR compositeAlphaFlags[] = {
-        VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-        VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
-        VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR,
-        VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
-    };
-    for (size_t i = 0; i < sizeof(compositeAlphaFlags) / sizeof(compositeAlphaFlags[0]); ++i)
-    {
-        if (surfCapabilities.supportedCompositeAlpha & compositeAlphaFlags[i]) {
-            compositeAlpha = compositeAlphaFlags[i];
-            break;
-        }
-    }
-
-    VkSwapchainKHR oldSwapchain = s_swapchain;
-
-    const VkSwapchainCreateInfoKHR swapchainCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
-        .pNext = NULL,
-        .flags = 0,
-        .surface = s_surface,
-        .minImageCount = desiredNumOfSwapchainImages,
-        .imageFormat = s_surfaceFormat.format,
-        .imageColorSpace = s_surfaceFormat.colorSpace,
-        .imageExtent = swapchainExtent,
-        .imageArrayLayers = 1,
-        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_specQueueFamilyIndex,
-        .preTransform = preTransform,
-        .compositeAlpha = compositeAlpha,
-        .presentMode = swapchainPresentMode,
-        .clipped = true,
-        .oldSwapchain = oldSwapchain
-    };
-    res = vkCreateSwapchainKHR(s_specDevice, &swapchainCreateInfo, NULL, &s_swapchain);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateSwapchainKHR failed: %d\n", res);
-        return false;
-    }
-
-    // If we just re-created an existing swapchain, we should destroy the old
-    // swapchain at this point.
-    // Note: destroying the swapchain also cleans up all its associated
-    // presentable images once the platform is done with them.
-    if (oldSwapchain != VK_NULL_HANDLE) {
-        vkDestroySwapchainKHR(s_specDevice, oldSwapchain, NULL);
-    }
-
-    res = vkGetSwapchainImagesKHR(s_specDevice, s_swapchain, &s_swapchainImageCount, NULL);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetSwapchainImagesKHR for count failed: %d\n", res);
-        return false;
-    }
-
-    VkImage swapchainImages[MAX_SWAPCHAIN_IMAGE_COUNT];
-    res = vkGetSwapchainImagesKHR(s_specDevice, s_swapchain, &s_swapchainImageCount, swapchainImages);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkGetSwapchainImagesKHR for content faile: %d\n", res);
-        return false;
-    }
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; i++)
-    {
-        const VkImageViewCreateInfo swapchainImageView = {
-            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0,
-            .image = swapchainImages[i],
-            .viewType = VK_IMAGE_VIEW_TYPE_2D,
-            .format = s_surfaceFormat.format,
-            .components =
-                {
-                    .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-                    .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-                    .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-                    .a = VK_COMPONENT_SWIZZLE_IDENTITY,
-                },
-            .subresourceRange =
-                {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = 1, 
-                .baseArrayLayer = 0, .layerCount = 1}
-        };
-        res = vkCreateImageView(s_specDevice, &swapchainImageView, NULL, &s_swapchainImageResources[i].view);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateImageView for swapchain failed: %d\n", res);
-            return false;
-        }
-
-        s_swapchainImageResources[i].image = swapchainImages[i];
-    }
-
-    return true;
-}
-
-static bool CreateFencesAndSemaphores(void)
-{
-    // Create semaphores to synchronize acquiring presentable buffers before
-    // rendering and waiting for drawing to be complete before presenting
-    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-    };
-
-    // Create fences that we can use to throttle if we get too far
-    // ahead of the image presents
-    const VkFenceCreateInfo fenceCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = VK_FENCE_CREATE_SIGNALED_BIT
-    };
-
-    for (uint32_t i = 0; i < FRAME_LAG; i++)
-    {
-        VkResult res = vkCreateFence(s_specDevice, &fenceCreateInfo, NULL, &s_presentFences[i]);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateFence @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, NULL, &s_imageAcquiredSemaphores[i]);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateSemaphore for s_imageAcquiredSemaphores @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, NULL, &s_drawCompleteSemaphores[i]);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateSemaphore for s_drawCompleteSemaphores @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        if (IsSeperatePresentQueue())
-        {
-            res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, NULL, &s_imageOwnershipSemaphores[i]);
-            if (res != VK_SUCCESS)
-            {
-                printf("vkCreateSemaphore for s_imageOwnershipSemaphores @%u failed: %d\n", i, res);
-                return false;
-            }
-        }
-    }
-
-    return true;
-}
-
-static bool BuildPresentImageOwnershipTransition(uint32_t imageIndex)
-{
-    const VkCommandBufferBeginInfo cmd_buf_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = NULL,
-        .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-        .pInheritanceInfo = NULL,
-    };
-    VkResult res = vkBeginCommandBuffer(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf, &cmd_buf_info);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkBeginCommandBuffer for present command @%u failed: %d\n", imageIndex, res);
-        return false;
-    }
-
-    VkImageMemoryBarrier image_ownership_barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-                                                    .pNext = NULL,
-                                                    .srcAccessMask = 0,
-                                                    .dstAccessMask = 0,
-                                                    .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                                                    .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-                                                    .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
-                                                    .dstQueueFamilyIndex = s_presentQueueFamilyIndex,
-                                                    .image = s_swapchainImageResources[imageIndex].image,
-                                                    .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1} };
-    // Transfer the swapchain image ownership from graphics queue family to present queue family
-    vkCmdPipelineBarrier(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
-        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &image_ownership_barrier);
-
-    res = vkEndCommandBuffer(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEndCommandBuffer failed in BuildPresentImageCommand: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateCommandBufferAndBeginCommand(void)
-{
-    const VkCommandPoolCreateInfo cmdPoolInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-        .pNext = NULL,
-        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-        .queueFamilyIndex = s_graphicsQueueFamilyIndex
-    };
-
-    VkResult res = vkCreateCommandPool(s_specDevice, &cmdPoolInfo, NULL, &s_commandPool);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateCommandPool failed: %d\n", res);
-        return false;
-    }
-
-    // Create the command buffer from the command pool
-    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-        .pNext = NULL,
-        .commandPool = s_commandPool,
-        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-        .commandBufferCount = (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0]))
-    };
-
-    res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, s_commandBuffers);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkAllocateCommandBuffers failed: %d\n", res);
-        return false;
-    }
-
-    // Create command buffers for swapchain images
-    for (uint32_t i = 0; i < s_swapchainImageCount; i++)
-    {
-        res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, &s_swapchainImageResources[i].cmd_buf);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkAllocateCommandBuffers for swapchain @%u failed: %d\n", i, res);
-            return false;
-        }
-    }
-
-    if (IsSeperatePresentQueue())
-    {
-        const VkCommandPoolCreateInfo present_cmd_pool_info = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
-            .pNext = NULL,
-            .queueFamilyIndex = s_presentQueueFamilyIndex,
-            .flags = 0,
-        };
-        res = vkCreateCommandPool(s_specDevice, &present_cmd_pool_info, NULL, &s_presentCommandPool);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateCommandPool failed: %d\n", res);
-            return false;
-        }
-        const VkCommandBufferAllocateInfo present_cmd_info = {
-            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
-            .pNext = NULL,
-            .commandPool = s_presentCommandPool,
-            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
-            .commandBufferCount = 1,
-        };
-        for (uint32_t i = 0; i < s_swapchainImageCount; i++)
-        {
-            res = vkAllocateCommandBuffers(s_specDevice, &present_cmd_info, &s_swapchainImageResources[i].graphics_to_present_cmd_buf);
-            if (res != VK_SUCCESS)
-            {
-                printf("vkAllocateCommandBuffers for graphics to present failed: %d\n", res);
-                return false;
-            }
-
-            if (!BuildPresentImageOwnershipTransition(i)) {
-                return false;
-            }
-        }
-    }
-
-    const VkCommandBufferBeginInfo cmdBufBeginInfo = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = NULL,
-        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
-        .pInheritanceInfo = NULL,
-    };
-    res = vkBeginCommandBuffer(s_commandBuffers[0], &cmdBufBeginInfo);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkBeginCommandBuffer failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateVertexAndUniformBuffersAndMemories(void)
-{    
-    VkPhysicalDeviceMemoryProperties memoryProperties = { 0 };
-    vkGetPhysicalDeviceMemoryProperties(s_currPhysicalDevice, &memoryProperties);
-
-    const VkBufferCreateInfo hostVertexBufferCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .size = sizeof(s_vertex_coords_data) + sizeof(s_vertex_color_data) + sizeof(FlattenVertexUniform),
-        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
-    };
-    VkResult res = vkCreateBuffer(s_specDevice, &hostVertexBufferCreateInfo, NULL, &s_hostVertexAndUniformBuffer);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateBuffer for host vertex and uniform buffer failed: %d\n", res);
-        return false;
-    }
-
-    VkMemoryRequirements hostVertexMemoryRequirements = { 0 };
-    vkGetBufferMemoryRequirements(s_specDevice, s_hostVertexAndUniformBuffer, &hostVertexMemoryRequirements);
-
-    uint32_t memoryTypeIndex;
-    // Find host visible property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-    {
-        if ((hostVertexMemoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 &&
-            (memoryType.propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0 &&
-            memoryProperties.memoryHeaps[memoryType.heapIndex].size >= hostVertexMemoryRequirements.size)
-        {
-            // found our memory type!
-            printf("Host visible memory size: %zuMB\n", memoryProperties.memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
-    const VkMemoryAllocateInfo hostMemAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = hostVertexMemoryRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex
-    };
-
-    res = vkAllocateMemory(s_specDevice, &hostMemAllocInfo, NULL, &s_hostVertexUniformMemory);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkAllocateMemory for host vertex and uniform memory failed: %d\n", res);
-        return res;
-    }
-
-    res = vkBindBufferMemory(s_specDevice, s_hostVertexAndUniformBuffer, s_hostVertexUniformMemory, 0);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkBindBufferMemory failed: %d\n", res);
-        return res;
-    }
-
-    const VkBufferCreateInfo deviceCoordsBufferCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .size = sizeof(s_vertex_coords_data),
-        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
-    };
-
-    const VkBufferCreateInfo deviceColorBufferCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .size = sizeof(s_vertex_color_data),
-        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
-    };
-
-    const VkBufferCreateInfo uniformBufferCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .size = sizeof(FlattenVertexUniform),
-        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
-    };
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        res = vkCreateBuffer(s_specDevice, &deviceCoordsBufferCreateInfo, NULL, &s_swapchainImageResources[i].coords_buffer);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateBuffer for vertex coords buffer @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkCreateBuffer(s_specDevice, &deviceColorBufferCreateInfo, NULL, &s_swapchainImageResources[i].color_buffer);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateBuffer for vertex color buffer @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        VkMemoryRequirements deviceVertexMemoryRequirements = { 0 };
-        vkGetBufferMemoryRequirements(s_specDevice, s_swapchainImageResources[i].coords_buffer, &deviceVertexMemoryRequirements);
-        const size_t totalDeviceVertexBufferSize = deviceVertexMemoryRequirements.size * 2;
-
-        // Find host visible property memory type index
-        for (memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-        {
-            if ((deviceVertexMemoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-                continue;
-            }
-            const VkMemoryType memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-            if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-                memoryProperties.memoryHeaps[memoryType.heapIndex].size >= totalDeviceVertexBufferSize) {
-                // found our memory type!
-                break;
-            }
-        }
-
-        const VkMemoryAllocateInfo deviceVertexMemAllocInfo = {
-            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .pNext = NULL,
-            .allocationSize = totalDeviceVertexBufferSize,
-            .memoryTypeIndex = memoryTypeIndex
-        };
-
-        res = vkAllocateMemory(s_specDevice, &deviceVertexMemAllocInfo, NULL, &s_swapchainImageResources[i].vertex_memory);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkAllocateMemory for vertex buffer @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].coords_buffer, s_swapchainImageResources[i].vertex_memory, 0);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].color_buffer, s_swapchainImageResources[i].vertex_memory, sizeof(s_vertex_coords_data));
-        if (res != VK_SUCCESS)
-        {
-            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkCreateBuffer(s_specDevice, &uniformBufferCreateInfo, NULL, &s_swapchainImageResources[i].uniform_buffer);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateBuffer for uniform buffer @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        vkGetBufferMemoryRequirements(s_specDevice, s_swapchainImageResources[i].uniform_buffer, &deviceVertexMemoryRequirements);
-
-        for (memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-        {
-            if ((deviceVertexMemoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-                continue;
-            }
-            const VkMemoryType memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-            if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-                memoryProperties.memoryHeaps[memoryType.heapIndex].size >= deviceVertexMemoryRequirements.size) {
-                // found our memory type!
-                break;
-            }
-        }
-
-        const VkMemoryAllocateInfo deviceUniformMemAllocInfo = {
-            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-            .pNext = NULL,
-            .allocationSize = deviceVertexMemoryRequirements.size,
-            .memoryTypeIndex = memoryTypeIndex
-        };
-
-        res = vkAllocateMemory(s_specDevice, &deviceUniformMemAllocInfo, NULL, &s_swapchainImageResources[i].uniform_memory);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkAllocateMemory for uniform buffer @%u failed: %d\n", i, res);
-            return false;
-        }
-
-        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].uniform_buffer, s_swapchainImageResources[i].uniform_memory, 0);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
-            return false;
-        }
-    }
-
-    // Fill the vertex coordinate data into the host memory object
-    uint8_t *hostData = NULL;
-    res = vkMapMemory(s_specDevice, s_hostVertexUniformMemory, 0, hostVertexMemoryRequirements.size, 0, &hostData);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkMapMemory in CreateVertexAndUniformBuffersAndMemories failed: %d\n", res);
-        return false;
-    }
-
-    memcpy(hostData, s_vertex_coords_data, sizeof(s_vertex_coords_data));
-    memcpy(&hostData[sizeof(s_vertex_coords_data)], s_vertex_color_data, sizeof(s_vertex_color_data));
-
-    vkUnmapMemory(s_specDevice, s_hostVertexUniformMemory);
-
-    return true;
-}
-
-static void CopyFromHostToDeviceBuffersAndSync(void)
-{
-    const VkBufferCopy copyCoordsRegion = {
-        .srcOffset = 0,
-        .dstOffset = 0,
-        .size = sizeof(s_vertex_coords_data)
-    };
-    const VkBufferCopy copyColorRegion = {
-        .srcOffset = sizeof(s_vertex_coords_data),
-        .dstOffset = 0,
-        .size = sizeof(s_vertex_color_data)
-    };
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        vkCmdCopyBuffer(s_commandBuffers[0], s_hostVertexAndUniformBuffer, s_swapchainImageResources[i].coords_buffer, 1, &copyCoordsRegion);
-        vkCmdCopyBuffer(s_commandBuffers[0], s_hostVertexAndUniformBuffer, s_swapchainImageResources[i].color_buffer, 1, &copyColorRegion);
-    }
-
-    VkBufferMemoryBarrier bufferBarriers[MAX_SWAPCHAIN_IMAGE_COUNT * 2];
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        // coords buffer barrier
-        bufferBarriers[i * 2 + 0].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        bufferBarriers[i * 2 + 0].pNext = NULL;
-        bufferBarriers[i * 2 + 0].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        bufferBarriers[i * 2 + 0].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarriers[i * 2 + 0].srcQueueFamilyIndex = s_graphicsQueueFamilyIndex;
-        bufferBarriers[i * 2 + 0].dstQueueFamilyIndex = s_graphicsQueueFamilyIndex;
-        bufferBarriers[i * 2 + 0].buffer = s_swapchainImageResources[i].coords_buffer;
-        bufferBarriers[i * 2 + 0].offset = 0;
-        bufferBarriers[i * 2 + 0].size = sizeof(s_vertex_coords_data);
-
-        // color buffer barrier
-        bufferBarriers[i * 2 + 1].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-        bufferBarriers[i * 2 + 1].pNext = NULL;
-        bufferBarriers[i * 2 + 1].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-        bufferBarriers[i * 2 + 1].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-        bufferBarriers[i * 2 + 1].srcQueueFamilyIndex = s_graphicsQueueFamilyIndex;
-        bufferBarriers[i * 2 + 1].dstQueueFamilyIndex = s_graphicsQueueFamilyIndex;
-        bufferBarriers[i * 2 + 1].buffer = s_swapchainImageResources[i].color_buffer;
-        bufferBarriers[i * 2 + 1].offset = 0;
-        bufferBarriers[i * 2 + 1].size = sizeof(s_vertex_color_data);
-    }
-
-    vkCmdPipelineBarrier(s_commandBuffers[0], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
-        0, NULL, s_swapchainImageCount * 2, bufferBarriers, 0, NULL);
-}
-
-static bool CreateDepthReource(void)
-{
-    const VkImageCreateInfo imageCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .imageType = VK_IMAGE_TYPE_2D,
-        .format = s_depth_format,
-        .extent = { s_render_width, s_render_height, 1 },
-        .mipLevels = 1,
-        .arrayLayers = 1,
-        .samples = VK_SAMPLE_COUNT_1_BIT,
-        .tiling = VK_IMAGE_TILING_OPTIMAL,
-        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-        .queueFamilyIndexCount = 1,
-        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex,
-        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
-    };
-
-    VkResult res = vkCreateImage(s_specDevice, &imageCreateInfo, NULL, &s_depthResource.image);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateImage for depth faild: %d\n", res);
-        return false;
-    }
-
-    VkMemoryRequirements memoryRequirements = { 0 };
-    vkGetImageMemoryRequirements(s_specDevice, s_depthResource.image, &memoryRequirements);
-
-    VkPhysicalDeviceMemoryProperties memoryProperties = { 0 };
-    vkGetPhysicalDeviceMemoryProperties(s_currPhysicalDevice, &memoryProperties);
-
-    uint32_t memoryTypeIndex;
-    // Find host visible property memory type index
-    for (memoryTypeIndex = 0; memoryTypeIndex < memoryProperties.memoryTypeCount; ++memoryTypeIndex)
-    {
-        if ((memoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) == 0U) {
-            continue;
-        }
-        const VkMemoryType memoryType = memoryProperties.memoryTypes[memoryTypeIndex];
-        if ((memoryType.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) != 0 &&
-            memoryProperties.memoryHeaps[memoryType.heapIndex].size >= memoryRequirements.size)
-        {
-            // found our memory type!
-            printf("Device local memory size: %zuMB\n", memoryProperties.memoryHeaps[memoryType.heapIndex].size / (1024 * 1024));
-            break;
-        }
-    }
-
-    const VkMemoryAllocateInfo memAllocInfo = {
-        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-        .pNext = NULL,
-        .allocationSize = memoryRequirements.size,
-        .memoryTypeIndex = memoryTypeIndex
-    };
-
-    res = vkAllocateMemory(s_specDevice, &memAllocInfo, NULL, &s_depthResource.device_memory);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkAllocateMemory for depth failed: %d\n", res);
-        return false;
-    }
-
-    res = vkBindImageMemory(s_specDevice, s_depthResource.image, s_depthResource.device_memory, 0);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkBindImageMemory for depth failed: %d\n", res);
-        return false;
-    }
-
-    const VkImageViewCreateInfo imageViewCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .image = s_depthResource.image,
-        .viewType = VK_IMAGE_VIEW_TYPE_2D,
-        .format = s_depth_format,
-        .components = {
-            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
-            .a = VK_COMPONENT_SWIZZLE_IDENTITY
-        },
-        .subresourceRange = {
-            .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT, 
-            .baseMipLevel = 0, 
-            .levelCount = 1, 
-            .baseArrayLayer = 0, 
-            .layerCount = 1
-        }
-    };
-
-    res = vkCreateImageView(s_specDevice, &imageViewCreateInfo, NULL, &s_depthResource.image_view);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateImageView for depth failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateDescriptorSetAndPipelineLayout(void)
-{
-    const VkDescriptorSetLayoutBinding layoutBindings[] = {
-        {
-            .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
-            .pImmutableSamplers = NULL,
-        }
-    };
-
-    const VkDescriptorSetLayoutCreateInfo descriptor_layout = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .bindingCount = (uint32_t)(sizeof(layoutBindings) / sizeof(layoutBindings[0])),
-        .pBindings = layoutBindings,
-    };
-
-    VkResult res = vkCreateDescriptorSetLayout(s_specDevice, &descriptor_layout, NULL, &s_descSetLayout);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateDescriptorSetLayout failed: %d\n", res);
-        return false;
-    }
-
-    const VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
-        .pNext = NULL,
-        .setLayoutCount = 1,
-        .pSetLayouts = &s_descSetLayout,
-    };
-
-    res = vkCreatePipelineLayout(s_specDevice, &pPipelineLayoutCreateInfo, NULL, &s_pipelineLayout);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreatePipelineLayout failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateRenderPass(void)
-{
-    // The initial layout for the color and depth attachments will be LAYOUT_UNDEFINED
-    // because at the start of the renderpass, we don't care about their contents.
-    // At the start of the subpass, the color attachment's layout will be transitioned
-    // to LAYOUT_COLOR_ATTACHMENT_OPTIMAL and the depth stencil attachment's layout
-    // will be transitioned to LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL.  At the end of
-    // the renderpass, the color attachment's layout will be transitioned to
-    // LAYOUT_PRESENT_SRC_KHR to be ready to present.  This is all done as part of
-    // the renderpass, no barriers are necessary.
-    const VkAttachmentDescription attachments[] = {
-        // color attachment
-        {
-            .flags = 0,
-            .format = s_surfaceFormat.format,
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
-            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-        },
-        // depth attachment
-        {
-            .format = s_depth_format,
-            .flags = 0,
-            .samples = VK_SAMPLE_COUNT_1_BIT,
-            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
-            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-        }
-    };
-    const VkAttachmentReference color_reference = {
-        .attachment = 0,
-        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-    };
-    const VkAttachmentReference depth_reference = {
-        .attachment = 1,
-        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
-    };
-    const VkSubpassDescription subpasses[1] = {
-        {
-            .flags = 0,
-            .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
-            .inputAttachmentCount = 0,
-            .pInputAttachments = NULL,
-            .colorAttachmentCount = 1,
-            .pColorAttachments = &color_reference,
-            .pResolveAttachments = NULL,
-            .pDepthStencilAttachment = &depth_reference,
-            .preserveAttachmentCount = 0,
-            .pPreserveAttachments = NULL,
-        }
-    };
-
-    VkSubpassDependency attachmentDependencies[] = {
-        // Depth buffer is shared between swapchain images
-        {
-            .srcSubpass = VK_SUBPASS_EXTERNAL,
-            .dstSubpass = 0,
-            .srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
-            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
-            .dependencyFlags = 0
-        },
-        // Image Layout Transition
-        {
-            .srcSubpass = VK_SUBPASS_EXTERNAL,
-            .dstSubpass = 0,
-            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .srcAccessMask = 0,
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
-            .dependencyFlags = 0,
-        },
-    };
-
-    const VkRenderPassCreateInfo renderPassCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .attachmentCount = (uint32_t)(sizeof(attachments) / sizeof(attachments[0])),
-        .pAttachments = attachments,
-        .subpassCount = (uint32_t)(sizeof(subpasses) / sizeof(subpasses[0])),
-        .pSubpasses = subpasses,
-        .dependencyCount = (uint32_t)(sizeof(attachmentDependencies) / sizeof(attachmentDependencies[0])),
-        .pDependencies = attachmentDependencies,
-    };
-
-    VkResult res = vkCreateRenderPass(s_specDevice, &renderPassCreateInfo, NULL, &s_render_pass);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateRenderPass failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool CreateShaderModule(const char* fileName, VkShaderModule* pShaderModule)
-{
-    FILE* fp = GeneralOpenFile(fileName);
-    if (fp == NULL)
-    {
-        printf("Shader file %s not found!\n", fileName);
-        return false;
-    }
-    fseek(fp, 0, SEEK_END);
-    size_t fileLen = ftell(fp);
-    fseek(fp, 0, SEEK_SET);
-
-    uint32_t* codeBuffer = malloc(fileLen);
-    if (codeBuffer != NULL) {
-        fread(codeBuffer, 1, fileLen, fp);
-    }
-    fclose(fp);
-
-    const VkShaderModuleCreateInfo moduleCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .codeSize = fileLen,
-        .pCode = codeBuffer
-    };
-
-    VkResult res = vkCreateShaderModule(s_specDevice, &moduleCreateInfo, NULL, pShaderModule);
-    if (res != VK_SUCCESS) {
-        printf("vkCreateShaderModule failed: %d\n", res);
-    }
-
-    free(codeBuffer);
-
-    return res == VK_SUCCESS;
-}
-
-static bool CreateVertAndFragShaderModules(const char* vertSPVFilePath, const char* fragSPVFilePath)
-{
-    if (!CreateShaderModule(vertSPVFilePath, &s_vertex_shader_module)) return false;
-    if (!CreateShaderModule(fragSPVFilePath, &s_fragment_shader_module)) return false;
-
-    return true;
-}
-
-static bool CreateGraphicsPipeline(const char* vertSPVFilePath, const char* fragSPVFilePath, int index)
-{
-    if (!CreateVertAndFragShaderModules(vertSPVFilePath, fragSPVFilePath)) {
-        return false;
-    }
-
-    // Two shader stages
-    const VkPipelineShaderStageCreateInfo shaderStages[] = {
-        // vertex shader
-        {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0,
-            .stage = VK_SHADER_STAGE_VERTEX_BIT,
-            .module = s_vertex_shader_module,
-            .pName = "main",
-            .pSpecializationInfo = NULL
-        },
-        // fragment shader
-        {
-            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-            .pNext = NULL,
-            .flags = 0,
-            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
-            .module = s_fragment_shader_module,
-            .pName = "main",
-            .pSpecializationInfo = NULL
-        }
-    };
-
-    const VkVertexInputBindingDescription vertexInputBindings[] = {
-        // coords buffer
-        {
-            .binding = 0,
-            .stride = sizeof(float[4]),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-        },
-        // color buffer
-        {
-            .binding = 1,
-            .stride = sizeof(float[4]),
-            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-        }
-    };
-
-    const VkVertexInputAttributeDescription vertexInputAttributes[] = {
-        // inPos attribute
-        {
-            .location = 0,
-            .binding = 0,
-            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-            .offset = 0
-        },
-        // inColor attribute
-        {
-            .location = 1,
-            .binding = 1,
-            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-            .offset = 0
-        }
-    };
-
-    const VkPipelineVertexInputStateCreateInfo vertexInputStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .vertexBindingDescriptionCount = (uint32_t)(sizeof(vertexInputBindings) / sizeof(vertexInputBindings[0])),
-        .pVertexBindingDescriptions = vertexInputBindings,
-        .vertexAttributeDescriptionCount = (uint32_t)(sizeof(vertexInputAttributes) / sizeof(vertexInputAttributes[0])),
-        .pVertexAttributeDescriptions = vertexInputAttributes
-    };
-
-    const VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
-        .primitiveRestartEnable = VK_FALSE
-    };
-
-    const VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .viewportCount = 1,
-        .pViewports = NULL,     // As the viewport state is dynamic, this member is ignored.
-        .scissorCount = 1,
-        .pScissors = NULL       // As the scissor state is dynamic, this member is ignored.
-    };
-
-    const VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .depthClampEnable = VK_FALSE,
-        .rasterizerDiscardEnable = VK_FALSE,
-        .polygonMode = VK_POLYGON_MODE_FILL,
-        // Index 0 square rotates about the x-axis so that the back face should not be culled.
-        .cullMode = index == 0 ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT,
-        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
-        .depthBiasEnable = VK_FALSE,
-        .depthBiasConstantFactor = 0.0f,
-        .depthBiasClamp = 1.0f,
-        .depthBiasSlopeFactor = 0.0f,
-        .lineWidth = 1.0f,
-    };
-
-    const VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
-        .sampleShadingEnable = VK_FALSE,
-        .minSampleShading = 0.0f,
-        .pSampleMask = NULL,
-        .alphaToCoverageEnable = VK_FALSE,
-        .alphaToOneEnable = VK_FALSE
-    };
-
-    const VkStencilOpState stencilOpState = {
-        .failOp = VK_STENCIL_OP_KEEP,
-        .passOp = VK_STENCIL_OP_KEEP,
-        .depthFailOp = VK_STENCIL_OP_KEEP,
-        .compareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
-        .compareMask = 0,
-        .writeMask = 0,
-        .reference = 0
-    };
-
-    const VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .depthTestEnable = VK_TRUE,
-        .depthWriteEnable = VK_TRUE,
-        .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
-        .depthBoundsTestEnable = VK_FALSE,
-        .stencilTestEnable = VK_FALSE,
-        .front = stencilOpState,
-        .back = stencilOpState,
-        .minDepthBounds = 0.0f,
-        .maxDepthBounds = 0.0f
-    };
-
-    const VkPipelineColorBlendAttachmentState attatchmentStates[1] = {
-        {
-            .blendEnable = VK_FALSE,
-            .srcColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-            .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
-            .colorBlendOp = VK_BLEND_OP_ADD,
-            .srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-            .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
-            .alphaBlendOp = VK_BLEND_OP_ADD,
-            .colorWriteMask = 0x0fU
-        }
-    };
-
-    const VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .logicOpEnable = VK_FALSE,
-        .logicOp = VK_LOGIC_OP_CLEAR,
-        .attachmentCount = (uint32_t)(sizeof(attatchmentStates) / sizeof(attatchmentStates[0])),
-        .pAttachments = attatchmentStates,
-        .blendConstants = { 0.0f }
-    };
-
-    const VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .dynamicStateCount = DYNAMIC_STATE_COUNT,
-        .pDynamicStates = (VkDynamicState[]) { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }
-    };
-
-    const VkGraphicsPipelineCreateInfo pipelineCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-        .pNext = NULL,
-        .stageCount = (uint32_t)(sizeof(shaderStages) / sizeof(shaderStages[0])),
-        .pStages = shaderStages,
-        .pVertexInputState = &vertexInputStateCreateInfo,
-        .pInputAssemblyState = &inputAssemblyStateCreateInfo,
-        .pTessellationState = NULL,
-        .pViewportState = &viewportStateCreateInfo,
-        .pRasterizationState = &rasterizationStateCreateInfo,
-        .pMultisampleState = &multisampleStateCreateInfo,
-        .pDepthStencilState = &depthStencilStateCreateInfo,
-        .pColorBlendState = &colorBlendStateCreateInfo,
-        .pDynamicState = &dynamicStateCreateInfo,
-        .layout = s_pipelineLayout,
-        .renderPass = s_render_pass,
-        .subpass = 0,
-        .basePipelineHandle = VK_NULL_HANDLE,
-        .basePipelineIndex = 0
-    };
-
-    const VkPipelineCacheCreateInfo pipelineCache = {
-        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
-        .pNext = NULL,
-        .flags = 0,
-        .initialDataSize = 0,
-        .pInitialData = NULL
-    };
-
-    VkResult res = vkCreatePipelineCache(s_specDevice, &pipelineCache, NULL, &s_pipelineCaches[index]);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreatePipelineCache failed: %d\n", res);
-        return false;
-    }
-
-    res = vkCreateGraphicsPipelines(s_specDevice, s_pipelineCaches[index], 1, &pipelineCreateInfo, NULL, &s_pipelines[index]);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateGraphicsPipelines failed: %d\n", res);
-        return false;
-    }
-
-    if (s_vertex_shader_module != VK_NULL_HANDLE)
-    {
-        vkDestroyShaderModule(s_specDevice, s_vertex_shader_module, NULL);
-        s_vertex_shader_module = VK_NULL_HANDLE;
-    }
-    if (s_fragment_shader_module != VK_NULL_HANDLE)
-    {
-        vkDestroyShaderModule(s_specDevice, s_fragment_shader_module, NULL);
-        s_fragment_shader_module = VK_NULL_HANDLE;
-    }
-
-    return true;
-}
-
-static bool CreateDescriptorPoolAndSet(void)
-{
-    const VkDescriptorPoolSize poolSizes[] = {
-        {
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = s_swapchainImageCount,
-        }
-    };
-    const VkDescriptorPoolCreateInfo descriptor_pool = {
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-        .pNext = NULL,
-        .maxSets = s_swapchainImageCount,
-        .poolSizeCount = (uint32_t)(sizeof(poolSizes) / sizeof(poolSizes[0])),
-        .pPoolSizes = poolSizes,
-    };
-
-    VkResult res = vkCreateDescriptorPool(s_specDevice, &descriptor_pool, NULL, &s_descPool);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateDescriptorPool failed: %d\n", res);
-        return false;
-    }
-
-    const VkDescriptorSetAllocateInfo alloc_info = { 
-        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-        .pNext = NULL,
-        .descriptorPool = s_descPool,
-        .descriptorSetCount = 1,
-        .pSetLayouts = &s_descSetLayout
-    };
-
-    VkDescriptorBufferInfo buffer_info = {
-        .buffer = VK_NULL_HANDLE,
-        .offset = 0,
-        .range = sizeof(FlattenVertexUniform)
-    };
-
-    VkWriteDescriptorSet writes[] = {
-        {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .pNext = NULL,
-            .dstSet = VK_NULL_HANDLE,
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .pImageInfo = NULL,
-            .pBufferInfo = &buffer_info,
-            .pTexelBufferView = NULL
-        }
-    };
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        // There's no need to free `descriptor_set`, since VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT flag is not set
-        // in the member `flags` in `VkDescriptorPoolCreateInfo` object.
-        res = vkAllocateDescriptorSets(s_specDevice, &alloc_info, &s_swapchainImageResources[i].descriptor_set);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkAllocateDescriptorSets for @%u swapchain image failed: %d\n", i, res);
-            return false;
-        }
-
-        buffer_info.buffer = s_swapchainImageResources[i].uniform_buffer;
-        for (size_t writeIndex = 0; writeIndex < sizeof(writes) / sizeof(writes[0]); ++writeIndex) {
-            writes[writeIndex].dstSet = s_swapchainImageResources[i].descriptor_set;
-        }
-        vkUpdateDescriptorSets(s_specDevice, (uint32_t)(sizeof(writes) / sizeof(writes[0])), writes, 0, NULL);
-    }
-
-    return true;
-}
-
-static bool CreateFramebuffers(void)
-{
-    VkImageView attachments[] = { VK_NULL_HANDLE, s_depthResource.image_view };
-
-    const VkFramebufferCreateInfo framebufferCreateInfo = {
-        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-        .pNext = NULL,
-        .renderPass = s_render_pass,
-        .attachmentCount = (uint32_t)(sizeof(attachments) / sizeof(attachments[0])),
-        .pAttachments = attachments,
-        .width = s_render_width,
-        .height = s_render_height,
-        .layers = 1
-    };
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        attachments[0] = s_swapchainImageResources[i].view;
-        VkResult res = vkCreateFramebuffer(s_specDevice, &framebufferCreateInfo, NULL, &s_swapchainImageResources[i].framebuffer);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkCreateFramebuffer @%u failed: %d\n", i, res);
-            return false;
-        }
-    }
-
-    return true;
-}
-
-static bool BuildCommandForDraw(VkCommandBuffer inputCmdBuf, uint32_t swapchainIndex)
-{
-    const VkCommandBufferBeginInfo cmd_buf_info = {
-        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
-        .pNext = NULL,
-        .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
-        .pInheritanceInfo = NULL,
-    };
-    VkResult res = vkBeginCommandBuffer(inputCmdBuf, &cmd_buf_info);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkBeginCommandBuffer in BuildCommandForDraw @%u failed: %d\n", swapchainIndex, res);
-        return false;
-    }
-
-    const VkClearValue clearValues[] = {
-        { .color.float32 = { 0.4f, 0.5f, 0.4f, 1.0f } },
-        { .depthStencil = { .depth = 1.0f, .stencil = 0 } },
-    };
-    const VkRenderPassBeginInfo renderPassBeginInfo = {
-        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-        .pNext = NULL,
-        .renderPass = s_render_pass,
-        .framebuffer = s_swapchainImageResources[swapchainIndex].framebuffer,
-        .renderArea = {
-            .offset = { .x = 0, .y = 0 },
-            .extent = {.width = s_render_width, .height = s_render_height }
-        },
-        .clearValueCount = (uint32_t)(sizeof(clearValues) / sizeof(clearValues[0])),
-        .pClearValues = clearValues,
-    };
-
-    // ==== The following code block is in the render pass instance. ====
-    vkCmdBeginRenderPass(inputCmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-    const VkBuffer vertexBuffers[] = {
-        s_swapchainImageResources[swapchainIndex].coords_buffer,
-        s_swapchainImageResources[swapchainIndex].color_buffer
-    };
-    const VkDeviceSize vertexoffsets[] = { 0, 0 };
-    vkCmdBindVertexBuffers(inputCmdBuf, 0, sizeof(vertexBuffers) / sizeof(vertexBuffers[0]), vertexBuffers, vertexoffsets);
-
-    vkCmdBindDescriptorSets(inputCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelineLayout, 0, 1,
-        &s_swapchainImageResources[swapchainIndex].descriptor_set, 0, NULL);
-
-    const bool isWidthShorterThanHeight = s_render_width < s_render_height;
-    const VkViewport viewport = {
-        .x = isWidthShorterThanHeight ? 0.0f : (s_render_width - s_render_height) / 2.0f,
-        .y = isWidthShorterThanHeight ? (s_render_height - s_render_width) / 2.0f : 0.0f,
-        .width = isWidthShorterThanHeight ? (float)s_render_width : (float)s_render_height,
-        .height = isWidthShorterThanHeight ? (float)s_render_width : (float)s_render_height,
-        .minDepth = 0.0f,
-        .maxDepth = 1.0f
-    };
-    vkCmdSetViewport(inputCmdBuf, 0, 1, &viewport);
-
-    const VkRect2D scissor = {
-        .offset = { .x = 0, .y = 0 },
-        .extent = { .width = s_render_width, .height = s_render_height }
-    };
-    vkCmdSetScissor(inputCmdBuf, 0, 1, &scissor);
-
-    // Draw
-    for (int i = 0; i < 2; ++i)
-    {
-        vkCmdBindPipeline(inputCmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelines[i]);
-        vkCmdDraw(inputCmdBuf, 4, 1, 0, 0);
-    }
-
-    // Note that ending the renderpass changes the image's layout from
-    // COLOR_ATTACHMENT_OPTIMAL to PRESENT_SRC_KHR
-    vkCmdEndRenderPass(inputCmdBuf);
-
-    if (IsSeperatePresentQueue())
-    {
-        // We have to transfer ownership from the graphics queue family to the
-        // present queue family to be able to present.  Note that we don't have
-        // to transfer from present queue family back to graphics queue family at
-        // the start of the next frame because we don't care about the image's
-        // contents at that point.
-        const VkImageMemoryBarrier image_ownership_barrier = { 
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-            .pNext = NULL,
-            .srcAccessMask = 0,
-            .dstAccessMask = 0,
-            .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-            .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
-            .dstQueueFamilyIndex = s_presentQueueFamilyIndex,
-            .image = s_swapchainImageResources[swapchainIndex].image,
-            .subresourceRange = { 
-                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, 
-                .baseMipLevel = 0, 
-                .levelCount = 1,
-                .baseArrayLayer = 0,
-                .layerCount = 1
-            }
-        };
-
-        vkCmdPipelineBarrier(inputCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0,
-            NULL, 1, &image_ownership_barrier);
-    }
-
-    // Update uniform buffer data on device side.
-    // ATTENTION: vkCmdCopyBuffer MUST BE only called outside of a render pass instance!
-    const size_t srcOffset = sizeof(s_vertex_coords_data) + sizeof(s_vertex_color_data);
-    const VkBufferCopy copyUniformRegion = {
-    .srcOffset = srcOffset,
-    .dstOffset = 0,
-    .size = sizeof(FlattenVertexUniform)
-    };
-    vkCmdCopyBuffer(inputCmdBuf, s_hostVertexAndUniformBuffer,
-        s_swapchainImageResources[swapchainIndex].uniform_buffer, 1, &copyUniformRegion);
-
-    const VkBufferMemoryBarrier copyBarrier = {
-        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
-        .pNext = NULL,
-        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
-        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
-        .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
-        .dstQueueFamilyIndex = s_graphicsQueueFamilyIndex,
-        .buffer = s_swapchainImageResources[swapchainIndex].uniform_buffer,
-        .offset = 0,
-        .size = sizeof(FlattenVertexUniform)
-    };
-    vkCmdPipelineBarrier(inputCmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
-        0, NULL, 1, &copyBarrier, 0, NULL);
-
-    res = vkEndCommandBuffer(inputCmdBuf);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEndCommandBuffer for BuildCommandForDraw failed: %d\n", res);
-        return false;
-    }
-
-    return true;
-}
-
-static bool FlushInitCommand(void)
-{
-    // This function could get called twice if the texture uses a staging buffer
-    // In that case the second call should be ignored
-    if (s_commandBuffers[0] == VK_NULL_HANDLE) return true;
-
-    VkResult res = vkEndCommandBuffer(s_commandBuffers[0]);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkEndCommandBuffer for init command buffer failed: %d\n", res);
-        return false;
-    }
-
-    const VkSubmitInfo submit_info = {
-        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-        .pNext = NULL,
-        .waitSemaphoreCount = 0,
-        .pWaitSemaphores = NULL,
-        .pWaitDstStageMask = NULL,
-        .commandBufferCount = (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])),
-        .pCommandBuffers = s_commandBuffers,
-        .signalSemaphoreCount = 0,
-        .pSignalSemaphores = NULL
-    };
-
-    VkFence submitFence = VK_NULL_HANDLE;
-    const VkFenceCreateInfo submitFenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .pNext = NULL, .flags = 0 };
-    res = vkCreateFence(s_specDevice, &submitFenceCreateInfo, NULL, &submitFence);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkCreateFence for submitFence failed: %d\n", res);
-        return false;
-    }
-
-    do
-    {
-        res = vkQueueSubmit(s_graphicsQueue, 1, &submit_info, submitFence);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkQueueSubmit in init command buffer failed: %d\n", res);
-            break;
-        }
-
-        res = vkWaitForFences(s_specDevice, 1, &submitFence, VK_TRUE, UINT64_MAX);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkWaitForFences in init command buffer failed: %d\n", res);
-            break;
-        }
-    }
-    while (false);
-
-    vkDestroyFence(s_specDevice, submitFence, NULL);
-    
-    // This command buffer is one shot for the init flush submission,
-    // and will NOT be used any more.
-    vkFreeCommandBuffers(s_specDevice, s_commandPool, (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])), s_commandBuffers);
-    s_commandBuffers[0] = VK_NULL_HANDLE;
-
-    return res == VK_SUCCESS;
-}
-
-static bool UpdateUniformData(int currImageIndex)
-{
-    const size_t srcOffset = sizeof(s_vertex_coords_data) + sizeof(s_vertex_color_data);
-
-    FlattenVertexUniform* hostUniformData = NULL;
-    VkResult res = vkMapMemory(s_specDevice, s_hostVertexUniformMemory, srcOffset, sizeof(FlattenVertexUniform), 0, &hostUniformData);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkMapMemory for update uniform data failed: %d\n", res);
-        return false;
-    }
-
-    hostUniformData->u_factor[0] = 1.0f;
-    hostUniformData->u_factor[1] = 1.0f;
-    hostUniformData->u_angle = s_currRorationDegree;
-
-    s_currRorationDegree += 1.0f;
-    if (s_currRorationDegree >= 360.0f) {
-        s_currRorationDegree = 0.0f;
-    }
-
-    vkUnmapMemory(s_specDevice, s_hostVertexUniformMemory);
-
-    return true;
-}
-
-static void DoResize(void)
-{
-
-}
-
-static void DrawObjects(HINSTANCE hInstance, HWND hWnd, int currFrameIndex)
-{
-    // Ensure no more than FRAME_LAG renderings are outstanding
-    vkWaitForFences(s_specDevice, 1, &s_presentFences[currFrameIndex], VK_TRUE, UINT64_MAX);
-    vkResetFences(s_specDevice, 1, &s_presentFences[currFrameIndex]);
-
-    uint32_t currImageIndex = 0;
-    VkResult res;
-    do
-    {
-        // Get the index of the next available swapchain image:
-        res = vkAcquireNextImageKHR(s_specDevice, s_swapchain, UINT64_MAX, s_imageAcquiredSemaphores[currFrameIndex], VK_NULL_HANDLE, &currImageIndex);
-        switch (res)
-        {
-        case VK_SUCCESS:
-            break;
-
-        case VK_ERROR_OUT_OF_DATE_KHR:
-            // s_swapchain is out of date (e.g. the window was resized) and must be recreated:
-            DoResize();
-            break;
-
-        case VK_SUBOPTIMAL_KHR:
-            // s_swapchain is not as optimal as it could be,
-            // but the platform's presentation engine will still present the image correctly.
-            break;
-
-        case VK_ERROR_SURFACE_LOST_KHR:
-            if (!CreateVulkanSurface(hInstance, hWnd)) return;
-            DoResize();
-            break;
-
-        default:
-            printf("vkAcquireNextImageKHR failed: %d\n", res);
-            return;
-        }
-    }
-    while (res != VK_SUCCESS);
-
-    if (!UpdateUniformData(currImageIndex)) {
-        return;
-    }
-
-    // Wait for the image acquired semaphore to be signaled to ensure
-    // that the image won't be rendered to until the presentation
-    // engine has fully released ownership to the application, and it is
-    // okay to render to the image.
-    const VkPipelineStageFlags pipelineStageFlags[1] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    VkSubmitInfo submit_info;
-    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submit_info.pNext = NULL;
-    submit_info.waitSemaphoreCount = 1;
-    submit_info.pWaitSemaphores = &s_imageAcquiredSemaphores[currFrameIndex];
-    submit_info.pWaitDstStageMask = pipelineStageFlags;
-    submit_info.commandBufferCount = 1;
-    submit_info.pCommandBuffers = &s_swapchainImageResources[currImageIndex].cmd_buf;
-    submit_info.signalSemaphoreCount = 1;
-    submit_info.pSignalSemaphores = &s_drawCompleteSemaphores[currFrameIndex];
-    res = vkQueueSubmit(s_graphicsQueue, 1, &submit_info, s_presentFences[currFrameIndex]);
-    if (res != VK_SUCCESS)
-    {
-        printf("vkQueueSubmit failed: %d\n", res);
-        return;
-    }
-
-    const bool isSeparatePresentQueue = IsSeperatePresentQueue();
-    if (isSeparatePresentQueue)
-    {
-        // If we are using separate queues, change image ownership to the
-        // present queue before presenting, waiting for the draw complete
-        // semaphore and signalling the ownership released semaphore when finished
-        submit_info.waitSemaphoreCount = 1;
-        submit_info.pWaitSemaphores = &s_drawCompleteSemaphores[currFrameIndex];
-        submit_info.commandBufferCount = 1;
-        submit_info.pCommandBuffers = &s_swapchainImageResources[currImageIndex].graphics_to_present_cmd_buf;
-        submit_info.signalSemaphoreCount = 1;
-        submit_info.pSignalSemaphores = &s_imageOwnershipSemaphores[currFrameIndex];
-        res = vkQueueSubmit(s_presentQueue, 1, &submit_info, VK_NULL_HANDLE);
-        if (res != VK_SUCCESS)
-        {
-            printf("vkQueueSubmit for presentation failed: %d\n", res);
-            return;
-        }
-    }
-
-    // If we are using separate queues we have to wait for image ownership,
-    // otherwise wait for draw complete
-    VkPresentInfoKHR present = {
-        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-        .pNext = NULL,
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = isSeparatePresentQueue ? &s_imageOwnershipSemaphores[currFrameIndex] : &s_drawCompleteSemaphores[currFrameIndex],
-        .swapchainCount = 1,
-        .pSwapchains = &s_swapchain,
-        .pImageIndices = &currImageIndex,
-        .pResults = NULL
-    };
-
-    VkRectLayerKHR rect;
-    VkPresentRegionKHR region;
-    VkPresentRegionsKHR regions;
-    if (s_supportIncrementalPresent)
-    {
-        // If using VK_KHR_incremental_present, we provide a hint of the region
-        // that contains changed content relative to the previously-presented
-        // image.  The implementation can use this hint in order to save
-        // work/power (by only copying the region in the hint).  The
-        // implementation is free to ignore the hint though, and so we must
-        // ensure that the entire image has the correctly-drawn content.
-        const uint32_t eighthOfWidth = s_render_width / 8;
-        const uint32_t eighthOfHeight = s_render_height / 8;
-
-        rect.offset.x = eighthOfWidth;
-        rect.offset.y = eighthOfHeight;
-        rect.extent.width = eighthOfWidth * 6;
-        rect.extent.height = eighthOfHeight * 6;
-        rect.layer = 0;
-
-        region.rectangleCount = 1;
-        region.pRectangles = &rect;
-
-        regions.sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
-        regions.pNext = present.pNext;
-        regions.swapchainCount = present.swapchainCount;
-        regions.pRegions = &region;
-
-        present.pNext = &regions;
-    }
-
-    res = vkQueuePresentKHR(s_presentQueue, &present);
-    switch (res)
-    {
-    case VK_SUCCESS:
-        break;
-
-    case VK_ERROR_OUT_OF_DATE_KHR:
-        // s_swapchain is out of date (e.g. the window was resized) and must be recreated:
-        DoResize();
-        break;
-
-    case VK_SUBOPTIMAL_KHR:
-        // s_swapchain is not as optimal as it could be, but the platform's presentation engine will still present the image correctly.
-        break;
-
-    case VK_ERROR_SURFACE_LOST_KHR:
-        if (!CreateVulkanSurface(hInstance, hWnd)) return;
-        DoResize();
-        break;
-
-    default:
-        printf("vkQueuePresentKHR failed: %d\n", res);
-        break;
-    }
-}
-
-static void RunTheRendering(HINSTANCE hInstance, HWND hWnd, int currFrameIndex)
-{
-    if (!s_isRenderPrepared) return;
-
-    DrawObjects(hInstance, hWnd, currFrameIndex);
-}
-
-static void DestroyVulkanAssets(void)
-{
-    vkDeviceWaitIdle(s_specDevice);
-
-    // Wait for fences from present operations
-    for (int i = 0; i < FRAME_LAG; i++)
-    {
-        if (s_presentFences[i] != VK_NULL_HANDLE)
-        {
-            vkWaitForFences(s_specDevice, 1, &s_presentFences[i], VK_TRUE, UINT64_MAX);
-            vkDestroyFence(s_specDevice, s_presentFences[i], NULL);
-        }
-        if (s_imageAcquiredSemaphores[i] != VK_NULL_HANDLE) {
-            vkDestroySemaphore(s_specDevice, s_imageAcquiredSemaphores[i], NULL);
-        }
-        if (s_drawCompleteSemaphores[i] != VK_NULL_HANDLE) {
-            vkDestroySemaphore(s_specDevice, s_drawCompleteSemaphores[i], NULL);
-        }
-        if (s_imageOwnershipSemaphores[i] != VK_NULL_HANDLE) {
-            vkDestroySemaphore(s_specDevice, s_imageOwnershipSemaphores[i], NULL);
-        }
-    }
-
-    if (s_descPool != VK_NULL_HANDLE) {
-        vkDestroyDescriptorPool(s_specDevice, s_descPool, NULL);
-    }
-    for (size_t i = 0; i < sizeof(s_pipelines) / sizeof(s_pipelines[0]); ++i)
-    {
-        if (s_pipelineCaches[i] != VK_NULL_HANDLE) {
-            vkDestroyPipelineCache(s_specDevice, s_pipelineCaches[i], NULL);
-        }
-        if (s_pipelines[i] != VK_NULL_HANDLE) {
-            vkDestroyPipeline(s_specDevice, s_pipelines[i], NULL);
-        }
-    }
-    if (s_vertex_shader_module != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(s_specDevice, s_vertex_shader_module, NULL);
-    }
-    if (s_fragment_shader_module != VK_NULL_HANDLE) {
-        vkDestroyShaderModule(s_specDevice, s_fragment_shader_module, NULL);
-    }
-    if (s_render_pass != VK_NULL_HANDLE) {
-        vkDestroyRenderPass(s_specDevice, s_render_pass, NULL);
-    }
-    if (s_pipelineLayout != VK_NULL_HANDLE) {
-        vkDestroyPipelineLayout(s_specDevice, s_pipelineLayout, NULL);
-    }
-    if (s_descSetLayout != VK_NULL_HANDLE) {
-        vkDestroyDescriptorSetLayout(s_specDevice, s_descSetLayout, NULL);
-    }
-
-    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-    {
-        if (s_swapchainImageResources[i].framebuffer != VK_NULL_HANDLE) {
-            vkDestroyFramebuffer(s_specDevice, s_swapchainImageResources[i].framebuffer, NULL);
-        }
-        if (s_swapchainImageResources[i].view != VK_NULL_HANDLE) {
-            vkDestroyImageView(s_specDevice, s_swapchainImageResources[i].view, NULL);
-        }
-        if (s_swapchainImageResources[i].cmd_buf != VK_NULL_HANDLE) {
-            vkFreeCommandBuffers(s_specDevice, s_commandPool, 1, &s_swapchainImageResources[i].cmd_buf);
-        }
-        if (s_swapchainImageResources[i].uniform_buffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].uniform_buffer, NULL);
-        }
-        if (s_swapchainImageResources[i].uniform_memory != VK_NULL_HANDLE) {
-            vkFreeMemory(s_specDevice, s_swapchainImageResources[i].uniform_memory, NULL);
-        }
-        if (s_swapchainImageResources[i].coords_buffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].coords_buffer, NULL);
-        }
-        if (s_swapchainImageResources[i].color_buffer != VK_NULL_HANDLE) {
-            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].color_buffer, NULL);
-        }
-        if (s_swapchainImageResources[i].vertex_memory != VK_NULL_HANDLE) {
-            vkFreeMemory(s_specDevice, s_swapchainImageResources[i].vertex_memory, NULL);
-        }
-    }
-    if (s_hostVertexAndUniformBuffer != VK_NULL_HANDLE) {
-        vkDestroyBuffer(s_specDevice, s_hostVertexAndUniformBuffer, NULL);
-    }
-    if (s_hostVertexUniformMemory != VK_NULL_HANDLE) {
-        vkFreeMemory(s_specDevice, s_hostVertexUniformMemory, NULL);
-    }
-    if (s_depthResource.image_view != VK_NULL_HANDLE) {
-        vkDestroyImageView(s_specDevice, s_depthResource.image_view, NULL);
-    }
-    if (s_depthResource.image != VK_NULL_HANDLE) {
-        vkDestroyImage(s_specDevice, s_depthResource.image, NULL);
-    }
-    if (s_depthResource.device_memory != VK_NULL_HANDLE) {
-        vkFreeMemory(s_specDevice, s_depthResource.device_memory, NULL);
-    }
-    if (s_commandPool != VK_NULL_HANDLE)
-    {
-        if (s_commandBuffers[0] != VK_NULL_HANDLE) {
-            vkFreeCommandBuffers(s_specDevice, s_commandPool, (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])), s_commandBuffers);
-        }
-        vkDestroyCommandPool(s_specDevice, s_commandPool, NULL);
-    }
-    if (s_presentCommandPool != VK_NULL_HANDLE)
-    {
-        for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-        {
-            if (s_swapchainImageResources[i].graphics_to_present_cmd_buf != VK_NULL_HANDLE) {
-                vkFreeCommandBuffers(s_specDevice, s_presentCommandPool, 1, &s_swapchainImageResources[i].graphics_to_present_cmd_buf);
-            }
-        }
-        vkDestroyCommandPool(s_specDevice, s_presentCommandPool, NULL);
-    }
-    if (s_swapchain != VK_NULL_HANDLE) {
-        vkDestroySwapchainKHR(s_specDevice, s_swapchain, NULL);
-    }
-    if (s_specDevice != VK_NULL_HANDLE) {
-        vkDestroyDevice(s_specDevice, NULL);
-    }
-    if (s_surface != VK_NULL_HANDLE) {
-        vkDestroySurfaceKHR(s_instance, s_surface, NULL);
-    }
-    if (s_instance != VK_NULL_HANDLE) {
-        vkDestroyInstance(s_instance, NULL);
-    }
-}
-
-static int s_currFrameIndex = 0;
-static POINT s_wndMinsize;                // minimum window size
-
-static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
-{
-    switch (uMsg)
-    {
-    case WM_CREATE:
-    {
-        RECT windowRect;
-        GetWindowRect(hWnd, &windowRect);
-        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_MINIMIZEBOX);
-        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_MAXIMIZEBOX);
-        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_SIZEBOX);
-        break;
-    }
-
-    case WM_CLOSE:
-        DestroyVulkanAssets();
-        PostQuitMessage(0);
-        break;
-
-    case WM_PAINT:
-        RunTheRendering(GetModuleHandleA(NULL), hWnd, s_currFrameIndex++);
-        if (s_currFrameIndex == FRAME_LAG) {
-            s_currFrameIndex = 0;
-        }
-        break;
-
-    case WM_GETMINMAXINFO:  // set window's minimum size
-        ((MINMAXINFO*)lParam)->ptMinTrackSize = s_wndMinsize;
-        return 0;
-
-    case WM_ERASEBKGND:
-        return 1;
-
-    case WM_SIZE:
-        // Resize the application to the new window size, except when
-        // it was minimized. Vulkan doesn't support images or swapchains
-        // with width=0 and height=0.
-        if (wParam != SIZE_MINIMIZED)
-        {
-            s_render_width = lParam & 0xffff;
-            s_render_height = (lParam & 0xffff0000U) >> 16;
-            DoResize();
-        }
-        break;
-
-    case WM_KEYDOWN:
-        switch (wParam)
-        {
-        case VK_ESCAPE:
-            PostQuitMessage(0);
-            break;
-        case VK_LEFT:
-            break;
-        case VK_RIGHT:
-            break;
-        case VK_SPACE:
-            break;
-        }
-        return 0;
-
-    default:
-        break;
-    }
-
-    return DefWindowProc(hWnd, uMsg, wParam, lParam);
-}
-
-static HWND CreateAndInitializeWindow(HINSTANCE hInstance, LPCSTR appName, int windowWidth, int windowHeight)
-{
-    WNDCLASSEXA win_class;
-    // Initialize the window class structure:
-    win_class.cbSize = sizeof(WNDCLASSEX);
-    win_class.style = CS_HREDRAW | CS_VREDRAW;
-    win_class.lpfnWndProc = WndProc;
-    win_class.cbClsExtra = 0;
-    win_class.cbWndExtra = 0;
-    win_class.hInstance = hInstance;
-    win_class.hIcon = LoadIconA(NULL, IDI_APPLICATION);
-    win_class.hCursor = LoadCursorA(NULL, IDC_ARROW);
-    win_class.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
-    win_class.lpszMenuName = NULL;
-    win_class.lpszClassName = appName;
-    win_class.hIconSm = LoadIconA(NULL, IDI_WINLOGO);
-    // Register window class:
-    if (!RegisterClassExA(&win_class))
-    {
-        // It didn't work, so try to give a useful error:
-        printf("Unexpected error trying to start the application!\n");
-        fflush(stdout);
-        exit(1);
-    }
-    // Create window with the registered class:
-    RECT wr = { 0, 0, windowWidth, windowHeight };
-    AdjustWindowRect(&wr, WS_OVERLAPPEDWINDOW, FALSE);
-
-    const LONG windowStyle = WS_OVERLAPPEDWINDOW | WS_VISIBLE | WS_SYSMENU;
-
-    HWND hWnd = CreateWindowExA(
-        0,                            // extra style
-        appName,                    // class name
-        appName,                   // app name
-        windowStyle,                   // window style
-        CW_USEDEFAULT, CW_USEDEFAULT,     // x, y coords
-        windowWidth,                    // width
-        windowHeight,                  // height
-        NULL,                        // handle to parent
-        NULL,                            // handle to menu
-        hInstance,                            // hInstance
-        NULL);
-
-    if (hWnd == NULL) {
-        // It didn't work, so try to give a useful error:
-        puts("Cannot create a window in which to draw!");
-    }
-
-    // Window client area size must be at least 1 pixel high, to prevent crash.
-    s_wndMinsize.x = GetSystemMetrics(SM_CXMINTRACK);
-    s_wndMinsize.y = GetSystemMetrics(SM_CYMINTRACK) + 1;
-
-    return hWnd;
-}
-
-int main(int argc, const char* const argv[])
-{
-    const char* const appName = "Vulkan Simple Render";
-
-    if (!InitializeVulkanInstance(appName, "ZennyEngine")) {
-        return 0;
-    }
-
-    if (!InitializeVulkanDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) {
-        return 0;
-    }
-
-    // Windows Instance
-    HINSTANCE wndInstance = GetModuleHandleA(NULL);
-
-    // window handle
-    HWND wndHandle = CreateAndInitializeWindow(wndInstance, appName, WINDOW_WIDTH, WINDOW_HEIGHT);
-
-    s_render_width = WINDOW_WIDTH;
-    s_render_height = WINDOW_HEIGHT;
-
-    // Initialize loop condition variable
-    bool done = true;
-
-    do
-    {
-        if (!CreateVulkanSurface(wndInstance, wndHandle)) break;
-        if (!CreateVulkanSwapchain()) break;
-        if (!CreateFencesAndSemaphores()) break;
-        if (!CreateCommandBufferAndBeginCommand()) break;
-        if (!CreateVertexAndUniformBuffersAndMemories()) break;
-        CopyFromHostToDeviceBuffersAndSync();
-        if (!CreateDepthReource()) break;
-        if (!CreateDescriptorSetAndPipelineLayout()) break;
-        if (!CreateRenderPass()) break;
-        if (!CreateGraphicsPipeline("flatten.vert.spv", "flatten.frag.spv", 0)) break;
-        if (!CreateGraphicsPipeline("gradient.vert.spv", "gradient.frag.spv", 1)) break;
-        if (!CreateDescriptorPoolAndSet()) break;
-        if (!CreateFramebuffers()) break;
-        
-        for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
-        {
-            if (!BuildCommandForDraw(s_swapchainImageResources[i].cmd_buf, i)) {
-                break;
-            }
-        }
-
-        s_isRenderPrepared = true;
-
-        // Prepare functions above may generate pipeline commands that need to be flushed before beginning the render loop.
-        if (!FlushInitCommand()) break;
-
-        done = false;
-    }
-    while (false);
-
-    // main message loop
-    MSG msg;
-    while (!done)
-    {
-        PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE);
-        if (msg.message == WM_QUIT)  // check for a quit message
-        {
-            done = true;  // if found, quit app
-        }
-        else {
-            // Translate and dispatch to event queue
-            TranslateMessage(&msg);
-            DispatchMessageA(&msg);
-        }
-        RedrawWindow(wndHandle, NULL, NULL, RDW_INTERNALPAINT);
-    }
-
-    if (wndHandle != NULL)
-    {
-        DestroyWindow(wndHandle);
-        wndHandle = NULL;
-    }
-}
-
-// 运行程序: Ctrl + F5 或调试 >“开始执行(不调试)”菜单
-// 调试程序: F5 或调试 >“开始调试”菜单
-
-// 入门使用技巧: 
-//   1. 使用解决方案资源管理器窗口添加/管理文件
-//   2. 使用团队资源管理器窗口连接到源代码管理
-//   3. 使用输出窗口查看生成输出和其他消息
-//   4. 使用错误列表窗口查看错误
-//   5. 转到“项目”>“添加新项”以创建新的代码文件，或转到“项目”>“添加现有项”以将现有代码文件添加到项目
-//   6. 将来，若要再次打开此项目，请转到“文件”>“打开”>“项目”并选择 .sln 文件
+﻿// VulkanSimpleRender.cpp : 此文件包含 "main" 函数。程序执行将在此处开始并结束。
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <limits.h>
+#include <errno.h>
+#include <vulkan/vulkan.h>
+
+#include "platform_utils.h"
+#include "bench_stats.h"
+#include "task_graph.h"
+#include "capability_registry.h"
+#include "mesh_file.h"
+#include "mesh_importer.h"
+#include "upload_manager.h"
+#include "texture_file.h"
+#include "object_culling.h"
+#include "job_system.h"
+#include "image_writer.h"
+#include "frame_capture.h"
+#include "frame_export.h"
+#include "deletion_queue.h"
+#include "host_allocator.h"
+#include "memory_tracker.h"
+#include "render_context.h"
+#include "render_server.h"
+
+#ifdef _WIN32
+// ATTENTION: <Windows.h> MUST BE included ahead of <vulkan/vulkan_win32.h> and <vulkan/vk_sdk_platform.h>
+#include <Windows.h>
+#include <wincodec.h>
+#include <vulkan/vulkan_win32.h>
+
+static inline FILE* GeneralOpenFile(const char* path)
+{
+    FILE* fp = NULL;
+    // error code such as `EISDIR`, `EMFILE`, `ENAMETOOLONG`, etc.
+    const errno_t errCode = fopen_s(&fp, path, "rb");
+    if (errCode != 0)
+    {
+        printf("Open file '%s' failed, because: %d\n", path, errCode);
+        return NULL;
+    }
+    return fp;
+}
+
+static inline FILE* GeneralOpenFileForWrite(const char* path)
+{
+    FILE* fp = NULL;
+    const errno_t errCode = fopen_s(&fp, path, "wb");
+    if (errCode != 0)
+    {
+        printf("Create file '%s' failed, because: %d\n", path, errCode);
+        return NULL;
+    }
+    return fp;
+}
+
+#define _USE_MATH_DEFINES
+
+#else
+
+static inline FILE* GeneralOpenFile(const char* path)
+{
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        printf("File '%s' open failed!\n", path);
+        return NULL;
+    }
+    return fp;
+}
+
+static inline FILE* GeneralOpenFileForWrite(const char* path)
+{
+    FILE* fp = fopen(path, "wb");
+    if (fp == NULL)
+    {
+        printf("File '%s' create failed: %d\n", path, errno);
+        return NULL;
+    }
+    return fp;
+}
+
+// <Windows.h> provides these two macros on the Windows platform
+#ifndef min
+#define min(a, b)   ((a) < (b) ? (a) : (b))
+#endif
+#ifndef max
+#define max(a, b)   ((a) > (b) ? (a) : (b))
+#endif
+
+#endif // _WIN32
+
+#include <math.h>
+
+
+enum MY_CONSTANTS
+{
+    MAX_VULKAN_LAYER_COUNT = 64,
+    MAX_GPU_COUNT = 8,
+    MAX_QUEUE_FAMILY_PROPERTY_COUNT = 8,
+    MAX_FORMAT_COUNT = 32,
+    MAX_PRESENT_MODE_COUNT = 8,
+    MAX_SWAPCHAIN_IMAGE_COUNT = 16,
+
+    WINDOW_WIDTH = 512,
+    WINDOW_HEIGHT = 512,
+    FRAME_LAG = 2,
+    MAX_FRAME_LAG = 8,
+
+    DEFAULT_BENCHMARK_FRAME_COUNT = 1000,
+    DEFAULT_BENCHMARK_WARMUP_FRAME_COUNT = 60,
+
+    MAX_STARTUP_PHASE_COUNT = 32,
+    MAX_STARTUP_WORKER_COUNT = 8,
+
+    // MUST BE the same as local_size_x in animate.comp.glsl
+    ANIMATION_WORKGROUP_SIZE = 64,
+
+    // All initial uploads go through a staging ring of this size. A mesh is read from its file in chunks of MESH_UPLOAD_CHUNK_SIZE,
+    // so the host memory used by the upload does not depend on the mesh size.
+    UPLOAD_STAGING_SIZE = 16 * 1024 * 1024,
+    MESH_UPLOAD_CHUNK_SIZE = 4 * 1024 * 1024,
+    // The texture is streamed through its own staging ring while frames are rendered. Mip levels are uploaded at startup
+    // from the smallest one up to TEXTURE_INITIAL_UPLOAD_SIZE, the finer levels follow one per frame.
+    TEXTURE_STAGING_SIZE = 4 * 1024 * 1024,
+    TEXTURE_INITIAL_UPLOAD_SIZE = 64 * 1024,
+    // The staging rings are halved down to this size while they do not fit within the memory budget
+    MIN_UPLOAD_STAGING_SIZE = 1024 * 1024,
+    // Layouts returned from VkPhysicalDeviceHostImageCopyPropertiesEXT::pCopyDstLayouts
+    MAX_HOST_IMAGE_COPY_LAYOUT_COUNT = 64,
+    // Width and height of the RGBA8 image uploaded by --upload-benchmark
+    UPLOAD_BENCHMARK_IMAGE_SIZE = 2048,
+    // Upper bound of --objects. Every object takes 40 bytes in the scene object store and 4 in the visible indices,
+    // besides its state and transform on the device, so this already asks for about 700 MiB of host memory.
+    MAX_OBJECT_COUNT = 16 * 1024 * 1024,
+    // --cull-benchmark culls scenes of s_cullBenchmarkObjectCounts objects scattered in a cube of this half size around the camera
+    CULL_BENCHMARK_SIZE_COUNT = 3,
+    CULL_BENCHMARK_SCENE_EXTENT = 500,
+    // Objects per job of the parallel culling pass, MUST BE a multiple of OBJECT_STORE_LANE_COUNT
+    CULL_PARALLEL_BATCH_SIZE = 16384,
+    // --job-benchmark submits JOB_BENCHMARK_FLAT_JOB_COUNT jobs from the main thread, then JOB_BENCHMARK_PARENT_JOB_COUNT jobs
+    // that submit JOB_BENCHMARK_CHILD_JOB_COUNT jobs each from the workers running them. The jobs are empty, so only the scheduling is measured.
+    JOB_BENCHMARK_FLAT_JOB_COUNT = 2048,
+    JOB_BENCHMARK_PARENT_JOB_COUNT = 64,
+    JOB_BENCHMARK_CHILD_JOB_COUNT = 63,
+    // Elements of the descriptor arrays of the bindless set, clamped to the update-after-bind limits of the device.
+    // Every swapchain image registers its uniform buffer and its transform buffer, the texture takes one image.
+    BINDLESS_BUFFER_CAPACITY = 1024,
+    BINDLESS_TEXTURE_CAPACITY = 256,
+    // --descriptor-benchmark rewrites the descriptors of DESCRIPTOR_BENCHMARK_SET_COUNT sets per iteration,
+    // allocated and written in batches of DESCRIPTOR_BENCHMARK_BATCH_SIZE sets
+    DESCRIPTOR_BENCHMARK_SET_COUNT = 4096,
+    DESCRIPTOR_BENCHMARK_BATCH_SIZE = 256,
+    // --context-benchmark renders on up to this many render contexts at once
+    MAX_RENDER_CONTEXT_COUNT = 16,
+    // Frames --capture has in flight between the copy and the written file, enough to cover the latency of the encoders
+    DEFAULT_FRAME_CAPTURE_SLOT_COUNT = 6,
+    // Stated in the header of a --stream in Y4M
+    DEFAULT_STREAM_FRAME_RATE = 60,
+
+    s_depth_format = VK_FORMAT_D16_UNORM
+};
+
+// MUST BE the same as the animation_params block of animate.comp.glsl
+typedef struct AnimationParameters
+{
+    float deltaTime;
+} AnimationParameters;
+
+typedef struct SwapchainImageResources
+{
+    VkImage image;
+    VkCommandBuffer cmd_buf;
+    VkCommandBuffer graphics_to_present_cmd_buf;
+    VkImageView view;
+    VkBuffer coords_buffer;
+    VkBuffer color_buffer;
+    VkBuffer uniform_buffer;
+    VkDeviceMemory vertex_memory;
+    VkDeviceMemory uniform_memory;
+    VkFramebuffer framebuffer;
+    VkDescriptorSet descriptor_set;
+    // Object transforms written by the animation dispatch and read by the draw of this image
+    VkBuffer transform_buffer;
+    VkDeviceMemory transform_memory;
+    VkCommandBuffer animation_cmd_buf;
+    VkDescriptorSet animation_descriptor_set;
+    // Persistently mapped, rewritten before every animation dispatch of this image
+    VkBuffer animation_params_buffer;
+    VkDeviceMemory animation_params_memory;
+    AnimationParameters* pAnimationParams;
+    // The present fence of the last frame drawn into this swapchain image
+    VkFence frame_fence;
+    // Elements of uniform_buffer and transform_buffer in the buffer array of the bindless set
+    uint32_t bindless_uniform_index;
+    uint32_t bindless_transform_index;
+    // Only headless render targets own their image memory; swapchain images are owned by the swapchain.
+    VkDeviceMemory image_memory;
+} SwapchainImageResources;
+
+typedef struct BenchmarkOptions
+{
+    uint32_t frameCount;
+    uint32_t warmupFrameCount;
+    // NULL or "-" means writing the report to stdout, through s_reportStream
+    const char* reportPath;
+    // Uploads measured per upload path after the frames, 0 skips the upload benchmark
+    uint32_t uploadIterationCount;
+    // Culling passes measured per scene size and kernel after the frames, 0 skips the culling benchmark
+    uint32_t cullIterationCount;
+    // Rounds of each job workload measured after the frames, 0 skips the job system benchmark
+    uint32_t jobIterationCount;
+    // Recordings of a frame measured per recording thread count after the frames, 0 skips the recording benchmark
+    uint32_t recordIterationCount;
+    // Rewrites of all the descriptor sets measured per descriptor path after the frames, 0 skips the descriptor benchmark
+    uint32_t descriptorIterationCount;
+    // Frames between two rebuilds of the graphics pipelines, 0 never rebuilds them
+    uint32_t shaderReloadInterval;
+} BenchmarkOptions;
+
+typedef struct CullBenchmarkResult
+{
+    uint32_t objectCount;
+    CullingKernel kernel;
+    // Workers of the job system culling the scene in parallel, 1 for a single CullObjects call
+    uint32_t workerCount;
+    uint32_t visibleCount;
+    // Milliseconds per culling pass
+    BenchStatistics time;
+} CullBenchmarkResult;
+
+typedef struct RecordBenchmarkResult
+{
+    // 0 for recording the render pass contents inline into the primary command buffer
+    uint32_t threadCount;
+    // Milliseconds per frame recording, including the reset of the command pools
+    BenchStatistics time;
+} RecordBenchmarkResult;
+
+typedef struct ContextBenchmarkResult
+{
+    uint32_t contextCount;
+    // Queues the contexts submit to, contexts beyond it share them
+    uint32_t queueCount;
+    // Frames of all the contexts together per second
+    double framesPerSecond;
+    // Milliseconds to create a context on its thread, while the other contexts are created too
+    double createTime;
+    // Milliseconds all the contexts waited for a queue another context submitted to
+    double queueWaitTime;
+} ContextBenchmarkResult;
+
+// One render context of the context benchmark, created, driven and destroyed on its own thread
+typedef struct RenderContextWorker
+{
+    RenderContextCreateInfo createInfo;
+    uint32_t index;
+    uint32_t frameCount;
+    // Counted up by every worker once it has tried to create its context
+    volatile int64_t* pReadyCount;
+    // Set once every worker is ready, so that the contexts render at the same time
+    volatile int64_t* pStartFlag;
+    uint64_t createTime;
+    uint64_t endTime;
+    uint64_t queueWaitTime;
+    bool succeeded;
+} RenderContextWorker;
+
+typedef struct DescriptorBenchmarkResult
+{
+    // false for allocating and updating descriptor sets from a pool
+    bool isDescriptorBuffer;
+    // Threads writing the descriptors, always 1 for the pool, which MUST BE externally synchronized
+    uint32_t workerCount;
+    // Milliseconds per rewrite of DESCRIPTOR_BENCHMARK_SET_COUNT sets
+    BenchStatistics time;
+} DescriptorBenchmarkResult;
+
+// Descriptor sets of the descriptor benchmark, written in parallel into a descriptor buffer
+typedef struct DescriptorChurnContext
+{
+    uint8_t* pSetData;
+    VkDeviceSize setStride;
+    VkDeviceSize bindingOffsets[2];
+    VkDeviceAddress bufferAddress;
+} DescriptorChurnContext;
+
+typedef struct JobBenchmarkResult
+{
+    uint32_t workerCount;
+    // Nanoseconds per job, from submitting the first job to the end of waiting for the last one
+    BenchStatistics flatJobTime;
+    BenchStatistics nestedJobTime;
+    uint64_t stolenJobCount;
+} JobBenchmarkResult;
+
+// Secondary command buffers recorded by one worker of s_jobSystem for one frame in flight. Each worker records into its own pool,
+// so the pools need no synchronization.
+typedef struct WorkerCommandPool
+{
+    VkCommandPool commandPool;
+    // Allocated on first use and kept across the resets of the pool
+    VkCommandBuffer secondaryCmdBufs[MAX_JOB_WORKER_COUNT];
+    uint32_t allocatedCount;
+    // Command buffers recorded since the last reset
+    uint32_t usedCount;
+} WorkerCommandPool;
+
+// The visible objects of a frame split into `chunkCount` consecutive ranges, each recorded into one secondary command buffer
+typedef struct DrawRecordContext
+{
+    uint32_t frameIndex;
+    uint32_t imageIndex;
+    uint32_t chunkCount;
+    VkCommandBuffer secondaryCmdBufs[MAX_JOB_WORKER_COUNT];
+    volatile int64_t hasFailed;
+} DrawRecordContext;
+
+// A scene culled in CULL_PARALLEL_BATCH_SIZE ranges, each writing its visible indices at the offset of its first object
+typedef struct ParallelCullContext
+{
+    const ObjectStore* pStore;
+    const Frustum* pFrustum;
+    CullingKernel kernel;
+    uint32_t* pVisibleIndices;
+    uint32_t* pBatchVisibleCounts;
+} ParallelCullContext;
+
+// Steps of PrepareRenderResources that are run as a task graph
+enum STARTUP_TASK_ID
+{
+    STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES,
+    STARTUP_TASK_CREATE_COMMAND_BUFFERS,
+    STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL,
+    STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS,
+    STARTUP_TASK_UPLOAD_VERTEX_DATA,
+    STARTUP_TASK_STREAM_MESH,
+    STARTUP_TASK_SUBMIT_UPLOADS,
+    STARTUP_TASK_CREATE_ANIMATION_PIPELINE,
+    STARTUP_TASK_CREATE_ANIMATION_RESOURCES,
+    STARTUP_TASK_RECORD_ANIMATION_RESET,
+    STARTUP_TASK_LOAD_TEXTURE,
+    STARTUP_TASK_CREATE_DEPTH_RESOURCE,
+    STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT,
+    STARTUP_TASK_CREATE_RENDER_PASS,
+    STARTUP_TASK_CREATE_FLATTEN_PIPELINE,
+    STARTUP_TASK_CREATE_GRADIENT_PIPELINE,
+    STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET,
+    STARTUP_TASK_CREATE_FRAMEBUFFERS,
+    STARTUP_TASK_BUILD_DRAW_COMMANDS,
+    STARTUP_TASK_FLUSH_INIT_COMMAND,
+    STARTUP_TASK_COUNT
+};
+
+typedef struct StartupPhaseTiming
+{
+    const char* name;
+    // Nanoseconds relative to s_startupBeginTime
+    uint64_t beginTime;
+    uint64_t endTime;
+    uint32_t workerIndex;
+} StartupPhaseTiming;
+
+// Per-object simulation state, MUST BE the same as ObjectState in animate.comp.glsl
+typedef struct ObjectState
+{
+    float position[2];
+    float velocity[2];
+    float angle;
+    float angularVelocity;
+    float scale;
+    float reserved;
+} ObjectState;
+
+// MUST BE the same as ObjectTransform in animate.comp.glsl and the instanced vertex shaders
+typedef struct ObjectTransform
+{
+    float offset[2];
+    float angle;
+    float scale;
+} ObjectTransform;
+
+typedef struct AnimationPushConstants
+{
+    uint32_t objectCount;
+    uint32_t reset;
+} AnimationPushConstants;
+
+// MUST BE the same as the push constant block of the bindless shaders. Elements of the descriptor arrays of the bindless set.
+typedef struct BindlessPushConstants
+{
+    uint32_t uniformIndex;
+    uint32_t transformIndex;
+    uint32_t textureIndex;
+} BindlessPushConstants;
+
+static_assert(sizeof(ObjectState) == 32U, "Invalid ObjectState size");
+static_assert(sizeof(ObjectTransform) == 16U, "Invalid ObjectTransform size");
+
+
+static VkLayerProperties s_layerProperties[MAX_VULKAN_LAYER_COUNT];
+static const char* s_layerNames[MAX_VULKAN_LAYER_COUNT];
+static uint32_t s_layerCount;
+static ExtensionSet s_instanceExtensionSet;
+// Capabilities of s_currPhysicalDevice
+static DeviceCapabilities s_deviceCapabilities;
+
+static VkPhysicalDevice s_currPhysicalDevice = VK_NULL_HANDLE;
+static VkInstance s_instance = VK_NULL_HANDLE;
+static VkDevice s_specDevice = VK_NULL_HANDLE;
+static bool s_supportIncrementalPresent = false;
+static uint32_t s_queueFamilyPropertyCount = 0;
+static uint32_t s_specQueueFamilyIndex = 0;
+static VkSurfaceKHR s_surface = VK_NULL_HANDLE;
+static VkSwapchainKHR s_swapchain = VK_NULL_HANDLE;
+static VkSurfaceFormatKHR s_surfaceFormat = { 0 };
+static uint32_t s_graphicsQueueFamilyIndex = 0;
+static uint32_t s_presentQueueFamilyIndex = 0;
+static VkQueue s_graphicsQueue = VK_NULL_HANDLE;
+static VkQueue s_presentQueue = VK_NULL_HANDLE;
+// UINT32_MAX means the initial uploads are recorded into the init command buffer on the graphics queue
+static uint32_t s_transferQueueFamilyIndex = UINT32_MAX;
+static VkQueue s_transferQueue = VK_NULL_HANDLE;
+// Signaled by the upload on the transfer queue and waited by the init command buffer on the graphics queue
+static VkSemaphore s_uploadCompleteSemaphore = VK_NULL_HANDLE;
+// Runs on the transfer queue if there is a separate one, otherwise on the graphics queue
+static UploadManager s_uploadManager = { 0 };
+static bool s_useTransferQueue = true;
+// The objects are animated by animate.comp on the GPU, which writes the transforms read by the instanced vertex shaders,
+// so the CPU cost per frame does not grow with the object count. Cleared if the shaders are missing or by --cpu-animation.
+static bool s_useGpuAnimation = true;
+// UINT32_MAX means the animation is dispatched on the graphics queue
+static uint32_t s_computeQueueFamilyIndex = UINT32_MAX;
+static VkQueue s_computeQueue = VK_NULL_HANDLE;
+static VkCommandPool s_computeCommandPool = VK_NULL_HANDLE;
+// Signaled by the animation dispatch and waited by the draw of the same frame
+static VkSemaphore s_animationCompleteSemaphores[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkBuffer s_objectStateBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory s_objectStateMemory = VK_NULL_HANDLE;
+static VkDescriptorSetLayout s_animationDescSetLayout = VK_NULL_HANDLE;
+static VkPipelineLayout s_animationPipelineLayout = VK_NULL_HANDLE;
+static VkPipeline s_animationPipeline = VK_NULL_HANDLE;
+static VkDescriptorPool s_animationDescPool = VK_NULL_HANDLE;
+// NULL means drawing the built-in square, otherwise the mesh file set by --mesh is drawn for every object
+static const char* s_meshFilePath = NULL;
+// An OBJ file converted into s_meshFilePath before rendering
+static const char* s_importObjPath = NULL;
+// Only mapped until the mesh has been streamed to the device, the header is kept for the pipelines and the draws.
+static MeshFile s_meshFile = { 0 };
+static MeshFileHeader s_meshHeader = { 0 };
+static VkBuffer s_meshVertexBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory s_meshVertexMemory = VK_NULL_HANDLE;
+static VkBuffer s_meshIndexBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory s_meshIndexMemory = VK_NULL_HANDLE;
+// NULL means the objects are not textured, otherwise the gradient pipeline samples the KTX 2.0 file set by --texture.
+// Cleared if the textured shaders are missing or the device cannot sample the texture format.
+static const char* s_texturePath = NULL;
+// Only mapped until every level stored in the file has been uploaded
+static TextureFile s_textureFile = { 0 };
+static VkImage s_textureImage = VK_NULL_HANDLE;
+static VkDeviceMemory s_textureMemory = VK_NULL_HANDLE;
+static VkImageView s_textureView = VK_NULL_HANDLE;
+static VkSampler s_textureSampler = VK_NULL_HANDLE;
+// Levels of s_textureImage, more than the file stores if the mip chain is generated with blits
+static uint32_t s_textureLevelCount = 0;
+// Finest level whose upload has completed, the shader clamps the sampled level of detail to it.
+static uint32_t s_textureResidentLevel = 0;
+// Level being streamed in, equal to s_textureResidentLevel if none
+static uint32_t s_textureStreamingLevel = 0;
+// The streamed level is resident once s_textureUploadManager has completed this many batches.
+static uint32_t s_textureStreamingBatchCount = 0;
+static uint64_t s_textureLoadBeginTime = 0;
+// Streams the texture on the graphics queue, so the levels need no queue family ownership transfer.
+// Not created if the texture is written with host image copies.
+static UploadManager s_textureUploadManager = { 0 };
+// VK_EXT_host_image_copy lets the host write texture levels straight into the image, skipping the staging copy and the queue.
+// Cleared if the device does not support it or by --no-host-image-copy.
+static bool s_useHostImageCopy = true;
+static PFN_vkCopyMemoryToImageEXT s_vkCopyMemoryToImageEXT = NULL;
+static PFN_vkTransitionImageLayoutEXT s_vkTransitionImageLayoutEXT = NULL;
+// Whether the levels of s_textureImage are written with host image copies instead of s_textureUploadManager
+static bool s_textureUsesHostImageCopy = false;
+static uint64_t s_textureUploadedSize = 0;
+// The animation advances the objects by the measured time between two frames. The first frame takes the nominal step,
+// and stalls (a breakpoint, a dragged window) are clamped so that the objects do not jump across the view.
+static const float s_nominalAnimationTimeStep = 1.0f / 60.0f;
+static const float s_maxAnimationTimeStep = 0.1f;
+static uint64_t s_lastAnimationTime = 0;
+static SwapchainImageResources s_swapchainImageResources[MAX_SWAPCHAIN_IMAGE_COUNT] = { 0 };
+static uint32_t s_swapchainImageCount = 0;
+static uint32_t s_render_width, s_render_height;
+static uint32_t s_frameLag = FRAME_LAG;
+static VkFence s_presentFences[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkSemaphore s_imageAcquiredSemaphores[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkSemaphore s_drawCompleteSemaphores[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkSemaphore s_imageOwnershipSemaphores[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkCommandPool s_commandPool = VK_NULL_HANDLE;
+static VkCommandPool s_presentCommandPool = VK_NULL_HANDLE;
+static VkCommandBuffer s_commandBuffers[1] = { VK_NULL_HANDLE };
+// With --record-per-frame, the draw commands are recorded every frame into the command buffer of the frame in flight
+// instead of being pre-recorded per swapchain image. Each frame owns a transient pool, which is reset as a whole
+// once the fence of the frame has been waited for.
+static bool s_recordCommandsPerFrame = false;
+static VkCommandPool s_frameCommandPools[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+static VkCommandBuffer s_frameCommandBuffers[MAX_FRAME_LAG] = { VK_NULL_HANDLE };
+// With --record-threads=<n>, the render pass contents are split into n secondary command buffers recorded on s_jobSystem,
+// which the primary command buffer of the frame executes in order. 0 records them inline into the primary command buffer.
+static uint32_t s_recordThreadCount = 0;
+static WorkerCommandPool s_workerCommandPools[MAX_FRAME_LAG][MAX_JOB_WORKER_COUNT];
+static VkBuffer s_hostUniformBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory s_hostUniformMemory = VK_NULL_HANDLE;
+static VkDescriptorSetLayout s_descSetLayout = VK_NULL_HANDLE;
+static VkPipelineLayout s_pipelineLayout = VK_NULL_HANDLE;
+static VkRenderPass s_render_pass = VK_NULL_HANDLE;
+static VkPipelineCache s_pipelineCaches[3] = { VK_NULL_HANDLE };
+static VkPipeline s_pipelines[3] = { VK_NULL_HANDLE };
+// Destroys the objects retired while frames are in flight once the frames using them have completed. The values are frame
+// numbers: s_submittedFrameValue counts the submitted frames, and every present fence signals the frame recorded in s_frameSlotValues.
+static DeletionQueue s_deletionQueue;
+static uint64_t s_submittedFrameValue = 0;
+static uint64_t s_frameSlotValues[MAX_FRAME_LAG] = { 0 };
+// With --reload-shaders
+static uint32_t s_shaderReloadCount = 0;
+static uint64_t s_totalShaderReloadTime = 0;
+static uint64_t s_maxShaderReloadTime = 0;
+static VkDescriptorPool s_descPool = VK_NULL_HANDLE;
+// With --bindless, all the draws read their resources from the arrays of one global descriptor set (VK_EXT_descriptor_indexing),
+// bound once per command buffer, and the shaders index them with push constants and gl_InstanceIndex.
+// Cleared if the device does not support it, the objects are animated on the CPU or the bindless shaders are missing.
+static bool s_useBindless = false;
+static VkDescriptorSet s_bindlessDescSet = VK_NULL_HANDLE;
+static uint32_t s_bindlessBufferCapacity = 0;
+static uint32_t s_bindlessTextureCapacity = 0;
+static uint32_t s_bindlessBufferCount = 0;
+static uint32_t s_bindlessTextureCount = 0;
+// Element of s_textureView in the image array of the bindless set
+static uint32_t s_bindlessTextureIndex = 0;
+// With --descriptor-buffer, the descriptors of every swapchain image are written into s_descriptorBuffer with vkGetDescriptorEXT
+// and bound by their offset (VK_EXT_descriptor_buffer), so no descriptor pool or set is created.
+// EXPERIMENTAL: it has not been run on a device exposing the extension yet, so it stays off unless asked for.
+// Cleared if the device does not support it or the bindless model is used.
+static bool s_useDescriptorBuffer = false;
+// Whether VK_EXT_descriptor_buffer is enabled on the device. Only --descriptor-buffer and --descriptor-benchmark enable it,
+// so the other runs keep the device features of the pool path.
+static bool s_supportDescriptorBuffer = false;
+static bool s_isDescriptorBufferRequested = false;
+static PFN_vkGetDescriptorSetLayoutSizeEXT s_vkGetDescriptorSetLayoutSizeEXT = NULL;
+static PFN_vkGetDescriptorSetLayoutBindingOffsetEXT s_vkGetDescriptorSetLayoutBindingOffsetEXT = NULL;
+static PFN_vkGetDescriptorEXT s_vkGetDescriptorEXT = NULL;
+static PFN_vkCmdBindDescriptorBuffersEXT s_vkCmdBindDescriptorBuffersEXT = NULL;
+static PFN_vkCmdSetDescriptorBufferOffsetsEXT s_vkCmdSetDescriptorBufferOffsetsEXT = NULL;
+// Host visible and persistently mapped, holding the set of swapchain image i at i * s_descriptorSetStride
+static VkBuffer s_descriptorBuffer = VK_NULL_HANDLE;
+static VkDeviceMemory s_descriptorBufferMemory = VK_NULL_HANDLE;
+static uint8_t* s_descriptorBufferData = NULL;
+static VkDeviceAddress s_descriptorBufferAddress = 0;
+static VkBufferUsageFlags s_descriptorBufferUsage = 0;
+// Size of s_descSetLayout rounded up to descriptorBufferOffsetAlignment
+static VkDeviceSize s_descriptorSetStride = 0;
+// Offsets of the bindings of s_descSetLayout in a set
+static VkDeviceSize s_descriptorBindingOffsets[3] = { 0 };
+static bool s_isRenderPrepared = false;
+static float s_currRorationDegree = 0.0f;
+
+// Headless rendering renders into offscreen images instead of swapchain images, so no window or display is required.
+static bool s_isHeadless = false;
+// Receives a report written to stdout. The logs then go to stderr, so the report can be piped on its own.
+static FILE* s_reportStream = NULL;
+// The number of squares drawn per frame. Objects are split evenly between the two pipelines.
+static uint32_t s_objectCount = 2;
+static const uint32_t s_cullBenchmarkObjectCounts[CULL_BENCHMARK_SIZE_COUNT] = { 10000, 100000, 1000000 };
+// Eye space bounds of the objects in draw order, culled against s_viewFrustum into s_visibleObjectIndices before the draws are recorded
+static ObjectStore s_sceneObjectStore = { 0 };
+static Frustum s_viewFrustum;
+static CullingKernel s_sceneCullingKernel = CULLING_KERNEL_SCALAR;
+// Ascending indices into s_sceneObjectStore, the first s_visibleObjectCount are valid
+static uint32_t* s_visibleObjectIndices = NULL;
+static uint32_t s_visibleObjectCount = 0;
+// One count per CULL_PARALLEL_BATCH_SIZE objects, for CullObjectsInParallel
+static uint32_t* s_cullBatchVisibleCounts = NULL;
+// A copy of the object states of animate.comp.glsl, advanced with the time step of every dispatch so the culling follows the objects drawn.
+// Only kept when the draws are recorded per frame, since the pre-recorded draws are culled once for all frames.
+static ObjectState* s_animatedObjectStates = NULL;
+// Bounding radius of every animated object, drift margin included
+static float s_animatedObjectRadius = 0.0f;
+static VkPresentModeKHR s_preferredPresentMode = VK_PRESENT_MODE_FIFO_KHR;
+// UINT32_MAX means choosing the device automatically
+static uint32_t s_deviceIndexOverride = UINT32_MAX;
+// Ignore the cached device and score all devices again
+static bool s_rescanDevices = false;
+static uint32_t s_timestampValidBits = 0;
+static float s_timestampPeriod = 1.0f;
+// Two timestamp queries (begin and end) per swapchain image command buffer
+static VkQueryPool s_timestampQueryPool = VK_NULL_HANDLE;
+
+// Startup instrumentation
+static uint64_t s_startupBeginTime = 0;
+static uint64_t s_firstFrameTime = 0;
+static uint64_t s_startupCriticalPathTime = 0;
+// 0 means choosing the worker count by the number of logical processors
+static uint32_t s_startupWorkerCount = 0;
+// Runs the per-frame CPU work, 0 workers means one per logical processor
+static JobSystem s_jobSystem;
+static uint32_t s_jobWorkerCount = 0;
+// With --capture, every headless frame is read back and written to "<s_captureFilePrefix>_<frame>.<format>" by the job system.
+static const char* s_captureFilePrefix = NULL;
+static ImageFileFormat s_captureFileFormat = IMAGE_FILE_FORMAT_PNG;
+static uint32_t s_captureSlotCount = DEFAULT_FRAME_CAPTURE_SLOT_COUNT;
+static FrameCapture s_frameCapture;
+// With --stream, every headless frame is read back through a ring of its own and written to s_streamPath in order by a writer thread.
+static const char* s_streamPath = NULL;
+static FrameCaptureOutput s_streamOutput = FRAME_CAPTURE_OUTPUT_Y4M_STREAM;
+static uint32_t s_streamFrameRate = DEFAULT_STREAM_FRAME_RATE;
+// Cleared by --cpu-yuv, or if the Y4M frames cannot be converted in a compute shader
+static bool s_convertStreamOnGpu = true;
+static FrameCapture s_frameStream;
+// With --export, the headless render targets are handed to a consumer process connecting to s_exportSocketPath without being copied.
+static const char* s_exportSocketPath = NULL;
+// --serve renders the frames requested by clients of a Unix domain socket at this path instead of running the benchmark
+static const char* s_serverSocketPath = NULL;
+static VkExternalMemoryHandleTypeFlagBits s_exportMemoryHandleType = VK_EXTERNAL_MEMORY_HANDLE_TYPE_OPAQUE_FD_BIT;
+static VkExternalSemaphoreHandleTypeFlagBits s_exportSemaphoreHandleType = VK_EXTERNAL_SEMAPHORE_HANDLE_TYPE_OPAQUE_FD_BIT;
+// Of the dedicated allocations of the render targets, which the consumer imports with the same size and type
+static VkDeviceSize s_exportAllocationSizes[MAX_FRAME_LAG];
+static uint32_t s_exportMemoryTypeIndex = 0;
+static FrameExport s_frameExport;
+// With --host-allocator, every Vulkan object created here is given the callbacks of s_hostAllocator, which count what the driver
+// allocates per allocation scope. Otherwise s_pAllocator stays NULL and the driver allocates on its own.
+static bool s_useHostAllocator = false;
+static HostAllocator s_hostAllocator;
+static const VkAllocationCallbacks* s_pAllocator = NULL;
+// Taken around the measured benchmark frames
+static HostAllocationStatistics s_frameBeginHostAllocations;
+static HostAllocationStatistics s_frameEndHostAllocations;
+// Every device memory allocation goes through s_memoryTracker, which places it by category within the budgets of the heaps.
+// The budgets and the usage of the other processes come from VK_EXT_memory_budget if the device supports it.
+static bool s_supportMemoryBudget = false;
+// --memory-budget caps the budget of every heap to this many MiB, 0 for no cap
+static uint32_t s_memoryBudgetLimit = 0;
+static DeviceMemoryTracker s_memoryTracker;
+// --context-benchmark renders on 1 up to this many render contexts at once after the frames, 0 skips it.
+// Known before the device is created, which gets a queue for every context if the queue family has enough of them.
+static uint32_t s_renderContextCount = 0;
+// Created in the queue family of s_specQueueFamilyIndex. The renderer only uses the first one, the render contexts the others.
+static uint32_t s_specQueueCount = 1;
+static StartupPhaseTiming s_startupPhases[MAX_STARTUP_PHASE_COUNT];
+static uint32_t s_startupPhaseCount = 0;
+
+struct
+{
+    VkImage image;
+    VkDeviceMemory device_memory;
+    VkImageView image_view;
+} s_depthResource;
+
+static const char* const s_deviceTypes[] = {
+    "Other",
+    "Integrated GPU",
+    "Discrete GPU",
+    "Virtual GPU",
+    "CPU"
+};
+
+// Preference of each device type, indexed by VkPhysicalDeviceType
+static const uint64_t s_deviceTypeRanks[] = { 1, 3, 4, 2, 1 };
+
+// The capabilities of the automatically chosen device are stored here,
+// so later launches skip scoring all devices and enumerating their capabilities.
+static const char* const s_deviceCacheFilePath = "device_cache.bin";
+
+static const float s_vertex_coords_data[4 * 4] = {
+    // bottom left
+    -0.2f, 0.2f, 0.0f, 1.0f,
+    // bottom right
+    0.2f, 0.2f, 0.0f, 1.0f,
+    // top left
+    -0.2f, -0.2f, 0.0f, 1.0f,
+    // top right
+    0.2f, -0.2f, 0.0f, 1.0f
+};
+
+// Where the vertex shaders place the objects, which the culling bounds MUST follow: the eye space depth of every object,
+// the offsets of the flatten and gradient objects drawn without the GPU animation,
+// the half size of the square the objects animated by animate.comp.glsl bounce in, and how far the copy of that animation on the CPU
+// may drift from the device, which rounds its floats differently.
+static const float s_objectEyeDepth = -2.3f;
+static const float s_staticObjectOffsets[2][2] = { { -0.6f, -0.6f }, { 0.6f, -0.6f } };
+static const float s_animationBoundsHalfSize = 0.8f;
+static const float s_animationDriftMargin = 0.01f;
+// The glOrtho of the vertex shaders with the u_factor written by UpdateUniformData, column-major.
+// The camera sits at the origin of the eye space, so this is the whole view-projection.
+static const float s_viewProjection[16] = {
+    1.0f, 0.0f, 0.0f, 0.0f,
+    0.0f, 1.0f, 0.0f, 0.0f,
+    0.0f, 0.0f, -1.0f, 0.0f,
+    0.0f, 0.0f, -2.0f, 1.0f
+};
+
+static const float s_vertex_color_data[4 * 4] = {
+    // bottom left
+    0.9f, 0.1f, 0.1f, 1.0f,
+    // bottom right
+    0.1f, 0.9f, 0.1f, 1.0f,
+    // top left
+    0.1f, 0.1f, 0.9f, 1.0f,
+    // top right
+    0.9f, 0.1f, 0.9f, 1.0f
+};
+
+static inline bool IsSeperatePresentQueue(void)
+{
+    return s_graphicsQueueFamilyIndex != s_presentQueueFamilyIndex;
+}
+
+static inline bool IsSeperateTransferQueue(void)
+{
+    return s_transferQueue != VK_NULL_HANDLE && s_transferQueueFamilyIndex != s_graphicsQueueFamilyIndex;
+}
+
+static inline bool IsSeperateComputeQueue(void)
+{
+    return s_computeQueueFamilyIndex != UINT32_MAX && s_computeQueueFamilyIndex != s_graphicsQueueFamilyIndex;
+}
+
+static VkResult init_global_layer_properties(void)
+{
+    uint32_t instance_layer_count;
+    VkResult res;
+
+    // It's possible, though very rare, 
+    // that the number of instance layers could change.
+    // For example, installing something could include new layers that
+    // the loader would pick up between the initial query for the count and the request for VkLayerProperties.
+    // The loader indicates that by returning a VK_INCOMPLETE status and will update the the count parameter.
+    // The count parameter will be updated with the number of entries loaded into the data pointer -
+    // in case the number of layers went down or is smaller than the size given.
+    do
+    {
+        res = vkEnumerateInstanceLayerProperties(&instance_layer_count, NULL);
+        if (res != VK_SUCCESS) {
+            return res;
+        }
+
+        if (instance_layer_count == 0) {
+            return VK_SUCCESS;
+        }
+        instance_layer_count = min(instance_layer_count, MAX_VULKAN_LAYER_COUNT);
+
+        res = vkEnumerateInstanceLayerProperties(&instance_layer_count, s_layerProperties);
+    } while (res == VK_INCOMPLETE);
+
+    s_layerCount = instance_layer_count;
+    for (uint32_t i = 0; i < instance_layer_count; i++) {
+        s_layerNames[i] = s_layerProperties[i].layerName;
+    }
+
+    return res;
+}
+
+static bool InitializeVulkanInstance(const char *appName, const char *engineName)
+{
+    VkResult result = init_global_layer_properties();
+    if (result != VK_SUCCESS)
+    {
+        printf("init_global_layer_properties failed: %d\n", result);
+        return false;
+    }
+    printf("Found %u layer(s)...\n", s_layerCount);
+
+    // Check whether a validation layer exists
+    for (uint32_t i = 0; i < s_layerCount; ++i)
+    {
+        if (strstr(s_layerNames[i], "validation") != NULL)
+        {
+            printf("Contains %s!\n", s_layerNames[i]);
+            break;
+        }
+    }
+
+    // Query the API version
+    uint32_t apiVersion = VK_API_VERSION_1_0;
+    result = vkEnumerateInstanceVersion(&apiVersion);
+    if (result != VK_SUCCESS)
+    {
+        printf("vkEnumerateInstanceVersion failed: %d\n", result);
+        return false;
+    }
+    printf("Current API version: %u.%u.%u\n", VK_VERSION_MAJOR(apiVersion), VK_VERSION_MINOR(apiVersion), VK_VERSION_PATCH(apiVersion));
+
+    // initialize the VkApplicationInfo structure
+    const VkApplicationInfo app_info = {
+        .sType = VK_STRUCTURE_TYPE_APPLICATION_INFO,
+        .pNext = NULL,
+        .pApplicationName = appName,
+        .applicationVersion = 1,
+        .pEngineName = engineName,
+        .engineVersion = 1,
+        .apiVersion = apiVersion
+    };
+
+    result = QueryInstanceExtensionSet(NULL, &s_instanceExtensionSet);
+    if (result != VK_SUCCESS)
+    {
+        printf("QueryInstanceExtensionSet failed: %d\n", result);
+        return false;
+    }
+    printf("Found %u instance extensions!\n", s_instanceExtensionSet.count);
+
+    uint32_t availExtensionCount = 0;
+    const char* availExtensionNames[8];
+
+    const bool supportSurface = ContainsExtension(&s_instanceExtensionSet, VK_KHR_SURFACE_EXTENSION_NAME);
+    if (supportSurface) {
+        availExtensionNames[availExtensionCount++] = VK_KHR_SURFACE_EXTENSION_NAME;
+    }
+#ifdef _WIN32
+    const bool supportFurfaceWin32 = ContainsExtension(&s_instanceExtensionSet, VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+    if (supportFurfaceWin32) {
+        availExtensionNames[availExtensionCount++] = VK_KHR_WIN32_SURFACE_EXTENSION_NAME;
+    }
+#endif // _WIN32
+    const bool supportColorSpaceExt = ContainsExtension(&s_instanceExtensionSet, VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME);
+    if (supportColorSpaceExt) {
+        availExtensionNames[availExtensionCount++] = VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME;
+    }
+    printf("Found %u required instance extensions!\n", availExtensionCount);
+
+    if (!supportSurface) {
+        printf("%s not supported!\n", VK_KHR_SURFACE_EXTENSION_NAME);
+    }
+#ifdef _WIN32
+    if (!supportFurfaceWin32) {
+        printf("%s not supported!\n", VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+    }
+#endif // _WIN32
+    if (!supportColorSpaceExt) {
+        printf("%s not supported!\n", VK_EXT_SWAPCHAIN_COLOR_SPACE_EXTENSION_NAME);
+    }
+
+    // initialize the VkInstanceCreateInfo structure
+    const VkInstanceCreateInfo inst_info = {
+        .sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .pApplicationInfo = &app_info,
+        .enabledExtensionCount = availExtensionCount,
+        .ppEnabledExtensionNames = availExtensionNames,
+        .enabledLayerCount = 0, // s_layerCount,
+        .ppEnabledLayerNames = s_layerNames
+    };
+
+    result = vkCreateInstance(&inst_info, s_pAllocator, &s_instance);
+    if (result == VK_ERROR_INCOMPATIBLE_DRIVER) {
+        puts("cannot find a compatible Vulkan ICD");
+    }
+    else if (result != VK_SUCCESS) {
+        printf("vkCreateInstance failed: %d\n", result);
+    }
+
+    return result == VK_SUCCESS;
+}
+
+static bool IsQueueFamilyUsable(VkPhysicalDevice physicalDevice, uint32_t queueFamilyIndex, const VkQueueFamilyProperties* pProperties, VkQueueFlagBits queueFlag)
+{
+    if ((pProperties->queueFlags & queueFlag) == 0) return false;
+#ifdef _WIN32
+    // Query whether the current queue supports presentation operations.
+    // Headless rendering never presents, so any matching queue family will do.
+    if (!s_isHeadless && vkGetPhysicalDeviceWin32PresentationSupportKHR(physicalDevice, queueFamilyIndex) != VK_TRUE) return false;
+#else
+    (void)physicalDevice;
+    (void)queueFamilyIndex;
+#endif // _WIN32
+    return true;
+}
+
+// Returns 0 if the device cannot run this application, otherwise the higher the more preferable.
+// The device type dominates the score, then the size of device local memory, then the queue family layout.
+static uint64_t ScorePhysicalDevice(VkPhysicalDevice physicalDevice, const DeviceCapabilities* pCapabilities, VkQueueFlagBits queueFlag)
+{
+    // Headless rendering never presents, so a swapchain is not required.
+    if (!s_isHeadless && !ContainsExtension(&pCapabilities->extensions, VK_KHR_SWAPCHAIN_EXTENSION_NAME))
+    {
+        printf("Not usable: %s not supported!\n", VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+        return 0;
+    }
+    // The vertex shaders declare their uniform blocks with the scalar layout.
+    if (pCapabilities->scalarBlockLayout == VK_FALSE)
+    {
+        printf("Not usable: %s feature not supported!\n", VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME);
+        return 0;
+    }
+
+    bool hasRequiredQueueFamily = false;
+    uint64_t queueScore = 0;
+    for (uint32_t i = 0; i < pCapabilities->queueFamilyCount; ++i)
+    {
+        const VkQueueFlags queueFlags = pCapabilities->queueFamilies[i].queueFlags;
+        if (IsQueueFamilyUsable(physicalDevice, i, &pCapabilities->queueFamilies[i], queueFlag)) {
+            hasRequiredQueueFamily = true;
+        }
+        // Prefer devices that can run compute or transfer work beside the graphics queue.
+        if ((queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 && (queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+            queueScore |= 2;
+        }
+        if ((queueFlags & VK_QUEUE_TRANSFER_BIT) != 0 && (queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0) {
+            queueScore |= 1;
+        }
+    }
+    if (!hasRequiredQueueFamily)
+    {
+        puts("Not usable: no queue family supports the required queue capabilities!");
+        return 0;
+    }
+
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties = &pCapabilities->memoryProperties;
+    uint64_t deviceLocalMemorySize = 0;
+    for (uint32_t i = 0; i < pMemoryProperties->memoryHeapCount; ++i)
+    {
+        if ((pMemoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0) {
+            deviceLocalMemorySize += pMemoryProperties->memoryHeaps[i].size;
+        }
+    }
+    const uint64_t deviceLocalMemoryMiB = min(deviceLocalMemorySize >> 20, (uint64_t)UINT32_MAX);
+    printf("Device local memory: %llu MiB\n", (unsigned long long)deviceLocalMemoryMiB);
+
+    const VkPhysicalDeviceType deviceType = pCapabilities->properties.deviceType;
+    const uint64_t typeRank = (uint32_t)deviceType < sizeof(s_deviceTypeRanks) / sizeof(s_deviceTypeRanks[0]) ? s_deviceTypeRanks[deviceType] : 1;
+    return (typeRank << 48) | (deviceLocalMemoryMiB << 8) | queueScore;
+}
+
+// Fills s_deviceCapabilities from the cache file if it describes `physicalDevice` on the current driver,
+// otherwise queries them again.
+static bool LoadOrQueryDeviceCapabilities(VkPhysicalDevice physicalDevice)
+{
+    if (!s_rescanDevices && LoadDeviceCapabilities(s_deviceCacheFilePath, &s_deviceCapabilities) &&
+        IsDeviceCapabilitiesCurrent(&s_deviceCapabilities, physicalDevice))
+    {
+        printf("Loaded the device capabilities from '%s'\n", s_deviceCacheFilePath);
+        return true;
+    }
+    return QueryDeviceCapabilities(physicalDevice, &s_deviceCapabilities);
+}
+
+// Chooses the device by the command line option or environment variable, then by the cache file,
+// and finally by scoring all devices. The capabilities of the chosen device are stored into s_deviceCapabilities.
+static bool ChoosePhysicalDevice(VkPhysicalDevice physicalDevices[], uint32_t gpu_count, VkQueueFlagBits queueFlag, uint32_t* pDeviceIndex)
+{
+    if (s_deviceIndexOverride != UINT32_MAX)
+    {
+        if (s_deviceIndexOverride >= gpu_count)
+        {
+            printf("The device index (%u) exceeds the max number of available devices (%u)\n", s_deviceIndexOverride, gpu_count);
+            return false;
+        }
+        *pDeviceIndex = s_deviceIndexOverride;
+        return LoadOrQueryDeviceCapabilities(physicalDevices[*pDeviceIndex]);
+    }
+
+    if (!s_rescanDevices && LoadDeviceCapabilities(s_deviceCacheFilePath, &s_deviceCapabilities))
+    {
+        uint8_t deviceUUID[VK_UUID_SIZE];
+        uint32_t i = 0;
+        for (; i < gpu_count; ++i)
+        {
+            GetPhysicalDeviceUUID(physicalDevices[i], deviceUUID);
+            if (memcmp(deviceUUID, s_deviceCapabilities.deviceUUID, VK_UUID_SIZE) != 0) continue;
+
+            printf("Found the cached device in '%s'\n", s_deviceCacheFilePath);
+            // The driver has been updated, so its capabilities may have changed.
+            const bool isCurrent = IsDeviceCapabilitiesCurrent(&s_deviceCapabilities, physicalDevices[i]);
+            if (!isCurrent && !QueryDeviceCapabilities(physicalDevices[i], &s_deviceCapabilities)) return false;
+
+            // The cache may have been stored by a headless run, which neither presents nor needs a swapchain,
+            // so the hard requirements MUST BE checked again before the cached device is used.
+            if (ScorePhysicalDevice(physicalDevices[i], &s_deviceCapabilities, queueFlag) == 0)
+            {
+                puts("The cached device cannot run this application, so all devices are scanned again...");
+                break;
+            }
+            *pDeviceIndex = i;
+            if (!isCurrent) {
+                StoreDeviceCapabilities(s_deviceCacheFilePath, &s_deviceCapabilities);
+            }
+            return true;
+        }
+        if (i == gpu_count) {
+            puts("The cached device is not available any more...");
+        }
+    }
+
+    const bool isSingle = gpu_count == 1;
+    printf("\nThis application has detected there %s %u Vulkan capable device%s installed: \n",
+        isSingle ? "is" : "are",
+        gpu_count,
+        isSingle ? "" : "s");
+
+    DeviceCapabilities* pCandidate = malloc(sizeof(*pCandidate));
+    if (pCandidate == NULL) return false;
+
+    uint64_t bestScore = 0;
+    for (uint32_t i = 0; i < gpu_count; i++)
+    {
+        if (!QueryDeviceCapabilities(physicalDevices[i], pCandidate)) continue;
+
+        const VkPhysicalDeviceProperties* pProps = &pCandidate->properties;
+        printf("\n======== Device %u info ========\n", i);
+        printf("Device name: %s\n", pProps->deviceName);
+        printf("Device type: %s\n", s_deviceTypes[pProps->deviceType]);
+        printf("Vulkan API version: %u.%u.%u\n", VK_VERSION_MAJOR(pProps->apiVersion), VK_VERSION_MINOR(pProps->apiVersion), VK_VERSION_PATCH(pProps->apiVersion));
+        printf("Driver version: %08X\n", pProps->driverVersion);
+
+        const uint64_t score = ScorePhysicalDevice(physicalDevices[i], pCandidate, queueFlag);
+        if (score > bestScore)
+        {
+            bestScore = score;
+            *pDeviceIndex = i;
+            s_deviceCapabilities = *pCandidate;
+        }
+    }
+    free(pCandidate);
+
+    if (bestScore == 0)
+    {
+        puts("No device is able to run this application!");
+        return false;
+    }
+
+    StoreDeviceCapabilities(s_deviceCacheFilePath, &s_deviceCapabilities);
+    return true;
+}
+
+// Returns the queue family used for the initial uploads beside `graphicsFamilyIndex`, or UINT32_MAX if there is none.
+// Transfer-only families are preferred, since they are usually backed by dedicated copy engines.
+static uint32_t FindTransferQueueFamily(const VkQueueFamilyProperties* pProperties, uint32_t count, uint32_t graphicsFamilyIndex)
+{
+    uint32_t familyIndex = UINT32_MAX;
+    uint32_t bestRank = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const VkQueueFlags queueFlags = pProperties[i].queueFlags;
+        // Graphics and compute queues support transfer operations implicitly.
+        if (i == graphicsFamilyIndex || pProperties[i].queueCount == 0 ||
+            (queueFlags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == 0) {
+            continue;
+        }
+
+        const uint32_t rank = (queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 ? 1 : (queueFlags & VK_QUEUE_COMPUTE_BIT) != 0 ? 2 : 3;
+        if (rank > bestRank)
+        {
+            bestRank = rank;
+            familyIndex = i;
+        }
+    }
+    return familyIndex;
+}
+
+// Returns the queue family the object animation is dispatched on beside `graphicsFamilyIndex`, or UINT32_MAX if there is none.
+// Compute families without graphics support are preferred, since they are usually backed by async compute engines.
+static uint32_t FindAsyncComputeQueueFamily(const VkQueueFamilyProperties* pProperties, uint32_t count, uint32_t graphicsFamilyIndex)
+{
+    uint32_t familyIndex = UINT32_MAX;
+    uint32_t bestRank = 0;
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const VkQueueFlags queueFlags = pProperties[i].queueFlags;
+        if (i == graphicsFamilyIndex || pProperties[i].queueCount == 0 || (queueFlags & VK_QUEUE_COMPUTE_BIT) == 0) {
+            continue;
+        }
+
+        const uint32_t rank = (queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 ? 1 : 2;
+        if (rank > bestRank)
+        {
+            bestRank = rank;
+            familyIndex = i;
+        }
+    }
+    return familyIndex;
+}
+
+// The GPU animation needs the compute shader and the instanced variants of the vertex shaders.
+static bool AreGpuAnimationShadersAvailable(void)
+{
+    const char* const fileNames[] = { "animate.comp.spv", "flatten_instanced.vert.spv", "gradient_instanced.vert.spv" };
+    for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); ++i)
+    {
+        FILE* fp = GeneralOpenFile(fileNames[i]);
+        if (fp == NULL)
+        {
+            printf("Shader file %s not found, so the objects are animated on the CPU. Run glsl_builder.bat to generate it.\n", fileNames[i]);
+            return false;
+        }
+        fclose(fp);
+    }
+    return true;
+}
+
+// The textured variants of the gradient shaders, the vertex shader matching the animation path.
+static bool AreTextureShadersAvailable(void)
+{
+    const char* const fileNames[] = { s_useGpuAnimation ? "textured_instanced.vert.spv" : "textured.vert.spv", "textured.frag.spv" };
+    for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); ++i)
+    {
+        FILE* fp = GeneralOpenFile(fileNames[i]);
+        if (fp == NULL)
+        {
+            printf("Shader file %s not found, so the objects are not textured. Run glsl_builder.bat to generate it.\n", fileNames[i]);
+            return false;
+        }
+        fclose(fp);
+    }
+    return true;
+}
+
+// The bindless variants of the vertex shaders and of the textured fragment shader, which index the arrays of the bindless set.
+static bool AreBindlessShadersAvailable(void)
+{
+    const char* const fileNames[] = {
+        "flatten_bindless.vert.spv", "gradient_bindless.vert.spv", "textured_bindless.vert.spv", "textured_bindless.frag.spv"
+    };
+    for (size_t i = 0; i < sizeof(fileNames) / sizeof(fileNames[0]); ++i)
+    {
+        FILE* fp = GeneralOpenFile(fileNames[i]);
+        if (fp == NULL)
+        {
+            printf("Shader file %s not found, so every swapchain image binds its own descriptor set. Run glsl_builder.bat to generate it.\n", fileNames[i]);
+            return false;
+        }
+        fclose(fp);
+    }
+    return true;
+}
+
+static bool IsYuvConversionShaderAvailable(void)
+{
+    FILE* fp = GeneralOpenFile("rgb_to_yuv.comp.spv");
+    if (fp == NULL)
+    {
+        puts("Shader file rgb_to_yuv.comp.spv not found, so the streamed frames are converted to YUV on the CPU. Run glsl_builder.bat to generate it.");
+        return false;
+    }
+    fclose(fp);
+    return true;
+}
+
+// Return the queue family count
+
+static VkImageUsageFlags GetHeadlessRenderTargetUsage(void)
+{
+    // The YUV conversion of --stream reads the render targets in a compute shader. VK_FORMAT_R8G8B8A8_UNORM always supports it.
+    return VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | (s_convertStreamOnGpu ? VK_IMAGE_USAGE_STORAGE_BIT : 0);
+}
+
+static bool InitializeVulkanDevice(VkQueueFlagBits queueFlag)
+{
+    VkPhysicalDevice physicalDevices[MAX_GPU_COUNT] = { VK_NULL_HANDLE };
+    uint32_t gpu_count = 0;
+    VkResult res = vkEnumeratePhysicalDevices(s_instance, &gpu_count, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEnumeratePhysicalDevices failed: %d\n", res);
+        return false;
+    }
+    gpu_count = min(gpu_count, MAX_GPU_COUNT);
+
+    res = vkEnumeratePhysicalDevices(s_instance, &gpu_count, physicalDevices);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEnumeratePhysicalDevices failed: %d\n", res);
+        return false;
+    }
+
+    uint32_t deviceIndex = 0;
+    if (!ChoosePhysicalDevice(physicalDevices, gpu_count, queueFlag, &deviceIndex)) return false;
+
+    printf("Use device[%u]: %s\n", deviceIndex, s_deviceCapabilities.properties.deviceName);
+
+    s_currPhysicalDevice = physicalDevices[deviceIndex];
+
+    const ExtensionSet* pDeviceExtensions = &s_deviceCapabilities.extensions;
+    printf("The current selected physical device supports %u device extensions!\n", pDeviceExtensions->count);
+
+    uint32_t availExtensionCount = 0;
+    const char* availExtensionNames[12];
+
+    const bool supportSwapchain = ContainsExtension(pDeviceExtensions, VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    if (supportSwapchain) {
+        availExtensionNames[availExtensionCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    }
+    if (ContainsExtension(pDeviceExtensions, VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME)) {
+        availExtensionNames[availExtensionCount++] = VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME;
+    }
+    s_supportIncrementalPresent = ContainsExtension(pDeviceExtensions, VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+    if (s_supportIncrementalPresent) {
+        availExtensionNames[availExtensionCount++] = VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME;
+    }
+    const bool supportDriverProperties = ContainsExtension(pDeviceExtensions, VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME);
+    if (supportDriverProperties) {
+        availExtensionNames[availExtensionCount++] = VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME;
+    }
+    // The extensions VK_EXT_host_image_copy depends on are core in Vulkan 1.3.
+    s_useHostImageCopy = s_useHostImageCopy && s_deviceCapabilities.hostImageCopy != VK_FALSE &&
+        s_deviceCapabilities.properties.apiVersion >= VK_API_VERSION_1_3;
+    if (s_useHostImageCopy) {
+        availExtensionNames[availExtensionCount++] = VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME;
+    }
+    // So are the ones VK_EXT_descriptor_buffer depends on.
+    s_supportDescriptorBuffer = s_isDescriptorBufferRequested && s_deviceCapabilities.descriptorBuffer != VK_FALSE &&
+        s_deviceCapabilities.properties.apiVersion >= VK_API_VERSION_1_3;
+    if (s_supportDescriptorBuffer) {
+        availExtensionNames[availExtensionCount++] = VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME;
+    }
+    // The budgets are queried with vkGetPhysicalDeviceMemoryProperties2, which is core in Vulkan 1.1.
+    s_supportMemoryBudget = ContainsExtension(pDeviceExtensions, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME) &&
+        s_deviceCapabilities.properties.apiVersion >= VK_API_VERSION_1_1;
+    if (s_supportMemoryBudget) {
+        availExtensionNames[availExtensionCount++] = VK_EXT_MEMORY_BUDGET_EXTENSION_NAME;
+    }
+
+    if (!supportSwapchain) {
+        printf("%s feature not supported!\n", VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+    if (!s_supportIncrementalPresent) {
+        printf("%s feature not supported!\n", VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME);
+    }
+    if (!supportDriverProperties) {
+        printf("%s feature not supported or not explicitly given!\n", VK_KHR_DRIVER_PROPERTIES_EXTENSION_NAME);
+    }
+    if (!s_supportMemoryBudget) {
+        printf("%s feature not supported, so the budget of a heap is its size!\n", VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+
+    printf("Available required device extension count: %u\n\n", availExtensionCount);
+    printf("Detail driver info: %s %s\n", s_deviceCapabilities.driverName, s_deviceCapabilities.driverInfo);
+
+    // ==== The following enables the supported features in the feature chaining form ====
+    VkPhysicalDeviceScalarBlockLayoutFeatures scalarBlockLayoutFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SCALAR_BLOCK_LAYOUT_FEATURES,
+        .pNext = NULL,
+        .scalarBlockLayout = s_deviceCapabilities.scalarBlockLayout
+    };
+
+    // physical device feature 2
+    VkPhysicalDeviceFeatures2 features2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+        // The scalar block layout feature structure MUST NOT be chained if the device does not know it.
+        .pNext = s_deviceCapabilities.scalarBlockLayout != VK_FALSE ? &scalarBlockLayoutFeature : NULL,
+        .features = s_deviceCapabilities.features
+    };
+
+    VkPhysicalDeviceHostImageCopyFeaturesEXT hostImageCopyFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_FEATURES_EXT,
+        .pNext = features2.pNext,
+        .hostImageCopy = VK_TRUE
+    };
+    if (s_useHostImageCopy) {
+        features2.pNext = &hostImageCopyFeature;
+    }
+
+    if (scalarBlockLayoutFeature.scalarBlockLayout == VK_FALSE) {
+        printf("%s feature not supported!\n", VK_EXT_SCALAR_BLOCK_LAYOUT_EXTENSION_NAME);
+    }
+    if (!s_useHostImageCopy) {
+        printf("%s feature not supported or disabled!\n", VK_EXT_HOST_IMAGE_COPY_EXTENSION_NAME);
+    }
+
+    // The descriptors of buffers are made from their device addresses
+    VkPhysicalDeviceBufferDeviceAddressFeatures bufferDeviceAddressFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES,
+        .pNext = features2.pNext,
+        .bufferDeviceAddress = VK_TRUE
+    };
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT,
+        .pNext = &bufferDeviceAddressFeature,
+        .descriptorBuffer = VK_TRUE
+    };
+    if (s_supportDescriptorBuffer) {
+        features2.pNext = &descriptorBufferFeature;
+    }
+    else if (s_isDescriptorBufferRequested) {
+        printf("%s feature not supported!\n", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    }
+
+    const float queue_priorities[1] = { 0.0f };
+    VkDeviceQueueCreateInfo queue_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+        .pNext = NULL,
+        .queueCount = 1,
+        .pQueuePriorities = queue_priorities
+    };
+
+    const VkQueueFamilyProperties* queueFamilyProperties = s_deviceCapabilities.queueFamilies;
+    s_queueFamilyPropertyCount = min(s_deviceCapabilities.queueFamilyCount, MAX_QUEUE_FAMILY_PROPERTY_COUNT);
+
+    bool found = false;
+    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; i++)
+    {
+        if (!IsQueueFamilyUsable(s_currPhysicalDevice, i, &queueFamilyProperties[i], queueFlag)) {
+            continue;
+        }
+        queue_info.queueFamilyIndex = i;
+        found = true;
+        break;
+    }
+    if (!found)
+    {
+        puts("No queue family supports the required queue capabilities!");
+        return false;
+    }
+
+    s_specQueueFamilyIndex = queue_info.queueFamilyIndex;
+    s_timestampValidBits = queueFamilyProperties[s_specQueueFamilyIndex].timestampValidBits;
+    s_timestampPeriod = s_deviceCapabilities.properties.limits.timestampPeriod;
+
+    // A queue from another family lets the initial uploads run while the render resources are still being created.
+    VkDeviceQueueCreateInfo queueInfos[3] = { queue_info, queue_info, queue_info };
+    uint32_t queueInfoCount = 1;
+    // Render contexts on queues of their own do not contend for a queue with each other
+    const float specQueuePriorities[1 + MAX_RENDER_CONTEXT_COUNT] = { 0.0f };
+    if (s_renderContextCount > 0)
+    {
+        queueInfos[0].queueCount = min(1 + s_renderContextCount, queueFamilyProperties[s_specQueueFamilyIndex].queueCount);
+        queueInfos[0].pQueuePriorities = specQueuePriorities;
+    }
+    s_specQueueCount = queueInfos[0].queueCount;
+    s_transferQueueFamilyIndex = s_useTransferQueue ?
+        FindTransferQueueFamily(queueFamilyProperties, s_queueFamilyPropertyCount, s_specQueueFamilyIndex) : UINT32_MAX;
+    if (s_transferQueueFamilyIndex != UINT32_MAX)
+    {
+        queueInfos[queueInfoCount++].queueFamilyIndex = s_transferQueueFamilyIndex;
+        printf("Upload on the queue family %u beside the queue family %u\n", s_transferQueueFamilyIndex, s_specQueueFamilyIndex);
+    }
+
+    // An async compute queue lets the animation of the next frame overlap the rendering of the current one.
+    s_useGpuAnimation = s_useGpuAnimation && s_objectCount > 0 && AreGpuAnimationShadersAvailable();
+    const VkPhysicalDeviceLimits* pLimits = &s_deviceCapabilities.properties.limits;
+    if (s_useGpuAnimation && ((uint64_t)s_objectCount * sizeof(ObjectState) > pLimits->maxStorageBufferRange ||
+        ((uint64_t)s_objectCount + ANIMATION_WORKGROUP_SIZE - 1) / ANIMATION_WORKGROUP_SIZE > pLimits->maxComputeWorkGroupCount[0]))
+    {
+        printf("%u objects exceed the storage buffer or dispatch limits, so they are animated on the CPU.\n", s_objectCount);
+        s_useGpuAnimation = false;
+    }
+    if (s_texturePath != NULL && !AreTextureShadersAvailable()) {
+        s_texturePath = NULL;
+    }
+    // Decided before the headless render targets are created, since the conversion reads them as storage images
+    s_convertStreamOnGpu = s_convertStreamOnGpu && s_streamPath != NULL && s_streamOutput == FRAME_CAPTURE_OUTPUT_Y4M_STREAM;
+    if (s_convertStreamOnGpu && (s_render_width % FRAME_CAPTURE_YUV_BLOCK_WIDTH != 0 || s_render_height % FRAME_CAPTURE_YUV_BLOCK_HEIGHT != 0))
+    {
+        printf("%ux%u is not a multiple of %ux%u, so the streamed frames are converted to YUV on the CPU.\n", s_render_width, s_render_height,
+            FRAME_CAPTURE_YUV_BLOCK_WIDTH, FRAME_CAPTURE_YUV_BLOCK_HEIGHT);
+        s_convertStreamOnGpu = false;
+    }
+    s_convertStreamOnGpu = s_convertStreamOnGpu && IsYuvConversionShaderAvailable();
+    // So are the handle types the render targets are exported with
+    if (s_exportSocketPath != NULL)
+    {
+        // The external memory and semaphore capabilities are core in Vulkan 1.1
+        if (s_deviceCapabilities.properties.apiVersion < VK_API_VERSION_1_1 ||
+            !ContainsExtension(pDeviceExtensions, VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME) ||
+            !ContainsExtension(pDeviceExtensions, VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME))
+        {
+            printf("--export requires Vulkan 1.1 with %s and %s!\n", VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME,
+                VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME);
+            return false;
+        }
+        availExtensionNames[availExtensionCount++] = VK_KHR_EXTERNAL_MEMORY_FD_EXTENSION_NAME;
+        availExtensionNames[availExtensionCount++] = VK_KHR_EXTERNAL_SEMAPHORE_FD_EXTENSION_NAME;
+        const bool supportDmaBuf = ContainsExtension(pDeviceExtensions, VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME);
+        if (supportDmaBuf) {
+            availExtensionNames[availExtensionCount++] = VK_EXT_EXTERNAL_MEMORY_DMA_BUF_EXTENSION_NAME;
+        }
+        if (!ChooseFrameExportHandleTypes(s_currPhysicalDevice, supportDmaBuf, VK_FORMAT_R8G8B8A8_UNORM, GetHeadlessRenderTargetUsage(),
+                                          &s_exportMemoryHandleType, &s_exportSemaphoreHandleType))
+        {
+            puts("The headless render targets or their semaphores cannot be exported as file descriptors!");
+            return false;
+        }
+        printf("Export the frames as %s memory with %s semaphores\n", GetExternalMemoryHandleTypeName(s_exportMemoryHandleType),
+            GetExternalSemaphoreHandleTypeName(s_exportSemaphoreHandleType));
+    }
+
+    // The bindless shaders read the transforms written by the GPU animation, and index the descriptor arrays with push constants,
+    // which needs the dynamic indexing of both array types besides the descriptor indexing features.
+    if (s_useBindless && (!s_useGpuAnimation || s_deviceCapabilities.bindlessDescriptors == VK_FALSE ||
+        s_deviceCapabilities.features.shaderStorageBufferArrayDynamicIndexing == VK_FALSE ||
+        s_deviceCapabilities.features.shaderSampledImageArrayDynamicIndexing == VK_FALSE))
+    {
+        printf("%s not supported or the objects are animated on the CPU, so every swapchain image binds its own descriptor set.\n",
+            VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+        s_useBindless = false;
+    }
+    s_useBindless = s_useBindless && AreBindlessShadersAvailable();
+    VkPhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeature = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .pNext = features2.pNext,
+        .descriptorBindingSampledImageUpdateAfterBind = VK_TRUE,
+        .descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE,
+        .descriptorBindingUpdateUnusedWhilePending = VK_TRUE,
+        .descriptorBindingPartiallyBound = VK_TRUE,
+        .runtimeDescriptorArray = VK_TRUE
+    };
+    if (s_useBindless)
+    {
+        features2.pNext = &descriptorIndexingFeature;
+        // Core in Vulkan 1.2
+        if (s_deviceCapabilities.properties.apiVersion < VK_API_VERSION_1_2) {
+            availExtensionNames[availExtensionCount++] = VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME;
+        }
+        s_bindlessBufferCapacity = min(BINDLESS_BUFFER_CAPACITY, s_deviceCapabilities.maxBindlessStorageBuffers);
+        s_bindlessTextureCapacity = min(BINDLESS_TEXTURE_CAPACITY, s_deviceCapabilities.maxBindlessSampledImages);
+        printf("Bindless descriptors: %u buffers and %u textures in one global set\n", s_bindlessBufferCapacity, s_bindlessTextureCapacity);
+    }
+    // The bindless set relies on update-after-bind pools, which descriptor buffers replace altogether.
+    if (s_useDescriptorBuffer && (!s_supportDescriptorBuffer || s_useBindless))
+    {
+        printf("%s not supported or the bindless model is used, so the descriptor sets are allocated from a pool.\n",
+            VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+        s_useDescriptorBuffer = false;
+    }
+    s_computeQueueFamilyIndex = s_useGpuAnimation ?
+        FindAsyncComputeQueueFamily(queueFamilyProperties, s_queueFamilyPropertyCount, s_specQueueFamilyIndex) : UINT32_MAX;
+    if (s_computeQueueFamilyIndex != UINT32_MAX)
+    {
+        // A queue family MUST NOT appear twice in pQueueCreateInfos. When the transfer queue comes from the same family,
+        // both share its first queue, which is safe since the upload has been submitted before the first frame is animated.
+        if (s_computeQueueFamilyIndex != s_transferQueueFamilyIndex) {
+            queueInfos[queueInfoCount++].queueFamilyIndex = s_computeQueueFamilyIndex;
+        }
+        printf("Animate on the queue family %u beside the queue family %u\n", s_computeQueueFamilyIndex, s_specQueueFamilyIndex);
+    }
+
+    // There are two ways to enable features:
+    // (1) Set pNext to a VkPhysicalDeviceFeatures2 structure and set pEnabledFeatures to NULL;
+    // (2) or set pNext to NULL and set pEnabledFeatures to a VkPhysicalDeviceFeatures structure.
+    // Here uses the first way
+    const VkDeviceCreateInfo device_info = {
+        .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = &features2,
+        .queueCreateInfoCount = queueInfoCount,
+        .pQueueCreateInfos = queueInfos,
+        .enabledLayerCount = 0,
+        .ppEnabledLayerNames = NULL,
+        .enabledExtensionCount = availExtensionCount,
+        .ppEnabledExtensionNames = availExtensionNames,
+        .pEnabledFeatures = NULL
+    };
+
+    res = vkCreateDevice(s_currPhysicalDevice, &device_info, s_pAllocator, &s_specDevice);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDevice failed: %d\n", res);
+        return false;
+    }
+    const MemoryTrackerCreateInfo memoryTrackerCreateInfo = {
+        .physicalDevice = s_currPhysicalDevice,
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .isMemoryBudgetSupported = s_supportMemoryBudget,
+        .budgetPercent = DEFAULT_MEMORY_BUDGET_PERCENT,
+        .budgetLimit = (VkDeviceSize)s_memoryBudgetLimit << 20
+    };
+    if (!CreateDeviceMemoryTracker(&memoryTrackerCreateInfo, &s_memoryTracker)) return false;
+    const DeletionQueueCreateInfo deletionQueueCreateInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .pMemoryTracker = &s_memoryTracker,
+        .initialCapacity = DEFAULT_DELETION_QUEUE_CAPACITY
+    };
+    if (!CreateDeletionQueue(&deletionQueueCreateInfo, &s_deletionQueue)) return false;
+    for (uint32_t i = 0; i < s_memoryTracker.memoryProperties.memoryHeapCount; ++i)
+    {
+        const VkMemoryHeap* pHeap = &s_memoryTracker.memoryProperties.memoryHeaps[i];
+        printf("Memory heap[%u]: %lluMB, budget %lluMB%s\n", i, (unsigned long long)(pHeap->size >> 20),
+            (unsigned long long)(s_memoryTracker.heaps[i].budget >> 20), (pHeap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 ? ", device local" : "");
+    }
+
+    if (s_transferQueueFamilyIndex != UINT32_MAX) {
+        vkGetDeviceQueue(s_specDevice, s_transferQueueFamilyIndex, 0, &s_transferQueue);
+    }
+    if (s_computeQueueFamilyIndex != UINT32_MAX) {
+        vkGetDeviceQueue(s_specDevice, s_computeQueueFamilyIndex, 0, &s_computeQueue);
+    }
+
+    if (s_useHostImageCopy)
+    {
+        s_vkCopyMemoryToImageEXT = (PFN_vkCopyMemoryToImageEXT)vkGetDeviceProcAddr(s_specDevice, "vkCopyMemoryToImageEXT");
+        s_vkTransitionImageLayoutEXT = (PFN_vkTransitionImageLayoutEXT)vkGetDeviceProcAddr(s_specDevice, "vkTransitionImageLayoutEXT");
+        s_useHostImageCopy = s_vkCopyMemoryToImageEXT != NULL && s_vkTransitionImageLayoutEXT != NULL;
+    }
+    if (s_supportDescriptorBuffer)
+    {
+        s_vkGetDescriptorSetLayoutSizeEXT = (PFN_vkGetDescriptorSetLayoutSizeEXT)vkGetDeviceProcAddr(s_specDevice, "vkGetDescriptorSetLayoutSizeEXT");
+        s_vkGetDescriptorSetLayoutBindingOffsetEXT =
+            (PFN_vkGetDescriptorSetLayoutBindingOffsetEXT)vkGetDeviceProcAddr(s_specDevice, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+        s_vkGetDescriptorEXT = (PFN_vkGetDescriptorEXT)vkGetDeviceProcAddr(s_specDevice, "vkGetDescriptorEXT");
+        s_vkCmdBindDescriptorBuffersEXT = (PFN_vkCmdBindDescriptorBuffersEXT)vkGetDeviceProcAddr(s_specDevice, "vkCmdBindDescriptorBuffersEXT");
+        s_vkCmdSetDescriptorBufferOffsetsEXT = (PFN_vkCmdSetDescriptorBufferOffsetsEXT)vkGetDeviceProcAddr(s_specDevice, "vkCmdSetDescriptorBufferOffsetsEXT");
+        s_supportDescriptorBuffer = s_vkGetDescriptorSetLayoutSizeEXT != NULL && s_vkGetDescriptorSetLayoutBindingOffsetEXT != NULL &&
+            s_vkGetDescriptorEXT != NULL && s_vkCmdBindDescriptorBuffersEXT != NULL && s_vkCmdSetDescriptorBufferOffsetsEXT != NULL;
+        s_useDescriptorBuffer = s_useDescriptorBuffer && s_supportDescriptorBuffer;
+        if (s_useDescriptorBuffer) {
+            printf("The %s path is experimental and has not been validated on a device yet!\n", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+        }
+    }
+
+    return true;
+}
+
+#ifdef _WIN32
+static bool CreateVulkanSurface(HINSTANCE hInstane, HWND hWnd)
+{
+    // Destroy the surface object if it has already existed.
+    if (s_surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(s_instance, s_surface, s_pAllocator);
+    }
+
+    // Create a WSI surface for the window:
+    const VkWin32SurfaceCreateInfoKHR createInfo = {
+        .sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR,
+        .pNext = NULL,
+        .flags = 0,
+        .hinstance = hInstane,
+        .hwnd = hWnd
+    };
+
+    VkResult res = vkCreateWin32SurfaceKHR(s_instance, &createInfo, s_pAllocator, &s_surface);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateWin32SurfaceKHR failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+#endif // _WIN32
+
+static bool CreateVulkanSwapchain(void)
+{
+    // Iterate over each queue to learn whether it supports presenting:
+    VkBool32 supportsPresents[MAX_QUEUE_FAMILY_PROPERTY_COUNT] = { VK_FALSE };
+    VkResult res;
+    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
+    {
+        res = vkGetPhysicalDeviceSurfaceSupportKHR(s_currPhysicalDevice, i, s_surface, &supportsPresents[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkGetPhysicalDeviceSurfaceSupportKHR failed @%u: %d\n", i, res);
+            return false;
+        }
+    }
+
+    VkQueueFamilyProperties queue_props[MAX_QUEUE_FAMILY_PROPERTY_COUNT] = { 0 };
+    vkGetPhysicalDeviceQueueFamilyProperties(s_currPhysicalDevice, &s_queueFamilyPropertyCount, queue_props);
+
+    // Search for a graphics and a present queue in the array of queue families,
+    // try to find one that supports both
+    uint32_t graphicsQueueFamilyIndex = UINT32_MAX;
+    uint32_t presentQueueFamilyIndex = UINT32_MAX;
+    for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
+    {
+        if ((queue_props[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0)
+        {
+            if (graphicsQueueFamilyIndex == UINT32_MAX) {
+                graphicsQueueFamilyIndex = i;
+            }
+            if (supportsPresents[i] == VK_TRUE)
+            {
+                graphicsQueueFamilyIndex = i;
+                presentQueueFamilyIndex = i;
+                break;
+            }
+        }
+    }
+
+    if (presentQueueFamilyIndex == UINT32_MAX)
+    {
+        // If didn't find a queue that supports both graphics and present, then
+        // find a separate present queue.
+        for (uint32_t i = 0; i < s_queueFamilyPropertyCount; ++i)
+        {
+            if (supportsPresents[i] == VK_TRUE)
+            {
+                presentQueueFamilyIndex = i;
+                break;
+            }
+        }
+    }
+
+    // Generate error if could not find both a graphics and a present queue
+    if (graphicsQueueFamilyIndex == UINT32_MAX || presentQueueFamilyIndex == UINT32_MAX)
+    {
+        puts("Could not find both graphics and present queues!");
+        return false;
+    }
+
+    s_graphicsQueueFamilyIndex = graphicsQueueFamilyIndex;
+    s_presentQueueFamilyIndex = presentQueueFamilyIndex;
+    const bool isSeparatePresentQueue = graphicsQueueFamilyIndex != presentQueueFamilyIndex;
+
+    vkGetDeviceQueue(s_specDevice, graphicsQueueFamilyIndex, 0, &s_graphicsQueue);
+
+    if (!isSeparatePresentQueue) {
+        s_presentQueue = s_graphicsQueue;
+    }
+    else {
+        vkGetDeviceQueue(s_specDevice, presentQueueFamilyIndex, 0, &s_presentQueue);
+    }
+
+    // Check the surface capabilities and formats
+    VkSurfaceCapabilitiesKHR surfCapabilities = { 0 };
+    res = vkGetPhysicalDeviceSurfaceCapabilitiesKHR(s_currPhysicalDevice, s_surface, &surfCapabilities);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetPhysicalDeviceSurfaceCapabilitiesKHR failed: %d\n", res);
+        return false;
+    }
+
+    // Determine the number of VkImages to use in the swap chain.
+    // Application desires to acquire 3 images at a time for triple buffering
+    uint32_t desiredNumOfSwapchainImages = 3;
+    desiredNumOfSwapchainImages = max(desiredNumOfSwapchainImages, surfCapabilities.minImageCount);
+    // If maxImageCount is 0, we can ask for as many images as we want;
+    // otherwise we're limited to maxImageCount
+    if (surfCapabilities.maxImageCount > 0) {
+        // Application must settle for fewer images than desired:
+        desiredNumOfSwapchainImages = min(desiredNumOfSwapchainImages, surfCapabilities.maxImageCount);
+    }
+
+    // Get the list of VkFormat's that are supported:
+    uint32_t formatCount = 0;
+    res = vkGetPhysicalDeviceSurfaceFormatsKHR(s_currPhysicalDevice, s_surface, &formatCount, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetPhysicalDeviceSurfaceFormatsKHR for count failed: %d\n", res);
+        return false;
+    }
+    formatCount = min(formatCount, MAX_FORMAT_COUNT);
+
+    VkSurfaceFormatKHR surfaceFormats[MAX_FORMAT_COUNT];
+    res = vkGetPhysicalDeviceSurfaceFormatsKHR(s_currPhysicalDevice, s_surface, &formatCount, surfaceFormats);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetPhysicalDeviceSurfaceFormatsKHR for content failed: %d\n", res);
+        return false;
+    }
+
+    // Prefer extended SRGB, then normal SRGB and last UNORM RGBA
+    const uint64_t preferredSurfaceFormatList[] = {
+        ((uint64_t)VK_FORMAT_R16G16B16A16_SFLOAT << 32) | VK_COLOR_SPACE_EXTENDED_SRGB_LINEAR_EXT,
+        ((uint64_t)VK_FORMAT_A2B10G10R10_UNORM_PACK32 << 32) | VK_COLOR_SPACE_SRGB_NONLINEAR_KHR,
+        ((uint64_t)VK_FORMAT_R8G8B8A8_SRGB << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
+        ((uint64_t)VK_FORMAT_B8G8R8A8_SRGB << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
+        ((uint64_t)VK_FORMAT_R8G8B8A8_UNORM << 32) | VK_COLORSPACE_SRGB_NONLINEAR_KHR,
+        ((uint64_t)VK_FORMAT_B8G8R8A8_UNORM << 32)| VK_COLORSPACE_SRGB_NONLINEAR_KHR
+    };
+    enum {
+        preferredFormatCount = sizeof(preferredSurfaceFormatList) / sizeof(preferredSurfaceFormatList[0])
+    };
+
+    bool foundPreferredFormat = false;
+    for (int i = 0; i < preferredFormatCount; ++i)
+    {
+        const uint64_t currPreferredFormat = preferredSurfaceFormatList[i];
+        for (uint32_t j = 0; j < formatCount; ++j)
+        {
+            const VkFormat format = surfaceFormats[j].format;
+            const VkColorSpaceKHR colorSpace = surfaceFormats[j].colorSpace;
+            if (currPreferredFormat == (((uint64_t)format << 32) | colorSpace))
+            {
+                s_surfaceFormat = surfaceFormats[j];
+                foundPreferredFormat = true;
+                break;
+            }
+        }
+        if (foundPreferredFormat) {
+            break;
+        }
+    }
+    if (!foundPreferredFormat)
+    {
+        printf("Can't find our preferred formats... Falling back to first exposed format. Rendering may be incorrect.\n");
+        s_surfaceFormat = surfaceFormats[0];
+    }
+
+    VkExtent2D swapchainExtent;
+    // width and height are either both 0xFFFFFFFF, or both not 0xFFFFFFFF.
+    if (surfCapabilities.currentExtent.width == 0xffffffffU || surfCapabilities.currentExtent.height == 0xffffffffU)
+    {
+        // If the surface size is undefined, the size is set to the size
+        // of the images requested, which must fit within the minimum and
+        // maximum values.
+        swapchainExtent.width = s_render_width;
+        swapchainExtent.height = s_render_height;
+
+        swapchainExtent.width = max(swapchainExtent.width, surfCapabilities.minImageExtent.width);
+        swapchainExtent.width = min(swapchainExtent.width, surfCapabilities.maxImageExtent.width);
+
+        swapchainExtent.height = max(swapchainExtent.height, surfCapabilities.minImageExtent.height);
+        swapchainExtent.height = min(swapchainExtent.height, surfCapabilities.maxImageExtent.height);
+    }
+    else
+    {
+        // If the surface size is defined, the swap chain size must match
+        swapchainExtent = surfCapabilities.currentExtent;
+        s_render_width = surfCapabilities.currentExtent.width;
+        s_render_height = surfCapabilities.currentExtent.height;
+    }
+
+    if (s_render_width == 0 || s_render_height == 0) {
+        // In the window minimized situation
+        return true;
+    }
+
+    uint32_t presentModeCount = 0;
+    res = vkGetPhysicalDeviceSurfacePresentModesKHR(s_currPhysicalDevice, s_surface, &presentModeCount, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetPhysicalDeviceSurfacePresentModesKHR for count failed: %d\n", res);
+        return false;
+    }
+    presentModeCount = min(presentModeCount, MAX_PRESENT_MODE_COUNT);
+
+    VkPresentModeKHR presentModes[MAX_PRESENT_MODE_COUNT] = { 0 };
+    res = vkGetPhysicalDeviceSurfacePresentModesKHR(s_currPhysicalDevice, s_surface, &presentModeCount, presentModes);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetPhysicalDeviceSurfacePresentModesKHR for content failed: %d\n", res);
+        return false;
+    }
+
+    // The FIFO present mode is guaranteed by the spec to be supported
+    // and to have no tearing.  It's a great default present mode to use,
+    // so it's the fallback when the requested present mode is not available.
+    const VkPresentModeKHR preferredPresentModes[] = {
+        s_preferredPresentMode,
+        VK_PRESENT_MODE_FIFO_KHR
+    };
+
+    //  There are times when you may wish to use another present mode.  The
+    //  following code shows how to select them, and the comments provide some
+    //  reasons you may wish to use them.
+    //
+    // It should be noted that Vulkan 1.0 doesn't provide a method for
+    // synchronizing rendering with the presentation engine's display.  There
+    // is a method provided for throttling rendering with the display, but
+    // there are some presentation engines for which this method will not work.
+    // If an application doesn't throttle its rendering, and if it renders much
+    // faster than the refresh rate of the display, this can waste power on
+    // mobile devices.  That is because power is being spent rendering images
+    // that may never be seen.
+
+    // VK_PRESENT_MODE_IMMEDIATE_KHR is for applications that don't care about
+    // tearing, or have some way of synchronizing their rendering with the
+    // display.
+    // VK_PRESENT_MODE_MAILBOX_KHR may be useful for applications that
+    // generally render a new presentable image every refresh cycle, but are
+    // occasionally early.  In this case, the application wants the new image
+    // to be displayed instead of the previously-queued-for-presentation image
+    // that has not yet been displayed.
+    // VK_PRESENT_MODE_FIFO_RELAXED_KHR is for applications that generally
+    // render a new presentable image every refresh cycle, but are occasionally
+    // late.  In this case (perhaps because of stuttering/latency concerns),
+    // the application wants the late image to be immediately displayed, even
+    // though that may mean some tearing.
+    VkPresentModeKHR swapchainPresentMode = VK_PRESENT_MODE_MAX_ENUM_KHR;
+
+    bool foundPreferredPresentMode = false;
+    for (size_t i = 0; i < sizeof(preferredPresentModes) / sizeof(preferredPresentModes[0]); ++i)
+    {
+        const VkPresentModeKHR currPreferredPresentMode = preferredPresentModes[i];
+        for (uint32_t j = 0; j < presentModeCount; ++j)
+        {
+            if (presentModes[j] == currPreferredPresentMode)
+            {
+                swapchainPresentMode = currPreferredPresentMode;
+                foundPreferredPresentMode = true;
+                break;
+            }
+        }
+        if (foundPreferredPresentMode) {
+            break;
+        }
+    }
+
+    if (!foundPreferredPresentMode)
+    {
+        puts("Preferred present mode is not found!");
+        return false;
+    }
+
+    VkSurfaceTransformFlagsKHR preTransform;
+    if ((surfCapabilities.supportedTransforms & VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR) != 0) {
+        preTransform = VK_SURFACE_TRANSFORM_IDENTITY_BIT_KHR;
+    }
+    else {
+        preTransform = surfCapabilities.currentTransform;
+    }
+
+    // Find a supported composite alpha mode - one of these is guaranteed to be set
+    VkCompositeAlphaFlagBitsKHR compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+    VkCompositeAlphaFlagBitsKHR compositeAlphaFlags[] = {
+        VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
+        VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR,
+        VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR,
+        VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR,
+    };
+    for (size_t i = 0; i < sizeof(compositeAlphaFlags) / sizeof(compositeAlphaFlags[0]); ++i)
+    {
+        if (surfCapabilities.supportedCompositeAlpha & compositeAlphaFlags[i]) {
+            compositeAlpha = compositeAlphaFlags[i];
+            break;
+        }
+    }
+
+    VkSwapchainKHR oldSwapchain = s_swapchain;
+    const uint32_t oldSwapchainImageCount = s_swapchainImageCount;
+
+    const VkSwapchainCreateInfoKHR swapchainCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+        .pNext = NULL,
+        .flags = 0,
+        .surface = s_surface,
+        .minImageCount = desiredNumOfSwapchainImages,
+        .imageFormat = s_surfaceFormat.format,
+        .imageColorSpace = s_surfaceFormat.colorSpace,
+        .imageExtent = swapchainExtent,
+        .imageArrayLayers = 1,
+        .imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+        .imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_specQueueFamilyIndex,
+        .preTransform = preTransform,
+        .compositeAlpha = compositeAlpha,
+        .presentMode = swapchainPresentMode,
+        .clipped = true,
+        .oldSwapchain = oldSwapchain
+    };
+    res = vkCreateSwapchainKHR(s_specDevice, &swapchainCreateInfo, s_pAllocator, &s_swapchain);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateSwapchainKHR failed: %d\n", res);
+        return false;
+    }
+
+    // If we just re-created an existing swapchain, we should destroy the old
+    // swapchain once the frames rendered into its images have completed.
+    // Note: destroying the swapchain also cleans up all its associated
+    // presentable images once the platform is done with them.
+    if (oldSwapchain != VK_NULL_HANDLE &&
+        !RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_SWAPCHAIN_KHR, (uint64_t)oldSwapchain, s_submittedFrameValue)) {
+        return false;
+    }
+
+    res = vkGetSwapchainImagesKHR(s_specDevice, s_swapchain, &s_swapchainImageCount, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetSwapchainImagesKHR for count failed: %d\n", res);
+        return false;
+    }
+    // The other per-image resources are created once, for the images of the first swapchain
+    if (oldSwapchain != VK_NULL_HANDLE && s_swapchainImageCount != oldSwapchainImageCount)
+    {
+        printf("The recreated swapchain has %u images instead of %u!\n", s_swapchainImageCount, oldSwapchainImageCount);
+        return false;
+    }
+
+    VkImage swapchainImages[MAX_SWAPCHAIN_IMAGE_COUNT];
+    res = vkGetSwapchainImagesKHR(s_specDevice, s_swapchain, &s_swapchainImageCount, swapchainImages);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkGetSwapchainImagesKHR for content faile: %d\n", res);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; i++)
+    {
+        const VkImageViewCreateInfo swapchainImageView = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .image = swapchainImages[i],
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = s_surfaceFormat.format,
+            .components =
+                {
+                    .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                    .a = VK_COMPONENT_SWIZZLE_IDENTITY,
+                },
+            .subresourceRange =
+                {.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .baseMipLevel = 0, .levelCount = 1, 
+                .baseArrayLayer = 0, .layerCount = 1}
+        };
+        res = vkCreateImageView(s_specDevice, &swapchainImageView, s_pAllocator, &s_swapchainImageResources[i].view);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateImageView for swapchain failed: %d\n", res);
+            return false;
+        }
+
+        s_swapchainImageResources[i].image = swapchainImages[i];
+    }
+
+    return true;
+}
+
+static bool CreateHeadlessRenderTargets(void)
+{
+    // There's no surface to present to, so the graphics queue also plays the role of the present queue.
+    s_graphicsQueueFamilyIndex = s_specQueueFamilyIndex;
+    s_presentQueueFamilyIndex = s_specQueueFamilyIndex;
+    vkGetDeviceQueue(s_specDevice, s_graphicsQueueFamilyIndex, 0, &s_graphicsQueue);
+    s_presentQueue = s_graphicsQueue;
+
+    s_surfaceFormat.format = VK_FORMAT_R8G8B8A8_UNORM;
+    s_surfaceFormat.colorSpace = VK_COLOR_SPACE_SRGB_NONLINEAR_KHR;
+
+    // One render target per frame in flight, so that the render target of the current frame is never in use by the GPU
+    s_swapchainImageCount = s_frameLag;
+
+    // With --export, the render targets live in memory of their own that is shared with the consumer process.
+    const bool isExported = s_exportSocketPath != NULL;
+    const VkExternalMemoryImageCreateInfo externalMemoryImageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_EXTERNAL_MEMORY_IMAGE_CREATE_INFO,
+        .pNext = NULL,
+        .handleTypes = s_exportMemoryHandleType
+    };
+    const VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = isExported ? &externalMemoryImageCreateInfo : NULL,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = s_surfaceFormat.format,
+        .extent = { s_render_width, s_render_height, 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = GetHeadlessRenderTargetUsage(),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        SwapchainImageResources* const imageResources = &s_swapchainImageResources[i];
+
+        VkResult res = vkCreateImage(s_specDevice, &imageCreateInfo, s_pAllocator, &imageResources->image);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateImage for headless render target @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        VkMemoryRequirements memoryRequirements = { 0 };
+        vkGetImageMemoryRequirements(s_specDevice, imageResources->image, &memoryRequirements);
+
+        // Importing a dedicated allocation only requires the consumer to create the same image
+        const VkMemoryDedicatedAllocateInfo dedicatedAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_DEDICATED_ALLOCATE_INFO,
+            .pNext = NULL,
+            .image = imageResources->image,
+            .buffer = VK_NULL_HANDLE
+        };
+        const VkExportMemoryAllocateInfo exportAllocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_EXPORT_MEMORY_ALLOCATE_INFO,
+            .pNext = &dedicatedAllocateInfo,
+            .handleTypes = s_exportMemoryHandleType
+        };
+        const DeviceMemoryRequest request = {
+            .pNext = isExported ? &exportAllocateInfo : NULL,
+            .size = memoryRequirements.size,
+            // The consumer imports every render target with the memory type of the first one
+            .memoryTypeBits = isExported && i > 0 ? 1U << s_exportMemoryTypeIndex : memoryRequirements.memoryTypeBits,
+            .requiredFlags = 0,
+            .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .category = DEVICE_MEMORY_CATEGORY_RENDER_TARGET
+        };
+        s_exportAllocationSizes[i] = memoryRequirements.size;
+        res = AllocateTrackedDeviceMemory(&s_memoryTracker, &request, &imageResources->image_memory, &s_exportMemoryTypeIndex);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateMemory for headless render target @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkBindImageMemory(s_specDevice, imageResources->image, imageResources->image_memory, 0);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBindImageMemory for headless render target @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        const VkImageViewCreateInfo imageViewCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .image = imageResources->image,
+            .viewType = VK_IMAGE_VIEW_TYPE_2D,
+            .format = s_surfaceFormat.format,
+            .components = {
+                .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+                .a = VK_COMPONENT_SWIZZLE_IDENTITY
+            },
+            .subresourceRange = {
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+                .baseMipLevel = 0,
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+        res = vkCreateImageView(s_specDevice, &imageViewCreateInfo, s_pAllocator, &imageResources->view);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateImageView for headless render target @%u failed: %d\n", i, res);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool CreateFencesAndSemaphores(void)
+{
+    // Create semaphores to synchronize acquiring presentable buffers before
+    // rendering and waiting for drawing to be complete before presenting
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+
+    // Create fences that we can use to throttle if we get too far
+    // ahead of the image presents
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_FENCE_CREATE_SIGNALED_BIT
+    };
+
+    for (uint32_t i = 0; i < s_frameLag; i++)
+    {
+        VkResult res = vkCreateFence(s_specDevice, &fenceCreateInfo, s_pAllocator, &s_presentFences[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateFence @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, s_pAllocator, &s_imageAcquiredSemaphores[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore for s_imageAcquiredSemaphores @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, s_pAllocator, &s_drawCompleteSemaphores[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore for s_drawCompleteSemaphores @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        if (IsSeperatePresentQueue())
+        {
+            res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, s_pAllocator, &s_imageOwnershipSemaphores[i]);
+            if (res != VK_SUCCESS)
+            {
+                printf("vkCreateSemaphore for s_imageOwnershipSemaphores @%u failed: %d\n", i, res);
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+static bool BuildPresentImageOwnershipTransition(uint32_t imageIndex)
+{
+    const VkCommandBufferBeginInfo cmd_buf_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    VkResult res = vkBeginCommandBuffer(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf, &cmd_buf_info);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer for present command @%u failed: %d\n", imageIndex, res);
+        return false;
+    }
+
+    VkImageMemoryBarrier image_ownership_barrier = { .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                                                    .pNext = NULL,
+                                                    .srcAccessMask = 0,
+                                                    .dstAccessMask = 0,
+                                                    .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                                    .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                                                    .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+                                                    .dstQueueFamilyIndex = s_presentQueueFamilyIndex,
+                                                    .image = s_swapchainImageResources[imageIndex].image,
+                                                    .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1} };
+    // Transfer the swapchain image ownership from graphics queue family to present queue family
+    vkCmdPipelineBarrier(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+        VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0, NULL, 1, &image_ownership_barrier);
+
+    res = vkEndCommandBuffer(s_swapchainImageResources[imageIndex].graphics_to_present_cmd_buf);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer failed in BuildPresentImageCommand: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateFrameCommandPools(void)
+{
+    // No pool is created with VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, since its command buffer is only ever reset
+    // together with the pool, which lets the driver recycle the command memory of the pool in bulk.
+    const VkCommandPoolCreateInfo cmdPoolInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex
+    };
+    for (uint32_t i = 0; i < s_frameLag; ++i)
+    {
+        VkResult res = vkCreateCommandPool(s_specDevice, &cmdPoolInfo, s_pAllocator, &s_frameCommandPools[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateCommandPool for frame @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = NULL,
+            .commandPool = s_frameCommandPools[i],
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+        res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, &s_frameCommandBuffers[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateCommandBuffers for frame @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        // One pool per worker that may record secondary command buffers of the frame
+        for (uint32_t j = 0; j < s_jobSystem.workerCount; ++j)
+        {
+            res = vkCreateCommandPool(s_specDevice, &cmdPoolInfo, s_pAllocator, &s_workerCommandPools[i][j].commandPool);
+            if (res != VK_SUCCESS)
+            {
+                printf("vkCreateCommandPool for worker %u of frame @%u failed: %d\n", j, i, res);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool CreateCommandBufferAndBeginCommand(void)
+{
+    const VkCommandPoolCreateInfo cmdPoolInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex
+    };
+
+    VkResult res = vkCreateCommandPool(s_specDevice, &cmdPoolInfo, s_pAllocator, &s_commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool failed: %d\n", res);
+        return false;
+    }
+
+    // Create the command buffer from the command pool
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = s_commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0]))
+    };
+
+    res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, s_commandBuffers);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers failed: %d\n", res);
+        return false;
+    }
+
+    if (s_recordCommandsPerFrame && !CreateFrameCommandPools()) {
+        return false;
+    }
+
+    // Create command buffers for swapchain images, unless the draw commands are recorded per frame
+    for (uint32_t i = 0; i < s_swapchainImageCount && !s_recordCommandsPerFrame; i++)
+    {
+        res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, &s_swapchainImageResources[i].cmd_buf);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateCommandBuffers for swapchain @%u failed: %d\n", i, res);
+            return false;
+        }
+    }
+
+    if (IsSeperatePresentQueue())
+    {
+        // The ownership transitions are recorded again for the images of a recreated swapchain
+        const VkCommandPoolCreateInfo present_cmd_pool_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = NULL,
+            .queueFamilyIndex = s_presentQueueFamilyIndex,
+            .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        };
+        res = vkCreateCommandPool(s_specDevice, &present_cmd_pool_info, s_pAllocator, &s_presentCommandPool);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateCommandPool failed: %d\n", res);
+            return false;
+        }
+        const VkCommandBufferAllocateInfo present_cmd_info = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .pNext = NULL,
+            .commandPool = s_presentCommandPool,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1,
+        };
+        for (uint32_t i = 0; i < s_swapchainImageCount; i++)
+        {
+            res = vkAllocateCommandBuffers(s_specDevice, &present_cmd_info, &s_swapchainImageResources[i].graphics_to_present_cmd_buf);
+            if (res != VK_SUCCESS)
+            {
+                printf("vkAllocateCommandBuffers for graphics to present failed: %d\n", res);
+                return false;
+            }
+
+            if (!BuildPresentImageOwnershipTransition(i)) {
+                return false;
+            }
+        }
+    }
+
+    const VkCommandBufferBeginInfo cmdBufBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    res = vkBeginCommandBuffer(s_commandBuffers[0], &cmdBufBeginInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateVertexAndUniformBuffersAndMemories(void)
+{    
+    // The vertex data is uploaded by s_uploadManager, so the host buffer only stages the uniform updates on the graphics queue.
+    const VkBufferCreateInfo hostUniformBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = sizeof(FlattenVertexUniform),
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
+    };
+    VkResult res = vkCreateBuffer(s_specDevice, &hostUniformBufferCreateInfo, s_pAllocator, &s_hostUniformBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for host uniform buffer failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements hostUniformMemoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(s_specDevice, s_hostUniformBuffer, &hostUniformMemoryRequirements);
+
+    const DeviceMemoryRequest hostUniformMemoryRequest = {
+        .pNext = NULL,
+        .size = hostUniformMemoryRequirements.size,
+        .memoryTypeBits = hostUniformMemoryRequirements.memoryTypeBits,
+        .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        .preferredFlags = 0,
+        .category = DEVICE_MEMORY_CATEGORY_UNIFORM
+    };
+    res = AllocateTrackedDeviceMemory(&s_memoryTracker, &hostUniformMemoryRequest, &s_hostUniformMemory, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for host uniform memory failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(s_specDevice, s_hostUniformBuffer, s_hostUniformMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory failed: %d\n", res);
+        return false;
+    }
+
+    const VkBufferCreateInfo deviceCoordsBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = sizeof(s_vertex_coords_data),
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
+    };
+
+    const VkBufferCreateInfo deviceColorBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = sizeof(s_vertex_color_data),
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
+    };
+
+    const VkBufferCreateInfo uniformBufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = sizeof(FlattenVertexUniform),
+        // The bindless set holds every buffer in one array of storage buffers
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT | (s_useBindless ? VK_BUFFER_USAGE_STORAGE_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) |
+                 (s_useDescriptorBuffer ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex
+    };
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        res = vkCreateBuffer(s_specDevice, &deviceCoordsBufferCreateInfo, s_pAllocator, &s_swapchainImageResources[i].coords_buffer);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateBuffer for vertex coords buffer @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkCreateBuffer(s_specDevice, &deviceColorBufferCreateInfo, s_pAllocator, &s_swapchainImageResources[i].color_buffer);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateBuffer for vertex color buffer @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        VkMemoryRequirements deviceVertexMemoryRequirements = { 0 };
+        vkGetBufferMemoryRequirements(s_specDevice, s_swapchainImageResources[i].coords_buffer, &deviceVertexMemoryRequirements);
+        const VkDeviceSize totalDeviceVertexBufferSize = deviceVertexMemoryRequirements.size * 2;
+
+        const DeviceMemoryRequest deviceVertexMemoryRequest = {
+            .pNext = NULL,
+            .size = totalDeviceVertexBufferSize,
+            .memoryTypeBits = deviceVertexMemoryRequirements.memoryTypeBits,
+            .requiredFlags = 0,
+            .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .category = DEVICE_MEMORY_CATEGORY_GEOMETRY
+        };
+        res = AllocateTrackedDeviceMemory(&s_memoryTracker, &deviceVertexMemoryRequest, &s_swapchainImageResources[i].vertex_memory, NULL);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateMemory for vertex buffer @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].coords_buffer, s_swapchainImageResources[i].vertex_memory, 0);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].color_buffer, s_swapchainImageResources[i].vertex_memory, sizeof(s_vertex_coords_data));
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkCreateBuffer(s_specDevice, &uniformBufferCreateInfo, s_pAllocator, &s_swapchainImageResources[i].uniform_buffer);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateBuffer for uniform buffer @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        vkGetBufferMemoryRequirements(s_specDevice, s_swapchainImageResources[i].uniform_buffer, &deviceVertexMemoryRequirements);
+
+        // The descriptor of the uniform buffer in s_descriptorBuffer is made from its device address.
+        const VkMemoryAllocateFlagsInfo deviceUniformMemAllocFlagsInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+            .pNext = NULL,
+            .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+            .deviceMask = 0
+        };
+        const DeviceMemoryRequest deviceUniformMemoryRequest = {
+            .pNext = s_useDescriptorBuffer ? &deviceUniformMemAllocFlagsInfo : NULL,
+            .size = deviceVertexMemoryRequirements.size,
+            .memoryTypeBits = deviceVertexMemoryRequirements.memoryTypeBits,
+            .requiredFlags = 0,
+            .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .category = DEVICE_MEMORY_CATEGORY_UNIFORM
+        };
+        res = AllocateTrackedDeviceMemory(&s_memoryTracker, &deviceUniformMemoryRequest, &s_swapchainImageResources[i].uniform_memory, NULL);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateMemory for uniform buffer @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        res = vkBindBufferMemory(s_specDevice, s_swapchainImageResources[i].uniform_buffer, s_swapchainImageResources[i].uniform_memory, 0);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBindBufferMemory for coords buffer %u failed: %d\n", i, res);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Creates s_uploadManager on the transfer queue if there is a separate one, so that the initial uploads execute
+// while the pipelines are being created. FlushInitCommand then acquires the uploaded resources on the graphics queue.
+static bool CreateStartupUploadManager(void)
+{
+    const bool isSeperateTransferQueue = IsSeperateTransferQueue();
+    if (isSeperateTransferQueue)
+    {
+        const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0
+        };
+        const VkResult res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, s_pAllocator, &s_uploadCompleteSemaphore);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore for s_uploadCompleteSemaphore failed: %d\n", res);
+            return false;
+        }
+    }
+
+    const UploadManagerCreateInfo createInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .pMemoryProperties = &s_deviceCapabilities.memoryProperties,
+        .queue = isSeperateTransferQueue ? s_transferQueue : s_graphicsQueue,
+        .queueFamilyIndex = isSeperateTransferQueue ? s_transferQueueFamilyIndex : s_graphicsQueueFamilyIndex,
+        .dstQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .stagingSize = UPLOAD_STAGING_SIZE,
+        .stagingAlignment = s_deviceCapabilities.properties.limits.optimalBufferCopyOffsetAlignment,
+        .pMemoryTracker = &s_memoryTracker,
+        .minStagingSize = MIN_UPLOAD_STAGING_SIZE
+    };
+    return CreateUploadManager(&createInfo, &s_uploadManager);
+}
+
+// Enqueues the vertex data of every swapchain image, which the upload manager merges into one copy command per buffer.
+static bool UploadVertexData(void)
+{
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        if (!EnqueueBufferUpload(&s_uploadManager, s_swapchainImageResources[i].coords_buffer, 0, s_vertex_coords_data, sizeof(s_vertex_coords_data),
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) ||
+            !EnqueueBufferUpload(&s_uploadManager, s_swapchainImageResources[i].color_buffer, 0, s_vertex_color_data, sizeof(s_vertex_color_data),
+                                 VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Submits the remaining initial uploads together with the barrier making all of them visible to the graphics queue.
+static bool SubmitStartupUploads(void)
+{
+    if (!SubmitUploads(&s_uploadManager, s_uploadCompleteSemaphore)) return false;
+
+    printf("Initial uploads: %.1f KB in %u batches with %u copy commands for %u regions\n",
+        (double)s_uploadManager.uploadedSize / 1024.0, s_uploadManager.submittedBatchCount,
+        s_uploadManager.copyCommandCount, s_uploadManager.regionCount);
+    return true;
+}
+
+// The transfer submission has completed once the init command buffer waiting for it has completed.
+static void DestroyTransferQueueUploadResources(void)
+{
+    if (s_uploadCompleteSemaphore != VK_NULL_HANDLE)
+    {
+        vkDestroySemaphore(s_specDevice, s_uploadCompleteSemaphore, s_pAllocator);
+        s_uploadCompleteSemaphore = VK_NULL_HANDLE;
+    }
+}
+
+static bool CreateDepthReource(void)
+{
+    const RenderTargetImageCreateInfo createInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .pMemoryTracker = &s_memoryTracker,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .width = s_render_width,
+        .height = s_render_height,
+        .format = (VkFormat)s_depth_format,
+        .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+        .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+        .category = DEVICE_MEMORY_CATEGORY_DEPTH
+    };
+    return CreateRenderTargetImage(&createInfo, &s_depthResource.image, &s_depthResource.device_memory, &s_depthResource.image_view);
+}
+
+// The global set of the bindless model: binding 0 is an array of storage buffers holding the uniform and transform buffers
+// of every swapchain image, binding 1 an array of combined image samplers. Both arrays are update-after-bind and partially bound,
+// so resources can be registered while command buffers using the set are pending, and the unused elements are never written.
+// The shaders receive the elements to read as push constants.
+static bool CreateBindlessDescriptorSetAndPipelineLayout(void)
+{
+    const VkDescriptorSetLayoutBinding layoutBindings[] = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = s_bindlessBufferCapacity,
+            // textured_bindless.frag reads u_minLod
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = s_bindlessTextureCapacity,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = NULL,
+        }
+    };
+    const VkDescriptorBindingFlags bindingFlags[] = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT,
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+    };
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .pNext = NULL,
+        .bindingCount = (uint32_t)(sizeof(bindingFlags) / sizeof(bindingFlags[0])),
+        .pBindingFlags = bindingFlags
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptor_layout = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &bindingFlagsCreateInfo,
+        .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        .bindingCount = (uint32_t)(sizeof(layoutBindings) / sizeof(layoutBindings[0])),
+        .pBindings = layoutBindings,
+    };
+
+    VkResult res = vkCreateDescriptorSetLayout(s_specDevice, &descriptor_layout, s_pAllocator, &s_descSetLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorSetLayout for the bindless set failed: %d\n", res);
+        return false;
+    }
+
+    const VkPushConstantRange pushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset = 0,
+        .size = sizeof(BindlessPushConstants)
+    };
+    const VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .setLayoutCount = 1,
+        .pSetLayouts = &s_descSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+
+    res = vkCreatePipelineLayout(s_specDevice, &pPipelineLayoutCreateInfo, s_pAllocator, &s_pipelineLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreatePipelineLayout for the bindless set failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateDescriptorSetAndPipelineLayout(void)
+{
+    if (s_useBindless) return CreateBindlessDescriptorSetAndPipelineLayout();
+
+    const bool isTextured = s_texturePath != NULL;
+    VkDescriptorSetLayoutBinding layoutBindings[3] = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = 1,
+            // textured.frag reads u_minLod
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT | (isTextured ? VK_SHADER_STAGE_FRAGMENT_BIT : 0),
+            .pImmutableSamplers = NULL,
+        }
+    };
+    uint32_t bindingCount = 1;
+    // The object transforms, only read by the instanced vertex shaders
+    if (s_useGpuAnimation)
+    {
+        layoutBindings[bindingCount++] = (VkDescriptorSetLayoutBinding){
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .pImmutableSamplers = NULL,
+        };
+    }
+    if (isTextured)
+    {
+        layoutBindings[bindingCount++] = (VkDescriptorSetLayoutBinding){
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = NULL,
+        };
+    }
+
+    const VkDescriptorSetLayoutCreateInfo descriptor_layout = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = s_useDescriptorBuffer ? VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0,
+        .bindingCount = bindingCount,
+        .pBindings = layoutBindings,
+    };
+
+    VkResult res = vkCreateDescriptorSetLayout(s_specDevice, &descriptor_layout, s_pAllocator, &s_descSetLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorSetLayout failed: %d\n", res);
+        return false;
+    }
+
+    const VkPipelineLayoutCreateInfo pPipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .setLayoutCount = 1,
+        .pSetLayouts = &s_descSetLayout,
+    };
+
+    res = vkCreatePipelineLayout(s_specDevice, &pPipelineLayoutCreateInfo, s_pAllocator, &s_pipelineLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreatePipelineLayout failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateRenderPass(void)
+{
+    // A headless render target is read back or converted to YUV after the render pass, instead of being presented
+    const VkPipelineStageFlags colorReadStages = (s_isHeadless ? VK_PIPELINE_STAGE_TRANSFER_BIT : 0) |
+                                                 (s_convertStreamOnGpu ? VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT : 0);
+    return CreateSceneRenderPass(s_specDevice, s_pAllocator, s_surfaceFormat.format, (VkFormat)s_depth_format,
+        s_isHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, colorReadStages, &s_render_pass);
+}
+
+static bool CreateShaderModule(const char* fileName, VkShaderModule* pShaderModule)
+{
+    FILE* fp = GeneralOpenFile(fileName);
+    if (fp == NULL)
+    {
+        printf("Shader file %s not found!\n", fileName);
+        return false;
+    }
+    fseek(fp, 0, SEEK_END);
+    size_t fileLen = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    uint32_t* codeBuffer = malloc(fileLen);
+    if (codeBuffer != NULL) {
+        fread(codeBuffer, 1, fileLen, fp);
+    }
+    fclose(fp);
+
+    const VkShaderModuleCreateInfo moduleCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .codeSize = fileLen,
+        .pCode = codeBuffer
+    };
+
+    VkResult res = vkCreateShaderModule(s_specDevice, &moduleCreateInfo, s_pAllocator, pShaderModule);
+    if (res != VK_SUCCESS) {
+        printf("vkCreateShaderModule failed: %d\n", res);
+    }
+
+    free(codeBuffer);
+
+    return res == VK_SUCCESS;
+}
+
+static bool CreateVertAndFragShaderModules(const char* vertSPVFilePath, const char* fragSPVFilePath,
+                                           VkShaderModule* pVertShaderModule, VkShaderModule* pFragShaderModule)
+{
+    if (!CreateShaderModule(vertSPVFilePath, pVertShaderModule)) return false;
+    if (!CreateShaderModule(fragSPVFilePath, pFragShaderModule))
+    {
+        vkDestroyShaderModule(s_specDevice, *pVertShaderModule, s_pAllocator);
+        *pVertShaderModule = VK_NULL_HANDLE;
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateGraphicsPipeline(const char* vertSPVFilePath, const char* fragSPVFilePath, int index)
+{
+    // The shader modules are local so that multiple pipelines can be created on different threads at the same time.
+    VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    if (!CreateVertAndFragShaderModules(vertSPVFilePath, fragSPVFilePath, &vertShaderModule, &fragShaderModule)) {
+        return false;
+    }
+
+    // A mesh interleaves all its attributes in one binding as described by its header.
+    const bool useMesh = s_meshFilePath != NULL;
+    const VkVertexInputBindingDescription meshInputBinding = {
+        .binding = 0,
+        .stride = s_meshHeader.vertexStride,
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+    };
+    VkVertexInputAttributeDescription meshInputAttributes[MAX_MESH_VERTEX_ATTRIBUTE_COUNT];
+    for (uint32_t i = 0; i < s_meshHeader.attributeCount; ++i)
+    {
+        meshInputAttributes[i] = (VkVertexInputAttributeDescription){
+            .location = s_meshHeader.attributes[i].location,
+            .binding = 0,
+            .format = (VkFormat)s_meshHeader.attributes[i].format,
+            .offset = s_meshHeader.attributes[i].offset
+        };
+    }
+
+    const VkPipelineVertexInputStateCreateInfo meshVertexInputStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .vertexBindingDescriptionCount = 1,
+        .pVertexBindingDescriptions = &meshInputBinding,
+        .vertexAttributeDescriptionCount = s_meshHeader.attributeCount,
+        .pVertexAttributeDescriptions = meshInputAttributes
+    };
+
+    const VkPipelineCacheCreateInfo pipelineCache = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .initialDataSize = 0,
+        .pInitialData = NULL
+    };
+
+    bool succeeded = false;
+    const VkResult res = vkCreatePipelineCache(s_specDevice, &pipelineCache, s_pAllocator, &s_pipelineCaches[index]);
+    if (res != VK_SUCCESS) {
+        printf("vkCreatePipelineCache failed: %d\n", res);
+    }
+    else
+    {
+        const ScenePipelineCreateInfo pipelineCreateInfo = {
+            .device = s_specDevice,
+            .pAllocator = s_pAllocator,
+            .pipelineCache = s_pipelineCaches[index],
+            .flags = s_useDescriptorBuffer ? VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT : 0,
+            .vertexShader = vertShaderModule,
+            .fragmentShader = fragShaderModule,
+            .pVertexInputState = useMesh ? &meshVertexInputStateCreateInfo : NULL,
+            .topology = useMesh ? (VkPrimitiveTopology)s_meshHeader.topology : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+            // Index 0 square rotates about the x-axis so that the back face should not be culled.
+            .cullMode = index == 0 ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT,
+            .layout = s_pipelineLayout,
+            .renderPass = s_render_pass
+        };
+        succeeded = CreateSceneGraphicsPipeline(&pipelineCreateInfo, &s_pipelines[index]);
+    }
+
+    // The shader modules are not needed any more once the pipeline has been created.
+    vkDestroyShaderModule(s_specDevice, vertShaderModule, s_pAllocator);
+    vkDestroyShaderModule(s_specDevice, fragShaderModule, s_pAllocator);
+
+    return succeeded;
+}
+
+static bool CreateFlattenPipeline(void)
+{
+    if (s_useBindless) {
+        return CreateGraphicsPipeline("flatten_bindless.vert.spv", "flatten.frag.spv", 0);
+    }
+    return CreateGraphicsPipeline(s_useGpuAnimation ? "flatten_instanced.vert.spv" : "flatten.vert.spv", "flatten.frag.spv", 0);
+}
+
+static bool CreateGradientPipeline(void)
+{
+    if (s_useBindless) {
+        return s_texturePath != NULL ? CreateGraphicsPipeline("textured_bindless.vert.spv", "textured_bindless.frag.spv", 1) :
+            CreateGraphicsPipeline("gradient_bindless.vert.spv", "gradient.frag.spv", 1);
+    }
+    if (s_texturePath != NULL) {
+        return CreateGraphicsPipeline(s_useGpuAnimation ? "textured_instanced.vert.spv" : "textured.vert.spv", "textured.frag.spv", 1);
+    }
+    return CreateGraphicsPipeline(s_useGpuAnimation ? "gradient_instanced.vert.spv" : "gradient.vert.spv", "gradient.frag.spv", 1);
+}
+
+// Rebuilds the graphics pipelines from the SPV files, as a shader hot reload would. The frames in flight still draw with the old
+// pipelines, so they are retired instead of waiting for the device to become idle. The draw commands MUST BE recorded per frame.
+static bool ReloadGraphicsPipelines(void)
+{
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        if (!RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_PIPELINE, (uint64_t)s_pipelines[i], s_submittedFrameValue)) return false;
+        s_pipelines[i] = VK_NULL_HANDLE;
+        // Only used while the pipeline is created
+        vkDestroyPipelineCache(s_specDevice, s_pipelineCaches[i], s_pAllocator);
+        s_pipelineCaches[i] = VK_NULL_HANDLE;
+    }
+    return CreateFlattenPipeline() && CreateGradientPipeline();
+}
+
+// Writes `buffer` into the next element of the buffer array of the bindless set and returns the element in `pIndex`.
+// The arrays are update-after-bind, so a buffer can be registered while command buffers using the set are pending.
+static bool RegisterBindlessBuffer(VkBuffer buffer, uint32_t* pIndex)
+{
+    if (s_bindlessBufferCount >= s_bindlessBufferCapacity)
+    {
+        printf("The bindless buffer array is full with %u buffers!\n", s_bindlessBufferCapacity);
+        return false;
+    }
+
+    const VkDescriptorBufferInfo bufferInfo = {
+        .buffer = buffer,
+        .offset = 0,
+        .range = VK_WHOLE_SIZE
+    };
+    const VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = NULL,
+        .dstSet = s_bindlessDescSet,
+        .dstBinding = 0,
+        .dstArrayElement = s_bindlessBufferCount,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+        .pImageInfo = NULL,
+        .pBufferInfo = &bufferInfo,
+        .pTexelBufferView = NULL
+    };
+    vkUpdateDescriptorSets(s_specDevice, 1, &write, 0, NULL);
+    *pIndex = s_bindlessBufferCount++;
+    return true;
+}
+
+// Like RegisterBindlessBuffer for the image array of the bindless set.
+static bool RegisterBindlessTexture(VkImageView imageView, VkSampler sampler, uint32_t* pIndex)
+{
+    if (s_bindlessTextureCount >= s_bindlessTextureCapacity)
+    {
+        printf("The bindless texture array is full with %u textures!\n", s_bindlessTextureCapacity);
+        return false;
+    }
+
+    const VkDescriptorImageInfo imageInfo = {
+        .sampler = sampler,
+        .imageView = imageView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+    const VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = NULL,
+        .dstSet = s_bindlessDescSet,
+        .dstBinding = 1,
+        .dstArrayElement = s_bindlessTextureCount,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &imageInfo,
+        .pBufferInfo = NULL,
+        .pTexelBufferView = NULL
+    };
+    vkUpdateDescriptorSets(s_specDevice, 1, &write, 0, NULL);
+    *pIndex = s_bindlessTextureCount++;
+    return true;
+}
+
+// Allocates the only set of the bindless model and registers the buffers of every swapchain image and the texture in it.
+static bool CreateBindlessDescriptorPoolAndSet(void)
+{
+    const VkDescriptorPoolSize poolSizes[] = {
+        {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = s_bindlessBufferCapacity,
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = s_bindlessTextureCapacity,
+        }
+    };
+    const VkDescriptorPoolCreateInfo descriptor_pool = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        // MUST BE set for the sets of a layout created with VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT
+        .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT,
+        .maxSets = 1,
+        .poolSizeCount = (uint32_t)(sizeof(poolSizes) / sizeof(poolSizes[0])),
+        .pPoolSizes = poolSizes,
+    };
+
+    VkResult res = vkCreateDescriptorPool(s_specDevice, &descriptor_pool, s_pAllocator, &s_descPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorPool for the bindless set failed: %d\n", res);
+        return false;
+    }
+
+    const VkDescriptorSetAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = s_descPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &s_descSetLayout
+    };
+    res = vkAllocateDescriptorSets(s_specDevice, &alloc_info, &s_bindlessDescSet);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateDescriptorSets for the bindless set failed: %d\n", res);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        SwapchainImageResources* pResources = &s_swapchainImageResources[i];
+        if (!RegisterBindlessBuffer(pResources->uniform_buffer, &pResources->bindless_uniform_index)) return false;
+        if (!RegisterBindlessBuffer(pResources->transform_buffer, &pResources->bindless_transform_index)) return false;
+    }
+    if (s_texturePath != NULL && !RegisterBindlessTexture(s_textureView, s_textureSampler, &s_bindlessTextureIndex)) return false;
+
+    return true;
+}
+
+// Creates a buffer bound to its own memory of a type having all of `requiredFlags`, and all of `preferredFlags` as well if the budget allows.
+// The buffer is shared concurrently if more than one queue family is specified.
+static bool CreateBufferWithMemory(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags requiredFlags, VkMemoryPropertyFlags preferredFlags,
+                                   DeviceMemoryCategory category, const uint32_t* pQueueFamilyIndices, uint32_t queueFamilyIndexCount,
+                                   VkBuffer* pBuffer, VkDeviceMemory* pMemory)
+{
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = size,
+        .usage = usage,
+        .sharingMode = queueFamilyIndexCount > 1 ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = queueFamilyIndexCount,
+        .pQueueFamilyIndices = pQueueFamilyIndices
+    };
+    VkResult res = vkCreateBuffer(s_specDevice, &bufferCreateInfo, s_pAllocator, pBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer in CreateBufferWithMemory failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(s_specDevice, *pBuffer, &memoryRequirements);
+
+    const VkMemoryAllocateFlagsInfo memAllocFlagsInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO,
+        .pNext = NULL,
+        .flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT,
+        .deviceMask = 0
+    };
+    const DeviceMemoryRequest request = {
+        // The device address of a buffer can only be queried if its memory is allocated with VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT.
+        .pNext = (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) != 0 ? &memAllocFlagsInfo : NULL,
+        .size = memoryRequirements.size,
+        .memoryTypeBits = memoryRequirements.memoryTypeBits,
+        .requiredFlags = requiredFlags,
+        .preferredFlags = preferredFlags,
+        .category = category
+    };
+    res = AllocateTrackedDeviceMemory(&s_memoryTracker, &request, pMemory, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory in CreateBufferWithMemory failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(s_specDevice, *pBuffer, *pMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory in CreateBufferWithMemory failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static inline VkDeviceAddress GetBufferDeviceAddress(VkBuffer buffer)
+{
+    const VkBufferDeviceAddressInfo addressInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO,
+        .pNext = NULL,
+        .buffer = buffer
+    };
+    return vkGetBufferDeviceAddress(s_specDevice, &addressInfo);
+}
+
+// Writes the descriptor of a uniform or storage buffer range to `pDescriptor` in a descriptor buffer.
+static void GetBufferDescriptor(VkDescriptorType type, VkDeviceAddress address, VkDeviceSize range, void* pDescriptor)
+{
+    const VkDescriptorAddressInfoEXT addressInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT,
+        .pNext = NULL,
+        .address = address,
+        .range = range,
+        .format = VK_FORMAT_UNDEFINED
+    };
+    const bool isUniformBuffer = type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+    const VkDescriptorGetInfoEXT getInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+        .pNext = NULL,
+        .type = type,
+        .data = isUniformBuffer ? (VkDescriptorDataEXT){ .pUniformBuffer = &addressInfo } : (VkDescriptorDataEXT){ .pStorageBuffer = &addressInfo }
+    };
+    s_vkGetDescriptorEXT(s_specDevice, &getInfo, isUniformBuffer ? s_deviceCapabilities.uniformBufferDescriptorSize :
+        s_deviceCapabilities.storageBufferDescriptorSize, pDescriptor);
+}
+
+// Writes the descriptors of the set of `imageIndex` into `pSetData` as laid out by s_descSetLayout.
+// Only host memory is written, so the sets of different images can be written on any threads at the same time.
+static void WriteImageDescriptors(uint32_t imageIndex, uint8_t* pSetData)
+{
+    const SwapchainImageResources* pResources = &s_swapchainImageResources[imageIndex];
+    GetBufferDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, GetBufferDeviceAddress(pResources->uniform_buffer), sizeof(FlattenVertexUniform),
+        pSetData + s_descriptorBindingOffsets[0]);
+    if (s_useGpuAnimation)
+    {
+        GetBufferDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, GetBufferDeviceAddress(pResources->transform_buffer),
+            (VkDeviceSize)s_objectCount * sizeof(ObjectTransform), pSetData + s_descriptorBindingOffsets[1]);
+    }
+    if (s_texturePath != NULL)
+    {
+        const VkDescriptorImageInfo imageInfo = {
+            .sampler = s_textureSampler,
+            .imageView = s_textureView,
+            .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+        };
+        const VkDescriptorGetInfoEXT getInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT,
+            .pNext = NULL,
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .data = { .pCombinedImageSampler = &imageInfo }
+        };
+        s_vkGetDescriptorEXT(s_specDevice, &getInfo, s_deviceCapabilities.combinedImageSamplerDescriptorSize,
+            pSetData + s_descriptorBindingOffsets[2]);
+    }
+}
+
+// Replaces the descriptor pool and sets: the set of every swapchain image is written into a host visible buffer,
+// which the draws bind by the offset of their set.
+static bool CreateDescriptorBufferAndWriteDescriptors(void)
+{
+    VkDeviceSize layoutSize = 0;
+    s_vkGetDescriptorSetLayoutSizeEXT(s_specDevice, s_descSetLayout, &layoutSize);
+    const VkDeviceSize alignment = s_deviceCapabilities.descriptorBufferOffsetAlignment > 0 ? s_deviceCapabilities.descriptorBufferOffsetAlignment : 1;
+    s_descriptorSetStride = (layoutSize + alignment - 1) / alignment * alignment;
+
+    // The bindings in the order of CreateDescriptorSetAndPipelineLayout
+    const bool isBindingUsed[] = { true, s_useGpuAnimation, s_texturePath != NULL };
+    for (uint32_t i = 0; i < sizeof(isBindingUsed) / sizeof(isBindingUsed[0]); ++i)
+    {
+        if (isBindingUsed[i]) {
+            s_vkGetDescriptorSetLayoutBindingOffsetEXT(s_specDevice, s_descSetLayout, i, &s_descriptorBindingOffsets[i]);
+        }
+    }
+
+    // Combined image samplers MUST BE in a buffer usable for both samplers and resources
+    s_descriptorBufferUsage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT |
+        (s_texturePath != NULL ? VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT : 0);
+    if (!CreateBufferWithMemory(s_descriptorSetStride * s_swapchainImageCount, s_descriptorBufferUsage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, DEVICE_MEMORY_CATEGORY_UNIFORM, &s_graphicsQueueFamilyIndex, 1,
+        &s_descriptorBuffer, &s_descriptorBufferMemory)) {
+        return false;
+    }
+    const VkResult res = vkMapMemory(s_specDevice, s_descriptorBufferMemory, 0, VK_WHOLE_SIZE, 0, (void**)&s_descriptorBufferData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for the descriptor buffer failed: %d\n", res);
+        return false;
+    }
+    s_descriptorBufferAddress = GetBufferDeviceAddress(s_descriptorBuffer);
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i) {
+        WriteImageDescriptors(i, s_descriptorBufferData + i * s_descriptorSetStride);
+    }
+    printf("Descriptor buffer: %u sets of %llu bytes\n", s_swapchainImageCount, (unsigned long long)s_descriptorSetStride);
+
+    return true;
+}
+
+static bool CreateDescriptorPoolAndSet(void)
+{
+    if (s_useBindless) return CreateBindlessDescriptorPoolAndSet();
+    if (s_useDescriptorBuffer) return CreateDescriptorBufferAndWriteDescriptors();
+
+    const VkDescriptorPoolSize poolSizes[] = {
+        {
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = s_swapchainImageCount,
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = s_swapchainImageCount,
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = s_swapchainImageCount,
+        }
+    };
+    // The storage buffer is only used by the GPU animation, and the combined image sampler only by the texture.
+    const bool isDescriptorTypeUsed[] = { true, s_useGpuAnimation, s_texturePath != NULL };
+    VkDescriptorPoolSize usedPoolSizes[sizeof(poolSizes) / sizeof(poolSizes[0])];
+    uint32_t descriptorTypeCount = 0;
+    for (uint32_t i = 0; i < sizeof(poolSizes) / sizeof(poolSizes[0]); ++i)
+    {
+        if (isDescriptorTypeUsed[i]) {
+            usedPoolSizes[descriptorTypeCount++] = poolSizes[i];
+        }
+    }
+    const VkDescriptorPoolCreateInfo descriptor_pool = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .maxSets = s_swapchainImageCount,
+        .poolSizeCount = descriptorTypeCount,
+        .pPoolSizes = usedPoolSizes,
+    };
+
+    VkResult res = vkCreateDescriptorPool(s_specDevice, &descriptor_pool, s_pAllocator, &s_descPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorPool failed: %d\n", res);
+        return false;
+    }
+
+    const VkDescriptorSetAllocateInfo alloc_info = { 
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = s_descPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &s_descSetLayout
+    };
+
+    VkDescriptorBufferInfo buffer_info = {
+        .buffer = VK_NULL_HANDLE,
+        .offset = 0,
+        .range = sizeof(FlattenVertexUniform)
+    };
+    VkDescriptorBufferInfo transform_info = {
+        .buffer = VK_NULL_HANDLE,
+        .offset = 0,
+        .range = VK_WHOLE_SIZE
+    };
+    const VkDescriptorImageInfo texture_info = {
+        .sampler = s_textureSampler,
+        .imageView = s_textureView,
+        .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    };
+
+    VkWriteDescriptorSet writes[] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &buffer_info,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &transform_info,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 2,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &texture_info,
+            .pBufferInfo = NULL,
+            .pTexelBufferView = NULL
+        }
+    };
+    // The writes are in the order of the pool sizes
+    VkWriteDescriptorSet usedWrites[sizeof(writes) / sizeof(writes[0])];
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        // There's no need to free `descriptor_set`, since VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT flag is not set
+        // in the member `flags` in `VkDescriptorPoolCreateInfo` object.
+        res = vkAllocateDescriptorSets(s_specDevice, &alloc_info, &s_swapchainImageResources[i].descriptor_set);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateDescriptorSets for @%u swapchain image failed: %d\n", i, res);
+            return false;
+        }
+
+        buffer_info.buffer = s_swapchainImageResources[i].uniform_buffer;
+        transform_info.buffer = s_swapchainImageResources[i].transform_buffer;
+        uint32_t writeCount = 0;
+        for (size_t writeIndex = 0; writeIndex < sizeof(writes) / sizeof(writes[0]); ++writeIndex)
+        {
+            if (!isDescriptorTypeUsed[writeIndex]) continue;
+            writes[writeIndex].dstSet = s_swapchainImageResources[i].descriptor_set;
+            usedWrites[writeCount++] = writes[writeIndex];
+        }
+        vkUpdateDescriptorSets(s_specDevice, writeCount, usedWrites, 0, NULL);
+    }
+
+    return true;
+}
+
+static bool CreateAnimationPipeline(void)
+{
+    const VkDescriptorSetLayoutBinding layoutBindings[] = {
+        // object states
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        // object transforms
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        // animation parameters
+        {
+            .binding = 2,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = NULL,
+        }
+    };
+
+    const VkDescriptorSetLayoutCreateInfo descriptorLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = (uint32_t)(sizeof(layoutBindings) / sizeof(layoutBindings[0])),
+        .pBindings = layoutBindings,
+    };
+
+    VkResult res = vkCreateDescriptorSetLayout(s_specDevice, &descriptorLayoutCreateInfo, s_pAllocator, &s_animationDescSetLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorSetLayout for animation failed: %d\n", res);
+        return false;
+    }
+
+    const VkPushConstantRange pushConstantRange = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(AnimationPushConstants)
+    };
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .setLayoutCount = 1,
+        .pSetLayouts = &s_animationDescSetLayout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    };
+
+    res = vkCreatePipelineLayout(s_specDevice, &pipelineLayoutCreateInfo, s_pAllocator, &s_animationPipelineLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreatePipelineLayout for animation failed: %d\n", res);
+        return false;
+    }
+
+    VkShaderModule compShaderModule = VK_NULL_HANDLE;
+    if (!CreateShaderModule("animate.comp.spv", &compShaderModule)) return false;
+
+    const VkComputePipelineCreateInfo pipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = compShaderModule,
+            .pName = "main",
+            .pSpecializationInfo = NULL
+        },
+        .layout = s_animationPipelineLayout,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0
+    };
+
+    res = vkCreateComputePipelines(s_specDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, s_pAllocator, &s_animationPipeline);
+    if (res != VK_SUCCESS) {
+        printf("vkCreateComputePipelines for animation failed: %d\n", res);
+    }
+
+    vkDestroyShaderModule(s_specDevice, compShaderModule, s_pAllocator);
+
+    return res == VK_SUCCESS;
+}
+
+// Device local memory is preferred, the buffer falls back to any other memory type rather than failing when it is out of budget.
+static inline bool CreateDeviceLocalBuffer(VkDeviceSize size, VkBufferUsageFlags usage, DeviceMemoryCategory category,
+                                           const uint32_t* pQueueFamilyIndices, uint32_t queueFamilyIndexCount, VkBuffer* pBuffer, VkDeviceMemory* pMemory)
+{
+    return CreateBufferWithMemory(size, usage, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category, pQueueFamilyIndices, queueFamilyIndexCount, pBuffer, pMemory);
+}
+
+// Falls back like CreateDeviceLocalBuffer
+static bool CreateDeviceLocalImage(const VkImageCreateInfo* pCreateInfo, DeviceMemoryCategory category, VkImage* pImage, VkDeviceMemory* pMemory)
+{
+    VkResult res = vkCreateImage(s_specDevice, pCreateInfo, s_pAllocator, pImage);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateImage in CreateDeviceLocalImage failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetImageMemoryRequirements(s_specDevice, *pImage, &memoryRequirements);
+
+    const DeviceMemoryRequest request = {
+        .pNext = NULL,
+        .size = memoryRequirements.size,
+        .memoryTypeBits = memoryRequirements.memoryTypeBits,
+        .requiredFlags = 0,
+        .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        .category = category
+    };
+    res = AllocateTrackedDeviceMemory(&s_memoryTracker, &request, pMemory, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory in CreateDeviceLocalImage failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindImageMemory(s_specDevice, *pImage, *pMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindImageMemory in CreateDeviceLocalImage failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+// A texture needs the transfer source usage only if its mip chain is generated with blits.
+static inline VkImageUsageFlags GetTextureImageUsage(bool generateMipmaps)
+{
+    return VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | (generateMipmaps ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0);
+}
+
+// Maps the mesh file set by --mesh and checks that the device and the vertex shaders can consume its layout.
+static bool OpenMeshFileForRendering(void)
+{
+    if (!OpenMeshFile(s_meshFilePath, &s_meshFile)) return false;
+    s_meshHeader = *s_meshFile.pHeader;
+
+    const VkPhysicalDeviceLimits* pLimits = &s_deviceCapabilities.properties.limits;
+    bool isValid = true;
+    // The vertex shaders read inPos at location 0 and inColor at location 1, other attributes are ignored.
+    bool hasPosition = false;
+    bool hasColor = false;
+    for (uint32_t i = 0; i < s_meshHeader.attributeCount; ++i)
+    {
+        const MeshVertexAttribute* pAttribute = &s_meshHeader.attributes[i];
+        VkFormatProperties formatProperties = { 0 };
+        vkGetPhysicalDeviceFormatProperties(s_currPhysicalDevice, (VkFormat)pAttribute->format, &formatProperties);
+        if ((formatProperties.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) == 0 ||
+            pAttribute->location >= pLimits->maxVertexInputAttributes || pAttribute->offset > pLimits->maxVertexInputAttributeOffset)
+        {
+            printf("Mesh vertex attribute %u (location %u, format %u) is not supported by the device!\n", i, pAttribute->location, pAttribute->format);
+            isValid = false;
+        }
+        hasPosition = hasPosition || pAttribute->location == 0;
+        hasColor = hasColor || pAttribute->location == 1;
+    }
+    if (!hasPosition || !hasColor)
+    {
+        puts("The mesh MUST have vertex attributes at location 0 (position) and 1 (color)!");
+        isValid = false;
+    }
+    if (s_meshHeader.vertexStride > pLimits->maxVertexInputBindingStride)
+    {
+        printf("The mesh vertex stride %u exceeds the device limit %u!\n", s_meshHeader.vertexStride, pLimits->maxVertexInputBindingStride);
+        isValid = false;
+    }
+    // Draw calls take 32-bit counts, and 32-bit index values are limited on devices without fullDrawIndexUint32.
+    if (s_meshHeader.vertexCount > UINT32_MAX || s_meshHeader.indexCount > UINT32_MAX ||
+        (s_meshHeader.indexSize == 4 && s_meshHeader.vertexCount - 1 > pLimits->maxDrawIndexedIndexValue))
+    {
+        puts("The mesh has more vertices or indices than a draw call of the device supports!");
+        isValid = false;
+    }
+
+    if (!isValid) {
+        CloseMeshFile(&s_meshFile);
+    }
+    return isValid;
+}
+
+// Enqueues the upload of `size` bytes of the mapped mesh file at `pSrcData` into `dstBuffer` one chunk at a time.
+static bool StreamMeshSection(const uint8_t* pSrcData, VkDeviceSize size, VkBuffer dstBuffer, VkAccessFlags dstAccessMask)
+{
+    const uint64_t fileOffset = (uint64_t)(pSrcData - (const uint8_t*)s_meshFile.mapping.pData);
+    for (VkDeviceSize offset = 0; offset < size; )
+    {
+        const VkDeviceSize chunkSize = min(size - offset, (VkDeviceSize)MESH_UPLOAD_CHUNK_SIZE);
+        if (!EnqueueBufferUpload(&s_uploadManager, dstBuffer, offset, pSrcData + offset, chunkSize, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, dstAccessMask)) {
+            return false;
+        }
+        // These pages of the file will not be read again, so they do not need to stay resident.
+        ReleasePlatformFileRange(&s_meshFile.mapping, fileOffset + offset, chunkSize);
+        offset += chunkSize;
+    }
+    return true;
+}
+
+// Uploads the vertex and index sections of the mapped mesh file into device local buffers.
+// The file is read straight from its mapping into the staging ring of s_uploadManager, which submits a batch whenever
+// its share of the ring is full, so no copy of the whole mesh is ever held in host memory.
+static bool StreamMeshToDevice(void)
+{
+    const uint64_t beginTime = GetCurrentTimeNanoseconds();
+
+    if (!CreateDeviceLocalBuffer(s_meshFile.vertexDataSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                 DEVICE_MEMORY_CATEGORY_GEOMETRY, &s_graphicsQueueFamilyIndex, 1, &s_meshVertexBuffer, &s_meshVertexMemory)) {
+        return false;
+    }
+    const bool isIndexed = s_meshFile.indexDataSize > 0;
+    if (isIndexed && !CreateDeviceLocalBuffer(s_meshFile.indexDataSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                                              DEVICE_MEMORY_CATEGORY_GEOMETRY, &s_graphicsQueueFamilyIndex, 1, &s_meshIndexBuffer, &s_meshIndexMemory)) {
+        return false;
+    }
+
+    const bool succeeded = StreamMeshSection(s_meshFile.pVertexData, s_meshFile.vertexDataSize, s_meshVertexBuffer, VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) &&
+                           (!isIndexed || StreamMeshSection(s_meshFile.pIndexData, s_meshFile.indexDataSize, s_meshIndexBuffer, VK_ACCESS_INDEX_READ_BIT));
+
+    // Everything needed later has been copied into s_meshHeader and the staging ring.
+    const uint64_t fileSize = s_meshFile.mapping.size;
+    CloseMeshFile(&s_meshFile);
+
+    if (succeeded)
+    {
+        printf("Mesh '%s' streamed: %llu vertices, %llu indices, %.1f MB through %.1f MB of staging memory (%.1f ms)\n",
+            s_meshFilePath, (unsigned long long)s_meshHeader.vertexCount, (unsigned long long)s_meshHeader.indexCount,
+            (double)fileSize / (1024.0 * 1024.0), (double)s_uploadManager.info.stagingSize / (1024.0 * 1024.0),
+            (double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000.0);
+    }
+    return succeeded;
+}
+
+// VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT only exists in the 64-bit format features.
+// If `requireOptimalDeviceAccess` is true, formats whose host transfer usage makes the device access slower are rejected too.
+static bool IsHostImageCopyFormat(VkFormat format, VkImageUsageFlags usage, bool requireOptimalDeviceAccess)
+{
+    if (!s_useHostImageCopy) return false;
+
+    VkFormatProperties3 formatProperties3 = {
+        .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_3,
+        .pNext = NULL
+    };
+    VkFormatProperties2 formatProperties2 = {
+        .sType = VK_STRUCTURE_TYPE_FORMAT_PROPERTIES_2,
+        .pNext = &formatProperties3
+    };
+    vkGetPhysicalDeviceFormatProperties2(s_currPhysicalDevice, format, &formatProperties2);
+    if ((formatProperties3.optimalTilingFeatures & VK_FORMAT_FEATURE_2_HOST_IMAGE_TRANSFER_BIT_EXT) == 0) return false;
+
+    VkHostImageCopyDevicePerformanceQueryEXT performanceQuery = {
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_COPY_DEVICE_PERFORMANCE_QUERY_EXT,
+        .pNext = NULL
+    };
+    VkImageFormatProperties2 imageFormatProperties2 = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_FORMAT_PROPERTIES_2,
+        .pNext = &performanceQuery
+    };
+    const VkPhysicalDeviceImageFormatInfo2 imageFormatInfo = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_IMAGE_FORMAT_INFO_2,
+        .pNext = NULL,
+        .format = format,
+        .type = VK_IMAGE_TYPE_2D,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = usage | VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT,
+        .flags = 0
+    };
+    if (vkGetPhysicalDeviceImageFormatProperties2(s_currPhysicalDevice, &imageFormatInfo, &imageFormatProperties2) != VK_SUCCESS) return false;
+
+    return !requireOptimalDeviceAccess || performanceQuery.optimalDeviceAccess != VK_FALSE;
+}
+
+// Host image copies can only write images in the layouts listed by the implementation.
+static bool IsHostImageCopyDstLayout(VkImageLayout layout)
+{
+    VkImageLayout dstLayouts[MAX_HOST_IMAGE_COPY_LAYOUT_COUNT];
+    VkPhysicalDeviceHostImageCopyPropertiesEXT hostImageCopyProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_HOST_IMAGE_COPY_PROPERTIES_EXT,
+        .pNext = NULL,
+        .copySrcLayoutCount = 0,
+        .pCopySrcLayouts = NULL,
+        .copyDstLayoutCount = MAX_HOST_IMAGE_COPY_LAYOUT_COUNT,
+        .pCopyDstLayouts = dstLayouts
+    };
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &hostImageCopyProperties
+    };
+    vkGetPhysicalDeviceProperties2(s_currPhysicalDevice, &properties2);
+
+    for (uint32_t i = 0; i < hostImageCopyProperties.copyDstLayoutCount; ++i)
+    {
+        if (dstLayouts[i] == layout) return true;
+    }
+    return false;
+}
+
+// Transitions mip levels [baseLevel, baseLevel + levelCount) of `image` on the host. The device MUST NOT access them meanwhile.
+static bool TransitionImageLayoutOnHost(VkImage image, uint32_t baseLevel, uint32_t levelCount, VkImageLayout oldLayout, VkImageLayout newLayout)
+{
+    const VkHostImageLayoutTransitionInfoEXT transition = {
+        .sType = VK_STRUCTURE_TYPE_HOST_IMAGE_LAYOUT_TRANSITION_INFO_EXT,
+        .pNext = NULL,
+        .image = image,
+        .oldLayout = oldLayout,
+        .newLayout = newLayout,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, baseLevel, levelCount, 0, 1 }
+    };
+    const VkResult res = s_vkTransitionImageLayoutEXT(s_specDevice, 1, &transition);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkTransitionImageLayoutEXT failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+// Writes `pLevel` into mip level `level` of `image`, which is in `layout`, straight from host memory.
+// The copy has completed when the call returns, and the next queue submission makes it visible to the device,
+// so no staging memory, copy command or barrier is involved.
+static bool CopyImageLevelFromHost(VkImage image, const TextureLevel* pLevel, uint32_t level, VkImageLayout layout)
+{
+    const VkMemoryToImageCopyEXT region = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_TO_IMAGE_COPY_EXT,
+        .pNext = NULL,
+        .pHostPointer = pLevel->pData,
+        .memoryRowLength = 0,
+        .memoryImageHeight = 0,
+        .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+        .imageOffset = { 0, 0, 0 },
+        .imageExtent = { pLevel->width, pLevel->height, 1 }
+    };
+    const VkCopyMemoryToImageInfoEXT copyInfo = {
+        .sType = VK_STRUCTURE_TYPE_COPY_MEMORY_TO_IMAGE_INFO_EXT,
+        .pNext = NULL,
+        .flags = 0,
+        .dstImage = image,
+        .dstImageLayout = layout,
+        .regionCount = 1,
+        .pRegions = &region
+    };
+    const VkResult res = s_vkCopyMemoryToImageEXT(s_specDevice, &copyInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCopyMemoryToImageEXT failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+// Enqueues the upload of `pLevel` into mip level `level` of `dstImage` in bands of block rows,
+// so a level larger than the share of one staging batch is still uploaded while the previous bands are copied.
+static bool EnqueueImageLevelUpload(UploadManager* pManager, VkImage dstImage, const TextureFormatInfo* pFormatInfo, const TextureLevel* pLevel,
+                                    uint32_t level, VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const uint64_t blockRowSize = GetTextureLevelSize(pFormatInfo, pLevel->width, 1);
+    const uint32_t blockRowCount = (pLevel->height + pFormatInfo->blockHeight - 1) / pFormatInfo->blockHeight;
+    const uint64_t maxBandSize = pManager->info.stagingSize / UPLOAD_BATCH_RING_SIZE;
+    const uint32_t bandRowCount = (uint32_t)max(maxBandSize / blockRowSize, 1);
+
+    for (uint32_t row = 0; row < blockRowCount; row += bandRowCount)
+    {
+        const uint32_t rowCount = min(bandRowCount, blockRowCount - row);
+        const uint32_t y = row * pFormatInfo->blockHeight;
+        // The extent of the last band is clipped to the level, blocks of compressed formats may cover texels beyond it.
+        const VkBufferImageCopy region = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .imageOffset = { 0, (int32_t)y, 0 },
+            .imageExtent = { pLevel->width, min(rowCount * pFormatInfo->blockHeight, pLevel->height - y), 1 }
+        };
+        if (!EnqueueImageUpload(pManager, dstImage, &region, pLevel->pData + row * blockRowSize, rowCount * blockRowSize,
+                                finalLayout, dstStageMask, dstAccessMask)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Maps the texture file set by --texture and decides how its mip chain is created and uploaded. A format the device cannot sample,
+// e.g. BC on most mobile GPUs or ETC2 on most desktop GPUs, drops the texture instead of failing the startup.
+static bool OpenTextureFileForRendering(void)
+{
+    if (!OpenTextureFile(s_texturePath, &s_textureFile)) return false;
+
+    VkFormatProperties formatProperties = { 0 };
+    vkGetPhysicalDeviceFormatProperties(s_currPhysicalDevice, s_textureFile.format, &formatProperties);
+    const VkFormatFeatureFlags features = formatProperties.optimalTilingFeatures;
+    const VkFormatFeatureFlags sampledFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+    const uint32_t maxDimension = s_deviceCapabilities.properties.limits.maxImageDimension2D;
+    if ((features & sampledFeatures) != sampledFeatures || s_textureFile.width > maxDimension || s_textureFile.height > maxDimension)
+    {
+        printf("The device cannot sample the %ux%u texture of format %d, so the objects are not textured.\n",
+            s_textureFile.width, s_textureFile.height, s_textureFile.format);
+        CloseTextureFile(&s_textureFile);
+        s_texturePath = NULL;
+        return true;
+    }
+
+    // A file storing only the base level gets the rest of the mip chain generated with blits, which compressed formats never support.
+    const VkFormatFeatureFlags blitFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    s_textureLevelCount = s_textureFile.levelCount;
+    if (s_textureFile.levelCount == 1 && (features & blitFeatures) == blitFeatures)
+    {
+        for (uint32_t size = max(s_textureFile.width, s_textureFile.height); size > 1; size /= 2) {
+            ++s_textureLevelCount;
+        }
+    }
+
+    // The mip generation reads the base level in the transfer source layout, so the host MUST BE able to write it in that layout.
+    const bool generateMipmaps = s_textureLevelCount > s_textureFile.levelCount;
+    s_textureUsesHostImageCopy = IsHostImageCopyFormat(s_textureFile.format, GetTextureImageUsage(generateMipmaps), true) &&
+        IsHostImageCopyDstLayout(generateMipmaps ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    return true;
+}
+
+static bool CreateTextureImageAndSampler(bool generateMipmaps)
+{
+    const VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = s_textureFile.format,
+        .extent = { s_textureFile.width, s_textureFile.height, 1 },
+        .mipLevels = s_textureLevelCount,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = GetTextureImageUsage(generateMipmaps) | (s_textureUsesHostImageCopy ? VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : 0),
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    // Memory for the whole mip chain is allocated up front, streaming only decides when the levels are filled.
+    if (!CreateDeviceLocalImage(&imageCreateInfo, DEVICE_MEMORY_CATEGORY_TEXTURE, &s_textureImage, &s_textureMemory)) return false;
+
+    const VkImageViewCreateInfo imageViewCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .image = s_textureImage,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = s_textureFile.format,
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY
+        },
+        .subresourceRange = {
+            .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+            .baseMipLevel = 0,
+            .levelCount = s_textureLevelCount,
+            .baseArrayLayer = 0,
+            .layerCount = 1
+        }
+    };
+    VkResult res = vkCreateImageView(s_specDevice, &imageViewCreateInfo, s_pAllocator, &s_textureView);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateImageView for texture failed: %d\n", res);
+        return false;
+    }
+
+    // Levels that are not resident yet are excluded by u_minLod in the shader rather than by the sampler, which cannot change.
+    const VkSamplerCreateInfo samplerCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .magFilter = VK_FILTER_LINEAR,
+        .minFilter = VK_FILTER_LINEAR,
+        .mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT,
+        .mipLodBias = 0.0f,
+        .anisotropyEnable = VK_FALSE,
+        .maxAnisotropy = 1.0f,
+        .compareEnable = VK_FALSE,
+        .compareOp = VK_COMPARE_OP_NEVER,
+        .minLod = 0.0f,
+        .maxLod = VK_LOD_CLAMP_NONE,
+        .borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
+        .unnormalizedCoordinates = VK_FALSE
+    };
+    res = vkCreateSampler(s_specDevice, &samplerCreateInfo, s_pAllocator, &s_textureSampler);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateSampler for texture failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+// Enqueues the upload of mip level `level` of the texture file into the staging ring of s_textureUploadManager.
+static bool EnqueueTextureLevel(uint32_t level, VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const TextureLevel* pLevel = &s_textureFile.levels[level];
+    if (!EnqueueImageLevelUpload(&s_textureUploadManager, s_textureImage, &s_textureFile.formatInfo, pLevel, level, finalLayout, dstStageMask, dstAccessMask)) {
+        return false;
+    }
+    // These pages of the file will not be read again, so they do not need to stay resident.
+    ReleasePlatformFileRange(&s_textureFile.mapping, (uint64_t)(pLevel->pData - (const uint8_t*)s_textureFile.mapping.pData), pLevel->size);
+    s_textureUploadedSize += pLevel->size;
+    return true;
+}
+
+// Writes mip level `level` of the texture file straight from its mapping with a host image copy.
+static bool CopyTextureLevelFromHost(uint32_t level, VkImageLayout layout)
+{
+    const TextureLevel* pLevel = &s_textureFile.levels[level];
+    if (!CopyImageLevelFromHost(s_textureImage, pLevel, level, layout)) return false;
+    ReleasePlatformFileRange(&s_textureFile.mapping, (uint64_t)(pLevel->pData - (const uint8_t*)s_textureFile.mapping.pData), pLevel->size);
+    s_textureUploadedSize += pLevel->size;
+    return true;
+}
+
+// Generates levels 1 and finer of the texture from the uploaded base level, each one blitted from the previous one.
+// Level 0 MUST BE in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, all levels end in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL.
+static void RecordTextureMipmapGeneration(VkCommandBuffer cmdBuf)
+{
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = 0,
+        .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+        .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = s_textureImage,
+        .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 1, s_textureLevelCount - 1, 0, 1 }
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+
+    for (uint32_t level = 1; level < s_textureLevelCount; ++level)
+    {
+        const VkImageBlit blit = {
+            .srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1 },
+            .srcOffsets = { { 0, 0, 0 }, { (int32_t)max(s_textureFile.width >> (level - 1), 1), (int32_t)max(s_textureFile.height >> (level - 1), 1), 1 } },
+            .dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1 },
+            .dstOffsets = { { 0, 0, 0 }, { (int32_t)max(s_textureFile.width >> level, 1), (int32_t)max(s_textureFile.height >> level, 1), 1 } }
+        };
+        vkCmdBlitImage(cmdBuf, s_textureImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, s_textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       1, &blit, VK_FILTER_LINEAR);
+
+        // The next level is blitted from this one
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.subresourceRange.baseMipLevel = level;
+        barrier.subresourceRange.levelCount = 1;
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+    }
+
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = s_textureLevelCount;
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, NULL, 0, NULL, 1, &barrier);
+}
+
+// Creates the texture and makes its coarsest levels resident before the first frame.
+// A file storing only the base level gets its mip chain generated in the init command buffer. Otherwise the smallest levels
+// are uploaded up to TEXTURE_INITIAL_UPLOAD_SIZE, and StreamTextureLevels uploads the finer ones while frames are rendered.
+// The levels are written with host image copies if possible, otherwise through a staging ring on the graphics queue.
+// Drops the finest levels stored in the texture file while the image would not fit within the budget of the device local memory,
+// so the texture is blurrier rather than pushing the other resources out of the budget. A generated mip chain is left alone,
+// since its base level is all the file has.
+static void DropTextureLevelsOverBudget(void)
+{
+    if (s_textureLevelCount > s_textureFile.levelCount) return;
+
+    // The image takes about the size of its levels
+    uint64_t imageSize = 0;
+    for (uint32_t i = 0; i < s_textureFile.levelCount; ++i) {
+        imageSize += s_textureFile.levels[i].size;
+    }
+    const VkDeviceSize headroom = GetDeviceMemoryHeadroom(&s_memoryTracker, UINT32_MAX, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+    uint32_t droppedLevelCount = 0;
+    uint64_t droppedSize = 0;
+    // The smallest level is kept in any case
+    while (droppedLevelCount + 1 < s_textureFile.levelCount && imageSize - droppedSize > headroom)
+    {
+        const TextureLevel* pLevel = &s_textureFile.levels[droppedLevelCount++];
+        // Never read
+        ReleasePlatformFileRange(&s_textureFile.mapping, (uint64_t)(pLevel->pData - (const uint8_t*)s_textureFile.mapping.pData), pLevel->size);
+        droppedSize += pLevel->size;
+    }
+    if (droppedLevelCount == 0) return;
+
+    s_textureFile.levelCount -= droppedLevelCount;
+    memmove(s_textureFile.levels, &s_textureFile.levels[droppedLevelCount], s_textureFile.levelCount * sizeof(TextureLevel));
+    s_textureFile.width = s_textureFile.levels[0].width;
+    s_textureFile.height = s_textureFile.levels[0].height;
+    s_textureLevelCount = s_textureFile.levelCount;
+    printf("Dropped the %u finest texture levels over the memory budget\n", droppedLevelCount);
+    RecordDeviceMemoryDegradation(&s_memoryTracker, DEVICE_MEMORY_CATEGORY_TEXTURE, droppedSize);
+}
+
+static bool LoadTexture(void)
+{
+    s_textureLoadBeginTime = GetCurrentTimeNanoseconds();
+
+    DropTextureLevelsOverBudget();
+    const bool generateMipmaps = s_textureLevelCount > s_textureFile.levelCount;
+    if (!CreateTextureImageAndSampler(generateMipmaps)) return false;
+
+    if (!s_textureUsesHostImageCopy)
+    {
+        const UploadManagerCreateInfo createInfo = {
+            .device = s_specDevice,
+            .pAllocator = s_pAllocator,
+            .pMemoryProperties = &s_deviceCapabilities.memoryProperties,
+            .queue = s_graphicsQueue,
+            .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+            .dstQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+            .stagingSize = TEXTURE_STAGING_SIZE,
+            .stagingAlignment = s_deviceCapabilities.properties.limits.optimalBufferCopyOffsetAlignment,
+            .pMemoryTracker = &s_memoryTracker,
+            .minStagingSize = MIN_UPLOAD_STAGING_SIZE
+        };
+        if (!CreateUploadManager(&createInfo, &s_textureUploadManager)) return false;
+    }
+
+    if (generateMipmaps)
+    {
+        if (s_textureUsesHostImageCopy)
+        {
+            if (!TransitionImageLayoutOnHost(s_textureImage, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL) ||
+                !CopyTextureLevelFromHost(0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL)) {
+                return false;
+            }
+        }
+        else if (!EnqueueTextureLevel(0, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT) ||
+                 !SubmitUploads(&s_textureUploadManager, VK_NULL_HANDLE)) {
+            return false;
+        }
+        RecordTextureMipmapGeneration(s_commandBuffers[0]);
+        s_textureResidentLevel = 0;
+    }
+    else
+    {
+        // The descriptor covers the whole mip chain, so the levels still to be streamed are in the sampled layout too.
+        // u_minLod keeps their undefined contents from being sampled.
+        if (s_textureUsesHostImageCopy &&
+            !TransitionImageLayoutOnHost(s_textureImage, 0, s_textureLevelCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)) {
+            return false;
+        }
+
+        uint32_t level = s_textureLevelCount;
+        uint64_t uploadedSize = 0;
+        // At least the smallest level is resident before the first frame
+        while (level > 0 && (level == s_textureLevelCount || uploadedSize + s_textureFile.levels[level - 1].size <= TEXTURE_INITIAL_UPLOAD_SIZE))
+        {
+            --level;
+            const bool succeeded = s_textureUsesHostImageCopy ? CopyTextureLevelFromHost(level, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) :
+                EnqueueTextureLevel(level, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+            if (!succeeded) return false;
+            uploadedSize += s_textureFile.levels[level].size;
+        }
+        s_textureResidentLevel = level;
+
+        if (!s_textureUsesHostImageCopy)
+        {
+            if (!SubmitUploads(&s_textureUploadManager, VK_NULL_HANDLE)) return false;
+            if (level > 0)
+            {
+                const VkImageMemoryBarrier barrier = {
+                    .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                    .pNext = NULL,
+                    .srcAccessMask = 0,
+                    .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+                    .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+                    .newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                    .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+                    .image = s_textureImage,
+                    .subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, level, 0, 1 }
+                };
+                vkCmdPipelineBarrier(s_commandBuffers[0], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                     0, 0, NULL, 0, NULL, 1, &barrier);
+            }
+        }
+    }
+    s_textureStreamingLevel = s_textureResidentLevel;
+
+    printf("Texture '%s': %ux%u, format %d, %u levels (%u generated), %u resident at startup, uploaded with %s\n",
+        s_texturePath, s_textureFile.width, s_textureFile.height, s_textureFile.format, s_textureLevelCount,
+        s_textureLevelCount - s_textureFile.levelCount, s_textureLevelCount - s_textureResidentLevel,
+        s_textureUsesHostImageCopy ? "host image copies" : "staging copies");
+    return true;
+}
+
+// Called once per frame. Makes the next finer mip level resident and lowers u_minLod to it,
+// so the texture sharpens progressively without a frame ever waiting for an upload.
+// A host image copy has completed when it returns. A staging upload is submitted here, and its level only becomes
+// resident in a later frame, once its batches have completed.
+static bool StreamTextureLevels(void)
+{
+    if (s_textureFile.mapping.pData == NULL) return true;
+
+    if (s_textureUsesHostImageCopy)
+    {
+        if (s_textureResidentLevel > 0)
+        {
+            if (!CopyTextureLevelFromHost(s_textureResidentLevel - 1, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)) return false;
+            s_textureStreamingLevel = --s_textureResidentLevel;
+        }
+    }
+    else
+    {
+        RetireCompletedUploads(&s_textureUploadManager);
+        if (s_textureStreamingLevel < s_textureResidentLevel)
+        {
+            if (s_textureUploadManager.completedBatchCount < s_textureStreamingBatchCount) return true;
+            s_textureResidentLevel = s_textureStreamingLevel;
+        }
+        if (s_textureResidentLevel > 0)
+        {
+            s_textureStreamingLevel = s_textureResidentLevel - 1;
+            if (!EnqueueTextureLevel(s_textureStreamingLevel, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+                                     VK_ACCESS_SHADER_READ_BIT) ||
+                !SubmitUploads(&s_textureUploadManager, VK_NULL_HANDLE)) {
+                return false;
+            }
+            s_textureStreamingBatchCount = s_textureUploadManager.submittedBatchCount;
+            return true;
+        }
+    }
+
+    if (s_textureResidentLevel == 0)
+    {
+        printf("Texture fully resident: %.1f KB uploaded with %s (%.1f ms after the load began)\n",
+            (double)s_textureUploadedSize / 1024.0, s_textureUsesHostImageCopy ? "host image copies" : "staging copies",
+            (double)(GetCurrentTimeNanoseconds() - s_textureLoadBeginTime) / 1000000.0);
+        // Every upload has completed, so the staging memory and the file are not needed any more.
+        DestroyUploadManager(&s_textureUploadManager);
+        CloseTextureFile(&s_textureFile);
+    }
+    return true;
+}
+
+// Uploads a UPLOAD_BENCHMARK_IMAGE_SIZE x UPLOAD_BENCHMARK_IMAGE_SIZE RGBA8 image `iterationCount` times through each upload path
+// and summarizes the throughputs in MB/s. A sample spans from the first byte written until the device can use the image:
+// the staging path waits for its batches, the host image copy path only for the copy, since the next submission makes it visible.
+// The host image copy statistics are left empty if the device does not support it for the image.
+static bool BenchmarkImageUploads(uint32_t iterationCount, BenchStatistics* pStagingThroughput, BenchStatistics* pHostCopyThroughput)
+{
+    const VkFormat format = VK_FORMAT_R8G8B8A8_UNORM;
+    const VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    const bool useHostImageCopy = IsHostImageCopyFormat(format, usage, false) && IsHostImageCopyDstLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+
+    TextureFormatInfo formatInfo;
+    GetTextureFormatInfo(format, &formatInfo);
+    TextureLevel level = {
+        .pData = NULL,
+        .size = GetTextureLevelSize(&formatInfo, UPLOAD_BENCHMARK_IMAGE_SIZE, UPLOAD_BENCHMARK_IMAGE_SIZE),
+        .width = UPLOAD_BENCHMARK_IMAGE_SIZE,
+        .height = UPLOAD_BENCHMARK_IMAGE_SIZE
+    };
+    const double sizeInMB = (double)level.size / (1024.0 * 1024.0);
+
+    uint8_t* pData = malloc(level.size);
+    double* samples = calloc(iterationCount, sizeof(double));
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    UploadManager uploadManager = { 0 };
+    memset(pHostCopyThroughput, 0, sizeof(*pHostCopyThroughput));
+
+    bool succeeded = false;
+    do
+    {
+        if (pData == NULL || samples == NULL)
+        {
+            puts("Failed to allocate the upload benchmark buffers!");
+            break;
+        }
+        // Incompressible contents, so neither path benefits from zero pages
+        for (uint64_t i = 0; i < level.size; ++i) {
+            pData[i] = (uint8_t)((i * 2654435761U) >> 24);
+        }
+        level.pData = pData;
+
+        const VkImageCreateInfo imageCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .imageType = VK_IMAGE_TYPE_2D,
+            .format = format,
+            .extent = { UPLOAD_BENCHMARK_IMAGE_SIZE, UPLOAD_BENCHMARK_IMAGE_SIZE, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .tiling = VK_IMAGE_TILING_OPTIMAL,
+            .usage = usage | (useHostImageCopy ? VK_IMAGE_USAGE_HOST_TRANSFER_BIT_EXT : 0),
+            .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+            .queueFamilyIndexCount = 1,
+            .pQueueFamilyIndices = &s_graphicsQueueFamilyIndex,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+        };
+        if (!CreateDeviceLocalImage(&imageCreateInfo, DEVICE_MEMORY_CATEGORY_BENCHMARK, &image, &memory)) break;
+
+        const UploadManagerCreateInfo createInfo = {
+            .device = s_specDevice,
+            .pAllocator = s_pAllocator,
+            .pMemoryProperties = &s_deviceCapabilities.memoryProperties,
+            .queue = s_graphicsQueue,
+            .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+            .dstQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+            .stagingSize = UPLOAD_STAGING_SIZE,
+            .stagingAlignment = s_deviceCapabilities.properties.limits.optimalBufferCopyOffsetAlignment,
+            .pMemoryTracker = &s_memoryTracker,
+            // The throughput is measured with the full ring
+            .minStagingSize = UPLOAD_STAGING_SIZE
+        };
+        if (!CreateUploadManager(&createInfo, &uploadManager)) break;
+
+        uint32_t i;
+        for (i = 0; i < iterationCount; ++i)
+        {
+            const uint64_t beginTime = GetCurrentTimeNanoseconds();
+            if (!EnqueueImageLevelUpload(&uploadManager, image, &formatInfo, &level, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT) ||
+                !SubmitUploads(&uploadManager, VK_NULL_HANDLE)) {
+                break;
+            }
+            // The graphics queue is idle besides the benchmark
+            const VkResult res = vkQueueWaitIdle(s_graphicsQueue);
+            if (res != VK_SUCCESS)
+            {
+                printf("vkQueueWaitIdle for upload benchmark failed: %d\n", res);
+                break;
+            }
+            samples[i] = sizeInMB / ((double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000000.0);
+            RetireCompletedUploads(&uploadManager);
+        }
+        if (i != iterationCount) break;
+        ComputeBenchStatistics(samples, iterationCount, pStagingThroughput);
+
+        if (useHostImageCopy)
+        {
+            for (i = 0; i < iterationCount; ++i)
+            {
+                // The transition discards the previous contents, like the first batch of a staging upload does.
+                const uint64_t beginTime = GetCurrentTimeNanoseconds();
+                if (!TransitionImageLayoutOnHost(image, 0, 1, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) ||
+                    !CopyImageLevelFromHost(image, &level, 0, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL)) {
+                    break;
+                }
+                samples[i] = sizeInMB / ((double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000000.0);
+            }
+            if (i != iterationCount) break;
+            ComputeBenchStatistics(samples, iterationCount, pHostCopyThroughput);
+        }
+
+        printf("Upload benchmark of a %.1f MB image: staging %.1f MB/s", sizeInMB, pStagingThroughput->p50);
+        if (useHostImageCopy) {
+            printf(", host image copy %.1f MB/s (medians of %u uploads)\n", pHostCopyThroughput->p50, iterationCount);
+        }
+        else {
+            printf(" (median of %u uploads), host image copy not available\n", iterationCount);
+        }
+        succeeded = true;
+    }
+    while (false);
+
+    DestroyUploadManager(&uploadManager);
+    if (image != VK_NULL_HANDLE) {
+        vkDestroyImage(s_specDevice, image, s_pAllocator);
+    }
+    if (memory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, memory);
+    }
+    free(samples);
+    free(pData);
+    return succeeded;
+}
+
+// Returns a pseudo-random value in [0, 1) from a xorshift32 state, which MUST NOT be 0.
+static inline float NextBenchmarkRandom(uint32_t* pState)
+{
+    uint32_t x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return (float)(x >> 8) / 16777216.0f;
+}
+
+static void CullObjectBatch(void* pUserData, uint32_t first, uint32_t count, uint32_t workerIndex)
+{
+    (void)workerIndex;
+
+    const ParallelCullContext* pContext = pUserData;
+    pContext->pBatchVisibleCounts[first / CULL_PARALLEL_BATCH_SIZE] =
+        CullObjectRange(pContext->pStore, pContext->pFrustum, pContext->kernel, first, count, &pContext->pVisibleIndices[first]);
+}
+
+// Culls the store on all workers of s_jobSystem, with the same result as CullObjects. `batchVisibleCounts` MUST hold one count
+// per CULL_PARALLEL_BATCH_SIZE objects.
+static uint32_t CullObjectsInParallel(const ObjectStore* pStore, const Frustum* pFrustum, CullingKernel kernel, uint32_t* pVisibleIndices,
+                                      uint32_t batchVisibleCounts[])
+{
+    ParallelCullContext context = {
+        .pStore = pStore,
+        .pFrustum = pFrustum,
+        .kernel = kernel,
+        .pVisibleIndices = pVisibleIndices,
+        .pBatchVisibleCounts = batchVisibleCounts
+    };
+    RunParallelFor(&s_jobSystem, 0, pStore->count, CULL_PARALLEL_BATCH_SIZE, CullObjectBatch, &context);
+
+    // Moves the visible indices of every batch right after those of the previous batches, which never overtakes the batch offsets
+    uint32_t visibleCount = 0;
+    for (uint32_t first = 0; first < pStore->count; first += CULL_PARALLEL_BATCH_SIZE)
+    {
+        const uint32_t batchVisibleCount = batchVisibleCounts[first / CULL_PARALLEL_BATCH_SIZE];
+        memmove(&pVisibleIndices[visibleCount], &pVisibleIndices[first], batchVisibleCount * sizeof(uint32_t));
+        visibleCount += batchVisibleCount;
+    }
+    return visibleCount;
+}
+
+// Radius of the object geometry around its origin, written in the header of a mesh file.
+// A mesh whose positions are not 32-bit floats is given a radius that no frustum culls.
+static float GetObjectGeometryRadius(void)
+{
+    if (s_meshFilePath != NULL) {
+        return s_meshHeader.positionRadius >= 0.0f ? s_meshHeader.positionRadius : 1.0e6f;
+    }
+
+    float maxSquaredLength = 0.0f;
+    for (uint32_t v = 0; v < sizeof(s_vertex_coords_data) / (4 * sizeof(float)); ++v)
+    {
+        const float* pPosition = &s_vertex_coords_data[v * 4];
+        const float squaredLength = pPosition[0] * pPosition[0] + pPosition[1] * pPosition[1] + pPosition[2] * pPosition[2];
+        maxSquaredLength = squaredLength > maxSquaredLength ? squaredLength : maxSquaredLength;
+    }
+    return sqrtf(maxSquaredLength);
+}
+
+// The Hash of animate.comp.glsl
+static float HashAnimationSeed(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352dU;
+    x ^= x >> 15;
+    x *= 0x846ca68bU;
+    x ^= x >> 16;
+    return (float)(x >> 8) / 16777216.0f;
+}
+
+static void SetAnimatedObjectBounds(uint32_t index)
+{
+    const float position[3] = { s_animatedObjectStates[index].position[0], s_animatedObjectStates[index].position[1], s_objectEyeDepth };
+    // The objects rotate about the z-axis, within their radius
+    const float halfExtents[3] = { s_animatedObjectRadius, s_animatedObjectRadius, s_animatedObjectRadius };
+    SetObjectBounds(&s_sceneObjectStore, index, position, halfExtents);
+}
+
+// Places the objects as the reset dispatch of animate.comp.glsl does. Only the positions and the velocities are followed.
+static void ResetAnimatedObjects(void)
+{
+    for (uint32_t i = 0; i < s_objectCount; ++i)
+    {
+        const uint32_t seed = i * 6U;
+        ObjectState* pState = &s_animatedObjectStates[i];
+        pState->position[0] = HashAnimationSeed(seed) * 1.6f - 0.8f;
+        pState->position[1] = HashAnimationSeed(seed + 1U) * 1.6f - 0.8f;
+        pState->velocity[0] = HashAnimationSeed(seed + 2U) * 0.6f - 0.3f;
+        pState->velocity[1] = HashAnimationSeed(seed + 3U) * 0.6f - 0.3f;
+        SetAnimatedObjectBounds(i);
+    }
+}
+
+// Advances the objects [first, first + count) as animate.comp.glsl does with the time step at `pUserData`.
+static void AdvanceAnimatedObjectBatch(void* pUserData, uint32_t first, uint32_t count, uint32_t workerIndex)
+{
+    (void)workerIndex;
+
+    const float deltaTime = *(const float*)pUserData;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        ObjectState* pState = &s_animatedObjectStates[i];
+        for (uint32_t k = 0; k < 2; ++k)
+        {
+            pState->position[k] += pState->velocity[k] * deltaTime;
+            // Bounce off the edges of the view volume
+            if (fabsf(pState->position[k]) > s_animationBoundsHalfSize)
+            {
+                pState->position[k] = fmaxf(-s_animationBoundsHalfSize, fminf(pState->position[k], s_animationBoundsHalfSize));
+                pState->velocity[k] = -pState->velocity[k];
+            }
+        }
+        SetAnimatedObjectBounds(i);
+    }
+}
+
+// Follows an animation dispatch of `deltaTime` in s_sceneObjectStore, on all workers of s_jobSystem once the scene spans several batches.
+// MUST BE called on worker 0 of s_jobSystem.
+static void AdvanceAnimatedObjects(float deltaTime)
+{
+    if (s_jobSystem.workerCount > 1 && s_objectCount > CULL_PARALLEL_BATCH_SIZE) {
+        RunParallelFor(&s_jobSystem, 0, s_objectCount, CULL_PARALLEL_BATCH_SIZE, AdvanceAnimatedObjectBatch, &deltaTime);
+    }
+    else {
+        AdvanceAnimatedObjectBatch(&deltaTime, 0, s_objectCount, 0);
+    }
+}
+
+// Fills s_sceneObjectStore with the bounds of the objects in eye space. Without the GPU animation, all objects of a pipeline
+// are drawn at the same place. With it, the objects move on the device: the draws recorded per frame follow each object
+// with s_animatedObjectStates, the pre-recorded draws bound each by the square it bounces in.
+static bool CreateSceneObjectStore(void)
+{
+    // CreateObjectStore refuses an empty store, an empty scene gets one that is never filled.
+    if (!CreateObjectStore(s_objectCount > 0 ? s_objectCount : 1, &s_sceneObjectStore))
+    {
+        puts("Failed to allocate the scene object store!");
+        return false;
+    }
+    s_visibleObjectIndices = malloc((size_t)s_sceneObjectStore.paddedCapacity * sizeof(uint32_t));
+    s_cullBatchVisibleCounts = calloc(s_objectCount / CULL_PARALLEL_BATCH_SIZE + 1, sizeof(uint32_t));
+    if (s_visibleObjectIndices == NULL || s_cullBatchVisibleCounts == NULL)
+    {
+        puts("Failed to allocate the visible object indices!");
+        return false;
+    }
+
+    // The scale of animate.comp.glsl
+    const float scale = s_useGpuAnimation ? fminf(1.0f, 2.0f / sqrtf((float)s_objectCount)) : 1.0f;
+    const float radius = GetObjectGeometryRadius() * scale;
+    if (s_useGpuAnimation && s_recordCommandsPerFrame)
+    {
+        s_animatedObjectStates = calloc(s_objectCount, sizeof(ObjectState));
+        if (s_animatedObjectStates == NULL)
+        {
+            puts("Failed to allocate the animated object states!");
+            return false;
+        }
+        s_animatedObjectRadius = radius + s_animationDriftMargin;
+    }
+
+    const float bounceExtent = s_useGpuAnimation ? s_animationBoundsHalfSize : 0.0f;
+    // The rotation about the x-axis moves the geometry along y and z within its radius.
+    const float halfExtents[3] = { bounceExtent + radius, bounceExtent + radius, radius };
+    const uint32_t flattenObjectCount = s_objectCount / 2 + s_objectCount % 2;
+    for (uint32_t i = 0; i < s_objectCount; ++i)
+    {
+        const float* pOffset = s_staticObjectOffsets[i < flattenObjectCount ? 0 : 1];
+        const float position[3] = {
+            s_useGpuAnimation ? 0.0f : pOffset[0],
+            s_useGpuAnimation ? 0.0f : pOffset[1],
+            s_objectEyeDepth
+        };
+        AddObjectToStore(&s_sceneObjectStore, position, halfExtents);
+    }
+    if (s_animatedObjectStates != NULL) {
+        ResetAnimatedObjects();
+    }
+
+    ExtractFrustumPlanes(s_viewProjection, &s_viewFrustum);
+    s_sceneCullingKernel = GetBestCullingKernel();
+    return true;
+}
+
+// Culls s_sceneObjectStore into s_visibleObjectIndices, on all workers of s_jobSystem once the scene spans several batches.
+// MUST BE called on worker 0 of s_jobSystem.
+static void CullSceneObjects(void)
+{
+    s_visibleObjectCount = s_jobSystem.workerCount > 1 && s_sceneObjectStore.count > CULL_PARALLEL_BATCH_SIZE ?
+        CullObjectsInParallel(&s_sceneObjectStore, &s_viewFrustum, s_sceneCullingKernel, s_visibleObjectIndices, s_cullBatchVisibleCounts) :
+        CullObjects(&s_sceneObjectStore, &s_viewFrustum, s_sceneCullingKernel, s_visibleObjectIndices);
+}
+
+// Culls scenes of s_cullBenchmarkObjectCounts boxes against the frustum of a perspective camera at the scene center,
+// `iterationCount` times with every kernel supported by the CPU, and with the widest kernel on all workers of s_jobSystem.
+// Every pass MUST find the same visible objects as the scalar kernel.
+static bool BenchmarkFrustumCulling(uint32_t iterationCount, CullBenchmarkResult results[], uint32_t* pResultCount)
+{
+    // 60 degrees vertical field of view, square aspect ratio, looking down -Z from the origin
+    const float nearZ = 0.1f;
+    const float farZ = 2.0f * CULL_BENCHMARK_SCENE_EXTENT;
+    const float focalLength = 1.0f / tanf(3.14159265f / 6.0f);
+    const float viewProjection[16] = {
+        focalLength, 0.0f, 0.0f, 0.0f,
+        0.0f, focalLength, 0.0f, 0.0f,
+        0.0f, 0.0f, farZ / (nearZ - farZ), -1.0f,
+        0.0f, 0.0f, nearZ * farZ / (nearZ - farZ), 0.0f
+    };
+    Frustum frustum;
+    ExtractFrustumPlanes(viewProjection, &frustum);
+
+    const uint32_t maxObjectCount = s_cullBenchmarkObjectCounts[CULL_BENCHMARK_SIZE_COUNT - 1];
+    ObjectStore store = { 0 };
+    uint32_t* visibleIndices = NULL;
+    uint32_t* referenceIndices = NULL;
+    uint32_t* batchVisibleCounts = calloc(maxObjectCount / CULL_PARALLEL_BATCH_SIZE + 1, sizeof(uint32_t));
+    double* samples = calloc(iterationCount, sizeof(double));
+    uint32_t resultCount = 0;
+
+    bool succeeded = true;
+    for (uint32_t i = 0; i < CULL_BENCHMARK_SIZE_COUNT && succeeded; ++i)
+    {
+        const uint32_t objectCount = s_cullBenchmarkObjectCounts[i];
+        succeeded = samples != NULL && batchVisibleCounts != NULL && CreateObjectStore(objectCount, &store);
+        if (succeeded && visibleIndices == NULL)
+        {
+            // Large enough for every scene
+            visibleIndices = malloc((maxObjectCount + OBJECT_STORE_LANE_COUNT) * sizeof(uint32_t));
+            referenceIndices = malloc((maxObjectCount + OBJECT_STORE_LANE_COUNT) * sizeof(uint32_t));
+            succeeded = visibleIndices != NULL && referenceIndices != NULL;
+        }
+        if (!succeeded)
+        {
+            puts("Failed to allocate the culling benchmark scene!");
+            break;
+        }
+
+        uint32_t randomState = 0x9E3779B9U;
+        for (uint32_t j = 0; j < objectCount; ++j)
+        {
+            const float position[3] = {
+                (NextBenchmarkRandom(&randomState) * 2.0f - 1.0f) * CULL_BENCHMARK_SCENE_EXTENT,
+                (NextBenchmarkRandom(&randomState) * 2.0f - 1.0f) * CULL_BENCHMARK_SCENE_EXTENT,
+                (NextBenchmarkRandom(&randomState) * 2.0f - 1.0f) * CULL_BENCHMARK_SCENE_EXTENT
+            };
+            const float halfExtents[3] = {
+                0.5f + NextBenchmarkRandom(&randomState) * 1.5f,
+                0.5f + NextBenchmarkRandom(&randomState) * 1.5f,
+                0.5f + NextBenchmarkRandom(&randomState) * 1.5f
+            };
+            AddObjectToStore(&store, position, halfExtents);
+        }
+
+        const uint32_t referenceCount = CullObjects(&store, &frustum, CULLING_KERNEL_SCALAR, referenceIndices);
+        // Every supported kernel on one thread, then the widest one on all workers of the job system
+        for (uint32_t kernel = 0; kernel <= CULLING_KERNEL_COUNT; ++kernel)
+        {
+            const bool isParallel = kernel == CULLING_KERNEL_COUNT;
+            const CullingKernel cullingKernel = isParallel ? GetBestCullingKernel() : (CullingKernel)kernel;
+            if (!IsCullingKernelSupported(cullingKernel) || (isParallel && s_jobSystem.workerCount < 2)) continue;
+
+            uint32_t visibleCount = 0;
+            for (uint32_t j = 0; j < iterationCount; ++j)
+            {
+                const uint64_t beginTime = GetCurrentTimeNanoseconds();
+                visibleCount = isParallel ? CullObjectsInParallel(&store, &frustum, cullingKernel, visibleIndices, batchVisibleCounts) :
+                    CullObjects(&store, &frustum, cullingKernel, visibleIndices);
+                samples[j] = (double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000.0;
+            }
+            if (visibleCount != referenceCount || memcmp(visibleIndices, referenceIndices, visibleCount * sizeof(uint32_t)) != 0)
+            {
+                printf("The %s culling kernel%s disagrees with the scalar one: %u visible objects instead of %u!\n",
+                    GetCullingKernelName(cullingKernel), isParallel ? " on the job system" : "", visibleCount, referenceCount);
+                succeeded = false;
+                break;
+            }
+
+            CullBenchmarkResult* pResult = &results[resultCount++];
+            pResult->objectCount = objectCount;
+            pResult->kernel = cullingKernel;
+            pResult->workerCount = isParallel ? s_jobSystem.workerCount : 1;
+            pResult->visibleCount = visibleCount;
+            ComputeBenchStatistics(samples, iterationCount, &pResult->time);
+            printf("Culled %u objects with the %s kernel on %u thread(s): %u visible, %.3f ms (%.2f ns per object)\n", objectCount,
+                GetCullingKernelName(pResult->kernel), pResult->workerCount, visibleCount, pResult->time.p50,
+                pResult->time.p50 * 1000000.0 / objectCount);
+        }
+        DestroyObjectStore(&store);
+    }
+
+    free(samples);
+    free(batchVisibleCounts);
+    free(visibleIndices);
+    free(referenceIndices);
+    *pResultCount = resultCount;
+    return succeeded;
+}
+
+static void RunEmptyBenchmarkJob(void* pUserData, uint32_t workerIndex)
+{
+    (void)pUserData;
+    (void)workerIndex;
+}
+
+static void RunParentBenchmarkJob(void* pUserData, uint32_t workerIndex)
+{
+    // The children are counted by the counter of the parent, which is only decremented after they have all been submitted.
+    JobCounter* pCounter = pUserData;
+    for (uint32_t i = 0; i < JOB_BENCHMARK_CHILD_JOB_COUNT; ++i) {
+        SubmitJob(&s_jobSystem, workerIndex, RunEmptyBenchmarkJob, NULL, pCounter);
+    }
+}
+
+// Measures the scheduling overhead per job of s_jobSystem with empty jobs, `iterationCount` rounds per workload: jobs all submitted
+// from the main thread, which the other workers have to steal, and jobs submitted by other jobs on the workers running them.
+static bool BenchmarkJobSystem(uint32_t iterationCount, JobBenchmarkResult* pResult)
+{
+    double* flatSamples = calloc(iterationCount, sizeof(double));
+    double* nestedSamples = calloc(iterationCount, sizeof(double));
+    if (flatSamples == NULL || nestedSamples == NULL)
+    {
+        puts("Failed to allocate the job system benchmark samples!");
+        free(flatSamples);
+        free(nestedSamples);
+        return false;
+    }
+
+    uint64_t executedJobCount, initialStolenJobCount, stolenJobCount;
+    GetJobSystemStatistics(&s_jobSystem, &executedJobCount, &initialStolenJobCount);
+
+    for (uint32_t i = 0; i < iterationCount; ++i)
+    {
+        JobCounter counter = { 0 };
+        uint64_t beginTime = GetCurrentTimeNanoseconds();
+        for (uint32_t j = 0; j < JOB_BENCHMARK_FLAT_JOB_COUNT; ++j) {
+            SubmitJob(&s_jobSystem, 0, RunEmptyBenchmarkJob, NULL, &counter);
+        }
+        WaitForJobCounter(&s_jobSystem, 0, &counter);
+        flatSamples[i] = (double)(GetCurrentTimeNanoseconds() - beginTime) / JOB_BENCHMARK_FLAT_JOB_COUNT;
+
+        beginTime = GetCurrentTimeNanoseconds();
+        for (uint32_t j = 0; j < JOB_BENCHMARK_PARENT_JOB_COUNT; ++j) {
+            SubmitJob(&s_jobSystem, 0, RunParentBenchmarkJob, &counter, &counter);
+        }
+        WaitForJobCounter(&s_jobSystem, 0, &counter);
+        nestedSamples[i] = (double)(GetCurrentTimeNanoseconds() - beginTime) / (JOB_BENCHMARK_PARENT_JOB_COUNT * (JOB_BENCHMARK_CHILD_JOB_COUNT + 1));
+    }
+
+    GetJobSystemStatistics(&s_jobSystem, &executedJobCount, &stolenJobCount);
+    pResult->workerCount = s_jobSystem.workerCount;
+    pResult->stolenJobCount = stolenJobCount - initialStolenJobCount;
+    ComputeBenchStatistics(flatSamples, iterationCount, &pResult->flatJobTime);
+    ComputeBenchStatistics(nestedSamples, iterationCount, &pResult->nestedJobTime);
+    printf("Job system with %u workers: %.1f ns per flat job, %.1f ns per nested job, %llu jobs stolen\n", pResult->workerCount,
+        pResult->flatJobTime.p50, pResult->nestedJobTime.p50, (unsigned long long)pResult->stolenJobCount);
+
+    free(flatSamples);
+    free(nestedSamples);
+    return true;
+}
+
+// Animates all objects and writes their transforms into the transform buffer of `imageIndex`.
+// If `reset` is true, the objects are placed at their initial states instead.
+static void RecordAnimationDispatch(VkCommandBuffer cmdBuf, uint32_t imageIndex, bool reset)
+{
+    const AnimationPushConstants pushConstants = {
+        .objectCount = s_objectCount,
+        .reset = reset ? 1U : 0U
+    };
+
+    vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, s_animationPipeline);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_COMPUTE, s_animationPipelineLayout, 0, 1,
+        &s_swapchainImageResources[imageIndex].animation_descriptor_set, 0, NULL);
+    vkCmdPushConstants(cmdBuf, s_animationPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pushConstants), &pushConstants);
+    vkCmdDispatch(cmdBuf, (s_objectCount + ANIMATION_WORKGROUP_SIZE - 1) / ANIMATION_WORKGROUP_SIZE, 1, 1);
+}
+
+static bool BuildCommandForAnimation(uint32_t imageIndex)
+{
+    const VkCommandBuffer cmdBuf = s_swapchainImageResources[imageIndex].animation_cmd_buf;
+    const VkCommandBufferBeginInfo cmdBufBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT,
+        .pInheritanceInfo = NULL,
+    };
+    VkResult res = vkBeginCommandBuffer(cmdBuf, &cmdBufBeginInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer for animation @%u failed: %d\n", imageIndex, res);
+        return false;
+    }
+
+    // The states are updated in place, so the dispatch MUST wait for the dispatch of the previous frame on the same queue.
+    const VkBufferMemoryBarrier stateBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .buffer = s_objectStateBuffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+        0, NULL, 1, &stateBarrier, 0, NULL);
+
+    RecordAnimationDispatch(cmdBuf, imageIndex, false);
+
+    res = vkEndCommandBuffer(cmdBuf);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for animation @%u failed: %d\n", imageIndex, res);
+        return false;
+    }
+
+    return true;
+}
+
+// Creates the object state buffer, and a transform buffer, a descriptor set and a prerecorded command buffer for each swapchain image.
+static bool CreateAnimationResources(void)
+{
+    if (!IsSeperateComputeQueue())
+    {
+        s_computeQueueFamilyIndex = s_graphicsQueueFamilyIndex;
+        s_computeQueue = s_graphicsQueue;
+    }
+
+    // The states are reset on the graphics queue and the transforms are read there,
+    // so both are shared concurrently with the compute queue instead of transferring their ownership every frame.
+    const uint32_t queueFamilyIndices[] = { s_graphicsQueueFamilyIndex, s_computeQueueFamilyIndex };
+    const uint32_t queueFamilyIndexCount = IsSeperateComputeQueue() ? 2U : 1U;
+
+    if (!CreateDeviceLocalBuffer((VkDeviceSize)s_objectCount * sizeof(ObjectState), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, DEVICE_MEMORY_CATEGORY_GEOMETRY,
+        queueFamilyIndices, queueFamilyIndexCount, &s_objectStateBuffer, &s_objectStateMemory)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        if (!CreateDeviceLocalBuffer((VkDeviceSize)s_objectCount * sizeof(ObjectTransform),
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | (s_useDescriptorBuffer ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0), DEVICE_MEMORY_CATEGORY_GEOMETRY,
+            queueFamilyIndices, queueFamilyIndexCount, &s_swapchainImageResources[i].transform_buffer, &s_swapchainImageResources[i].transform_memory)) {
+            return false;
+        }
+
+        // Only read on the compute queue
+        SwapchainImageResources* pResources = &s_swapchainImageResources[i];
+        if (!CreateBufferWithMemory(sizeof(AnimationParameters), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, DEVICE_MEMORY_CATEGORY_UNIFORM,
+            &s_computeQueueFamilyIndex, 1, &pResources->animation_params_buffer, &pResources->animation_params_memory)) {
+            return false;
+        }
+        const VkResult mapResult = vkMapMemory(s_specDevice, pResources->animation_params_memory, 0, VK_WHOLE_SIZE, 0,
+            (void**)&pResources->pAnimationParams);
+        if (mapResult != VK_SUCCESS)
+        {
+            printf("vkMapMemory for animation parameters @%u failed: %d\n", i, mapResult);
+            return false;
+        }
+        pResources->pAnimationParams->deltaTime = s_nominalAnimationTimeStep;
+    }
+
+    const VkDescriptorPoolSize poolSizes[] = {
+        { .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = s_swapchainImageCount * 2 },
+        { .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = s_swapchainImageCount }
+    };
+    const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .maxSets = s_swapchainImageCount,
+        .poolSizeCount = (uint32_t)(sizeof(poolSizes) / sizeof(poolSizes[0])),
+        .pPoolSizes = poolSizes,
+    };
+    VkResult res = vkCreateDescriptorPool(s_specDevice, &descriptorPoolCreateInfo, s_pAllocator, &s_animationDescPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorPool for animation failed: %d\n", res);
+        return false;
+    }
+
+    const VkDescriptorSetAllocateInfo descSetAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = s_animationDescPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &s_animationDescSetLayout
+    };
+    const VkDescriptorBufferInfo stateInfo = { .buffer = s_objectStateBuffer, .offset = 0, .range = VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo transformInfo = { .buffer = VK_NULL_HANDLE, .offset = 0, .range = VK_WHOLE_SIZE };
+    VkDescriptorBufferInfo paramsInfo = { .buffer = VK_NULL_HANDLE, .offset = 0, .range = VK_WHOLE_SIZE };
+    VkWriteDescriptorSet writes[] = {
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &stateInfo,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 1,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &transformInfo,
+            .pTexelBufferView = NULL
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .pNext = NULL,
+            .dstSet = VK_NULL_HANDLE,
+            .dstBinding = 2,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pImageInfo = NULL,
+            .pBufferInfo = &paramsInfo,
+            .pTexelBufferView = NULL
+        }
+    };
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        res = vkAllocateDescriptorSets(s_specDevice, &descSetAllocInfo, &s_swapchainImageResources[i].animation_descriptor_set);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateDescriptorSets for animation @%u failed: %d\n", i, res);
+            return false;
+        }
+
+        transformInfo.buffer = s_swapchainImageResources[i].transform_buffer;
+        paramsInfo.buffer = s_swapchainImageResources[i].animation_params_buffer;
+        for (size_t writeIndex = 0; writeIndex < sizeof(writes) / sizeof(writes[0]); ++writeIndex) {
+            writes[writeIndex].dstSet = s_swapchainImageResources[i].animation_descriptor_set;
+        }
+        vkUpdateDescriptorSets(s_specDevice, (uint32_t)(sizeof(writes) / sizeof(writes[0])), writes, 0, NULL);
+    }
+
+    // A command pool of its own, so the animation commands are recorded without synchronizing with `s_commandPool`.
+    const VkCommandPoolCreateInfo cmdPoolInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queueFamilyIndex = s_computeQueueFamilyIndex
+    };
+    res = vkCreateCommandPool(s_specDevice, &cmdPoolInfo, s_pAllocator, &s_computeCommandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool for animation failed: %d\n", res);
+        return false;
+    }
+
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = s_computeCommandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, &s_swapchainImageResources[i].animation_cmd_buf);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkAllocateCommandBuffers for animation @%u failed: %d\n", i, res);
+            return false;
+        }
+        if (!BuildCommandForAnimation(i)) return false;
+    }
+
+    const VkSemaphoreCreateInfo semaphoreCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+    };
+    for (uint32_t i = 0; i < s_frameLag; ++i)
+    {
+        res = vkCreateSemaphore(s_specDevice, &semaphoreCreateInfo, s_pAllocator, &s_animationCompleteSemaphores[i]);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateSemaphore for s_animationCompleteSemaphores @%u failed: %d\n", i, res);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool CreateFramebuffers(void)
+{
+    VkImageView attachments[] = { VK_NULL_HANDLE, s_depthResource.image_view };
+
+    const VkFramebufferCreateInfo framebufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .renderPass = s_render_pass,
+        .attachmentCount = (uint32_t)(sizeof(attachments) / sizeof(attachments[0])),
+        .pAttachments = attachments,
+        .width = s_render_width,
+        .height = s_render_height,
+        .layers = 1
+    };
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        attachments[0] = s_swapchainImageResources[i].view;
+        VkResult res = vkCreateFramebuffer(s_specDevice, &framebufferCreateInfo, s_pAllocator, &s_swapchainImageResources[i].framebuffer);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateFramebuffer @%u failed: %d\n", i, res);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool CreateTimestampQueryPool(void)
+{
+    if (s_timestampValidBits == 0)
+    {
+        puts("The graphics queue does not support timestamps, so GPU frame time will not be measured.");
+        return true;
+    }
+
+    const VkQueryPoolCreateInfo queryPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .queryType = VK_QUERY_TYPE_TIMESTAMP,
+        .queryCount = s_swapchainImageCount * 2,
+        .pipelineStatistics = 0
+    };
+    VkResult res = vkCreateQueryPool(s_specDevice, &queryPoolCreateInfo, s_pAllocator, &s_timestampQueryPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateQueryPool for timestamps failed: %d\n", res);
+        return false;
+    }
+
+    // Reset all queries in the init command buffer,
+    // so that querying the results before the first frame completes simply returns VK_NOT_READY.
+    vkCmdResetQueryPool(s_commandBuffers[0], s_timestampQueryPool, 0, queryPoolCreateInfo.queryCount);
+
+    return true;
+}
+
+// Fetches the GPU execution time in milliseconds of the last completed command buffer of the specified swapchain image.
+static bool ReadGpuFrameTime(uint32_t swapchainIndex, double* pGpuTime)
+{
+    if (s_timestampQueryPool == VK_NULL_HANDLE) return false;
+
+    uint64_t timestamps[2] = { 0 };
+    const VkResult res = vkGetQueryPoolResults(s_specDevice, s_timestampQueryPool, swapchainIndex * 2, 2, sizeof(timestamps), timestamps,
+        sizeof(timestamps[0]), VK_QUERY_RESULT_64_BIT);
+    if (res != VK_SUCCESS) return false;
+
+    const uint64_t validMask = s_timestampValidBits >= 64 ? UINT64_MAX : (1ULL << s_timestampValidBits) - 1ULL;
+    const uint64_t ticks = (timestamps[1] - timestamps[0]) & validMask;
+    *pGpuTime = (double)ticks * (double)s_timestampPeriod / 1000000.0;
+    return true;
+}
+
+// Draws `instanceCount` instances of the object geometry, either the mesh or the built-in square.
+static void RecordObjectGeometryDraw(VkCommandBuffer cmdBuf, uint32_t instanceCount, uint32_t firstInstance)
+{
+    if (s_meshFilePath == NULL) {
+        vkCmdDraw(cmdBuf, 4, instanceCount, 0, firstInstance);
+    }
+    else if (s_meshHeader.indexSize != 0) {
+        vkCmdDrawIndexed(cmdBuf, (uint32_t)s_meshHeader.indexCount, instanceCount, 0, 0, firstInstance);
+    }
+    else {
+        vkCmdDraw(cmdBuf, (uint32_t)s_meshHeader.vertexCount, instanceCount, 0, firstInstance);
+    }
+}
+
+// Records the draws of the visible objects s_visibleObjectIndices[firstVisible, firstVisible + visibleCount) inside the render pass
+// instance of `swapchainIndex`, binding all the state they use, since a secondary command buffer inherits none of it.
+static void RecordObjectDraws(VkCommandBuffer cmdBuf, uint32_t swapchainIndex, uint32_t firstVisible, uint32_t visibleCount)
+{
+    const VkDeviceSize vertexoffsets[] = { 0, 0 };
+    if (s_meshFilePath != NULL)
+    {
+        vkCmdBindVertexBuffers(cmdBuf, 0, 1, &s_meshVertexBuffer, vertexoffsets);
+        if (s_meshIndexBuffer != VK_NULL_HANDLE) {
+            vkCmdBindIndexBuffer(cmdBuf, s_meshIndexBuffer, 0, s_meshHeader.indexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32);
+        }
+    }
+    else
+    {
+        const VkBuffer vertexBuffers[] = {
+            s_swapchainImageResources[swapchainIndex].coords_buffer,
+            s_swapchainImageResources[swapchainIndex].color_buffer
+        };
+        vkCmdBindVertexBuffers(cmdBuf, 0, sizeof(vertexBuffers) / sizeof(vertexBuffers[0]), vertexBuffers, vertexoffsets);
+    }
+
+    if (s_useBindless)
+    {
+        // The global set is the same for every image, only the elements read by the shaders differ.
+        const BindlessPushConstants pushConstants = {
+            .uniformIndex = s_swapchainImageResources[swapchainIndex].bindless_uniform_index,
+            .transformIndex = s_swapchainImageResources[swapchainIndex].bindless_transform_index,
+            .textureIndex = s_bindlessTextureIndex
+        };
+        vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelineLayout, 0, 1, &s_bindlessDescSet, 0, NULL);
+        vkCmdPushConstants(cmdBuf, s_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+            sizeof(pushConstants), &pushConstants);
+    }
+    else if (s_useDescriptorBuffer)
+    {
+        // Binding the buffer is the expensive part on some implementations, choosing the set is just an offset.
+        const VkDescriptorBufferBindingInfoEXT bindingInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT,
+            .pNext = NULL,
+            .address = s_descriptorBufferAddress,
+            .usage = s_descriptorBufferUsage
+        };
+        const uint32_t bufferIndex = 0;
+        const VkDeviceSize setOffset = swapchainIndex * s_descriptorSetStride;
+        s_vkCmdBindDescriptorBuffersEXT(cmdBuf, 1, &bindingInfo);
+        s_vkCmdSetDescriptorBufferOffsetsEXT(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelineLayout, 0, 1, &bufferIndex, &setOffset);
+    }
+    else
+    {
+        vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelineLayout, 0, 1,
+            &s_swapchainImageResources[swapchainIndex].descriptor_set, 0, NULL);
+    }
+
+    const bool isWidthShorterThanHeight = s_render_width < s_render_height;
+    const VkViewport viewport = {
+        .x = isWidthShorterThanHeight ? 0.0f : (s_render_width - s_render_height) / 2.0f,
+        .y = isWidthShorterThanHeight ? (s_render_height - s_render_width) / 2.0f : 0.0f,
+        .width = isWidthShorterThanHeight ? (float)s_render_width : (float)s_render_height,
+        .height = isWidthShorterThanHeight ? (float)s_render_width : (float)s_render_height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vkCmdSetViewport(cmdBuf, 0, 1, &viewport);
+
+    const VkRect2D scissor = {
+        .offset = { .x = 0, .y = 0 },
+        .extent = { .width = s_render_width, .height = s_render_height }
+    };
+    vkCmdSetScissor(cmdBuf, 0, 1, &scissor);
+
+    // Draw. Objects are split evenly between the two pipelines and the visible indices ascend, so each pipeline is bound at most once per range.
+    const uint32_t* pVisibleIndices = &s_visibleObjectIndices[firstVisible];
+    uint32_t visible = 0;
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        const uint32_t pipelineEndObject = i == 0 ? s_objectCount / 2 + s_objectCount % 2 : s_objectCount;
+        if (visible == visibleCount || pVisibleIndices[visible] >= pipelineEndObject) continue;
+
+        vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, s_pipelines[i]);
+        while (visible < visibleCount && pVisibleIndices[visible] < pipelineEndObject)
+        {
+            if (s_useGpuAnimation)
+            {
+                // Every instance fetches its own transform with gl_InstanceIndex, which starts from the first instance of the draw,
+                // so every run of consecutive visible objects is one instanced draw.
+                const uint32_t runFirstObject = pVisibleIndices[visible];
+                uint32_t runEnd = visible + 1;
+                while (runEnd < visibleCount && pVisibleIndices[runEnd] == runFirstObject + (runEnd - visible) &&
+                       pVisibleIndices[runEnd] < pipelineEndObject) {
+                    ++runEnd;
+                }
+                RecordObjectGeometryDraw(cmdBuf, runEnd - visible, runFirstObject);
+                visible = runEnd;
+            }
+            else
+            {
+                RecordObjectGeometryDraw(cmdBuf, 1, 0);
+                ++visible;
+            }
+        }
+    }
+}
+
+// `usageFlags` is VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT for the pre-recorded command buffers submitted every time
+// their image is drawn, and VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT for the ones recorded per frame.
+// If `pSecondaryCmdBufs` is not NULL, the render pass contents are the given secondary command buffers instead of being recorded inline.
+static bool BuildCommandForDraw(VkCommandBuffer inputCmdBuf, uint32_t swapchainIndex, VkCommandBufferUsageFlags usageFlags,
+                                const VkCommandBuffer* pSecondaryCmdBufs, uint32_t secondaryCmdBufCount)
+{
+    const VkCommandBufferBeginInfo cmd_buf_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = usageFlags,
+        .pInheritanceInfo = NULL,
+    };
+    VkResult res = vkBeginCommandBuffer(inputCmdBuf, &cmd_buf_info);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer in BuildCommandForDraw @%u failed: %d\n", swapchainIndex, res);
+        return false;
+    }
+
+    if (s_timestampQueryPool != VK_NULL_HANDLE)
+    {
+        // Queries MUST BE reset outside of a render pass instance before being written again.
+        vkCmdResetQueryPool(inputCmdBuf, s_timestampQueryPool, swapchainIndex * 2, 2);
+        vkCmdWriteTimestamp(inputCmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, s_timestampQueryPool, swapchainIndex * 2);
+    }
+
+    const VkClearValue clearValues[] = {
+        { .color.float32 = { 0.4f, 0.5f, 0.4f, 1.0f } },
+        { .depthStencil = { .depth = 1.0f, .stencil = 0 } },
+    };
+    const VkRenderPassBeginInfo renderPassBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .pNext = NULL,
+        .renderPass = s_render_pass,
+        .framebuffer = s_swapchainImageResources[swapchainIndex].framebuffer,
+        .renderArea = {
+            .offset = { .x = 0, .y = 0 },
+            .extent = {.width = s_render_width, .height = s_render_height }
+        },
+        .clearValueCount = (uint32_t)(sizeof(clearValues) / sizeof(clearValues[0])),
+        .pClearValues = clearValues,
+    };
+
+    // ==== The following code block is in the render pass instance. ====
+    if (secondaryCmdBufCount > 0)
+    {
+        vkCmdBeginRenderPass(inputCmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        vkCmdExecuteCommands(inputCmdBuf, secondaryCmdBufCount, pSecondaryCmdBufs);
+    }
+    else if (pSecondaryCmdBufs != NULL)
+    {
+        // Every chunk was empty
+        vkCmdBeginRenderPass(inputCmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    }
+    else
+    {
+        vkCmdBeginRenderPass(inputCmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        RecordObjectDraws(inputCmdBuf, swapchainIndex, 0, s_visibleObjectCount);
+    }
+
+    // Note that ending the renderpass changes the image's layout from
+    // COLOR_ATTACHMENT_OPTIMAL to PRESENT_SRC_KHR
+    vkCmdEndRenderPass(inputCmdBuf);
+
+    if (IsSeperatePresentQueue())
+    {
+        // We have to transfer ownership from the graphics queue family to the
+        // present queue family to be able to present.  Note that we don't have
+        // to transfer from present queue family back to graphics queue family at
+        // the start of the next frame because we don't care about the image's
+        // contents at that point.
+        const VkImageMemoryBarrier image_ownership_barrier = { 
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = 0,
+            .dstAccessMask = 0,
+            .oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            .newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+            .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+            .dstQueueFamilyIndex = s_presentQueueFamilyIndex,
+            .image = s_swapchainImageResources[swapchainIndex].image,
+            .subresourceRange = { 
+                .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, 
+                .baseMipLevel = 0, 
+                .levelCount = 1,
+                .baseArrayLayer = 0,
+                .layerCount = 1
+            }
+        };
+
+        vkCmdPipelineBarrier(inputCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, NULL, 0,
+            NULL, 1, &image_ownership_barrier);
+    }
+
+    // Update uniform buffer data on device side.
+    // ATTENTION: vkCmdCopyBuffer MUST BE only called outside of a render pass instance!
+    const VkBufferCopy copyUniformRegion = {
+    .srcOffset = 0,
+    .dstOffset = 0,
+    .size = sizeof(FlattenVertexUniform)
+    };
+    vkCmdCopyBuffer(inputCmdBuf, s_hostUniformBuffer,
+        s_swapchainImageResources[swapchainIndex].uniform_buffer, 1, &copyUniformRegion);
+
+    const VkBufferMemoryBarrier copyBarrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_SHADER_READ_BIT,
+        .srcQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .dstQueueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .buffer = s_swapchainImageResources[swapchainIndex].uniform_buffer,
+        .offset = 0,
+        .size = sizeof(FlattenVertexUniform)
+    };
+    vkCmdPipelineBarrier(inputCmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_SHADER_BIT, 0,
+        0, NULL, 1, &copyBarrier, 0, NULL);
+
+    if (s_timestampQueryPool != VK_NULL_HANDLE) {
+        vkCmdWriteTimestamp(inputCmdBuf, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, s_timestampQueryPool, swapchainIndex * 2 + 1);
+    }
+
+    res = vkEndCommandBuffer(inputCmdBuf);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for BuildCommandForDraw failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static void RecordDrawChunks(void* pUserData, uint32_t firstChunk, uint32_t chunkCount, uint32_t workerIndex)
+{
+    DrawRecordContext* pContext = pUserData;
+    WorkerCommandPool* pPool = &s_workerCommandPools[pContext->frameIndex][workerIndex];
+    for (uint32_t chunk = firstChunk; chunk < firstChunk + chunkCount; ++chunk)
+    {
+        if (pPool->usedCount == pPool->allocatedCount)
+        {
+            const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+                .pNext = NULL,
+                .commandPool = pPool->commandPool,
+                .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY,
+                .commandBufferCount = 1
+            };
+            const VkResult res = vkAllocateCommandBuffers(s_specDevice, &cmdBufAllocInfo, &pPool->secondaryCmdBufs[pPool->allocatedCount]);
+            if (res != VK_SUCCESS)
+            {
+                printf("vkAllocateCommandBuffers for secondary command buffer of worker %u failed: %d\n", workerIndex, res);
+                PlatformAtomicStore(&pContext->hasFailed, 1);
+                return;
+            }
+            pPool->allocatedCount++;
+        }
+        const VkCommandBuffer cmdBuf = pPool->secondaryCmdBufs[pPool->usedCount++];
+
+        const VkCommandBufferInheritanceInfo inheritanceInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+            .pNext = NULL,
+            .renderPass = s_render_pass,
+            .subpass = 0,
+            .framebuffer = s_swapchainImageResources[pContext->imageIndex].framebuffer,
+            .occlusionQueryEnable = VK_FALSE,
+            .queryFlags = 0,
+            .pipelineStatistics = 0
+        };
+        const VkCommandBufferBeginInfo beginInfo = {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .pNext = NULL,
+            .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+            .pInheritanceInfo = &inheritanceInfo
+        };
+        VkResult res = vkBeginCommandBuffer(cmdBuf, &beginInfo);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkBeginCommandBuffer for secondary command buffer of worker %u failed: %d\n", workerIndex, res);
+            PlatformAtomicStore(&pContext->hasFailed, 1);
+            return;
+        }
+
+        const uint32_t firstVisible = (uint32_t)((uint64_t)chunk * s_visibleObjectCount / pContext->chunkCount);
+        const uint32_t endVisible = (uint32_t)((uint64_t)(chunk + 1) * s_visibleObjectCount / pContext->chunkCount);
+        RecordObjectDraws(cmdBuf, pContext->imageIndex, firstVisible, endVisible - firstVisible);
+
+        res = vkEndCommandBuffer(cmdBuf);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkEndCommandBuffer for secondary command buffer of worker %u failed: %d\n", workerIndex, res);
+            PlatformAtomicStore(&pContext->hasFailed, 1);
+            return;
+        }
+        pContext->secondaryCmdBufs[chunk] = cmdBuf;
+    }
+}
+
+// Culls the objects and records the draw commands of the visible ones for `imageIndex` into the command buffer of `frameIndex`,
+// whose previous submission MUST have completed.
+// With `recordThreadCount` > 0, the render pass contents are recorded into as many secondary command buffers on s_jobSystem.
+// Returns the command buffer to submit, or VK_NULL_HANDLE on failure.
+static VkCommandBuffer RecordFrameDrawCommands(uint32_t frameIndex, uint32_t imageIndex, uint32_t recordThreadCount)
+{
+    CullSceneObjects();
+
+    VkResult res = vkResetCommandPool(s_specDevice, s_frameCommandPools[frameIndex], 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkResetCommandPool for frame @%u failed: %d\n", frameIndex, res);
+        return VK_NULL_HANDLE;
+    }
+    if (recordThreadCount == 0)
+    {
+        if (!BuildCommandForDraw(s_frameCommandBuffers[frameIndex], imageIndex, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, NULL, 0)) {
+            return VK_NULL_HANDLE;
+        }
+        return s_frameCommandBuffers[frameIndex];
+    }
+
+    for (uint32_t i = 0; i < s_jobSystem.workerCount; ++i)
+    {
+        WorkerCommandPool* pPool = &s_workerCommandPools[frameIndex][i];
+        if (pPool->usedCount == 0) continue;
+
+        res = vkResetCommandPool(s_specDevice, pPool->commandPool, 0);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkResetCommandPool for worker %u of frame @%u failed: %d\n", i, frameIndex, res);
+            return VK_NULL_HANDLE;
+        }
+        pPool->usedCount = 0;
+    }
+
+    // Empty chunks are not worth a secondary command buffer
+    DrawRecordContext context = {
+        .frameIndex = frameIndex,
+        .imageIndex = imageIndex,
+        .chunkCount = recordThreadCount < s_visibleObjectCount ? recordThreadCount : s_visibleObjectCount,
+        .hasFailed = 0
+    };
+    RunParallelFor(&s_jobSystem, 0, context.chunkCount, 1, RecordDrawChunks, &context);
+    if (PlatformAtomicLoad(&context.hasFailed) != 0) return VK_NULL_HANDLE;
+
+    if (!BuildCommandForDraw(s_frameCommandBuffers[frameIndex], imageIndex, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+                             context.secondaryCmdBufs, context.chunkCount)) {
+        return VK_NULL_HANDLE;
+    }
+    return s_frameCommandBuffers[frameIndex];
+}
+
+// Records the draw commands of the first frame in flight `iterationCount` times inline, then with 1 up to all workers of s_jobSystem
+// recording secondary command buffers. The device MUST BE idle, and the recorded command buffers are never submitted.
+static bool BenchmarkCommandRecording(uint32_t iterationCount, RecordBenchmarkResult results[], uint32_t* pResultCount)
+{
+    double* samples = calloc(iterationCount, sizeof(double));
+    if (samples == NULL)
+    {
+        puts("Failed to allocate the command recording benchmark samples!");
+        return false;
+    }
+
+    uint32_t resultCount = 0;
+    bool succeeded = true;
+    for (uint32_t threadCount = 0; threadCount <= s_jobSystem.workerCount && succeeded; ++threadCount)
+    {
+        for (uint32_t i = 0; i < iterationCount && succeeded; ++i)
+        {
+            const uint64_t beginTime = GetCurrentTimeNanoseconds();
+            succeeded = RecordFrameDrawCommands(0, 0, threadCount) != VK_NULL_HANDLE;
+            samples[i] = (double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000.0;
+        }
+        if (!succeeded) break;
+
+        RecordBenchmarkResult* pResult = &results[resultCount++];
+        pResult->threadCount = threadCount;
+        ComputeBenchStatistics(samples, iterationCount, &pResult->time);
+        if (threadCount == 0) {
+            printf("Recorded %u objects inline: %.3f ms\n", s_objectCount, pResult->time.p50);
+        }
+        else {
+            printf("Recorded %u objects into secondary command buffers on %u thread(s): %.3f ms, %.2fx the speed on 1 thread\n", s_objectCount,
+                threadCount, pResult->time.p50, results[1].time.p50 / pResult->time.p50);
+        }
+    }
+
+    free(samples);
+    *pResultCount = resultCount;
+    return succeeded;
+}
+
+static void RunRenderContextWorker(void* pArgument)
+{
+    RenderContextWorker* pWorker = pArgument;
+    RenderContext context;
+    const uint64_t createBeginTime = GetCurrentTimeNanoseconds();
+    const bool isCreated = CreateRenderContext(&pWorker->createInfo, &context);
+    pWorker->createTime = GetCurrentTimeNanoseconds() - createBeginTime;
+    PlatformAtomicAdd(pWorker->pReadyCount, 1);
+    if (!isCreated) return;
+
+    while (PlatformAtomicLoad(pWorker->pStartFlag) == 0) {
+        YieldPlatformThread();
+    }
+
+    RenderContextScene scene = {
+        .cameraExtent = { 1.0f, 1.0f },
+        .angle = 0.0f
+    };
+    memcpy(scene.vertexColors, s_vertex_color_data, sizeof(scene.vertexColors));
+    bool succeeded = true;
+    for (uint32_t frame = 0; frame < pWorker->frameCount && succeeded; ++frame)
+    {
+        // Every context turns the squares from its own angle, like independent scenes
+        scene.angle = (float)((pWorker->index * 45U + frame) % 360U);
+        succeeded = SubmitRenderContextFrame(&context, &scene);
+    }
+    succeeded = succeeded && FinishRenderContextFrames(&context);
+    pWorker->endTime = GetCurrentTimeNanoseconds();
+    pWorker->queueWaitTime = context.queueWaitTime;
+    pWorker->succeeded = succeeded;
+    DestroyRenderContext(&context);
+}
+
+// Renders `frameCount` frames on each of 1, 2, 4 ... s_renderContextCount render contexts at once, every context on its own thread
+// and, as far as the queue family has them, on its own queue. The contexts share the device, the shader modules and one pipeline cache,
+// which the single context of the first round fills, so the later rounds create their pipelines from a warm cache.
+static bool BenchmarkRenderContexts(uint32_t frameCount, ContextBenchmarkResult results[], uint32_t* pResultCount)
+{
+    VkShaderModule vertexShaders[RENDER_CONTEXT_DRAW_COUNT] = { VK_NULL_HANDLE };
+    VkShaderModule fragmentShaders[RENDER_CONTEXT_DRAW_COUNT] = { VK_NULL_HANDLE };
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    RenderQueue queues[1 + MAX_RENDER_CONTEXT_COUNT];
+    RenderContextWorker workers[MAX_RENDER_CONTEXT_COUNT];
+    PlatformThread threads[MAX_RENDER_CONTEXT_COUNT];
+    for (uint32_t i = 0; i < s_specQueueCount; ++i)
+    {
+        vkGetDeviceQueue(s_specDevice, s_specQueueFamilyIndex, i, &queues[i].queue);
+        InitializePlatformMutex(&queues[i].mutex);
+    }
+    // The first queue belongs to the renderer, which is idle by now, so the contexts only take it if there is no other one.
+    const uint32_t firstContextQueue = s_specQueueCount > 1 ? 1 : 0;
+    const uint32_t contextQueueCount = s_specQueueCount - firstContextQueue;
+
+    uint32_t resultCount = 0;
+    bool succeeded = false;
+    do
+    {
+        if (!CreateVertAndFragShaderModules("flatten.vert.spv", "flatten.frag.spv", &vertexShaders[0], &fragmentShaders[0])) break;
+        if (!CreateVertAndFragShaderModules("gradient.vert.spv", "gradient.frag.spv", &vertexShaders[1], &fragmentShaders[1])) break;
+
+        const VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .initialDataSize = 0,
+            .pInitialData = NULL
+        };
+        const VkResult res = vkCreatePipelineCache(s_specDevice, &pipelineCacheCreateInfo, s_pAllocator, &pipelineCache);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreatePipelineCache for the render contexts failed: %d\n", res);
+            break;
+        }
+
+        succeeded = true;
+        uint32_t contextCount = 1;
+        while (succeeded)
+        {
+            volatile int64_t readyCount = 0;
+            volatile int64_t startFlag = 0;
+            uint32_t threadCount = 0;
+            for (uint32_t i = 0; i < contextCount; ++i)
+            {
+                workers[i] = (RenderContextWorker){
+                    .createInfo = {
+                        .device = s_specDevice,
+                        .pAllocator = s_pAllocator,
+                        .pMemoryTracker = &s_memoryTracker,
+                        .pipelineCache = pipelineCache,
+                        .pQueue = &queues[firstContextQueue + i % contextQueueCount],
+                        .queueFamilyIndex = s_specQueueFamilyIndex,
+                        .width = s_render_width,
+                        .height = s_render_height,
+                        .colorFormat = VK_FORMAT_R8G8B8A8_UNORM,
+                        .depthFormat = (VkFormat)s_depth_format,
+                        .frameCount = min(s_frameLag, (uint32_t)MAX_RENDER_CONTEXT_FRAME_COUNT),
+                        .uniformAlignment = s_deviceCapabilities.properties.limits.minUniformBufferOffsetAlignment,
+                        .vertexShaders = { vertexShaders[0], vertexShaders[1] },
+                        .fragmentShaders = { fragmentShaders[0], fragmentShaders[1] },
+                        .pVertexCoords = s_vertex_coords_data
+                    },
+                    .index = i,
+                    .frameCount = frameCount,
+                    .pReadyCount = &readyCount,
+                    .pStartFlag = &startFlag,
+                    .succeeded = false
+                };
+                if (!CreatePlatformThread(&threads[i], RunRenderContextWorker, &workers[i]))
+                {
+                    puts("Failed to create a render context thread!");
+                    succeeded = false;
+                    break;
+                }
+                ++threadCount;
+            }
+
+            while (PlatformAtomicLoad(&readyCount) < (int64_t)threadCount) {
+                YieldPlatformThread();
+            }
+            const uint64_t beginTime = GetCurrentTimeNanoseconds();
+            PlatformAtomicStore(&startFlag, 1);
+            for (uint32_t i = 0; i < threadCount; ++i) {
+                JoinPlatformThread(threads[i]);
+            }
+            if (!succeeded) break;
+
+            uint64_t endTime = beginTime;
+            uint64_t createTime = 0;
+            uint64_t queueWaitTime = 0;
+            for (uint32_t i = 0; i < contextCount; ++i)
+            {
+                succeeded = succeeded && workers[i].succeeded;
+                endTime = max(endTime, workers[i].endTime);
+                createTime += workers[i].createTime;
+                queueWaitTime += workers[i].queueWaitTime;
+            }
+            if (!succeeded)
+            {
+                printf("Rendering on %u render contexts failed!\n", contextCount);
+                break;
+            }
+
+            ContextBenchmarkResult* pResult = &results[resultCount++];
+            pResult->contextCount = contextCount;
+            pResult->queueCount = min(contextCount, contextQueueCount);
+            pResult->framesPerSecond = endTime > beginTime ? (double)contextCount * frameCount * 1000000000.0 / (endTime - beginTime) : 0.0;
+            pResult->createTime = (double)createTime / contextCount / 1000000.0;
+            pResult->queueWaitTime = (double)queueWaitTime / 1000000.0;
+            printf("%u render context(s) on %u queue(s): %.1f fps in total, %.1f fps per context, %.2fx the throughput of 1 context, created in %.3f ms\n",
+                contextCount, pResult->queueCount, pResult->framesPerSecond, pResult->framesPerSecond / contextCount,
+                results[0].framesPerSecond > 0.0 ? pResult->framesPerSecond / results[0].framesPerSecond : 0.0, pResult->createTime);
+
+            if (contextCount == s_renderContextCount) break;
+            contextCount = min(contextCount * 2, s_renderContextCount);
+        }
+    }
+    while (false);
+
+    vkDestroyPipelineCache(s_specDevice, pipelineCache, s_pAllocator);
+    for (uint32_t i = 0; i < RENDER_CONTEXT_DRAW_COUNT; ++i)
+    {
+        vkDestroyShaderModule(s_specDevice, vertexShaders[i], s_pAllocator);
+        vkDestroyShaderModule(s_specDevice, fragmentShaders[i], s_pAllocator);
+    }
+    for (uint32_t i = 0; i < s_specQueueCount; ++i) {
+        DestroyPlatformMutex(&queues[i].mutex);
+    }
+    *pResultCount = resultCount;
+    return succeeded;
+}
+
+static void WriteChurnDescriptorBatch(void* pUserData, uint32_t first, uint32_t count, uint32_t workerIndex)
+{
+    (void)workerIndex;
+    const DescriptorChurnContext* pContext = pUserData;
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        uint8_t* pSetData = pContext->pSetData + i * pContext->setStride;
+        GetBufferDescriptor(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, pContext->bufferAddress, sizeof(FlattenVertexUniform),
+            pSetData + pContext->bindingOffsets[0]);
+        GetBufferDescriptor(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, pContext->bufferAddress, sizeof(FlattenVertexUniform),
+            pSetData + pContext->bindingOffsets[1]);
+    }
+}
+
+// Measures rewriting DESCRIPTOR_BENCHMARK_SET_COUNT sets of a uniform buffer and a storage buffer, like the sets of the draws,
+// by resetting a pool and allocating and updating the sets again, and by writing them into a descriptor buffer
+// on 1 and on all job system workers if VK_EXT_descriptor_buffer is supported.
+static bool BenchmarkDescriptorChurn(uint32_t iterationCount, DescriptorBenchmarkResult results[], uint32_t* pResultCount)
+{
+    const VkDescriptorSetLayoutBinding layoutBindings[] = {
+        {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .pImmutableSamplers = NULL,
+        },
+        {
+            .binding = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .pImmutableSamplers = NULL,
+        }
+    };
+    VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = (uint32_t)(sizeof(layoutBindings) / sizeof(layoutBindings[0])),
+        .pBindings = layoutBindings,
+    };
+    const VkDescriptorPoolSize poolSizes[] = {
+        {
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = DESCRIPTOR_BENCHMARK_SET_COUNT,
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = DESCRIPTOR_BENCHMARK_SET_COUNT,
+        }
+    };
+    const VkDescriptorPoolCreateInfo poolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .maxSets = DESCRIPTOR_BENCHMARK_SET_COUNT,
+        .poolSizeCount = (uint32_t)(sizeof(poolSizes) / sizeof(poolSizes[0])),
+        .pPoolSizes = poolSizes,
+    };
+
+    double* samples = calloc(iterationCount, sizeof(double));
+    VkDescriptorSetLayout poolLayout = VK_NULL_HANDLE;
+    VkDescriptorSetLayout bufferLayout = VK_NULL_HANDLE;
+    VkDescriptorPool pool = VK_NULL_HANDLE;
+    VkBuffer resourceBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory resourceMemory = VK_NULL_HANDLE;
+    VkBuffer descriptorBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory descriptorMemory = VK_NULL_HANDLE;
+    uint32_t resultCount = 0;
+
+    bool succeeded = false;
+    do
+    {
+        if (samples == NULL)
+        {
+            puts("Failed to allocate the descriptor benchmark samples!");
+            break;
+        }
+        // The descriptors of all the sets point at the same buffer, writing them costs the same as for distinct buffers.
+        if (!CreateDeviceLocalBuffer(sizeof(FlattenVertexUniform), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT |
+            (s_supportDescriptorBuffer ? VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT : 0), DEVICE_MEMORY_CATEGORY_BENCHMARK, &s_graphicsQueueFamilyIndex, 1,
+            &resourceBuffer, &resourceMemory)) {
+            break;
+        }
+        VkResult res = vkCreateDescriptorSetLayout(s_specDevice, &layoutCreateInfo, s_pAllocator, &poolLayout);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateDescriptorSetLayout for descriptor benchmark failed: %d\n", res);
+            break;
+        }
+        res = vkCreateDescriptorPool(s_specDevice, &poolCreateInfo, s_pAllocator, &pool);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateDescriptorPool for descriptor benchmark failed: %d\n", res);
+            break;
+        }
+
+        VkDescriptorSetLayout batchLayouts[DESCRIPTOR_BENCHMARK_BATCH_SIZE];
+        VkDescriptorSet batchSets[DESCRIPTOR_BENCHMARK_BATCH_SIZE];
+        VkWriteDescriptorSet batchWrites[DESCRIPTOR_BENCHMARK_BATCH_SIZE * 2];
+        const VkDescriptorBufferInfo bufferInfo = {
+            .buffer = resourceBuffer,
+            .offset = 0,
+            .range = sizeof(FlattenVertexUniform)
+        };
+        for (uint32_t i = 0; i < DESCRIPTOR_BENCHMARK_BATCH_SIZE; ++i)
+        {
+            batchLayouts[i] = poolLayout;
+            for (uint32_t j = 0; j < 2; ++j)
+            {
+                batchWrites[i * 2 + j] = (VkWriteDescriptorSet){
+                    .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+                    .pNext = NULL,
+                    .dstSet = VK_NULL_HANDLE,
+                    .dstBinding = j,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                    .descriptorType = layoutBindings[j].descriptorType,
+                    .pImageInfo = NULL,
+                    .pBufferInfo = &bufferInfo,
+                    .pTexelBufferView = NULL
+                };
+            }
+        }
+        const VkDescriptorSetAllocateInfo allocInfo = {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+            .pNext = NULL,
+            .descriptorPool = pool,
+            .descriptorSetCount = DESCRIPTOR_BENCHMARK_BATCH_SIZE,
+            .pSetLayouts = batchLayouts
+        };
+
+        uint32_t i;
+        for (i = 0; i < iterationCount; ++i)
+        {
+            const uint64_t beginTime = GetCurrentTimeNanoseconds();
+            res = vkResetDescriptorPool(s_specDevice, pool, 0);
+            for (uint32_t first = 0; first < DESCRIPTOR_BENCHMARK_SET_COUNT && res == VK_SUCCESS; first += DESCRIPTOR_BENCHMARK_BATCH_SIZE)
+            {
+                res = vkAllocateDescriptorSets(s_specDevice, &allocInfo, batchSets);
+                if (res != VK_SUCCESS) break;
+                for (uint32_t j = 0; j < DESCRIPTOR_BENCHMARK_BATCH_SIZE * 2; ++j) {
+                    batchWrites[j].dstSet = batchSets[j / 2];
+                }
+                vkUpdateDescriptorSets(s_specDevice, DESCRIPTOR_BENCHMARK_BATCH_SIZE * 2, batchWrites, 0, NULL);
+            }
+            if (res != VK_SUCCESS)
+            {
+                printf("Allocating the descriptor benchmark sets failed: %d\n", res);
+                break;
+            }
+            samples[i] = (double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000.0;
+        }
+        if (i != iterationCount) break;
+
+        DescriptorBenchmarkResult* pResult = &results[resultCount++];
+        pResult->isDescriptorBuffer = false;
+        pResult->workerCount = 1;
+        ComputeBenchStatistics(samples, iterationCount, &pResult->time);
+        printf("Rewrote %u descriptor sets from a pool: %.3f ms\n", DESCRIPTOR_BENCHMARK_SET_COUNT, pResult->time.p50);
+
+        if (!s_supportDescriptorBuffer)
+        {
+            printf("%s not supported, so only the pool is measured\n", VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+            succeeded = true;
+            break;
+        }
+
+        layoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        res = vkCreateDescriptorSetLayout(s_specDevice, &layoutCreateInfo, s_pAllocator, &bufferLayout);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateDescriptorSetLayout for descriptor buffer benchmark failed: %d\n", res);
+            break;
+        }
+        VkDeviceSize layoutSize = 0;
+        s_vkGetDescriptorSetLayoutSizeEXT(s_specDevice, bufferLayout, &layoutSize);
+        const VkDeviceSize alignment = s_deviceCapabilities.descriptorBufferOffsetAlignment > 0 ? s_deviceCapabilities.descriptorBufferOffsetAlignment : 1;
+        DescriptorChurnContext context = {
+            .pSetData = NULL,
+            .setStride = (layoutSize + alignment - 1) / alignment * alignment
+        };
+        for (uint32_t j = 0; j < 2; ++j) {
+            s_vkGetDescriptorSetLayoutBindingOffsetEXT(s_specDevice, bufferLayout, j, &context.bindingOffsets[j]);
+        }
+        if (!CreateBufferWithMemory(context.setStride * DESCRIPTOR_BENCHMARK_SET_COUNT,
+            VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, DEVICE_MEMORY_CATEGORY_BENCHMARK,
+            &s_graphicsQueueFamilyIndex, 1, &descriptorBuffer, &descriptorMemory)) {
+            break;
+        }
+        res = vkMapMemory(s_specDevice, descriptorMemory, 0, VK_WHOLE_SIZE, 0, (void**)&context.pSetData);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkMapMemory for descriptor buffer benchmark failed: %d\n", res);
+            break;
+        }
+        context.bufferAddress = GetBufferDeviceAddress(resourceBuffer);
+
+        // No reset or allocation: a set is rewritten in place, and only the writes of a single set need to be ordered.
+        const uint32_t workerCounts[] = { 1, s_jobSystem.workerCount };
+        const uint32_t rowCount = s_jobSystem.workerCount > 1 ? 2 : 1;
+        for (uint32_t row = 0; row < rowCount; ++row)
+        {
+            const uint32_t workerCount = workerCounts[row];
+            for (i = 0; i < iterationCount; ++i)
+            {
+                const uint64_t beginTime = GetCurrentTimeNanoseconds();
+                if (workerCount == 1) {
+                    WriteChurnDescriptorBatch(&context, 0, DESCRIPTOR_BENCHMARK_SET_COUNT, 0);
+                }
+                else {
+                    RunParallelFor(&s_jobSystem, 0, DESCRIPTOR_BENCHMARK_SET_COUNT, DESCRIPTOR_BENCHMARK_BATCH_SIZE, WriteChurnDescriptorBatch, &context);
+                }
+                samples[i] = (double)(GetCurrentTimeNanoseconds() - beginTime) / 1000000.0;
+            }
+
+            pResult = &results[resultCount++];
+            pResult->isDescriptorBuffer = true;
+            pResult->workerCount = workerCount;
+            ComputeBenchStatistics(samples, iterationCount, &pResult->time);
+            printf("Rewrote %u descriptor sets in a descriptor buffer on %u thread(s): %.3f ms, %.2fx the speed of the pool\n",
+                DESCRIPTOR_BENCHMARK_SET_COUNT, workerCount, pResult->time.p50, results[0].time.p50 / pResult->time.p50);
+        }
+        succeeded = true;
+    }
+    while (false);
+
+    if (descriptorBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, descriptorBuffer, s_pAllocator);
+    }
+    if (descriptorMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, descriptorMemory);
+    }
+    if (pool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(s_specDevice, pool, s_pAllocator);
+    }
+    if (bufferLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(s_specDevice, bufferLayout, s_pAllocator);
+    }
+    if (poolLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(s_specDevice, poolLayout, s_pAllocator);
+    }
+    if (resourceBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, resourceBuffer, s_pAllocator);
+    }
+    if (resourceMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, resourceMemory);
+    }
+    free(samples);
+    *pResultCount = resultCount;
+    return succeeded;
+}
+
+static bool FlushInitCommand(void)
+{
+    // This function could get called twice if the texture uses a staging buffer
+    // In that case the second call should be ignored
+    if (s_commandBuffers[0] == VK_NULL_HANDLE) return true;
+
+    // Take over the resources uploaded on the transfer queue. The vertex data is always among them, so some stage waits.
+    const bool waitForTransferQueue = s_uploadCompleteSemaphore != VK_NULL_HANDLE;
+    VkPipelineStageFlags waitDstStageMask = 0;
+    if (waitForTransferQueue) {
+        waitDstStageMask = RecordUploadAcquireBarriers(&s_uploadManager, s_commandBuffers[0]);
+    }
+
+    VkResult res = vkEndCommandBuffer(s_commandBuffers[0]);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for init command buffer failed: %d\n", res);
+        return false;
+    }
+
+    const VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = waitForTransferQueue ? 1 : 0,
+        .pWaitSemaphores = &s_uploadCompleteSemaphore,
+        .pWaitDstStageMask = &waitDstStageMask,
+        .commandBufferCount = (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])),
+        .pCommandBuffers = s_commandBuffers,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+
+    VkFence submitFence = VK_NULL_HANDLE;
+    const VkFenceCreateInfo submitFenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .pNext = NULL, .flags = 0 };
+    res = vkCreateFence(s_specDevice, &submitFenceCreateInfo, s_pAllocator, &submitFence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateFence for submitFence failed: %d\n", res);
+        return false;
+    }
+
+    do
+    {
+        res = vkQueueSubmit(s_graphicsQueue, 1, &submit_info, submitFence);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkQueueSubmit in init command buffer failed: %d\n", res);
+            break;
+        }
+
+        res = vkWaitForFences(s_specDevice, 1, &submitFence, VK_TRUE, UINT64_MAX);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkWaitForFences in init command buffer failed: %d\n", res);
+            break;
+        }
+    }
+    while (false);
+
+    vkDestroyFence(s_specDevice, submitFence, s_pAllocator);
+    if (res == VK_SUCCESS)
+    {
+        DestroyTransferQueueUploadResources();
+        // The initial uploads have completed, so their staging space is free for later uploads.
+        RetireCompletedUploads(&s_uploadManager);
+    }
+    
+    // This command buffer is one shot for the init flush submission,
+    // and will NOT be used any more.
+    vkFreeCommandBuffers(s_specDevice, s_commandPool, (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])), s_commandBuffers);
+    s_commandBuffers[0] = VK_NULL_HANDLE;
+
+    return res == VK_SUCCESS;
+}
+
+static bool UpdateUniformData(void)
+{
+    FlattenVertexUniform* hostUniformData = NULL;
+    VkResult res = vkMapMemory(s_specDevice, s_hostUniformMemory, 0, sizeof(FlattenVertexUniform), 0, (void**)&hostUniformData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for update uniform data failed: %d\n", res);
+        return false;
+    }
+
+    hostUniformData->u_factor[0] = 1.0f;
+    hostUniformData->u_factor[1] = 1.0f;
+    hostUniformData->u_angle = s_currRorationDegree;
+    hostUniformData->u_minLod = (float)s_textureResidentLevel;
+
+    s_currRorationDegree += 1.0f;
+    if (s_currRorationDegree >= 360.0f) {
+        s_currRorationDegree = 0.0f;
+    }
+
+    vkUnmapMemory(s_specDevice, s_hostUniformMemory);
+
+    return true;
+}
+
+// Submits the animation of the objects drawn into `imageIndex`, which signals s_animationCompleteSemaphores[frameIndex].
+// `waitSemaphore` is waited before the dispatch if it is not VK_NULL_HANDLE.
+// The previous animation of `imageIndex` MUST HAVE completed, since its parameters are rewritten here.
+static bool SubmitObjectAnimation(uint32_t imageIndex, uint32_t frameIndex, VkSemaphore waitSemaphore)
+{
+    const uint64_t currentTime = GetCurrentTimeNanoseconds();
+    float deltaTime = s_lastAnimationTime != 0 ? (float)((double)(currentTime - s_lastAnimationTime) / 1000000000.0) : s_nominalAnimationTimeStep;
+    if (deltaTime > s_maxAnimationTimeStep) {
+        deltaTime = s_maxAnimationTimeStep;
+    }
+    s_lastAnimationTime = currentTime;
+    s_swapchainImageResources[imageIndex].pAnimationParams->deltaTime = deltaTime;
+    if (s_animatedObjectStates != NULL) {
+        AdvanceAnimatedObjects(deltaTime);
+    }
+
+    const VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+    const VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitDstStageMask,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &s_swapchainImageResources[imageIndex].animation_cmd_buf,
+        .signalSemaphoreCount = 1,
+        .pSignalSemaphores = &s_animationCompleteSemaphores[frameIndex]
+    };
+    const VkResult res = vkQueueSubmit(s_computeQueue, 1, &submit_info, VK_NULL_HANDLE);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for animation failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+// Appends a startup phase that began at `beginTime` and ends now.
+static void RecordStartupPhase(const char* name, uint64_t beginTime)
+{
+    if (s_startupPhaseCount >= MAX_STARTUP_PHASE_COUNT) return;
+
+    s_startupPhases[s_startupPhaseCount++] = (StartupPhaseTiming){
+        .name = name,
+        .beginTime = beginTime - s_startupBeginTime,
+        .endTime = GetCurrentTimeNanoseconds() - s_startupBeginTime,
+        .workerIndex = 0
+    };
+}
+
+static void PrintStartupReport(void)
+{
+    uint64_t totalPhaseTime = 0;
+    puts("\n======== Startup phases ========");
+    for (uint32_t i = 0; i < s_startupPhaseCount; ++i)
+    {
+        const StartupPhaseTiming* pPhase = &s_startupPhases[i];
+        totalPhaseTime += pPhase->endTime - pPhase->beginTime;
+        printf("%-44s begin: %9.3fms  duration: %9.3fms  worker: %u\n", pPhase->name, pPhase->beginTime / 1000000.0,
+            (pPhase->endTime - pPhase->beginTime) / 1000000.0, pPhase->workerIndex);
+    }
+    printf("Sum of all phases: %.3fms, critical path of the render resource graph: %.3fms\n",
+        totalPhaseTime / 1000000.0, s_startupCriticalPathTime / 1000000.0);
+    if (s_firstFrameTime != 0) {
+        printf("Time to first frame: %.3fms\n", (s_firstFrameTime - s_startupBeginTime) / 1000000.0);
+    }
+    puts("");
+}
+
+#ifdef _WIN32
+// Recreates the swapchain for the new size of the window. The old swapchain, the views and framebuffers of its images and the depth
+// image are retired rather than destroyed, since the frames in flight may still use them.
+// On failure, the rendering stops and the application quits.
+static bool DoResize(void)
+{
+    // WM_SIZE also arrives while the window is created, before there is anything to resize
+    if (!s_isRenderPrepared) return true;
+
+    const VkSwapchainKHR oldSwapchain = s_swapchain;
+    VkImageView oldViews[MAX_SWAPCHAIN_IMAGE_COUNT];
+    VkFramebuffer oldFramebuffers[MAX_SWAPCHAIN_IMAGE_COUNT];
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        oldViews[i] = s_swapchainImageResources[i].view;
+        oldFramebuffers[i] = s_swapchainImageResources[i].framebuffer;
+    }
+
+    bool succeeded = CreateVulkanSwapchain();
+    // Nothing is created while the window is minimized
+    if (succeeded && s_swapchain == oldSwapchain) return true;
+
+    for (uint32_t i = 0; i < s_swapchainImageCount && succeeded; ++i)
+    {
+        succeeded = RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_FRAMEBUFFER, (uint64_t)oldFramebuffers[i], s_submittedFrameValue) &&
+                    RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)oldViews[i], s_submittedFrameValue);
+    }
+    // The depth image has the size of the swapchain
+    succeeded = succeeded &&
+        RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_IMAGE_VIEW, (uint64_t)s_depthResource.image_view, s_submittedFrameValue) &&
+        RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_IMAGE, (uint64_t)s_depthResource.image, s_submittedFrameValue) &&
+        RetireVulkanObject(&s_deletionQueue, VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)s_depthResource.device_memory, s_submittedFrameValue);
+    if (succeeded) {
+        memset(&s_depthResource, 0, sizeof(s_depthResource));
+    }
+    succeeded = succeeded && CreateDepthReource() && CreateFramebuffers();
+
+    // The pre-recorded command buffers refer to the old images and framebuffers, and MUST NOT be pending when they are recorded again.
+    // The draws recorded per frame pick up the new ones on their own.
+    const bool isSeparatePresentQueue = IsSeperatePresentQueue();
+    if (succeeded && (!s_recordCommandsPerFrame || isSeparatePresentQueue))
+    {
+        vkQueueWaitIdle(s_graphicsQueue);
+        if (isSeparatePresentQueue) {
+            vkQueueWaitIdle(s_presentQueue);
+        }
+        for (uint32_t i = 0; i < s_swapchainImageCount && succeeded; ++i)
+        {
+            succeeded = (s_recordCommandsPerFrame ||
+                         BuildCommandForDraw(s_swapchainImageResources[i].cmd_buf, i, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, NULL, 0)) &&
+                        (!isSeparatePresentQueue || BuildPresentImageOwnershipTransition(i));
+        }
+    }
+
+    if (!succeeded)
+    {
+        puts("Failed to resize the swapchain!");
+        s_isRenderPrepared = false;
+        PostQuitMessage(1);
+    }
+    return succeeded;
+}
+
+static void DrawObjects(HINSTANCE hInstance, HWND hWnd, int currFrameIndex)
+{
+    // Ensure no more than FRAME_LAG renderings are outstanding
+    vkWaitForFences(s_specDevice, 1, &s_presentFences[currFrameIndex], VK_TRUE, UINT64_MAX);
+    vkResetFences(s_specDevice, 1, &s_presentFences[currFrameIndex]);
+    CollectDeletionQueue(&s_deletionQueue, s_frameSlotValues[currFrameIndex]);
+    // The budgets change with what the other processes allocate
+    UpdateDeviceMemoryBudget(&s_memoryTracker);
+
+    uint32_t currImageIndex = 0;
+    VkResult res;
+    do
+    {
+        // Get the index of the next available swapchain image:
+        res = vkAcquireNextImageKHR(s_specDevice, s_swapchain, UINT64_MAX, s_imageAcquiredSemaphores[currFrameIndex], VK_NULL_HANDLE, &currImageIndex);
+        switch (res)
+        {
+        case VK_SUCCESS:
+            break;
+
+        case VK_ERROR_OUT_OF_DATE_KHR:
+            // s_swapchain is out of date (e.g. the window was resized) and must be recreated:
+            if (!DoResize()) return;
+            break;
+
+        case VK_SUBOPTIMAL_KHR:
+            // s_swapchain is not as optimal as it could be,
+            // but the platform's presentation engine will still present the image correctly.
+            break;
+
+        case VK_ERROR_SURFACE_LOST_KHR:
+            if (!CreateVulkanSurface(hInstance, hWnd) || !DoResize()) return;
+            break;
+
+        default:
+            printf("vkAcquireNextImageKHR failed: %d\n", res);
+            return;
+        }
+    }
+    while (res != VK_SUCCESS);
+
+    // The image may be acquired again while the frame last drawn into it is still in flight in another slot,
+    // and the animation parameters of the image are rewritten below.
+    SwapchainImageResources* pImageResources = &s_swapchainImageResources[currImageIndex];
+    if (pImageResources->frame_fence != VK_NULL_HANDLE && pImageResources->frame_fence != s_presentFences[currFrameIndex]) {
+        vkWaitForFences(s_specDevice, 1, &pImageResources->frame_fence, VK_TRUE, UINT64_MAX);
+    }
+    pImageResources->frame_fence = s_presentFences[currFrameIndex];
+
+    if (!UpdateUniformData() || !StreamTextureLevels()) {
+        return;
+    }
+
+    // Wait for the image acquired semaphore to be signaled to ensure
+    // that the image won't be rendered to until the presentation
+    // engine has fully released ownership to the application, and it is
+    // okay to render to the image.
+    VkPipelineStageFlags pipelineStageFlags[1] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+    VkSemaphore drawWaitSemaphore = s_imageAcquiredSemaphores[currFrameIndex];
+    if (s_useGpuAnimation)
+    {
+        // The transforms of the image may still be read by its previous draw until the image is acquired again,
+        // so the animation waits for the acquisition instead, and the draw waits for the animation, which transitively
+        // keeps the color attachment output after the acquisition.
+        if (!SubmitObjectAnimation(currImageIndex, currFrameIndex, s_imageAcquiredSemaphores[currFrameIndex])) return;
+        drawWaitSemaphore = s_animationCompleteSemaphores[currFrameIndex];
+        pipelineStageFlags[0] |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    }
+
+    VkCommandBuffer drawCmdBuf = s_swapchainImageResources[currImageIndex].cmd_buf;
+    if (s_recordCommandsPerFrame && (drawCmdBuf = RecordFrameDrawCommands(currFrameIndex, currImageIndex, s_recordThreadCount)) == VK_NULL_HANDLE) {
+        return;
+    }
+
+    VkSubmitInfo submit_info;
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submit_info.pNext = NULL;
+    submit_info.waitSemaphoreCount = 1;
+    submit_info.pWaitSemaphores = &drawWaitSemaphore;
+    submit_info.pWaitDstStageMask = pipelineStageFlags;
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &drawCmdBuf;
+    submit_info.signalSemaphoreCount = 1;
+    submit_info.pSignalSemaphores = &s_drawCompleteSemaphores[currFrameIndex];
+    res = vkQueueSubmit(s_graphicsQueue, 1, &submit_info, s_presentFences[currFrameIndex]);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit failed: %d\n", res);
+        return;
+    }
+    s_frameSlotValues[currFrameIndex] = ++s_submittedFrameValue;
+
+    const bool isSeparatePresentQueue = IsSeperatePresentQueue();
+    if (isSeparatePresentQueue)
+    {
+        // If we are using separate queues, change image ownership to the
+        // present queue before presenting, waiting for the draw complete
+        // semaphore and signalling the ownership released semaphore when finished
+        submit_info.waitSemaphoreCount = 1;
+        submit_info.pWaitSemaphores = &s_drawCompleteSemaphores[currFrameIndex];
+        submit_info.commandBufferCount = 1;
+        submit_info.pCommandBuffers = &s_swapchainImageResources[currImageIndex].graphics_to_present_cmd_buf;
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &s_imageOwnershipSemaphores[currFrameIndex];
+        res = vkQueueSubmit(s_presentQueue, 1, &submit_info, VK_NULL_HANDLE);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkQueueSubmit for presentation failed: %d\n", res);
+            return;
+        }
+    }
+
+    // If we are using separate queues we have to wait for image ownership,
+    // otherwise wait for draw complete
+    VkPresentInfoKHR present = {
+        .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+        .pNext = NULL,
+        .waitSemaphoreCount = 1,
+        .pWaitSemaphores = isSeparatePresentQueue ? &s_imageOwnershipSemaphores[currFrameIndex] : &s_drawCompleteSemaphores[currFrameIndex],
+        .swapchainCount = 1,
+        .pSwapchains = &s_swapchain,
+        .pImageIndices = &currImageIndex,
+        .pResults = NULL
+    };
+
+    VkRectLayerKHR rect;
+    VkPresentRegionKHR region;
+    VkPresentRegionsKHR regions;
+    if (s_supportIncrementalPresent)
+    {
+        // If using VK_KHR_incremental_present, we provide a hint of the region
+        // that contains changed content relative to the previously-presented
+        // image.  The implementation can use this hint in order to save
+        // work/power (by only copying the region in the hint).  The
+        // implementation is free to ignore the hint though, and so we must
+        // ensure that the entire image has the correctly-drawn content.
+        const uint32_t eighthOfWidth = s_render_width / 8;
+        const uint32_t eighthOfHeight = s_render_height / 8;
+
+        rect.offset.x = eighthOfWidth;
+        rect.offset.y = eighthOfHeight;
+        rect.extent.width = eighthOfWidth * 6;
+        rect.extent.height = eighthOfHeight * 6;
+        rect.layer = 0;
+
+        region.rectangleCount = 1;
+        region.pRectangles = &rect;
+
+        regions.sType = VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR;
+        regions.pNext = present.pNext;
+        regions.swapchainCount = present.swapchainCount;
+        regions.pRegions = &region;
+
+        present.pNext = &regions;
+    }
+
+    res = vkQueuePresentKHR(s_presentQueue, &present);
+    switch (res)
+    {
+    case VK_SUCCESS:
+        break;
+
+    case VK_ERROR_OUT_OF_DATE_KHR:
+        // s_swapchain is out of date (e.g. the window was resized) and must be recreated:
+        DoResize();
+        break;
+
+    case VK_SUBOPTIMAL_KHR:
+        // s_swapchain is not as optimal as it could be, but the platform's presentation engine will still present the image correctly.
+        break;
+
+    case VK_ERROR_SURFACE_LOST_KHR:
+        if (!CreateVulkanSurface(hInstance, hWnd)) return;
+        DoResize();
+        break;
+
+    default:
+        printf("vkQueuePresentKHR failed: %d\n", res);
+        break;
+    }
+}
+
+static void RunTheRendering(HINSTANCE hInstance, HWND hWnd, int currFrameIndex)
+{
+    if (!s_isRenderPrepared) return;
+
+    DrawObjects(hInstance, hWnd, currFrameIndex);
+
+    if (s_firstFrameTime == 0)
+    {
+        s_firstFrameTime = GetCurrentTimeNanoseconds();
+        PrintStartupReport();
+    }
+}
+#endif // _WIN32
+
+// Renders one frame into the headless render target of `currFrameIndex`.
+// `pFenceWaitTime` receives the nanoseconds blocked on waiting for the frame slot to become available.
+// `pGpuTime` receives the GPU time in milliseconds of the previous frame rendered in the same slot, or a negative value if unavailable.
+// `pRecordTime` receives the nanoseconds spent on resetting the command pool and recording the draw commands, 0 if they are pre-recorded.
+static bool DrawHeadlessFrame(uint32_t currFrameIndex, uint64_t* pFenceWaitTime, double* pGpuTime, uint64_t* pRecordTime)
+{
+    const uint64_t waitBeginTime = GetCurrentTimeNanoseconds();
+    VkResult res = vkWaitForFences(s_specDevice, 1, &s_presentFences[currFrameIndex], VK_TRUE, UINT64_MAX);
+    *pFenceWaitTime = GetCurrentTimeNanoseconds() - waitBeginTime;
+    if (res != VK_SUCCESS)
+    {
+        printf("vkWaitForFences for headless frame @%u failed: %d\n", currFrameIndex, res);
+        return false;
+    }
+
+    // The timestamps MUST BE fetched before the command buffer is submitted again.
+    if (!ReadGpuFrameTime(currFrameIndex, pGpuTime)) {
+        *pGpuTime = -1.0;
+    }
+
+    vkResetFences(s_specDevice, 1, &s_presentFences[currFrameIndex]);
+    // The fence also signals every earlier submission to the queue
+    CollectDeletionQueue(&s_deletionQueue, s_frameSlotValues[currFrameIndex]);
+    // The budgets change with what the other processes allocate
+    UpdateDeviceMemoryBudget(&s_memoryTracker);
+
+    if (!UpdateUniformData() || !StreamTextureLevels()) {
+        return false;
+    }
+
+    // Each frame in flight owns one headless render target, so the image index is just the frame index.
+    // The fence above guarantees that the previous draw of this slot no longer reads its transforms.
+    // On an async compute queue, the animation overlaps the draw of the previous frame.
+    if (s_useGpuAnimation && !SubmitObjectAnimation(currFrameIndex, currFrameIndex, VK_NULL_HANDLE)) {
+        return false;
+    }
+
+    VkCommandBuffer drawCmdBuf = s_swapchainImageResources[currFrameIndex].cmd_buf;
+    *pRecordTime = 0;
+    if (s_recordCommandsPerFrame)
+    {
+        const uint64_t recordBeginTime = GetCurrentTimeNanoseconds();
+        drawCmdBuf = RecordFrameDrawCommands(currFrameIndex, currFrameIndex, s_recordThreadCount);
+        if (drawCmdBuf == VK_NULL_HANDLE) return false;
+        *pRecordTime = GetCurrentTimeNanoseconds() - recordBeginTime;
+    }
+
+    const VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_VERTEX_SHADER_BIT;
+    const VkSubmitInfo submit_info = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = s_useGpuAnimation ? 1 : 0,
+        .pWaitSemaphores = &s_animationCompleteSemaphores[currFrameIndex],
+        .pWaitDstStageMask = &waitDstStageMask,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &drawCmdBuf,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    res = vkQueueSubmit(s_graphicsQueue, 1, &submit_info, s_presentFences[currFrameIndex]);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for headless frame failed: %d\n", res);
+        return false;
+    }
+    s_frameSlotValues[currFrameIndex] = ++s_submittedFrameValue;
+
+    return true;
+}
+
+static bool CreateHeadlessFrameCapture(void)
+{
+    const FrameCaptureCreateInfo createInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .pMemoryProperties = &s_deviceCapabilities.memoryProperties,
+        .pMemoryTracker = &s_memoryTracker,
+        .queue = s_graphicsQueue,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .width = s_render_width,
+        .height = s_render_height,
+        .rowPitchAlignment = s_deviceCapabilities.properties.limits.optimalBufferCopyRowPitchAlignment,
+        .slotCount = s_captureSlotCount,
+        .pJobSystem = &s_jobSystem,
+        .output = FRAME_CAPTURE_OUTPUT_IMAGE_FILES,
+        .fileFormat = s_captureFileFormat,
+        .path = s_captureFilePrefix,
+        .frameRate = 0,
+        .yuvShaderModule = VK_NULL_HANDLE
+    };
+    if (!CreateFrameCapture(&createInfo, &s_frameCapture)) return false;
+
+    // The main thread only submits the encode jobs
+    if (s_jobSystem.workerCount < 2) {
+        puts("The job system has a single worker, so the captured frames are encoded on the rendering thread whenever the capture ring is full.");
+    }
+    printf("Capturing every frame into %u %s readback buffers as %s files\n", s_frameCapture.info.slotCount,
+        s_frameCapture.isMemoryCoherent ? "coherent" : "cached", GetImageFileFormatName(s_captureFileFormat));
+    return true;
+}
+
+static bool CreateHeadlessFrameStream(void)
+{
+    VkShaderModule yuvShaderModule = VK_NULL_HANDLE;
+    if (s_convertStreamOnGpu && !CreateShaderModule("rgb_to_yuv.comp.spv", &yuvShaderModule)) return false;
+
+    const FrameCaptureCreateInfo createInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .pMemoryProperties = &s_deviceCapabilities.memoryProperties,
+        .pMemoryTracker = &s_memoryTracker,
+        .queue = s_graphicsQueue,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .width = s_render_width,
+        .height = s_render_height,
+        .rowPitchAlignment = s_deviceCapabilities.properties.limits.optimalBufferCopyRowPitchAlignment,
+        .slotCount = s_captureSlotCount,
+        .pJobSystem = &s_jobSystem,
+        .output = s_streamOutput,
+        .fileFormat = IMAGE_FILE_FORMAT_PNG,
+        .path = s_streamPath,
+        .frameRate = s_streamFrameRate,
+        .yuvShaderModule = yuvShaderModule
+    };
+    printf("Opening the frame stream %s...\n", s_streamPath);
+    const bool isCreated = CreateFrameCapture(&createInfo, &s_frameStream);
+    if (yuvShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(s_specDevice, yuvShaderModule, s_pAllocator);
+    }
+    if (!isCreated) return false;
+
+    printf("Streaming every frame as %s through %u %s readback buffers of %u bytes%s\n", GetFrameCaptureFormatName(&s_frameStream),
+        s_frameStream.info.slotCount, s_frameStream.isMemoryCoherent ? "coherent" : "cached", s_frameStream.readbackSize,
+        s_frameStream.isYuvOnGpu ? ", converted to YUV on the GPU" : "");
+    return true;
+}
+
+static bool CreateHeadlessFrameExport(void)
+{
+    // The consumer opens the same device with the same driver
+    VkPhysicalDeviceIDProperties idProps = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES,
+        .pNext = NULL
+    };
+    VkPhysicalDeviceProperties2 properties2 = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+        .pNext = &idProps
+    };
+    vkGetPhysicalDeviceProperties2(s_currPhysicalDevice, &properties2);
+
+    VkImage images[MAX_FRAME_LAG];
+    VkDeviceMemory memories[MAX_FRAME_LAG];
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        images[i] = s_swapchainImageResources[i].image;
+        memories[i] = s_swapchainImageResources[i].image_memory;
+    }
+
+    const FrameExportCreateInfo createInfo = {
+        .device = s_specDevice,
+        .pAllocator = s_pAllocator,
+        .queue = s_graphicsQueue,
+        .queueFamilyIndex = s_graphicsQueueFamilyIndex,
+        .socketPath = s_exportSocketPath,
+        .imageCount = s_swapchainImageCount,
+        .pImages = images,
+        .pMemories = memories,
+        .pAllocationSizes = s_exportAllocationSizes,
+        .memoryTypeIndex = s_exportMemoryTypeIndex,
+        .width = s_render_width,
+        .height = s_render_height,
+        .format = s_surfaceFormat.format,
+        .usage = GetHeadlessRenderTargetUsage(),
+        .memoryHandleType = s_exportMemoryHandleType,
+        .semaphoreHandleType = s_exportSemaphoreHandleType,
+        .pDeviceUUID = idProps.deviceUUID,
+        .pDriverUUID = idProps.driverUUID
+    };
+    if (!CreateFrameExport(&createInfo, &s_frameExport)) return false;
+
+    printf("Exporting %u render targets to the frame consumer, which reads every frame in place\n", s_frameExport.info.imageCount);
+    return true;
+}
+
+static void DestroyVulkanAssets(void)
+{
+    vkDeviceWaitIdle(s_specDevice);
+
+    // Before the job system, which encodes the frames still being captured
+    DestroyFrameCapture(&s_frameCapture);
+    DestroyFrameCapture(&s_frameStream);
+    // Before the render targets, which the consumer may still have imported
+    DestroyFrameExport(&s_frameExport);
+    // The device is idle, so the objects still waiting for their frames are destroyed at once.
+    DestroyDeletionQueue(&s_deletionQueue);
+
+    // Wait for fences from present operations
+    for (uint32_t i = 0; i < s_frameLag; i++)
+    {
+        if (s_presentFences[i] != VK_NULL_HANDLE)
+        {
+            vkWaitForFences(s_specDevice, 1, &s_presentFences[i], VK_TRUE, UINT64_MAX);
+            vkDestroyFence(s_specDevice, s_presentFences[i], s_pAllocator);
+        }
+        if (s_imageAcquiredSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(s_specDevice, s_imageAcquiredSemaphores[i], s_pAllocator);
+        }
+        if (s_drawCompleteSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(s_specDevice, s_drawCompleteSemaphores[i], s_pAllocator);
+        }
+        if (s_imageOwnershipSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(s_specDevice, s_imageOwnershipSemaphores[i], s_pAllocator);
+        }
+        if (s_animationCompleteSemaphores[i] != VK_NULL_HANDLE) {
+            vkDestroySemaphore(s_specDevice, s_animationCompleteSemaphores[i], s_pAllocator);
+        }
+    }
+
+    if (s_timestampQueryPool != VK_NULL_HANDLE) {
+        vkDestroyQueryPool(s_specDevice, s_timestampQueryPool, s_pAllocator);
+    }
+    if (s_descPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(s_specDevice, s_descPool, s_pAllocator);
+    }
+    if (s_descriptorBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, s_descriptorBuffer, s_pAllocator);
+    }
+    if (s_descriptorBufferMemory != VK_NULL_HANDLE) {
+        // Unmapped implicitly
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_descriptorBufferMemory);
+    }
+    for (size_t i = 0; i < sizeof(s_pipelines) / sizeof(s_pipelines[0]); ++i)
+    {
+        if (s_pipelineCaches[i] != VK_NULL_HANDLE) {
+            vkDestroyPipelineCache(s_specDevice, s_pipelineCaches[i], s_pAllocator);
+        }
+        if (s_pipelines[i] != VK_NULL_HANDLE) {
+            vkDestroyPipeline(s_specDevice, s_pipelines[i], s_pAllocator);
+        }
+    }
+    if (s_render_pass != VK_NULL_HANDLE) {
+        vkDestroyRenderPass(s_specDevice, s_render_pass, s_pAllocator);
+    }
+    if (s_pipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(s_specDevice, s_pipelineLayout, s_pAllocator);
+    }
+    if (s_descSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(s_specDevice, s_descSetLayout, s_pAllocator);
+    }
+    if (s_animationDescPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(s_specDevice, s_animationDescPool, s_pAllocator);
+    }
+    if (s_animationPipeline != VK_NULL_HANDLE) {
+        vkDestroyPipeline(s_specDevice, s_animationPipeline, s_pAllocator);
+    }
+    if (s_animationPipelineLayout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(s_specDevice, s_animationPipelineLayout, s_pAllocator);
+    }
+    if (s_animationDescSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(s_specDevice, s_animationDescSetLayout, s_pAllocator);
+    }
+
+    for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+    {
+        if (s_swapchainImageResources[i].framebuffer != VK_NULL_HANDLE) {
+            vkDestroyFramebuffer(s_specDevice, s_swapchainImageResources[i].framebuffer, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].view != VK_NULL_HANDLE) {
+            vkDestroyImageView(s_specDevice, s_swapchainImageResources[i].view, s_pAllocator);
+        }
+        // Headless render targets are not owned by a swapchain
+        if (s_isHeadless && s_swapchainImageResources[i].image != VK_NULL_HANDLE) {
+            vkDestroyImage(s_specDevice, s_swapchainImageResources[i].image, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].image_memory != VK_NULL_HANDLE) {
+            FreeTrackedDeviceMemory(&s_memoryTracker, s_swapchainImageResources[i].image_memory);
+        }
+        if (s_swapchainImageResources[i].cmd_buf != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(s_specDevice, s_commandPool, 1, &s_swapchainImageResources[i].cmd_buf);
+        }
+        if (s_swapchainImageResources[i].uniform_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].uniform_buffer, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].uniform_memory != VK_NULL_HANDLE) {
+            FreeTrackedDeviceMemory(&s_memoryTracker, s_swapchainImageResources[i].uniform_memory);
+        }
+        if (s_swapchainImageResources[i].coords_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].coords_buffer, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].color_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].color_buffer, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].vertex_memory != VK_NULL_HANDLE) {
+            FreeTrackedDeviceMemory(&s_memoryTracker, s_swapchainImageResources[i].vertex_memory);
+        }
+        if (s_swapchainImageResources[i].transform_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].transform_buffer, s_pAllocator);
+        }
+        if (s_swapchainImageResources[i].transform_memory != VK_NULL_HANDLE) {
+            FreeTrackedDeviceMemory(&s_memoryTracker, s_swapchainImageResources[i].transform_memory);
+        }
+        if (s_swapchainImageResources[i].animation_params_buffer != VK_NULL_HANDLE) {
+            vkDestroyBuffer(s_specDevice, s_swapchainImageResources[i].animation_params_buffer, s_pAllocator);
+        }
+        // Freeing the memory also unmaps it
+        if (s_swapchainImageResources[i].animation_params_memory != VK_NULL_HANDLE) {
+            FreeTrackedDeviceMemory(&s_memoryTracker, s_swapchainImageResources[i].animation_params_memory);
+        }
+    }
+    if (s_objectStateBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, s_objectStateBuffer, s_pAllocator);
+    }
+    if (s_objectStateMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_objectStateMemory);
+    }
+    if (s_meshVertexBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, s_meshVertexBuffer, s_pAllocator);
+    }
+    if (s_meshVertexMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_meshVertexMemory);
+    }
+    if (s_meshIndexBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, s_meshIndexBuffer, s_pAllocator);
+    }
+    if (s_meshIndexMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_meshIndexMemory);
+    }
+    // Still mapped only if the startup failed before the mesh was streamed
+    if (s_meshFile.pHeader != NULL) {
+        CloseMeshFile(&s_meshFile);
+    }
+    DestroyObjectStore(&s_sceneObjectStore);
+    free(s_animatedObjectStates);
+    s_animatedObjectStates = NULL;
+    free(s_visibleObjectIndices);
+    s_visibleObjectIndices = NULL;
+    free(s_cullBatchVisibleCounts);
+    s_cullBatchVisibleCounts = NULL;
+    // Still alive if the texture has not been fully streamed in
+    DestroyUploadManager(&s_textureUploadManager);
+    if (s_textureFile.mapping.pData != NULL) {
+        CloseTextureFile(&s_textureFile);
+    }
+    if (s_textureSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(s_specDevice, s_textureSampler, s_pAllocator);
+    }
+    if (s_textureView != VK_NULL_HANDLE) {
+        vkDestroyImageView(s_specDevice, s_textureView, s_pAllocator);
+    }
+    if (s_textureImage != VK_NULL_HANDLE) {
+        vkDestroyImage(s_specDevice, s_textureImage, s_pAllocator);
+    }
+    if (s_textureMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_textureMemory);
+    }
+    if (s_hostUniformBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(s_specDevice, s_hostUniformBuffer, s_pAllocator);
+    }
+    if (s_hostUniformMemory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_hostUniformMemory);
+    }
+    if (s_depthResource.image_view != VK_NULL_HANDLE) {
+        vkDestroyImageView(s_specDevice, s_depthResource.image_view, s_pAllocator);
+    }
+    if (s_depthResource.image != VK_NULL_HANDLE) {
+        vkDestroyImage(s_specDevice, s_depthResource.image, s_pAllocator);
+    }
+    if (s_depthResource.device_memory != VK_NULL_HANDLE) {
+        FreeTrackedDeviceMemory(&s_memoryTracker, s_depthResource.device_memory);
+    }
+    if (s_commandPool != VK_NULL_HANDLE)
+    {
+        if (s_commandBuffers[0] != VK_NULL_HANDLE) {
+            vkFreeCommandBuffers(s_specDevice, s_commandPool, (uint32_t)(sizeof(s_commandBuffers) / sizeof(s_commandBuffers[0])), s_commandBuffers);
+        }
+        vkDestroyCommandPool(s_specDevice, s_commandPool, s_pAllocator);
+    }
+    // Left over only if the startup failed before the init command was flushed
+    DestroyTransferQueueUploadResources();
+    DestroyUploadManager(&s_uploadManager);
+    for (uint32_t i = 0; i < s_frameLag; ++i)
+    {
+        if (s_frameCommandPools[i] != VK_NULL_HANDLE) {
+            vkDestroyCommandPool(s_specDevice, s_frameCommandPools[i], s_pAllocator);
+        }
+        // The secondary command buffers are freed together with their pools
+        for (uint32_t j = 0; j < MAX_JOB_WORKER_COUNT; ++j)
+        {
+            if (s_workerCommandPools[i][j].commandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(s_specDevice, s_workerCommandPools[i][j].commandPool, s_pAllocator);
+            }
+        }
+    }
+    if (s_computeCommandPool != VK_NULL_HANDLE) {
+        // The animation command buffers are freed together with their pool
+        vkDestroyCommandPool(s_specDevice, s_computeCommandPool, s_pAllocator);
+    }
+    if (s_presentCommandPool != VK_NULL_HANDLE)
+    {
+        for (uint32_t i = 0; i < s_swapchainImageCount; ++i)
+        {
+            if (s_swapchainImageResources[i].graphics_to_present_cmd_buf != VK_NULL_HANDLE) {
+                vkFreeCommandBuffers(s_specDevice, s_presentCommandPool, 1, &s_swapchainImageResources[i].graphics_to_present_cmd_buf);
+            }
+        }
+        vkDestroyCommandPool(s_specDevice, s_presentCommandPool, s_pAllocator);
+    }
+    if (s_swapchain != VK_NULL_HANDLE) {
+        vkDestroySwapchainKHR(s_specDevice, s_swapchain, s_pAllocator);
+    }
+    // Reports the allocations that have not been freed
+    DestroyDeviceMemoryTracker(&s_memoryTracker);
+    if (s_specDevice != VK_NULL_HANDLE) {
+        vkDestroyDevice(s_specDevice, s_pAllocator);
+    }
+    if (s_surface != VK_NULL_HANDLE) {
+        vkDestroySurfaceKHR(s_instance, s_surface, s_pAllocator);
+    }
+    if (s_instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(s_instance, s_pAllocator);
+    }
+    // Nothing created with the callbacks is left
+    DestroyHostAllocator(&s_hostAllocator);
+    DestroyJobSystem(&s_jobSystem);
+}
+
+static bool ExecuteStartupTask(void* pUserData)
+{
+    switch ((enum STARTUP_TASK_ID)(uintptr_t)pUserData)
+    {
+    case STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES:
+        return CreateFencesAndSemaphores();
+    case STARTUP_TASK_CREATE_COMMAND_BUFFERS:
+        return CreateCommandBufferAndBeginCommand();
+    case STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL:
+        return CreateTimestampQueryPool();
+    case STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS:
+        return CreateVertexAndUniformBuffersAndMemories();
+    case STARTUP_TASK_UPLOAD_VERTEX_DATA:
+        return CreateStartupUploadManager() && UploadVertexData();
+    case STARTUP_TASK_STREAM_MESH:
+        return StreamMeshToDevice();
+    case STARTUP_TASK_SUBMIT_UPLOADS:
+        return SubmitStartupUploads();
+    case STARTUP_TASK_CREATE_ANIMATION_PIPELINE:
+        return CreateAnimationPipeline();
+    case STARTUP_TASK_CREATE_ANIMATION_RESOURCES:
+        return CreateAnimationResources();
+    case STARTUP_TASK_RECORD_ANIMATION_RESET:
+        // The objects are placed once in the init command buffer, and every frame advances them from then on.
+        RecordAnimationDispatch(s_commandBuffers[0], 0, true);
+        return true;
+    case STARTUP_TASK_LOAD_TEXTURE:
+        return LoadTexture();
+    case STARTUP_TASK_CREATE_DEPTH_RESOURCE:
+        return CreateDepthReource();
+    case STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT:
+        return CreateDescriptorSetAndPipelineLayout();
+    case STARTUP_TASK_CREATE_RENDER_PASS:
+        return CreateRenderPass();
+    case STARTUP_TASK_CREATE_FLATTEN_PIPELINE:
+        return CreateFlattenPipeline();
+    case STARTUP_TASK_CREATE_GRADIENT_PIPELINE:
+        return CreateGradientPipeline();
+    case STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET:
+        return CreateDescriptorPoolAndSet();
+    case STARTUP_TASK_CREATE_FRAMEBUFFERS:
+        return CreateFramebuffers();
+    case STARTUP_TASK_BUILD_DRAW_COMMANDS:
+        // Nothing to pre-record if the draw commands are recorded per frame
+        for (uint32_t i = 0; i < s_swapchainImageCount && !s_recordCommandsPerFrame; ++i)
+        {
+            if (!BuildCommandForDraw(s_swapchainImageResources[i].cmd_buf, i, VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT, NULL, 0)) {
+                return false;
+            }
+        }
+        return true;
+    case STARTUP_TASK_FLUSH_INIT_COMMAND:
+        // Prepare functions above may generate pipeline commands that need to be flushed before beginning the render loop.
+        return FlushInitCommand();
+    default:
+        return false;
+    }
+}
+
+// Creates all render resources. Independent steps run in parallel as a task graph,
+// so the startup time is bounded by the critical path instead of the sum of all the steps.
+static bool PrepareRenderResources(void)
+{
+    // The pipelines are created from the vertex layout in the mesh header, so the file is mapped before any task starts.
+    if (s_meshFilePath != NULL)
+    {
+        const uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!OpenMeshFileForRendering()) return false;
+        RecordStartupPhase("OpenMeshFile", phaseBeginTime);
+    }
+    // The bounds are read from the mesh before it is streamed, and the pre-recorded draw commands only draw the objects visible now.
+    {
+        const uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!CreateSceneObjectStore()) return false;
+        CullSceneObjects();
+        RecordStartupPhase("CullSceneObjects", phaseBeginTime);
+    }
+    // The mip level count decides the image creation, and an unsupported format drops the texture before the layouts are created.
+    if (s_texturePath != NULL)
+    {
+        const uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!OpenTextureFileForRendering()) return false;
+        RecordStartupPhase("OpenTextureFile", phaseBeginTime);
+    }
+
+#define STARTUP_TASK_BIT(id)    (1ULL << (id))
+
+    // Rules for the dependencies besides the data flow:
+    // - The init command buffer and the draw command buffers share `s_commandPool`, which MUST BE externally synchronized,
+    //   so everything recording into them is serialized: command buffers -> timestamp reset -> animation reset -> draw commands.
+    // - FlushInitCommand submits the init command buffer, so it runs last.
+    // - All initial uploads go through s_uploadManager, which is not thread safe, so its users are serialized:
+    //   vertex data -> mesh -> submit. With a separate transfer queue the batches are submitted as soon as they are full,
+    //   so the copies execute while the pipelines are being created, and FlushInitCommand then acquires the uploaded resources.
+    //   Otherwise the batches are submitted on the graphics queue, which MUST BE externally synchronized too.
+    // - The animation commands are recorded into their own command pool, only the reset of the object states
+    //   is recorded into the init command buffer and therefore joins the serialized chain above.
+    // - The texture load records its layout transitions or mipmap generation into the init command buffer and joins that chain
+    //   after the animation reset. It submits its first levels on the graphics queue, so it also waits for SubmitUploads.
+    static const uint64_t dependencies[STARTUP_TASK_COUNT] = {
+        [STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES] = 0,
+        [STARTUP_TASK_CREATE_COMMAND_BUFFERS] = 0,
+        [STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_COMMAND_BUFFERS),
+        [STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS] = 0,
+        [STARTUP_TASK_UPLOAD_VERTEX_DATA] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS),
+        [STARTUP_TASK_STREAM_MESH] = STARTUP_TASK_BIT(STARTUP_TASK_UPLOAD_VERTEX_DATA),
+        [STARTUP_TASK_SUBMIT_UPLOADS] = STARTUP_TASK_BIT(STARTUP_TASK_UPLOAD_VERTEX_DATA) |
+                                        STARTUP_TASK_BIT(STARTUP_TASK_STREAM_MESH),
+        [STARTUP_TASK_CREATE_ANIMATION_PIPELINE] = 0,
+        [STARTUP_TASK_CREATE_ANIMATION_RESOURCES] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_ANIMATION_PIPELINE),
+        [STARTUP_TASK_RECORD_ANIMATION_RESET] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_COMMAND_BUFFERS) |
+                                                STARTUP_TASK_BIT(STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL) |
+                                                STARTUP_TASK_BIT(STARTUP_TASK_CREATE_ANIMATION_RESOURCES),
+        [STARTUP_TASK_LOAD_TEXTURE] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_COMMAND_BUFFERS) |
+                                      STARTUP_TASK_BIT(STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL) |
+                                      STARTUP_TASK_BIT(STARTUP_TASK_SUBMIT_UPLOADS) |
+                                      STARTUP_TASK_BIT(STARTUP_TASK_RECORD_ANIMATION_RESET),
+        [STARTUP_TASK_CREATE_DEPTH_RESOURCE] = 0,
+        [STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT] = 0,
+        [STARTUP_TASK_CREATE_RENDER_PASS] = 0,
+        [STARTUP_TASK_CREATE_FLATTEN_PIPELINE] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT) |
+                                                 STARTUP_TASK_BIT(STARTUP_TASK_CREATE_RENDER_PASS),
+        [STARTUP_TASK_CREATE_GRADIENT_PIPELINE] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT) |
+                                                  STARTUP_TASK_BIT(STARTUP_TASK_CREATE_RENDER_PASS),
+        [STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS) |
+                                                        STARTUP_TASK_BIT(STARTUP_TASK_CREATE_ANIMATION_RESOURCES) |
+                                                        STARTUP_TASK_BIT(STARTUP_TASK_LOAD_TEXTURE) |
+                                                        STARTUP_TASK_BIT(STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT),
+        [STARTUP_TASK_CREATE_FRAMEBUFFERS] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_DEPTH_RESOURCE) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_RENDER_PASS),
+        [STARTUP_TASK_BUILD_DRAW_COMMANDS] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_COMMAND_BUFFERS) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_STREAM_MESH) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_RECORD_ANIMATION_RESET) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_LOAD_TEXTURE) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_FLATTEN_PIPELINE) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_GRADIENT_PIPELINE) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET) |
+                                             STARTUP_TASK_BIT(STARTUP_TASK_CREATE_FRAMEBUFFERS),
+        [STARTUP_TASK_FLUSH_INIT_COMMAND] = STARTUP_TASK_BIT(STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES) |
+                                            STARTUP_TASK_BIT(STARTUP_TASK_SUBMIT_UPLOADS) |
+                                            STARTUP_TASK_BIT(STARTUP_TASK_BUILD_DRAW_COMMANDS)
+    };
+    static const char* const taskNames[STARTUP_TASK_COUNT] = {
+        [STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES] = "CreateFencesAndSemaphores",
+        [STARTUP_TASK_CREATE_COMMAND_BUFFERS] = "CreateCommandBufferAndBeginCommand",
+        [STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL] = "CreateTimestampQueryPool",
+        [STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS] = "CreateVertexAndUniformBuffersAndMemories",
+        [STARTUP_TASK_UPLOAD_VERTEX_DATA] = "UploadVertexData",
+        [STARTUP_TASK_STREAM_MESH] = "StreamMeshToDevice",
+        [STARTUP_TASK_SUBMIT_UPLOADS] = "SubmitUploads",
+        [STARTUP_TASK_CREATE_ANIMATION_PIPELINE] = "CreateAnimationPipeline",
+        [STARTUP_TASK_CREATE_ANIMATION_RESOURCES] = "CreateAnimationResources",
+        [STARTUP_TASK_RECORD_ANIMATION_RESET] = "RecordAnimationDispatch(reset)",
+        [STARTUP_TASK_LOAD_TEXTURE] = "LoadTexture",
+        [STARTUP_TASK_CREATE_DEPTH_RESOURCE] = "CreateDepthReource",
+        [STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT] = "CreateDescriptorSetAndPipelineLayout",
+        [STARTUP_TASK_CREATE_RENDER_PASS] = "CreateRenderPass",
+        [STARTUP_TASK_CREATE_FLATTEN_PIPELINE] = "CreateGraphicsPipeline(flatten)",
+        [STARTUP_TASK_CREATE_GRADIENT_PIPELINE] = "CreateGraphicsPipeline(gradient)",
+        [STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET] = "CreateDescriptorPoolAndSet",
+        [STARTUP_TASK_CREATE_FRAMEBUFFERS] = "CreateFramebuffers",
+        [STARTUP_TASK_BUILD_DRAW_COMMANDS] = "BuildCommandForDraw",
+        [STARTUP_TASK_FLUSH_INIT_COMMAND] = "FlushInitCommand"
+    };
+
+    // Timestamp queries are only used by the headless benchmark, the mesh is only streamed with --mesh,
+    // and the animation tasks only run for the GPU animation.
+    // Skipping a task keeps its dependents valid, since an absent node simply has no bit set in `graphIndices`.
+    const bool isTaskEnabled[STARTUP_TASK_COUNT] = {
+        [STARTUP_TASK_CREATE_FENCES_AND_SEMAPHORES] = true,
+        [STARTUP_TASK_CREATE_COMMAND_BUFFERS] = true,
+        [STARTUP_TASK_CREATE_TIMESTAMP_QUERY_POOL] = s_isHeadless,
+        [STARTUP_TASK_CREATE_VERTEX_AND_UNIFORM_BUFFERS] = true,
+        [STARTUP_TASK_UPLOAD_VERTEX_DATA] = true,
+        [STARTUP_TASK_STREAM_MESH] = s_meshFilePath != NULL,
+        [STARTUP_TASK_SUBMIT_UPLOADS] = true,
+        [STARTUP_TASK_CREATE_ANIMATION_PIPELINE] = s_useGpuAnimation,
+        [STARTUP_TASK_CREATE_ANIMATION_RESOURCES] = s_useGpuAnimation,
+        [STARTUP_TASK_RECORD_ANIMATION_RESET] = s_useGpuAnimation,
+        [STARTUP_TASK_LOAD_TEXTURE] = s_texturePath != NULL,
+        [STARTUP_TASK_CREATE_DEPTH_RESOURCE] = true,
+        [STARTUP_TASK_CREATE_DESCRIPTOR_SET_AND_PIPELINE_LAYOUT] = true,
+        [STARTUP_TASK_CREATE_RENDER_PASS] = true,
+        [STARTUP_TASK_CREATE_FLATTEN_PIPELINE] = true,
+        [STARTUP_TASK_CREATE_GRADIENT_PIPELINE] = true,
+        [STARTUP_TASK_CREATE_DESCRIPTOR_POOL_AND_SET] = true,
+        [STARTUP_TASK_CREATE_FRAMEBUFFERS] = true,
+        [STARTUP_TASK_BUILD_DRAW_COMMANDS] = true,
+        [STARTUP_TASK_FLUSH_INIT_COMMAND] = true
+    };
+
+    TaskGraphNode nodes[STARTUP_TASK_COUNT];
+    uint32_t graphIndices[STARTUP_TASK_COUNT];
+    uint32_t nodeCount = 0;
+    for (uint32_t task = 0; task < STARTUP_TASK_COUNT; ++task)
+    {
+        graphIndices[task] = UINT32_MAX;
+        if (!isTaskEnabled[task]) continue;
+
+        uint64_t dependencyMask = 0;
+        for (uint32_t dep = 0; dep < task; ++dep)
+        {
+            if ((dependencies[task] & STARTUP_TASK_BIT(dep)) != 0 && graphIndices[dep] != UINT32_MAX) {
+                dependencyMask |= 1ULL << graphIndices[dep];
+            }
+        }
+
+        graphIndices[task] = nodeCount;
+        nodes[nodeCount++] = (TaskGraphNode){
+            .name = taskNames[task],
+            .function = ExecuteStartupTask,
+            .pUserData = (void*)(uintptr_t)task,
+            .dependencyMask = dependencyMask
+        };
+    }
+
+#undef STARTUP_TASK_BIT
+
+    uint32_t workerCount = s_startupWorkerCount;
+    if (workerCount == 0) {
+        workerCount = min(GetLogicalProcessorCount(), (uint32_t)MAX_STARTUP_WORKER_COUNT);
+    }
+
+    const bool succeeded = RunTaskGraph(nodes, nodeCount, workerCount);
+
+    for (uint32_t i = 0; i < nodeCount && s_startupPhaseCount < MAX_STARTUP_PHASE_COUNT; ++i)
+    {
+        if (!nodes[i].isExecuted) continue;
+
+        s_startupPhases[s_startupPhaseCount++] = (StartupPhaseTiming){
+            .name = nodes[i].name,
+            .beginTime = nodes[i].beginTime - s_startupBeginTime,
+            .endTime = nodes[i].endTime - s_startupBeginTime,
+            .workerIndex = nodes[i].workerIndex
+        };
+    }
+    s_startupCriticalPathTime = GetTaskGraphCriticalPathTime(nodes, nodeCount);
+
+    if (!succeeded) return false;
+
+    s_isRenderPrepared = true;
+
+    return true;
+}
+
+static const char* GetPresentModeName(VkPresentModeKHR presentMode)
+{
+    switch (presentMode)
+    {
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo-relaxed";
+    default:
+        return "unknown";
+    }
+}
+
+// The stalls are part of the CPU frame time, the drain follows the last frame. The encode times of a stream are its write times.
+static void WriteFrameCaptureJSON(FILE* fp, const char* name, const FrameCapture* pCapture, uint64_t drainTime)
+{
+    const uint32_t finishedFrameCount = pCapture->writtenFrameCount + pCapture->failedFrameCount;
+    fprintf(fp, ",\n  \"%s\": { \"format\": \"%s\", \"slots\": %u, \"readback_bytes_per_frame\": %u, \"gpu_yuv\": %s, \"captured\": %u, \"written\": %u, \"failed\": %u, \"stalls\": %u, \"stall_ms\": %.3f, \"encode_mean_ms\": %.3f, \"encode_max_ms\": %.3f, \"drain_ms\": %.3f }",
+        name, GetFrameCaptureFormatName(pCapture), pCapture->info.slotCount, pCapture->readbackSize, pCapture->isYuvOnGpu ? "true" : "false",
+        pCapture->capturedFrameCount, pCapture->writtenFrameCount, pCapture->failedFrameCount, pCapture->stallCount, pCapture->stallTime / 1000000.0,
+        finishedFrameCount > 0 ? pCapture->totalEncodeTime / 1000000.0 / finishedFrameCount : 0.0, pCapture->maxEncodeTime / 1000000.0,
+        drainTime / 1000000.0);
+}
+
+// The counts per frame are over the measured frames, the other values over the whole run up to the report.
+static void WriteHostAllocationsJSON(FILE* fp, uint32_t frameCount)
+{
+    HostAllocationStatistics statistics;
+    GetHostAllocationStatistics(&s_hostAllocator, &statistics);
+
+    fprintf(fp, ",\n  \"host_allocations\": {\n");
+    fprintf(fp, "    \"arena\": { \"size\": %u, \"allocations\": %llu, \"overflows\": %llu, \"resets\": %llu, \"peak_bytes\": %llu },\n",
+        s_hostAllocator.info.arenaSize, (unsigned long long)statistics.arenaAllocationCount, (unsigned long long)statistics.arenaOverflowCount,
+        (unsigned long long)statistics.arenaResetCount, (unsigned long long)statistics.arenaPeakBytes);
+    fprintf(fp, "    \"pools\": { \"allocations\": %llu, \"slabs\": %llu, \"allocations_per_size_class\": [",
+        (unsigned long long)statistics.poolAllocationCount, (unsigned long long)statistics.poolSlabCount);
+    for (uint32_t i = 0; i < HOST_POOL_SIZE_CLASS_COUNT; ++i) {
+        fprintf(fp, "%s%llu", i > 0 ? ", " : " ", (unsigned long long)statistics.poolAllocationCounts[i]);
+    }
+    fprintf(fp, " ] },\n");
+    fprintf(fp, "    \"heap_allocations\": %llu,\n", (unsigned long long)statistics.heapAllocationCount);
+    fprintf(fp, "    \"scopes\": [\n");
+    for (uint32_t i = 0; i < HOST_ALLOCATION_SCOPE_COUNT; ++i)
+    {
+        const HostAllocationScopeStatistics* pScope = &statistics.scopes[i];
+        const HostAllocationScopeStatistics* pBegin = &s_frameBeginHostAllocations.scopes[i];
+        const HostAllocationScopeStatistics* pEnd = &s_frameEndHostAllocations.scopes[i];
+        const uint64_t frameAllocationCount = pEnd->allocationCount + pEnd->reallocationCount - pBegin->allocationCount - pBegin->reallocationCount;
+        fprintf(fp, "      { \"scope\": \"%s\", \"allocations\": %llu, \"reallocations\": %llu, \"frees\": %llu, \"total_bytes\": %llu, \"current_bytes\": %llu, \"peak_bytes\": %llu, \"internal_allocations\": %llu, \"internal_peak_bytes\": %llu, \"allocations_per_frame\": %.3f, \"bytes_per_frame\": %.1f }%s\n",
+            GetSystemAllocationScopeName((VkSystemAllocationScope)i), (unsigned long long)pScope->allocationCount,
+            (unsigned long long)pScope->reallocationCount, (unsigned long long)pScope->freeCount, (unsigned long long)pScope->totalBytes,
+            (unsigned long long)pScope->currentBytes, (unsigned long long)pScope->peakBytes, (unsigned long long)pScope->internalAllocationCount,
+            (unsigned long long)pScope->peakInternalBytes, frameCount > 0 ? (double)frameAllocationCount / frameCount : 0.0,
+            frameCount > 0 ? (double)(pEnd->totalBytes - pBegin->totalBytes) / frameCount : 0.0, i + 1 < HOST_ALLOCATION_SCOPE_COUNT ? "," : "");
+    }
+    fprintf(fp, "    ]\n");
+    fprintf(fp, "  }");
+}
+
+// The usage of a heap is reported by the driver with VK_EXT_memory_budget, without it the usage is what the tracker has allocated.
+static void WriteDeviceMemoryJSON(FILE* fp)
+{
+    const DeviceMemoryTracker* pTracker = &s_memoryTracker;
+    fprintf(fp, ",\n  \"device_memory\": {\n");
+    fprintf(fp, "    \"memory_budget_extension\": %s, \"budget_percent\": %u, \"budget_limit\": %llu, \"budget_updates\": %u,\n",
+        pTracker->info.isMemoryBudgetSupported ? "true" : "false", pTracker->info.budgetPercent, (unsigned long long)pTracker->info.budgetLimit,
+        pTracker->budgetUpdateCount);
+    fprintf(fp, "    \"heaps\": [\n");
+    for (uint32_t i = 0; i < pTracker->memoryProperties.memoryHeapCount; ++i)
+    {
+        const VkMemoryHeap* pHeap = &pTracker->memoryProperties.memoryHeaps[i];
+        const MemoryHeapBudget* pBudget = &pTracker->heaps[i];
+        fprintf(fp, "      { \"index\": %u, \"device_local\": %s, \"size\": %llu, \"budget\": %llu, \"driver_usage\": %llu, \"tracked_bytes\": %llu, \"peak_tracked_bytes\": %llu, \"peak_usage\": %llu }%s\n",
+            i, (pHeap->flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0 ? "true" : "false", (unsigned long long)pHeap->size,
+            (unsigned long long)pBudget->budget, (unsigned long long)pBudget->driverUsage, (unsigned long long)pBudget->trackedBytes,
+            (unsigned long long)pBudget->peakTrackedBytes, (unsigned long long)pBudget->peakUsage,
+            i + 1 < pTracker->memoryProperties.memoryHeapCount ? "," : "");
+    }
+    fprintf(fp, "    ],\n");
+    fprintf(fp, "    \"categories\": [\n");
+    for (uint32_t i = 0; i < DEVICE_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        const DeviceMemoryCategoryStatistics* pCategory = &pTracker->categories[i];
+        fprintf(fp, "      { \"category\": \"%s\", \"allocations\": %u, \"current_bytes\": %llu, \"peak_bytes\": %llu }%s\n",
+            GetDeviceMemoryCategoryName((DeviceMemoryCategory)i), pCategory->allocationCount, (unsigned long long)pCategory->currentBytes,
+            (unsigned long long)pCategory->peakBytes, i + 1 < DEVICE_MEMORY_CATEGORY_COUNT ? "," : "");
+    }
+    fprintf(fp, "    ],\n");
+    fprintf(fp, "    \"fallbacks\": %u, \"over_budget\": %u, \"failed\": %u, \"degradations\": %u, \"degraded_bytes\": %llu\n",
+        pTracker->fallbackCount, pTracker->overBudgetCount, pTracker->failedCount, pTracker->degradationCount,
+        (unsigned long long)pTracker->degradedBytes);
+    fprintf(fp, "  }");
+}
+
+static bool WriteBenchmarkReport(const BenchmarkOptions* pOptions, double elapsedSeconds, const BenchStatistics* pCpuFrameTime,
+                                const BenchStatistics* pGpuFrameTime, const BenchStatistics* pFrameInterval, const BenchStatistics* pRecordTime,
+                                const BenchStatistics* pStagingThroughput, const BenchStatistics* pHostCopyThroughput,
+                                const CullBenchmarkResult* pCullResults, uint32_t cullResultCount, const JobBenchmarkResult* pJobResult,
+                                const RecordBenchmarkResult* pRecordResults, uint32_t recordResultCount,
+                                const DescriptorBenchmarkResult* pDescriptorResults, uint32_t descriptorResultCount, uint64_t captureDrainTime,
+                                uint64_t streamDrainTime, const ContextBenchmarkResult* pContextResults, uint32_t contextResultCount)
+{
+    const bool toStdout = pOptions->reportPath == NULL || strcmp(pOptions->reportPath, "-") == 0;
+    FILE* fp = toStdout ? s_reportStream : GeneralOpenFileForWrite(pOptions->reportPath);
+    if (fp == NULL) return false;
+
+    VkPhysicalDeviceProperties props = { 0 };
+    vkGetPhysicalDeviceProperties(s_currPhysicalDevice, &props);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"benchmark\": \"headless\",\n");
+    fprintf(fp, "  \"device\": \"%s\",\n", props.deviceName);
+    fprintf(fp, "  \"driver_version\": %u,\n", props.driverVersion);
+    fprintf(fp, "  \"config\": { \"width\": %u, \"height\": %u, \"objects\": %u, \"frames_in_flight\": %u, \"present_mode\": \"%s\", \"frames\": %u, \"warmup_frames\": %u, \"animation\": \"%s\", \"command_recording\": \"%s\", \"descriptor_model\": \"%s\" },\n",
+        s_render_width, s_render_height, s_objectCount, s_frameLag, GetPresentModeName(s_preferredPresentMode),
+        pOptions->frameCount, pOptions->warmupFrameCount,
+        !s_useGpuAnimation ? "cpu" : IsSeperateComputeQueue() ? "async-compute" : "compute", s_recordCommandsPerFrame ? "per-frame" : "static",
+        s_useBindless ? "bindless" : s_useDescriptorBuffer ? "descriptor-buffer" : "per-image");
+    fprintf(fp, "  \"startup\": {\n");
+    fprintf(fp, "    \"time_to_first_frame_ms\": %.3f,\n", (s_firstFrameTime - s_startupBeginTime) / 1000000.0);
+    fprintf(fp, "    \"critical_path_ms\": %.3f,\n", s_startupCriticalPathTime / 1000000.0);
+    fprintf(fp, "    \"phases\": [\n");
+    for (uint32_t i = 0; i < s_startupPhaseCount; ++i)
+    {
+        const StartupPhaseTiming* pPhase = &s_startupPhases[i];
+        fprintf(fp, "      { \"name\": \"%s\", \"begin_ms\": %.3f, \"duration_ms\": %.3f, \"worker\": %u }%s\n", pPhase->name,
+            pPhase->beginTime / 1000000.0, (pPhase->endTime - pPhase->beginTime) / 1000000.0, pPhase->workerIndex,
+            i + 1 < s_startupPhaseCount ? "," : "");
+    }
+    fprintf(fp, "    ]\n");
+    fprintf(fp, "  },\n");
+    fprintf(fp, "  \"elapsed_seconds\": %.6f,\n", elapsedSeconds);
+    fprintf(fp, "  \"throughput_fps\": %.3f,\n", elapsedSeconds > 0.0 ? pOptions->frameCount / elapsedSeconds : 0.0);
+    WriteBenchStatisticsJSON(fp, "  ", "cpu_frame_time_ms", pCpuFrameTime);
+    fprintf(fp, ",\n");
+    WriteBenchStatisticsJSON(fp, "  ", "gpu_frame_time_ms", pGpuFrameTime);
+    fprintf(fp, ",\n");
+    WriteBenchStatisticsJSON(fp, "  ", "frame_interval_ms", pFrameInterval);
+    if (s_recordCommandsPerFrame)
+    {
+        // Part of the CPU frame time
+        fprintf(fp, ",\n");
+        WriteBenchStatisticsJSON(fp, "  ", "command_record_time_ms", pRecordTime);
+    }
+    if (s_captureFilePrefix != NULL) {
+        WriteFrameCaptureJSON(fp, "frame_capture", &s_frameCapture, captureDrainTime);
+    }
+    if (s_streamPath != NULL)
+    {
+        // The stalls are the backpressure of the reader of the stream
+        WriteFrameCaptureJSON(fp, "frame_stream", &s_frameStream, streamDrainTime);
+    }
+    // Objects destroyed after their frames, without draining the GPU. Whatever is pending at the end is destroyed at the teardown.
+    fprintf(fp, ",\n  \"deletion_queue\": { \"retired\": %u, \"destroyed\": %u, \"pending\": %u, \"max_pending\": %u }",
+        s_deletionQueue.retiredCount, s_deletionQueue.destroyedCount, s_deletionQueue.count, s_deletionQueue.maxPendingCount);
+    WriteDeviceMemoryJSON(fp);
+    if (pOptions->shaderReloadInterval > 0)
+    {
+        fprintf(fp, ",\n  \"shader_reload\": { \"interval\": %u, \"reloads\": %u, \"reload_mean_ms\": %.3f, \"reload_max_ms\": %.3f }",
+            pOptions->shaderReloadInterval, s_shaderReloadCount,
+            s_shaderReloadCount > 0 ? s_totalShaderReloadTime / 1000000.0 / s_shaderReloadCount : 0.0, s_maxShaderReloadTime / 1000000.0);
+    }
+    if (s_pAllocator != NULL) {
+        WriteHostAllocationsJSON(fp, pOptions->frameCount);
+    }
+    if (s_exportSocketPath != NULL)
+    {
+        // The stalls are the backpressure of the consumer
+        fprintf(fp, ",\n  \"frame_export\": { \"memory_handle_type\": \"%s\", \"semaphore_handle_type\": \"%s\", \"images\": %u, \"exported\": %u, \"released\": %u, \"stalls\": %u, \"stall_ms\": %.3f }",
+            GetExternalMemoryHandleTypeName(s_exportMemoryHandleType), GetExternalSemaphoreHandleTypeName(s_exportSemaphoreHandleType),
+            s_frameExport.info.imageCount, s_frameExport.exportedFrameCount, s_frameExport.releasedFrameCount, s_frameExport.stallCount,
+            s_frameExport.stallTime / 1000000.0);
+    }
+    if (pOptions->uploadIterationCount > 0)
+    {
+        fprintf(fp, ",\n  \"upload_throughput_mb_s\": {\n");
+        WriteBenchStatisticsJSON(fp, "    ", "staging", pStagingThroughput);
+        fprintf(fp, ",\n");
+        WriteBenchStatisticsJSON(fp, "    ", "host_image_copy", pHostCopyThroughput);
+        fprintf(fp, "\n  }");
+    }
+    if (pOptions->cullIterationCount > 0)
+    {
+        fprintf(fp, ",\n  \"frustum_culling\": [\n");
+        for (uint32_t i = 0; i < cullResultCount; ++i)
+        {
+            const CullBenchmarkResult* pResult = &pCullResults[i];
+            fprintf(fp, "    { \"objects\": %u, \"kernel\": \"%s\", \"workers\": %u, \"visible\": %u, \"ns_per_object\": %.3f, ",
+                pResult->objectCount, GetCullingKernelName(pResult->kernel), pResult->workerCount, pResult->visibleCount,
+                pResult->time.p50 * 1000000.0 / pResult->objectCount);
+            WriteBenchStatisticsJSON(fp, "", "time_ms", &pResult->time);
+            fprintf(fp, " }%s\n", i + 1 < cullResultCount ? "," : "");
+        }
+        fprintf(fp, "  ]");
+    }
+    if (pOptions->recordIterationCount > 0)
+    {
+        // The speedup is relative to recording the secondary command buffers on 1 thread
+        fprintf(fp, ",\n  \"command_recording_scaling\": [\n");
+        for (uint32_t i = 0; i < recordResultCount; ++i)
+        {
+            const RecordBenchmarkResult* pResult = &pRecordResults[i];
+            fprintf(fp, "    { \"threads\": %u, \"secondary\": %s, \"speedup\": %.3f, ", pResult->threadCount == 0 ? 1 : pResult->threadCount,
+                pResult->threadCount == 0 ? "false" : "true", recordResultCount > 1 ? pRecordResults[1].time.p50 / pResult->time.p50 : 1.0);
+            WriteBenchStatisticsJSON(fp, "", "time_ms", &pResult->time);
+            fprintf(fp, " }%s\n", i + 1 < recordResultCount ? "," : "");
+        }
+        fprintf(fp, "  ]");
+    }
+    if (pOptions->descriptorIterationCount > 0)
+    {
+        // The speedup is relative to the pool
+        fprintf(fp, ",\n  \"descriptor_churn\": [\n");
+        for (uint32_t i = 0; i < descriptorResultCount; ++i)
+        {
+            const DescriptorBenchmarkResult* pResult = &pDescriptorResults[i];
+            fprintf(fp, "    { \"path\": \"%s\", \"threads\": %u, \"sets\": %u, \"ns_per_set\": %.3f, \"speedup\": %.3f, ",
+                pResult->isDescriptorBuffer ? "descriptor-buffer" : "pool", pResult->workerCount, DESCRIPTOR_BENCHMARK_SET_COUNT,
+                pResult->time.p50 * 1000000.0 / DESCRIPTOR_BENCHMARK_SET_COUNT, pDescriptorResults[0].time.p50 / pResult->time.p50);
+            WriteBenchStatisticsJSON(fp, "", "time_ms", &pResult->time);
+            fprintf(fp, " }%s\n", i + 1 < descriptorResultCount ? "," : "");
+        }
+        fprintf(fp, "  ]");
+    }
+    if (s_renderContextCount > 0)
+    {
+        // The efficiency is the throughput relative to the contexts each rendering as fast as 1 context on its own
+        fprintf(fp, ",\n  \"render_context_scaling\": [\n");
+        for (uint32_t i = 0; i < contextResultCount; ++i)
+        {
+            const ContextBenchmarkResult* pResult = &pContextResults[i];
+            fprintf(fp, "    { \"contexts\": %u, \"queues\": %u, \"frames_per_context\": %u, \"aggregate_fps\": %.3f, \"fps_per_context\": %.3f, \"scaling_efficiency\": %.3f, \"pipeline_cache\": \"%s\", \"create_ms\": %.3f, \"queue_wait_ms\": %.3f }%s\n",
+                pResult->contextCount, pResult->queueCount, pOptions->frameCount, pResult->framesPerSecond,
+                pResult->framesPerSecond / pResult->contextCount,
+                pContextResults[0].framesPerSecond > 0.0 ? pResult->framesPerSecond / (pContextResults[0].framesPerSecond * pResult->contextCount) : 0.0,
+                i == 0 ? "cold" : "warm", pResult->createTime, pResult->queueWaitTime, i + 1 < contextResultCount ? "," : "");
+        }
+        fprintf(fp, "  ]");
+    }
+    if (pOptions->jobIterationCount > 0)
+    {
+        fprintf(fp, ",\n  \"job_system\": {\n");
+        fprintf(fp, "    \"workers\": %u,\n", pJobResult->workerCount);
+        fprintf(fp, "    \"stolen_jobs\": %llu,\n", (unsigned long long)pJobResult->stolenJobCount);
+        WriteBenchStatisticsJSON(fp, "    ", "flat_job_ns", &pJobResult->flatJobTime);
+        fprintf(fp, ",\n");
+        WriteBenchStatisticsJSON(fp, "    ", "nested_job_ns", &pJobResult->nestedJobTime);
+        fprintf(fp, "\n  }");
+    }
+    fprintf(fp, "\n}\n");
+
+    if (toStdout) {
+        fflush(fp);
+    }
+    else {
+        fclose(fp);
+    }
+    return true;
+}
+
+// Renders `warmupFrameCount + frameCount` frames into offscreen render targets and reports the timings of the last `frameCount` frames.
+// The present mode only takes effect on a swapchain, so it is just recorded in the report here.
+static int RunHeadlessBenchmark(const BenchmarkOptions* pOptions)
+{
+    const uint32_t frameCount = pOptions->frameCount;
+    const uint32_t totalFrameCount = pOptions->warmupFrameCount + frameCount;
+
+    double* cpuFrameTimes = calloc(frameCount, sizeof(double));
+    double* gpuFrameTimes = calloc(frameCount, sizeof(double));
+    double* frameIntervals = calloc(frameCount, sizeof(double));
+    double* recordTimes = calloc(frameCount, sizeof(double));
+    // Whether the frame last submitted in each slot is measured
+    bool isSlotMeasured[MAX_FRAME_LAG] = { false };
+
+    bool succeeded = false;
+    do
+    {
+        if (cpuFrameTimes == NULL || gpuFrameTimes == NULL || frameIntervals == NULL || recordTimes == NULL)
+        {
+            puts("Failed to allocate the benchmark sample buffers!");
+            break;
+        }
+
+        const uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!CreateHeadlessRenderTargets()) break;
+        RecordStartupPhase("CreateHeadlessRenderTargets", phaseBeginTime);
+
+        if (!PrepareRenderResources()) break;
+        if (s_captureFilePrefix != NULL && !CreateHeadlessFrameCapture()) break;
+        if (s_streamPath != NULL && !CreateHeadlessFrameStream()) break;
+        if (s_exportSocketPath != NULL && !CreateHeadlessFrameExport()) break;
+
+        printf("Benchmarking %u frames (%u warm-up frames) at %ux%u with %u objects and %u frames in flight, %s command recording...\n",
+            frameCount, pOptions->warmupFrameCount, s_render_width, s_render_height, s_objectCount, s_frameLag,
+            s_recordCommandsPerFrame ? "per-frame" : "static");
+
+        size_t gpuSampleCount = 0;
+        uint64_t prevFrameEndTime = GetCurrentTimeNanoseconds();
+        uint64_t benchBeginTime = prevFrameEndTime;
+        uint32_t frame;
+        for (frame = 0; frame < totalFrameCount; ++frame)
+        {
+            const uint32_t frameIndex = frame % s_frameLag;
+            const bool isMeasured = frame >= pOptions->warmupFrameCount;
+            if (frame == pOptions->warmupFrameCount)
+            {
+                benchBeginTime = prevFrameEndTime;
+                if (s_pAllocator != NULL) {
+                    GetHostAllocationStatistics(&s_hostAllocator, &s_frameBeginHostAllocations);
+                }
+            }
+
+            const uint64_t frameBeginTime = GetCurrentTimeNanoseconds();
+            uint64_t fenceWaitTime = 0;
+            double gpuTime = -1.0;
+            uint64_t recordTime = 0;
+            // Waits here whenever the consumer still reads the frame previously rendered into the target, and acquires the target
+            // back from the consumer ahead of the draw on the same queue
+            if (s_exportSocketPath != NULL && !AcquireExportedImage(&s_frameExport, frameIndex)) break;
+            if (pOptions->shaderReloadInterval > 0 && frame > 0 && frame % pOptions->shaderReloadInterval == 0)
+            {
+                const uint64_t reloadBeginTime = GetCurrentTimeNanoseconds();
+                if (!ReloadGraphicsPipelines()) break;
+                const uint64_t reloadTime = GetCurrentTimeNanoseconds() - reloadBeginTime;
+                ++s_shaderReloadCount;
+                s_totalShaderReloadTime += reloadTime;
+                s_maxShaderReloadTime = max(s_maxShaderReloadTime, reloadTime);
+            }
+            if (!DrawHeadlessFrame(frameIndex, &fenceWaitTime, &gpuTime, &recordTime)) break;
+            // Submitted behind the draw, the frame is written some frames later
+            const SwapchainImageResources* pTarget = &s_swapchainImageResources[frameIndex];
+            if (s_captureFilePrefix != NULL && !CaptureFrame(&s_frameCapture, pTarget->image, pTarget->view, frame)) break;
+            // Waits here whenever the reader of the stream falls a whole ring behind
+            if (s_streamPath != NULL && !CaptureFrame(&s_frameStream, pTarget->image, pTarget->view, frame)) break;
+            if (s_exportSocketPath != NULL && !ExportFrame(&s_frameExport, frameIndex, frame)) break;
+            const uint64_t frameEndTime = GetCurrentTimeNanoseconds();
+
+            if (s_firstFrameTime == 0)
+            {
+                s_firstFrameTime = frameEndTime;
+                PrintStartupReport();
+            }
+
+            // The GPU time belongs to the frame previously submitted in the same slot
+            if (gpuTime >= 0.0 && isSlotMeasured[frameIndex]) {
+                gpuFrameTimes[gpuSampleCount++] = gpuTime;
+            }
+            isSlotMeasured[frameIndex] = isMeasured;
+
+            if (isMeasured)
+            {
+                const uint32_t sampleIndex = frame - pOptions->warmupFrameCount;
+                cpuFrameTimes[sampleIndex] = (double)(frameEndTime - frameBeginTime - fenceWaitTime) / 1000000.0;
+                frameIntervals[sampleIndex] = (double)(frameEndTime - prevFrameEndTime) / 1000000.0;
+                recordTimes[sampleIndex] = (double)recordTime / 1000000.0;
+            }
+            prevFrameEndTime = frameEndTime;
+        }
+        if (frame != totalFrameCount) break;
+
+        vkDeviceWaitIdle(s_specDevice);
+        const uint64_t benchEndTime = GetCurrentTimeNanoseconds();
+        if (s_pAllocator != NULL) {
+            GetHostAllocationStatistics(&s_hostAllocator, &s_frameEndHostAllocations);
+        }
+
+        uint64_t captureDrainTime = 0;
+        if (s_captureFilePrefix != NULL)
+        {
+            if (!FinishFrameCaptures(&s_frameCapture)) {
+                printf("%u of %u captured frames could not be written!\n", s_frameCapture.failedFrameCount, s_frameCapture.capturedFrameCount);
+            }
+            captureDrainTime = GetCurrentTimeNanoseconds() - benchEndTime;
+            printf("Wrote %u captured frames, the capture stalled %u times for %.3f ms in total\n", s_frameCapture.writtenFrameCount,
+                s_frameCapture.stallCount, s_frameCapture.stallTime / 1000000.0);
+        }
+        uint64_t streamDrainTime = 0;
+        if (s_streamPath != NULL)
+        {
+            const uint64_t drainBeginTime = GetCurrentTimeNanoseconds();
+            if (!FinishFrameCaptures(&s_frameStream)) {
+                printf("%u of %u streamed frames could not be written!\n", s_frameStream.failedFrameCount, s_frameStream.capturedFrameCount);
+            }
+            streamDrainTime = GetCurrentTimeNanoseconds() - drainBeginTime;
+            printf("Streamed %u frames (%.1f MB) to %s, the rendering waited for the stream %u times for %.3f ms in total\n",
+                s_frameStream.writtenFrameCount, s_frameStream.streamedByteCount / 1000000.0, s_streamPath, s_frameStream.stallCount,
+                s_frameStream.stallTime / 1000000.0);
+        }
+        if (s_exportSocketPath != NULL)
+        {
+            printf("Exported %u frames, the consumer released %u of them, the rendering waited for the consumer %u times for %.3f ms in total\n",
+                s_frameExport.exportedFrameCount, s_frameExport.releasedFrameCount, s_frameExport.stallCount, s_frameExport.stallTime / 1000000.0);
+        }
+
+        // Collect the GPU times of the frames still in flight when the loop ended
+        for (uint32_t i = 0; i < s_frameLag; ++i)
+        {
+            double gpuTime;
+            if (isSlotMeasured[i] && ReadGpuFrameTime(i, &gpuTime)) {
+                gpuFrameTimes[gpuSampleCount++] = gpuTime;
+            }
+        }
+
+        BenchStatistics cpuFrameTimeStats, gpuFrameTimeStats, frameIntervalStats, recordTimeStats;
+        ComputeBenchStatistics(cpuFrameTimes, frameCount, &cpuFrameTimeStats);
+        ComputeBenchStatistics(gpuFrameTimes, gpuSampleCount, &gpuFrameTimeStats);
+        ComputeBenchStatistics(frameIntervals, frameCount, &frameIntervalStats);
+        ComputeBenchStatistics(recordTimes, frameCount, &recordTimeStats);
+
+        // Measured after the frames, so the uploads do not compete with the rendering
+        BenchStatistics stagingThroughputStats = { 0 };
+        BenchStatistics hostCopyThroughputStats = { 0 };
+        if (pOptions->uploadIterationCount > 0 &&
+            !BenchmarkImageUploads(pOptions->uploadIterationCount, &stagingThroughputStats, &hostCopyThroughputStats)) {
+            break;
+        }
+        // One more result per scene size for the parallel pass
+        CullBenchmarkResult cullResults[CULL_BENCHMARK_SIZE_COUNT * (CULLING_KERNEL_COUNT + 1)];
+        uint32_t cullResultCount = 0;
+        if (pOptions->cullIterationCount > 0 && !BenchmarkFrustumCulling(pOptions->cullIterationCount, cullResults, &cullResultCount)) {
+            break;
+        }
+        RecordBenchmarkResult recordResults[MAX_JOB_WORKER_COUNT + 1];
+        uint32_t recordResultCount = 0;
+        if (pOptions->recordIterationCount > 0 &&
+            !BenchmarkCommandRecording(pOptions->recordIterationCount, recordResults, &recordResultCount)) {
+            break;
+        }
+        // The pool, then the descriptor buffer on 1 and on all workers
+        DescriptorBenchmarkResult descriptorResults[3];
+        uint32_t descriptorResultCount = 0;
+        if (pOptions->descriptorIterationCount > 0 &&
+            !BenchmarkDescriptorChurn(pOptions->descriptorIterationCount, descriptorResults, &descriptorResultCount)) {
+            break;
+        }
+        JobBenchmarkResult jobResult = { 0 };
+        if (pOptions->jobIterationCount > 0 && !BenchmarkJobSystem(pOptions->jobIterationCount, &jobResult)) {
+            break;
+        }
+        ContextBenchmarkResult contextResults[MAX_RENDER_CONTEXT_COUNT];
+        uint32_t contextResultCount = 0;
+        if (s_renderContextCount > 0 && !BenchmarkRenderContexts(frameCount, contextResults, &contextResultCount)) {
+            break;
+        }
+
+        const double elapsedSeconds = (double)(benchEndTime - benchBeginTime) / 1000000000.0;
+        succeeded = WriteBenchmarkReport(pOptions, elapsedSeconds, &cpuFrameTimeStats, &gpuFrameTimeStats, &frameIntervalStats, &recordTimeStats,
+                                         &stagingThroughputStats, &hostCopyThroughputStats, cullResults, cullResultCount, &jobResult,
+                                         recordResults, recordResultCount, descriptorResults, descriptorResultCount, captureDrainTime,
+                                         streamDrainTime, contextResults, contextResultCount);
+    }
+    while (false);
+
+    free(cpuFrameTimes);
+    free(gpuFrameTimes);
+    free(frameIntervals);
+    free(recordTimes);
+
+    DestroyVulkanAssets();
+
+    return succeeded ? 0 : 1;
+}
+
+static bool WriteRenderServerReport(const char* reportPath, const RenderServer* pServer, double startupTime)
+{
+    const bool toStdout = reportPath == NULL || strcmp(reportPath, "-") == 0;
+    FILE* fp = toStdout ? s_reportStream : GeneralOpenFileForWrite(reportPath);
+    if (fp == NULL) return false;
+
+    VkPhysicalDeviceProperties props = { 0 };
+    vkGetPhysicalDeviceProperties(s_currPhysicalDevice, &props);
+
+    BenchStatistics latencyStats, renderTimeStats;
+    ComputeBenchStatistics(pServer->pLatencies, pServer->sampleCount, &latencyStats);
+    ComputeBenchStatistics(pServer->pRenderTimes, pServer->sampleCount, &renderTimeStats);
+
+    fprintf(fp, "{\n");
+    fprintf(fp, "  \"benchmark\": \"render_server\",\n");
+    fprintf(fp, "  \"device\": \"%s\",\n", props.deviceName);
+    fprintf(fp, "  \"driver_version\": %u,\n", props.driverVersion);
+    fprintf(fp, "  \"config\": { \"width\": %u, \"height\": %u, \"frames_in_flight\": %u, \"shared_slots\": %d },\n",
+        pServer->info.pContext->info.width, pServer->info.pContext->info.height, pServer->info.pContext->info.frameCount,
+        RENDER_SERVER_SHARED_SLOT_COUNT);
+    // Paid once at the start, the requests find the device, the pipelines and the memory ready
+    fprintf(fp, "  \"startup_ms\": %.3f,\n", startupTime);
+    fprintf(fp, "  \"clients\": %u,\n", pServer->clientCount);
+    fprintf(fp, "  \"requests\": %llu,\n", (unsigned long long)pServer->requestCount);
+    fprintf(fp, "  \"failed_requests\": %llu,\n", (unsigned long long)pServer->failedRequestCount);
+    fprintf(fp, "  \"frames\": { \"inline\": %llu, \"shared_memory\": %llu, \"none\": %llu },\n",
+        (unsigned long long)pServer->deliveryCounts[RENDER_SERVER_FRAME_DELIVERY_INLINE],
+        (unsigned long long)pServer->deliveryCounts[RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY],
+        (unsigned long long)pServer->deliveryCounts[RENDER_SERVER_FRAME_DELIVERY_NONE]);
+    WriteBenchStatisticsJSON(fp, "  ", "request_latency_ms", &latencyStats);
+    fprintf(fp, ",\n");
+    WriteBenchStatisticsJSON(fp, "  ", "render_time_ms", &renderTimeStats);
+    WriteDeviceMemoryJSON(fp);
+    fprintf(fp, "\n}\n");
+
+    if (toStdout) {
+        fflush(fp);
+    }
+    else {
+        fclose(fp);
+    }
+    return true;
+}
+
+// Keeps the device, the pipelines and the memory of one render context alive and renders the frames requested by clients of
+// a Unix domain socket, until a client asks the server to shut down. The report shows what a frame costs once the setup is paid.
+static int RunRenderServerMode(const char* reportPath)
+{
+    VkShaderModule vertexShaders[RENDER_CONTEXT_DRAW_COUNT] = { VK_NULL_HANDLE };
+    VkShaderModule fragmentShaders[RENDER_CONTEXT_DRAW_COUNT] = { VK_NULL_HANDLE };
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    RenderQueue queue;
+    vkGetDeviceQueue(s_specDevice, s_specQueueFamilyIndex, 0, &queue.queue);
+    InitializePlatformMutex(&queue.mutex);
+    RenderContext context = { 0 };
+    RenderServer server = { 0 };
+
+    bool succeeded = false;
+    do
+    {
+        if (!CreateVertAndFragShaderModules("flatten.vert.spv", "flatten.frag.spv", &vertexShaders[0], &fragmentShaders[0])) break;
+        if (!CreateVertAndFragShaderModules("gradient.vert.spv", "gradient.frag.spv", &vertexShaders[1], &fragmentShaders[1])) break;
+
+        const VkPipelineCacheCreateInfo pipelineCacheCreateInfo = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .initialDataSize = 0,
+            .pInitialData = NULL
+        };
+        const VkResult res = vkCreatePipelineCache(s_specDevice, &pipelineCacheCreateInfo, s_pAllocator, &pipelineCache);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreatePipelineCache for the render server failed: %d\n", res);
+            break;
+        }
+
+        const RenderContextCreateInfo contextCreateInfo = {
+            .device = s_specDevice,
+            .pAllocator = s_pAllocator,
+            .pMemoryTracker = &s_memoryTracker,
+            .pipelineCache = pipelineCache,
+            .pQueue = &queue,
+            .queueFamilyIndex = s_specQueueFamilyIndex,
+            .width = s_render_width,
+            .height = s_render_height,
+            .colorFormat = VK_FORMAT_R8G8B8A8_UNORM,
+            .depthFormat = (VkFormat)s_depth_format,
+            .frameCount = min(s_frameLag, (uint32_t)MAX_RENDER_CONTEXT_FRAME_COUNT),
+            .uniformAlignment = s_deviceCapabilities.properties.limits.minUniformBufferOffsetAlignment,
+            .vertexShaders = { vertexShaders[0], vertexShaders[1] },
+            .fragmentShaders = { fragmentShaders[0], fragmentShaders[1] },
+            .pVertexCoords = s_vertex_coords_data,
+            .isReadbackEnabled = true
+        };
+        if (!CreateRenderContext(&contextCreateInfo, &context)) break;
+
+        RenderContextScene initialScene = {
+            .cameraExtent = { 1.0f, 1.0f },
+            .angle = 0.0f
+        };
+        memcpy(initialScene.vertexColors, s_vertex_color_data, sizeof(initialScene.vertexColors));
+        const RenderServerCreateInfo serverCreateInfo = {
+            .socketPath = s_serverSocketPath,
+            .pContext = &context,
+            .pInitialScene = &initialScene
+        };
+        if (!CreateRenderServer(&serverCreateInfo, &server)) break;
+
+        const double startupTime = (GetCurrentTimeNanoseconds() - s_startupBeginTime) / 1000000.0;
+        printf("Serving %ux%u frames on %s, ready %.3f ms after the start\n", s_render_width, s_render_height, s_serverSocketPath, startupTime);
+        if (!RunRenderServer(&server)) break;
+
+        BenchStatistics latencyStats;
+        ComputeBenchStatistics(server.pLatencies, server.sampleCount, &latencyStats);
+        printf("Served %llu frames to %u clients, %.3f ms per request at the median, %.3f ms at p99\n",
+            (unsigned long long)server.sampleCount, server.clientCount, latencyStats.p50, latencyStats.p99);
+        succeeded = WriteRenderServerReport(reportPath, &server, startupTime);
+    }
+    while (false);
+
+    DestroyRenderServer(&server);
+    DestroyRenderContext(&context);
+    vkDestroyPipelineCache(s_specDevice, pipelineCache, s_pAllocator);
+    for (uint32_t i = 0; i < RENDER_CONTEXT_DRAW_COUNT; ++i)
+    {
+        vkDestroyShaderModule(s_specDevice, vertexShaders[i], s_pAllocator);
+        vkDestroyShaderModule(s_specDevice, fragmentShaders[i], s_pAllocator);
+    }
+    DestroyPlatformMutex(&queue.mutex);
+
+    DestroyVulkanAssets();
+
+    return succeeded ? 0 : 1;
+}
+
+static void PrintUsage(const char* appPath)
+{
+    printf("Usage: %s [options]\n", appPath);
+    puts("  --benchmark                Render headless and print a benchmark report");
+    puts("  --serve=<socket path>      Render the frames requested over a Unix socket until a client shuts the server down (Linux)");
+    puts("  --width=<n>                Render target width");
+    puts("  --height=<n>               Render target height");
+    puts("  --objects=<n>              Number of objects drawn per frame");
+    puts("  --mesh=<path>              Draw every object with the mesh in the given mesh file instead of a square");
+    puts("  --import-obj=<path>        Convert an OBJ file into an optimized mesh file at the --mesh path first");
+    puts("  --texture=<path>           Texture the gradient objects with the given KTX 2.0 file");
+    printf("  --frames-in-flight=<n>     Number of frames in flight (1 ~ %d)\n", MAX_FRAME_LAG);
+    puts("  --present-mode=<mode>      fifo, fifo-relaxed, mailbox or immediate");
+    puts("  --device=<n>               Index of the physical device to use, overrides VSR_DEVICE_INDEX");
+    printf("  --rescan-devices           Ignore the device cached in '%s' and score all devices again\n", s_deviceCacheFilePath);
+    puts("  --no-transfer-queue        Upload the initial data on the graphics queue");
+    puts("  --cpu-animation            Animate the objects on the CPU instead of in a compute shader");
+    puts("  --record-per-frame         Record the draw commands every frame into per-frame command pools instead of pre-recording them");
+    printf("  --record-threads=<n>       Record the draws per frame into n secondary command buffers on the job system (1 ~ %d)\n", MAX_JOB_WORKER_COUNT);
+    puts("  --bindless                 Read all resources from one global descriptor set with descriptor indexing");
+    puts("  --descriptor-buffer        Experimental: write the descriptors into a buffer with VK_EXT_descriptor_buffer instead of allocating sets");
+    puts("  --no-host-image-copy       Upload the texture through a staging buffer even if VK_EXT_host_image_copy is supported");
+    printf("  --startup-threads=<n>      Number of threads creating the render resources (1 ~ %d, default: CPU count)\n", MAX_STARTUP_WORKER_COUNT);
+    printf("  --job-threads=<n>          Number of job system workers running the per-frame CPU work (1 ~ %d, default: CPU count)\n", MAX_JOB_WORKER_COUNT);
+    puts("  --frames=<n>               Number of measured benchmark frames");
+    puts("  --warmup=<n>               Number of benchmark warm-up frames");
+    puts("  --report=<path>            Benchmark report file path, '-' for stdout (default), which moves the logs to stderr");
+    puts("  --capture=<prefix>         Read every benchmark frame back and write it to <prefix>_<frame>.<format> on the job system");
+    puts("  --capture-format=<format>  png, qoi or ppm (default: png)");
+    printf("  --capture-ring=<n>         Number of frames being read back, encoded or streamed at once (1 ~ %d, default: %d)\n",
+        MAX_FRAME_CAPTURE_SLOT_COUNT, DEFAULT_FRAME_CAPTURE_SLOT_COUNT);
+    puts("  --stream=<path>            Write every benchmark frame in order to a file or named pipe, or fd:<n> for a file descriptor");
+    puts("  --stream-format=<format>   y4m or rgba (default: y4m)");
+    printf("  --stream-fps=<n>           Frame rate stated in the Y4M header (1 ~ 1000, default: %d)\n", DEFAULT_STREAM_FRAME_RATE);
+    puts("  --cpu-yuv                  Convert the Y4M frames on the stream writer thread instead of in a compute shader before the readback");
+    puts("  --export=<socket path>     Hand every benchmark frame to a frame_consumer connecting to a Unix socket, without copying it (Linux)");
+    puts("  --reload-shaders=<n>       Rebuild the graphics pipelines every n benchmark frames, destroying the old ones after their frames");
+    puts("  --host-allocator           Give the driver allocation callbacks counting its host allocations per scope, with arenas and pools");
+    puts("  --memory-budget=<MiB>      Cap the memory budget of every heap, to see how the resources degrade on a smaller device");
+    puts("  --upload-benchmark=<n>     Measure the image upload throughput of both upload paths over n uploads after the frames");
+    puts("  --cull-benchmark=<n>       Measure n frustum culling passes over 10k, 100k and 1M objects per culling kernel after the frames");
+    puts("  --record-benchmark=<n>     Measure n frame recordings inline and on 1 to all job system workers after the frames");
+    puts("  --descriptor-benchmark=<n> Measure n rewrites of 4096 descriptor sets from a pool and into a descriptor buffer after the frames");
+    puts("  --job-benchmark=<n>        Measure the job system scheduling overhead over n rounds of empty jobs after the frames");
+    printf("  --context-benchmark=<n>    Measure the frame rate of 1 up to n render contexts at once, each on its own thread, after the frames (1 ~ %d)\n",
+        MAX_RENDER_CONTEXT_COUNT);
+}
+
+// Returns the value part if `arg` is in the form of `<name>=<value>`, otherwise NULL.
+static const char* MatchCommandLineOption(const char* arg, const char* name)
+{
+    const size_t nameLength = strlen(name);
+    if (strncmp(arg, name, nameLength) != 0 || arg[nameLength] != '=') return NULL;
+    return &arg[nameLength + 1];
+}
+
+static bool ParseUnsignedOptionValue(const char* name, const char* value, uint32_t minValue, uint32_t maxValue, uint32_t* pResult)
+{
+    char* end = NULL;
+    errno = 0;
+    const unsigned long result = strtoul(value, &end, 10);
+    if (errno != 0 || end == value || *end != '\0' || result < minValue || result > maxValue)
+    {
+        printf("Invalid value '%s' for %s! A value in [%u, %u] is expected.\n", value, name, minValue, maxValue);
+        return false;
+    }
+    *pResult = (uint32_t)result;
+    return true;
+}
+
+static bool ParsePresentModeOptionValue(const char* value, VkPresentModeKHR* pPresentMode)
+{
+    const VkPresentModeKHR presentModes[] = {
+        VK_PRESENT_MODE_IMMEDIATE_KHR,
+        VK_PRESENT_MODE_MAILBOX_KHR,
+        VK_PRESENT_MODE_FIFO_KHR,
+        VK_PRESENT_MODE_FIFO_RELAXED_KHR
+    };
+    for (size_t i = 0; i < sizeof(presentModes) / sizeof(presentModes[0]); ++i)
+    {
+        if (strcmp(value, GetPresentModeName(presentModes[i])) == 0)
+        {
+            *pPresentMode = presentModes[i];
+            return true;
+        }
+    }
+    printf("Unknown present mode: %s\n", value);
+    return false;
+}
+
+static bool ParseCommandLineOptions(int argc, const char* const argv[], BenchmarkOptions* pBenchmarkOptions)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+        const char* value = NULL;
+        bool isValid = true;
+
+        if (strcmp(arg, "--benchmark") == 0) {
+            s_isHeadless = true;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--width")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 16384, &s_render_width);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--height")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 16384, &s_render_height);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--objects")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 0, MAX_OBJECT_COUNT, &s_objectCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--mesh")) != NULL) {
+            s_meshFilePath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--import-obj")) != NULL) {
+            s_importObjPath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--texture")) != NULL) {
+            s_texturePath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--frames-in-flight")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_FRAME_LAG, &s_frameLag);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--present-mode")) != NULL) {
+            isValid = ParsePresentModeOptionValue(value, &s_preferredPresentMode);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--device")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 0, MAX_GPU_COUNT - 1, &s_deviceIndexOverride);
+        }
+        else if (strcmp(arg, "--rescan-devices") == 0) {
+            s_rescanDevices = true;
+        }
+        else if (strcmp(arg, "--no-transfer-queue") == 0) {
+            s_useTransferQueue = false;
+        }
+        else if (strcmp(arg, "--cpu-animation") == 0) {
+            s_useGpuAnimation = false;
+        }
+        else if (strcmp(arg, "--record-per-frame") == 0) {
+            s_recordCommandsPerFrame = true;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--record-threads")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_JOB_WORKER_COUNT, &s_recordThreadCount);
+            s_recordCommandsPerFrame = true;
+        }
+        else if (strcmp(arg, "--bindless") == 0) {
+            s_useBindless = true;
+        }
+        else if (strcmp(arg, "--descriptor-buffer") == 0) {
+            s_useDescriptorBuffer = true;
+        }
+        else if (strcmp(arg, "--no-host-image-copy") == 0) {
+            s_useHostImageCopy = false;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--startup-threads")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_STARTUP_WORKER_COUNT, &s_startupWorkerCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--job-threads")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_JOB_WORKER_COUNT, &s_jobWorkerCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--frames")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, UINT32_MAX / 2, &pBenchmarkOptions->frameCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--warmup")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 0, UINT32_MAX / 2, &pBenchmarkOptions->warmupFrameCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--report")) != NULL) {
+            pBenchmarkOptions->reportPath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--upload-benchmark")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 1000, &pBenchmarkOptions->uploadIterationCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--cull-benchmark")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 10000, &pBenchmarkOptions->cullIterationCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--record-benchmark")) != NULL) {
+            // Records with the per-frame command pools, which the frames then use too
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 10000, &pBenchmarkOptions->recordIterationCount);
+            s_recordCommandsPerFrame = true;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--capture")) != NULL) {
+            s_captureFilePrefix = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--capture-format")) != NULL)
+        {
+            isValid = ParseImageFileFormat(value, &s_captureFileFormat);
+            if (!isValid) {
+                printf("Unknown capture format: %s\n", value);
+            }
+        }
+        else if ((value = MatchCommandLineOption(arg, "--capture-ring")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_FRAME_CAPTURE_SLOT_COUNT, &s_captureSlotCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--stream")) != NULL) {
+            s_streamPath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--stream-format")) != NULL)
+        {
+            if (strcmp(value, "y4m") == 0) {
+                s_streamOutput = FRAME_CAPTURE_OUTPUT_Y4M_STREAM;
+            }
+            else if (strcmp(value, "rgba") == 0) {
+                s_streamOutput = FRAME_CAPTURE_OUTPUT_RGBA_STREAM;
+            }
+            else
+            {
+                printf("Unknown stream format: %s\n", value);
+                isValid = false;
+            }
+        }
+        else if ((value = MatchCommandLineOption(arg, "--stream-fps")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 1000, &s_streamFrameRate);
+        }
+        else if (strcmp(arg, "--cpu-yuv") == 0) {
+            s_convertStreamOnGpu = false;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--export")) != NULL) {
+            s_exportSocketPath = value;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--serve")) != NULL) {
+            s_serverSocketPath = value;
+            s_isHeadless = true;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--reload-shaders")) != NULL) {
+            // The pre-recorded command buffers would keep drawing with the retired pipelines
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 100000, &pBenchmarkOptions->shaderReloadInterval);
+            s_recordCommandsPerFrame = true;
+        }
+        else if (strcmp(arg, "--host-allocator") == 0) {
+            s_useHostAllocator = true;
+        }
+        else if ((value = MatchCommandLineOption(arg, "--memory-budget")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 16, 1024 * 1024, &s_memoryBudgetLimit);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--context-benchmark")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, MAX_RENDER_CONTEXT_COUNT, &s_renderContextCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--descriptor-benchmark")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 10000, &pBenchmarkOptions->descriptorIterationCount);
+        }
+        else if ((value = MatchCommandLineOption(arg, "--job-benchmark")) != NULL) {
+            isValid = ParseUnsignedOptionValue(arg, value, 1, 10000, &pBenchmarkOptions->jobIterationCount);
+        }
+        else
+        {
+            printf("Unknown option: %s\n", arg);
+            PrintUsage(argv[0]);
+            return false;
+        }
+
+        if (!isValid) return false;
+    }
+
+    if (s_importObjPath != NULL && s_meshFilePath == NULL)
+    {
+        puts("--import-obj requires --mesh=<path> for the mesh file to write!");
+        return false;
+    }
+    // Swapchain images are owned by the presentation engine once presented, only the headless render targets are read back.
+    if (s_captureFilePrefix != NULL && !s_isHeadless)
+    {
+        puts("--capture requires --benchmark!");
+        return false;
+    }
+    if (s_streamPath != NULL && !s_isHeadless)
+    {
+        puts("--stream requires --benchmark!");
+        return false;
+    }
+    // The exported render targets belong to the consumer between the frames, so nothing else may read them back.
+    if (s_exportSocketPath != NULL && (!s_isHeadless || s_captureFilePrefix != NULL || s_streamPath != NULL))
+    {
+        puts("--export requires --benchmark and cannot be combined with --capture or --stream!");
+        return false;
+    }
+
+    // The command line option takes precedence over the environment variable.
+    char envValue[16];
+    if (s_deviceIndexOverride == UINT32_MAX && GetEnvironmentVariableString("VSR_DEVICE_INDEX", envValue, sizeof(envValue)))
+    {
+        if (!ParseUnsignedOptionValue("VSR_DEVICE_INDEX", envValue, 0, MAX_GPU_COUNT - 1, &s_deviceIndexOverride)) return false;
+    }
+
+    return true;
+}
+
+#ifdef _WIN32
+static int s_currFrameIndex = 0;
+static POINT s_wndMinsize;                // minimum window size
+
+static LRESULT CALLBACK WndProc(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lParam)
+{
+    switch (uMsg)
+    {
+    case WM_CREATE:
+    {
+        RECT windowRect;
+        GetWindowRect(hWnd, &windowRect);
+        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_MINIMIZEBOX);
+        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_MAXIMIZEBOX);
+        SetWindowLongA(hWnd, GWL_STYLE, GetWindowLongA(hWnd, GWL_STYLE) & ~WS_SIZEBOX);
+        break;
+    }
+
+    case WM_CLOSE:
+        DestroyVulkanAssets();
+        PostQuitMessage(0);
+        break;
+
+    case WM_PAINT:
+        RunTheRendering(GetModuleHandleA(NULL), hWnd, s_currFrameIndex++);
+        if ((uint32_t)s_currFrameIndex == s_frameLag) {
+            s_currFrameIndex = 0;
+        }
+        break;
+
+    case WM_GETMINMAXINFO:  // set window's minimum size
+        ((MINMAXINFO*)lParam)->ptMinTrackSize = s_wndMinsize;
+        return 0;
+
+    case WM_ERASEBKGND:
+        return 1;
+
+    case WM_SIZE:
+        // Resize the application to the new window size, except when
+        // it was minimized. Vulkan doesn't support images or swapchains
+        // with width=0 and height=0.
+        if (wParam != SIZE_MINIMIZED)
+        {
+            s_render_width = lParam & 0xffff;
+            s_render_height = (lParam & 0xffff0000U) >> 16;
+            DoResize();
+        }
+        break;
+
+    case WM_KEYDOWN:
+        switch (wParam)
+        {
+        case VK_ESCAPE:
+            PostQuitMessage(0);
+            break;
+        case VK_LEFT:
+            break;
+        case VK_RIGHT:
+            break;
+        case VK_SPACE:
+            break;
+        }
+        return 0;
+
+    default:
+        break;
+    }
+
+    return DefWindowProc(hWnd, uMsg, wParam, lParam);
+}
+
+static HWND CreateAndInitializeWindow(HINSTANCE hInstance, LPCSTR appName, int windowWidth, int windowHeight)
+{
+    WNDCLASSEXA win_class;
+    // Initialize the window class structure:
+    win_class.cbSize = sizeof(WNDCLASSEX);
+    win_class.style = CS_HREDRAW | CS_VREDRAW;
+    win_class.lpfnWndProc = WndProc;
+    win_class.cbClsExtra = 0;
+    win_class.cbWndExtra = 0;
+    win_class.hInstance = hInstance;
+    win_class.hIcon = LoadIconA(NULL, IDI_APPLICATION);
+    win_class.hCursor = LoadCursorA(NULL, IDC_ARROW);
+    win_class.hbrBackground = (HBRUSH)GetStockObject(WHITE_BRUSH);
+    win_class.lpszMenuName = NULL;
+    win_class.lpszClassName = appName;
+    win_class.hIconSm = LoadIconA(NULL, IDI_WINLOGO);
+    // Register window class:
+    if (!RegisterClassExA(&win_class))
+    {
+        // It didn't work, so try to give a useful error:
+        printf("Unexpected error trying to start the application!\n");
+        fflush(stdout);
+        exit(1);
+    }
+    // Create window with the registered class:
+    RECT wr = { 0, 0, windowWidth, windowHeight };
+    AdjustWindowRect(&wr, WS_OVERLAPPEDWINDOW, FALSE);
+
+    const LONG windowStyle = WS_OVERLAPPEDWINDOW | WS_VISIBLE | WS_SYSMENU;
+
+    HWND hWnd = CreateWindowExA(
+        0,                            // extra style
+        appName,                    // class name
+        appName,                   // app name
+        windowStyle,                   // window style
+        CW_USEDEFAULT, CW_USEDEFAULT,     // x, y coords
+        windowWidth,                    // width
+        windowHeight,                  // height
+        NULL,                        // handle to parent
+        NULL,                            // handle to menu
+        hInstance,                            // hInstance
+        NULL);
+
+    if (hWnd == NULL) {
+        // It didn't work, so try to give a useful error:
+        puts("Cannot create a window in which to draw!");
+    }
+
+    // Window client area size must be at least 1 pixel high, to prevent crash.
+    s_wndMinsize.x = GetSystemMetrics(SM_CXMINTRACK);
+    s_wndMinsize.y = GetSystemMetrics(SM_CYMINTRACK) + 1;
+
+    return hWnd;
+}
+#endif // _WIN32
+
+int main(int argc, const char* const argv[])
+{
+    const char* const appName = "Vulkan Simple Render";
+
+    // A stdout redirected to a file or a pipe is fully buffered, which would hold the logs back once DetachPlatformStandardOutput
+    // moves them to stderr. The buffering MUST BE set before the first output.
+#ifdef _WIN32
+    // The CRT buffers _IOLBF streams fully
+    setvbuf(stdout, NULL, _IONBF, 0);
+#else
+    setvbuf(stdout, NULL, _IOLBF, BUFSIZ);
+#endif // _WIN32
+
+    s_startupBeginTime = GetCurrentTimeNanoseconds();
+
+    s_render_width = WINDOW_WIDTH;
+    s_render_height = WINDOW_HEIGHT;
+
+    BenchmarkOptions benchmarkOptions = {
+        .frameCount = DEFAULT_BENCHMARK_FRAME_COUNT,
+        .warmupFrameCount = DEFAULT_BENCHMARK_WARMUP_FRAME_COUNT,
+        .reportPath = NULL,
+        .uploadIterationCount = 0,
+        .cullIterationCount = 0,
+        .jobIterationCount = 0,
+        .recordIterationCount = 0,
+        .descriptorIterationCount = 0,
+        .shaderReloadInterval = 0
+    };
+
+#if defined(HEADLESS_BENCHMARK_BUILD) || !defined(_WIN32)
+    // The benchmark build target, and platforms without a window implementation here, always render headless.
+    s_isHeadless = true;
+#endif
+
+    if (!ParseCommandLineOptions(argc, argv, &benchmarkOptions)) {
+        return 1;
+    }
+    s_isDescriptorBufferRequested = s_useDescriptorBuffer || benchmarkOptions.descriptorIterationCount > 0;
+
+    if ((s_isHeadless || s_serverSocketPath != NULL) &&
+        (benchmarkOptions.reportPath == NULL || strcmp(benchmarkOptions.reportPath, "-") == 0))
+    {
+        // Keeps the logs of the startup and of the frames out of the report
+        s_reportStream = DetachPlatformStandardOutput();
+        if (s_reportStream == NULL)
+        {
+            puts("Failed to move the logs to stderr, they are mixed with the report on stdout.");
+            s_reportStream = stdout;
+        }
+    }
+
+    if (s_importObjPath != NULL)
+    {
+        const uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!ImportObjMesh(s_importObjPath, s_meshFilePath)) return 1;
+        RecordStartupPhase("ImportObjMesh", phaseBeginTime);
+    }
+
+    if (s_useHostAllocator)
+    {
+        // Created ahead of the instance, since the instance is the first object allocating with the callbacks
+        const HostAllocatorCreateInfo hostAllocatorCreateInfo = { .arenaSize = DEFAULT_HOST_ARENA_SIZE };
+        if (!CreateHostAllocator(&hostAllocatorCreateInfo, &s_hostAllocator)) return 1;
+        s_pAllocator = GetHostAllocationCallbacks(&s_hostAllocator);
+    }
+
+    uint64_t phaseBeginTime = GetCurrentTimeNanoseconds();
+    if (!InitializeVulkanInstance(appName, "ZennyEngine")) {
+        return s_isHeadless ? 1 : 0;
+    }
+    RecordStartupPhase("InitializeVulkanInstance", phaseBeginTime);
+
+    phaseBeginTime = GetCurrentTimeNanoseconds();
+    if (!InitializeVulkanDevice(VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT)) {
+        return s_isHeadless ? 1 : 0;
+    }
+    RecordStartupPhase("InitializeVulkanDevice", phaseBeginTime);
+
+    phaseBeginTime = GetCurrentTimeNanoseconds();
+    const uint32_t jobWorkerCount = s_jobWorkerCount > 0 ? s_jobWorkerCount : min(GetLogicalProcessorCount(), (uint32_t)MAX_JOB_WORKER_COUNT);
+    if (!CreateJobSystem(jobWorkerCount, &s_jobSystem))
+    {
+        puts("Failed to create the job system!");
+        return 1;
+    }
+    RecordStartupPhase("CreateJobSystem", phaseBeginTime);
+
+    if (s_serverSocketPath != NULL) {
+        return RunRenderServerMode(benchmarkOptions.reportPath);
+    }
+    if (s_isHeadless) {
+        return RunHeadlessBenchmark(&benchmarkOptions);
+    }
+
+#ifdef _WIN32
+    // Windows Instance
+    HINSTANCE wndInstance = GetModuleHandleA(NULL);
+
+    // window handle
+    phaseBeginTime = GetCurrentTimeNanoseconds();
+    HWND wndHandle = CreateAndInitializeWindow(wndInstance, appName, (int)s_render_width, (int)s_render_height);
+    RecordStartupPhase("CreateAndInitializeWindow", phaseBeginTime);
+
+    // Initialize loop condition variable
+    bool done = true;
+
+    do
+    {
+        phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!CreateVulkanSurface(wndInstance, wndHandle)) break;
+        RecordStartupPhase("CreateVulkanSurface", phaseBeginTime);
+
+        phaseBeginTime = GetCurrentTimeNanoseconds();
+        if (!CreateVulkanSwapchain()) break;
+        RecordStartupPhase("CreateVulkanSwapchain", phaseBeginTime);
+
+        if (!PrepareRenderResources()) break;
+
+        done = false;
+    }
+    while (false);
+
+    // main message loop
+    MSG msg;
+    while (!done)
+    {
+        PeekMessageA(&msg, NULL, 0, 0, PM_REMOVE);
+        if (msg.message == WM_QUIT)  // check for a quit message
+        {
+            done = true;  // if found, quit app
+        }
+        else {
+            // Translate and dispatch to event queue
+            TranslateMessage(&msg);
+            DispatchMessageA(&msg);
+        }
+        RedrawWindow(wndHandle, NULL, NULL, RDW_INTERNALPAINT);
+    }
+
+    if (wndHandle != NULL)
+    {
+        DestroyWindow(wndHandle);
+        wndHandle = NULL;
+    }
+#endif // _WIN32
+
+    return 0;
+}
+
+// 运行程序: Ctrl + F5 或调试 >“开始执行(不调试)”菜单
+// 调试程序: F5 或调试 >“开始调试”菜单
+
+// 入门使用技巧: 
+//   1. 使用解决方案资源管理器窗口添加/管理文件
+//   2. 使用团队资源管理器窗口连接到源代码管理
+//   3. 使用输出窗口查看生成输出和其他消息
+//   4. 使用错误列表窗口查看错误
+//   5. 转到“项目”>“添加新项”以创建新的代码文件，或转到“项目”>“添加现有项”以将现有代码文件添加到项目
+//   6. 将来，若要再次打开此项目，请转到“文件”>“打开”>“项目”并选择 .sln 文件
@@ -0,0 +1,349 @@
+#include "memory_tracker.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The mutex MUST BE locked.
+static VkDeviceSize GetHeapUsage(const DeviceMemoryTracker* pTracker, uint32_t heapIndex)
+{
+    const MemoryHeapBudget* pHeap = &pTracker->heaps[heapIndex];
+    if (!pTracker->info.isMemoryBudgetSupported) return pHeap->trackedBytes;
+
+    // The usage reported by the driver, plus what has been allocated or freed through the tracker since
+    const VkDeviceSize usage = pHeap->driverUsage + pHeap->trackedBytes;
+    return usage > pHeap->trackedBytesAtUpdate ? usage - pHeap->trackedBytesAtUpdate : 0;
+}
+
+static VkDeviceSize GetHeapAllowance(const DeviceMemoryTracker* pTracker, uint32_t heapIndex)
+{
+    return pTracker->heaps[heapIndex].budget / 100 * pTracker->info.budgetPercent;
+}
+
+// The mutex MUST BE locked.
+static void QueryHeapBudgets(DeviceMemoryTracker* pTracker)
+{
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budgetProperties = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT,
+        .pNext = NULL
+    };
+    if (pTracker->info.isMemoryBudgetSupported)
+    {
+        VkPhysicalDeviceMemoryProperties2 memoryProperties2 = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budgetProperties
+        };
+        vkGetPhysicalDeviceMemoryProperties2(pTracker->info.physicalDevice, &memoryProperties2);
+    }
+
+    for (uint32_t i = 0; i < pTracker->memoryProperties.memoryHeapCount; ++i)
+    {
+        MemoryHeapBudget* pHeap = &pTracker->heaps[i];
+        VkDeviceSize budget = pTracker->info.isMemoryBudgetSupported ? budgetProperties.heapBudget[i] : pTracker->memoryProperties.memoryHeaps[i].size;
+        if (pTracker->info.budgetLimit > 0 && budget > pTracker->info.budgetLimit) {
+            budget = pTracker->info.budgetLimit;
+        }
+        pHeap->budget = budget;
+        if (pTracker->info.isMemoryBudgetSupported)
+        {
+            pHeap->driverUsage = budgetProperties.heapUsage[i];
+            pHeap->trackedBytesAtUpdate = pHeap->trackedBytes;
+        }
+
+        const VkDeviceSize usage = GetHeapUsage(pTracker, i);
+        if (usage > pHeap->peakUsage) {
+            pHeap->peakUsage = usage;
+        }
+    }
+    ++pTracker->budgetUpdateCount;
+}
+
+bool CreateDeviceMemoryTracker(const MemoryTrackerCreateInfo* pCreateInfo, DeviceMemoryTracker* pTracker)
+{
+    memset(pTracker, 0, sizeof(*pTracker));
+    pTracker->info = *pCreateInfo;
+    if (pTracker->info.budgetPercent == 0) {
+        pTracker->info.budgetPercent = DEFAULT_MEMORY_BUDGET_PERCENT;
+    }
+
+    pTracker->allocationCapacity = DEFAULT_TRACKED_ALLOCATION_CAPACITY;
+    pTracker->pAllocations = malloc(pTracker->allocationCapacity * sizeof(TrackedDeviceMemory));
+    if (pTracker->pAllocations == NULL)
+    {
+        puts("Failed to allocate the device memory tracker!");
+        return false;
+    }
+    InitializePlatformMutex(&pTracker->mutex);
+
+    vkGetPhysicalDeviceMemoryProperties(pCreateInfo->physicalDevice, &pTracker->memoryProperties);
+    QueryHeapBudgets(pTracker);
+    return true;
+}
+
+void DestroyDeviceMemoryTracker(DeviceMemoryTracker* pTracker)
+{
+    if (pTracker->pAllocations == NULL) return;
+
+    if (pTracker->allocationCount > 0) {
+        printf("%u device memory allocations were not freed!\n", pTracker->allocationCount);
+    }
+    free(pTracker->pAllocations);
+    DestroyPlatformMutex(&pTracker->mutex);
+    memset(pTracker, 0, sizeof(*pTracker));
+}
+
+void UpdateDeviceMemoryBudget(DeviceMemoryTracker* pTracker)
+{
+    LockPlatformMutex(&pTracker->mutex);
+    QueryHeapBudgets(pTracker);
+    UnlockPlatformMutex(&pTracker->mutex);
+}
+
+VkDeviceSize GetDeviceMemoryHeadroom(DeviceMemoryTracker* pTracker, uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredFlags)
+{
+    VkDeviceSize headroom = 0;
+    LockPlatformMutex(&pTracker->mutex);
+    for (uint32_t i = 0; i < pTracker->memoryProperties.memoryTypeCount; ++i)
+    {
+        const VkMemoryType* pType = &pTracker->memoryProperties.memoryTypes[i];
+        if ((memoryTypeBits & (1U << i)) == 0 || (pType->propertyFlags & requiredFlags) != requiredFlags) {
+            continue;
+        }
+        const VkDeviceSize usage = GetHeapUsage(pTracker, pType->heapIndex);
+        const VkDeviceSize allowance = GetHeapAllowance(pTracker, pType->heapIndex);
+        if (allowance > usage && allowance - usage > headroom) {
+            headroom = allowance - usage;
+        }
+    }
+    UnlockPlatformMutex(&pTracker->mutex);
+    return headroom;
+}
+
+// Picks the memory type to try next and reserves the size of the request in the budget of its heap, so that allocations made on
+// other threads meanwhile see it. `*pPass` carries on where the previous call stopped. Returns UINT32_MAX once every suitable
+// memory type has failed. The mutex MUST BE locked.
+static uint32_t ReserveDeviceMemoryType(DeviceMemoryTracker* pTracker, const DeviceMemoryRequest* pRequest, uint32_t failedTypeBits, uint32_t* pPass)
+{
+    const VkMemoryPropertyFlags preferredFlags = pRequest->requiredFlags | pRequest->preferredFlags;
+    // The first pass keeps to the budget with the preferred properties, the second with the required ones, the last ignores the budget.
+    for (; *pPass < 3; ++*pPass)
+    {
+        const VkMemoryPropertyFlags flags = *pPass == 0 ? preferredFlags : pRequest->requiredFlags;
+        for (uint32_t i = 0; i < pTracker->memoryProperties.memoryTypeCount; ++i)
+        {
+            const VkMemoryType* pType = &pTracker->memoryProperties.memoryTypes[i];
+            if ((pRequest->memoryTypeBits & ~failedTypeBits & (1U << i)) == 0 || (pType->propertyFlags & flags) != flags) {
+                continue;
+            }
+            if (*pPass < 2 && GetHeapUsage(pTracker, pType->heapIndex) + pRequest->size > GetHeapAllowance(pTracker, pType->heapIndex)) {
+                continue;
+            }
+            pTracker->heaps[pType->heapIndex].trackedBytes += pRequest->size;
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+VkResult AllocateTrackedDeviceMemory(DeviceMemoryTracker* pTracker, const DeviceMemoryRequest* pRequest, VkDeviceMemory* pMemory,
+                                     uint32_t* pMemoryTypeIndex)
+{
+    LockPlatformMutex(&pTracker->mutex);
+    // The slot is reserved up front, so that a successful allocation never has to grow the list
+    if (pTracker->allocationCount + pTracker->pendingAllocationCount == pTracker->allocationCapacity)
+    {
+        const uint32_t newCapacity = pTracker->allocationCapacity * 2;
+        TrackedDeviceMemory* pAllocations = realloc(pTracker->pAllocations, newCapacity * sizeof(TrackedDeviceMemory));
+        if (pAllocations == NULL)
+        {
+            UnlockPlatformMutex(&pTracker->mutex);
+            puts("Failed to grow the device memory tracker!");
+            return VK_ERROR_OUT_OF_HOST_MEMORY;
+        }
+        pTracker->pAllocations = pAllocations;
+        pTracker->allocationCapacity = newCapacity;
+    }
+    ++pTracker->pendingAllocationCount;
+
+    VkMemoryAllocateInfo allocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .pNext = pRequest->pNext,
+        .allocationSize = pRequest->size,
+        .memoryTypeIndex = 0
+    };
+    // A memory type that has failed once is not tried again
+    uint32_t failedTypeBits = 0;
+    uint32_t pass = 0;
+    uint32_t memoryTypeIndex;
+    VkResult res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    // vkAllocateMemory may take long, and the other threads allocating or freeing MUST NOT wait for it
+    while ((memoryTypeIndex = ReserveDeviceMemoryType(pTracker, pRequest, failedTypeBits, &pass)) != UINT32_MAX)
+    {
+        UnlockPlatformMutex(&pTracker->mutex);
+        allocateInfo.memoryTypeIndex = memoryTypeIndex;
+        res = vkAllocateMemory(pTracker->info.device, &allocateInfo, pTracker->info.pAllocator, pMemory);
+        LockPlatformMutex(&pTracker->mutex);
+        if (res == VK_SUCCESS) break;
+
+        pTracker->heaps[pTracker->memoryProperties.memoryTypes[memoryTypeIndex].heapIndex].trackedBytes -= pRequest->size;
+        failedTypeBits |= 1U << memoryTypeIndex;
+    }
+    --pTracker->pendingAllocationCount;
+
+    if (memoryTypeIndex == UINT32_MAX)
+    {
+        ++pTracker->failedCount;
+        UnlockPlatformMutex(&pTracker->mutex);
+        printf("No memory type could hold %llu bytes of %s memory: %d\n", (unsigned long long)pRequest->size,
+            GetDeviceMemoryCategoryName(pRequest->category), res);
+        return res;
+    }
+
+    const VkMemoryType* pType = &pTracker->memoryProperties.memoryTypes[memoryTypeIndex];
+    const VkMemoryPropertyFlags preferredFlags = pRequest->requiredFlags | pRequest->preferredFlags;
+    if ((pType->propertyFlags & preferredFlags) != preferredFlags) {
+        ++pTracker->fallbackCount;
+    }
+    if (pass == 2) {
+        ++pTracker->overBudgetCount;
+    }
+    pTracker->pAllocations[pTracker->allocationCount++] = (TrackedDeviceMemory){
+        .memory = *pMemory,
+        .size = pRequest->size,
+        .memoryTypeIndex = memoryTypeIndex,
+        .category = pRequest->category
+    };
+
+    // The size has been added to trackedBytes by ReserveDeviceMemoryType
+    MemoryHeapBudget* pHeap = &pTracker->heaps[pType->heapIndex];
+    if (pHeap->trackedBytes > pHeap->peakTrackedBytes) {
+        pHeap->peakTrackedBytes = pHeap->trackedBytes;
+    }
+    const VkDeviceSize usage = GetHeapUsage(pTracker, pType->heapIndex);
+    if (usage > pHeap->peakUsage) {
+        pHeap->peakUsage = usage;
+    }
+    DeviceMemoryCategoryStatistics* pCategory = &pTracker->categories[pRequest->category];
+    ++pCategory->allocationCount;
+    pCategory->currentBytes += pRequest->size;
+    if (pCategory->currentBytes > pCategory->peakBytes) {
+        pCategory->peakBytes = pCategory->currentBytes;
+    }
+    UnlockPlatformMutex(&pTracker->mutex);
+
+    if (pMemoryTypeIndex != NULL) {
+        *pMemoryTypeIndex = memoryTypeIndex;
+    }
+    return VK_SUCCESS;
+}
+
+void FreeTrackedDeviceMemory(DeviceMemoryTracker* pTracker, VkDeviceMemory memory)
+{
+    if (memory == VK_NULL_HANDLE) return;
+
+    LockPlatformMutex(&pTracker->mutex);
+    // The most recent allocations are usually freed first
+    for (uint32_t i = pTracker->allocationCount; i > 0; --i)
+    {
+        const TrackedDeviceMemory* pAllocation = &pTracker->pAllocations[i - 1];
+        if (pAllocation->memory != memory) continue;
+
+        const uint32_t heapIndex = pTracker->memoryProperties.memoryTypes[pAllocation->memoryTypeIndex].heapIndex;
+        pTracker->heaps[heapIndex].trackedBytes -= pAllocation->size;
+        pTracker->categories[pAllocation->category].currentBytes -= pAllocation->size;
+        pTracker->pAllocations[i - 1] = pTracker->pAllocations[--pTracker->allocationCount];
+        break;
+    }
+    UnlockPlatformMutex(&pTracker->mutex);
+
+    vkFreeMemory(pTracker->info.device, memory, pTracker->info.pAllocator);
+}
+
+VkResult AllocateReadbackDeviceMemory(DeviceMemoryTracker* pTracker, VkDevice device, const VkAllocationCallbacks* pAllocator,
+                                      const VkPhysicalDeviceMemoryProperties* pMemoryProperties, const VkMemoryRequirements* pRequirements,
+                                      VkDeviceMemory* pMemory, bool* pIsCoherent)
+{
+    // Reading uncached memory from the CPU is slow, so cached memory is preferred even if it has to be invalidated.
+    const VkMemoryPropertyFlags requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    const VkMemoryPropertyFlags preferredFlags = VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    VkResult res = VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    if (pTracker != NULL)
+    {
+        const DeviceMemoryRequest request = {
+            .pNext = NULL,
+            .size = pRequirements->size,
+            .memoryTypeBits = pRequirements->memoryTypeBits,
+            .requiredFlags = requiredFlags,
+            .preferredFlags = preferredFlags,
+            .category = DEVICE_MEMORY_CATEGORY_READBACK
+        };
+        res = AllocateTrackedDeviceMemory(pTracker, &request, pMemory, &memoryTypeIndex);
+        pMemoryProperties = &pTracker->memoryProperties;
+    }
+    else
+    {
+        // The same order as the tracker, without the budget
+        const VkMemoryPropertyFlags passFlags[2] = { requiredFlags | preferredFlags, requiredFlags };
+        for (uint32_t pass = 0; pass < 2 && memoryTypeIndex == UINT32_MAX; ++pass)
+        {
+            for (uint32_t i = 0; i < pMemoryProperties->memoryTypeCount; ++i)
+            {
+                if ((pRequirements->memoryTypeBits & (1U << i)) != 0 && (pMemoryProperties->memoryTypes[i].propertyFlags & passFlags[pass]) == passFlags[pass])
+                {
+                    memoryTypeIndex = i;
+                    break;
+                }
+            }
+        }
+        if (memoryTypeIndex == UINT32_MAX)
+        {
+            puts("No host visible memory type for readback!");
+            return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+        }
+        const VkMemoryAllocateInfo allocateInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = NULL,
+            .allocationSize = pRequirements->size,
+            .memoryTypeIndex = memoryTypeIndex
+        };
+        res = vkAllocateMemory(device, &allocateInfo, pAllocator, pMemory);
+    }
+    if (res != VK_SUCCESS) return res;
+
+    *pIsCoherent = (pMemoryProperties->memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) != 0;
+    return VK_SUCCESS;
+}
+
+void RecordDeviceMemoryDegradation(DeviceMemoryTracker* pTracker, DeviceMemoryCategory category, VkDeviceSize savedBytes)
+{
+    LockPlatformMutex(&pTracker->mutex);
+    ++pTracker->degradationCount;
+    pTracker->degradedBytes += savedBytes;
+    UnlockPlatformMutex(&pTracker->mutex);
+    printf("Saved %.1f KB of %s memory to stay within the memory budget\n", (double)savedBytes / 1024.0, GetDeviceMemoryCategoryName(category));
+}
+
+const char* GetDeviceMemoryCategoryName(DeviceMemoryCategory category)
+{
+    switch (category)
+    {
+    case DEVICE_MEMORY_CATEGORY_GEOMETRY:
+        return "geometry";
+    case DEVICE_MEMORY_CATEGORY_UNIFORM:
+        return "uniform";
+    case DEVICE_MEMORY_CATEGORY_TEXTURE:
+        return "texture";
+    case DEVICE_MEMORY_CATEGORY_RENDER_TARGET:
+        return "render_target";
+    case DEVICE_MEMORY_CATEGORY_DEPTH:
+        return "depth";
+    case DEVICE_MEMORY_CATEGORY_STAGING:
+        return "staging";
+    case DEVICE_MEMORY_CATEGORY_READBACK:
+        return "readback";
+    case DEVICE_MEMORY_CATEGORY_BENCHMARK:
+        return "benchmark";
+    default:
+        return "unknown";
+    }
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+
+enum MEMORY_TRACKER_CONSTANTS
+{
+    // Share of the budget of a heap the allocations are placed in first, the rest is left to the driver and the other processes
+    DEFAULT_MEMORY_BUDGET_PERCENT = 90,
+    // A plain run keeps about a dozen allocations alive. Every texture, mesh or render context adds a few.
+    DEFAULT_TRACKED_ALLOCATION_CAPACITY = 64
+};
+
+typedef enum DeviceMemoryCategory
+{
+    // Vertex, index and per-object buffers
+    DEVICE_MEMORY_CATEGORY_GEOMETRY,
+    // Uniform and descriptor buffers
+    DEVICE_MEMORY_CATEGORY_UNIFORM,
+    DEVICE_MEMORY_CATEGORY_TEXTURE,
+    DEVICE_MEMORY_CATEGORY_RENDER_TARGET,
+    DEVICE_MEMORY_CATEGORY_DEPTH,
+    // Upload rings written by the host
+    DEVICE_MEMORY_CATEGORY_STAGING,
+    // Buffers the host reads frames back from
+    DEVICE_MEMORY_CATEGORY_READBACK,
+    // Resources of the benchmarks run after the frames
+    DEVICE_MEMORY_CATEGORY_BENCHMARK,
+    DEVICE_MEMORY_CATEGORY_COUNT
+} DeviceMemoryCategory;
+
+typedef struct MemoryTrackerCreateInfo
+{
+    VkPhysicalDevice physicalDevice;
+    VkDevice device;
+    const VkAllocationCallbacks* pAllocator;
+    // VK_EXT_memory_budget is enabled on the device, which MUST support Vulkan 1.1. Otherwise the budget of a heap is its size
+    // and its usage is what has been allocated through the tracker.
+    bool isMemoryBudgetSupported;
+    // 0 for DEFAULT_MEMORY_BUDGET_PERCENT
+    uint32_t budgetPercent;
+    // Caps the budget of every heap, so a device with less memory can be simulated. 0 for no cap.
+    VkDeviceSize budgetLimit;
+} MemoryTrackerCreateInfo;
+
+typedef struct DeviceMemoryRequest
+{
+    // Chained to VkMemoryAllocateInfo, e.g. VkMemoryDedicatedAllocateInfo
+    const void* pNext;
+    VkDeviceSize size;
+    uint32_t memoryTypeBits;
+    // The memory type MUST have all of these
+    VkMemoryPropertyFlags requiredFlags;
+    // Memory types having all of these as well are tried first. Resources which still work from a slower memory type,
+    // e.g. geometry preferring VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, fall back to it instead of failing.
+    VkMemoryPropertyFlags preferredFlags;
+    DeviceMemoryCategory category;
+} DeviceMemoryRequest;
+
+typedef struct TrackedDeviceMemory
+{
+    VkDeviceMemory memory;
+    VkDeviceSize size;
+    uint32_t memoryTypeIndex;
+    DeviceMemoryCategory category;
+} TrackedDeviceMemory;
+
+typedef struct MemoryHeapBudget
+{
+    // The budget after budgetLimit, before budgetPercent
+    VkDeviceSize budget;
+    // Reported by VK_EXT_memory_budget at the last update, 0 without it
+    VkDeviceSize driverUsage;
+    VkDeviceSize trackedBytesAtUpdate;
+    VkDeviceSize trackedBytes;
+    VkDeviceSize peakTrackedBytes;
+    VkDeviceSize peakUsage;
+} MemoryHeapBudget;
+
+typedef struct DeviceMemoryCategoryStatistics
+{
+    uint32_t allocationCount;
+    VkDeviceSize currentBytes;
+    VkDeviceSize peakBytes;
+} DeviceMemoryCategoryStatistics;
+
+// Allocates all device memory by category and keeps every heap within its budget where possible. An allocation goes to the first
+// memory type with the preferred properties whose heap has room in the budget, then to one with only the required properties,
+// and only if no heap has room, over the budget. VK_ERROR_OUT_OF_DEVICE_MEMORY from one memory type moves on to the next, so an
+// allocation only fails once every suitable memory type has failed. Callers with optional quality ask GetDeviceMemoryHeadroom first
+// and shrink what they allocate, reporting it with RecordDeviceMemoryDegradation. Thread safe.
+typedef struct DeviceMemoryTracker
+{
+    MemoryTrackerCreateInfo info;
+    PlatformMutex mutex;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    MemoryHeapBudget heaps[VK_MAX_MEMORY_HEAPS];
+
+    TrackedDeviceMemory* pAllocations;
+    uint32_t allocationCount;
+    uint32_t allocationCapacity;
+    // Allocations waiting for vkAllocateMemory, which runs without the mutex. Each has a slot in pAllocations and its size
+    // in the trackedBytes of a heap reserved.
+    uint32_t pendingAllocationCount;
+
+    DeviceMemoryCategoryStatistics categories[DEVICE_MEMORY_CATEGORY_COUNT];
+    uint32_t budgetUpdateCount;
+    // Placed in a memory type without the preferred properties
+    uint32_t fallbackCount;
+    // Placed over the budget of their heap, since no suitable heap had room
+    uint32_t overBudgetCount;
+    // Failed in every suitable memory type
+    uint32_t failedCount;
+    uint32_t degradationCount;
+    VkDeviceSize degradedBytes;
+} DeviceMemoryTracker;
+
+extern bool CreateDeviceMemoryTracker(const MemoryTrackerCreateInfo* pCreateInfo, DeviceMemoryTracker* pTracker);
+// Every tracked allocation MUST have been freed.
+extern void DestroyDeviceMemoryTracker(DeviceMemoryTracker* pTracker);
+
+// Queries the budget and usage of every heap from the driver again. Without VK_EXT_memory_budget only the peaks are updated.
+extern void UpdateDeviceMemoryBudget(DeviceMemoryTracker* pTracker);
+// Returns the most bytes that fit within the budget in any memory type of `memoryTypeBits` having all of `requiredFlags`.
+extern VkDeviceSize GetDeviceMemoryHeadroom(DeviceMemoryTracker* pTracker, uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredFlags);
+
+// Returns the result of the last vkAllocateMemory tried, or VK_ERROR_OUT_OF_DEVICE_MEMORY if no memory type is suitable at all.
+// `pMemoryTypeIndex` may be NULL.
+extern VkResult AllocateTrackedDeviceMemory(DeviceMemoryTracker* pTracker, const DeviceMemoryRequest* pRequest, VkDeviceMemory* pMemory,
+                                            uint32_t* pMemoryTypeIndex);
+// Ignores VK_NULL_HANDLE, like vkFreeMemory.
+extern void FreeTrackedDeviceMemory(DeviceMemoryTracker* pTracker, VkDeviceMemory memory);
+// Allocates DEVICE_MEMORY_CATEGORY_READBACK memory the host reads frames back from, from the tracker if `pTracker` is not NULL, and
+// otherwise from the memory types of `pMemoryProperties` with `device` and `pAllocator`. `*pIsCoherent` tells whether the mapped memory
+// is host coherent, or has to be invalidated before it is read. Returns like AllocateTrackedDeviceMemory.
+extern VkResult AllocateReadbackDeviceMemory(DeviceMemoryTracker* pTracker, VkDevice device, const VkAllocationCallbacks* pAllocator,
+                                             const VkPhysicalDeviceMemoryProperties* pMemoryProperties, const VkMemoryRequirements* pRequirements,
+                                             VkDeviceMemory* pMemory, bool* pIsCoherent);
+// Records that a resource of the category was made `savedBytes` smaller than asked for to stay within the budget.
+extern void RecordDeviceMemoryDegradation(DeviceMemoryTracker* pTracker, DeviceMemoryCategory category, VkDeviceSize savedBytes);
+
+extern const char* GetDeviceMemoryCategoryName(DeviceMemoryCategory category);
@@ -0,0 +1,179 @@
+#include "mesh_file.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+static inline uint64_t AlignMeshFileOffset(uint64_t offset)
+{
+    return (offset + MESH_FILE_SECTION_ALIGNMENT - 1) & ~(uint64_t)(MESH_FILE_SECTION_ALIGNMENT - 1);
+}
+
+static bool IsMeshSectionInside(uint64_t offset, uint64_t elementCount, uint64_t elementSize, uint64_t fileSize)
+{
+    if (offset % MESH_FILE_SECTION_ALIGNMENT != 0 || offset < sizeof(MeshFileHeader) || offset > fileSize) return false;
+    // Written this way to avoid overflowing 64 bits with corrupted counts
+    return elementCount <= (fileSize - offset) / elementSize;
+}
+
+static bool ValidateMeshFileHeader(const MeshFileHeader* pHeader, uint64_t fileSize, const char* path)
+{
+    if (pHeader->magic != MESH_FILE_MAGIC || pHeader->formatVersion != MESH_FILE_FORMAT_VERSION)
+    {
+        printf("'%s' is not a mesh file of version %d!\n", path, MESH_FILE_FORMAT_VERSION);
+        return false;
+    }
+    if (pHeader->topology > VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP)
+    {
+        printf("Mesh file '%s' has an unsupported topology: %u\n", path, pHeader->topology);
+        return false;
+    }
+    if (pHeader->vertexStride == 0 || pHeader->attributeCount == 0 || pHeader->attributeCount > MAX_MESH_VERTEX_ATTRIBUTE_COUNT ||
+        pHeader->vertexCount == 0)
+    {
+        printf("Mesh file '%s' has an invalid vertex layout!\n", path);
+        return false;
+    }
+    for (uint32_t i = 0; i < pHeader->attributeCount; ++i)
+    {
+        // The format size is checked by the renderer, here only that the attribute starts inside a vertex.
+        if (pHeader->attributes[i].offset >= pHeader->vertexStride || pHeader->attributes[i].format == VK_FORMAT_UNDEFINED)
+        {
+            printf("Mesh file '%s' has an invalid vertex attribute %u!\n", path, i);
+            return false;
+        }
+    }
+    if (pHeader->indexSize != 0 && pHeader->indexSize != 2 && pHeader->indexSize != 4)
+    {
+        printf("Mesh file '%s' has an invalid index size: %u\n", path, pHeader->indexSize);
+        return false;
+    }
+    if (!IsMeshSectionInside(pHeader->vertexDataOffset, pHeader->vertexCount, pHeader->vertexStride, fileSize) ||
+        (pHeader->indexSize != 0 && (pHeader->indexCount == 0 ||
+                                     !IsMeshSectionInside(pHeader->indexDataOffset, pHeader->indexCount, pHeader->indexSize, fileSize))))
+    {
+        printf("Mesh file '%s' is truncated or has invalid section offsets!\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool OpenMeshFile(const char* path, MeshFile* pMeshFile)
+{
+    memset(pMeshFile, 0, sizeof(*pMeshFile));
+
+    if (!MapPlatformFile(path, &pMeshFile->mapping))
+    {
+        printf("Map mesh file '%s' failed!\n", path);
+        return false;
+    }
+
+    const MeshFileHeader* pHeader = pMeshFile->mapping.pData;
+    if (pMeshFile->mapping.size < sizeof(*pHeader))
+    {
+        printf("Mesh file '%s' is too small!\n", path);
+        CloseMeshFile(pMeshFile);
+        return false;
+    }
+    if (!ValidateMeshFileHeader(pHeader, pMeshFile->mapping.size, path))
+    {
+        CloseMeshFile(pMeshFile);
+        return false;
+    }
+
+    const uint8_t* pFileData = pMeshFile->mapping.pData;
+    pMeshFile->pHeader = pHeader;
+    pMeshFile->pVertexData = pFileData + pHeader->vertexDataOffset;
+    pMeshFile->vertexDataSize = pHeader->vertexCount * pHeader->vertexStride;
+    if (pHeader->indexSize != 0)
+    {
+        pMeshFile->pIndexData = pFileData + pHeader->indexDataOffset;
+        pMeshFile->indexDataSize = pHeader->indexCount * pHeader->indexSize;
+    }
+    return true;
+}
+
+void CloseMeshFile(MeshFile* pMeshFile)
+{
+    UnmapPlatformFile(&pMeshFile->mapping);
+    memset(pMeshFile, 0, sizeof(*pMeshFile));
+}
+
+static bool WriteMeshFilePadding(FILE* fp, uint64_t currOffset, uint64_t targetOffset)
+{
+    static const uint8_t zeros[MESH_FILE_SECTION_ALIGNMENT] = { 0 };
+    const size_t size = (size_t)(targetOffset - currOffset);
+    return size == 0 || fwrite(zeros, 1, size, fp) == size;
+}
+
+// Only positions made of 32-bit floats are read, the radius of any other format is -1.
+static float ComputeMeshPositionRadius(const MeshFileHeader* pHeader, const void* pVertexData)
+{
+    const uint8_t* pPositions = NULL;
+    uint32_t componentCount = 0;
+    for (uint32_t i = 0; i < pHeader->attributeCount; ++i)
+    {
+        const MeshVertexAttribute* pAttribute = &pHeader->attributes[i];
+        if (pAttribute->location != 0) continue;
+
+        if (pAttribute->format == VK_FORMAT_R32G32_SFLOAT) {
+            componentCount = 2;
+        }
+        else if (pAttribute->format == VK_FORMAT_R32G32B32_SFLOAT || pAttribute->format == VK_FORMAT_R32G32B32A32_SFLOAT) {
+            componentCount = 3;
+        }
+        pPositions = (const uint8_t*)pVertexData + pAttribute->offset;
+    }
+    if (componentCount == 0) return -1.0f;
+
+    float maxSquaredLength = 0.0f;
+    for (uint64_t v = 0; v < pHeader->vertexCount; ++v)
+    {
+        float position[3] = { 0.0f, 0.0f, 0.0f };
+        memcpy(position, pPositions + v * pHeader->vertexStride, componentCount * sizeof(float));
+        const float squaredLength = position[0] * position[0] + position[1] * position[1] + position[2] * position[2];
+        maxSquaredLength = squaredLength > maxSquaredLength ? squaredLength : maxSquaredLength;
+    }
+    return sqrtf(maxSquaredLength);
+}
+
+bool WriteMeshFile(const char* path, const MeshFileHeader* pLayout, const void* pVertexData, const void* pIndexData)
+{
+    MeshFileHeader header = *pLayout;
+    header.magic = MESH_FILE_MAGIC;
+    header.formatVersion = MESH_FILE_FORMAT_VERSION;
+    header.positionRadius = ComputeMeshPositionRadius(&header, pVertexData);
+    header.reserved = 0;
+    if (header.indexSize == 0) header.indexCount = 0;
+
+    const uint64_t vertexDataSize = header.vertexCount * header.vertexStride;
+    const uint64_t indexDataSize = header.indexCount * header.indexSize;
+    header.vertexDataOffset = AlignMeshFileOffset(sizeof(header));
+    header.indexDataOffset = indexDataSize > 0 ? AlignMeshFileOffset(header.vertexDataOffset + vertexDataSize) : 0;
+
+    FILE* fp = NULL;
+#ifdef _WIN32
+    if (fopen_s(&fp, path, "wb") != 0) fp = NULL;
+#else
+    fp = fopen(path, "wb");
+#endif // _WIN32
+    if (fp == NULL)
+    {
+        printf("Create mesh file '%s' failed!\n", path);
+        return false;
+    }
+
+    bool succeeded = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+                     WriteMeshFilePadding(fp, sizeof(header), header.vertexDataOffset) &&
+                     fwrite(pVertexData, 1, (size_t)vertexDataSize, fp) == (size_t)vertexDataSize;
+    if (succeeded && indexDataSize > 0)
+    {
+        succeeded = WriteMeshFilePadding(fp, header.vertexDataOffset + vertexDataSize, header.indexDataOffset) &&
+                    fwrite(pIndexData, 1, (size_t)indexDataSize, fp) == (size_t)indexDataSize;
+    }
+    if (fclose(fp) != 0) succeeded = false;
+
+    if (!succeeded) {
+        printf("Write mesh file '%s' failed!\n", path);
+    }
+    return succeeded;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+
+enum MESH_FILE_CONSTANTS
+{
+    // 'VSRM' in little endian
+    MESH_FILE_MAGIC = 0x4D525356,
+    // MUST BE increased whenever the layout of MeshFileHeader changes
+    MESH_FILE_FORMAT_VERSION = 2,
+    // The vertex and index sections start at multiples of this, which satisfies the alignment of any vertex format
+    // and of vkCmdCopyBuffer offsets, and keeps the sections page-friendly for the mapped reads.
+    MESH_FILE_SECTION_ALIGNMENT = 256,
+    MAX_MESH_VERTEX_ATTRIBUTE_COUNT = 8
+};
+
+typedef struct MeshVertexAttribute
+{
+    // Input location in the vertex shader
+    uint32_t location;
+    // VkFormat
+    uint32_t format;
+    // Byte offset inside a vertex
+    uint32_t offset;
+} MeshVertexAttribute;
+
+// Stored at offset 0 of a mesh file, followed by the vertex section and the optional index section.
+// All values are little endian.
+typedef struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t formatVersion;
+    // VkPrimitiveTopology, a list or strip of points, lines or triangles
+    uint32_t topology;
+    // All attributes are interleaved in one vertex buffer binding
+    uint32_t vertexStride;
+    uint32_t attributeCount;
+    // Size in bytes of an index: 2, 4 or 0 if the mesh is not indexed
+    uint32_t indexSize;
+    MeshVertexAttribute attributes[MAX_MESH_VERTEX_ATTRIBUTE_COUNT];
+    // Radius around the origin of the positions at location 0, so the bounds of the mesh are known without reading its vertices.
+    // Negative if the positions are not 32-bit floats.
+    float positionRadius;
+    uint32_t reserved;
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    // Byte offsets from the beginning of the file, multiples of MESH_FILE_SECTION_ALIGNMENT
+    uint64_t vertexDataOffset;
+    uint64_t indexDataOffset;
+} MeshFileHeader;
+
+static_assert(sizeof(MeshFileHeader) == 160U, "Invalid MeshFileHeader size");
+
+typedef struct MeshFile
+{
+    PlatformMappedFile mapping;
+    // Point into the mapping
+    const MeshFileHeader* pHeader;
+    const uint8_t* pVertexData;
+    const uint8_t* pIndexData;
+    uint64_t vertexDataSize;
+    uint64_t indexDataSize;
+} MeshFile;
+
+// Maps the mesh file at `path` and validates its header. No vertex or index data is read yet.
+extern bool OpenMeshFile(const char* path, MeshFile* pMeshFile);
+extern void CloseMeshFile(MeshFile* pMeshFile);
+
+// Writes a mesh file described by `pLayout`, of which the magic, the version, the position radius and the data offsets are filled here.
+// `pIndexData` is ignored if `pLayout->indexSize` is 0.
+extern bool WriteMeshFile(const char* path, const MeshFileHeader* pLayout, const void* pVertexData, const void* pIndexData);
@@ -0,0 +1,301 @@
+#include "mesh_importer.h"
+#include "mesh_file.h"
+#include "mesh_optimizer.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+enum MESH_IMPORTER_CONSTANTS
+{
+    MAX_OBJ_LINE_LENGTH = 4096,
+    // Half the edge length of the built-in square
+    IMPORTED_MESH_HALF_EXTENT_PERCENT = 20
+};
+
+// MUST match the vertex layout written by ImportObjMesh
+typedef struct ImportedVertex
+{
+    float position[4];
+    uint8_t color[4];
+} ImportedVertex;
+
+typedef struct ObjMeshData
+{
+    // 3 floats per vertex
+    float* positions;
+    // 3 floats per vertex, only valid if `hasColors`
+    float* colors;
+    size_t vertexCount;
+    size_t vertexCapacity;
+    uint32_t* indices;
+    size_t indexCount;
+    size_t indexCapacity;
+    bool hasColors;
+} ObjMeshData;
+
+static bool ReserveArray(void** ppArray, size_t* pCapacity, size_t requiredCount, size_t elementSize)
+{
+    if (requiredCount <= *pCapacity) return true;
+
+    size_t capacity = *pCapacity > 0 ? *pCapacity : 1024;
+    while (capacity < requiredCount) capacity *= 2;
+    void* pArray = realloc(*ppArray, capacity * elementSize);
+    if (pArray == NULL) return false;
+
+    *ppArray = pArray;
+    *pCapacity = capacity;
+    return true;
+}
+
+static bool ParseObjVertex(const char* text, ObjMeshData* pMesh)
+{
+    // Both arrays grow together, so they share `vertexCapacity`.
+    const size_t vertexCount = pMesh->vertexCount;
+    size_t positionCapacity = pMesh->vertexCapacity;
+    if (!ReserveArray((void**)&pMesh->positions, &positionCapacity, vertexCount + 1, sizeof(float[3])) ||
+        !ReserveArray((void**)&pMesh->colors, &pMesh->vertexCapacity, vertexCount + 1, sizeof(float[3]))) {
+        return false;
+    }
+
+    float values[6] = { 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f };
+    uint32_t valueCount = 0;
+    for (char* end = NULL; valueCount < 6; ++valueCount, text = end)
+    {
+        values[valueCount] = strtof(text, &end);
+        if (end == text) break;
+    }
+    if (valueCount < 3) return false;
+    // The color extension of some exporters: "v x y z r g b"
+    if (valueCount == 6) pMesh->hasColors = true;
+
+    memcpy(&pMesh->positions[vertexCount * 3], values, sizeof(float[3]));
+    memcpy(&pMesh->colors[vertexCount * 3], &values[3], sizeof(float[3]));
+    ++pMesh->vertexCount;
+    return true;
+}
+
+// Face elements are "v", "v/vt", "v//vn" or "v/vt/vn", of which only the position index is used.
+// Indices are 1-based, negative ones are relative to the last vertex.
+static bool ParseObjFace(const char* text, ObjMeshData* pMesh)
+{
+    uint32_t firstIndex = 0;
+    uint32_t prevIndex = 0;
+    uint32_t elementCount = 0;
+    while (true)
+    {
+        char* end = NULL;
+        const long index = strtol(text, &end, 10);
+        if (end == text) break;
+
+        const long resolvedIndex = index > 0 ? index - 1 : (long)pMesh->vertexCount + index;
+        if (index == 0 || resolvedIndex < 0 || (size_t)resolvedIndex >= pMesh->vertexCount) return false;
+
+        // Skip the texture coordinate and normal indices
+        while (*end != '\0' && !isspace((unsigned char)*end)) ++end;
+        text = end;
+
+        const uint32_t currIndex = (uint32_t)resolvedIndex;
+        if (elementCount == 0) {
+            firstIndex = currIndex;
+        }
+        else if (elementCount >= 2)
+        {
+            if (!ReserveArray((void**)&pMesh->indices, &pMesh->indexCapacity, pMesh->indexCount + 3, sizeof(uint32_t))) return false;
+            pMesh->indices[pMesh->indexCount++] = firstIndex;
+            pMesh->indices[pMesh->indexCount++] = prevIndex;
+            pMesh->indices[pMesh->indexCount++] = currIndex;
+        }
+        prevIndex = currIndex;
+        ++elementCount;
+    }
+    return elementCount >= 3;
+}
+
+static bool LoadObjMesh(const char* path, ObjMeshData* pMesh)
+{
+    FILE* fp = NULL;
+#ifdef _WIN32
+    if (fopen_s(&fp, path, "r") != 0) fp = NULL;
+#else
+    fp = fopen(path, "r");
+#endif // _WIN32
+    if (fp == NULL)
+    {
+        printf("Open OBJ file '%s' failed!\n", path);
+        return false;
+    }
+
+    char line[MAX_OBJ_LINE_LENGTH];
+    uint32_t lineNumber = 0;
+    bool succeeded = true;
+    while (succeeded && fgets(line, sizeof(line), fp) != NULL)
+    {
+        ++lineNumber;
+        if (strchr(line, '\n') == NULL && !feof(fp))
+        {
+            printf("Line %u of OBJ file '%s' is too long!\n", lineNumber, path);
+            succeeded = false;
+            break;
+        }
+
+        // Normals, texture coordinates, groups, materials and the rest are not needed.
+        if (line[0] == 'v' && isspace((unsigned char)line[1])) {
+            succeeded = ParseObjVertex(&line[2], pMesh);
+        }
+        else if (line[0] == 'f' && isspace((unsigned char)line[1])) {
+            succeeded = ParseObjFace(&line[2], pMesh);
+        }
+
+        if (!succeeded) {
+            printf("Invalid or out of memory at line %u of OBJ file '%s'!\n", lineNumber, path);
+        }
+    }
+    fclose(fp);
+
+    if (succeeded && pMesh->indexCount == 0)
+    {
+        printf("OBJ file '%s' has no faces!\n", path);
+        succeeded = false;
+    }
+    return succeeded;
+}
+
+// Centers the mesh and scales it to the size of the square. Y is flipped, since OBJ is y-up and the renderer's clip space is y-down.
+// Vertices without a color are colored by their position in the bounding box.
+static void ConvertObjVertices(const ObjMeshData* pMesh, ImportedVertex* pVertices)
+{
+    float minBounds[3] = { pMesh->positions[0], pMesh->positions[1], pMesh->positions[2] };
+    float maxBounds[3] = { pMesh->positions[0], pMesh->positions[1], pMesh->positions[2] };
+    for (size_t v = 1; v < pMesh->vertexCount; ++v)
+    {
+        for (size_t k = 0; k < 3; ++k)
+        {
+            const float value = pMesh->positions[v * 3 + k];
+            if (value < minBounds[k]) minBounds[k] = value;
+            if (value > maxBounds[k]) maxBounds[k] = value;
+        }
+    }
+    float maxExtent = 0.0f;
+    float center[3];
+    for (size_t k = 0; k < 3; ++k)
+    {
+        center[k] = (minBounds[k] + maxBounds[k]) * 0.5f;
+        if (maxBounds[k] - minBounds[k] > maxExtent) maxExtent = maxBounds[k] - minBounds[k];
+    }
+    const float scale = maxExtent > 0.0f ? 2.0f * IMPORTED_MESH_HALF_EXTENT_PERCENT / 100.0f / maxExtent : 1.0f;
+
+    for (size_t v = 0; v < pMesh->vertexCount; ++v)
+    {
+        const float* pPosition = &pMesh->positions[v * 3];
+        ImportedVertex* pVertex = &pVertices[v];
+        pVertex->position[0] = (pPosition[0] - center[0]) * scale;
+        pVertex->position[1] = -(pPosition[1] - center[1]) * scale;
+        pVertex->position[2] = (pPosition[2] - center[2]) * scale;
+        pVertex->position[3] = 1.0f;
+
+        for (size_t k = 0; k < 3; ++k)
+        {
+            float value = pMesh->hasColors ? pMesh->colors[v * 3 + k] :
+                          (maxBounds[k] > minBounds[k] ? (pPosition[k] - minBounds[k]) / (maxBounds[k] - minBounds[k]) : 0.5f);
+            value = value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            pVertex->color[k] = (uint8_t)(value * 255.0f + 0.5f);
+        }
+        pVertex->color[3] = 255;
+    }
+}
+
+static void PrintVertexStatistics(const char* stage, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    VertexCacheStatistics cacheStatistics;
+    VertexFetchStatistics fetchStatistics;
+    AnalyzeVertexCache(indices, indexCount, vertexCount, &cacheStatistics);
+    AnalyzeVertexFetch(indices, indexCount, vertexCount, sizeof(ImportedVertex), &fetchStatistics);
+    printf("  %-7s ACMR: %.3f  ATVR: %.3f  vertex fetch: %.1f KB  overfetch: %.3f\n", stage, cacheStatistics.acmr, cacheStatistics.atvr,
+        (double)fetchStatistics.bytesFetched / 1024.0, fetchStatistics.overfetch);
+}
+
+bool ImportObjMesh(const char* objPath, const char* meshPath)
+{
+    ObjMeshData mesh = { 0 };
+    ImportedVertex* vertices = NULL;
+    ImportedVertex* optimizedVertices = NULL;
+    uint32_t* cacheOrderIndices = NULL;
+    bool succeeded = false;
+    do
+    {
+        if (!LoadObjMesh(objPath, &mesh)) break;
+        if (mesh.vertexCount > UINT32_MAX || mesh.indexCount > UINT32_MAX)
+        {
+            printf("OBJ file '%s' is too large!\n", objPath);
+            break;
+        }
+
+        vertices = malloc(mesh.vertexCount * sizeof(ImportedVertex));
+        optimizedVertices = malloc(mesh.vertexCount * sizeof(ImportedVertex));
+        cacheOrderIndices = malloc(mesh.indexCount * sizeof(uint32_t));
+        if (vertices == NULL || optimizedVertices == NULL || cacheOrderIndices == NULL)
+        {
+            puts("Out of memory in ImportObjMesh!");
+            break;
+        }
+        ConvertObjVertices(&mesh, vertices);
+
+        printf("Importing '%s': %zu vertices, %zu triangles (FIFO cache of %d vertices, %d-byte fetch lines)\n",
+            objPath, mesh.vertexCount, mesh.indexCount / 3, VERTEX_CACHE_ANALYSIS_SIZE, VERTEX_FETCH_CACHE_LINE_SIZE);
+        PrintVertexStatistics("before", mesh.indices, mesh.indexCount, mesh.vertexCount);
+
+        // The overdraw pass moves whole clusters of the cache order around, so it runs after the cache pass
+        // and may only raise the ACMR by 5%. The vertices are reordered last, as they follow the final triangle order.
+        if (!OptimizeVertexCache(cacheOrderIndices, mesh.indices, mesh.indexCount, mesh.vertexCount) ||
+            !OptimizeOverdraw(mesh.indices, cacheOrderIndices, mesh.indexCount, vertices[0].position, mesh.vertexCount, sizeof(ImportedVertex), 1.05f))
+        {
+            puts("Out of memory in ImportObjMesh!");
+            break;
+        }
+        const size_t vertexCount = OptimizeVertexFetch(optimizedVertices, mesh.indices, mesh.indexCount, vertices, mesh.vertexCount,
+                                                       sizeof(ImportedVertex));
+        if (vertexCount == 0)
+        {
+            puts("Out of memory in ImportObjMesh!");
+            break;
+        }
+        PrintVertexStatistics("after", mesh.indices, mesh.indexCount, vertexCount);
+
+        MeshFileHeader layout = {
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+            .vertexStride = sizeof(ImportedVertex),
+            .attributeCount = 2,
+            .attributes = {
+                { .location = 0, .format = VK_FORMAT_R32G32B32A32_SFLOAT, .offset = offsetof(ImportedVertex, position) },
+                { .location = 1, .format = VK_FORMAT_R8G8B8A8_UNORM, .offset = offsetof(ImportedVertex, color) }
+            },
+            .vertexCount = vertexCount,
+            .indexCount = mesh.indexCount,
+            // 16-bit indices halve the index fetch whenever they are enough.
+            .indexSize = vertexCount <= UINT16_MAX + 1U ? 2 : 4
+        };
+        if (layout.indexSize == 2)
+        {
+            // Narrowed in place, every index is read before it is overwritten.
+            uint16_t* shortIndices = (uint16_t*)mesh.indices;
+            for (size_t i = 0; i < mesh.indexCount; ++i) {
+                shortIndices[i] = (uint16_t)mesh.indices[i];
+            }
+        }
+        succeeded = WriteMeshFile(meshPath, &layout, optimizedVertices, mesh.indices);
+        if (succeeded) {
+            printf("Mesh file '%s' written: %zu vertices, %zu %u-byte indices\n", meshPath, vertexCount, mesh.indexCount, layout.indexSize);
+        }
+    }
+    while (false);
+
+    free(cacheOrderIndices);
+    free(optimizedVertices);
+    free(vertices);
+    free(mesh.indices);
+    free(mesh.colors);
+    free(mesh.positions);
+    return succeeded;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdbool.h>
+
+// Converts a Wavefront OBJ file into a mesh file (see mesh_file.h) that the renderer draws in place of the square.
+// Only the vertex positions, optional vertex colors ("v x y z r g b") and faces are read; polygons are triangulated as fans.
+// The mesh is centered and scaled to the size of the square, its triangles are reordered for the post-transform vertex cache
+// and for overdraw, and its vertices for fetch locality. The vertex cache and fetch statistics are printed before and after.
+extern bool ImportObjMesh(const char* objPath, const char* meshPath);
@@ -0,0 +1,420 @@
+#include "mesh_optimizer.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct OverdrawCluster
+{
+    // Larger is drawn earlier
+    float sortKey;
+    uint32_t firstTriangle;
+    uint32_t triangleCount;
+} OverdrawCluster;
+
+// FIFO cache of vertex indices without any allocation, small enough for a linear search
+typedef struct FifoVertexCache
+{
+    uint32_t entries[VERTEX_CACHE_ANALYSIS_SIZE];
+    uint32_t count;
+    uint32_t next;
+} FifoVertexCache;
+
+// Returns true on a cache miss, which inserts the vertex.
+static bool AccessFifoVertexCache(FifoVertexCache* pCache, uint32_t vertex)
+{
+    for (uint32_t i = 0; i < pCache->count; ++i)
+    {
+        if (pCache->entries[i] == vertex) return false;
+    }
+    pCache->entries[pCache->next] = vertex;
+    pCache->next = (pCache->next + 1) % VERTEX_CACHE_ANALYSIS_SIZE;
+    if (pCache->count < VERTEX_CACHE_ANALYSIS_SIZE) ++pCache->count;
+    return true;
+}
+
+void AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, VertexCacheStatistics* pStatistics)
+{
+    FifoVertexCache cache = { 0 };
+    uint64_t transformCount = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        if (AccessFifoVertexCache(&cache, indices[i])) ++transformCount;
+    }
+
+    pStatistics->vertexTransformCount = transformCount;
+    pStatistics->acmr = indexCount >= 3 ? (float)transformCount / (float)(indexCount / 3) : 0.0f;
+    pStatistics->atvr = vertexCount > 0 ? (float)transformCount / (float)vertexCount : 0.0f;
+}
+
+void AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexStride,
+                        VertexFetchStatistics* pStatistics)
+{
+    uint64_t lineTags[VERTEX_FETCH_CACHE_LINE_COUNT];
+    memset(lineTags, 0xFF, sizeof(lineTags));
+
+    uint64_t bytesFetched = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint64_t begin = (uint64_t)indices[i] * vertexStride;
+        const uint64_t end = begin + vertexStride;
+        for (uint64_t line = begin / VERTEX_FETCH_CACHE_LINE_SIZE; line <= (end - 1) / VERTEX_FETCH_CACHE_LINE_SIZE; ++line)
+        {
+            uint64_t* pTag = &lineTags[line % VERTEX_FETCH_CACHE_LINE_COUNT];
+            if (*pTag != line)
+            {
+                *pTag = line;
+                bytesFetched += VERTEX_FETCH_CACHE_LINE_SIZE;
+            }
+        }
+    }
+
+    pStatistics->bytesFetched = bytesFetched;
+    pStatistics->overfetch = vertexCount > 0 ? (float)bytesFetched / (float)(vertexCount * vertexStride) : 0.0f;
+}
+
+// Forsyth's scoring: vertices recently used score higher, so do vertices with few remaining triangles,
+// which finishes off isolated parts of the mesh instead of leaving them for later.
+static float ComputeVertexCacheScore(int32_t cachePosition, uint32_t remainingTriangleCount)
+{
+    if (remainingTriangleCount == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0)
+    {
+        // The vertices of the last triangle get a fixed score, otherwise the order would prefer strips over fans.
+        if (cachePosition < 3) {
+            score = 0.75f;
+        }
+        else {
+            score = powf(1.0f - (float)(cachePosition - 3) / (float)(VERTEX_CACHE_OPTIMIZATION_SIZE - 3), 1.5f);
+        }
+    }
+    return score + 2.0f / sqrtf((float)remainingTriangleCount);
+}
+
+bool OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return true;
+
+    // Remaining triangles of every vertex are stored contiguously in `adjacency` from `adjacencyOffsets[v]`.
+    uint32_t* triangleCounts = calloc(vertexCount, sizeof(uint32_t));
+    uint32_t* adjacencyOffsets = malloc(vertexCount * sizeof(uint32_t));
+    uint32_t* adjacency = malloc(triangleCount * 3 * sizeof(uint32_t));
+    int32_t* cachePositions = malloc(vertexCount * sizeof(int32_t));
+    float* vertexScores = malloc(vertexCount * sizeof(float));
+    float* triangleScores = malloc(triangleCount * sizeof(float));
+    bool* isEmitted = calloc(triangleCount, sizeof(bool));
+    const bool succeeded = triangleCounts != NULL && adjacencyOffsets != NULL && adjacency != NULL && cachePositions != NULL &&
+                           vertexScores != NULL && triangleScores != NULL && isEmitted != NULL;
+    if (succeeded)
+    {
+        for (size_t i = 0; i < triangleCount * 3; ++i) {
+            ++triangleCounts[indices[i]];
+        }
+        uint32_t offset = 0;
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            adjacencyOffsets[v] = offset;
+            offset += triangleCounts[v];
+            triangleCounts[v] = 0;
+        }
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = indices[t * 3 + k];
+                adjacency[adjacencyOffsets[v] + triangleCounts[v]++] = (uint32_t)t;
+            }
+        }
+
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            cachePositions[v] = -1;
+            vertexScores[v] = ComputeVertexCacheScore(-1, triangleCounts[v]);
+        }
+        size_t bestTriangle = 0;
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            const uint32_t* pTriangle = &indices[t * 3];
+            triangleScores[t] = vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+            if (triangleScores[t] > triangleScores[bestTriangle]) bestTriangle = t;
+        }
+
+        uint32_t cache[VERTEX_CACHE_OPTIMIZATION_SIZE];
+        uint32_t cacheCount = 0;
+        size_t scanCursor = 0;
+        for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+        {
+            if (bestTriangle == SIZE_MAX)
+            {
+                // No triangle touches the cache any more, continue with any remaining one.
+                while (isEmitted[scanCursor]) ++scanCursor;
+                bestTriangle = scanCursor;
+            }
+
+            const uint32_t* pTriangle = &indices[bestTriangle * 3];
+            memcpy(&destination[emittedCount * 3], pTriangle, 3 * sizeof(uint32_t));
+            isEmitted[bestTriangle] = true;
+
+            // Three extra entries hold the vertices pushed out by the emitted triangle.
+            uint32_t newCache[VERTEX_CACHE_OPTIMIZATION_SIZE + 3];
+            uint32_t newCacheCount = 0;
+            for (uint32_t k = 0; k < 3; ++k)
+            {
+                const uint32_t v = pTriangle[k];
+                uint32_t* pList = &adjacency[adjacencyOffsets[v]];
+                for (uint32_t j = 0; j < triangleCounts[v]; ++j)
+                {
+                    if (pList[j] == bestTriangle)
+                    {
+                        pList[j] = pList[--triangleCounts[v]];
+                        break;
+                    }
+                }
+                // Degenerate triangles reference a vertex more than once
+                if ((k < 1 || pTriangle[0] != v) && (k < 2 || pTriangle[1] != v)) {
+                    newCache[newCacheCount++] = v;
+                }
+            }
+            for (uint32_t i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                if (v != pTriangle[0] && v != pTriangle[1] && v != pTriangle[2]) {
+                    newCache[newCacheCount++] = v;
+                }
+            }
+
+            // Rescore the cached vertices and the vertices pushed out of the cache, and propagate the changes to their triangles.
+            for (uint32_t i = 0; i < newCacheCount; ++i)
+            {
+                const uint32_t v = newCache[i];
+                cachePositions[v] = i < VERTEX_CACHE_OPTIMIZATION_SIZE ? (int32_t)i : -1;
+                const float score = ComputeVertexCacheScore(cachePositions[v], triangleCounts[v]);
+                const float scoreDelta = score - vertexScores[v];
+                vertexScores[v] = score;
+                for (uint32_t j = 0; j < triangleCounts[v]; ++j) {
+                    triangleScores[adjacency[adjacencyOffsets[v] + j]] += scoreDelta;
+                }
+            }
+            cacheCount = newCacheCount < VERTEX_CACHE_OPTIMIZATION_SIZE ? newCacheCount : VERTEX_CACHE_OPTIMIZATION_SIZE;
+            memcpy(cache, newCache, cacheCount * sizeof(uint32_t));
+
+            // Only triangles touching the cache are candidates, which keeps every step independent of the mesh size.
+            bestTriangle = SIZE_MAX;
+            float bestScore = -1.0f;
+            for (uint32_t i = 0; i < cacheCount; ++i)
+            {
+                const uint32_t v = cache[i];
+                for (uint32_t j = 0; j < triangleCounts[v]; ++j)
+                {
+                    const uint32_t t = adjacency[adjacencyOffsets[v] + j];
+                    if (triangleScores[t] > bestScore)
+                    {
+                        bestScore = triangleScores[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+    }
+
+    free(isEmitted);
+    free(triangleScores);
+    free(vertexScores);
+    free(cachePositions);
+    free(adjacency);
+    free(adjacencyOffsets);
+    free(triangleCounts);
+    return succeeded;
+}
+
+static int CompareOverdrawClusters(const void* pLeft, const void* pRight)
+{
+    const OverdrawCluster* pA = pLeft;
+    const OverdrawCluster* pB = pRight;
+    if (pA->sortKey != pB->sortKey) return pA->sortKey > pB->sortKey ? -1 : 1;
+    // Stable for equal keys
+    return pA->firstTriangle < pB->firstTriangle ? -1 : (pA->firstTriangle > pB->firstTriangle ? 1 : 0);
+}
+
+static inline const float* GetVertexPosition(const float* positions, size_t positionStride, uint32_t vertex)
+{
+    return (const float*)((const uint8_t*)positions + vertex * positionStride);
+}
+
+// Twice the area vector of a triangle, pointing along its front face normal
+static void ComputeTriangleNormal(const float* p0, const float* p1, const float* p2, float normal[3])
+{
+    const float e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    const float e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+// Splits the triangle list where the cache starts cold (hard boundaries), and inside these runs wherever the ACMR so far
+// is already below `threshold` times the ACMR of the run (soft boundaries), so that moving a cluster costs little locality.
+// Returns the number of clusters written to `clusters`.
+static uint32_t SplitOverdrawClusters(const uint32_t* indices, size_t triangleCount, float threshold, OverdrawCluster* clusters)
+{
+    uint32_t hardClusterCount = 0;
+    FifoVertexCache cache = { 0 };
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t missCount = 0;
+        for (size_t k = 0; k < 3; ++k) {
+            missCount += AccessFifoVertexCache(&cache, indices[t * 3 + k]) ? 1U : 0U;
+        }
+        if (t == 0 || missCount == 3) {
+            clusters[hardClusterCount++] = (OverdrawCluster){ .sortKey = 0.0f, .firstTriangle = (uint32_t)t, .triangleCount = 0 };
+        }
+        ++clusters[hardClusterCount - 1].triangleCount;
+    }
+
+    // The soft clusters are written into `clusters` while the hard clusters are read from a copy.
+    OverdrawCluster* hardClusters = malloc(hardClusterCount * sizeof(OverdrawCluster));
+    if (hardClusters == NULL) return hardClusterCount;
+    memcpy(hardClusters, clusters, hardClusterCount * sizeof(OverdrawCluster));
+
+    uint32_t clusterCount = 0;
+    for (uint32_t c = 0; c < hardClusterCount; ++c)
+    {
+        const uint32_t begin = hardClusters[c].firstTriangle;
+        const uint32_t end = begin + hardClusters[c].triangleCount;
+
+        uint32_t hardMissCount = 0;
+        memset(&cache, 0, sizeof(cache));
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            for (size_t k = 0; k < 3; ++k) {
+                hardMissCount += AccessFifoVertexCache(&cache, indices[t * 3 + k]) ? 1U : 0U;
+            }
+        }
+        const float clusterThreshold = threshold * (float)hardMissCount / (float)(end - begin);
+
+        uint32_t softBegin = begin;
+        uint32_t softMissCount = 0;
+        memset(&cache, 0, sizeof(cache));
+        for (uint32_t t = begin; t < end; ++t)
+        {
+            for (size_t k = 0; k < 3; ++k) {
+                softMissCount += AccessFifoVertexCache(&cache, indices[t * 3 + k]) ? 1U : 0U;
+            }
+            if ((float)softMissCount <= clusterThreshold * (float)(t + 1 - softBegin) || t + 1 == end)
+            {
+                clusters[clusterCount++] = (OverdrawCluster){ .sortKey = 0.0f, .firstTriangle = softBegin, .triangleCount = t + 1 - softBegin };
+                softBegin = t + 1;
+                softMissCount = 0;
+                memset(&cache, 0, sizeof(cache));
+            }
+        }
+    }
+    free(hardClusters);
+    return clusterCount;
+}
+
+bool OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+                      size_t positionStride, float threshold)
+{
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) return true;
+
+    OverdrawCluster* clusters = malloc(triangleCount * sizeof(OverdrawCluster));
+    if (clusters == NULL) return false;
+    const uint32_t clusterCount = SplitOverdrawClusters(indices, triangleCount, threshold, clusters);
+
+    // Area weighted centroid of the mesh
+    float meshCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    float meshArea = 0.0f;
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        const float* p0 = GetVertexPosition(positions, positionStride, indices[t * 3]);
+        const float* p1 = GetVertexPosition(positions, positionStride, indices[t * 3 + 1]);
+        const float* p2 = GetVertexPosition(positions, positionStride, indices[t * 3 + 2]);
+        float normal[3];
+        ComputeTriangleNormal(p0, p1, p2, normal);
+        const float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+        for (size_t k = 0; k < 3; ++k) {
+            meshCentroid[k] += (p0[k] + p1[k] + p2[k]) * area;
+        }
+        meshArea += area;
+    }
+    for (size_t k = 0; k < 3; ++k) {
+        meshCentroid[k] = meshArea > 0.0f ? meshCentroid[k] / (meshArea * 3.0f) : 0.0f;
+    }
+
+    // Clusters far out along their own normal occlude the rest of the mesh from most directions, so they go first.
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        float centroid[3] = { 0.0f, 0.0f, 0.0f };
+        float normalSum[3] = { 0.0f, 0.0f, 0.0f };
+        float clusterArea = 0.0f;
+        for (uint32_t t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].triangleCount; ++t)
+        {
+            const float* p0 = GetVertexPosition(positions, positionStride, indices[t * 3]);
+            const float* p1 = GetVertexPosition(positions, positionStride, indices[t * 3 + 1]);
+            const float* p2 = GetVertexPosition(positions, positionStride, indices[t * 3 + 2]);
+            float normal[3];
+            ComputeTriangleNormal(p0, p1, p2, normal);
+            const float area = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+            for (size_t k = 0; k < 3; ++k)
+            {
+                centroid[k] += (p0[k] + p1[k] + p2[k]) * area;
+                normalSum[k] += normal[k];
+            }
+            clusterArea += area;
+        }
+        const float normalLength = sqrtf(normalSum[0] * normalSum[0] + normalSum[1] * normalSum[1] + normalSum[2] * normalSum[2]);
+        float sortKey = 0.0f;
+        if (clusterArea > 0.0f && normalLength > 0.0f)
+        {
+            for (size_t k = 0; k < 3; ++k) {
+                sortKey += (centroid[k] / (clusterArea * 3.0f) - meshCentroid[k]) * normalSum[k] / normalLength;
+            }
+        }
+        clusters[c].sortKey = sortKey;
+    }
+    qsort(clusters, clusterCount, sizeof(OverdrawCluster), CompareOverdrawClusters);
+
+    size_t writtenIndexCount = 0;
+    for (uint32_t c = 0; c < clusterCount; ++c)
+    {
+        const size_t clusterIndexCount = (size_t)clusters[c].triangleCount * 3;
+        memcpy(&destination[writtenIndexCount], &indices[(size_t)clusters[c].firstTriangle * 3], clusterIndexCount * sizeof(uint32_t));
+        writtenIndexCount += clusterIndexCount;
+    }
+    free(clusters);
+
+    VertexCacheStatistics cacheOrderStatistics;
+    VertexCacheStatistics overdrawOrderStatistics;
+    AnalyzeVertexCache(indices, indexCount, vertexCount, &cacheOrderStatistics);
+    AnalyzeVertexCache(destination, indexCount, vertexCount, &overdrawOrderStatistics);
+    if (overdrawOrderStatistics.acmr > cacheOrderStatistics.acmr * threshold) {
+        memcpy(destination, indices, triangleCount * 3 * sizeof(uint32_t));
+    }
+    return true;
+}
+
+size_t OptimizeVertexFetch(void* destination, uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount,
+                           size_t vertexStride)
+{
+    uint32_t* remap = malloc(vertexCount * sizeof(uint32_t));
+    if (remap == NULL) return 0;
+    memset(remap, 0xFF, vertexCount * sizeof(uint32_t));
+
+    size_t newVertexCount = 0;
+    for (size_t i = 0; i < indexCount; ++i)
+    {
+        const uint32_t vertex = indices[i];
+        if (remap[vertex] == UINT32_MAX)
+        {
+            remap[vertex] = (uint32_t)newVertexCount;
+            memcpy((uint8_t*)destination + newVertexCount * vertexStride, (const uint8_t*)vertices + vertex * vertexStride, vertexStride);
+            ++newVertexCount;
+        }
+        indices[i] = remap[vertex];
+    }
+    free(remap);
+    return newVertexCount;
+}
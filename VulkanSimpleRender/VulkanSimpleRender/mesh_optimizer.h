@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+enum MESH_OPTIMIZER_CONSTANTS
+{
+    // Size of the FIFO post-transform cache used to report ACMR, a common size of the vertex reuse window of current GPUs
+    VERTEX_CACHE_ANALYSIS_SIZE = 16,
+    // Size of the LRU cache the triangle order is optimized for.
+    // Larger than the analysis cache, so the order is good for a range of hardware without being tuned to one.
+    VERTEX_CACHE_OPTIMIZATION_SIZE = 32,
+
+    // The vertex fetch analysis simulates a direct mapped cache of VERTEX_FETCH_CACHE_LINE_COUNT lines
+    VERTEX_FETCH_CACHE_LINE_SIZE = 64,
+    VERTEX_FETCH_CACHE_LINE_COUNT = 256
+};
+
+typedef struct VertexCacheStatistics
+{
+    uint64_t vertexTransformCount;
+    // Average cache miss ratio: transformed vertices per triangle, 0.5 at best for large regular meshes and 3 at worst
+    float acmr;
+    // Average transform to vertex ratio: transformed vertices per vertex, 1 at best
+    float atvr;
+} VertexCacheStatistics;
+
+typedef struct VertexFetchStatistics
+{
+    uint64_t bytesFetched;
+    // Bytes fetched per byte of vertex data, 1 at best
+    float overfetch;
+} VertexFetchStatistics;
+
+// Simulates a FIFO post-transform cache of VERTEX_CACHE_ANALYSIS_SIZE entries over a triangle list.
+extern void AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, VertexCacheStatistics* pStatistics);
+// Simulates the memory traffic of fetching the vertices of a triangle list in index order.
+extern void AnalyzeVertexFetch(const uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexStride,
+                               VertexFetchStatistics* pStatistics);
+
+// Reorders the triangles of a triangle list for post-transform vertex cache locality (Forsyth's linear-speed algorithm).
+// `destination` MUST NOT alias `indices`. Returns false if out of memory.
+extern bool OptimizeVertexCache(uint32_t* destination, const uint32_t* indices, size_t indexCount, size_t vertexCount);
+
+// Reorders clusters of a cache optimized triangle list so that outward facing clusters are drawn first, which reduces overdraw
+// from any view direction (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+// `positions` points to 3 floats per vertex, `positionStride` bytes apart. The cache order is kept if the ACMR would grow
+// by more than `threshold` times, e.g. 1.05. `destination` MUST NOT alias `indices`. Returns false if out of memory.
+extern bool OptimizeOverdraw(uint32_t* destination, const uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount,
+                             size_t positionStride, float threshold);
+
+// Reorders the vertices in the order they are first referenced and rewrites `indices` in place, so the vertices are fetched
+// almost sequentially. Unreferenced vertices are dropped. Returns the number of vertices written to `destination`, 0 if out of memory.
+extern size_t OptimizeVertexFetch(void* destination, uint32_t* indices, size_t indexCount, const void* vertices, size_t vertexCount,
+                                  size_t vertexStride);
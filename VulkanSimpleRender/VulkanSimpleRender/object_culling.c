@@ -0,0 +1,403 @@
+#include "object_culling.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define OBJECT_CULLING_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define OBJECT_CULLING_NEON
+#include <arm_neon.h>
+#endif
+
+// MSVC compiles AVX2 intrinsics anywhere, GCC and Clang only inside functions targeting AVX2.
+#if defined(OBJECT_CULLING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define CULLING_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CULLING_TARGET_AVX2
+#endif
+
+typedef struct CullingPlane
+{
+    float normal[3];
+    float distance;
+    // AABB bounds forming the corner farthest along the normal, which is outside the plane only if the whole box is
+    const float* pCorner[3];
+} CullingPlane;
+
+#ifdef OBJECT_CULLING_X86
+// Lane indices of the set bits of a 4-bit mask packed into bytes from the lowest one, and the number of set bits
+static const uint32_t s_compactedLanes[16] = {
+    0x00000000U, 0x00000000U, 0x00000001U, 0x00000100U, 0x00000002U, 0x00000200U, 0x00000201U, 0x00020100U,
+    0x00000003U, 0x00000300U, 0x00000301U, 0x00030100U, 0x00000302U, 0x00030200U, 0x00030201U, 0x03020100U
+};
+static const uint32_t s_setBitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+#endif // OBJECT_CULLING_X86
+
+bool CreateObjectStore(uint32_t capacity, ObjectStore* pStore)
+{
+    memset(pStore, 0, sizeof(*pStore));
+
+    const uint32_t paddedCapacity = (capacity + OBJECT_STORE_LANE_COUNT - 1) / OBJECT_STORE_LANE_COUNT * OBJECT_STORE_LANE_COUNT;
+    if (paddedCapacity == 0) return false;
+
+    float** const ppArrays[] = {
+        &pStore->positionX, &pStore->positionY, &pStore->positionZ, &pStore->radius,
+        &pStore->aabbMinX, &pStore->aabbMinY, &pStore->aabbMinZ, &pStore->aabbMaxX, &pStore->aabbMaxY, &pStore->aabbMaxZ
+    };
+    const size_t arrayCount = sizeof(ppArrays) / sizeof(ppArrays[0]);
+    // A multiple of OBJECT_STORE_ALIGNMENT, as aligned_alloc requires
+    const size_t allocationSize = (size_t)paddedCapacity * sizeof(float) * arrayCount;
+#ifdef _WIN32
+    pStore->pAllocation = _aligned_malloc(allocationSize, OBJECT_STORE_ALIGNMENT);
+#else
+    pStore->pAllocation = aligned_alloc(OBJECT_STORE_ALIGNMENT, allocationSize);
+#endif // _WIN32
+    if (pStore->pAllocation == NULL) return false;
+    // The padding is read by the kernels, zeros keep it free of NaNs and denormals.
+    memset(pStore->pAllocation, 0, allocationSize);
+
+    float* pArray = pStore->pAllocation;
+    for (size_t i = 0; i < arrayCount; ++i)
+    {
+        *ppArrays[i] = pArray;
+        pArray += paddedCapacity;
+    }
+
+    pStore->capacity = capacity;
+    pStore->paddedCapacity = paddedCapacity;
+    return true;
+}
+
+void DestroyObjectStore(ObjectStore* pStore)
+{
+#ifdef _WIN32
+    _aligned_free(pStore->pAllocation);
+#else
+    free(pStore->pAllocation);
+#endif // _WIN32
+    memset(pStore, 0, sizeof(*pStore));
+}
+
+bool AddObjectToStore(ObjectStore* pStore, const float position[3], const float halfExtents[3])
+{
+    if (pStore->count == pStore->capacity) return false;
+
+    SetObjectBounds(pStore, pStore->count++, position, halfExtents);
+    return true;
+}
+
+void SetObjectBounds(ObjectStore* pStore, uint32_t index, const float position[3], const float halfExtents[3])
+{
+    pStore->positionX[index] = position[0];
+    pStore->positionY[index] = position[1];
+    pStore->positionZ[index] = position[2];
+    pStore->radius[index] = sqrtf(halfExtents[0] * halfExtents[0] + halfExtents[1] * halfExtents[1] + halfExtents[2] * halfExtents[2]);
+    pStore->aabbMinX[index] = position[0] - halfExtents[0];
+    pStore->aabbMinY[index] = position[1] - halfExtents[1];
+    pStore->aabbMinZ[index] = position[2] - halfExtents[2];
+    pStore->aabbMaxX[index] = position[0] + halfExtents[0];
+    pStore->aabbMaxY[index] = position[1] + halfExtents[1];
+    pStore->aabbMaxZ[index] = position[2] + halfExtents[2];
+}
+
+void ExtractFrustumPlanes(const float viewProjection[16], Frustum* pFrustum)
+{
+    // Row i of the matrix is viewProjection[i], viewProjection[4 + i], ... since the matrix is column-major.
+    // A clip space position is inside if -w <= x <= w, -w <= y <= w and 0 <= z <= w, each bound is a plane of rows.
+    static const struct { int32_t row; float sign; bool addW; } s_planeRows[FRUSTUM_PLANE_COUNT] = {
+        { 0, 1.0f, true }, { 0, -1.0f, true }, { 1, 1.0f, true }, { 1, -1.0f, true }, { 2, 1.0f, false }, { 2, -1.0f, true }
+    };
+    for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+    {
+        float* plane = pFrustum->planes[p];
+        for (uint32_t column = 0; column < 4; ++column)
+        {
+            const float w = s_planeRows[p].addW ? viewProjection[column * 4 + 3] : 0.0f;
+            plane[column] = w + s_planeRows[p].sign * viewProjection[column * 4 + s_planeRows[p].row];
+        }
+        // Unit normals make the plane equation a signed distance, which the sphere test compares with the radius.
+        const float length = sqrtf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f)
+        {
+            for (uint32_t i = 0; i < 4; ++i) {
+                plane[i] /= length;
+            }
+        }
+    }
+}
+
+#ifdef OBJECT_CULLING_X86
+static bool IsAvx2Supported(void)
+{
+#ifdef _MSC_VER
+    int cpuInfo[4];
+    __cpuid(cpuInfo, 0);
+    if (cpuInfo[0] < 7) return false;
+    __cpuid(cpuInfo, 1);
+    // The OS MUST save the YMM registers on context switches
+    const bool isOsxsaveSupported = (cpuInfo[2] & (1 << 27)) != 0;
+    if (!isOsxsaveSupported || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(cpuInfo, 7, 0);
+    return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+    // Also checks that the OS saves the YMM registers
+    return __builtin_cpu_supports("avx2");
+#endif // _MSC_VER
+}
+#endif // OBJECT_CULLING_X86
+
+bool IsCullingKernelSupported(CullingKernel kernel)
+{
+    switch (kernel)
+    {
+    case CULLING_KERNEL_SCALAR:
+        return true;
+#ifdef OBJECT_CULLING_X86
+    case CULLING_KERNEL_SSE:
+        return true;
+    case CULLING_KERNEL_AVX2:
+        return IsAvx2Supported();
+#endif // OBJECT_CULLING_X86
+#ifdef OBJECT_CULLING_NEON
+    case CULLING_KERNEL_NEON:
+        return true;
+#endif // OBJECT_CULLING_NEON
+    default:
+        return false;
+    }
+}
+
+CullingKernel GetBestCullingKernel(void)
+{
+    const CullingKernel kernels[] = { CULLING_KERNEL_AVX2, CULLING_KERNEL_NEON, CULLING_KERNEL_SSE };
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+    {
+        if (IsCullingKernelSupported(kernels[i])) return kernels[i];
+    }
+    return CULLING_KERNEL_SCALAR;
+}
+
+const char* GetCullingKernelName(CullingKernel kernel)
+{
+    switch (kernel)
+    {
+    case CULLING_KERNEL_SCALAR:
+        return "scalar";
+    case CULLING_KERNEL_SSE:
+        return "sse";
+    case CULLING_KERNEL_AVX2:
+        return "avx2";
+    case CULLING_KERNEL_NEON:
+        return "neon";
+    default:
+        return "unknown";
+    }
+}
+
+// The distances are summed in the same order by every kernel, so they all classify the objects on the planes identically.
+static uint32_t CullObjectsScalar(const ObjectStore* pStore, const CullingPlane planes[], uint32_t first, uint32_t end, uint32_t* pVisibleIndices)
+{
+    uint32_t visibleCount = 0;
+    for (uint32_t i = first; i < end; ++i)
+    {
+        const float x = pStore->positionX[i];
+        const float y = pStore->positionY[i];
+        const float z = pStore->positionZ[i];
+        const float negRadius = 0.0f - pStore->radius[i];
+        bool isVisible = true;
+        for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT && isVisible; ++p)
+        {
+            const CullingPlane* pPlane = &planes[p];
+            const float sphereDistance = x * pPlane->normal[0] + y * pPlane->normal[1] + z * pPlane->normal[2] + pPlane->distance;
+            const float cornerDistance = pPlane->pCorner[0][i] * pPlane->normal[0] + pPlane->pCorner[1][i] * pPlane->normal[1] +
+                pPlane->pCorner[2][i] * pPlane->normal[2] + pPlane->distance;
+            isVisible = sphereDistance >= negRadius && cornerDistance >= 0.0f;
+        }
+        if (isVisible) {
+            pVisibleIndices[visibleCount++] = i;
+        }
+    }
+    return visibleCount;
+}
+
+// Appends base + i for every set bit i of `mask`. Every index is stored and the count only advances past the visible ones,
+// so no branch depends on the individual bits.
+static inline uint32_t AppendVisibleLanes(uint32_t* pVisibleIndices, uint32_t visibleCount, uint32_t base, uint32_t mask, uint32_t laneCount)
+{
+    for (uint32_t i = 0; i < laneCount; ++i)
+    {
+        pVisibleIndices[visibleCount] = base + i;
+        visibleCount += (mask >> i) & 1U;
+    }
+    return visibleCount;
+}
+
+// Lanes past the end of the range, possibly reading the zeroed padding of the store, are cleared from the mask.
+static inline uint32_t ClearPaddingLanes(uint32_t mask, uint32_t remainingCount, uint32_t laneCount)
+{
+    return remainingCount < laneCount ? mask & ((1U << remainingCount) - 1U) : mask;
+}
+
+#ifdef OBJECT_CULLING_X86
+static uint32_t CullObjectsSSE(const ObjectStore* pStore, const CullingPlane planes[], uint32_t first, uint32_t end, uint32_t* pVisibleIndices)
+{
+    uint32_t visibleCount = 0;
+    for (uint32_t base = first; base < end; base += 4)
+    {
+        const __m128 x = _mm_load_ps(&pStore->positionX[base]);
+        const __m128 y = _mm_load_ps(&pStore->positionY[base]);
+        const __m128 z = _mm_load_ps(&pStore->positionZ[base]);
+        const __m128 negRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_load_ps(&pStore->radius[base]));
+        __m128 visible = _mm_castsi128_ps(_mm_set1_epi32(-1));
+        for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+        {
+            const CullingPlane* pPlane = &planes[p];
+            const __m128 nx = _mm_set1_ps(pPlane->normal[0]);
+            const __m128 ny = _mm_set1_ps(pPlane->normal[1]);
+            const __m128 nz = _mm_set1_ps(pPlane->normal[2]);
+            const __m128 d = _mm_set1_ps(pPlane->distance);
+            const __m128 sphereDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, nx), _mm_mul_ps(y, ny)), _mm_mul_ps(z, nz)), d);
+            const __m128 cornerDistance = _mm_add_ps(_mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(_mm_load_ps(&pPlane->pCorner[0][base]), nx),
+                _mm_mul_ps(_mm_load_ps(&pPlane->pCorner[1][base]), ny)),
+                _mm_mul_ps(_mm_load_ps(&pPlane->pCorner[2][base]), nz)), d);
+            visible = _mm_and_ps(visible, _mm_and_ps(_mm_cmpge_ps(sphereDistance, negRadius), _mm_cmpge_ps(cornerDistance, _mm_setzero_ps())));
+        }
+
+        const uint32_t mask = ClearPaddingLanes((uint32_t)_mm_movemask_ps(visible), end - base, 4);
+        // Most objects are outside of a frustum in large scenes
+        if (mask == 0) continue;
+        visibleCount = AppendVisibleLanes(pVisibleIndices, visibleCount, base, mask, 4);
+    }
+    return visibleCount;
+}
+
+CULLING_TARGET_AVX2
+static uint32_t CullObjectsAVX2(const ObjectStore* pStore, const CullingPlane planes[], uint32_t first, uint32_t end, uint32_t* pVisibleIndices)
+{
+    const __m256i laneIndices = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    uint32_t visibleCount = 0;
+    for (uint32_t base = first; base < end; base += 8)
+    {
+        const __m256 x = _mm256_load_ps(&pStore->positionX[base]);
+        const __m256 y = _mm256_load_ps(&pStore->positionY[base]);
+        const __m256 z = _mm256_load_ps(&pStore->positionZ[base]);
+        const __m256 negRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_load_ps(&pStore->radius[base]));
+        __m256 visible = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+        for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+        {
+            const CullingPlane* pPlane = &planes[p];
+            const __m256 nx = _mm256_set1_ps(pPlane->normal[0]);
+            const __m256 ny = _mm256_set1_ps(pPlane->normal[1]);
+            const __m256 nz = _mm256_set1_ps(pPlane->normal[2]);
+            const __m256 d = _mm256_set1_ps(pPlane->distance);
+            const __m256 sphereDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, nx), _mm256_mul_ps(y, ny)),
+                                                                      _mm256_mul_ps(z, nz)), d);
+            const __m256 cornerDistance = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(_mm256_load_ps(&pPlane->pCorner[0][base]), nx),
+                _mm256_mul_ps(_mm256_load_ps(&pPlane->pCorner[1][base]), ny)),
+                _mm256_mul_ps(_mm256_load_ps(&pPlane->pCorner[2][base]), nz)), d);
+            visible = _mm256_and_ps(visible, _mm256_and_ps(_mm256_cmp_ps(sphereDistance, negRadius, _CMP_GE_OQ),
+                                                           _mm256_cmp_ps(cornerDistance, _mm256_setzero_ps(), _CMP_GE_OQ)));
+        }
+
+        const uint32_t mask = ClearPaddingLanes((uint32_t)_mm256_movemask_ps(visible), end - base, 8);
+        if (mask == 0) continue;
+
+        // Packs the visible lanes to the front with one permutation and stores all 8 lanes, the ones past the visible lanes
+        // are overwritten by the next store. The lane order of the high half follows the set bits of the low half.
+        const uint32_t lowMask = mask & 0xFU;
+        const uint32_t highMask = mask >> 4;
+        const uint64_t packedLanes = (uint64_t)s_compactedLanes[lowMask] |
+            ((uint64_t)(s_compactedLanes[highMask] + 0x04040404U) << (8 * s_setBitCounts[lowMask]));
+        const __m256i permutation = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&packedLanes));
+        const __m256i indices = _mm256_add_epi32(_mm256_set1_epi32((int)base), laneIndices);
+        _mm256_storeu_si256((__m256i*)&pVisibleIndices[visibleCount], _mm256_permutevar8x32_epi32(indices, permutation));
+        visibleCount += s_setBitCounts[lowMask] + s_setBitCounts[highMask];
+    }
+    return visibleCount;
+}
+#endif // OBJECT_CULLING_X86
+
+#ifdef OBJECT_CULLING_NEON
+static uint32_t CullObjectsNEON(const ObjectStore* pStore, const CullingPlane planes[], uint32_t first, uint32_t end, uint32_t* pVisibleIndices)
+{
+    const uint32_t laneBitValues[4] = { 1U, 2U, 4U, 8U };
+    const uint32x4_t laneBits = vld1q_u32(laneBitValues);
+    uint32_t visibleCount = 0;
+    for (uint32_t base = first; base < end; base += 4)
+    {
+        const float32x4_t x = vld1q_f32(&pStore->positionX[base]);
+        const float32x4_t y = vld1q_f32(&pStore->positionY[base]);
+        const float32x4_t z = vld1q_f32(&pStore->positionZ[base]);
+        const float32x4_t negRadius = vsubq_f32(vdupq_n_f32(0.0f), vld1q_f32(&pStore->radius[base]));
+        uint32x4_t visible = vdupq_n_u32(UINT32_MAX);
+        for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+        {
+            const CullingPlane* pPlane = &planes[p];
+            const float32x4_t nx = vdupq_n_f32(pPlane->normal[0]);
+            const float32x4_t ny = vdupq_n_f32(pPlane->normal[1]);
+            const float32x4_t nz = vdupq_n_f32(pPlane->normal[2]);
+            const float32x4_t d = vdupq_n_f32(pPlane->distance);
+            // Separate multiplies and adds rather than fused ones, to round like the other kernels
+            const float32x4_t sphereDistance = vaddq_f32(vaddq_f32(vaddq_f32(vmulq_f32(x, nx), vmulq_f32(y, ny)), vmulq_f32(z, nz)), d);
+            const float32x4_t cornerDistance = vaddq_f32(vaddq_f32(vaddq_f32(
+                vmulq_f32(vld1q_f32(&pPlane->pCorner[0][base]), nx),
+                vmulq_f32(vld1q_f32(&pPlane->pCorner[1][base]), ny)),
+                vmulq_f32(vld1q_f32(&pPlane->pCorner[2][base]), nz)), d);
+            visible = vandq_u32(visible, vandq_u32(vcgeq_f32(sphereDistance, negRadius), vcgeq_f32(cornerDistance, vdupq_n_f32(0.0f))));
+        }
+
+        const uint32_t mask = ClearPaddingLanes(vaddvq_u32(vandq_u32(visible, laneBits)), end - base, 4);
+        if (mask == 0) continue;
+        visibleCount = AppendVisibleLanes(pVisibleIndices, visibleCount, base, mask, 4);
+    }
+    return visibleCount;
+}
+#endif // OBJECT_CULLING_NEON
+
+uint32_t CullObjectRange(const ObjectStore* pStore, const Frustum* pFrustum, CullingKernel kernel, uint32_t firstObject, uint32_t objectCount,
+                         uint32_t* pVisibleIndices)
+{
+    const uint32_t endObject = firstObject + objectCount;
+
+    CullingPlane planes[FRUSTUM_PLANE_COUNT];
+    for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+    {
+        const float* plane = pFrustum->planes[p];
+        CullingPlane* pPlane = &planes[p];
+        pPlane->normal[0] = plane[0];
+        pPlane->normal[1] = plane[1];
+        pPlane->normal[2] = plane[2];
+        pPlane->distance = plane[3];
+        pPlane->pCorner[0] = plane[0] >= 0.0f ? pStore->aabbMaxX : pStore->aabbMinX;
+        pPlane->pCorner[1] = plane[1] >= 0.0f ? pStore->aabbMaxY : pStore->aabbMinY;
+        pPlane->pCorner[2] = plane[2] >= 0.0f ? pStore->aabbMaxZ : pStore->aabbMinZ;
+    }
+
+    switch (kernel)
+    {
+#ifdef OBJECT_CULLING_X86
+    case CULLING_KERNEL_SSE:
+        return CullObjectsSSE(pStore, planes, firstObject, endObject, pVisibleIndices);
+    case CULLING_KERNEL_AVX2:
+        return CullObjectsAVX2(pStore, planes, firstObject, endObject, pVisibleIndices);
+#endif // OBJECT_CULLING_X86
+#ifdef OBJECT_CULLING_NEON
+    case CULLING_KERNEL_NEON:
+        return CullObjectsNEON(pStore, planes, firstObject, endObject, pVisibleIndices);
+#endif // OBJECT_CULLING_NEON
+    default:
+        return CullObjectsScalar(pStore, planes, firstObject, endObject, pVisibleIndices);
+    }
+}
+
+uint32_t CullObjects(const ObjectStore* pStore, const Frustum* pFrustum, CullingKernel kernel, uint32_t* pVisibleIndices)
+{
+    return CullObjectRange(pStore, pFrustum, kernel, 0, pStore->count, pVisibleIndices);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum OBJECT_CULLING_CONSTANTS
+{
+    // Every array of an ObjectStore is aligned to this and padded to a multiple of OBJECT_STORE_LANE_COUNT elements,
+    // so the widest kernel only issues aligned full-width loads.
+    OBJECT_STORE_ALIGNMENT = 32,
+    OBJECT_STORE_LANE_COUNT = 8,
+    FRUSTUM_PLANE_COUNT = 6
+};
+
+typedef enum CullingKernel
+{
+    CULLING_KERNEL_SCALAR,
+    // 4 objects per iteration
+    CULLING_KERNEL_SSE,
+    // 8 objects per iteration, the visible indices are compacted with a lane permutation
+    CULLING_KERNEL_AVX2,
+    // 4 objects per iteration
+    CULLING_KERNEL_NEON,
+    CULLING_KERNEL_COUNT
+} CullingKernel;
+
+// Bounds of the objects in world space as a structure of arrays, so a kernel loads the same field of consecutive objects
+// with one vector load. The bounding sphere of an object is centered at its position.
+typedef struct ObjectStore
+{
+    float* positionX;
+    float* positionY;
+    float* positionZ;
+    float* radius;
+    float* aabbMinX;
+    float* aabbMinY;
+    float* aabbMinZ;
+    float* aabbMaxX;
+    float* aabbMaxY;
+    float* aabbMaxZ;
+    uint32_t count;
+    uint32_t capacity;
+    // `capacity` rounded up to a multiple of OBJECT_STORE_LANE_COUNT, the length of every array
+    uint32_t paddedCapacity;
+    // All arrays are carved out of this allocation
+    void* pAllocation;
+} ObjectStore;
+
+// Planes of the form dot(normal, p) + distance >= 0 inside the frustum, with unit normals pointing inwards
+typedef struct Frustum
+{
+    float planes[FRUSTUM_PLANE_COUNT][4];
+} Frustum;
+
+// Returns false if out of memory.
+extern bool CreateObjectStore(uint32_t capacity, ObjectStore* pStore);
+extern void DestroyObjectStore(ObjectStore* pStore);
+// Appends an object bounded by the box of `halfExtents` around `position`. Returns false if the store is full.
+extern bool AddObjectToStore(ObjectStore* pStore, const float position[3], const float halfExtents[3]);
+// Moves the object `index`, which MUST BE in the store, to the box of `halfExtents` around `position`.
+extern void SetObjectBounds(ObjectStore* pStore, uint32_t index, const float position[3], const float halfExtents[3]);
+
+// Extracts the planes of the clip volume of a column-major view-projection matrix with the Vulkan depth range 0 <= z <= w.
+extern void ExtractFrustumPlanes(const float viewProjection[16], Frustum* pFrustum);
+
+// Whether the kernel is compiled for this target and supported by the CPU
+extern bool IsCullingKernelSupported(CullingKernel kernel);
+// The widest supported kernel
+extern CullingKernel GetBestCullingKernel(void);
+extern const char* GetCullingKernelName(CullingKernel kernel);
+
+// Writes the indices of the objects whose bounding sphere and AABB both intersect the frustum to `pVisibleIndices` in ascending order,
+// and returns their count. Every kernel gives the same result. `pVisibleIndices` MUST hold `pStore->paddedCapacity` elements,
+// since the wider kernels store full vectors past the last visible index. `kernel` MUST BE supported.
+extern uint32_t CullObjects(const ObjectStore* pStore, const Frustum* pFrustum, CullingKernel kernel, uint32_t* pVisibleIndices);
+// Culls the objects [firstObject, firstObject + objectCount) like CullObjects, so ranges can be culled in parallel.
+// `firstObject` MUST BE a multiple of OBJECT_STORE_LANE_COUNT. The indices written are indices into the store, and `pVisibleIndices`
+// MUST hold `objectCount` rounded up to a multiple of OBJECT_STORE_LANE_COUNT elements.
+extern uint32_t CullObjectRange(const ObjectStore* pStore, const Frustum* pFrustum, CullingKernel kernel, uint32_t firstObject, uint32_t objectCount,
+                                uint32_t* pVisibleIndices);
@@ -0,0 +1,522 @@
+#include "platform_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct PlatformThreadStartContext
+{
+    PFN_PlatformThreadRoutine routine;
+    void* pArgument;
+} PlatformThreadStartContext;
+
+// Parses "fd:<n>"
+static bool ParseFileDescriptor(const char* path, unsigned int* pFd)
+{
+    if (strncmp(path, "fd:", 3) != 0 || path[3] < '0' || path[3] > '9') return false;
+    char* pEnd = NULL;
+    const unsigned long fd = strtoul(path + 3, &pEnd, 10);
+    if (*pEnd != '\0' || fd > INT32_MAX) return false;
+    *pFd = (unsigned int)fd;
+    return true;
+}
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+
+uint64_t GetCurrentTimeNanoseconds(void)
+{
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    // Split the conversion into seconds and the remainder to avoid overflowing 64 bits
+    const uint64_t freq = (uint64_t)frequency.QuadPart;
+    const uint64_t ticks = (uint64_t)counter.QuadPart;
+    return (ticks / freq) * 1000000000ULL + (ticks % freq) * 1000000000ULL / freq;
+}
+
+uint32_t GetLogicalProcessorCount(void)
+{
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    return systemInfo.dwNumberOfProcessors > 0 ? (uint32_t)systemInfo.dwNumberOfProcessors : 1U;
+}
+
+bool GetEnvironmentVariableString(const char* name, char* buffer, size_t bufferSize)
+{
+    size_t requiredSize = 0;
+    // `requiredSize` includes the terminating null character and is 0 if the variable does not exist.
+    return getenv_s(&requiredSize, buffer, bufferSize, name) == 0 && requiredSize > 1;
+}
+
+static DWORD WINAPI PlatformThreadStart(LPVOID lpParameter)
+{
+    const PlatformThreadStartContext context = *(PlatformThreadStartContext*)lpParameter;
+    free(lpParameter);
+
+    context.routine(context.pArgument);
+    return 0;
+}
+
+bool CreatePlatformThread(PlatformThread* pThread, PFN_PlatformThreadRoutine routine, void* pArgument)
+{
+    PlatformThreadStartContext* pContext = malloc(sizeof(*pContext));
+    if (pContext == NULL) return false;
+
+    pContext->routine = routine;
+    pContext->pArgument = pArgument;
+    *pThread = CreateThread(NULL, 0, PlatformThreadStart, pContext, 0, NULL);
+    if (*pThread == NULL)
+    {
+        free(pContext);
+        return false;
+    }
+    return true;
+}
+
+void JoinPlatformThread(PlatformThread thread)
+{
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void YieldPlatformThread(void)
+{
+    SwitchToThread();
+}
+
+void InitializePlatformMutex(PlatformMutex* pMutex)
+{
+    InitializeSRWLock(pMutex);
+}
+
+void DestroyPlatformMutex(PlatformMutex* pMutex)
+{
+    // SRW locks need no cleanup
+    (void)pMutex;
+}
+
+void LockPlatformMutex(PlatformMutex* pMutex)
+{
+    AcquireSRWLockExclusive(pMutex);
+}
+
+void UnlockPlatformMutex(PlatformMutex* pMutex)
+{
+    ReleaseSRWLockExclusive(pMutex);
+}
+
+void InitializePlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    InitializeConditionVariable(pConditionVariable);
+}
+
+void DestroyPlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    // Condition variables need no cleanup
+    (void)pConditionVariable;
+}
+
+void WaitPlatformConditionVariable(PlatformConditionVariable* pConditionVariable, PlatformMutex* pMutex)
+{
+    SleepConditionVariableSRW(pConditionVariable, pMutex, INFINITE, 0);
+}
+
+void WakeAllPlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    WakeAllConditionVariable(pConditionVariable);
+}
+
+bool MapPlatformFile(const char* path, PlatformMappedFile* pMappedFile)
+{
+    memset(pMappedFile, 0, sizeof(*pMappedFile));
+
+    const HANDLE hFile = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (hFile == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart <= 0)
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const HANDLE hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (hMapping == NULL)
+    {
+        CloseHandle(hFile);
+        return false;
+    }
+
+    const void* pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (pData == NULL)
+    {
+        CloseHandle(hMapping);
+        CloseHandle(hFile);
+        return false;
+    }
+
+    pMappedFile->pData = pData;
+    pMappedFile->size = (uint64_t)fileSize.QuadPart;
+    pMappedFile->hFile = hFile;
+    pMappedFile->hMapping = hMapping;
+    return true;
+}
+
+void UnmapPlatformFile(PlatformMappedFile* pMappedFile)
+{
+    if (pMappedFile->pData != NULL) UnmapViewOfFile(pMappedFile->pData);
+    if (pMappedFile->hMapping != NULL) CloseHandle(pMappedFile->hMapping);
+    if (pMappedFile->hFile != NULL) CloseHandle(pMappedFile->hFile);
+    memset(pMappedFile, 0, sizeof(*pMappedFile));
+}
+
+void ReleasePlatformFileRange(const PlatformMappedFile* pMappedFile, uint64_t offset, uint64_t size)
+{
+    // Unlocking pages that are not locked removes them from the working set of the process.
+    // The call fails with ERROR_NOT_LOCKED by design, so the result is ignored.
+    if (offset < pMappedFile->size) {
+        VirtualUnlock((LPVOID)((const uint8_t*)pMappedFile->pData + offset), (SIZE_T)min(size, pMappedFile->size - offset));
+    }
+}
+
+FILE* OpenPlatformOutputStream(const char* path)
+{
+    unsigned int fd = 0;
+    if (ParseFileDescriptor(path, &fd))
+    {
+        // The descriptor is inherited in text mode, which would expand every 0x0A byte
+        if (_setmode((int)fd, _O_BINARY) == -1) return NULL;
+        return _fdopen((int)fd, "wb");
+    }
+    // Also opens named pipes, given as \\.\pipe\<name>
+    FILE* fp = NULL;
+    return fopen_s(&fp, path, "wb") == 0 ? fp : NULL;
+}
+
+FILE* DetachPlatformStandardOutput(void)
+{
+    fflush(stdout);
+    const int outputFd = _dup(_fileno(stdout));
+    if (outputFd == -1) return NULL;
+    FILE* fp = _fdopen(outputFd, "w");
+    if (fp == NULL || _dup2(_fileno(stderr), _fileno(stdout)) != 0)
+    {
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        else {
+            _close(outputFd);
+        }
+        return NULL;
+    }
+    return fp;
+}
+
+bool SendPlatformSocketPacket(int socketFd, const void* pData, size_t size, const int* pFds, uint32_t fdCount)
+{
+    (void)socketFd; (void)pData; (void)size; (void)pFds; (void)fdCount;
+    return false;
+}
+
+bool ReceivePlatformSocketPacket(int socketFd, void* pData, size_t size, size_t* pPacketSize, int* pFds, uint32_t maxFdCount,
+                                 uint32_t* pFdCount)
+{
+    (void)socketFd; (void)pData; (void)size; (void)pFds; (void)maxFdCount;
+    *pPacketSize = 0;
+    *pFdCount = 0;
+    return false;
+}
+
+#else
+#include <time.h>
+#include <signal.h>
+#include <sched.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+uint64_t GetCurrentTimeNanoseconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t GetLogicalProcessorCount(void)
+{
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (uint32_t)count : 1U;
+}
+
+bool GetEnvironmentVariableString(const char* name, char* buffer, size_t bufferSize)
+{
+    const char* value = getenv(name);
+    if (value == NULL || value[0] == '\0') return false;
+
+    const size_t length = strlen(value);
+    if (length >= bufferSize) return false;
+    memcpy(buffer, value, length + 1);
+    return true;
+}
+
+static void* PlatformThreadStart(void* pParameter)
+{
+    const PlatformThreadStartContext context = *(PlatformThreadStartContext*)pParameter;
+    free(pParameter);
+
+    context.routine(context.pArgument);
+    return NULL;
+}
+
+bool CreatePlatformThread(PlatformThread* pThread, PFN_PlatformThreadRoutine routine, void* pArgument)
+{
+    PlatformThreadStartContext* pContext = malloc(sizeof(*pContext));
+    if (pContext == NULL) return false;
+
+    pContext->routine = routine;
+    pContext->pArgument = pArgument;
+    if (pthread_create(pThread, NULL, PlatformThreadStart, pContext) != 0)
+    {
+        free(pContext);
+        return false;
+    }
+    return true;
+}
+
+void JoinPlatformThread(PlatformThread thread)
+{
+    pthread_join(thread, NULL);
+}
+
+void YieldPlatformThread(void)
+{
+    sched_yield();
+}
+
+void InitializePlatformMutex(PlatformMutex* pMutex)
+{
+    pthread_mutex_init(pMutex, NULL);
+}
+
+void DestroyPlatformMutex(PlatformMutex* pMutex)
+{
+    pthread_mutex_destroy(pMutex);
+}
+
+void LockPlatformMutex(PlatformMutex* pMutex)
+{
+    pthread_mutex_lock(pMutex);
+}
+
+void UnlockPlatformMutex(PlatformMutex* pMutex)
+{
+    pthread_mutex_unlock(pMutex);
+}
+
+void InitializePlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    pthread_cond_init(pConditionVariable, NULL);
+}
+
+void DestroyPlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    pthread_cond_destroy(pConditionVariable);
+}
+
+void WaitPlatformConditionVariable(PlatformConditionVariable* pConditionVariable, PlatformMutex* pMutex)
+{
+    pthread_cond_wait(pConditionVariable, pMutex);
+}
+
+void WakeAllPlatformConditionVariable(PlatformConditionVariable* pConditionVariable)
+{
+    pthread_cond_broadcast(pConditionVariable);
+}
+
+bool MapPlatformFile(const char* path, PlatformMappedFile* pMappedFile)
+{
+    memset(pMappedFile, 0, sizeof(*pMappedFile));
+    pMappedFile->fd = -1;
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    void* pData = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (pData == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+    // Let the kernel read ahead aggressively and drop the pages behind
+    madvise(pData, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+
+    pMappedFile->pData = pData;
+    pMappedFile->size = (uint64_t)fileStat.st_size;
+    pMappedFile->fd = fd;
+    return true;
+}
+
+void UnmapPlatformFile(PlatformMappedFile* pMappedFile)
+{
+    if (pMappedFile->pData != NULL) munmap((void*)pMappedFile->pData, (size_t)pMappedFile->size);
+    if (pMappedFile->fd >= 0) close(pMappedFile->fd);
+    memset(pMappedFile, 0, sizeof(*pMappedFile));
+    pMappedFile->fd = -1;
+}
+
+void ReleasePlatformFileRange(const PlatformMappedFile* pMappedFile, uint64_t offset, uint64_t size)
+{
+    if (offset >= pMappedFile->size) return;
+
+    // madvise requires a page aligned address, so only whole pages inside the range are released.
+    const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    const uint64_t end = offset + size < pMappedFile->size ? offset + size : pMappedFile->size;
+    const uint64_t alignedBegin = (offset + pageSize - 1) / pageSize * pageSize;
+    const uint64_t alignedEnd = end == pMappedFile->size ? end : end / pageSize * pageSize;
+    if (alignedEnd > alignedBegin) {
+        madvise((uint8_t*)pMappedFile->pData + alignedBegin, (size_t)(alignedEnd - alignedBegin), MADV_DONTNEED);
+    }
+}
+
+FILE* OpenPlatformOutputStream(const char* path)
+{
+    // A reader closing its end of a pipe raises SIGPIPE, which terminates the process by default.
+    // Ignored, the write fails with EPIPE instead.
+    signal(SIGPIPE, SIG_IGN);
+
+    unsigned int fd = 0;
+    if (ParseFileDescriptor(path, &fd)) {
+        return fdopen((int)fd, "wb");
+    }
+    // Opening a FIFO blocks until a reader opens it
+    return fopen(path, "wb");
+}
+
+FILE* DetachPlatformStandardOutput(void)
+{
+    fflush(stdout);
+    const int outputFd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+    if (outputFd < 0) return NULL;
+    FILE* fp = fdopen(outputFd, "w");
+    if (fp == NULL || dup2(STDERR_FILENO, STDOUT_FILENO) < 0)
+    {
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        else {
+            close(outputFd);
+        }
+        return NULL;
+    }
+    return fp;
+}
+
+bool SendPlatformSocketPacket(int socketFd, const void* pData, size_t size, const int* pFds, uint32_t fdCount)
+{
+    if (fdCount > MAX_PLATFORM_SOCKET_FD_COUNT) return false;
+
+    struct iovec iov = { .iov_base = (void*)pData, .iov_len = size };
+    union
+    {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * MAX_PLATFORM_SOCKET_FD_COUNT)];
+    } control;
+    memset(&control, 0, sizeof(control));
+    struct msghdr msg = {
+        .msg_name = NULL,
+        .msg_namelen = 0,
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = fdCount > 0 ? control.buffer : NULL,
+        .msg_controllen = fdCount > 0 ? CMSG_SPACE(sizeof(int) * fdCount) : 0,
+        .msg_flags = 0
+    };
+    if (fdCount > 0)
+    {
+        struct cmsghdr* pHeader = CMSG_FIRSTHDR(&msg);
+        pHeader->cmsg_level = SOL_SOCKET;
+        pHeader->cmsg_type = SCM_RIGHTS;
+        pHeader->cmsg_len = CMSG_LEN(sizeof(int) * fdCount);
+        memcpy(CMSG_DATA(pHeader), pFds, sizeof(int) * fdCount);
+    }
+
+    ssize_t sentSize;
+    do {
+        sentSize = sendmsg(socketFd, &msg, MSG_NOSIGNAL);
+    } while (sentSize < 0 && errno == EINTR);
+    return sentSize == (ssize_t)size;
+}
+
+bool ReceivePlatformSocketPacket(int socketFd, void* pData, size_t size, size_t* pPacketSize, int* pFds, uint32_t maxFdCount,
+                                 uint32_t* pFdCount)
+{
+    struct iovec iov = { .iov_base = pData, .iov_len = size };
+    // Room for every descriptor a packet may carry, so MSG_CTRUNC means the sender broke the protocol
+    union
+    {
+        struct cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(int) * MAX_PLATFORM_SOCKET_FD_COUNT)];
+    } control;
+    struct msghdr msg = {
+        .msg_name = NULL,
+        .msg_namelen = 0,
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = sizeof(control.buffer),
+        .msg_flags = 0
+    };
+    // MSG_TRUNC returns the size of the whole packet
+    ssize_t receivedSize;
+    do {
+        receivedSize = recvmsg(socketFd, &msg, MSG_CMSG_CLOEXEC | MSG_TRUNC);
+    } while (receivedSize < 0 && errno == EINTR);
+    *pPacketSize = 0;
+    *pFdCount = 0;
+    // 0 once the peer has closed its end
+    if (receivedSize <= 0) return false;
+
+    // Even a truncated control message installs the descriptors that fit, every one of them MUST BE kept or closed.
+    uint32_t fdCount = 0;
+    for (struct cmsghdr* pHeader = CMSG_FIRSTHDR(&msg); pHeader != NULL; pHeader = CMSG_NXTHDR(&msg, pHeader))
+    {
+        if (pHeader->cmsg_level != SOL_SOCKET || pHeader->cmsg_type != SCM_RIGHTS) continue;
+        const size_t count = (pHeader->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        const uint8_t* pReceivedFds = CMSG_DATA(pHeader);
+        for (size_t i = 0; i < count; ++i)
+        {
+            int fd;
+            memcpy(&fd, pReceivedFds + i * sizeof(int), sizeof(int));
+            if (fdCount < maxFdCount) {
+                pFds[fdCount++] = fd;
+            }
+            else {
+                close(fd);
+            }
+        }
+    }
+    if ((msg.msg_flags & MSG_CTRUNC) != 0)
+    {
+        for (uint32_t i = 0; i < fdCount; ++i) {
+            close(pFds[i]);
+        }
+        return false;
+    }
+    *pPacketSize = (size_t)receivedSize;
+    *pFdCount = fdCount;
+    return true;
+}
+
+#endif // _WIN32
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef _WIN32
+#include <Windows.h>
+
+typedef HANDLE PlatformThread;
+typedef SRWLOCK PlatformMutex;
+typedef CONDITION_VARIABLE PlatformConditionVariable;
+#else
+#include <pthread.h>
+
+typedef pthread_t PlatformThread;
+typedef pthread_mutex_t PlatformMutex;
+typedef pthread_cond_t PlatformConditionVariable;
+#endif // _WIN32
+
+enum PLATFORM_UTILS_CONSTANTS
+{
+    // File descriptors a socket packet can carry
+    MAX_PLATFORM_SOCKET_FD_COUNT = 16
+};
+
+typedef void (*PFN_PlatformThreadRoutine)(void* pArgument);
+
+// Atomic operations on naturally aligned 64-bit integers. Loads acquire and stores release,
+// read-modify-write operations and PlatformMemoryFence are sequentially consistent.
+#ifdef _WIN32
+static inline int64_t PlatformAtomicLoad(const volatile int64_t* pValue)
+{
+    return ReadAcquire64(pValue);
+}
+
+static inline void PlatformAtomicStore(volatile int64_t* pValue, int64_t value)
+{
+    WriteRelease64(pValue, value);
+}
+
+// Returns the new value.
+static inline int64_t PlatformAtomicAdd(volatile int64_t* pValue, int64_t addend)
+{
+    return InterlockedExchangeAdd64(pValue, addend) + addend;
+}
+
+static inline bool PlatformAtomicCompareExchange(volatile int64_t* pValue, int64_t expected, int64_t desired)
+{
+    return InterlockedCompareExchange64(pValue, desired, expected) == expected;
+}
+
+static inline void PlatformMemoryFence(void)
+{
+    MemoryBarrier();
+}
+
+// Hints to the CPU that the calling thread is spinning
+static inline void PlatformSpinPause(void)
+{
+    YieldProcessor();
+}
+#else
+static inline int64_t PlatformAtomicLoad(const volatile int64_t* pValue)
+{
+    return __atomic_load_n(pValue, __ATOMIC_ACQUIRE);
+}
+
+static inline void PlatformAtomicStore(volatile int64_t* pValue, int64_t value)
+{
+    __atomic_store_n(pValue, value, __ATOMIC_RELEASE);
+}
+
+// Returns the new value.
+static inline int64_t PlatformAtomicAdd(volatile int64_t* pValue, int64_t addend)
+{
+    return __atomic_add_fetch(pValue, addend, __ATOMIC_SEQ_CST);
+}
+
+static inline bool PlatformAtomicCompareExchange(volatile int64_t* pValue, int64_t expected, int64_t desired)
+{
+    return __atomic_compare_exchange_n(pValue, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static inline void PlatformMemoryFence(void)
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+// Hints to the CPU that the calling thread is spinning
+static inline void PlatformSpinPause(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+#endif // _WIN32
+
+// A whole file mapped read-only into the address space
+typedef struct PlatformMappedFile
+{
+    const void* pData;
+    uint64_t size;
+#ifdef _WIN32
+    HANDLE hFile;
+    HANDLE hMapping;
+#else
+    int fd;
+#endif // _WIN32
+} PlatformMappedFile;
+
+// Returns the value of a monotonic clock in nanoseconds.
+// Only the difference between two values is meaningful.
+extern uint64_t GetCurrentTimeNanoseconds(void);
+
+// Returns the number of logical processors available to the process, at least 1.
+extern uint32_t GetLogicalProcessorCount(void);
+
+// Copies the value of an environment variable into `buffer`.
+// Returns false if the variable is not set, is empty or does not fit in `buffer`.
+extern bool GetEnvironmentVariableString(const char* name, char* buffer, size_t bufferSize);
+
+extern bool CreatePlatformThread(PlatformThread* pThread, PFN_PlatformThreadRoutine routine, void* pArgument);
+// Waits for the thread to exit and releases it.
+extern void JoinPlatformThread(PlatformThread thread);
+// Gives up the rest of the time slice of the calling thread.
+extern void YieldPlatformThread(void);
+
+extern void InitializePlatformMutex(PlatformMutex* pMutex);
+extern void DestroyPlatformMutex(PlatformMutex* pMutex);
+extern void LockPlatformMutex(PlatformMutex* pMutex);
+extern void UnlockPlatformMutex(PlatformMutex* pMutex);
+
+extern void InitializePlatformConditionVariable(PlatformConditionVariable* pConditionVariable);
+extern void DestroyPlatformConditionVariable(PlatformConditionVariable* pConditionVariable);
+// `pMutex` MUST BE locked by the calling thread.
+extern void WaitPlatformConditionVariable(PlatformConditionVariable* pConditionVariable, PlatformMutex* pMutex);
+extern void WakeAllPlatformConditionVariable(PlatformConditionVariable* pConditionVariable);
+
+// Maps the file at `path` read-only. The pages are only read from disk when they are touched.
+// Returns false if the file cannot be opened or is empty.
+extern bool MapPlatformFile(const char* path, PlatformMappedFile* pMappedFile);
+extern void UnmapPlatformFile(PlatformMappedFile* pMappedFile);
+// Hints that the given range will not be read again, so its pages can be dropped from the working set.
+// The data stays accessible and is read from disk again if touched.
+extern void ReleasePlatformFileRange(const PlatformMappedFile* pMappedFile, uint64_t offset, uint64_t size);
+
+// Opens `path` for writing binary data. `path` may also name a pipe, or be "fd:<n>" for a file descriptor inherited from the parent process.
+// Writing to a pipe whose reader has exited fails instead of terminating the process.
+extern FILE* OpenPlatformOutputStream(const char* path);
+// Moves the standard output to a new stream and points the standard output at the standard error instead,
+// so everything printed goes to the standard error and only what is written to the returned stream reaches the original standard output.
+// Returns NULL and leaves the standard output as it is on failure.
+// The buffering of stdout is left as it is, so it MUST BE set up before the first output for the logs not to wait for a full buffer.
+extern FILE* DetachPlatformStandardOutput(void);
+
+// Sends `size` bytes as one packet of a SOCK_SEQPACKET Unix domain socket, and duplicates the `fdCount` file descriptors into the
+// receiving process with SCM_RIGHTS. The caller keeps its descriptors. A peer that has exited fails the send instead of raising SIGPIPE.
+// Always fails on Windows, which has no descriptor passing.
+extern bool SendPlatformSocketPacket(int socketFd, const void* pData, size_t size, const int* pFds, uint32_t fdCount);
+// Blocks until a packet arrives and receives up to `size` bytes of it. `*pPacketSize` is the size of the whole packet, which was cut off
+// if it is larger than `size`. Up to `maxFdCount` received descriptors are written to `pFds` and belong to the caller, the others are closed.
+// Returns false if the peer has disconnected, or if the packet carried more than MAX_PLATFORM_SOCKET_FD_COUNT descriptors,
+// in which case none is kept.
+extern bool ReceivePlatformSocketPacket(int socketFd, void* pData, size_t size, size_t* pPacketSize, int* pFds, uint32_t maxFdCount,
+                                        uint32_t* pFdCount);
@@ -0,0 +1,294 @@
+// render_client.c : a separate program requesting frames from VulkanSimpleRender --serve=<socket path>.
+// Every frame turns the squares a little further and is delivered inline on the socket or in the shared memory of the server.
+// The round trip of every request is timed, next to the time the server needed to render the frame.
+//
+// Built on its own, since it has a main function of its own:
+//   gcc -std=gnu17 -O2 render_client.c render_server_message.c platform_utils.c -o render_client -lpthread
+// Run it once the server is listening, or while it is starting:
+//   render_client <socket path> [frame count] [inline|shared|none] [shutdown]
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "platform_utils.h"
+#include "render_server_message.h"
+
+#ifdef _WIN32
+
+int main(void)
+{
+    puts("render_client only runs on Linux, where the render server listens on a Unix domain socket!");
+    return 1;
+}
+
+#else
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+enum RENDER_CLIENT_CONSTANTS
+{
+    // The server may still be creating its device
+    CONNECT_RETRY_COUNT = 100,
+    CONNECT_RETRY_INTERVAL_MS = 100,
+    DEFAULT_RENDER_CLIENT_FRAME_COUNT = 100,
+    // Degrees the squares turn from one frame to the next
+    RENDER_CLIENT_ANGLE_STEP = 3
+};
+
+typedef struct RenderClient
+{
+    int socketFd;
+    RenderServerMessage hello;
+    // RENDER_SERVER_SHARED_SLOT_COUNT frames, mapped read-only
+    const uint8_t* pSharedMemory;
+    size_t sharedMemorySize;
+    // Receives the inline frames
+    uint8_t* pFrame;
+    // Sent with every request, turned a little further each time
+    RenderContextScene scene;
+
+    uint32_t receivedFrameCount;
+    uint64_t totalRoundTripTime;
+    uint64_t maxRoundTripTime;
+    uint64_t totalRenderTime;
+} RenderClient;
+
+static bool ConnectToServer(RenderClient* pClient, const char* socketPath)
+{
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    const size_t socketPathLength = strlen(socketPath);
+    if (socketPathLength >= sizeof(address.sun_path))
+    {
+        printf("Socket path '%s' is too long!\n", socketPath);
+        return false;
+    }
+    memcpy(address.sun_path, socketPath, socketPathLength + 1);
+
+    pClient->socketFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (pClient->socketFd < 0)
+    {
+        printf("Creating the socket failed: %d\n", errno);
+        return false;
+    }
+    for (uint32_t i = 0; i < CONNECT_RETRY_COUNT; ++i)
+    {
+        if (connect(pClient->socketFd, (const struct sockaddr*)&address, sizeof(address)) == 0) return true;
+
+        const struct timespec interval = { .tv_sec = 0, .tv_nsec = CONNECT_RETRY_INTERVAL_MS * 1000000L };
+        nanosleep(&interval, NULL);
+    }
+    printf("Connecting to %s failed: %d\n", socketPath, errno);
+    return false;
+}
+
+static bool ReceiveHello(RenderClient* pClient)
+{
+    RenderServerMessage* pHello = &pClient->hello;
+    int fd = -1;
+    if (!ReceiveRenderServerMessage(pClient->socketFd, pHello, &fd) || pHello->type != RENDER_SERVER_MESSAGE_HELLO || fd < 0)
+    {
+        if (fd >= 0) {
+            close(fd);
+        }
+        puts("The server did not send its shared memory!");
+        return false;
+    }
+
+    pClient->sharedMemorySize = (size_t)(pHello->frameSize * pHello->sharedSlotCount);
+    void* pSharedMemory = mmap(NULL, pClient->sharedMemorySize, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the memory alive
+    close(fd);
+    if (pSharedMemory == MAP_FAILED)
+    {
+        printf("Mapping the shared memory failed: %d\n", errno);
+        return false;
+    }
+    pClient->pSharedMemory = pSharedMemory;
+
+    pClient->pFrame = malloc((size_t)pHello->frameSize);
+    if (pClient->pFrame == NULL)
+    {
+        puts("Failed to allocate the frame!");
+        return false;
+    }
+    printf("Receiving frames of %ux%u, %u bytes per row, with %u shared slots\n", pHello->width, pHello->height, pHello->rowPitch,
+        pHello->sharedSlotCount);
+    return true;
+}
+
+// Receives the packets following the response to an inline RENDER request
+static bool ReceiveInlineFrame(RenderClient* pClient)
+{
+    uint64_t receivedSize = 0;
+    while (receivedSize < pClient->hello.frameSize)
+    {
+        const uint64_t packetSize = pClient->hello.frameSize - receivedSize < RENDER_SERVER_PACKET_SIZE ?
+            pClient->hello.frameSize - receivedSize : RENDER_SERVER_PACKET_SIZE;
+        ssize_t size;
+        do {
+            size = recv(pClient->socketFd, pClient->pFrame + receivedSize, (size_t)packetSize, 0);
+        } while (size < 0 && errno == EINTR);
+        if (size <= 0) return false;
+        receivedSize += (uint64_t)size;
+    }
+    return true;
+}
+
+// Replaces the colors of the server once, every request then carries the whole scene
+static bool SendScene(RenderClient* pClient)
+{
+    RenderContextScene* pScene = &pClient->scene;
+    pScene->cameraExtent[0] = 1.0f;
+    pScene->cameraExtent[1] = 1.0f;
+    pScene->angle = 0.0f;
+    for (uint32_t i = 0; i < RENDER_CONTEXT_VERTEX_COUNT; ++i)
+    {
+        pScene->vertexColors[i][0] = i == 0 || i == 3 ? 1.0f : 0.0f;
+        pScene->vertexColors[i][1] = i == 1 || i == 3 ? 1.0f : 0.0f;
+        pScene->vertexColors[i][2] = i == 2 || i == 3 ? 1.0f : 0.0f;
+        pScene->vertexColors[i][3] = 1.0f;
+    }
+    const RenderServerMessage request = { .type = RENDER_SERVER_MESSAGE_UPDATE_SCENE, .scene = *pScene };
+    RenderServerMessage response;
+    int fd = -1;
+    const bool isSent = SendRenderServerMessage(pClient->socketFd, &request, -1) && ReceiveRenderServerMessage(pClient->socketFd, &response, &fd);
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (!isSent || response.status != 0)
+    {
+        puts("The server did not take the scene!");
+        return false;
+    }
+    return true;
+}
+
+static bool RequestFrame(RenderClient* pClient, uint32_t frame, RenderServerFrameDelivery delivery, const uint8_t** ppPixels)
+{
+    pClient->scene.angle = (float)((frame * RENDER_CLIENT_ANGLE_STEP) % 360);
+    const RenderServerMessage request = {
+        .type = RENDER_SERVER_MESSAGE_RENDER,
+        .scene = pClient->scene,
+        .hasScene = 1,
+        .delivery = delivery
+    };
+
+    const uint64_t beginTime = GetCurrentTimeNanoseconds();
+    RenderServerMessage response;
+    int fd = -1;
+    if (!SendRenderServerMessage(pClient->socketFd, &request, -1) || !ReceiveRenderServerMessage(pClient->socketFd, &response, &fd))
+    {
+        puts("The server has disconnected!");
+        return false;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    if (response.type != RENDER_SERVER_MESSAGE_RESPONSE || response.status != 0)
+    {
+        printf("The server failed to render frame %u!\n", frame);
+        return false;
+    }
+
+    *ppPixels = NULL;
+    if (delivery == RENDER_SERVER_FRAME_DELIVERY_INLINE)
+    {
+        if (!ReceiveInlineFrame(pClient))
+        {
+            puts("The server has disconnected while sending a frame!");
+            return false;
+        }
+        *ppPixels = pClient->pFrame;
+    }
+    else if (delivery == RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY)
+    {
+        if (response.sharedSlot >= pClient->hello.sharedSlotCount)
+        {
+            printf("Unexpected shared slot %u!\n", response.sharedSlot);
+            return false;
+        }
+        *ppPixels = pClient->pSharedMemory + response.sharedSlot * pClient->hello.frameSize;
+    }
+
+    const uint64_t roundTripTime = GetCurrentTimeNanoseconds() - beginTime;
+    pClient->totalRoundTripTime += roundTripTime;
+    pClient->maxRoundTripTime = roundTripTime > pClient->maxRoundTripTime ? roundTripTime : pClient->maxRoundTripTime;
+    pClient->totalRenderTime += response.renderTime;
+    ++pClient->receivedFrameCount;
+    return true;
+}
+
+static void DestroyRenderClient(RenderClient* pClient)
+{
+    if (pClient->socketFd >= 0) {
+        close(pClient->socketFd);
+    }
+    if (pClient->pSharedMemory != NULL) {
+        munmap((void*)pClient->pSharedMemory, pClient->sharedMemorySize);
+    }
+    free(pClient->pFrame);
+    memset(pClient, 0, sizeof(*pClient));
+    pClient->socketFd = -1;
+}
+
+int main(int argc, const char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <socket path> [frame count] [inline|shared|none] [shutdown]\n", argv[0]);
+        return 1;
+    }
+    const uint32_t frameCount = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 10) : DEFAULT_RENDER_CLIENT_FRAME_COUNT;
+    RenderServerFrameDelivery delivery = RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY;
+    if (argc > 3 && strcmp(argv[3], "inline") == 0) {
+        delivery = RENDER_SERVER_FRAME_DELIVERY_INLINE;
+    }
+    else if (argc > 3 && strcmp(argv[3], "none") == 0) {
+        delivery = RENDER_SERVER_FRAME_DELIVERY_NONE;
+    }
+    const bool isShutdownRequested = argc > 4 && strcmp(argv[4], "shutdown") == 0;
+
+    RenderClient client;
+    memset(&client, 0, sizeof(client));
+    client.socketFd = -1;
+
+    bool succeeded = ConnectToServer(&client, argv[1]) && ReceiveHello(&client) && SendScene(&client);
+    const uint8_t* pPixels = NULL;
+    for (uint32_t frame = 0; succeeded && frame < frameCount; ++frame) {
+        succeeded = RequestFrame(&client, frame, delivery, &pPixels);
+    }
+
+    if (client.receivedFrameCount > 0)
+    {
+        printf("Received %u frames, %.3f ms per round trip on average and %.3f ms at most, %.3f ms of it rendering\n",
+            client.receivedFrameCount, client.totalRoundTripTime / 1000000.0 / client.receivedFrameCount, client.maxRoundTripTime / 1000000.0,
+            client.totalRenderTime / 1000000.0 / client.receivedFrameCount);
+    }
+    if (succeeded && pPixels != NULL)
+    {
+        const uint8_t* pCenter = pPixels + (client.hello.height / 2) * client.hello.rowPitch + (client.hello.width / 2) * 4;
+        printf("Center pixel of the last frame: %u %u %u %u\n", pCenter[0], pCenter[1], pCenter[2], pCenter[3]);
+    }
+    if (succeeded && isShutdownRequested)
+    {
+        const RenderServerMessage shutdown = { .type = RENDER_SERVER_MESSAGE_SHUTDOWN };
+        RenderServerMessage response;
+        int fd = -1;
+        succeeded = SendRenderServerMessage(client.socketFd, &shutdown, -1) && ReceiveRenderServerMessage(client.socketFd, &response, &fd);
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+    DestroyRenderClient(&client);
+    return succeeded ? 0 : 1;
+}
+
+#endif // _WIN32
@@ -0,0 +1,979 @@
+#include "render_context.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+enum RENDER_CONTEXT_PRIVATE_CONSTANTS
+{
+    RENDER_CONTEXT_VERTEX_DATA_SIZE = RENDER_CONTEXT_VERTEX_COUNT * sizeof(float[4])
+};
+
+static VkDeviceSize AlignRenderContextOffset(VkDeviceSize offset, VkDeviceSize alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool CreateSceneRenderPass(VkDevice device, const VkAllocationCallbacks* pAllocator, VkFormat colorFormat, VkFormat depthFormat,
+                           VkImageLayout colorFinalLayout, VkPipelineStageFlags colorReadStages, VkRenderPass* pRenderPass)
+{
+    // The initial layout for the color and depth attachments will be LAYOUT_UNDEFINED
+    // because at the start of the renderpass, we don't care about their contents.
+    // At the start of the subpass, the color attachment's layout will be transitioned
+    // to LAYOUT_COLOR_ATTACHMENT_OPTIMAL and the depth stencil attachment's layout
+    // will be transitioned to LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL.  At the end of
+    // the renderpass, the color attachment's layout will be transitioned to
+    // `colorFinalLayout`.  This is all done as part of the renderpass, no barriers are necessary.
+    const VkAttachmentDescription attachments[] = {
+        // color attachment
+        {
+            .flags = 0,
+            .format = colorFormat,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = colorFinalLayout,
+        },
+        // depth attachment
+        {
+            .flags = 0,
+            .format = depthFormat,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        }
+    };
+    const VkAttachmentReference colorReference = {
+        .attachment = 0,
+        .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+    };
+    const VkAttachmentReference depthReference = {
+        .attachment = 1,
+        .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+    };
+    const VkSubpassDescription subpass = {
+        .flags = 0,
+        .pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+        .inputAttachmentCount = 0,
+        .pInputAttachments = NULL,
+        .colorAttachmentCount = 1,
+        .pColorAttachments = &colorReference,
+        .pResolveAttachments = NULL,
+        .pDepthStencilAttachment = &depthReference,
+        .preserveAttachmentCount = 0,
+        .pPreserveAttachments = NULL,
+    };
+
+    const VkSubpassDependency dependencies[] = {
+        // The depth buffer is shared between the frames in flight
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dependencyFlags = 0
+        },
+        // Image layout transition, which also waits for the reads of the color attachment by its previous frame
+        {
+            .srcSubpass = VK_SUBPASS_EXTERNAL,
+            .dstSubpass = 0,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | colorReadStages,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT,
+            .dependencyFlags = 0,
+        },
+        // The reads recorded after the render pass see the finished color attachment
+        {
+            .srcSubpass = 0,
+            .dstSubpass = VK_SUBPASS_EXTERNAL,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            .dstStageMask = colorReadStages,
+            .srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = ((colorReadStages & VK_PIPELINE_STAGE_TRANSFER_BIT) != 0 ? VK_ACCESS_TRANSFER_READ_BIT : 0) |
+                             ((colorReadStages & VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT) != 0 ? VK_ACCESS_SHADER_READ_BIT : 0),
+            .dependencyFlags = 0,
+        },
+    };
+
+    const VkRenderPassCreateInfo renderPassCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .attachmentCount = (uint32_t)(sizeof(attachments) / sizeof(attachments[0])),
+        .pAttachments = attachments,
+        .subpassCount = 1,
+        .pSubpasses = &subpass,
+        // Without reads after the render pass, the implicit dependency at its end is enough
+        .dependencyCount = colorReadStages != 0 ? 3U : 2U,
+        .pDependencies = dependencies,
+    };
+    const VkResult res = vkCreateRenderPass(device, &renderPassCreateInfo, pAllocator, pRenderPass);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateRenderPass failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+bool CreateSceneGraphicsPipeline(const ScenePipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline)
+{
+    // Two shader stages
+    const VkPipelineShaderStageCreateInfo shaderStages[] = {
+        // vertex shader
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_VERTEX_BIT,
+            .module = pCreateInfo->vertexShader,
+            .pName = "main",
+            .pSpecializationInfo = NULL
+        },
+        // fragment shader
+        {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .pNext = NULL,
+            .flags = 0,
+            .stage = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .module = pCreateInfo->fragmentShader,
+            .pName = "main",
+            .pSpecializationInfo = NULL
+        }
+    };
+
+    const VkVertexInputBindingDescription vertexInputBindings[] = {
+        // coords buffer
+        {
+            .binding = 0,
+            .stride = sizeof(float[4]),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+        },
+        // color buffer
+        {
+            .binding = 1,
+            .stride = sizeof(float[4]),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+        }
+    };
+    const VkVertexInputAttributeDescription vertexInputAttributes[] = {
+        // inPos attribute
+        {
+            .location = 0,
+            .binding = 0,
+            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .offset = 0
+        },
+        // inColor attribute
+        {
+            .location = 1,
+            .binding = 1,
+            .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+            .offset = 0
+        }
+    };
+    const VkPipelineVertexInputStateCreateInfo squareVertexInputStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .vertexBindingDescriptionCount = (uint32_t)(sizeof(vertexInputBindings) / sizeof(vertexInputBindings[0])),
+        .pVertexBindingDescriptions = vertexInputBindings,
+        .vertexAttributeDescriptionCount = (uint32_t)(sizeof(vertexInputAttributes) / sizeof(vertexInputAttributes[0])),
+        .pVertexAttributeDescriptions = vertexInputAttributes
+    };
+
+    const VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .topology = pCreateInfo->topology,
+        .primitiveRestartEnable = VK_FALSE
+    };
+
+    const VkPipelineViewportStateCreateInfo viewportStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .viewportCount = 1,
+        .pViewports = NULL,     // As the viewport state is dynamic, this member is ignored.
+        .scissorCount = 1,
+        .pScissors = NULL       // As the scissor state is dynamic, this member is ignored.
+    };
+
+    const VkPipelineRasterizationStateCreateInfo rasterizationStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .depthClampEnable = VK_FALSE,
+        .rasterizerDiscardEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = pCreateInfo->cullMode,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthBiasEnable = VK_FALSE,
+        .depthBiasConstantFactor = 0.0f,
+        .depthBiasClamp = 1.0f,
+        .depthBiasSlopeFactor = 0.0f,
+        .lineWidth = 1.0f,
+    };
+
+    const VkPipelineMultisampleStateCreateInfo multisampleStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT,
+        .sampleShadingEnable = VK_FALSE,
+        .minSampleShading = 0.0f,
+        .pSampleMask = NULL,
+        .alphaToCoverageEnable = VK_FALSE,
+        .alphaToOneEnable = VK_FALSE
+    };
+
+    const VkStencilOpState stencilOpState = {
+        .failOp = VK_STENCIL_OP_KEEP,
+        .passOp = VK_STENCIL_OP_KEEP,
+        .depthFailOp = VK_STENCIL_OP_KEEP,
+        .compareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+        .compareMask = 0,
+        .writeMask = 0,
+        .reference = 0
+    };
+
+    const VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .front = stencilOpState,
+        .back = stencilOpState,
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 0.0f
+    };
+
+    const VkPipelineColorBlendAttachmentState attachmentState = {
+        .blendEnable = VK_FALSE,
+        .srcColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT
+    };
+
+    const VkPipelineColorBlendStateCreateInfo colorBlendStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_CLEAR,
+        .attachmentCount = 1,
+        .pAttachments = &attachmentState,
+        .blendConstants = { 0.0f }
+    };
+
+    const VkDynamicState dynamicStates[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    const VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .dynamicStateCount = (uint32_t)(sizeof(dynamicStates) / sizeof(dynamicStates[0])),
+        .pDynamicStates = dynamicStates
+    };
+
+    const VkGraphicsPipelineCreateInfo pipelineCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = pCreateInfo->flags,
+        .stageCount = (uint32_t)(sizeof(shaderStages) / sizeof(shaderStages[0])),
+        .pStages = shaderStages,
+        .pVertexInputState = pCreateInfo->pVertexInputState != NULL ? pCreateInfo->pVertexInputState : &squareVertexInputStateCreateInfo,
+        .pInputAssemblyState = &inputAssemblyStateCreateInfo,
+        .pTessellationState = NULL,
+        .pViewportState = &viewportStateCreateInfo,
+        .pRasterizationState = &rasterizationStateCreateInfo,
+        .pMultisampleState = &multisampleStateCreateInfo,
+        .pDepthStencilState = &depthStencilStateCreateInfo,
+        .pColorBlendState = &colorBlendStateCreateInfo,
+        .pDynamicState = &dynamicStateCreateInfo,
+        .layout = pCreateInfo->layout,
+        .renderPass = pCreateInfo->renderPass,
+        .subpass = 0,
+        .basePipelineHandle = VK_NULL_HANDLE,
+        .basePipelineIndex = 0
+    };
+
+    const VkResult res = vkCreateGraphicsPipelines(pCreateInfo->device, pCreateInfo->pipelineCache, 1, &pipelineCreateInfo,
+        pCreateInfo->pAllocator, pPipeline);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateGraphicsPipelines failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+bool CreateRenderTargetImage(const RenderTargetImageCreateInfo* pCreateInfo, VkImage* pImage, VkDeviceMemory* pMemory,
+                             VkImageView* pImageView)
+{
+    const VkDevice device = pCreateInfo->device;
+    const VkImageCreateInfo imageCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .imageType = VK_IMAGE_TYPE_2D,
+        .format = pCreateInfo->format,
+        .extent = { .width = pCreateInfo->width, .height = pCreateInfo->height, .depth = 1 },
+        .mipLevels = 1,
+        .arrayLayers = 1,
+        .samples = VK_SAMPLE_COUNT_1_BIT,
+        .tiling = VK_IMAGE_TILING_OPTIMAL,
+        .usage = pCreateInfo->usage,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &pCreateInfo->queueFamilyIndex,
+        .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED
+    };
+    VkResult res = vkCreateImage(device, &imageCreateInfo, pCreateInfo->pAllocator, pImage);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateImage for render target failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetImageMemoryRequirements(device, *pImage, &memoryRequirements);
+    const DeviceMemoryRequest request = {
+        .pNext = NULL,
+        .size = memoryRequirements.size,
+        .memoryTypeBits = memoryRequirements.memoryTypeBits,
+        .requiredFlags = 0,
+        .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        .category = pCreateInfo->category
+    };
+    res = AllocateTrackedDeviceMemory(pCreateInfo->pMemoryTracker, &request, pMemory, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for render target failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindImageMemory(device, *pImage, *pMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindImageMemory for render target failed: %d\n", res);
+        return false;
+    }
+
+    const VkImageViewCreateInfo imageViewCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .image = *pImage,
+        .viewType = VK_IMAGE_VIEW_TYPE_2D,
+        .format = pCreateInfo->format,
+        .components = {
+            .r = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .g = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .b = VK_COMPONENT_SWIZZLE_IDENTITY,
+            .a = VK_COMPONENT_SWIZZLE_IDENTITY
+        },
+        .subresourceRange = { .aspectMask = pCreateInfo->aspectMask, .baseMipLevel = 0, .levelCount = 1, .baseArrayLayer = 0, .layerCount = 1 }
+    };
+    res = vkCreateImageView(device, &imageViewCreateInfo, pCreateInfo->pAllocator, pImageView);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateImageView for render target failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+static bool CreateRenderContextPipelines(RenderContext* pContext)
+{
+    const VkDevice device = pContext->info.device;
+    const VkDescriptorSetLayoutBinding layoutBinding = {
+        .binding = 0,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .descriptorCount = 1,
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .pImmutableSamplers = NULL
+    };
+    const VkDescriptorSetLayoutCreateInfo descriptorSetLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .bindingCount = 1,
+        .pBindings = &layoutBinding
+    };
+    VkResult res = vkCreateDescriptorSetLayout(device, &descriptorSetLayoutCreateInfo, pContext->info.pAllocator, &pContext->descriptorSetLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorSetLayout for render context failed: %d\n", res);
+        return false;
+    }
+
+    const VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .setLayoutCount = 1,
+        .pSetLayouts = &pContext->descriptorSetLayout,
+        .pushConstantRangeCount = 0,
+        .pPushConstantRanges = NULL
+    };
+    res = vkCreatePipelineLayout(device, &pipelineLayoutCreateInfo, pContext->info.pAllocator, &pContext->pipelineLayout);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreatePipelineLayout for render context failed: %d\n", res);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < RENDER_CONTEXT_DRAW_COUNT; ++i)
+    {
+        // Every context after the first one finds its pipelines in the shared cache
+        const ScenePipelineCreateInfo pipelineCreateInfo = {
+            .device = device,
+            .pAllocator = pContext->info.pAllocator,
+            .pipelineCache = pContext->info.pipelineCache,
+            .flags = 0,
+            .vertexShader = pContext->info.vertexShaders[i],
+            .fragmentShader = pContext->info.fragmentShaders[i],
+            .pVertexInputState = NULL,
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+            // The first square rotates about the x-axis so that its back face is seen as well
+            .cullMode = i == 0 ? VK_CULL_MODE_NONE : VK_CULL_MODE_BACK_BIT,
+            .layout = pContext->pipelineLayout,
+            .renderPass = pContext->renderPass
+        };
+        if (!CreateSceneGraphicsPipeline(&pipelineCreateInfo, &pContext->pipelines[i])) return false;
+    }
+    return true;
+}
+
+// Of the size of the context, in device local memory
+static bool CreateRenderContextImage(RenderContext* pContext, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspectMask,
+                                     DeviceMemoryCategory category, VkImage* pImage, VkDeviceMemory* pMemory, VkImageView* pImageView)
+{
+    const RenderTargetImageCreateInfo createInfo = {
+        .device = pContext->info.device,
+        .pAllocator = pContext->info.pAllocator,
+        .pMemoryTracker = pContext->info.pMemoryTracker,
+        .queueFamilyIndex = pContext->info.queueFamilyIndex,
+        .width = pContext->info.width,
+        .height = pContext->info.height,
+        .format = format,
+        .usage = usage,
+        .aspectMask = aspectMask,
+        .category = category
+    };
+    return CreateRenderTargetImage(&createInfo, pImage, pMemory, pImageView);
+}
+
+static bool CreateRenderContextReadback(RenderContext* pContext, RenderContextFrame* pFrame)
+{
+    const VkDevice device = pContext->info.device;
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = (VkDeviceSize)pContext->info.width * pContext->info.height * 4,
+        .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &pContext->info.queueFamilyIndex
+    };
+    VkResult res = vkCreateBuffer(device, &bufferCreateInfo, pContext->info.pAllocator, &pFrame->readbackBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for render context readback failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, pFrame->readbackBuffer, &memoryRequirements);
+    res = AllocateReadbackDeviceMemory(pContext->info.pMemoryTracker, device, pContext->info.pAllocator, &pContext->info.pMemoryTracker->memoryProperties,
+        &memoryRequirements, &pFrame->readbackMemory, &pContext->isReadbackCoherent);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for render context readback failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(device, pFrame->readbackBuffer, pFrame->readbackMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory for render context readback failed: %d\n", res);
+        return false;
+    }
+    res = vkMapMemory(device, pFrame->readbackMemory, 0, VK_WHOLE_SIZE, 0, (void**)&pFrame->pReadbackData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for render context readback failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+static bool CreateRenderContextFrame(RenderContext* pContext, RenderContextFrame* pFrame)
+{
+    const VkDevice device = pContext->info.device;
+    if (!CreateRenderContextImage(pContext, pContext->info.colorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+        VK_IMAGE_ASPECT_COLOR_BIT, DEVICE_MEMORY_CATEGORY_RENDER_TARGET, &pFrame->image, &pFrame->imageMemory, &pFrame->imageView)) {
+        return false;
+    }
+
+    const VkImageView attachments[] = { pFrame->imageView, pContext->depthImageView };
+    const VkFramebufferCreateInfo framebufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .renderPass = pContext->renderPass,
+        .attachmentCount = (uint32_t)(sizeof(attachments) / sizeof(attachments[0])),
+        .pAttachments = attachments,
+        .width = pContext->info.width,
+        .height = pContext->info.height,
+        .layers = 1
+    };
+    VkResult res = vkCreateFramebuffer(device, &framebufferCreateInfo, pContext->info.pAllocator, &pFrame->framebuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateFramebuffer for render context failed: %d\n", res);
+        return false;
+    }
+
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = pContext->vertexOffset + 2 * RENDER_CONTEXT_VERTEX_DATA_SIZE,
+        .usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &pContext->info.queueFamilyIndex
+    };
+    res = vkCreateBuffer(device, &bufferCreateInfo, pContext->info.pAllocator, &pFrame->buffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for render context failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, pFrame->buffer, &memoryRequirements);
+    // Written by the host for every frame, so it has to stay mapped. Device local memory the host can write to is read faster.
+    const DeviceMemoryRequest request = {
+        .pNext = NULL,
+        .size = memoryRequirements.size,
+        .memoryTypeBits = memoryRequirements.memoryTypeBits,
+        .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        .category = DEVICE_MEMORY_CATEGORY_UNIFORM
+    };
+    res = AllocateTrackedDeviceMemory(pContext->info.pMemoryTracker, &request, &pFrame->bufferMemory, NULL);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for render context failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(device, pFrame->buffer, pFrame->bufferMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory for render context failed: %d\n", res);
+        return false;
+    }
+
+    res = vkMapMemory(device, pFrame->bufferMemory, 0, VK_WHOLE_SIZE, 0, (void**)&pFrame->pBufferData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for render context failed: %d\n", res);
+        return false;
+    }
+    memcpy(pFrame->pBufferData + pContext->vertexOffset, pContext->info.pVertexCoords, RENDER_CONTEXT_VERTEX_DATA_SIZE);
+
+    const VkDescriptorSetAllocateInfo descriptorSetAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .pNext = NULL,
+        .descriptorPool = pContext->descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &pContext->descriptorSetLayout
+    };
+    res = vkAllocateDescriptorSets(device, &descriptorSetAllocateInfo, &pFrame->descriptorSet);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateDescriptorSets for render context failed: %d\n", res);
+        return false;
+    }
+
+    const VkDescriptorBufferInfo bufferInfo = { .buffer = pFrame->buffer, .offset = 0, .range = sizeof(FlattenVertexUniform) };
+    const VkWriteDescriptorSet writeDescriptorSet = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .pNext = NULL,
+        .dstSet = pFrame->descriptorSet,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+        .pImageInfo = NULL,
+        .pBufferInfo = &bufferInfo,
+        .pTexelBufferView = NULL
+    };
+    vkUpdateDescriptorSets(device, 1, &writeDescriptorSet, 0, NULL);
+
+    const VkCommandBufferAllocateInfo commandBufferAllocateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pContext->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = 1
+    };
+    res = vkAllocateCommandBuffers(device, &commandBufferAllocateInfo, &pFrame->commandBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers for render context failed: %d\n", res);
+        return false;
+    }
+
+    // Signaled, so that the first frame rendered with the slot does not wait
+    const VkFenceCreateInfo fenceCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_FENCE_CREATE_SIGNALED_BIT
+    };
+    res = vkCreateFence(device, &fenceCreateInfo, pContext->info.pAllocator, &pFrame->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateFence for render context failed: %d\n", res);
+        return false;
+    }
+    return !pContext->info.isReadbackEnabled || CreateRenderContextReadback(pContext, pFrame);
+}
+
+bool CreateRenderContext(const RenderContextCreateInfo* pCreateInfo, RenderContext* pContext)
+{
+    memset(pContext, 0, sizeof(*pContext));
+    if (pCreateInfo->frameCount == 0 || pCreateInfo->frameCount > MAX_RENDER_CONTEXT_FRAME_COUNT)
+    {
+        printf("Invalid render context frame count: %u\n", pCreateInfo->frameCount);
+        return false;
+    }
+    pContext->info = *pCreateInfo;
+    const VkDevice device = pCreateInfo->device;
+    // The uniform block starts the buffer of a frame and the vertices follow it, float4 aligned
+    const VkDeviceSize uniformAlignment = pCreateInfo->uniformAlignment > 16 ? pCreateInfo->uniformAlignment : 16;
+    pContext->vertexOffset = AlignRenderContextOffset(sizeof(FlattenVertexUniform), uniformAlignment);
+
+    // The copies of the readback, or of the render server, read the render targets after the render pass
+    if (!CreateSceneRenderPass(device, pCreateInfo->pAllocator, pCreateInfo->colorFormat, pCreateInfo->depthFormat,
+        VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_TRANSFER_BIT, &pContext->renderPass) || !CreateRenderContextPipelines(pContext)) {
+        goto failed;
+    }
+
+    if (!CreateRenderContextImage(pContext, pCreateInfo->depthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT,
+        DEVICE_MEMORY_CATEGORY_DEPTH, &pContext->depthImage, &pContext->depthMemory, &pContext->depthImageView)) {
+        goto failed;
+    }
+
+    const VkDescriptorPoolSize poolSize = { .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, .descriptorCount = pCreateInfo->frameCount };
+    const VkDescriptorPoolCreateInfo descriptorPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .maxSets = pCreateInfo->frameCount,
+        .poolSizeCount = 1,
+        .pPoolSizes = &poolSize
+    };
+    VkResult res = vkCreateDescriptorPool(device, &descriptorPoolCreateInfo, pCreateInfo->pAllocator, &pContext->descriptorPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateDescriptorPool for render context failed: %d\n", res);
+        goto failed;
+    }
+
+    // A command pool MUST only be used by one thread at a time, so every context has its own
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = pCreateInfo->queueFamilyIndex
+    };
+    res = vkCreateCommandPool(device, &commandPoolCreateInfo, pCreateInfo->pAllocator, &pContext->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool for render context failed: %d\n", res);
+        goto failed;
+    }
+
+    for (uint32_t i = 0; i < pCreateInfo->frameCount; ++i)
+    {
+        if (!CreateRenderContextFrame(pContext, &pContext->frames[i])) goto failed;
+    }
+    return true;
+
+failed:
+    DestroyRenderContext(pContext);
+    return false;
+}
+
+void DestroyRenderContext(RenderContext* pContext)
+{
+    const VkDevice device = pContext->info.device;
+    const VkAllocationCallbacks* pAllocator = pContext->info.pAllocator;
+    if (device == VK_NULL_HANDLE) return;
+
+    FinishRenderContextFrames(pContext);
+    for (uint32_t i = 0; i < pContext->info.frameCount; ++i)
+    {
+        RenderContextFrame* pFrame = &pContext->frames[i];
+        vkDestroyFence(device, pFrame->fence, pAllocator);
+        vkDestroyBuffer(device, pFrame->readbackBuffer, pAllocator);
+        FreeTrackedDeviceMemory(pContext->info.pMemoryTracker, pFrame->readbackMemory);
+        vkDestroyBuffer(device, pFrame->buffer, pAllocator);
+        FreeTrackedDeviceMemory(pContext->info.pMemoryTracker, pFrame->bufferMemory);
+        vkDestroyFramebuffer(device, pFrame->framebuffer, pAllocator);
+        vkDestroyImageView(device, pFrame->imageView, pAllocator);
+        vkDestroyImage(device, pFrame->image, pAllocator);
+        FreeTrackedDeviceMemory(pContext->info.pMemoryTracker, pFrame->imageMemory);
+    }
+    // Frees the command buffers and the descriptor sets of the frames
+    vkDestroyCommandPool(device, pContext->commandPool, pAllocator);
+    vkDestroyDescriptorPool(device, pContext->descriptorPool, pAllocator);
+    vkDestroyImageView(device, pContext->depthImageView, pAllocator);
+    vkDestroyImage(device, pContext->depthImage, pAllocator);
+    FreeTrackedDeviceMemory(pContext->info.pMemoryTracker, pContext->depthMemory);
+    for (uint32_t i = 0; i < RENDER_CONTEXT_DRAW_COUNT; ++i) {
+        vkDestroyPipeline(device, pContext->pipelines[i], pAllocator);
+    }
+    vkDestroyPipelineLayout(device, pContext->pipelineLayout, pAllocator);
+    vkDestroyDescriptorSetLayout(device, pContext->descriptorSetLayout, pAllocator);
+    vkDestroyRenderPass(device, pContext->renderPass, pAllocator);
+    memset(pContext, 0, sizeof(*pContext));
+}
+
+static void RecordRenderContextFrame(const RenderContext* pContext, const RenderContextFrame* pFrame)
+{
+    const VkCommandBuffer cmdBuf = pFrame->commandBuffer;
+    const VkClearValue clearValues[] = {
+        { .color = { .float32 = { 0.4f, 0.5f, 0.4f, 1.0f } } },
+        { .depthStencil = { .depth = 1.0f, .stencil = 0 } }
+    };
+    const VkRenderPassBeginInfo renderPassBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+        .pNext = NULL,
+        .renderPass = pContext->renderPass,
+        .framebuffer = pFrame->framebuffer,
+        .renderArea = { .offset = { .x = 0, .y = 0 }, .extent = { .width = pContext->info.width, .height = pContext->info.height } },
+        .clearValueCount = (uint32_t)(sizeof(clearValues) / sizeof(clearValues[0])),
+        .pClearValues = clearValues
+    };
+    vkCmdBeginRenderPass(cmdBuf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+    const VkBuffer vertexBuffers[] = { pFrame->buffer, pFrame->buffer };
+    const VkDeviceSize vertexOffsets[] = { pContext->vertexOffset, pContext->vertexOffset + RENDER_CONTEXT_VERTEX_DATA_SIZE };
+    vkCmdBindVertexBuffers(cmdBuf, 0, 2, vertexBuffers, vertexOffsets);
+    vkCmdBindDescriptorSets(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pContext->pipelineLayout, 0, 1, &pFrame->descriptorSet, 0, NULL);
+
+    // A square viewport centered in the render target, as the renderer draws
+    const uint32_t width = pContext->info.width;
+    const uint32_t height = pContext->info.height;
+    const bool isWidthShorterThanHeight = width < height;
+    const VkViewport viewport = {
+        .x = isWidthShorterThanHeight ? 0.0f : (width - height) / 2.0f,
+        .y = isWidthShorterThanHeight ? (height - width) / 2.0f : 0.0f,
+        .width = isWidthShorterThanHeight ? (float)width : (float)height,
+        .height = isWidthShorterThanHeight ? (float)width : (float)height,
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+    vkCmdSetViewport(cmdBuf, 0, 1, &viewport);
+    const VkRect2D scissor = { .offset = { .x = 0, .y = 0 }, .extent = { .width = width, .height = height } };
+    vkCmdSetScissor(cmdBuf, 0, 1, &scissor);
+
+    for (uint32_t i = 0; i < RENDER_CONTEXT_DRAW_COUNT; ++i)
+    {
+        vkCmdBindPipeline(cmdBuf, VK_PIPELINE_BIND_POINT_GRAPHICS, pContext->pipelines[i]);
+        vkCmdDraw(cmdBuf, RENDER_CONTEXT_VERTEX_COUNT, 1, 0, 0);
+    }
+
+    vkCmdEndRenderPass(cmdBuf);
+
+    if (pContext->info.isReadbackEnabled)
+    {
+        // The render pass has left the render target in VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL and made it available to transfers
+        const VkBufferImageCopy region = {
+            .bufferOffset = 0,
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1 },
+            .imageOffset = { .x = 0, .y = 0, .z = 0 },
+            .imageExtent = { .width = width, .height = height, .depth = 1 }
+        };
+        vkCmdCopyImageToBuffer(cmdBuf, pFrame->image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pFrame->readbackBuffer, 1, &region);
+
+        // The fence alone does not make the copy visible to the host
+        const VkBufferMemoryBarrier hostBarrier = {
+            .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_HOST_READ_BIT,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .buffer = pFrame->readbackBuffer,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE
+        };
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, NULL, 1, &hostBarrier, 0, NULL);
+    }
+}
+
+bool SubmitRenderContextFrame(RenderContext* pContext, const RenderContextScene* pScene)
+{
+    const VkDevice device = pContext->info.device;
+    RenderContextFrame* pFrame = &pContext->frames[pContext->submittedFrameCount % pContext->info.frameCount];
+
+    const uint64_t waitStartTime = GetCurrentTimeNanoseconds();
+    VkResult res = vkWaitForFences(device, 1, &pFrame->fence, VK_TRUE, UINT64_MAX);
+    pContext->fenceWaitTime += GetCurrentTimeNanoseconds() - waitStartTime;
+    if (res != VK_SUCCESS)
+    {
+        printf("vkWaitForFences for render context failed: %d\n", res);
+        return false;
+    }
+
+    // The frame of the slot has completed, so its buffer can be written again
+    FlattenVertexUniform* pUniform = (FlattenVertexUniform*)pFrame->pBufferData;
+    pUniform->u_factor[0] = pScene->cameraExtent[0];
+    pUniform->u_factor[1] = pScene->cameraExtent[1];
+    pUniform->u_angle = pScene->angle;
+    pUniform->u_minLod = 0.0f;
+    memcpy(pFrame->pBufferData + pContext->vertexOffset + RENDER_CONTEXT_VERTEX_DATA_SIZE, pScene->vertexColors, RENDER_CONTEXT_VERTEX_DATA_SIZE);
+
+    res = vkResetCommandBuffer(pFrame->commandBuffer, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkResetCommandBuffer for render context failed: %d\n", res);
+        return false;
+    }
+    const VkCommandBufferBeginInfo beginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+    res = vkBeginCommandBuffer(pFrame->commandBuffer, &beginInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer for render context failed: %d\n", res);
+        return false;
+    }
+    RecordRenderContextFrame(pContext, pFrame);
+    res = vkEndCommandBuffer(pFrame->commandBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for render context failed: %d\n", res);
+        return false;
+    }
+
+    res = vkResetFences(device, 1, &pFrame->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkResetFences for render context failed: %d\n", res);
+        return false;
+    }
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pFrame->commandBuffer,
+        .signalSemaphoreCount = 0,
+        .pSignalSemaphores = NULL
+    };
+    const uint64_t lockStartTime = GetCurrentTimeNanoseconds();
+    LockPlatformMutex(&pContext->info.pQueue->mutex);
+    pContext->queueWaitTime += GetCurrentTimeNanoseconds() - lockStartTime;
+    res = vkQueueSubmit(pContext->info.pQueue->queue, 1, &submitInfo, pFrame->fence);
+    UnlockPlatformMutex(&pContext->info.pQueue->mutex);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for render context failed: %d\n", res);
+        return false;
+    }
+
+    ++pContext->submittedFrameCount;
+    return true;
+}
+
+bool FinishRenderContextFrames(RenderContext* pContext)
+{
+    VkFence fences[MAX_RENDER_CONTEXT_FRAME_COUNT];
+    uint32_t fenceCount = 0;
+    for (uint32_t i = 0; i < pContext->info.frameCount; ++i)
+    {
+        if (pContext->frames[i].fence != VK_NULL_HANDLE) {
+            fences[fenceCount++] = pContext->frames[i].fence;
+        }
+    }
+    if (fenceCount == 0) return true;
+
+    const VkResult res = vkWaitForFences(pContext->info.device, fenceCount, fences, VK_TRUE, UINT64_MAX);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkWaitForFences for render context failed: %d\n", res);
+        return false;
+    }
+    return true;
+}
+
+bool ReadRenderContextFrame(RenderContext* pContext, const uint8_t** ppPixels)
+{
+    if (pContext->submittedFrameCount == 0)
+    {
+        puts("No render context frame has been submitted to read!");
+        return false;
+    }
+    const RenderContextFrame* pFrame = &pContext->frames[(pContext->submittedFrameCount - 1) % pContext->info.frameCount];
+
+    const uint64_t waitStartTime = GetCurrentTimeNanoseconds();
+    VkResult res = vkWaitForFences(pContext->info.device, 1, &pFrame->fence, VK_TRUE, UINT64_MAX);
+    pContext->fenceWaitTime += GetCurrentTimeNanoseconds() - waitStartTime;
+    if (res != VK_SUCCESS)
+    {
+        printf("vkWaitForFences for render context readback failed: %d\n", res);
+        return false;
+    }
+
+    if (!pContext->isReadbackCoherent)
+    {
+        const VkMappedMemoryRange range = {
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext = NULL,
+            .memory = pFrame->readbackMemory,
+            .offset = 0,
+            .size = VK_WHOLE_SIZE
+        };
+        res = vkInvalidateMappedMemoryRanges(pContext->info.device, 1, &range);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkInvalidateMappedMemoryRanges for render context readback failed: %d\n", res);
+            return false;
+        }
+    }
+    *ppPixels = pFrame->pReadbackData;
+    return true;
+}
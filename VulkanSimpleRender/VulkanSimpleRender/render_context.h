@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+#include "memory_tracker.h"
+
+enum RENDER_CONTEXT_CONSTANTS
+{
+    MAX_RENDER_CONTEXT_FRAME_COUNT = 8,
+    // Every context draws the two squares of the renderer, each a triangle strip of the same 4 vertices
+    RENDER_CONTEXT_DRAW_COUNT = 2,
+    RENDER_CONTEXT_VERTEX_COUNT = 4
+};
+
+// MUST BE the same as transform_block in the vertex shaders, of the renderer and of the contexts alike
+typedef struct FlattenVertexUniform
+{
+    float u_factor[2];
+    float u_angle;
+    // Finest mip level sampled by textured.frag.glsl
+    float u_minLod;
+} FlattenVertexUniform;
+
+static_assert(sizeof(FlattenVertexUniform) == 16U, "Invalid FlattenVertexUniform size");
+
+// The state of the pipelines drawing the squares, or a mesh in their place
+typedef struct ScenePipelineCreateInfo
+{
+    VkDevice device;
+    const VkAllocationCallbacks* pAllocator;
+    VkPipelineCache pipelineCache;
+    VkPipelineCreateFlags flags;
+    VkShaderModule vertexShader;
+    VkShaderModule fragmentShader;
+    // NULL for the positions and the colors of the squares, xyzw each in bindings 0 and 1 at locations 0 and 1
+    const VkPipelineVertexInputStateCreateInfo* pVertexInputState;
+    VkPrimitiveTopology topology;
+    VkCullModeFlags cullMode;
+    VkPipelineLayout layout;
+    VkRenderPass renderPass;
+} ScenePipelineCreateInfo;
+
+typedef struct RenderTargetImageCreateInfo
+{
+    VkDevice device;
+    const VkAllocationCallbacks* pAllocator;
+    DeviceMemoryTracker* pMemoryTracker;
+    uint32_t queueFamilyIndex;
+    uint32_t width;
+    uint32_t height;
+    VkFormat format;
+    VkImageUsageFlags usage;
+    VkImageAspectFlags aspectMask;
+    DeviceMemoryCategory category;
+} RenderTargetImageCreateInfo;
+
+// A queue the contexts submit to. Contexts sharing a queue take turns on its mutex, since vkQueueSubmit MUST BE externally synchronized.
+typedef struct RenderQueue
+{
+    VkQueue queue;
+    PlatformMutex mutex;
+} RenderQueue;
+
+typedef struct RenderContextCreateInfo
+{
+    VkDevice device;
+    const VkAllocationCallbacks* pAllocator;
+    // Allocates the render targets and the frame buffers, shared by every context
+    DeviceMemoryTracker* pMemoryTracker;
+    // Shared by every context. A pipeline cache is internally synchronized unless it is created with
+    // VK_PIPELINE_CACHE_CREATE_EXTERNALLY_SYNCHRONIZED_BIT, so the contexts can create their pipelines at the same time.
+    VkPipelineCache pipelineCache;
+    RenderQueue* pQueue;
+    uint32_t queueFamilyIndex;
+    uint32_t width;
+    uint32_t height;
+    VkFormat colorFormat;
+    VkFormat depthFormat;
+    // Frames in flight, at most MAX_RENDER_CONTEXT_FRAME_COUNT
+    uint32_t frameCount;
+    // VkPhysicalDeviceLimits::minUniformBufferOffsetAlignment
+    VkDeviceSize uniformAlignment;
+    // Shared by every context. The vertex shaders read transform_block at set 0, binding 0, and the position and the color
+    // of a vertex at locations 0 and 1, as flatten.vert.glsl and gradient.vert.glsl do.
+    VkShaderModule vertexShaders[RENDER_CONTEXT_DRAW_COUNT];
+    VkShaderModule fragmentShaders[RENDER_CONTEXT_DRAW_COUNT];
+    // xyzw of every vertex
+    const float* pVertexCoords;
+    // Copies every frame into a host visible buffer, so it can be read with ReadRenderContextFrame.
+    // colorFormat MUST have 4 bytes per texel then.
+    bool isReadbackEnabled;
+} RenderContextCreateInfo;
+
+// Everything a frame of a context draws
+typedef struct RenderContextScene
+{
+    // Half extents of the orthographic camera
+    float cameraExtent[2];
+    // Rotation of the squares in degrees
+    float angle;
+    // RGBA of every vertex
+    float vertexColors[RENDER_CONTEXT_VERTEX_COUNT][4];
+} RenderContextScene;
+
+typedef struct RenderContextFrame
+{
+    VkImage image;
+    VkDeviceMemory imageMemory;
+    VkImageView imageView;
+    VkFramebuffer framebuffer;
+    // The uniform block, then the vertex positions and colors, written by the host for every frame
+    VkBuffer buffer;
+    VkDeviceMemory bufferMemory;
+    uint8_t* pBufferData;
+    VkDescriptorSet descriptorSet;
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    // The tightly packed texels of the render target, with isReadbackEnabled
+    VkBuffer readbackBuffer;
+    VkDeviceMemory readbackMemory;
+    const uint8_t* pReadbackData;
+} RenderContextFrame;
+
+// The state of one render target on one queue, so that a process can render many independent scenes at the same time.
+// A context MUST only be used by one thread at a time. It shares the device, the pipeline cache, the shader modules, the memory
+// tracker and possibly its queue with the other contexts, everything else is its own.
+typedef struct RenderContext
+{
+    RenderContextCreateInfo info;
+    VkRenderPass renderPass;
+    VkDescriptorSetLayout descriptorSetLayout;
+    VkPipelineLayout pipelineLayout;
+    VkPipeline pipelines[RENDER_CONTEXT_DRAW_COUNT];
+    VkDescriptorPool descriptorPool;
+    VkCommandPool commandPool;
+    // Shared by the frames in flight, which the render pass orders
+    VkImage depthImage;
+    VkDeviceMemory depthMemory;
+    VkImageView depthImageView;
+    RenderContextFrame frames[MAX_RENDER_CONTEXT_FRAME_COUNT];
+    // Of the vertex positions in the frame buffers, the colors follow them
+    VkDeviceSize vertexOffset;
+    // Cached readback memory MUST BE invalidated before it is read, which is the faster memory for the host to read
+    bool isReadbackCoherent;
+
+    uint64_t submittedFrameCount;
+    // Nanoseconds waited for a frame in flight to complete
+    uint64_t fenceWaitTime;
+    // Nanoseconds waited for the queue while other contexts submitted to it
+    uint64_t queueWaitTime;
+} RenderContext;
+
+// The render pass, the pipelines and the attachments are created the same way for the renderer of main.c and for the contexts.
+
+// A cleared color attachment ending in `colorFinalLayout` and a cleared depth attachment shared by the frames in flight.
+// `colorReadStages` read the color attachment after the render pass, like the copies of a readback: they wait for the render pass,
+// and the next render pass into the same attachment waits for them.
+extern bool CreateSceneRenderPass(VkDevice device, const VkAllocationCallbacks* pAllocator, VkFormat colorFormat, VkFormat depthFormat,
+                                  VkImageLayout colorFinalLayout, VkPipelineStageFlags colorReadStages, VkRenderPass* pRenderPass);
+// Viewport and scissor are dynamic, the depth test is enabled and blending disabled.
+extern bool CreateSceneGraphicsPipeline(const ScenePipelineCreateInfo* pCreateInfo, VkPipeline* pPipeline);
+// A 2D attachment in device local memory and its view. What has been created when a call fails is left for the caller to destroy.
+extern bool CreateRenderTargetImage(const RenderTargetImageCreateInfo* pCreateInfo, VkImage* pImage, VkDeviceMemory* pMemory,
+                                    VkImageView* pImageView);
+
+extern bool CreateRenderContext(const RenderContextCreateInfo* pCreateInfo, RenderContext* pContext);
+// Waits for the frames in flight first.
+extern void DestroyRenderContext(RenderContext* pContext);
+
+// Waits until the oldest frame in flight has completed, then renders `pScene` into its render target. The render target is left in
+// VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL.
+extern bool SubmitRenderContextFrame(RenderContext* pContext, const RenderContextScene* pScene);
+// Waits until every submitted frame has completed.
+extern bool FinishRenderContextFrames(RenderContext* pContext);
+// Waits until the last submitted frame has completed and returns its texels in `ppPixels`, rows of width * 4 bytes. They stay valid until
+// frameCount more frames are submitted. isReadbackEnabled MUST BE set.
+extern bool ReadRenderContextFrame(RenderContext* pContext, const uint8_t** ppPixels);
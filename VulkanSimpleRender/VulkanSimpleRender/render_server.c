@@ -0,0 +1,399 @@
+#ifndef _WIN32
+// memfd_create
+#define _GNU_SOURCE
+#endif // !_WIN32
+
+#include "render_server.h"
+#include "platform_utils.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif // !_WIN32
+
+#ifdef _WIN32
+
+bool CreateRenderServer(const RenderServerCreateInfo* pCreateInfo, RenderServer* pServer)
+{
+    // Windows would listen on a named pipe and share the frames through a file mapping instead.
+    (void)pCreateInfo;
+    memset(pServer, 0, sizeof(*pServer));
+    puts("The render server is only implemented with Unix domain sockets on Linux!");
+    return false;
+}
+
+void DestroyRenderServer(RenderServer* pServer)
+{
+    memset(pServer, 0, sizeof(*pServer));
+}
+
+bool RunRenderServer(RenderServer* pServer)
+{
+    (void)pServer;
+    return false;
+}
+
+#else
+
+// Sends the texels after the response, each packet a slice of the frame
+static bool SendRenderServerFrame(int socketFd, const uint8_t* pPixels, uint64_t size)
+{
+    for (uint64_t offset = 0; offset < size;)
+    {
+        const size_t packetSize = (size_t)(size - offset < RENDER_SERVER_PACKET_SIZE ? size - offset : RENDER_SERVER_PACKET_SIZE);
+        ssize_t sentSize;
+        do {
+            sentSize = send(socketFd, pPixels + offset, packetSize, MSG_NOSIGNAL);
+        } while (sentSize < 0 && errno == EINTR);
+        if (sentSize != (ssize_t)packetSize) return false;
+        offset += packetSize;
+    }
+    return true;
+}
+
+static bool AddRenderServerSample(RenderServer* pServer, double latency, double renderTime)
+{
+    if (pServer->sampleCount == pServer->sampleCapacity)
+    {
+        const uint32_t newCapacity = pServer->sampleCapacity * 2;
+        double* pLatencies = realloc(pServer->pLatencies, newCapacity * sizeof(double));
+        if (pLatencies == NULL) return false;
+        pServer->pLatencies = pLatencies;
+        double* pRenderTimes = realloc(pServer->pRenderTimes, newCapacity * sizeof(double));
+        if (pRenderTimes == NULL) return false;
+        pServer->pRenderTimes = pRenderTimes;
+        pServer->sampleCapacity = newCapacity;
+    }
+    pServer->pLatencies[pServer->sampleCount] = latency;
+    pServer->pRenderTimes[pServer->sampleCount] = renderTime;
+    ++pServer->sampleCount;
+    return true;
+}
+
+static void FillRenderServerFrameInfo(const RenderServer* pServer, RenderServerMessage* pMessage)
+{
+    const RenderContext* pContext = pServer->info.pContext;
+    pMessage->width = pContext->info.width;
+    pMessage->height = pContext->info.height;
+    pMessage->format = (uint32_t)pContext->info.colorFormat;
+    pMessage->rowPitch = pContext->info.width * 4;
+    pMessage->frameSize = pServer->frameSize;
+    pMessage->sharedSlotCount = RENDER_SERVER_SHARED_SLOT_COUNT;
+}
+
+// Renders a frame for the RENDER request and sends the response. Returns false with *pIsFatal set if the frame cannot be rendered,
+// and with it cleared if only the client is gone.
+static bool HandleRenderRequest(RenderServer* pServer, RenderServerClient* pClient, const RenderServerMessage* pRequest, uint64_t receiveTime,
+                                bool* pIsFatal)
+{
+    RenderContext* pContext = pServer->info.pContext;
+    const int socketFd = pClient->socketFd;
+    RenderServerMessage response = { .type = RENDER_SERVER_MESSAGE_RESPONSE, .status = 0 };
+    *pIsFatal = false;
+    if (pRequest->delivery > RENDER_SERVER_FRAME_DELIVERY_NONE)
+    {
+        ++pServer->failedRequestCount;
+        response.status = -1;
+        return SendRenderServerMessage(socketFd, &response, -1);
+    }
+    if (pRequest->hasScene != 0) {
+        pServer->scene = pRequest->scene;
+    }
+
+    const uint8_t* pPixels = NULL;
+    if (!SubmitRenderContextFrame(pContext, &pServer->scene) || !ReadRenderContextFrame(pContext, &pPixels))
+    {
+        *pIsFatal = true;
+        return false;
+    }
+    const uint64_t renderEndTime = GetCurrentTimeNanoseconds();
+
+    FillRenderServerFrameInfo(pServer, &response);
+    response.frameNumber = pContext->submittedFrameCount - 1;
+    response.renderTime = renderEndTime - receiveTime;
+    if (pRequest->delivery == RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY)
+    {
+        response.sharedSlot = pClient->nextSharedSlot;
+        pClient->nextSharedSlot = (pClient->nextSharedSlot + 1) % RENDER_SERVER_SHARED_SLOT_COUNT;
+        memcpy(pClient->pSharedMemory + response.sharedSlot * pServer->frameSize, pPixels, pServer->frameSize);
+    }
+    if (!SendRenderServerMessage(socketFd, &response, -1)) return false;
+    // The texels stay valid until the next frames are submitted, so they are sent straight from the readback memory
+    if (pRequest->delivery == RENDER_SERVER_FRAME_DELIVERY_INLINE && !SendRenderServerFrame(socketFd, pPixels, pServer->frameSize)) {
+        return false;
+    }
+
+    ++pServer->deliveryCounts[pRequest->delivery];
+    const double latency = (double)(GetCurrentTimeNanoseconds() - receiveTime) / 1000000.0;
+    if (!AddRenderServerSample(pServer, latency, (double)response.renderTime / 1000000.0))
+    {
+        puts("Failed to grow the render server latency samples!");
+        *pIsFatal = true;
+        return false;
+    }
+    return true;
+}
+
+// Answers the next request of the client, which MUST have one waiting. Returns false if the server has to stop,
+// and clears *pIsConnected if the client has disconnected or cannot be served any more.
+static bool ServeRenderClientRequest(RenderServer* pServer, RenderServerClient* pClient, bool* pIsConnected, bool* pIsShutdownRequested)
+{
+    const int socketFd = pClient->socketFd;
+    RenderServerMessage request;
+    int fd = -1;
+    *pIsConnected = ReceiveRenderServerMessage(socketFd, &request, &fd);
+    if (!*pIsConnected) return true;
+    const uint64_t receiveTime = GetCurrentTimeNanoseconds();
+    // Clients have nothing to hand over
+    if (fd >= 0) {
+        close(fd);
+    }
+    ++pServer->requestCount;
+    ++pClient->requestCount;
+
+    RenderServerMessage response = { .type = RENDER_SERVER_MESSAGE_RESPONSE, .status = 0 };
+    switch (request.type)
+    {
+    case RENDER_SERVER_MESSAGE_UPDATE_SCENE:
+        pServer->scene = request.scene;
+        *pIsConnected = SendRenderServerMessage(socketFd, &response, -1);
+        return true;
+    case RENDER_SERVER_MESSAGE_RENDER:
+    {
+        bool isFatal = false;
+        *pIsConnected = HandleRenderRequest(pServer, pClient, &request, receiveTime, &isFatal);
+        return !isFatal;
+    }
+    case RENDER_SERVER_MESSAGE_SHUTDOWN:
+        *pIsShutdownRequested = true;
+        SendRenderServerMessage(socketFd, &response, -1);
+        *pIsConnected = false;
+        return true;
+    default:
+        ++pServer->failedRequestCount;
+        response.status = -1;
+        *pIsConnected = SendRenderServerMessage(socketFd, &response, -1);
+        return true;
+    }
+}
+
+// Creates anonymous memory of RENDER_SERVER_SHARED_SLOT_COUNT frames the client maps, so a frame crosses the process boundary with a single copy.
+// Returns its descriptor and maps it into the server, -1 on failure.
+// Every client gets memory of its own, so no client can read the frames of another or have its slots overwritten by their requests.
+static int CreateRenderClientSharedMemory(const RenderServer* pServer, uint8_t** ppSharedMemory)
+{
+    const uint64_t sharedMemorySize = pServer->frameSize * RENDER_SERVER_SHARED_SLOT_COUNT;
+    const int fd = memfd_create("VulkanSimpleRender frames", MFD_CLOEXEC);
+    if (fd < 0 || ftruncate(fd, (off_t)sharedMemorySize) != 0)
+    {
+        printf("Creating the render client shared memory failed: %d\n", errno);
+        if (fd >= 0) {
+            close(fd);
+        }
+        return -1;
+    }
+    void* pSharedMemory = mmap(NULL, (size_t)sharedMemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (pSharedMemory == MAP_FAILED)
+    {
+        printf("Mapping the render client shared memory failed: %d\n", errno);
+        close(fd);
+        return -1;
+    }
+    *ppSharedMemory = pSharedMemory;
+    return fd;
+}
+
+static void ReleaseRenderClient(const RenderServer* pServer, const RenderServerClient* pClient)
+{
+    close(pClient->socketFd);
+    munmap(pClient->pSharedMemory, (size_t)(pServer->frameSize * RENDER_SERVER_SHARED_SLOT_COUNT));
+}
+
+// Accepts a waiting client and sends it the hello message with its shared memory. Returns false if no client can be accepted any more.
+static bool AcceptRenderClient(RenderServer* pServer)
+{
+    int socketFd;
+    do {
+        socketFd = accept4(pServer->listenFd, NULL, NULL, SOCK_CLOEXEC);
+    } while (socketFd < 0 && errno == EINTR);
+    if (socketFd < 0)
+    {
+        printf("Accepting a render client failed: %d\n", errno);
+        return false;
+    }
+    ++pServer->clientCount;
+    if (pServer->connectedClientCount == MAX_RENDER_SERVER_CLIENT_COUNT)
+    {
+        printf("Render client %u turned away, %d clients are connected already\n", pServer->clientCount, MAX_RENDER_SERVER_CLIENT_COUNT);
+        close(socketFd);
+        return true;
+    }
+
+    // Requests are only received once poll reports them, but a response or an inline frame is sent with a blocking send,
+    // which a client that stops reading would stall forever.
+    const struct timeval sendTimeout = {
+        .tv_sec = RENDER_SERVER_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (RENDER_SERVER_SEND_TIMEOUT_MS % 1000) * 1000
+    };
+    if (setsockopt(socketFd, SOL_SOCKET, SO_SNDTIMEO, &sendTimeout, sizeof(sendTimeout)) != 0)
+    {
+        printf("Setting the send timeout of render client %u failed: %d\n", pServer->clientCount, errno);
+        close(socketFd);
+        return true;
+    }
+    RenderServerClient client = {
+        .socketFd = socketFd,
+        .pSharedMemory = NULL,
+        .nextSharedSlot = 0,
+        .number = pServer->clientCount,
+        .requestCount = 0
+    };
+    const int sharedMemoryFd = CreateRenderClientSharedMemory(pServer, &client.pSharedMemory);
+    if (sharedMemoryFd < 0)
+    {
+        // The client is turned away, the clients already connected are still served
+        close(socketFd);
+        return true;
+    }
+
+    RenderServerMessage hello = { .type = RENDER_SERVER_MESSAGE_HELLO, .status = 0 };
+    FillRenderServerFrameInfo(pServer, &hello);
+    const bool isSent = SendRenderServerMessage(socketFd, &hello, sharedMemoryFd);
+    // The mappings of the server and the client keep the memory alive
+    close(sharedMemoryFd);
+    if (!isSent)
+    {
+        printf("Render client %u disconnected before the hello message\n", pServer->clientCount);
+        ReleaseRenderClient(pServer, &client);
+        return true;
+    }
+    pServer->clients[pServer->connectedClientCount++] = client;
+    return true;
+}
+
+// Closes the connection to the client at `index`, which is replaced by the last client.
+static void DisconnectRenderClient(RenderServer* pServer, uint32_t index)
+{
+    const RenderServerClient* pClient = &pServer->clients[index];
+    ReleaseRenderClient(pServer, pClient);
+    printf("Render client %u disconnected after %llu requests\n", pClient->number, (unsigned long long)pClient->requestCount);
+    pServer->clients[index] = pServer->clients[--pServer->connectedClientCount];
+}
+
+bool CreateRenderServer(const RenderServerCreateInfo* pCreateInfo, RenderServer* pServer)
+{
+    memset(pServer, 0, sizeof(*pServer));
+    pServer->info = *pCreateInfo;
+    pServer->listenFd = -1;
+    pServer->scene = *pCreateInfo->pInitialScene;
+    pServer->info.pInitialScene = NULL;
+    if (!pCreateInfo->pContext->info.isReadbackEnabled)
+    {
+        puts("The render context of the render server does not read its frames back!");
+        return false;
+    }
+    const size_t socketPathLength = strlen(pCreateInfo->socketPath);
+    if (socketPathLength >= sizeof(pServer->socketPath))
+    {
+        printf("Render server socket path '%s' is too long!\n", pCreateInfo->socketPath);
+        return false;
+    }
+    memcpy(pServer->socketPath, pCreateInfo->socketPath, socketPathLength + 1);
+    pServer->info.socketPath = pServer->socketPath;
+
+    pServer->sampleCapacity = DEFAULT_RENDER_SERVER_SAMPLE_CAPACITY;
+    pServer->pLatencies = malloc(pServer->sampleCapacity * sizeof(double));
+    pServer->pRenderTimes = malloc(pServer->sampleCapacity * sizeof(double));
+    if (pServer->pLatencies == NULL || pServer->pRenderTimes == NULL)
+    {
+        puts("Failed to allocate the render server latency samples!");
+        DestroyRenderServer(pServer);
+        return false;
+    }
+
+    const RenderContext* pContext = pCreateInfo->pContext;
+    pServer->frameSize = (uint64_t)pContext->info.width * pContext->info.height * 4;
+
+    pServer->listenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (pServer->listenFd < 0)
+    {
+        printf("Creating the render server socket failed: %d\n", errno);
+        DestroyRenderServer(pServer);
+        return false;
+    }
+    struct sockaddr_un address = { .sun_family = AF_UNIX };
+    memcpy(address.sun_path, pServer->socketPath, socketPathLength + 1);
+    // bind fails on an existing path, and a server that was killed never got to unlink its socket in DestroyRenderServer
+    unlink(pServer->socketPath);
+    if (bind(pServer->listenFd, (const struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(pServer->listenFd, MAX_RENDER_SERVER_CLIENT_COUNT) != 0)
+    {
+        printf("Listening on %s failed: %d\n", pServer->socketPath, errno);
+        close(pServer->listenFd);
+        pServer->listenFd = -1;
+        DestroyRenderServer(pServer);
+        return false;
+    }
+    return true;
+}
+
+void DestroyRenderServer(RenderServer* pServer)
+{
+    if (pServer->info.pContext == NULL) return;
+
+    for (uint32_t i = 0; i < pServer->connectedClientCount; ++i) {
+        ReleaseRenderClient(pServer, &pServer->clients[i]);
+    }
+    if (pServer->listenFd >= 0)
+    {
+        close(pServer->listenFd);
+        unlink(pServer->socketPath);
+    }
+    free(pServer->pLatencies);
+    free(pServer->pRenderTimes);
+    memset(pServer, 0, sizeof(*pServer));
+}
+
+bool RunRenderServer(RenderServer* pServer)
+{
+    bool isShutdownRequested = false;
+    while (!isShutdownRequested)
+    {
+        // The listening socket, then every client
+        struct pollfd pollFds[MAX_RENDER_SERVER_CLIENT_COUNT + 1];
+        pollFds[0] = (struct pollfd){ .fd = pServer->listenFd, .events = POLLIN, .revents = 0 };
+        for (uint32_t i = 0; i < pServer->connectedClientCount; ++i) {
+            pollFds[i + 1] = (struct pollfd){ .fd = pServer->clients[i].socketFd, .events = POLLIN, .revents = 0 };
+        }
+        if (poll(pollFds, (nfds_t)(pServer->connectedClientCount + 1), -1) < 0)
+        {
+            if (errno == EINTR) continue;
+            printf("Polling the render clients failed: %d\n", errno);
+            return false;
+        }
+
+        // One request per client and round, so a busy client cannot starve the others. Backwards, since a disconnected client
+        // is replaced by the last one, which has been served already.
+        for (uint32_t i = pServer->connectedClientCount; i-- > 0 && !isShutdownRequested;)
+        {
+            if ((pollFds[i + 1].revents & (POLLIN | POLLHUP | POLLERR)) == 0) continue;
+
+            bool isConnected = true;
+            if (!ServeRenderClientRequest(pServer, &pServer->clients[i], &isConnected, &isShutdownRequested)) return false;
+            if (!isConnected) {
+                DisconnectRenderClient(pServer, i);
+            }
+        }
+        if ((pollFds[0].revents & POLLIN) != 0 && !isShutdownRequested && !AcceptRenderClient(pServer)) return false;
+    }
+    return true;
+}
+
+#endif // _WIN32
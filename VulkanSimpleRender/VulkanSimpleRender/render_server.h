@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "render_context.h"
+#include "render_server_message.h"
+
+enum RENDER_SERVER_CONSTANTS
+{
+    MAX_RENDER_SERVER_PATH_LENGTH = 108,
+    // Clients served at once, a client connecting beyond them is turned away
+    MAX_RENDER_SERVER_CLIENT_COUNT = 8,
+    // A client that does not take a response within this time is dropped, so it cannot stall the others
+    RENDER_SERVER_SEND_TIMEOUT_MS = 2000,
+    // One latency sample per request rendered, of all clients together. Longer sessions grow the samples.
+    DEFAULT_RENDER_SERVER_SAMPLE_CAPACITY = 1024
+};
+
+typedef struct RenderServerCreateInfo
+{
+    // Listens on a Unix domain socket at this path and serves up to MAX_RENDER_SERVER_CLIENT_COUNT clients at once
+    const char* socketPath;
+    // Renders every frame, created with isReadbackEnabled. It stays alive between the requests and the clients, so no request pays for
+    // creating the instance, the device, the pipelines or the memory.
+    RenderContext* pContext;
+    // Rendered until a client updates it
+    const RenderContextScene* pInitialScene;
+} RenderServerCreateInfo;
+
+typedef struct RenderServerClient
+{
+    int socketFd;
+    // RENDER_SERVER_SHARED_SLOT_COUNT frames, only mapped by this client
+    uint8_t* pSharedMemory;
+    uint32_t nextSharedSlot;
+    // Counted from 1 in the order the clients connected
+    uint32_t number;
+    uint64_t requestCount;
+} RenderServerClient;
+
+// Renders frames on request of local clients. Not thread safe, RunRenderServer blocks the calling thread.
+// The clients are polled together and served one request at a time in turn, so an idle client never holds up the others.
+typedef struct RenderServer
+{
+    RenderServerCreateInfo info;
+    char socketPath[MAX_RENDER_SERVER_PATH_LENGTH];
+    int listenFd;
+    uint64_t frameSize;
+    // Kept across the clients
+    RenderContextScene scene;
+
+    RenderServerClient clients[MAX_RENDER_SERVER_CLIENT_COUNT];
+    uint32_t connectedClientCount;
+
+    // Every client that has connected so far
+    uint32_t clientCount;
+    uint64_t requestCount;
+    uint64_t failedRequestCount;
+    uint64_t deliveryCounts[RENDER_SERVER_FRAME_DELIVERY_NONE + 1];
+    // Milliseconds per RENDER request, from receiving it to sending the last packet of the response, and the part of it until the frame
+    // could be read on the host
+    double* pLatencies;
+    double* pRenderTimes;
+    uint32_t sampleCount;
+    uint32_t sampleCapacity;
+} RenderServer;
+
+// Starts listening. Returns false if the socket cannot be created.
+extern bool CreateRenderServer(const RenderServerCreateInfo* pCreateInfo, RenderServer* pServer);
+extern void DestroyRenderServer(RenderServer* pServer);
+
+// Serves the clients until one of them sends RENDER_SERVER_MESSAGE_SHUTDOWN. Returns false if a frame cannot be rendered or no client
+// can be accepted any more. Invalid requests are answered with a non-zero status, a client that disconnects is just dropped.
+extern bool RunRenderServer(RenderServer* pServer);
@@ -0,0 +1,43 @@
+#include "render_server_message.h"
+#include "platform_utils.h"
+#include <string.h>
+
+#ifdef _WIN32
+
+bool SendRenderServerMessage(int socketFd, const RenderServerMessage* pMessage, int fd)
+{
+    (void)socketFd; (void)pMessage; (void)fd;
+    return false;
+}
+
+bool ReceiveRenderServerMessage(int socketFd, RenderServerMessage* pMessage, int* pFd)
+{
+    (void)socketFd; (void)pMessage;
+    *pFd = -1;
+    return false;
+}
+
+#else
+
+bool SendRenderServerMessage(int socketFd, const RenderServerMessage* pMessage, int fd)
+{
+    return SendPlatformSocketPacket(socketFd, pMessage, sizeof(*pMessage), &fd, fd >= 0 ? 1 : 0);
+}
+
+bool ReceiveRenderServerMessage(int socketFd, RenderServerMessage* pMessage, int* pFd)
+{
+    size_t packetSize = 0;
+    uint32_t fdCount = 0;
+    *pFd = -1;
+    if (!ReceivePlatformSocketPacket(socketFd, pMessage, sizeof(*pMessage), &packetSize, pFd, 1, &fdCount)) return false;
+
+    // A packet of another size comes from a peer built against another version of the message
+    if (packetSize != sizeof(*pMessage))
+    {
+        memset(pMessage, 0, sizeof(*pMessage));
+        pMessage->type = UINT32_MAX;
+    }
+    return true;
+}
+
+#endif // _WIN32
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "render_context.h"
+
+enum RENDER_SERVER_MESSAGE_CONSTANTS
+{
+    // Frames a client can hold in its shared memory at once. The frame of a request goes into the slot after the previous one of the client.
+    RENDER_SERVER_SHARED_SLOT_COUNT = 2,
+    // Inline texels follow a response in packets of at most this size, well below the send buffer limit of a SOCK_SEQPACKET socket
+    RENDER_SERVER_PACKET_SIZE = 64 * 1024
+};
+
+typedef enum RenderServerMessageType
+{
+    // Server to client, once after connecting: the size and format of the frames, with a file descriptor of shared memory holding
+    // RENDER_SERVER_SHARED_SLOT_COUNT frames, to be mapped read-only. Every client gets memory of its own.
+    RENDER_SERVER_MESSAGE_HELLO,
+    // Client to server: replaces the scene every later frame renders
+    RENDER_SERVER_MESSAGE_UPDATE_SCENE,
+    // Client to server: renders a frame, of `scene` if `hasScene` is set and of the current scene otherwise, and delivers it
+    RENDER_SERVER_MESSAGE_RENDER,
+    // Client to server: stops the server once the response has been sent
+    RENDER_SERVER_MESSAGE_SHUTDOWN,
+    // Server to client: answers every request in order
+    RENDER_SERVER_MESSAGE_RESPONSE
+} RenderServerMessageType;
+
+typedef enum RenderServerFrameDelivery
+{
+    // The texels follow the response on the socket, in packets of at most RENDER_SERVER_PACKET_SIZE bytes
+    RENDER_SERVER_FRAME_DELIVERY_INLINE,
+    // The texels are written into `sharedSlot` of the shared memory before the response is sent
+    RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY,
+    // The frame is only rendered, to measure its cost without delivering it
+    RENDER_SERVER_FRAME_DELIVERY_NONE
+} RenderServerFrameDelivery;
+
+// Every message has the same size, sent as one packet of a SOCK_SEQPACKET socket. Both sides run on the same machine.
+typedef struct RenderServerMessage
+{
+    uint32_t type;
+    // RESPONSE: 0 if the request succeeded
+    int32_t status;
+
+    // UPDATE_SCENE and RENDER
+    RenderContextScene scene;
+    // RENDER
+    uint32_t hasScene;
+    uint32_t delivery;
+
+    // HELLO, and RESPONSE to RENDER. Rows are rowPitch bytes apart, a frame is frameSize bytes.
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;
+    uint32_t rowPitch;
+    uint64_t frameSize;
+    uint32_t sharedSlotCount;
+    // RESPONSE to RENDER with RENDER_SERVER_FRAME_DELIVERY_SHARED_MEMORY, the frame is at sharedSlot * frameSize
+    uint32_t sharedSlot;
+    // RESPONSE to RENDER: counted over all clients, and nanoseconds from receiving the request until the frame could be read on the host
+    uint64_t frameNumber;
+    uint64_t renderTime;
+} RenderServerMessage;
+
+// Sends the message, and the file descriptor into the receiving process if it is not negative. The caller keeps its descriptor.
+extern bool SendRenderServerMessage(int socketFd, const RenderServerMessage* pMessage, int fd);
+// Blocks until a message arrives. A received descriptor belongs to the caller, -1 if none. Returns false if the peer has disconnected.
+extern bool ReceiveRenderServerMessage(int socketFd, RenderServerMessage* pMessage, int* pFd);
@@ -0,0 +1,73 @@
+#version 450 core
+
+// MUST BE the same as FRAME_CAPTURE_YUV_WORKGROUP_SIZE in frame_capture.h
+layout(local_size_x = 8, local_size_y = 8, local_size_z = 1) in;
+
+layout(set = 0, binding = 0, rgba8) uniform readonly image2D srcImage;
+
+// The Y plane followed by the U and the V plane at half resolution, four bytes per word
+layout(std430, set = 0, binding = 1) writeonly buffer YuvPlanes
+{
+    uint words[];
+} dstPlanes;
+
+layout(push_constant) uniform Extent
+{
+    uint width;
+    uint height;
+} extent;
+
+ivec3 LoadRgb(uint x, uint y)
+{
+    return ivec3(round(imageLoad(srcImage, ivec2(x, y)).rgb * 255.0));
+}
+
+// Every invocation converts a block of 8x2 pixels into two words of each of its Y rows, one word of U and one of V.
+// Full range BT.601 in the same fixed point arithmetic as ConvertRgbaToYuv420 in frame_capture.c, so both conversions are bit-exact.
+void main()
+{
+    const uint x0 = gl_GlobalInvocationID.x * 8;
+    const uint y0 = gl_GlobalInvocationID.y * 2;
+    if (x0 >= extent.width || y0 >= extent.height) {
+        return;
+    }
+
+    ivec3 rgb[2][8];
+    for (uint row = 0; row < 2; ++row)
+    {
+        for (uint i = 0; i < 8; ++i) {
+            rgb[row][i] = LoadRgb(x0 + i, y0 + row);
+        }
+    }
+
+    for (uint row = 0; row < 2; ++row)
+    {
+        for (uint word = 0; word < 2; ++word)
+        {
+            uint packed = 0;
+            for (uint i = 0; i < 4; ++i)
+            {
+                const ivec3 c = rgb[row][word * 4 + i];
+                packed |= uint((77 * c.r + 150 * c.g + 29 * c.b + 128) >> 8) << (8 * i);
+            }
+            dstPlanes.words[((y0 + row) * extent.width + x0 + word * 4) / 4] = packed;
+        }
+    }
+
+    uint packedU = 0;
+    uint packedV = 0;
+    for (uint i = 0; i < 4; ++i)
+    {
+        const ivec3 s = rgb[0][i * 2] + rgb[0][i * 2 + 1] + rgb[1][i * 2] + rgb[1][i * 2 + 1];
+        // Offset by 128 << 10 and rounded, never negative
+        const int u = (-43 * s.r - 85 * s.g + 128 * s.b + 131584) >> 10;
+        const int v = (128 * s.r - 107 * s.g - 21 * s.b + 131584) >> 10;
+        packedU |= uint(min(u, 255)) << (8 * i);
+        packedV |= uint(min(v, 255)) << (8 * i);
+    }
+    const uint chromaWidth = extent.width / 2;
+    const uint lumaSize = extent.width * extent.height;
+    const uint chromaOffset = gl_GlobalInvocationID.y * chromaWidth + x0 / 2;
+    dstPlanes.words[(lumaSize + chromaOffset) / 4] = packedU;
+    dstPlanes.words[(lumaSize + chromaWidth * (extent.height / 2) + chromaOffset) / 4] = packedV;
+}
@@ -0,0 +1,160 @@
+#include "task_graph.h"
+#include "platform_utils.h"
+
+typedef struct TaskGraphExecution
+{
+    TaskGraphNode* nodes;
+    uint32_t nodeCount;
+    PlatformMutex mutex;
+    PlatformConditionVariable stateChanged;
+    uint64_t finishedMask;
+    uint64_t startedMask;
+    bool hasFailed;
+} TaskGraphExecution;
+
+typedef struct TaskGraphWorker
+{
+    TaskGraphExecution* pExecution;
+    uint32_t workerIndex;
+} TaskGraphWorker;
+
+// Returns the index of a node whose dependencies have all finished, or UINT32_MAX if none is ready.
+// MUST BE called with the execution mutex locked.
+static uint32_t PickReadyNode(const TaskGraphExecution* pExecution)
+{
+    for (uint32_t i = 0; i < pExecution->nodeCount; ++i)
+    {
+        const uint64_t bit = 1ULL << i;
+        if ((pExecution->startedMask & bit) != 0) continue;
+        if ((pExecution->nodes[i].dependencyMask & ~pExecution->finishedMask) == 0) return i;
+    }
+    return UINT32_MAX;
+}
+
+static void RunTaskGraphWorker(void* pArgument)
+{
+    const TaskGraphWorker* pWorker = pArgument;
+    TaskGraphExecution* pExecution = pWorker->pExecution;
+    const uint64_t allNodesMask = pExecution->nodeCount == 64 ? UINT64_MAX : (1ULL << pExecution->nodeCount) - 1ULL;
+
+    LockPlatformMutex(&pExecution->mutex);
+    while (true)
+    {
+        if (pExecution->hasFailed || pExecution->startedMask == allNodesMask) break;
+
+        const uint32_t nodeIndex = PickReadyNode(pExecution);
+        if (nodeIndex == UINT32_MAX)
+        {
+            WaitPlatformConditionVariable(&pExecution->stateChanged, &pExecution->mutex);
+            continue;
+        }
+
+        TaskGraphNode* pNode = &pExecution->nodes[nodeIndex];
+        pExecution->startedMask |= 1ULL << nodeIndex;
+        UnlockPlatformMutex(&pExecution->mutex);
+
+        pNode->workerIndex = pWorker->workerIndex;
+        pNode->beginTime = GetCurrentTimeNanoseconds();
+        pNode->succeeded = pNode->function(pNode->pUserData);
+        pNode->endTime = GetCurrentTimeNanoseconds();
+        pNode->isExecuted = true;
+
+        LockPlatformMutex(&pExecution->mutex);
+        pExecution->finishedMask |= 1ULL << nodeIndex;
+        if (!pNode->succeeded) {
+            pExecution->hasFailed = true;
+        }
+        WakeAllPlatformConditionVariable(&pExecution->stateChanged);
+    }
+    UnlockPlatformMutex(&pExecution->mutex);
+}
+
+bool RunTaskGraph(TaskGraphNode nodes[], uint32_t nodeCount, uint32_t workerCount)
+{
+    if (nodeCount > MAX_TASK_GRAPH_NODE_COUNT) return false;
+
+    for (uint32_t i = 0; i < nodeCount; ++i)
+    {
+        // Only backward dependencies are allowed
+        if ((nodes[i].dependencyMask >> i) != 0) return false;
+
+        nodes[i].beginTime = 0;
+        nodes[i].endTime = 0;
+        nodes[i].workerIndex = 0;
+        nodes[i].isExecuted = false;
+        nodes[i].succeeded = false;
+    }
+
+    if (workerCount < 1) {
+        workerCount = 1;
+    }
+    if (workerCount > MAX_TASK_GRAPH_WORKER_COUNT) {
+        workerCount = MAX_TASK_GRAPH_WORKER_COUNT;
+    }
+    if (workerCount > nodeCount && nodeCount > 0) {
+        workerCount = nodeCount;
+    }
+
+    TaskGraphExecution execution = {
+        .nodes = nodes,
+        .nodeCount = nodeCount,
+        .finishedMask = 0,
+        .startedMask = 0,
+        .hasFailed = false
+    };
+    InitializePlatformMutex(&execution.mutex);
+    InitializePlatformConditionVariable(&execution.stateChanged);
+
+    TaskGraphWorker workers[MAX_TASK_GRAPH_WORKER_COUNT];
+    PlatformThread threads[MAX_TASK_GRAPH_WORKER_COUNT];
+    uint32_t threadCount = 0;
+    for (uint32_t i = 0; i < workerCount; ++i)
+    {
+        workers[i].pExecution = &execution;
+        workers[i].workerIndex = i;
+    }
+
+    // Worker 0 is the calling thread. If a thread cannot be created, the rest of the work is just shared by fewer workers.
+    for (uint32_t i = 1; i < workerCount; ++i)
+    {
+        if (!CreatePlatformThread(&threads[threadCount], RunTaskGraphWorker, &workers[i])) break;
+        threadCount++;
+    }
+
+    RunTaskGraphWorker(&workers[0]);
+
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        JoinPlatformThread(threads[i]);
+    }
+
+    DestroyPlatformConditionVariable(&execution.stateChanged);
+    DestroyPlatformMutex(&execution.mutex);
+
+    return !execution.hasFailed;
+}
+
+uint64_t GetTaskGraphCriticalPathTime(const TaskGraphNode nodes[], uint32_t nodeCount)
+{
+    // Nodes only depend on lower indices, so a single forward pass visits them in topological order.
+    uint64_t pathTimes[MAX_TASK_GRAPH_NODE_COUNT] = { 0 };
+    uint64_t criticalPathTime = 0;
+
+    for (uint32_t i = 0; i < nodeCount && i < MAX_TASK_GRAPH_NODE_COUNT; ++i)
+    {
+        uint64_t longestDependencyTime = 0;
+        for (uint32_t dep = 0; dep < i; ++dep)
+        {
+            if ((nodes[i].dependencyMask & (1ULL << dep)) != 0 && pathTimes[dep] > longestDependencyTime) {
+                longestDependencyTime = pathTimes[dep];
+            }
+        }
+
+        const uint64_t duration = nodes[i].isExecuted ? nodes[i].endTime - nodes[i].beginTime : 0;
+        pathTimes[i] = longestDependencyTime + duration;
+        if (pathTimes[i] > criticalPathTime) {
+            criticalPathTime = pathTimes[i];
+        }
+    }
+
+    return criticalPathTime;
+}
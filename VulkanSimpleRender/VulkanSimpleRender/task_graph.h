@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+enum TASK_GRAPH_CONSTANTS
+{
+    // Dependencies are stored as a 64-bit mask
+    MAX_TASK_GRAPH_NODE_COUNT = 64,
+    MAX_TASK_GRAPH_WORKER_COUNT = 16
+};
+
+typedef bool (*PFN_TaskGraphFunction)(void* pUserData);
+
+typedef struct TaskGraphNode
+{
+    const char* name;
+    PFN_TaskGraphFunction function;
+    void* pUserData;
+    // Bit `i` set means this node MUST NOT start before node `i` has finished.
+    uint64_t dependencyMask;
+
+    // Filled by RunTaskGraph. Timestamps are from GetCurrentTimeNanoseconds().
+    uint64_t beginTime;
+    uint64_t endTime;
+    uint32_t workerIndex;
+    bool isExecuted;
+    bool succeeded;
+} TaskGraphNode;
+
+// Runs all nodes respecting their dependencies on `workerCount` threads, the calling thread included.
+// Dependencies MUST only refer to nodes with a lower index, which makes the graph acyclic by construction.
+// Once a node fails, no further node is started and false is returned after the running ones finish.
+extern bool RunTaskGraph(TaskGraphNode nodes[], uint32_t nodeCount, uint32_t workerCount);
+
+// Returns the length in nanoseconds of the longest dependency chain, measured with the recorded durations of executed nodes.
+extern uint64_t GetTaskGraphCriticalPathTime(const TaskGraphNode nodes[], uint32_t nodeCount);
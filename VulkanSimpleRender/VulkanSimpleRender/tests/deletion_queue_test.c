@@ -0,0 +1,136 @@
+#include "deletion_queue.h"
+#include "fake_vulkan.h"
+#include "test_utils.h"
+
+static FakeVulkanDevice* ResetHostDevice(void)
+{
+    const VkMemoryPropertyFlags propertyFlags[1] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+    const uint32_t heapIndices[1] = { 0 };
+    const VkDeviceSize heapSizes[1] = { 64 * 1024 * 1024 };
+    return ResetFakeVulkanDevice(1, propertyFlags, heapIndices, 1, heapSizes);
+}
+
+static bool IsDestroyed(const FakeVulkanDevice* pDevice, uint32_t destroyedIndex, VkObjectType type, uint64_t handle)
+{
+    return destroyedIndex < pDevice->destroyedObjectCount && pDevice->destroyedObjects[destroyedIndex].type == type &&
+        pDevice->destroyedObjects[destroyedIndex].handle == handle;
+}
+
+static void TestRetirementOrder(void)
+{
+    FakeVulkanDevice* pDevice = ResetHostDevice();
+    const DeletionQueueCreateInfo createInfo = { .initialCapacity = 0 };
+    DeletionQueue queue;
+    TEST_CHECK(CreateDeletionQueue(&createInfo, &queue));
+    TEST_CHECK(queue.capacity == DEFAULT_DELETION_QUEUE_CAPACITY);
+
+    // Nothing has completed yet, so even value 0 waits for the first collection
+    const uint64_t buffer = CreateFakeVulkanHandle();
+    const uint64_t image = CreateFakeVulkanHandle();
+    const uint64_t pipeline = CreateFakeVulkanHandle();
+    const uint64_t swapchain = CreateFakeVulkanHandle();
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_BUFFER, buffer, 1));
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_IMAGE, image, 2));
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_PIPELINE, pipeline, 3));
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_SWAPCHAIN_KHR, swapchain, 3));
+    TEST_CHECK(queue.count == 4);
+    TEST_CHECK(pDevice->destroyedObjectCount == 0);
+
+    TEST_CHECK(CollectDeletionQueue(&queue, 0) == 0);
+    TEST_CHECK(CollectDeletionQueue(&queue, 2) == 2);
+    TEST_CHECK(IsDestroyed(pDevice, 0, VK_OBJECT_TYPE_BUFFER, buffer));
+    TEST_CHECK(IsDestroyed(pDevice, 1, VK_OBJECT_TYPE_IMAGE, image));
+    // A smaller value reported later does not move the completed value back
+    TEST_CHECK(CollectDeletionQueue(&queue, 1) == 0);
+    TEST_CHECK(queue.completedValue == 2);
+
+    // Retired after value 2 has completed, but behind a pending object, so it waits for the objects ahead of it
+    const uint64_t fence = CreateFakeVulkanHandle();
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_FENCE, fence, 2));
+    TEST_CHECK(queue.count == 3);
+    TEST_CHECK(CollectDeletionQueue(&queue, 3) == 3);
+    TEST_CHECK(IsDestroyed(pDevice, 2, VK_OBJECT_TYPE_PIPELINE, pipeline));
+    TEST_CHECK(IsDestroyed(pDevice, 3, VK_OBJECT_TYPE_SWAPCHAIN_KHR, swapchain));
+    TEST_CHECK(IsDestroyed(pDevice, 4, VK_OBJECT_TYPE_FENCE, fence));
+
+    // With nothing pending, a completed value is destroyed at once
+    const uint64_t sampler = CreateFakeVulkanHandle();
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_SAMPLER, sampler, 3));
+    TEST_CHECK(IsDestroyed(pDevice, 5, VK_OBJECT_TYPE_SAMPLER, sampler));
+    TEST_CHECK(queue.count == 0);
+
+    // Null handles are accepted and ignored, unsupported types are refused
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_IMAGE_VIEW, 0, 4));
+    TEST_CHECK(!RetireVulkanObject(&queue, VK_OBJECT_TYPE_DEVICE, CreateFakeVulkanHandle(), 4));
+    TEST_CHECK(queue.count == 0);
+    TEST_CHECK(queue.retiredCount == 6);
+    TEST_CHECK(queue.destroyedCount == 6);
+    TEST_CHECK(queue.maxPendingCount == 4);
+    TEST_CHECK(pDevice->destroyedObjectCount == 6);
+    DestroyDeletionQueue(&queue);
+}
+
+static void TestGrowth(void)
+{
+    FakeVulkanDevice* pDevice = ResetHostDevice();
+    const DeletionQueueCreateInfo createInfo = { .initialCapacity = 4 };
+    DeletionQueue queue;
+    TEST_CHECK(CreateDeletionQueue(&createInfo, &queue));
+
+    // Wraps the ring around before it grows, so the pending objects are unrolled in order
+    enum { OBJECT_COUNT = 23 };
+    uint64_t handles[OBJECT_COUNT];
+    uint32_t collectedCount = 0;
+    for (uint32_t i = 0; i < OBJECT_COUNT; ++i)
+    {
+        handles[i] = CreateFakeVulkanHandle();
+        TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_IMAGE_VIEW, handles[i], 1 + i));
+        if (i == 2) {
+            collectedCount += CollectDeletionQueue(&queue, 2);
+        }
+    }
+    TEST_CHECK(collectedCount == 2);
+    TEST_CHECK(queue.capacity >= OBJECT_COUNT - collectedCount);
+    TEST_CHECK(CollectDeletionQueue(&queue, OBJECT_COUNT) == OBJECT_COUNT - collectedCount);
+    TEST_CHECK(pDevice->destroyedObjectCount == OBJECT_COUNT);
+    for (uint32_t i = 0; i < OBJECT_COUNT; ++i) {
+        TEST_CHECK(IsDestroyed(pDevice, i, VK_OBJECT_TYPE_IMAGE_VIEW, handles[i]));
+    }
+    DestroyDeletionQueue(&queue);
+}
+
+static void TestDestroyAndTrackedMemory(void)
+{
+    FakeVulkanDevice* pDevice = ResetHostDevice();
+    const MemoryTrackerCreateInfo trackerInfo = { .budgetPercent = 100 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&trackerInfo, &tracker));
+    const DeletionQueueCreateInfo createInfo = { .pMemoryTracker = &tracker };
+    DeletionQueue queue;
+    TEST_CHECK(CreateDeletionQueue(&createInfo, &queue));
+
+    const DeviceMemoryRequest request = { .size = 4096, .memoryTypeBits = 0x1, .category = DEVICE_MEMORY_CATEGORY_TEXTURE };
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    TEST_CHECK(AllocateTrackedDeviceMemory(&tracker, &request, &memory, NULL) == VK_SUCCESS);
+    const uint64_t image = CreateFakeVulkanHandle();
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_IMAGE, image, 10));
+    TEST_CHECK(RetireVulkanObject(&queue, VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory, 10));
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_TEXTURE].currentBytes == 4096);
+
+    // Destroying the queue destroys what is still pending, and the tracker stops counting the memory
+    DestroyDeletionQueue(&queue);
+    TEST_CHECK(IsDestroyed(pDevice, 0, VK_OBJECT_TYPE_IMAGE, image));
+    TEST_CHECK(IsDestroyed(pDevice, 1, VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory));
+    TEST_CHECK(tracker.allocationCount == 0);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_TEXTURE].currentBytes == 0);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+int main(void)
+{
+    TestRetirementOrder();
+    TestGrowth();
+    TestDestroyAndTrackedMemory();
+    return GetTestExitCode();
+}
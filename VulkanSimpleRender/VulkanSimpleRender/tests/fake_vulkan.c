@@ -0,0 +1,124 @@
+#include "fake_vulkan.h"
+#include <string.h>
+
+static FakeVulkanDevice s_fakeDevice;
+static bool s_isFakeDeviceInitialized = false;
+
+FakeVulkanDevice* ResetFakeVulkanDevice(uint32_t memoryTypeCount, const VkMemoryPropertyFlags* pPropertyFlags, const uint32_t* pHeapIndices,
+                                        uint32_t heapCount, const VkDeviceSize* pHeapSizes)
+{
+    if (s_isFakeDeviceInitialized) {
+        DestroyPlatformMutex(&s_fakeDevice.mutex);
+    }
+    memset(&s_fakeDevice, 0, sizeof(s_fakeDevice));
+    InitializePlatformMutex(&s_fakeDevice.mutex);
+    s_isFakeDeviceInitialized = true;
+
+    s_fakeDevice.memoryProperties.memoryTypeCount = memoryTypeCount;
+    for (uint32_t i = 0; i < memoryTypeCount; ++i)
+    {
+        s_fakeDevice.memoryProperties.memoryTypes[i].propertyFlags = pPropertyFlags[i];
+        s_fakeDevice.memoryProperties.memoryTypes[i].heapIndex = pHeapIndices[i];
+    }
+    s_fakeDevice.memoryProperties.memoryHeapCount = heapCount;
+    for (uint32_t i = 0; i < heapCount; ++i)
+    {
+        s_fakeDevice.memoryProperties.memoryHeaps[i].size = pHeapSizes[i];
+        s_fakeDevice.heapBudgets[i] = pHeapSizes[i];
+    }
+    return &s_fakeDevice;
+}
+
+uint64_t CreateFakeVulkanHandle(void)
+{
+    return (uint64_t)PlatformAtomicAdd(&s_fakeDevice.nextHandle, 1);
+}
+
+static void LogDestroyedObject(VkObjectType type, uint64_t handle)
+{
+    if (handle == 0) return;
+
+    LockPlatformMutex(&s_fakeDevice.mutex);
+    if (s_fakeDevice.destroyedObjectCount < FAKE_VULKAN_MAX_DESTROYED_OBJECT_COUNT) {
+        s_fakeDevice.destroyedObjects[s_fakeDevice.destroyedObjectCount++] = (FakeDestroyedObject){ .type = type, .handle = handle };
+    }
+    UnlockPlatformMutex(&s_fakeDevice.mutex);
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties* pMemoryProperties)
+{
+    (void)physicalDevice;
+    *pMemoryProperties = s_fakeDevice.memoryProperties;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkGetPhysicalDeviceMemoryProperties2(VkPhysicalDevice physicalDevice, VkPhysicalDeviceMemoryProperties2* pMemoryProperties)
+{
+    (void)physicalDevice;
+    pMemoryProperties->memoryProperties = s_fakeDevice.memoryProperties;
+    for (VkBaseOutStructure* pNext = pMemoryProperties->pNext; pNext != NULL; pNext = pNext->pNext)
+    {
+        if (pNext->sType != VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT) continue;
+
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT* pBudget = (VkPhysicalDeviceMemoryBudgetPropertiesEXT*)pNext;
+        memcpy(pBudget->heapBudget, s_fakeDevice.heapBudgets, sizeof(pBudget->heapBudget));
+        memcpy(pBudget->heapUsage, s_fakeDevice.heapUsages, sizeof(pBudget->heapUsage));
+    }
+}
+
+VKAPI_ATTR VkResult VKAPI_CALL vkAllocateMemory(VkDevice device, const VkMemoryAllocateInfo* pAllocateInfo, const VkAllocationCallbacks* pAllocator,
+                                                VkDeviceMemory* pMemory)
+{
+    (void)device; (void)pAllocator;
+    const int64_t callIndex = PlatformAtomicAdd(&s_fakeDevice.allocateCallCount, 1);
+    const int64_t runningCount = PlatformAtomicAdd(&s_fakeDevice.runningAllocationCount, 1);
+    int64_t maxRunningCount = PlatformAtomicLoad(&s_fakeDevice.maxRunningAllocationCount);
+    while (runningCount > maxRunningCount && !PlatformAtomicCompareExchange(&s_fakeDevice.maxRunningAllocationCount, maxRunningCount, runningCount)) {
+        maxRunningCount = PlatformAtomicLoad(&s_fakeDevice.maxRunningAllocationCount);
+    }
+    const uint64_t beginTime = GetCurrentTimeNanoseconds();
+    while (GetCurrentTimeNanoseconds() - beginTime < s_fakeDevice.allocationDelayNanoseconds) {
+        YieldPlatformThread();
+    }
+    PlatformAtomicAdd(&s_fakeDevice.runningAllocationCount, -1);
+
+    const uint32_t period = s_fakeDevice.failingAllocationPeriod;
+    if ((s_fakeDevice.failingMemoryTypeBits & (1U << pAllocateInfo->memoryTypeIndex)) != 0 && (period == 0 || callIndex % period == 0)) {
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+    PlatformAtomicAdd(&s_fakeDevice.liveMemoryCount, 1);
+    *pMemory = (VkDeviceMemory)CreateFakeVulkanHandle();
+    return VK_SUCCESS;
+}
+
+VKAPI_ATTR void VKAPI_CALL vkFreeMemory(VkDevice device, VkDeviceMemory memory, const VkAllocationCallbacks* pAllocator)
+{
+    (void)device; (void)pAllocator;
+    if (memory == VK_NULL_HANDLE) return;
+    PlatformAtomicAdd(&s_fakeDevice.liveMemoryCount, -1);
+    LogDestroyedObject(VK_OBJECT_TYPE_DEVICE_MEMORY, (uint64_t)memory);
+}
+
+// Only logs the destruction. Non-dispatchable handles are pointers on 64-bit platforms and uint64_t otherwise.
+#define FAKE_VULKAN_DESTROY_FUNCTION(function, handleType, objectType) \
+    VKAPI_ATTR void VKAPI_CALL function(VkDevice device, handleType object, const VkAllocationCallbacks* pAllocator) \
+    { \
+        (void)device; (void)pAllocator; \
+        LogDestroyedObject(objectType, (uint64_t)object); \
+    }
+
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyBuffer, VkBuffer, VK_OBJECT_TYPE_BUFFER)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyBufferView, VkBufferView, VK_OBJECT_TYPE_BUFFER_VIEW)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyImage, VkImage, VK_OBJECT_TYPE_IMAGE)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyImageView, VkImageView, VK_OBJECT_TYPE_IMAGE_VIEW)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroySampler, VkSampler, VK_OBJECT_TYPE_SAMPLER)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyFramebuffer, VkFramebuffer, VK_OBJECT_TYPE_FRAMEBUFFER)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyRenderPass, VkRenderPass, VK_OBJECT_TYPE_RENDER_PASS)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyPipeline, VkPipeline, VK_OBJECT_TYPE_PIPELINE)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyPipelineLayout, VkPipelineLayout, VK_OBJECT_TYPE_PIPELINE_LAYOUT)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyDescriptorPool, VkDescriptorPool, VK_OBJECT_TYPE_DESCRIPTOR_POOL)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyDescriptorSetLayout, VkDescriptorSetLayout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyCommandPool, VkCommandPool, VK_OBJECT_TYPE_COMMAND_POOL)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroySemaphore, VkSemaphore, VK_OBJECT_TYPE_SEMAPHORE)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyFence, VkFence, VK_OBJECT_TYPE_FENCE)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroyQueryPool, VkQueryPool, VK_OBJECT_TYPE_QUERY_POOL)
+FAKE_VULKAN_DESTROY_FUNCTION(vkDestroySwapchainKHR, VkSwapchainKHR, VK_OBJECT_TYPE_SWAPCHAIN_KHR)
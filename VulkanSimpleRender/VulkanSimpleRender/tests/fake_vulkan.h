@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+
+enum FAKE_VULKAN_CONSTANTS
+{
+    FAKE_VULKAN_MAX_DESTROYED_OBJECT_COUNT = 4096
+};
+
+typedef struct FakeDestroyedObject
+{
+    VkObjectType type;
+    uint64_t handle;
+} FakeDestroyedObject;
+
+// Stands in for the driver behind the Vulkan functions the memory tracker and the deletion queue call, so they are tested
+// without a device. Memory is never backed, handles are counted up from 1, and destroyed objects are logged in order.
+// The functions are thread safe.
+typedef struct FakeVulkanDevice
+{
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    // Reported through VkPhysicalDeviceMemoryBudgetPropertiesEXT
+    VkDeviceSize heapBudgets[VK_MAX_MEMORY_HEAPS];
+    VkDeviceSize heapUsages[VK_MAX_MEMORY_HEAPS];
+    // vkAllocateMemory fails with VK_ERROR_OUT_OF_DEVICE_MEMORY in these memory types, on every `failingAllocationPeriod`-th call
+    // if that is not 0, otherwise always
+    uint32_t failingMemoryTypeBits;
+    uint32_t failingAllocationPeriod;
+    // vkAllocateMemory takes at least this long, so allocations made on several threads overlap
+    uint64_t allocationDelayNanoseconds;
+
+    volatile int64_t nextHandle;
+    volatile int64_t allocateCallCount;
+    volatile int64_t liveMemoryCount;
+    // The most vkAllocateMemory calls running at once
+    volatile int64_t runningAllocationCount;
+    volatile int64_t maxRunningAllocationCount;
+    PlatformMutex mutex;
+    FakeDestroyedObject destroyedObjects[FAKE_VULKAN_MAX_DESTROYED_OBJECT_COUNT];
+    uint32_t destroyedObjectCount;
+} FakeVulkanDevice;
+
+// Resets the fake device to `memoryTypeCount` memory types, of which type i has `pPropertyFlags[i]` and lives in heap `pHeapIndices[i]`,
+// and to `heapCount` heaps of `pHeapSizes` bytes, whose budget is their size. Returns the device for the test to adjust.
+extern FakeVulkanDevice* ResetFakeVulkanDevice(uint32_t memoryTypeCount, const VkMemoryPropertyFlags* pPropertyFlags, const uint32_t* pHeapIndices,
+                                               uint32_t heapCount, const VkDeviceSize* pHeapSizes);
+// Returns the next handle, as vkCreate* would.
+extern uint64_t CreateFakeVulkanHandle(void);
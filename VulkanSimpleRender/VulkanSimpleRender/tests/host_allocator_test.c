@@ -0,0 +1,223 @@
+#include "host_allocator.h"
+#include "test_utils.h"
+#include <string.h>
+
+enum HOST_ALLOCATOR_TEST_CONSTANTS
+{
+    TEST_ARENA_SIZE = 4096,
+    POOL_TEST_ALLOCATION_COUNT = 300,
+    HOST_STRESS_THREAD_COUNT = 4,
+    HOST_STRESS_ALLOCATION_COUNT = 2000
+};
+
+static bool IsAligned(const void* pMemory, size_t alignment)
+{
+    return ((uintptr_t)pMemory & (alignment - 1)) == 0;
+}
+
+static void TestCommandArena(void)
+{
+    const HostAllocatorCreateInfo createInfo = { .arenaSize = TEST_ARENA_SIZE };
+    HostAllocator allocator;
+    TEST_CHECK(CreateHostAllocator(&createInfo, &allocator));
+    const VkAllocationCallbacks* pCallbacks = GetHostAllocationCallbacks(&allocator);
+
+    // Bumped from the arena with any alignment, and rewound once the last one is freed
+    uint8_t* pFirst = pCallbacks->pfnAllocation(pCallbacks->pUserData, 100, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    uint8_t* pSecond = pCallbacks->pfnAllocation(pCallbacks->pUserData, 200, 256, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    TEST_CHECK(pFirst != NULL && pSecond != NULL);
+    TEST_CHECK(IsAligned(pFirst, HOST_ALLOCATION_HEADER_SIZE));
+    TEST_CHECK(IsAligned(pSecond, 256));
+    TEST_CHECK(pFirst >= allocator.pArena && pFirst + 100 <= pSecond);
+    TEST_CHECK(pSecond + 200 <= allocator.pArena + TEST_ARENA_SIZE);
+    memset(pFirst, 0xAB, 100);
+    memset(pSecond, 0xCD, 200);
+
+    // Too large for the arena
+    void* pLarge = pCallbacks->pfnAllocation(pCallbacks->pUserData, TEST_ARENA_SIZE, 16, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    TEST_CHECK(pLarge != NULL);
+    pCallbacks->pfnFree(pCallbacks->pUserData, pLarge);
+
+    pCallbacks->pfnFree(pCallbacks->pUserData, pSecond);
+    pCallbacks->pfnFree(pCallbacks->pUserData, pFirst);
+    void* pAgain = pCallbacks->pfnAllocation(pCallbacks->pUserData, 100, 8, VK_SYSTEM_ALLOCATION_SCOPE_COMMAND);
+    TEST_CHECK(pAgain == pFirst);
+    pCallbacks->pfnFree(pCallbacks->pUserData, pAgain);
+
+    HostAllocationStatistics statistics;
+    GetHostAllocationStatistics(&allocator, &statistics);
+    TEST_CHECK(statistics.arenaAllocationCount == 3);
+    TEST_CHECK(statistics.arenaOverflowCount == 1);
+    TEST_CHECK(statistics.arenaResetCount == 2);
+    TEST_CHECK(statistics.heapAllocationCount == 1);
+    const HostAllocationScopeStatistics* pScope = &statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_COMMAND];
+    TEST_CHECK(pScope->allocationCount == 4);
+    TEST_CHECK(pScope->freeCount == 4);
+    TEST_CHECK(pScope->currentBytes == 0);
+    TEST_CHECK(pScope->peakBytes == 300 + TEST_ARENA_SIZE);
+    TEST_CHECK(pScope->totalBytes == 400 + TEST_ARENA_SIZE);
+    DestroyHostAllocator(&allocator);
+}
+
+static void TestObjectPools(void)
+{
+    const HostAllocatorCreateInfo createInfo = { .arenaSize = 0 };
+    HostAllocator allocator;
+    TEST_CHECK(CreateHostAllocator(&createInfo, &allocator));
+    TEST_CHECK(allocator.info.arenaSize == DEFAULT_HOST_ARENA_SIZE);
+    const VkAllocationCallbacks* pCallbacks = GetHostAllocationCallbacks(&allocator);
+
+    // Small object allocations of several size classes, none of which overlap
+    uint8_t* pAllocations[POOL_TEST_ALLOCATION_COUNT];
+    size_t sizes[POOL_TEST_ALLOCATION_COUNT];
+    size_t alignments[POOL_TEST_ALLOCATION_COUNT];
+    uint32_t randomState = 12345;
+    for (uint32_t i = 0; i < POOL_TEST_ALLOCATION_COUNT; ++i)
+    {
+        sizes[i] = 1 + NextTestRandom(&randomState) % 2000;
+        alignments[i] = (size_t)1 << (NextTestRandom(&randomState) % 7);
+        pAllocations[i] = pCallbacks->pfnAllocation(pCallbacks->pUserData, sizes[i], alignments[i], VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+        TEST_CHECK(pAllocations[i] != NULL && IsAligned(pAllocations[i], alignments[i]));
+        memset(pAllocations[i], (int)(i & 0xFF), sizes[i]);
+    }
+    for (uint32_t i = 0; i < POOL_TEST_ALLOCATION_COUNT; ++i)
+    {
+        bool isIntact = true;
+        for (size_t k = 0; k < sizes[i]; ++k) {
+            isIntact = isIntact && pAllocations[i][k] == (uint8_t)(i & 0xFF);
+        }
+        TEST_CHECK(isIntact);
+    }
+
+    // A freed block is the next one handed out of its class
+    uint8_t* pFreed = pAllocations[7];
+    pCallbacks->pfnFree(pCallbacks->pUserData, pFreed);
+    pAllocations[7] = pCallbacks->pfnAllocation(pCallbacks->pUserData, sizes[7], alignments[7], VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    TEST_CHECK(pAllocations[7] == pFreed);
+
+    // Larger than the largest block
+    void* pLarge = pCallbacks->pfnAllocation(pCallbacks->pUserData, HOST_POOL_MAX_BLOCK_SIZE, 16, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    TEST_CHECK(pLarge != NULL);
+    pCallbacks->pfnFree(pCallbacks->pUserData, pLarge);
+    for (uint32_t i = 0; i < POOL_TEST_ALLOCATION_COUNT; ++i) {
+        pCallbacks->pfnFree(pCallbacks->pUserData, pAllocations[i]);
+    }
+    pCallbacks->pfnFree(pCallbacks->pUserData, NULL);
+
+    HostAllocationStatistics statistics;
+    GetHostAllocationStatistics(&allocator, &statistics);
+    TEST_CHECK(statistics.poolAllocationCount == POOL_TEST_ALLOCATION_COUNT + 1);
+    TEST_CHECK(statistics.heapAllocationCount == 1);
+    TEST_CHECK(statistics.poolSlabCount > 0);
+    uint64_t classAllocationCount = 0;
+    for (uint32_t i = 0; i < HOST_POOL_SIZE_CLASS_COUNT; ++i) {
+        classAllocationCount += statistics.poolAllocationCounts[i];
+    }
+    TEST_CHECK(classAllocationCount == statistics.poolAllocationCount);
+    TEST_CHECK(statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_OBJECT].currentBytes == 0);
+    TEST_CHECK(statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_OBJECT].freeCount == POOL_TEST_ALLOCATION_COUNT + 2);
+    DestroyHostAllocator(&allocator);
+}
+
+static void TestReallocation(void)
+{
+    const HostAllocatorCreateInfo createInfo = { .arenaSize = 0 };
+    HostAllocator allocator;
+    TEST_CHECK(CreateHostAllocator(&createInfo, &allocator));
+    const VkAllocationCallbacks* pCallbacks = GetHostAllocationCallbacks(&allocator);
+
+    // Grows out of the pools into the heap and moves to the scope of the reallocation, keeping the contents
+    uint8_t* pMemory = pCallbacks->pfnReallocation(pCallbacks->pUserData, NULL, 40, 8, VK_SYSTEM_ALLOCATION_SCOPE_OBJECT);
+    TEST_CHECK(pMemory != NULL);
+    for (uint32_t i = 0; i < 40; ++i) {
+        pMemory[i] = (uint8_t)i;
+    }
+    pMemory = pCallbacks->pfnReallocation(pCallbacks->pUserData, pMemory, 10000, 64, VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+    TEST_CHECK(pMemory != NULL && IsAligned(pMemory, 64));
+    bool isIntact = true;
+    for (uint32_t i = 0; i < 40; ++i) {
+        isIntact = isIntact && pMemory[i] == (uint8_t)i;
+    }
+    TEST_CHECK(isIntact);
+    pMemory = pCallbacks->pfnReallocation(pCallbacks->pUserData, pMemory, 20, 8, VK_SYSTEM_ALLOCATION_SCOPE_CACHE);
+    TEST_CHECK(pMemory != NULL && pMemory[19] == 19);
+    TEST_CHECK(pCallbacks->pfnReallocation(pCallbacks->pUserData, pMemory, 0, 8, VK_SYSTEM_ALLOCATION_SCOPE_CACHE) == NULL);
+
+    // Only counted
+    pCallbacks->pfnInternalAllocation(pCallbacks->pUserData, 500, VK_INTERNAL_ALLOCATION_TYPE_EXECUTABLE, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+    pCallbacks->pfnInternalFree(pCallbacks->pUserData, 500, VK_INTERNAL_ALLOCATION_TYPE_EXECUTABLE, VK_SYSTEM_ALLOCATION_SCOPE_DEVICE);
+
+    HostAllocationStatistics statistics;
+    GetHostAllocationStatistics(&allocator, &statistics);
+    const HostAllocationScopeStatistics* pObject = &statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_OBJECT];
+    const HostAllocationScopeStatistics* pCache = &statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_CACHE];
+    const HostAllocationScopeStatistics* pDevice = &statistics.scopes[VK_SYSTEM_ALLOCATION_SCOPE_DEVICE];
+    TEST_CHECK(pObject->allocationCount == 1 && pObject->currentBytes == 0);
+    TEST_CHECK(pCache->reallocationCount == 2);
+    TEST_CHECK(pCache->freeCount == 1);
+    TEST_CHECK(pCache->currentBytes == 0);
+    TEST_CHECK(pCache->peakBytes == 10000);
+    TEST_CHECK(pDevice->internalAllocationCount == 1);
+    TEST_CHECK(pDevice->currentInternalBytes == 0);
+    TEST_CHECK(pDevice->peakInternalBytes == 500);
+    TEST_CHECK(strcmp(GetSystemAllocationScopeName(VK_SYSTEM_ALLOCATION_SCOPE_COMMAND), "command") == 0);
+    DestroyHostAllocator(&allocator);
+}
+
+// The driver may call back from any thread
+static void StressHostAllocator(void* pArgument)
+{
+    const VkAllocationCallbacks* pCallbacks = pArgument;
+    void* pAllocations[16] = { NULL };
+    uint32_t randomState = (uint32_t)(uintptr_t)&pAllocations | 1U;
+    for (uint32_t i = 0; i < HOST_STRESS_ALLOCATION_COUNT; ++i)
+    {
+        const uint32_t slot = NextTestRandom(&randomState) % 16;
+        pCallbacks->pfnFree(pCallbacks->pUserData, pAllocations[slot]);
+        const VkSystemAllocationScope scope = (VkSystemAllocationScope)(NextTestRandom(&randomState) % HOST_ALLOCATION_SCOPE_COUNT);
+        pAllocations[slot] = pCallbacks->pfnAllocation(pCallbacks->pUserData, 1 + NextTestRandom(&randomState) % 3000, 16, scope);
+        memset(pAllocations[slot], 0x5A, 1);
+    }
+    for (uint32_t i = 0; i < 16; ++i) {
+        pCallbacks->pfnFree(pCallbacks->pUserData, pAllocations[i]);
+    }
+}
+
+static void TestThreads(void)
+{
+    const HostAllocatorCreateInfo createInfo = { .arenaSize = 0 };
+    HostAllocator allocator;
+    TEST_CHECK(CreateHostAllocator(&createInfo, &allocator));
+
+    PlatformThread threads[HOST_STRESS_THREAD_COUNT];
+    for (uint32_t i = 0; i < HOST_STRESS_THREAD_COUNT; ++i) {
+        TEST_CHECK(CreatePlatformThread(&threads[i], StressHostAllocator, (void*)GetHostAllocationCallbacks(&allocator)));
+    }
+    for (uint32_t i = 0; i < HOST_STRESS_THREAD_COUNT; ++i) {
+        JoinPlatformThread(threads[i]);
+    }
+
+    HostAllocationStatistics statistics;
+    GetHostAllocationStatistics(&allocator, &statistics);
+    uint64_t allocationCount = 0;
+    uint64_t freeCount = 0;
+    for (uint32_t i = 0; i < HOST_ALLOCATION_SCOPE_COUNT; ++i)
+    {
+        TEST_CHECK(statistics.scopes[i].currentBytes == 0);
+        allocationCount += statistics.scopes[i].allocationCount;
+        freeCount += statistics.scopes[i].freeCount;
+    }
+    TEST_CHECK(allocationCount == HOST_STRESS_THREAD_COUNT * HOST_STRESS_ALLOCATION_COUNT);
+    TEST_CHECK(freeCount == allocationCount);
+    TEST_CHECK(allocator.liveArenaAllocationCount == 0);
+    DestroyHostAllocator(&allocator);
+}
+
+int main(void)
+{
+    TestCommandArena();
+    TestObjectPools();
+    TestReallocation();
+    TestThreads();
+    return GetTestExitCode();
+}
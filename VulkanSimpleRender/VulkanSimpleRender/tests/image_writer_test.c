@@ -0,0 +1,245 @@
+#include "image_writer.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum IMAGE_WRITER_TEST_CONSTANTS
+{
+    // Wide enough for the PNG rows to span several stored deflate blocks
+    TEST_IMAGE_WIDTH = 150,
+    TEST_IMAGE_HEIGHT = 120,
+    // Rows are padded, as in a readback buffer
+    TEST_ROW_PITCH = TEST_IMAGE_WIDTH * 4 + 24,
+    MAX_TEST_FILE_SIZE = 1024 * 1024
+};
+
+static const char* const s_testFilePath = "image_writer_test.out";
+
+// Gradients, runs of one color and noise, so every QOI op is used
+static void FillTestImage(uint8_t* pPixels)
+{
+    uint32_t randomState = 0xC0FFEEU;
+    memset(pPixels, 0xEE, (size_t)TEST_ROW_PITCH * TEST_IMAGE_HEIGHT);
+    for (uint32_t y = 0; y < TEST_IMAGE_HEIGHT; ++y)
+    {
+        for (uint32_t x = 0; x < TEST_IMAGE_WIDTH; ++x)
+        {
+            uint8_t* pixel = pPixels + (size_t)y * TEST_ROW_PITCH + x * 4;
+            if (y < 40)
+            {
+                pixel[0] = (uint8_t)x;
+                pixel[1] = (uint8_t)(y * 3);
+                pixel[2] = (uint8_t)(x + y);
+                pixel[3] = 255;
+            }
+            else if (y < 80)
+            {
+                const uint8_t value = x < 100 ? 40 : 200;
+                pixel[0] = value;
+                pixel[1] = value;
+                pixel[2] = (uint8_t)(x / 8);
+                pixel[3] = 255;
+            }
+            else
+            {
+                const uint32_t noise = NextTestRandom(&randomState);
+                memcpy(pixel, &noise, 4);
+                pixel[3] = (uint8_t)(x % 3 == 0 ? pixel[3] : 255);
+            }
+        }
+    }
+}
+
+static size_t ReadTestFile(uint8_t* pData)
+{
+    FILE* pFile = NULL;
+#ifdef _WIN32
+    if (fopen_s(&pFile, s_testFilePath, "rb") != 0) pFile = NULL;
+#else
+    pFile = fopen(s_testFilePath, "rb");
+#endif // _WIN32
+    if (pFile == NULL) return 0;
+    const size_t size = fread(pData, 1, MAX_TEST_FILE_SIZE, pFile);
+    fclose(pFile);
+    return size;
+}
+
+static uint32_t LoadBigEndian32(const uint8_t* pSrc)
+{
+    return ((uint32_t)pSrc[0] << 24) | ((uint32_t)pSrc[1] << 16) | ((uint32_t)pSrc[2] << 8) | pSrc[3];
+}
+
+static bool IsPixelEqual(const uint8_t* pPixels, uint32_t pixelIndex, const uint8_t* pDecoded, uint32_t channelCount)
+{
+    const uint8_t* pixel = pPixels + (size_t)(pixelIndex / TEST_IMAGE_WIDTH) * TEST_ROW_PITCH + (pixelIndex % TEST_IMAGE_WIDTH) * 4;
+    return memcmp(pixel, pDecoded, channelCount) == 0;
+}
+
+static void TestPpm(const uint8_t* pPixels, uint8_t* pFile)
+{
+    TEST_CHECK(WriteImageFile(s_testFilePath, IMAGE_FILE_FORMAT_PPM, pPixels, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, TEST_ROW_PITCH));
+    const size_t size = ReadTestFile(pFile);
+    static const char header[] = "P6\n150 120\n255\n";
+    const size_t headerSize = sizeof(header) - 1;
+    TEST_CHECK(size == headerSize + TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 3);
+    TEST_CHECK(memcmp(pFile, header, headerSize) == 0);
+    bool isSame = size == headerSize + TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 3;
+    for (uint32_t i = 0; i < TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT && isSame; ++i) {
+        isSame = IsPixelEqual(pPixels, i, pFile + headerSize + i * 3, 3);
+    }
+    TEST_CHECK(isSame);
+}
+
+// Decodes the stored deflate blocks of the single IDAT chunk the writer produces
+static void TestPng(const uint8_t* pPixels, uint8_t* pFile)
+{
+    TEST_CHECK(WriteImageFile(s_testFilePath, IMAGE_FILE_FORMAT_PNG, pPixels, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, TEST_ROW_PITCH));
+    const size_t size = ReadTestFile(pFile);
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    TEST_CHECK(size > 8 + 25 + 12 + 12 && memcmp(pFile, signature, sizeof(signature)) == 0);
+
+    const uint8_t* pIhdr = pFile + 8;
+    TEST_CHECK(LoadBigEndian32(pIhdr) == 13 && memcmp(pIhdr + 4, "IHDR", 4) == 0);
+    TEST_CHECK(LoadBigEndian32(pIhdr + 8) == TEST_IMAGE_WIDTH && LoadBigEndian32(pIhdr + 12) == TEST_IMAGE_HEIGHT);
+    // 8 bits per channel, RGBA
+    TEST_CHECK(pIhdr[16] == 8 && pIhdr[17] == 6);
+
+    const uint8_t* pIdat = pIhdr + 25;
+    const uint32_t idatSize = LoadBigEndian32(pIdat);
+    TEST_CHECK(memcmp(pIdat + 4, "IDAT", 4) == 0);
+    TEST_CHECK(8 + 25 + 12 + (size_t)idatSize + 12 == size);
+    TEST_CHECK(memcmp(pIdat + 12 + idatSize + 4, "IEND", 4) == 0);
+
+    const size_t rawSize = (TEST_IMAGE_WIDTH * 4 + 1) * TEST_IMAGE_HEIGHT;
+    uint8_t* pRaw = malloc(rawSize);
+    const uint8_t* pSrc = pIdat + 8;
+    const uint8_t* pEnd = pSrc + idatSize;
+    TEST_CHECK(((pSrc[0] << 8) | pSrc[1]) % 31 == 0);
+    pSrc += 2;
+    size_t rawOffset = 0;
+    uint32_t blockCount = 0;
+    bool isFinal = false;
+    while (!isFinal && pSrc + 5 <= pEnd)
+    {
+        isFinal = (pSrc[0] & 1) != 0;
+        const uint32_t length = pSrc[1] | (pSrc[2] << 8);
+        const uint32_t notLength = pSrc[3] | (pSrc[4] << 8);
+        TEST_CHECK((pSrc[0] & 6) == 0 && (length ^ notLength) == 0xFFFF);
+        pSrc += 5;
+        if (rawOffset + length > rawSize || pSrc + length > pEnd) break;
+        memcpy(pRaw + rawOffset, pSrc, length);
+        rawOffset += length;
+        pSrc += length;
+        ++blockCount;
+    }
+    TEST_CHECK(isFinal && blockCount > 1 && rawOffset == rawSize);
+
+    uint32_t adlerA = 1;
+    uint32_t adlerB = 0;
+    for (size_t i = 0; i < rawOffset; ++i)
+    {
+        adlerA = (adlerA + pRaw[i]) % 65521U;
+        adlerB = (adlerB + adlerA) % 65521U;
+    }
+    TEST_CHECK(pSrc + 4 == pEnd && LoadBigEndian32(pSrc) == ((adlerB << 16) | adlerA));
+
+    bool isSame = rawOffset == rawSize;
+    for (uint32_t y = 0; y < TEST_IMAGE_HEIGHT && isSame; ++y)
+    {
+        const uint8_t* pRow = pRaw + (size_t)y * (TEST_IMAGE_WIDTH * 4 + 1);
+        isSame = pRow[0] == 0 && memcmp(pRow + 1, pPixels + (size_t)y * TEST_ROW_PITCH, TEST_IMAGE_WIDTH * 4) == 0;
+    }
+    TEST_CHECK(isSame);
+    free(pRaw);
+}
+
+static void TestQoi(const uint8_t* pPixels, uint8_t* pFile)
+{
+    TEST_CHECK(WriteImageFile(s_testFilePath, IMAGE_FILE_FORMAT_QOI, pPixels, TEST_IMAGE_WIDTH, TEST_IMAGE_HEIGHT, TEST_ROW_PITCH));
+    const size_t size = ReadTestFile(pFile);
+    TEST_CHECK(size > 14 + 8 && memcmp(pFile, "qoif", 4) == 0);
+    TEST_CHECK(LoadBigEndian32(pFile + 4) == TEST_IMAGE_WIDTH && LoadBigEndian32(pFile + 8) == TEST_IMAGE_HEIGHT);
+    TEST_CHECK(pFile[12] == 4);
+    static const uint8_t endMarker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    TEST_CHECK(memcmp(pFile + size - 8, endMarker, 8) == 0);
+
+    // The decoder of the QOI specification
+    uint8_t index[64][4];
+    memset(index, 0, sizeof(index));
+    uint8_t pixel[4] = { 0, 0, 0, 255 };
+    const uint8_t* pSrc = pFile + 14;
+    const uint8_t* pEnd = pFile + size - 8;
+    uint32_t run = 0;
+    uint32_t pixelIndex = 0;
+    bool isSame = true;
+    for (; pixelIndex < TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT && isSame; ++pixelIndex)
+    {
+        if (run > 0) {
+            --run;
+        }
+        else if (pSrc < pEnd)
+        {
+            const uint8_t op = *pSrc++;
+            if (op == 0xFE)
+            {
+                memcpy(pixel, pSrc, 3);
+                pSrc += 3;
+            }
+            else if (op == 0xFF)
+            {
+                memcpy(pixel, pSrc, 4);
+                pSrc += 4;
+            }
+            else if ((op & 0xC0) == 0x00) {
+                memcpy(pixel, index[op], 4);
+            }
+            else if ((op & 0xC0) == 0x40)
+            {
+                pixel[0] = (uint8_t)(pixel[0] + ((op >> 4) & 3) - 2);
+                pixel[1] = (uint8_t)(pixel[1] + ((op >> 2) & 3) - 2);
+                pixel[2] = (uint8_t)(pixel[2] + (op & 3) - 2);
+            }
+            else if ((op & 0xC0) == 0x80)
+            {
+                const int dg = (op & 0x3F) - 32;
+                const uint8_t next = *pSrc++;
+                pixel[0] = (uint8_t)(pixel[0] + dg - 8 + ((next >> 4) & 0xF));
+                pixel[1] = (uint8_t)(pixel[1] + dg);
+                pixel[2] = (uint8_t)(pixel[2] + dg - 8 + (next & 0xF));
+            }
+            else {
+                run = op & 0x3F;
+            }
+            memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+        }
+        isSame = IsPixelEqual(pPixels, pixelIndex, pixel, 4);
+    }
+    TEST_CHECK(isSame);
+    TEST_CHECK(pSrc == pEnd && run == 0);
+    // Far smaller than the pixels, since most of the image is gradients and runs
+    TEST_CHECK(size < TEST_IMAGE_WIDTH * TEST_IMAGE_HEIGHT * 3);
+}
+
+int main(void)
+{
+    for (uint32_t i = 0; i < IMAGE_FILE_FORMAT_COUNT; ++i)
+    {
+        ImageFileFormat format;
+        TEST_CHECK(ParseImageFileFormat(GetImageFileFormatName((ImageFileFormat)i), &format) && format == (ImageFileFormat)i);
+    }
+    ImageFileFormat format;
+    TEST_CHECK(!ParseImageFileFormat("bmp", &format));
+
+    uint8_t* pPixels = malloc((size_t)TEST_ROW_PITCH * TEST_IMAGE_HEIGHT);
+    uint8_t* pFile = malloc(MAX_TEST_FILE_SIZE);
+    FillTestImage(pPixels);
+    TestPpm(pPixels, pFile);
+    TestPng(pPixels, pFile);
+    TestQoi(pPixels, pFile);
+    // PNG cannot store an empty image
+    TEST_CHECK(!WriteImageFile(s_testFilePath, IMAGE_FILE_FORMAT_PNG, pPixels, 0, 0, 0));
+    remove(s_testFilePath);
+    free(pFile);
+    free(pPixels);
+    return GetTestExitCode();
+}
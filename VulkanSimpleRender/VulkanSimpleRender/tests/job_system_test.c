@@ -0,0 +1,139 @@
+#include "job_system.h"
+#include "test_utils.h"
+#include <string.h>
+
+enum JOB_SYSTEM_TEST_CONSTANTS
+{
+    TEST_WORKER_COUNT = 8,
+    PARALLEL_FOR_ELEMENT_COUNT = 10000,
+    // More than a deque holds, so some submissions run immediately
+    CHILD_JOB_COUNT = JOB_DEQUE_CAPACITY + 100,
+    NESTED_JOB_COUNT = 64
+};
+
+typedef struct ParallelForTest
+{
+    volatile int64_t visitCounts[PARALLEL_FOR_ELEMENT_COUNT];
+    volatile int64_t sum;
+    volatile int64_t maxBatchCount;
+    uint32_t batchSize;
+} ParallelForTest;
+
+static void VisitRange(void* pUserData, uint32_t first, uint32_t count, uint32_t workerIndex)
+{
+    ParallelForTest* pTest = pUserData;
+    (void)workerIndex;
+    if (count > (uint32_t)PlatformAtomicLoad(&pTest->maxBatchCount)) {
+        PlatformAtomicStore(&pTest->maxBatchCount, count);
+    }
+    for (uint32_t i = first; i < first + count; ++i)
+    {
+        PlatformAtomicAdd(&pTest->visitCounts[i], 1);
+        PlatformAtomicAdd(&pTest->sum, i);
+    }
+}
+
+static void TestParallelFor(uint32_t workerCount)
+{
+    static ParallelForTest test;
+    JobSystem system;
+    TEST_CHECK(CreateJobSystem(workerCount, &system));
+    const uint32_t batchSizes[4] = { 1, 7, 256, PARALLEL_FOR_ELEMENT_COUNT * 2 };
+    for (uint32_t b = 0; b < 4; ++b)
+    {
+        memset((void*)&test, 0, sizeof(test));
+        RunParallelFor(&system, 0, PARALLEL_FOR_ELEMENT_COUNT, batchSizes[b], VisitRange, &test);
+        bool isVisitedOnce = true;
+        for (uint32_t i = 0; i < PARALLEL_FOR_ELEMENT_COUNT; ++i) {
+            isVisitedOnce = isVisitedOnce && test.visitCounts[i] == 1;
+        }
+        TEST_CHECK(isVisitedOnce);
+        TEST_CHECK(test.sum == (int64_t)PARALLEL_FOR_ELEMENT_COUNT * (PARALLEL_FOR_ELEMENT_COUNT - 1) / 2);
+        TEST_CHECK(test.maxBatchCount <= (int64_t)batchSizes[b]);
+    }
+
+    // Nothing to do
+    memset((void*)&test, 0, sizeof(test));
+    RunParallelFor(&system, 0, 0, 16, VisitRange, &test);
+    TEST_CHECK(test.sum == 0);
+    DestroyJobSystem(&system);
+}
+
+typedef struct NestedJobTest
+{
+    JobSystem* pSystem;
+    volatile int64_t childCount;
+    volatile int64_t parentCount;
+} NestedJobTest;
+
+static void RunChildJob(void* pUserData, uint32_t workerIndex)
+{
+    NestedJobTest* pTest = pUserData;
+    (void)workerIndex;
+    PlatformAtomicAdd(&pTest->childCount, 1);
+}
+
+// Waits inside a job for jobs it has submitted, which the worker runs meanwhile instead of blocking
+static void RunParentJob(void* pUserData, uint32_t workerIndex)
+{
+    NestedJobTest* pTest = pUserData;
+    JobCounter counter = { 0 };
+    for (uint32_t i = 0; i < NESTED_JOB_COUNT; ++i) {
+        SubmitJob(pTest->pSystem, workerIndex, RunChildJob, pTest, &counter);
+    }
+    WaitForJobCounter(pTest->pSystem, workerIndex, &counter);
+    TEST_CHECK(counter.value == 0);
+    PlatformAtomicAdd(&pTest->parentCount, 1);
+}
+
+static void TestNestedJobs(void)
+{
+    JobSystem system;
+    TEST_CHECK(CreateJobSystem(TEST_WORKER_COUNT, &system));
+    NestedJobTest test = { .pSystem = &system };
+
+    JobCounter counter = { 0 };
+    for (uint32_t i = 0; i < NESTED_JOB_COUNT; ++i) {
+        SubmitJob(&system, 0, RunParentJob, &test, &counter);
+    }
+    WaitForJobCounter(&system, 0, &counter);
+    TEST_CHECK(test.parentCount == NESTED_JOB_COUNT);
+    TEST_CHECK(test.childCount == NESTED_JOB_COUNT * NESTED_JOB_COUNT);
+
+    // A full deque runs the submitted job right away
+    test.childCount = 0;
+    for (uint32_t i = 0; i < CHILD_JOB_COUNT; ++i) {
+        SubmitJob(&system, 0, RunChildJob, &test, &counter);
+    }
+    WaitForJobCounter(&system, 0, &counter);
+    TEST_CHECK(test.childCount == CHILD_JOB_COUNT);
+
+    uint64_t executedJobCount = 0;
+    uint64_t stolenJobCount = 0;
+    GetJobSystemStatistics(&system, &executedJobCount, &stolenJobCount);
+    TEST_CHECK(executedJobCount >= NESTED_JOB_COUNT * (NESTED_JOB_COUNT + 1));
+    TEST_CHECK(stolenJobCount <= executedJobCount);
+    DestroyJobSystem(&system);
+}
+
+static void TestWorkerCounts(void)
+{
+    // Clamped to [1, MAX_JOB_WORKER_COUNT], and created and destroyed repeatedly without leaking threads
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        JobSystem system;
+        TEST_CHECK(CreateJobSystem(i == 0 ? 0 : MAX_JOB_WORKER_COUNT + 1, &system));
+        TEST_CHECK(system.workerCount == (i == 0 ? 1 : MAX_JOB_WORKER_COUNT));
+        TEST_CHECK(system.threadCount == system.workerCount - 1);
+        DestroyJobSystem(&system);
+    }
+}
+
+int main(void)
+{
+    TestParallelFor(1);
+    TestParallelFor(TEST_WORKER_COUNT);
+    TestNestedJobs();
+    TestWorkerCounts();
+    return GetTestExitCode();
+}
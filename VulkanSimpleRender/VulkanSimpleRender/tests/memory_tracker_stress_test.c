@@ -0,0 +1,105 @@
+#include "memory_tracker.h"
+#include "fake_vulkan.h"
+#include "test_utils.h"
+
+// Allocates and frees on several threads at once while vkAllocateMemory is slow and sometimes fails, which overlaps the
+// allocations running without the mutex with the reservations, fallbacks and frees of the other threads. Also built with
+// ThreadSanitizer where the compiler supports it.
+enum MEMORY_TRACKER_STRESS_CONSTANTS
+{
+    STRESS_THREAD_COUNT = 8,
+    STRESS_ROUND_COUNT = 20,
+    STRESS_ALLOCATIONS_PER_ROUND = 50,
+    STRESS_ALLOCATION_DELAY_NANOSECONDS = 200000
+};
+
+typedef struct StressThread
+{
+    DeviceMemoryTracker* pTracker;
+    uint32_t successCount;
+    uint32_t failureCount;
+} StressThread;
+
+static void StressTrackedDeviceMemory(void* pArgument)
+{
+    StressThread* pThread = pArgument;
+    VkDeviceMemory memories[STRESS_ALLOCATIONS_PER_ROUND];
+    for (uint32_t round = 0; round < STRESS_ROUND_COUNT; ++round)
+    {
+        for (uint32_t i = 0; i < STRESS_ALLOCATIONS_PER_ROUND; ++i)
+        {
+            const DeviceMemoryRequest request = {
+                .size = 4096 * (1 + i % 7),
+                .memoryTypeBits = 0x3,
+                .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                .category = (DeviceMemoryCategory)(i % 3)
+            };
+            memories[i] = VK_NULL_HANDLE;
+            if (AllocateTrackedDeviceMemory(pThread->pTracker, &request, &memories[i], NULL) == VK_SUCCESS) {
+                ++pThread->successCount;
+            }
+            else {
+                ++pThread->failureCount;
+            }
+        }
+        for (uint32_t i = 0; i < STRESS_ALLOCATIONS_PER_ROUND; ++i) {
+            FreeTrackedDeviceMemory(pThread->pTracker, memories[i]);
+        }
+    }
+}
+
+int main(void)
+{
+    // A small device local heap, so the threads keep falling back to the host heap and going over the budget
+    const VkMemoryPropertyFlags propertyFlags[2] = { VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT };
+    const uint32_t heapIndices[2] = { 0, 1 };
+    const VkDeviceSize heapSizes[2] = { 1024 * 1024, 1024 * 1024 * 1024 };
+    FakeVulkanDevice* pDevice = ResetFakeVulkanDevice(2, propertyFlags, heapIndices, 2, heapSizes);
+    pDevice->failingMemoryTypeBits = 0x1;
+    pDevice->failingAllocationPeriod = 3;
+    pDevice->allocationDelayNanoseconds = STRESS_ALLOCATION_DELAY_NANOSECONDS;
+
+    const MemoryTrackerCreateInfo createInfo = { .budgetPercent = 0 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+
+    StressThread threads[STRESS_THREAD_COUNT];
+    PlatformThread threadHandles[STRESS_THREAD_COUNT];
+    for (uint32_t i = 0; i < STRESS_THREAD_COUNT; ++i)
+    {
+        threads[i] = (StressThread){ .pTracker = &tracker };
+        TEST_CHECK(CreatePlatformThread(&threadHandles[i], StressTrackedDeviceMemory, &threads[i]));
+    }
+    uint32_t successCount = 0;
+    uint32_t failureCount = 0;
+    for (uint32_t i = 0; i < STRESS_THREAD_COUNT; ++i)
+    {
+        JoinPlatformThread(threadHandles[i]);
+        successCount += threads[i].successCount;
+        failureCount += threads[i].failureCount;
+    }
+
+    // Every allocation has found a memory type, since the host heap never fails
+    TEST_CHECK(successCount == STRESS_THREAD_COUNT * STRESS_ROUND_COUNT * STRESS_ALLOCATIONS_PER_ROUND);
+    TEST_CHECK(failureCount == 0);
+    TEST_CHECK(tracker.failedCount == 0);
+    // vkAllocateMemory does not run under the mutex
+    TEST_CHECK(pDevice->maxRunningAllocationCount > 1);
+
+    TEST_CHECK(tracker.allocationCount == 0);
+    TEST_CHECK(tracker.pendingAllocationCount == 0);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 0);
+    TEST_CHECK(tracker.heaps[1].trackedBytes == 0);
+    uint32_t categoryAllocationCount = 0;
+    for (uint32_t i = 0; i < DEVICE_MEMORY_CATEGORY_COUNT; ++i)
+    {
+        TEST_CHECK(tracker.categories[i].currentBytes == 0);
+        categoryAllocationCount += tracker.categories[i].allocationCount;
+    }
+    TEST_CHECK(categoryAllocationCount == successCount);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+    printf("%u allocations, %u fallbacks, %u over the budget, at most %lld in vkAllocateMemory at once\n", successCount, tracker.fallbackCount,
+        tracker.overBudgetCount, (long long)pDevice->maxRunningAllocationCount);
+    DestroyDeviceMemoryTracker(&tracker);
+    return GetTestExitCode();
+}
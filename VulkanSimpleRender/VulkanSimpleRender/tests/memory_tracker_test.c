@@ -0,0 +1,264 @@
+#include "memory_tracker.h"
+#include "fake_vulkan.h"
+#include "test_utils.h"
+
+enum MEMORY_TRACKER_TEST_CONSTANTS
+{
+    DEVICE_HEAP_SIZE = 1024 * 1024,
+    HOST_HEAP_SIZE = 16 * 1024 * 1024,
+    KB = 1024
+};
+
+// A discrete GPU: device local memory in heap 0, host memory in heap 1, and a small device local window the host can write in heap 0
+static FakeVulkanDevice* ResetDiscreteDevice(void)
+{
+    const VkMemoryPropertyFlags propertyFlags[3] = {
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+    };
+    const uint32_t heapIndices[3] = { 0, 1, 0 };
+    const VkDeviceSize heapSizes[2] = { DEVICE_HEAP_SIZE, HOST_HEAP_SIZE };
+    return ResetFakeVulkanDevice(3, propertyFlags, heapIndices, 2, heapSizes);
+}
+
+static VkResult Allocate(DeviceMemoryTracker* pTracker, VkDeviceSize size, uint32_t memoryTypeBits, VkMemoryPropertyFlags requiredFlags,
+                         VkMemoryPropertyFlags preferredFlags, VkDeviceMemory* pMemory, uint32_t* pMemoryTypeIndex)
+{
+    const DeviceMemoryRequest request = {
+        .pNext = NULL,
+        .size = size,
+        .memoryTypeBits = memoryTypeBits,
+        .requiredFlags = requiredFlags,
+        .preferredFlags = preferredFlags,
+        .category = DEVICE_MEMORY_CATEGORY_GEOMETRY
+    };
+    *pMemory = VK_NULL_HANDLE;
+    return AllocateTrackedDeviceMemory(pTracker, &request, pMemory, pMemoryTypeIndex);
+}
+
+static void TestPlacementWithinBudget(void)
+{
+    FakeVulkanDevice* pDevice = ResetDiscreteDevice();
+    const MemoryTrackerCreateInfo createInfo = { .budgetPercent = 50 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+    const VkDeviceSize allowance = DEVICE_HEAP_SIZE / 100 * 50;
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == allowance);
+
+    // The preferred memory type while it has room
+    VkDeviceMemory memories[3];
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    TEST_CHECK(Allocate(&tracker, 400 * KB, 0x3, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memories[0], &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 0);
+    TEST_CHECK(tracker.fallbackCount == 0);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == allowance - 400 * KB);
+
+    // Then a memory type with only the required properties
+    TEST_CHECK(Allocate(&tracker, 400 * KB, 0x3, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memories[1], &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 1);
+    TEST_CHECK(tracker.fallbackCount == 1);
+    TEST_CHECK(tracker.overBudgetCount == 0);
+
+    // And over the budget once no suitable heap has room
+    TEST_CHECK(Allocate(&tracker, 400 * KB, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, &memories[2], &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 0);
+    TEST_CHECK(tracker.overBudgetCount == 1);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 0);
+
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 800 * KB);
+    TEST_CHECK(tracker.heaps[1].trackedBytes == 400 * KB);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_GEOMETRY].allocationCount == 3);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_GEOMETRY].currentBytes == 1200 * KB);
+    TEST_CHECK(tracker.allocationCount == 3);
+
+    for (uint32_t i = 0; i < 3; ++i) {
+        FreeTrackedDeviceMemory(&tracker, memories[i]);
+    }
+    FreeTrackedDeviceMemory(&tracker, VK_NULL_HANDLE);
+    TEST_CHECK(tracker.allocationCount == 0);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 0);
+    TEST_CHECK(tracker.heaps[1].trackedBytes == 0);
+    TEST_CHECK(tracker.heaps[0].peakTrackedBytes == 800 * KB);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_GEOMETRY].currentBytes == 0);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_GEOMETRY].peakBytes == 1200 * KB);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+static void TestFailedMemoryTypes(void)
+{
+    FakeVulkanDevice* pDevice = ResetDiscreteDevice();
+    pDevice->failingMemoryTypeBits = 0x1;
+    const MemoryTrackerCreateInfo createInfo = { .budgetPercent = 0 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+    TEST_CHECK(tracker.info.budgetPercent == DEFAULT_MEMORY_BUDGET_PERCENT);
+
+    // A memory type failing moves on to the next suitable one
+    VkDeviceMemory memory;
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    TEST_CHECK(Allocate(&tracker, 64 * KB, 0x3, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memory, &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 1);
+    TEST_CHECK(pDevice->allocateCallCount == 2);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 0);
+    TEST_CHECK(tracker.heaps[1].trackedBytes == 64 * KB);
+    FreeTrackedDeviceMemory(&tracker, memory);
+
+    // Failing in every suitable memory type tries each of them once and releases what was reserved
+    pDevice->allocateCallCount = 0;
+    TEST_CHECK(Allocate(&tracker, 64 * KB, 0x1, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memory, NULL) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    TEST_CHECK(pDevice->allocateCallCount == 1);
+    TEST_CHECK(tracker.failedCount == 1);
+    TEST_CHECK(tracker.pendingAllocationCount == 0);
+    TEST_CHECK(tracker.allocationCount == 0);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 0);
+
+    // No memory type has the required properties
+    pDevice->allocateCallCount = 0;
+    TEST_CHECK(Allocate(&tracker, 64 * KB, 0x2, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, &memory, NULL) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    TEST_CHECK(pDevice->allocateCallCount == 0);
+    TEST_CHECK(tracker.failedCount == 2);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+static void TestBudgets(void)
+{
+    // The limit caps the budget of every heap. The sizes are multiples of 100 bytes, so the budget percentage rounds nothing off.
+    FakeVulkanDevice* pDevice = ResetDiscreteDevice();
+    MemoryTrackerCreateInfo createInfo = { .budgetPercent = 100, .budgetLimit = 250 * KB };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+    TEST_CHECK(tracker.heaps[0].budget == 250 * KB);
+    TEST_CHECK(tracker.heaps[1].budget == 250 * KB);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x7, 0) == 250 * KB);
+    DestroyDeviceMemoryTracker(&tracker);
+
+    // With VK_EXT_memory_budget, what the other processes use counts against the budget
+    pDevice = ResetDiscreteDevice();
+    pDevice->heapBudgets[0] = 800 * KB;
+    pDevice->heapUsages[0] = 300 * KB;
+    createInfo = (MemoryTrackerCreateInfo){ .isMemoryBudgetSupported = true, .budgetPercent = 100 };
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+    TEST_CHECK(tracker.heaps[0].budget == 800 * KB);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 500 * KB);
+
+    VkDeviceMemory memory;
+    uint32_t memoryTypeIndex = UINT32_MAX;
+    TEST_CHECK(Allocate(&tracker, 600 * KB, 0x3, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memory, &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 1);
+    FreeTrackedDeviceMemory(&tracker, memory);
+    TEST_CHECK(Allocate(&tracker, 200 * KB, 0x3, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &memory, &memoryTypeIndex) == VK_SUCCESS);
+    TEST_CHECK(memoryTypeIndex == 0);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 300 * KB);
+
+    // The driver now reports the allocation itself, which is not counted twice
+    pDevice->heapUsages[0] = 500 * KB;
+    UpdateDeviceMemoryBudget(&tracker);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 300 * KB);
+    TEST_CHECK(tracker.heaps[0].peakUsage == 500 * KB);
+    FreeTrackedDeviceMemory(&tracker, memory);
+    TEST_CHECK(GetDeviceMemoryHeadroom(&tracker, 0x1, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) == 500 * KB);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+static void TestManyAllocations(void)
+{
+    FakeVulkanDevice* pDevice = ResetDiscreteDevice();
+    const MemoryTrackerCreateInfo createInfo = { .budgetPercent = 100 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+
+    // The list of allocations grows past its initial capacity
+    enum { ALLOCATION_COUNT = DEFAULT_TRACKED_ALLOCATION_CAPACITY * 3 };
+    VkDeviceMemory memories[ALLOCATION_COUNT];
+    for (uint32_t i = 0; i < ALLOCATION_COUNT; ++i)
+    {
+        const DeviceMemoryRequest request = {
+            .size = KB,
+            .memoryTypeBits = 0x7,
+            .preferredFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+            .category = (DeviceMemoryCategory)(i % DEVICE_MEMORY_CATEGORY_COUNT)
+        };
+        TEST_CHECK(AllocateTrackedDeviceMemory(&tracker, &request, &memories[i], NULL) == VK_SUCCESS);
+    }
+    TEST_CHECK(tracker.allocationCount == ALLOCATION_COUNT);
+    TEST_CHECK(tracker.allocationCapacity >= ALLOCATION_COUNT);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == ALLOCATION_COUNT * KB);
+    for (uint32_t i = 0; i < DEVICE_MEMORY_CATEGORY_COUNT; ++i) {
+        TEST_CHECK(tracker.categories[i].currentBytes == (VkDeviceSize)(ALLOCATION_COUNT / DEVICE_MEMORY_CATEGORY_COUNT) * KB);
+    }
+
+    // In an order other than the reverse of the allocations
+    for (uint32_t i = 0; i < ALLOCATION_COUNT; i += 2) {
+        FreeTrackedDeviceMemory(&tracker, memories[i]);
+    }
+    for (uint32_t i = 1; i < ALLOCATION_COUNT; i += 2) {
+        FreeTrackedDeviceMemory(&tracker, memories[i]);
+    }
+    TEST_CHECK(tracker.allocationCount == 0);
+    TEST_CHECK(tracker.heaps[0].trackedBytes == 0);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+
+    RecordDeviceMemoryDegradation(&tracker, DEVICE_MEMORY_CATEGORY_TEXTURE, 3 * KB);
+    TEST_CHECK(tracker.degradationCount == 1);
+    TEST_CHECK(tracker.degradedBytes == 3 * KB);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+static void TestReadbackMemory(void)
+{
+    // Host cached memory is not coherent here, as on most discrete GPUs
+    const VkMemoryPropertyFlags propertyFlags[3] = {
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT
+    };
+    const uint32_t heapIndices[3] = { 0, 1, 1 };
+    const VkDeviceSize heapSizes[2] = { DEVICE_HEAP_SIZE, HOST_HEAP_SIZE };
+    FakeVulkanDevice* pDevice = ResetFakeVulkanDevice(3, propertyFlags, heapIndices, 2, heapSizes);
+    const MemoryTrackerCreateInfo createInfo = { .budgetPercent = 100 };
+    DeviceMemoryTracker tracker;
+    TEST_CHECK(CreateDeviceMemoryTracker(&createInfo, &tracker));
+
+    // Cached memory first, through the tracker or without it
+    VkMemoryRequirements requirements = { .size = 64 * KB, .alignment = 256, .memoryTypeBits = 0x7 };
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    bool isCoherent = true;
+    TEST_CHECK(AllocateReadbackDeviceMemory(&tracker, VK_NULL_HANDLE, NULL, NULL, &requirements, &memory, &isCoherent) == VK_SUCCESS);
+    TEST_CHECK(!isCoherent);
+    TEST_CHECK(tracker.allocationCount == 1 && tracker.pAllocations[0].memoryTypeIndex == 2);
+    TEST_CHECK(tracker.categories[DEVICE_MEMORY_CATEGORY_READBACK].currentBytes == 64 * KB);
+    FreeTrackedDeviceMemory(&tracker, memory);
+
+    isCoherent = true;
+    TEST_CHECK(AllocateReadbackDeviceMemory(NULL, VK_NULL_HANDLE, NULL, &pDevice->memoryProperties, &requirements, &memory, &isCoherent) == VK_SUCCESS);
+    TEST_CHECK(!isCoherent);
+    TEST_CHECK(pDevice->liveMemoryCount == 1);
+    vkFreeMemory(VK_NULL_HANDLE, memory, NULL);
+
+    // Then any host visible memory
+    requirements.memoryTypeBits = 0x3;
+    isCoherent = false;
+    TEST_CHECK(AllocateReadbackDeviceMemory(NULL, VK_NULL_HANDLE, NULL, &pDevice->memoryProperties, &requirements, &memory, &isCoherent) == VK_SUCCESS);
+    TEST_CHECK(isCoherent);
+    vkFreeMemory(VK_NULL_HANDLE, memory, NULL);
+
+    requirements.memoryTypeBits = 0x1;
+    TEST_CHECK(AllocateReadbackDeviceMemory(NULL, VK_NULL_HANDLE, NULL, &pDevice->memoryProperties, &requirements, &memory, &isCoherent) ==
+        VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    TEST_CHECK(AllocateReadbackDeviceMemory(&tracker, VK_NULL_HANDLE, NULL, NULL, &requirements, &memory, &isCoherent) == VK_ERROR_OUT_OF_DEVICE_MEMORY);
+    TEST_CHECK(pDevice->liveMemoryCount == 0);
+    DestroyDeviceMemoryTracker(&tracker);
+}
+
+int main(void)
+{
+    TestPlacementWithinBudget();
+    TestFailedMemoryTypes();
+    TestBudgets();
+    TestManyAllocations();
+    TestReadbackMemory();
+    return GetTestExitCode();
+}
@@ -0,0 +1,193 @@
+#include "mesh_optimizer.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+
+enum MESH_OPTIMIZER_TEST_CONSTANTS
+{
+    // Larger than the simulated vertex fetch cache, so a shuffled vertex order overfetches
+    GRID_SIZE = 64,
+    GRID_VERTEX_COUNT = (GRID_SIZE + 1) * (GRID_SIZE + 1),
+    // One more vertex that no triangle uses
+    MESH_VERTEX_COUNT = GRID_VERTEX_COUNT + 1,
+    MESH_INDEX_COUNT = GRID_SIZE * GRID_SIZE * 6
+};
+
+typedef struct TestVertex
+{
+    float position[3];
+    uint32_t id;
+} TestVertex;
+
+typedef struct TestMesh
+{
+    TestVertex vertices[MESH_VERTEX_COUNT];
+    uint32_t indices[MESH_INDEX_COUNT];
+} TestMesh;
+
+// A bumpy grid whose triangles and vertices are shuffled, so neither is in a cache friendly order
+static void BuildShuffledGrid(TestMesh* pMesh)
+{
+    uint32_t randomState = 0x1234567U;
+    static uint32_t vertexOrder[MESH_VERTEX_COUNT];
+    for (uint32_t i = 0; i < MESH_VERTEX_COUNT; ++i) {
+        vertexOrder[i] = i;
+    }
+    for (uint32_t i = MESH_VERTEX_COUNT - 1; i > 0; --i)
+    {
+        const uint32_t j = NextTestRandom(&randomState) % (i + 1);
+        const uint32_t swap = vertexOrder[i];
+        vertexOrder[i] = vertexOrder[j];
+        vertexOrder[j] = swap;
+    }
+
+    // vertexOrder[g] is where grid vertex g is stored
+    for (uint32_t g = 0; g < MESH_VERTEX_COUNT; ++g)
+    {
+        TestVertex* pVertex = &pMesh->vertices[vertexOrder[g]];
+        pVertex->position[0] = (float)(g % (GRID_SIZE + 1));
+        pVertex->position[1] = (float)(g / (GRID_SIZE + 1));
+        pVertex->position[2] = NextTestRandomFloat(&randomState, 0.0f, 0.5f);
+        pVertex->id = g;
+    }
+    uint32_t* pIndex = pMesh->indices;
+    for (uint32_t y = 0; y < GRID_SIZE; ++y)
+    {
+        for (uint32_t x = 0; x < GRID_SIZE; ++x)
+        {
+            const uint32_t corner = y * (GRID_SIZE + 1) + x;
+            const uint32_t quad[6] = { corner, corner + 1, corner + GRID_SIZE + 1, corner + 1, corner + GRID_SIZE + 2, corner + GRID_SIZE + 1 };
+            for (uint32_t i = 0; i < 6; ++i) {
+                *pIndex++ = vertexOrder[quad[i]];
+            }
+        }
+    }
+    for (uint32_t i = MESH_INDEX_COUNT / 3 - 1; i > 0; --i)
+    {
+        const uint32_t j = NextTestRandom(&randomState) % (i + 1);
+        uint32_t swap[3];
+        memcpy(swap, &pMesh->indices[i * 3], sizeof(swap));
+        memcpy(&pMesh->indices[i * 3], &pMesh->indices[j * 3], sizeof(swap));
+        memcpy(&pMesh->indices[j * 3], swap, sizeof(swap));
+    }
+}
+
+static int CompareTriangles(const void* pLeft, const void* pRight)
+{
+    const uint32_t* left = pLeft;
+    const uint32_t* right = pRight;
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        if (left[i] != right[i]) return left[i] < right[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Whether both index lists hold the same triangles with the same winding, in any order and starting at any corner
+static bool HaveSameTriangles(const uint32_t* left, const uint32_t* right, size_t indexCount)
+{
+    uint32_t* pSorted[2] = { malloc(indexCount * sizeof(uint32_t)), malloc(indexCount * sizeof(uint32_t)) };
+    const uint32_t* sources[2] = { left, right };
+    for (uint32_t s = 0; s < 2; ++s)
+    {
+        for (size_t t = 0; t < indexCount; t += 3)
+        {
+            const uint32_t* triangle = &sources[s][t];
+            const uint32_t first = triangle[0] < triangle[1] ? (triangle[0] < triangle[2] ? 0 : 2) : (triangle[1] < triangle[2] ? 1 : 2);
+            for (uint32_t i = 0; i < 3; ++i) {
+                pSorted[s][t + i] = triangle[(first + i) % 3];
+            }
+        }
+        qsort(pSorted[s], indexCount / 3, 3 * sizeof(uint32_t), CompareTriangles);
+    }
+    const bool isSame = memcmp(pSorted[0], pSorted[1], indexCount * sizeof(uint32_t)) == 0;
+    free(pSorted[0]);
+    free(pSorted[1]);
+    return isSame;
+}
+
+static void TestAnalysis(void)
+{
+    // Every vertex of a lone triangle is transformed once
+    const uint32_t triangle[3] = { 0, 1, 2 };
+    VertexCacheStatistics cacheStatistics;
+    AnalyzeVertexCache(triangle, 3, 3, &cacheStatistics);
+    TEST_CHECK(cacheStatistics.vertexTransformCount == 3);
+    TEST_CHECK(cacheStatistics.acmr == 3.0f);
+    TEST_CHECK(cacheStatistics.atvr == 1.0f);
+
+    // Repeating it hits the cache
+    const uint32_t twice[6] = { 0, 1, 2, 2, 1, 0 };
+    AnalyzeVertexCache(twice, 6, 3, &cacheStatistics);
+    TEST_CHECK(cacheStatistics.vertexTransformCount == 3);
+    TEST_CHECK(cacheStatistics.acmr == 1.5f);
+
+    // Vertices fetched in order touch each cache line once
+    enum { SEQUENTIAL_VERTEX_COUNT = 96 };
+    uint32_t sequential[SEQUENTIAL_VERTEX_COUNT];
+    for (uint32_t i = 0; i < SEQUENTIAL_VERTEX_COUNT; ++i) {
+        sequential[i] = i;
+    }
+    VertexFetchStatistics fetchStatistics;
+    AnalyzeVertexFetch(sequential, SEQUENTIAL_VERTEX_COUNT, SEQUENTIAL_VERTEX_COUNT, 16, &fetchStatistics);
+    TEST_CHECK(fetchStatistics.bytesFetched == SEQUENTIAL_VERTEX_COUNT * 16);
+    TEST_CHECK(fetchStatistics.overfetch == 1.0f);
+}
+
+static void TestOptimization(void)
+{
+    static TestMesh mesh;
+    BuildShuffledGrid(&mesh);
+    static uint32_t cacheOrder[MESH_INDEX_COUNT];
+    static uint32_t overdrawOrder[MESH_INDEX_COUNT];
+    static TestVertex fetchVertices[MESH_VERTEX_COUNT];
+
+    VertexCacheStatistics shuffledCache;
+    AnalyzeVertexCache(mesh.indices, MESH_INDEX_COUNT, MESH_VERTEX_COUNT, &shuffledCache);
+    TEST_CHECK(OptimizeVertexCache(cacheOrder, mesh.indices, MESH_INDEX_COUNT, MESH_VERTEX_COUNT));
+    TEST_CHECK(HaveSameTriangles(cacheOrder, mesh.indices, MESH_INDEX_COUNT));
+    VertexCacheStatistics optimizedCache;
+    AnalyzeVertexCache(cacheOrder, MESH_INDEX_COUNT, MESH_VERTEX_COUNT, &optimizedCache);
+    printf("ACMR %.3f shuffled, %.3f optimized\n", shuffledCache.acmr, optimizedCache.acmr);
+    TEST_CHECK(optimizedCache.acmr < 1.0f);
+    TEST_CHECK(optimizedCache.acmr * 2.0f < shuffledCache.acmr);
+
+    // The overdraw order keeps most of the cache locality
+    TEST_CHECK(OptimizeOverdraw(overdrawOrder, cacheOrder, MESH_INDEX_COUNT, mesh.vertices[0].position, MESH_VERTEX_COUNT, sizeof(TestVertex), 1.05f));
+    TEST_CHECK(HaveSameTriangles(overdrawOrder, mesh.indices, MESH_INDEX_COUNT));
+    VertexCacheStatistics overdrawCache;
+    AnalyzeVertexCache(overdrawOrder, MESH_INDEX_COUNT, MESH_VERTEX_COUNT, &overdrawCache);
+    TEST_CHECK(overdrawCache.acmr <= optimizedCache.acmr * 1.05f + 1e-4f);
+
+    // The vertices end up in the order they are first used, without the unused one
+    VertexFetchStatistics shuffledFetch;
+    AnalyzeVertexFetch(overdrawOrder, MESH_INDEX_COUNT, MESH_VERTEX_COUNT, sizeof(TestVertex), &shuffledFetch);
+    static uint32_t fetchOrder[MESH_INDEX_COUNT];
+    memcpy(fetchOrder, overdrawOrder, sizeof(fetchOrder));
+    const size_t vertexCount = OptimizeVertexFetch(fetchVertices, fetchOrder, MESH_INDEX_COUNT, mesh.vertices, MESH_VERTEX_COUNT, sizeof(TestVertex));
+    TEST_CHECK(vertexCount == GRID_VERTEX_COUNT);
+    uint32_t nextNewVertex = 0;
+    bool isFirstUseOrder = true;
+    bool isSameVertex = true;
+    for (uint32_t i = 0; i < MESH_INDEX_COUNT; ++i)
+    {
+        if (fetchOrder[i] == nextNewVertex) {
+            ++nextNewVertex;
+        }
+        isFirstUseOrder = isFirstUseOrder && fetchOrder[i] < nextNewVertex;
+        isSameVertex = isSameVertex && memcmp(&fetchVertices[fetchOrder[i]], &mesh.vertices[overdrawOrder[i]], sizeof(TestVertex)) == 0;
+    }
+    TEST_CHECK(isFirstUseOrder);
+    TEST_CHECK(isSameVertex);
+    VertexFetchStatistics optimizedFetch;
+    AnalyzeVertexFetch(fetchOrder, MESH_INDEX_COUNT, vertexCount, sizeof(TestVertex), &optimizedFetch);
+    printf("Overfetch %.3f shuffled, %.3f optimized\n", shuffledFetch.overfetch, optimizedFetch.overfetch);
+    TEST_CHECK(optimizedFetch.overfetch < shuffledFetch.overfetch);
+}
+
+int main(void)
+{
+    TestAnalysis();
+    TestOptimization();
+    return GetTestExitCode();
+}
@@ -0,0 +1,155 @@
+#include "object_culling.h"
+#include "test_utils.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+enum OBJECT_CULLING_TEST_CONSTANTS
+{
+    // Not a multiple of OBJECT_STORE_LANE_COUNT, so the padding of the last vector is culled too
+    RANDOM_OBJECT_COUNT = 5003,
+    // A multiple of OBJECT_STORE_LANE_COUNT, as CullObjectRange requires
+    CULL_RANGE_SIZE = 1000
+};
+
+static void TestClipVolume(void)
+{
+    // With an identity matrix, the frustum is the clip volume -1 <= x, y <= 1 and 0 <= z <= 1
+    static const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    Frustum frustum;
+    ExtractFrustumPlanes(identity, &frustum);
+    for (uint32_t p = 0; p < FRUSTUM_PLANE_COUNT; ++p)
+    {
+        const float* plane = frustum.planes[p];
+        TEST_CHECK(fabsf(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2] - 1.0f) < 1e-5f);
+    }
+
+    static const struct { float position[3]; float halfExtent; bool isVisible; } s_objects[] = {
+        { { 0.0f, 0.0f, 0.5f }, 0.1f, true },
+        { { 3.0f, 0.0f, 0.5f }, 0.1f, false },
+        // Straddles a plane
+        { { 1.05f, 0.0f, 0.5f }, 0.1f, true },
+        { { 0.0f, 0.0f, -0.5f }, 0.1f, false },
+        { { 0.0f, 0.0f, 1.5f }, 0.1f, false },
+        // Overlaps the corner of two planes
+        { { 1.2f, -1.2f, 0.5f }, 0.25f, true },
+        { { 0.0f, -1.3f, 0.9f }, 0.2f, false },
+        // Contains the whole frustum
+        { { 0.0f, 0.0f, 0.0f }, 10.0f, true },
+        { { -0.99f, 0.99f, 0.99f }, 0.0f, true }
+    };
+    const uint32_t objectCount = sizeof(s_objects) / sizeof(s_objects[0]);
+    ObjectStore store;
+    TEST_CHECK(CreateObjectStore(objectCount, &store));
+    TEST_CHECK(store.paddedCapacity % OBJECT_STORE_LANE_COUNT == 0 && store.paddedCapacity >= objectCount);
+    for (uint32_t i = 0; i < objectCount; ++i)
+    {
+        const float halfExtents[3] = { s_objects[i].halfExtent, s_objects[i].halfExtent, s_objects[i].halfExtent };
+        TEST_CHECK(AddObjectToStore(&store, s_objects[i].position, halfExtents));
+    }
+    const float halfExtents[3] = { 1.0f, 1.0f, 1.0f };
+    TEST_CHECK(!AddObjectToStore(&store, s_objects[0].position, halfExtents));
+
+    uint32_t* pVisibleIndices = malloc(store.paddedCapacity * sizeof(uint32_t));
+    for (uint32_t k = 0; k < CULLING_KERNEL_COUNT; ++k)
+    {
+        if (!IsCullingKernelSupported((CullingKernel)k)) continue;
+
+        const uint32_t visibleCount = CullObjects(&store, &frustum, (CullingKernel)k, pVisibleIndices);
+        uint32_t expectedCount = 0;
+        for (uint32_t i = 0; i < objectCount; ++i)
+        {
+            if (!s_objects[i].isVisible) continue;
+            TEST_CHECK(expectedCount < visibleCount && pVisibleIndices[expectedCount] == i);
+            ++expectedCount;
+        }
+        TEST_CHECK(visibleCount == expectedCount);
+    }
+
+    // Moving an object into the frustum makes it visible
+    const float center[3] = { 0.0f, 0.5f, 0.5f };
+    SetObjectBounds(&store, 1, center, halfExtents);
+    TEST_CHECK(store.radius[1] > 1.7f && store.radius[1] < 1.74f);
+    const uint32_t visibleCount = CullObjects(&store, &frustum, CULLING_KERNEL_SCALAR, pVisibleIndices);
+    TEST_CHECK(visibleCount >= 2 && pVisibleIndices[1] == 1);
+    free(pVisibleIndices);
+    DestroyObjectStore(&store);
+}
+
+// A column-major perspective projection with the Vulkan depth range, looking down -z from the origin
+static void BuildPerspective(float fovY, float aspect, float nearZ, float farZ, float matrix[16])
+{
+    const float f = 1.0f / tanf(fovY * 0.5f);
+    memset(matrix, 0, 16 * sizeof(float));
+    matrix[0] = f / aspect;
+    matrix[5] = f;
+    matrix[10] = farZ / (nearZ - farZ);
+    matrix[11] = -1.0f;
+    matrix[14] = nearZ * farZ / (nearZ - farZ);
+}
+
+static void TestKernelsAgree(void)
+{
+    float viewProjection[16];
+    BuildPerspective(1.0f, 16.0f / 9.0f, 0.1f, 60.0f, viewProjection);
+    Frustum frustum;
+    ExtractFrustumPlanes(viewProjection, &frustum);
+
+    ObjectStore store;
+    TEST_CHECK(CreateObjectStore(RANDOM_OBJECT_COUNT, &store));
+    uint32_t randomState = 0x2545F491U;
+    for (uint32_t i = 0; i < RANDOM_OBJECT_COUNT; ++i)
+    {
+        const float position[3] = {
+            NextTestRandomFloat(&randomState, -60.0f, 60.0f),
+            NextTestRandomFloat(&randomState, -40.0f, 40.0f),
+            NextTestRandomFloat(&randomState, -80.0f, 10.0f)
+        };
+        const float halfExtents[3] = {
+            NextTestRandomFloat(&randomState, 0.0f, 3.0f),
+            NextTestRandomFloat(&randomState, 0.0f, 3.0f),
+            NextTestRandomFloat(&randomState, 0.0f, 3.0f)
+        };
+        TEST_CHECK(AddObjectToStore(&store, position, halfExtents));
+    }
+
+    uint32_t* pExpected = malloc(store.paddedCapacity * sizeof(uint32_t));
+    uint32_t* pVisibleIndices = malloc(store.paddedCapacity * sizeof(uint32_t));
+    const uint32_t expectedCount = CullObjects(&store, &frustum, CULLING_KERNEL_SCALAR, pExpected);
+    TEST_CHECK(expectedCount > 0 && expectedCount < RANDOM_OBJECT_COUNT);
+    bool isAscending = true;
+    for (uint32_t i = 1; i < expectedCount; ++i) {
+        isAscending = isAscending && pExpected[i - 1] < pExpected[i];
+    }
+    TEST_CHECK(isAscending);
+
+    TEST_CHECK(IsCullingKernelSupported(CULLING_KERNEL_SCALAR));
+    TEST_CHECK(IsCullingKernelSupported(GetBestCullingKernel()));
+    for (uint32_t k = 0; k < CULLING_KERNEL_COUNT; ++k)
+    {
+        if (!IsCullingKernelSupported((CullingKernel)k)) continue;
+        printf("Checking the %s kernel\n", GetCullingKernelName((CullingKernel)k));
+
+        const uint32_t visibleCount = CullObjects(&store, &frustum, (CullingKernel)k, pVisibleIndices);
+        TEST_CHECK(visibleCount == expectedCount && memcmp(pVisibleIndices, pExpected, expectedCount * sizeof(uint32_t)) == 0);
+
+        // Ranges culled one by one add up to the whole store
+        uint32_t rangeVisibleCount = 0;
+        for (uint32_t first = 0; first < RANDOM_OBJECT_COUNT; first += CULL_RANGE_SIZE)
+        {
+            const uint32_t count = RANDOM_OBJECT_COUNT - first < CULL_RANGE_SIZE ? RANDOM_OBJECT_COUNT - first : CULL_RANGE_SIZE;
+            rangeVisibleCount += CullObjectRange(&store, &frustum, (CullingKernel)k, first, count, pVisibleIndices + rangeVisibleCount);
+        }
+        TEST_CHECK(rangeVisibleCount == expectedCount && memcmp(pVisibleIndices, pExpected, expectedCount * sizeof(uint32_t)) == 0);
+    }
+    free(pVisibleIndices);
+    free(pExpected);
+    DestroyObjectStore(&store);
+}
+
+int main(void)
+{
+    TestClipVolume();
+    TestKernelsAgree();
+    return GetTestExitCode();
+}
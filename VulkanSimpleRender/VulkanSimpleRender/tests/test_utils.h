@@ -0,0 +1,46 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Every test is a program returning GetTestExitCode() from main. A failed check is reported and the test carries on,
+// so one run lists every failure.
+static int s_testFailureCount;
+
+static inline void ReportTestFailure(const char* file, int line, const char* condition)
+{
+    printf("%s(%d): check failed: %s\n", file, line, condition);
+    ++s_testFailureCount;
+}
+
+static inline int GetTestExitCode(void)
+{
+    if (s_testFailureCount > 0)
+    {
+        printf("%d checks failed\n", s_testFailureCount);
+        return 1;
+    }
+    puts("All checks passed");
+    return 0;
+}
+
+#define TEST_CHECK(condition) \
+    do { if (!(condition)) { ReportTestFailure(__FILE__, __LINE__, #condition); } } while (0)
+
+// xorshift32, so the inputs are the same on every platform
+static inline uint32_t NextTestRandom(uint32_t* pState)
+{
+    uint32_t x = *pState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *pState = x;
+    return x;
+}
+
+// Uniform in [minValue, maxValue)
+static inline float NextTestRandomFloat(uint32_t* pState, float minValue, float maxValue)
+{
+    return minValue + (maxValue - minValue) * (float)(NextTestRandom(pState) >> 8) * (1.0f / 16777216.0f);
+}
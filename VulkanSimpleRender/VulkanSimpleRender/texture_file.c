@@ -0,0 +1,161 @@
+#include "texture_file.h"
+#include <stdio.h>
+#include <string.h>
+
+static const uint8_t s_ktx2Identifier[KTX2_IDENTIFIER_SIZE] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+bool GetTextureFormatInfo(VkFormat format, TextureFormatInfo* pInfo)
+{
+    switch (format)
+    {
+    case VK_FORMAT_R8G8B8A8_UNORM:
+    case VK_FORMAT_R8G8B8A8_SRGB:
+    case VK_FORMAT_B8G8R8A8_UNORM:
+    case VK_FORMAT_B8G8R8A8_SRGB:
+        *pInfo = (TextureFormatInfo){ .blockWidth = 1, .blockHeight = 1, .blockSize = 4, .isCompressed = false };
+        return true;
+
+    case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+    case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+    case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+    case VK_FORMAT_BC4_UNORM_BLOCK:
+    case VK_FORMAT_BC4_SNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+    case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+        *pInfo = (TextureFormatInfo){ .blockWidth = 4, .blockHeight = 4, .blockSize = 8, .isCompressed = true };
+        return true;
+
+    case VK_FORMAT_BC2_UNORM_BLOCK:
+    case VK_FORMAT_BC2_SRGB_BLOCK:
+    case VK_FORMAT_BC3_UNORM_BLOCK:
+    case VK_FORMAT_BC3_SRGB_BLOCK:
+    case VK_FORMAT_BC5_UNORM_BLOCK:
+    case VK_FORMAT_BC5_SNORM_BLOCK:
+    case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+    case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+    case VK_FORMAT_BC7_UNORM_BLOCK:
+    case VK_FORMAT_BC7_SRGB_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+    case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+    case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+    case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+        *pInfo = (TextureFormatInfo){ .blockWidth = 4, .blockHeight = 4, .blockSize = 16, .isCompressed = true };
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+uint64_t GetTextureLevelSize(const TextureFormatInfo* pInfo, uint32_t width, uint32_t height)
+{
+    const uint64_t blockColumnCount = (width + pInfo->blockWidth - 1) / pInfo->blockWidth;
+    const uint64_t blockRowCount = (height + pInfo->blockHeight - 1) / pInfo->blockHeight;
+    return blockColumnCount * blockRowCount * pInfo->blockSize;
+}
+
+static bool ValidateKtx2Header(const Ktx2Header* pHeader, const char* path)
+{
+    if (memcmp(pHeader->identifier, s_ktx2Identifier, KTX2_IDENTIFIER_SIZE) != 0)
+    {
+        printf("'%s' is not a KTX 2.0 file!\n", path);
+        return false;
+    }
+    if (pHeader->pixelWidth == 0 || pHeader->pixelHeight == 0 || pHeader->pixelDepth != 0 || pHeader->layerCount > 1 ||
+        pHeader->faceCount != 1)
+    {
+        printf("Texture file '%s' is not a 2D texture!\n", path);
+        return false;
+    }
+    if (pHeader->supercompressionScheme != 0)
+    {
+        printf("Texture file '%s' uses the unsupported supercompression scheme %u!\n", path, pHeader->supercompressionScheme);
+        return false;
+    }
+    // A full mip chain of the base level is the longest valid one.
+    uint32_t maxLevelCount = 1;
+    for (uint32_t size = pHeader->pixelWidth > pHeader->pixelHeight ? pHeader->pixelWidth : pHeader->pixelHeight; size > 1; size /= 2) {
+        ++maxLevelCount;
+    }
+    if (pHeader->levelCount > maxLevelCount || pHeader->levelCount > MAX_TEXTURE_LEVEL_COUNT)
+    {
+        printf("Texture file '%s' has too many mip levels: %u\n", path, pHeader->levelCount);
+        return false;
+    }
+    return true;
+}
+
+bool OpenTextureFile(const char* path, TextureFile* pTextureFile)
+{
+    memset(pTextureFile, 0, sizeof(*pTextureFile));
+
+    if (!MapPlatformFile(path, &pTextureFile->mapping))
+    {
+        printf("Map texture file '%s' failed!\n", path);
+        return false;
+    }
+
+    const Ktx2Header* pHeader = pTextureFile->mapping.pData;
+    const uint64_t fileSize = pTextureFile->mapping.size;
+    if (fileSize < sizeof(*pHeader))
+    {
+        printf("Texture file '%s' is too small!\n", path);
+        CloseTextureFile(pTextureFile);
+        return false;
+    }
+    bool isValid = ValidateKtx2Header(pHeader, path);
+    if (isValid && !GetTextureFormatInfo((VkFormat)pHeader->vkFormat, &pTextureFile->formatInfo))
+    {
+        printf("Texture file '%s' has the unsupported format %u!\n", path, pHeader->vkFormat);
+        isValid = false;
+    }
+
+    const uint32_t levelCount = pHeader->levelCount > 0 ? pHeader->levelCount : 1;
+    if (isValid && fileSize < sizeof(*pHeader) + levelCount * sizeof(Ktx2LevelIndex))
+    {
+        printf("Texture file '%s' is too small!\n", path);
+        isValid = false;
+    }
+
+    const uint8_t* pFileData = pTextureFile->mapping.pData;
+    const Ktx2LevelIndex* pLevelIndices = (const Ktx2LevelIndex*)(pFileData + sizeof(*pHeader));
+    for (uint32_t i = 0; isValid && i < levelCount; ++i)
+    {
+        TextureLevel* pLevel = &pTextureFile->levels[i];
+        pLevel->width = pHeader->pixelWidth >> i > 0 ? pHeader->pixelWidth >> i : 1;
+        pLevel->height = pHeader->pixelHeight >> i > 0 ? pHeader->pixelHeight >> i : 1;
+        pLevel->size = GetTextureLevelSize(&pTextureFile->formatInfo, pLevel->width, pLevel->height);
+        // Written this way to avoid overflowing 64 bits with a corrupted offset
+        if (pLevelIndices[i].byteLength != pLevel->size || pLevelIndices[i].byteOffset > fileSize ||
+            pLevel->size > fileSize - pLevelIndices[i].byteOffset)
+        {
+            printf("Texture file '%s' is truncated or has an invalid level %u!\n", path, i);
+            isValid = false;
+            break;
+        }
+        pLevel->pData = pFileData + pLevelIndices[i].byteOffset;
+    }
+
+    if (!isValid)
+    {
+        CloseTextureFile(pTextureFile);
+        return false;
+    }
+
+    pTextureFile->format = (VkFormat)pHeader->vkFormat;
+    pTextureFile->width = pHeader->pixelWidth;
+    pTextureFile->height = pHeader->pixelHeight;
+    pTextureFile->levelCount = levelCount;
+    return true;
+}
+
+void CloseTextureFile(TextureFile* pTextureFile)
+{
+    UnmapPlatformFile(&pTextureFile->mapping);
+    memset(pTextureFile, 0, sizeof(*pTextureFile));
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include <vulkan/vulkan.h>
+#include "platform_utils.h"
+
+enum TEXTURE_FILE_CONSTANTS
+{
+    // Enough for a 32768 x 32768 texture
+    MAX_TEXTURE_LEVEL_COUNT = 16,
+    KTX2_IDENTIFIER_SIZE = 12
+};
+
+// Stored at offset 0 of a KTX 2.0 file, followed by the level index with one Ktx2LevelIndex per mip level.
+// All values are little endian.
+typedef struct Ktx2Header
+{
+    uint8_t identifier[KTX2_IDENTIFIER_SIZE];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    // 0 for 2D textures
+    uint32_t pixelDepth;
+    // 0 if the texture is not an array
+    uint32_t layerCount;
+    uint32_t faceCount;
+    // 0 asks the loader to generate the mip levels from the base level
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+} Ktx2Header;
+
+static_assert(sizeof(Ktx2Header) == 80U, "Invalid Ktx2Header size");
+
+typedef struct Ktx2LevelIndex
+{
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+} Ktx2LevelIndex;
+
+typedef struct TextureFormatInfo
+{
+    // Texel dimensions of a block, 1 x 1 for uncompressed formats
+    uint32_t blockWidth;
+    uint32_t blockHeight;
+    uint32_t blockSize;
+    bool isCompressed;
+} TextureFormatInfo;
+
+typedef struct TextureLevel
+{
+    // Points into the mapping, rows of blocks are tightly packed
+    const uint8_t* pData;
+    uint64_t size;
+    uint32_t width;
+    uint32_t height;
+} TextureLevel;
+
+typedef struct TextureFile
+{
+    PlatformMappedFile mapping;
+    VkFormat format;
+    TextureFormatInfo formatInfo;
+    uint32_t width;
+    uint32_t height;
+    // Level 0 is the base level. A file storing only the base level has a level count of 1.
+    uint32_t levelCount;
+    TextureLevel levels[MAX_TEXTURE_LEVEL_COUNT];
+} TextureFile;
+
+// Returns false if the format cannot be loaded: 8-bit RGBA, BC1 ~ BC7, ETC2 and EAC formats are supported.
+extern bool GetTextureFormatInfo(VkFormat format, TextureFormatInfo* pInfo);
+// Size in bytes of a `width` x `height` level of `pInfo` format
+extern uint64_t GetTextureLevelSize(const TextureFormatInfo* pInfo, uint32_t width, uint32_t height);
+
+// Maps the 2D KTX 2.0 file at `path` and validates its level index. No texel data is read yet.
+// Supercompressed files, arrays, cube maps and 3D textures are rejected.
+extern bool OpenTextureFile(const char* path, TextureFile* pTextureFile);
+extern void CloseTextureFile(TextureFile* pTextureFile);
@@ -0,0 +1,26 @@
+
+#version 450 core
+
+#extension GL_EXT_scalar_block_layout : enable
+
+precision mediump int;
+precision highp float;
+
+layout(location = 0) in smooth lowp vec4 fragColor;
+layout(location = 1) in smooth vec2 fragTexCoord;
+layout(location = 0) out lowp vec4 myOutput;
+
+layout(std430, set = 0, binding = 0, scalar) uniform transform_block {
+    vec2 u_factor;
+    float u_angle;
+    // Finest mip level that has been streamed in, the finer levels MUST NOT be sampled
+    float u_minLod;
+} trans_consts;
+
+layout(set = 0, binding = 2) uniform sampler2D u_texture;
+
+void main(void)
+{
+    const float lod = max(textureQueryLod(u_texture, fragTexCoord).y, trans_consts.u_minLod);
+    myOutput = fragColor * textureLod(u_texture, fragTexCoord, lod);
+}
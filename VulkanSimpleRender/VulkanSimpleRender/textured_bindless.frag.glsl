@@ -0,0 +1,35 @@
+
+#version 450 core
+
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+precision mediump int;
+precision highp float;
+
+layout(location = 0) in smooth lowp vec4 fragColor;
+layout(location = 1) in smooth vec2 fragTexCoord;
+layout(location = 0) out lowp vec4 myOutput;
+
+// Elements of the descriptor arrays of the global set, pushed once per command buffer
+layout(push_constant) uniform bindless_indices {
+    uint uniformIndex;
+    uint transformIndex;
+    uint textureIndex;
+} indices;
+
+layout(std430, set = 0, binding = 0, scalar) readonly buffer transform_block {
+    vec2 u_factor;
+    float u_angle;
+    // Finest mip level that has been streamed in, the finer levels MUST NOT be sampled
+    float u_minLod;
+} trans_consts[];
+
+layout(set = 0, binding = 1) uniform sampler2D u_textures[];
+
+void main(void)
+{
+    // The index is the same for the whole draw, so it needs no nonuniformEXT.
+    const float lod = max(textureQueryLod(u_textures[indices.textureIndex], fragTexCoord).y, trans_consts[indices.uniformIndex].u_minLod);
+    myOutput = fragColor * textureLod(u_textures[indices.textureIndex], fragTexCoord, lod);
+}
@@ -0,0 +1,95 @@
+
+#version 450 core
+
+#extension GL_EXT_scalar_block_layout : enable
+#extension GL_EXT_nonuniform_qualifier : enable
+
+layout(location = 0) in vec4 inPos;
+layout(location = 1) in vec4 inColor;
+layout(location = 0) out smooth lowp vec4 fragColor;
+layout(location = 1) out smooth vec2 fragTexCoord;
+
+// Elements of the descriptor arrays of the global set, pushed once per command buffer
+layout(push_constant) uniform bindless_indices {
+    uint uniformIndex;
+    uint transformIndex;
+    uint textureIndex;
+} indices;
+
+// Every buffer of the global set is in the array at binding 0, so each block type aliases it.
+layout(std430, set = 0, binding = 0, scalar) readonly buffer transform_block {
+    vec2 u_factor;
+    float u_angle;
+    float u_minLod;
+} trans_consts[];
+
+struct ObjectTransform {
+    vec2 offset;
+    float angle;
+    float scale;
+};
+
+// Written by animate.comp for every frame
+layout(std430, set = 0, binding = 0) readonly buffer object_block {
+    ObjectTransform transforms[];
+} objects[];
+
+/** Model view translation matrix *
+ * [ 1  0  0  0
+     0  1  0  0
+     0  0  1  0
+     x  y  z  1
+ * ]
+*/
+
+/** Ortho projection matrix *
+ * [ 2/(r-l)       0             0             0
+     0             2/(t-b)       0             0
+     0             0             -2/(f-n)      0
+     -(r+l)/(r-l)  -(t+b)/(t-b)  -(f+n)/(f-n)  1
+ * ]
+*/
+
+/** rotate matrix *
+ * [x^2*(1-c)+c  xy*(1-c)+zs  xz(1-c)-ys  0
+    xy(1-c)-zs   y^2*(1-c)+c  yz(1-c)+xs  0
+    xz(1-c)+ys   yz(1-c)-xs   z^2(1-c)+c  0
+    0            0            0           1
+ * ]
+ * |(x, y, z)| must be 1.0
+*/
+
+void main(void)
+{
+    // gl_InstanceIndex includes the firstInstance of the draw
+    const ObjectTransform transform = objects[indices.transformIndex].transforms[gl_InstanceIndex];
+
+    // glTranslate(offset.x, offset.y, -2.3, 1.0)
+    mat4 translateMatrix = mat4(1.0f, 0.0f, 0.0f, transform.offset.x,      // column 0
+                                0.0f, 1.0f, 0.0f, transform.offset.y,      // column 1
+                                0.0f, 0.0f, 1.0f, -2.3f,       // column 2
+                                0.0f, 0.0f, 0.0f, 1.0f         // column 3
+                                );
+
+    const float radian = -radians(transform.angle);
+
+    // glRotate(angle, 0.0, 0.0, 1.0)
+    mat4 rotateMatrix = mat4(cos(radian), -sin(radian), 0.0f, 0.0f,     // column 0
+                             sin(radian), cos(radian), 0.0f, 0.0f,      // column 1
+                             0.0f, 0.0f, 1.0f, 0.0f,                    // column 2
+                             0.0f, 0.0f, 0.0f, 1.0f                     // column 3
+    );
+
+    // glOrtho(-u_factor.x, u_factor.x, -u_factor.y, u_factor.y, 1.0, 3.0)
+    mat4 projectionMatrix = mat4(1.0f / trans_consts[indices.uniformIndex].u_factor.x, 0.0f, 0.0f, 0.0f,  // column 0
+                                 0.0f, 1.0f / trans_consts[indices.uniformIndex].u_factor.y, 0.0f, 0.0f,  // column 1
+                                 0.0f, 0.0f, -1.0f, -2.0f,                          // column 2
+                                 0.0f, 0.0f, 0.0f, 1.0f                             // colimn 3
+                                 );
+
+    gl_Position = vec4(inPos.xyz * transform.scale, inPos.w) * (rotateMatrix * (translateMatrix * projectionMatrix));
+    
+    fragColor = inColor;
+    // The built-in square spans [-0.2, 0.2], larger meshes repeat the texture
+    fragTexCoord = inPos.xy * 2.5f + 0.5f;
+}
@@ -0,0 +1,639 @@
+#include "upload_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint64_t AlignUploadOffset(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+static bool CreateStagingRing(UploadManager* pManager)
+{
+    const VkDevice device = pManager->info.device;
+    DeviceMemoryTracker* pTracker = pManager->info.pMemoryTracker;
+    const VkMemoryPropertyFlags memoryPropertyFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    if (pTracker != NULL && pManager->info.minStagingSize > 0)
+    {
+        const VkDeviceSize requestedSize = pManager->info.stagingSize;
+        const VkDeviceSize headroom = GetDeviceMemoryHeadroom(pTracker, UINT32_MAX, memoryPropertyFlags);
+        while (pManager->info.stagingSize > headroom && pManager->info.stagingSize / 2 >= pManager->info.minStagingSize) {
+            pManager->info.stagingSize /= 2;
+        }
+        if (pManager->info.stagingSize < requestedSize) {
+            RecordDeviceMemoryDegradation(pTracker, DEVICE_MEMORY_CATEGORY_STAGING, requestedSize - pManager->info.stagingSize);
+        }
+    }
+
+    const VkBufferCreateInfo bufferCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .pNext = NULL,
+        .flags = 0,
+        .size = pManager->info.stagingSize,
+        .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+        .queueFamilyIndexCount = 1,
+        .pQueueFamilyIndices = &pManager->info.queueFamilyIndex
+    };
+    VkResult res = vkCreateBuffer(device, &bufferCreateInfo, pManager->info.pAllocator, &pManager->stagingBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateBuffer for upload staging ring failed: %d\n", res);
+        return false;
+    }
+
+    VkMemoryRequirements memoryRequirements = { 0 };
+    vkGetBufferMemoryRequirements(device, pManager->stagingBuffer, &memoryRequirements);
+
+    if (pTracker != NULL)
+    {
+        const DeviceMemoryRequest request = {
+            .pNext = NULL,
+            .size = memoryRequirements.size,
+            .memoryTypeBits = memoryRequirements.memoryTypeBits,
+            .requiredFlags = memoryPropertyFlags,
+            .preferredFlags = 0,
+            .category = DEVICE_MEMORY_CATEGORY_STAGING
+        };
+        res = AllocateTrackedDeviceMemory(pTracker, &request, &pManager->stagingMemory, NULL);
+    }
+    else
+    {
+        const VkPhysicalDeviceMemoryProperties* pMemoryProperties = pManager->info.pMemoryProperties;
+        uint32_t memoryTypeIndex;
+        for (memoryTypeIndex = 0; memoryTypeIndex < pMemoryProperties->memoryTypeCount; ++memoryTypeIndex)
+        {
+            if ((memoryRequirements.memoryTypeBits & (1U << memoryTypeIndex)) != 0 &&
+                (pMemoryProperties->memoryTypes[memoryTypeIndex].propertyFlags & memoryPropertyFlags) == memoryPropertyFlags) {
+                break;
+            }
+        }
+        if (memoryTypeIndex == pMemoryProperties->memoryTypeCount)
+        {
+            puts("No host coherent memory type for the upload staging ring!");
+            return false;
+        }
+
+        const VkMemoryAllocateInfo memAllocInfo = {
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = NULL,
+            .allocationSize = memoryRequirements.size,
+            .memoryTypeIndex = memoryTypeIndex
+        };
+        res = vkAllocateMemory(device, &memAllocInfo, pManager->info.pAllocator, &pManager->stagingMemory);
+    }
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateMemory for upload staging ring failed: %d\n", res);
+        return false;
+    }
+
+    res = vkBindBufferMemory(device, pManager->stagingBuffer, pManager->stagingMemory, 0);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBindBufferMemory for upload staging ring failed: %d\n", res);
+        return false;
+    }
+
+    // Mapped for the lifetime of the manager
+    res = vkMapMemory(device, pManager->stagingMemory, 0, VK_WHOLE_SIZE, 0, (void**)&pManager->pStagingData);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkMapMemory for upload staging ring failed: %d\n", res);
+        return false;
+    }
+
+    return true;
+}
+
+static bool CreateUploadBatches(UploadManager* pManager)
+{
+    const VkDevice device = pManager->info.device;
+    // Every batch command buffer is re-recorded once its fence is signaled
+    const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+        .queueFamilyIndex = pManager->info.queueFamilyIndex
+    };
+    VkResult res = vkCreateCommandPool(device, &commandPoolCreateInfo, pManager->info.pAllocator, &pManager->commandPool);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkCreateCommandPool for upload manager failed: %d\n", res);
+        return false;
+    }
+
+    VkCommandBuffer commandBuffers[UPLOAD_BATCH_RING_SIZE];
+    const VkCommandBufferAllocateInfo cmdBufAllocInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+        .pNext = NULL,
+        .commandPool = pManager->commandPool,
+        .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+        .commandBufferCount = UPLOAD_BATCH_RING_SIZE
+    };
+    res = vkAllocateCommandBuffers(device, &cmdBufAllocInfo, commandBuffers);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkAllocateCommandBuffers for upload manager failed: %d\n", res);
+        return false;
+    }
+
+    const VkFenceCreateInfo fenceCreateInfo = { .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO, .pNext = NULL, .flags = 0 };
+    for (uint32_t i = 0; i < UPLOAD_BATCH_RING_SIZE; ++i)
+    {
+        pManager->batches[i].commandBuffer = commandBuffers[i];
+        res = vkCreateFence(device, &fenceCreateInfo, pManager->info.pAllocator, &pManager->batches[i].fence);
+        if (res != VK_SUCCESS)
+        {
+            printf("vkCreateFence for upload batch failed: %d\n", res);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool CreateUploadManager(const UploadManagerCreateInfo* pCreateInfo, UploadManager* pManager)
+{
+    memset(pManager, 0, sizeof(*pManager));
+    pManager->info = *pCreateInfo;
+
+    // Every piece of an upload starts at an aligned offset, so the ring size is a multiple of the alignment.
+    VkDeviceSize alignment = MIN_UPLOAD_STAGING_ALIGNMENT;
+    while (alignment < pCreateInfo->stagingAlignment) {
+        alignment *= 2;
+    }
+    pManager->info.stagingAlignment = alignment;
+    pManager->info.stagingSize = AlignUploadOffset(pCreateInfo->stagingSize, alignment * UPLOAD_BATCH_RING_SIZE);
+
+    if (!CreateStagingRing(pManager) || !CreateUploadBatches(pManager))
+    {
+        DestroyUploadManager(pManager);
+        return false;
+    }
+    return true;
+}
+
+void DestroyUploadManager(UploadManager* pManager)
+{
+    const VkDevice device = pManager->info.device;
+    for (uint32_t i = 0; i < UPLOAD_BATCH_RING_SIZE; ++i)
+    {
+        UploadBatch* pBatch = &pManager->batches[i];
+        if (pBatch->isInFlight) {
+            vkWaitForFences(device, 1, &pBatch->fence, VK_TRUE, UINT64_MAX);
+        }
+        if (pBatch->fence != VK_NULL_HANDLE) {
+            vkDestroyFence(device, pBatch->fence, pManager->info.pAllocator);
+        }
+    }
+    if (pManager->commandPool != VK_NULL_HANDLE) {
+        // The batch command buffers are freed together with their pool
+        vkDestroyCommandPool(device, pManager->commandPool, pManager->info.pAllocator);
+    }
+    if (pManager->stagingBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, pManager->stagingBuffer, pManager->info.pAllocator);
+    }
+    if (pManager->stagingMemory != VK_NULL_HANDLE)
+    {
+        // Implicitly unmapped
+        if (pManager->info.pMemoryTracker != NULL) {
+            FreeTrackedDeviceMemory(pManager->info.pMemoryTracker, pManager->stagingMemory);
+        }
+        else {
+            vkFreeMemory(device, pManager->stagingMemory, pManager->info.pAllocator);
+        }
+    }
+    memset(pManager, 0, sizeof(*pManager));
+}
+
+// Batches complete in submission order on the queue, so the ring tail only moves forward.
+static bool RetireOldestBatch(UploadManager* pManager, bool wait)
+{
+    const uint32_t oldest = (pManager->nextBatch + UPLOAD_BATCH_RING_SIZE - pManager->inFlightBatchCount) % UPLOAD_BATCH_RING_SIZE;
+    UploadBatch* pBatch = &pManager->batches[oldest];
+    const VkResult res = wait ? vkWaitForFences(pManager->info.device, 1, &pBatch->fence, VK_TRUE, UINT64_MAX) :
+                                vkGetFenceStatus(pManager->info.device, pBatch->fence);
+    if (res != VK_SUCCESS)
+    {
+        if (res != VK_NOT_READY) {
+            printf("Waiting for upload batch failed: %d\n", res);
+        }
+        return false;
+    }
+
+    vkResetFences(pManager->info.device, 1, &pBatch->fence);
+    pBatch->isInFlight = false;
+    pManager->stagingTail = pBatch->stagingEnd;
+    --pManager->inFlightBatchCount;
+    ++pManager->completedBatchCount;
+    return true;
+}
+
+void RetireCompletedUploads(UploadManager* pManager)
+{
+    while (pManager->inFlightBatchCount > 0 && RetireOldestBatch(pManager, false));
+}
+
+static int CompareUploadCopies(const void* pLeft, const void* pRight)
+{
+    const UploadCopy* pLeftCopy = pLeft;
+    const UploadCopy* pRightCopy = pRight;
+    if (pLeftCopy->destinationIndex != pRightCopy->destinationIndex) {
+        return pLeftCopy->destinationIndex < pRightCopy->destinationIndex ? -1 : 1;
+    }
+    return pLeftCopy->sequence < pRightCopy->sequence ? -1 : (pLeftCopy->sequence > pRightCopy->sequence ? 1 : 0);
+}
+
+// Records one copy command per destination, after transitioning the images written for the first time into their transfer layout.
+static void RecordBatchCopies(UploadManager* pManager, VkCommandBuffer cmdBuf)
+{
+    VkImageMemoryBarrier imageBarriers[MAX_UPLOAD_DESTINATION_COUNT];
+    uint32_t imageBarrierCount = 0;
+    for (uint32_t i = 0; i < pManager->destinationCount; ++i)
+    {
+        UploadDestination* pDestination = &pManager->destinations[i];
+        if (pDestination->image == VK_NULL_HANDLE || pDestination->isTransferDstLayout) continue;
+
+        imageBarriers[imageBarrierCount++] = (VkImageMemoryBarrier){
+            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+            .pNext = NULL,
+            .srcAccessMask = 0,
+            .dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+            .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = pDestination->image,
+            .subresourceRange = pDestination->subresourceRange
+        };
+        pDestination->isTransferDstLayout = true;
+    }
+    if (imageBarrierCount > 0) {
+        vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+            0, NULL, 0, NULL, imageBarrierCount, imageBarriers);
+    }
+
+    qsort(pManager->copies, pManager->copyCount, sizeof(pManager->copies[0]), CompareUploadCopies);
+
+    union
+    {
+        VkBufferCopy bufferRegions[MAX_UPLOAD_COPY_COUNT];
+        VkBufferImageCopy imageRegions[MAX_UPLOAD_COPY_COUNT];
+    } regions;
+    for (uint32_t first = 0; first < pManager->copyCount; )
+    {
+        const uint32_t destinationIndex = pManager->copies[first].destinationIndex;
+        const UploadDestination* pDestination = &pManager->destinations[destinationIndex];
+        uint32_t regionCount = 0;
+        if (pDestination->buffer != VK_NULL_HANDLE)
+        {
+            for (; first + regionCount < pManager->copyCount && pManager->copies[first + regionCount].destinationIndex == destinationIndex; ++regionCount) {
+                regions.bufferRegions[regionCount] = pManager->copies[first + regionCount].bufferRegion;
+            }
+            vkCmdCopyBuffer(cmdBuf, pManager->stagingBuffer, pDestination->buffer, regionCount, regions.bufferRegions);
+        }
+        else
+        {
+            for (; first + regionCount < pManager->copyCount && pManager->copies[first + regionCount].destinationIndex == destinationIndex; ++regionCount) {
+                regions.imageRegions[regionCount] = pManager->copies[first + regionCount].imageRegion;
+            }
+            vkCmdCopyBufferToImage(cmdBuf, pManager->stagingBuffer, pDestination->image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                regionCount, regions.imageRegions);
+        }
+        ++pManager->copyCommandCount;
+        pManager->regionCount += regionCount;
+        first += regionCount;
+    }
+}
+
+// One barrier for all the destinations: a global memory barrier covers every buffer on the same queue family,
+// while a queue family ownership transfer needs a release barrier per resource.
+static void RecordDestinationBarriers(UploadManager* pManager, VkCommandBuffer cmdBuf)
+{
+    const bool isRelease = pManager->info.queueFamilyIndex != pManager->info.dstQueueFamilyIndex;
+    VkBufferMemoryBarrier bufferBarriers[MAX_UPLOAD_DESTINATION_COUNT];
+    VkImageMemoryBarrier imageBarriers[MAX_UPLOAD_DESTINATION_COUNT];
+    uint32_t bufferBarrierCount = 0;
+    uint32_t imageBarrierCount = 0;
+    VkPipelineStageFlags dstStageMask = 0;
+    VkAccessFlags bufferDstAccessMask = 0;
+    for (uint32_t i = 0; i < pManager->destinationCount; ++i)
+    {
+        const UploadDestination* pDestination = &pManager->destinations[i];
+        dstStageMask |= pDestination->dstStageMask;
+        // The destination access mask of a release barrier is ignored.
+        if (pDestination->buffer != VK_NULL_HANDLE)
+        {
+            bufferDstAccessMask |= pDestination->dstAccessMask;
+            if (!isRelease) continue;
+
+            bufferBarriers[bufferBarrierCount++] = (VkBufferMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .pNext = NULL,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = 0,
+                .srcQueueFamilyIndex = pManager->info.queueFamilyIndex,
+                .dstQueueFamilyIndex = pManager->info.dstQueueFamilyIndex,
+                .buffer = pDestination->buffer,
+                .offset = 0,
+                .size = VK_WHOLE_SIZE
+            };
+        }
+        else
+        {
+            imageBarriers[imageBarrierCount++] = (VkImageMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext = NULL,
+                .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+                .dstAccessMask = isRelease ? 0 : pDestination->dstAccessMask,
+                .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout = pDestination->finalLayout,
+                .srcQueueFamilyIndex = isRelease ? pManager->info.queueFamilyIndex : VK_QUEUE_FAMILY_IGNORED,
+                .dstQueueFamilyIndex = isRelease ? pManager->info.dstQueueFamilyIndex : VK_QUEUE_FAMILY_IGNORED,
+                .image = pDestination->image,
+                .subresourceRange = pDestination->subresourceRange
+            };
+        }
+    }
+
+    const VkMemoryBarrier memoryBarrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .pNext = NULL,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = bufferDstAccessMask
+    };
+    const uint32_t memoryBarrierCount = !isRelease && bufferDstAccessMask != 0 ? 1 : 0;
+    if (memoryBarrierCount + bufferBarrierCount + imageBarrierCount == 0) return;
+
+    vkCmdPipelineBarrier(cmdBuf, VK_PIPELINE_STAGE_TRANSFER_BIT, isRelease ? VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT : dstStageMask, 0,
+        memoryBarrierCount, &memoryBarrier, bufferBarrierCount, bufferBarriers, imageBarrierCount, imageBarriers);
+}
+
+// Records the pending copies into the next batch and submits it. The destination barriers are only recorded when
+// `isFinal` is true, since the earlier batches on the same queue are covered by the first synchronization scope of that barrier.
+static bool SubmitUploadBatch(UploadManager* pManager, bool isFinal, VkSemaphore signalSemaphore)
+{
+    UploadBatch* pBatch = &pManager->batches[pManager->nextBatch];
+    if (pBatch->isInFlight && !RetireOldestBatch(pManager, true)) return false;
+
+    const VkCommandBufferBeginInfo cmdBufBeginInfo = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .pNext = NULL,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = NULL
+    };
+    VkResult res = vkBeginCommandBuffer(pBatch->commandBuffer, &cmdBufBeginInfo);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkBeginCommandBuffer for upload batch failed: %d\n", res);
+        return false;
+    }
+
+    RecordBatchCopies(pManager, pBatch->commandBuffer);
+    if (isFinal) {
+        RecordDestinationBarriers(pManager, pBatch->commandBuffer);
+    }
+
+    res = vkEndCommandBuffer(pBatch->commandBuffer);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkEndCommandBuffer for upload batch failed: %d\n", res);
+        return false;
+    }
+
+    const VkSubmitInfo submitInfo = {
+        .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+        .pNext = NULL,
+        .waitSemaphoreCount = 0,
+        .pWaitSemaphores = NULL,
+        .pWaitDstStageMask = NULL,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &pBatch->commandBuffer,
+        .signalSemaphoreCount = signalSemaphore != VK_NULL_HANDLE ? 1 : 0,
+        .pSignalSemaphores = &signalSemaphore
+    };
+    res = vkQueueSubmit(pManager->info.queue, 1, &submitInfo, pBatch->fence);
+    if (res != VK_SUCCESS)
+    {
+        printf("vkQueueSubmit for upload batch failed: %d\n", res);
+        return false;
+    }
+
+    pBatch->stagingEnd = pManager->stagingHead;
+    pBatch->isInFlight = true;
+    pManager->nextBatch = (pManager->nextBatch + 1) % UPLOAD_BATCH_RING_SIZE;
+    ++pManager->inFlightBatchCount;
+    ++pManager->submittedBatchCount;
+    pManager->copyCount = 0;
+    pManager->pendingSize = 0;
+    return true;
+}
+
+// Reserves `size` bytes of the staging ring, submitting the pending copies and waiting for the oldest batches
+// until enough space has been retired. A piece never wraps around the end of the ring.
+static bool AllocateStaging(UploadManager* pManager, VkDeviceSize size, VkDeviceSize* pOffset)
+{
+    const uint64_t ringSize = pManager->info.stagingSize;
+    if (size > ringSize)
+    {
+        printf("Upload of %llu bytes does not fit into the staging ring of %llu bytes!\n", (unsigned long long)size, (unsigned long long)ringSize);
+        return false;
+    }
+
+    RetireCompletedUploads(pManager);
+    while (true)
+    {
+        uint64_t begin = AlignUploadOffset(pManager->stagingHead, pManager->info.stagingAlignment);
+        if (begin % ringSize + size > ringSize) {
+            begin = AlignUploadOffset(begin, ringSize);
+        }
+        if (begin + size - pManager->stagingTail <= ringSize)
+        {
+            pManager->stagingHead = begin + size;
+            *pOffset = begin % ringSize;
+            return true;
+        }
+
+        if (pManager->copyCount > 0 && !SubmitUploadBatch(pManager, false, VK_NULL_HANDLE)) return false;
+        if (pManager->inFlightBatchCount == 0)
+        {
+            // The ring is empty, so the piece starts at the beginning of the next lap.
+            pManager->stagingHead = AlignUploadOffset(pManager->stagingHead, ringSize);
+            pManager->stagingTail = pManager->stagingHead;
+            continue;
+        }
+        if (!RetireOldestBatch(pManager, true)) return false;
+    }
+}
+
+// Returns the index of the destination entry, or UINT32_MAX if there are too many destinations.
+static uint32_t FindOrAddDestination(UploadManager* pManager, const UploadDestination* pDestination)
+{
+    for (uint32_t i = 0; i < pManager->destinationCount; ++i)
+    {
+        UploadDestination* pExisting = &pManager->destinations[i];
+        if (pExisting->buffer == pDestination->buffer && pExisting->image == pDestination->image &&
+            pExisting->subresourceRange.baseMipLevel == pDestination->subresourceRange.baseMipLevel)
+        {
+            pExisting->dstStageMask |= pDestination->dstStageMask;
+            pExisting->dstAccessMask |= pDestination->dstAccessMask;
+            return i;
+        }
+    }
+    if (pManager->destinationCount == MAX_UPLOAD_DESTINATION_COUNT)
+    {
+        puts("Too many upload destinations! SubmitUploads MUST BE called more often.");
+        return UINT32_MAX;
+    }
+    pManager->destinations[pManager->destinationCount] = *pDestination;
+    return pManager->destinationCount++;
+}
+
+static bool AddUploadCopy(UploadManager* pManager, const UploadCopy* pCopy, VkDeviceSize size)
+{
+    pManager->copies[pManager->copyCount] = *pCopy;
+    pManager->copies[pManager->copyCount].sequence = pManager->copyCount;
+    ++pManager->copyCount;
+    pManager->pendingSize += size;
+    pManager->uploadedSize += size;
+
+    // A batch is submitted once it holds its share of the ring, so the next pieces are staged while it is copied.
+    if (pManager->copyCount == MAX_UPLOAD_COPY_COUNT || pManager->pendingSize >= pManager->info.stagingSize / UPLOAD_BATCH_RING_SIZE) {
+        return SubmitUploadBatch(pManager, false, VK_NULL_HANDLE);
+    }
+    return true;
+}
+
+bool EnqueueBufferUpload(UploadManager* pManager, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size,
+                         VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const UploadDestination destination = {
+        .buffer = dstBuffer,
+        .image = VK_NULL_HANDLE,
+        .dstStageMask = dstStageMask,
+        .dstAccessMask = dstAccessMask
+    };
+    const uint32_t destinationIndex = FindOrAddDestination(pManager, &destination);
+    if (destinationIndex == UINT32_MAX) return false;
+
+    const VkDeviceSize maxPieceSize = pManager->info.stagingSize / UPLOAD_BATCH_RING_SIZE;
+    for (VkDeviceSize offset = 0; offset < size; )
+    {
+        const VkDeviceSize pieceSize = size - offset < maxPieceSize ? size - offset : maxPieceSize;
+        VkDeviceSize stagingOffset;
+        if (!AllocateStaging(pManager, pieceSize, &stagingOffset)) return false;
+        memcpy(pManager->pStagingData + stagingOffset, (const uint8_t*)pData + offset, (size_t)pieceSize);
+
+        const UploadCopy copy = {
+            .destinationIndex = destinationIndex,
+            .bufferRegion = { .srcOffset = stagingOffset, .dstOffset = dstOffset + offset, .size = pieceSize }
+        };
+        if (!AddUploadCopy(pManager, &copy, pieceSize)) return false;
+        offset += pieceSize;
+    }
+    return true;
+}
+
+bool EnqueueImageUpload(UploadManager* pManager, VkImage dstImage, const VkBufferImageCopy* pRegion, const void* pData, VkDeviceSize size,
+                        VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask)
+{
+    const UploadDestination destination = {
+        .buffer = VK_NULL_HANDLE,
+        .image = dstImage,
+        .subresourceRange = {
+            .aspectMask = pRegion->imageSubresource.aspectMask,
+            .baseMipLevel = pRegion->imageSubresource.mipLevel,
+            .levelCount = 1,
+            .baseArrayLayer = pRegion->imageSubresource.baseArrayLayer,
+            .layerCount = pRegion->imageSubresource.layerCount
+        },
+        .finalLayout = finalLayout,
+        .dstStageMask = dstStageMask,
+        .dstAccessMask = dstAccessMask,
+        .isTransferDstLayout = false
+    };
+    const uint32_t destinationIndex = FindOrAddDestination(pManager, &destination);
+    if (destinationIndex == UINT32_MAX) return false;
+
+    VkDeviceSize stagingOffset;
+    if (!AllocateStaging(pManager, size, &stagingOffset)) return false;
+    memcpy(pManager->pStagingData + stagingOffset, pData, (size_t)size);
+
+    UploadCopy copy = { .destinationIndex = destinationIndex, .imageRegion = *pRegion };
+    copy.imageRegion.bufferOffset = stagingOffset;
+    return AddUploadCopy(pManager, &copy, size);
+}
+
+bool SubmitUploads(UploadManager* pManager, VkSemaphore signalSemaphore)
+{
+    if (pManager->destinationCount == 0 && signalSemaphore == VK_NULL_HANDLE) return true;
+
+    const bool isRelease = pManager->info.queueFamilyIndex != pManager->info.dstQueueFamilyIndex;
+    if (isRelease && pManager->releasedDestinationCount + pManager->destinationCount > MAX_UPLOAD_DESTINATION_COUNT)
+    {
+        puts("Too many released upload destinations! RecordUploadAcquireBarriers MUST BE called more often.");
+        return false;
+    }
+
+    if (!SubmitUploadBatch(pManager, true, signalSemaphore)) return false;
+
+    if (isRelease)
+    {
+        memcpy(&pManager->releasedDestinations[pManager->releasedDestinationCount], pManager->destinations,
+            pManager->destinationCount * sizeof(pManager->destinations[0]));
+        pManager->releasedDestinationCount += pManager->destinationCount;
+    }
+    pManager->destinationCount = 0;
+    return true;
+}
+
+VkPipelineStageFlags RecordUploadAcquireBarriers(UploadManager* pManager, VkCommandBuffer cmdBuf)
+{
+    VkBufferMemoryBarrier bufferBarriers[MAX_UPLOAD_DESTINATION_COUNT];
+    VkImageMemoryBarrier imageBarriers[MAX_UPLOAD_DESTINATION_COUNT];
+    uint32_t bufferBarrierCount = 0;
+    uint32_t imageBarrierCount = 0;
+    VkPipelineStageFlags dstStageMask = 0;
+    // The source access mask is ignored by an acquire operation, the layouts MUST match the release.
+    for (uint32_t i = 0; i < pManager->releasedDestinationCount; ++i)
+    {
+        const UploadDestination* pDestination = &pManager->releasedDestinations[i];
+        dstStageMask |= pDestination->dstStageMask;
+        if (pDestination->buffer != VK_NULL_HANDLE)
+        {
+            bufferBarriers[bufferBarrierCount++] = (VkBufferMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+                .pNext = NULL,
+                .srcAccessMask = 0,
+                .dstAccessMask = pDestination->dstAccessMask,
+                .srcQueueFamilyIndex = pManager->info.queueFamilyIndex,
+                .dstQueueFamilyIndex = pManager->info.dstQueueFamilyIndex,
+                .buffer = pDestination->buffer,
+                .offset = 0,
+                .size = VK_WHOLE_SIZE
+            };
+        }
+        else
+        {
+            imageBarriers[imageBarrierCount++] = (VkImageMemoryBarrier){
+                .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+                .pNext = NULL,
+                .srcAccessMask = 0,
+                .dstAccessMask = pDestination->dstAccessMask,
+                .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                .newLayout = pDestination->finalLayout,
+                .srcQueueFamilyIndex = pManager->info.queueFamilyIndex,
+                .dstQueueFamilyIndex = pManager->info.dstQueueFamilyIndex,
+                .image = pDestination->image,
+                .subresourceRange = pDestination->subresourceRange
+            };
+        }
+    }
+    pManager->releasedDestinationCount = 0;
+
+    if (dstStageMask != 0) {
+        vkCmdPipelineBarrier(cmdBuf, dstStageMask, dstStageMask, 0, 0, NULL, bufferBarrierCount, bufferBarriers, imageBarrierCount, imageBarriers);
+    }
+    return dstStageMask;
+}
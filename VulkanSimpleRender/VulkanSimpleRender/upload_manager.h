@@ -0,0 +1,134 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <vulkan/vulkan.h>
+#include "memory_tracker.h"
+
+enum UPLOAD_MANAGER_CONSTANTS
+{
+    // Number of batches that can be in flight at the same time. Uploads are split into pieces of
+    // 1 / UPLOAD_BATCH_RING_SIZE of the staging ring, so the ring is refilled while earlier batches are still copied.
+    UPLOAD_BATCH_RING_SIZE = 4,
+    MAX_UPLOAD_COPY_COUNT = 256,
+    // Distinct destination buffers and images between two calls of SubmitUploads
+    MAX_UPLOAD_DESTINATION_COUNT = 64,
+    // Staging offsets are aligned to at least this, which is a multiple of every texel block size
+    MIN_UPLOAD_STAGING_ALIGNMENT = 16
+};
+
+typedef struct UploadManagerCreateInfo
+{
+    VkDevice device;
+    // The callbacks every object of the manager is created with, NULL for none
+    const VkAllocationCallbacks* pAllocator;
+    const VkPhysicalDeviceMemoryProperties* pMemoryProperties;
+    // The queue MUST support transfer operations and MUST BE externally synchronized with the other users of it.
+    VkQueue queue;
+    uint32_t queueFamilyIndex;
+    // Queue family using the uploaded resources. If it differs from `queueFamilyIndex`, SubmitUploads releases the destinations
+    // to it, and RecordUploadAcquireBarriers MUST BE recorded on a queue of it.
+    uint32_t dstQueueFamilyIndex;
+    VkDeviceSize stagingSize;
+    // VkPhysicalDeviceLimits::optimalBufferCopyOffsetAlignment
+    VkDeviceSize stagingAlignment;
+    // Allocates the staging ring if not NULL, which is then halved down to `minStagingSize` while it does not fit within the memory
+    // budget. A smaller ring only splits the uploads into more batches. 0 never shrinks it.
+    DeviceMemoryTracker* pMemoryTracker;
+    VkDeviceSize minStagingSize;
+} UploadManagerCreateInfo;
+
+typedef struct UploadDestination
+{
+    VkBuffer buffer;
+    VkImage image;
+    // The subresources of an image destination, which is one mip level of it
+    VkImageSubresourceRange subresourceRange;
+    VkImageLayout finalLayout;
+    VkPipelineStageFlags dstStageMask;
+    VkAccessFlags dstAccessMask;
+    // The subresources are transitioned to VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL by the first batch copying into them.
+    bool isTransferDstLayout;
+} UploadDestination;
+
+typedef struct UploadCopy
+{
+    uint32_t destinationIndex;
+    // Enqueue order, which keeps the regions of a destination in order after they are grouped
+    uint32_t sequence;
+    union
+    {
+        VkBufferCopy bufferRegion;
+        VkBufferImageCopy imageRegion;
+    };
+} UploadCopy;
+
+typedef struct UploadBatch
+{
+    VkCommandBuffer commandBuffer;
+    VkFence fence;
+    // Staging ring position after the last copy of the batch, which becomes the ring tail once the fence is signaled
+    uint64_t stagingEnd;
+    bool isInFlight;
+} UploadBatch;
+
+// Uploads host data into buffers and images through a persistently mapped staging ring.
+// Copies are batched per destination into multi-region copy commands, and every batch retires its staging space by its fence,
+// so an upload never waits for the device to become idle. Not thread safe.
+typedef struct UploadManager
+{
+    UploadManagerCreateInfo info;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingMemory;
+    uint8_t* pStagingData;
+    // Monotonic positions in the ring, the staging offset is the position modulo info.stagingSize.
+    // [stagingTail, stagingHead) is still read by batches in flight or by the pending copies.
+    uint64_t stagingHead;
+    uint64_t stagingTail;
+    VkCommandPool commandPool;
+    UploadBatch batches[UPLOAD_BATCH_RING_SIZE];
+    uint32_t nextBatch;
+    uint32_t inFlightBatchCount;
+
+    // Copies recorded by the next batch
+    UploadCopy copies[MAX_UPLOAD_COPY_COUNT];
+    uint32_t copyCount;
+    VkDeviceSize pendingSize;
+    // Destinations written since the last call of SubmitUploads
+    UploadDestination destinations[MAX_UPLOAD_DESTINATION_COUNT];
+    uint32_t destinationCount;
+    // Destinations released to info.dstQueueFamilyIndex and not acquired yet
+    UploadDestination releasedDestinations[MAX_UPLOAD_DESTINATION_COUNT];
+    uint32_t releasedDestinationCount;
+
+    uint32_t submittedBatchCount;
+    uint32_t completedBatchCount;
+    uint32_t copyCommandCount;
+    uint32_t regionCount;
+    uint64_t uploadedSize;
+} UploadManager;
+
+extern bool CreateUploadManager(const UploadManagerCreateInfo* pCreateInfo, UploadManager* pManager);
+// Waits for the batches in flight.
+extern void DestroyUploadManager(UploadManager* pManager);
+
+// Copies `size` bytes at `pData` into the staging ring and enqueues their copy into `dstBuffer` at `dstOffset`.
+// Large uploads are split and submitted in several batches, `pData` is not referenced after the call.
+extern bool EnqueueBufferUpload(UploadManager* pManager, VkBuffer dstBuffer, VkDeviceSize dstOffset, const void* pData, VkDeviceSize size,
+                                VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+// Enqueues the upload of one region of `dstImage`. The mip level and layers of `pRegion->imageSubresource` are discarded by the first
+// upload into them after SubmitUploads, the other subresources are not touched, so they can be used while the upload is in flight.
+// `pRegion->bufferOffset` is ignored, `size` bytes at `pData` MUST fit into the staging ring at once.
+extern bool EnqueueImageUpload(UploadManager* pManager, VkImage dstImage, const VkBufferImageCopy* pRegion, const void* pData, VkDeviceSize size,
+                               VkImageLayout finalLayout, VkPipelineStageFlags dstStageMask, VkAccessFlags dstAccessMask);
+
+// Submits the pending copies with one merged barrier, which makes everything enqueued since the last call available to the
+// destination stages, or releases it to info.dstQueueFamilyIndex. `signalSemaphore` is signaled by the submission if not VK_NULL_HANDLE.
+// The uploads have completed once `completedBatchCount` has reached the `submittedBatchCount` after this call.
+extern bool SubmitUploads(UploadManager* pManager, VkSemaphore signalSemaphore);
+// Records the acquire barriers matching the destinations released so far into `cmdBuf`.
+// Returns the stages at which the submission of `cmdBuf` MUST wait for the semaphore signaled by SubmitUploads, 0 if nothing was released.
+extern VkPipelineStageFlags RecordUploadAcquireBarriers(UploadManager* pManager, VkCommandBuffer cmdBuf);
+
+// Frees the staging space of the completed batches without blocking.
+extern void RetireCompletedUploads(UploadManager* pManager);